@@ -6,7 +6,6 @@
 #include "gSP_funcs_prot.h"
 
 #define gSPCombineMatrices() GSPCombineMatrices()
-#define gSPClipVertex(v)     GSPClipVertex(v)
 #define gSPLookAt(l, n)      GSPLookAt(l, n)
 #define gSPLight(l, n)       GSPLight(l, n)
 #define gSPLightColor(l, c)  GSPLightColor(l, c)
@@ -15,7 +14,6 @@
 #define gSPEndDisplayList()  GSPEndDisplayList()
 
 void GSPCombineMatrices(void);
-void GSPClipVertex(uint32_t v);
 void GSPLookAt(uint32_t l, uint32_t n);
 void GSPLight(uint32_t l, int32_t n);
 void GSPLightColor(uint32_t lightNum, uint32_t packedColor );
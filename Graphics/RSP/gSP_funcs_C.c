@@ -28,32 +28,6 @@ void GSPCombineMatricesC(void)
    }
 }
 
-void GSPClipVertexC(uint32_t v)
-{
-   switch (gfx_plugin)
-   {
-      case GFX_GLIDE64:
-#ifdef HAVE_GLIDE64
-         glide64gSPClipVertex(v);
-#endif
-         break;
-      case GFX_GLN64:
-#if !defined(HAVE_GLIDEN64) && defined(HAVE_GLN64)
-         gln64gSPClipVertex(v);
-#endif
-         break;
-      case GFX_RICE:
-#ifdef HAVE_RICE
-         /* TODO/FIXME */
-#endif
-         break;
-      case GFX_ANGRYLION:
-      case GFX_PARALLEL:
-         /* Stub, not HLE */
-         break;
-   }
-}
-
 /* Loads a LookAt structure in the RSP for specular highlighting
  * and projection mapping.
  *
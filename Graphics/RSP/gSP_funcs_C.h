@@ -10,7 +10,6 @@ extern "C" {
 #endif
 
 #define gSPCombineMatrices() GSPCombineMatricesC()
-#define gSPClipVertex(v)     GSPClipVertexC(v)
 #define gSPLookAt(l, n)      GSPLookAtC(l, n)
 #define gSPLight(l, n)       GSPLightC(l, n)
 #define gSPLightColor(l, c)  GSPLightColorC(l, c)
@@ -19,7 +18,6 @@ extern "C" {
 #define gSPEndDisplayList()  GSPEndDisplayListC()
 
 void GSPCombineMatricesC(void);
-void GSPClipVertexC(uint32_t v);
 void GSPLookAtC(uint32_t l, uint32_t n);
 void GSPLightC(uint32_t l, int32_t n);
 void GSPLightColorC(uint32_t lightNum, uint32_t packedColor );
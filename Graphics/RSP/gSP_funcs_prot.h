@@ -20,7 +20,6 @@ void glide64gSPDisplayList(uint32_t dl);
 void glide64gSPBranchList(uint32_t dl);
 void glide64gSPSetVertexColorBase(uint32_t base);
 void glide64gSPSegment(int32_t seg, int32_t base);
-void glide64gSPClipVertex(uint32_t v);
 void glide64gSPLightColor( uint32_t lightNum, uint32_t packedColor );
 void glide64gSPCombineMatrices(void);
 void glide64gSPLookAt(uint32_t l, uint32_t n);
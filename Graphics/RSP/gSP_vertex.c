@@ -0,0 +1,428 @@
+#include <math.h>
+
+#include "gSP_vertex.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define VERTEX_BATCH_SSE
+#elif defined(__ARM_NEON__) && defined(HAVE_NEON)
+#include <arm_neon.h>
+#define VERTEX_BATCH_NEON
+#endif
+
+/* The SIMD loops evaluate every expression in the same order as the
+ * scalar tails, so a vertex gets the same result whichever path it takes. */
+
+static void transform_scalar(struct vertex_batch *batch, unsigned i, float mtx[4][4])
+{
+   float x = batch->x[i];
+   float y = batch->y[i];
+   float z = batch->z[i];
+
+   batch->x[i] = x * mtx[0][0] + y * mtx[1][0] + z * mtx[2][0] + mtx[3][0];
+   batch->y[i] = x * mtx[0][1] + y * mtx[1][1] + z * mtx[2][1] + mtx[3][1];
+   batch->z[i] = x * mtx[0][2] + y * mtx[1][2] + z * mtx[2][2] + mtx[3][2];
+   batch->w[i] = x * mtx[0][3] + y * mtx[1][3] + z * mtx[2][3] + mtx[3][3];
+}
+
+static void normalize_scalar(struct vertex_batch *batch, unsigned i)
+{
+   float len = batch->nx[i] * batch->nx[i]
+      + batch->ny[i] * batch->ny[i]
+      + batch->nz[i] * batch->nz[i];
+
+   if (len == 0.0f)
+      return;
+
+   len = sqrtf(len);
+   batch->nx[i] /= len;
+   batch->ny[i] /= len;
+   batch->nz[i] /= len;
+}
+
+static void transform_normal_scalar(struct vertex_batch *batch, unsigned i, float mtx[4][4])
+{
+   float x = batch->nx[i];
+   float y = batch->ny[i];
+   float z = batch->nz[i];
+
+   batch->nx[i] = mtx[0][0] * x + mtx[1][0] * y + mtx[2][0] * z;
+   batch->ny[i] = mtx[0][1] * x + mtx[1][1] * y + mtx[2][1] * z;
+   batch->nz[i] = mtx[0][2] * x + mtx[1][2] * y + mtx[2][2] * z;
+
+   normalize_scalar(batch, i);
+}
+
+static void light_scalar(struct vertex_batch *batch, unsigned i,
+      const struct vertex_batch_light *lights, unsigned num_lights,
+      const float ambient[3])
+{
+   unsigned l;
+   float r = ambient[0];
+   float g = ambient[1];
+   float b = ambient[2];
+
+   for (l = 0; l < num_lights; l++)
+   {
+      float intensity = batch->nx[i] * lights[l].dir[0]
+         + batch->ny[i] * lights[l].dir[1]
+         + batch->nz[i] * lights[l].dir[2];
+
+      if (intensity < 0.0f)
+         intensity = 0.0f;
+
+      r += lights[l].col[0] * intensity;
+      g += lights[l].col[1] * intensity;
+      b += lights[l].col[2] * intensity;
+   }
+
+   /* MIN(1.0f, c), which keeps a NaN */
+   batch->r[i] = 1.0f < r ? 1.0f : r;
+   batch->g[i] = 1.0f < g ? 1.0f : g;
+   batch->b[i] = 1.0f < b ? 1.0f : b;
+}
+
+static void clip_scalar(struct vertex_batch *batch, unsigned i, float w_min)
+{
+   float x = batch->x[i];
+   float y = batch->y[i];
+   float w = batch->w[i];
+   uint32_t clip = 0;
+
+   if (x > +w)    clip |= VERTEX_CLIP_POSX;
+   if (x < -w)    clip |= VERTEX_CLIP_NEGX;
+   if (y > +w)    clip |= VERTEX_CLIP_POSY;
+   if (y < -w)    clip |= VERTEX_CLIP_NEGY;
+   if (w < w_min) clip |= VERTEX_CLIP_Z;
+
+   batch->clip[i] = clip;
+}
+
+#if defined(VERTEX_BATCH_SSE)
+
+static unsigned transform_simd(struct vertex_batch *batch, unsigned n, float mtx[4][4])
+{
+   unsigned i;
+   __m128 m[4][4];
+
+   for (i = 0; i < 16; i++)
+      m[i >> 2][i & 3] = _mm_set1_ps(mtx[i >> 2][i & 3]);
+
+   for (i = 0; i + 4 <= n; i += 4)
+   {
+      __m128 x = _mm_loadu_ps(&batch->x[i]);
+      __m128 y = _mm_loadu_ps(&batch->y[i]);
+      __m128 z = _mm_loadu_ps(&batch->z[i]);
+
+#define TRANSFORM_ROW(out, c) \
+      _mm_storeu_ps(&batch->out[i], _mm_add_ps(_mm_add_ps(_mm_add_ps( \
+            _mm_mul_ps(x, m[0][c]), _mm_mul_ps(y, m[1][c])), \
+            _mm_mul_ps(z, m[2][c])), m[3][c]))
+      TRANSFORM_ROW(x, 0);
+      TRANSFORM_ROW(y, 1);
+      TRANSFORM_ROW(z, 2);
+      TRANSFORM_ROW(w, 3);
+#undef TRANSFORM_ROW
+   }
+
+   return i;
+}
+
+static void normalize4(struct vertex_batch *batch, unsigned i, __m128 x, __m128 y, __m128 z)
+{
+   __m128 len  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+         _mm_mul_ps(z, z));
+   __m128 zero = _mm_cmpeq_ps(len, _mm_setzero_ps());
+
+   /* Lanes with a zero length are left as they are; dividing by 1 keeps
+    * them exact. */
+   len = _mm_or_ps(_mm_andnot_ps(zero, _mm_sqrt_ps(len)),
+         _mm_and_ps(zero, _mm_set1_ps(1.0f)));
+
+   _mm_storeu_ps(&batch->nx[i], _mm_div_ps(x, len));
+   _mm_storeu_ps(&batch->ny[i], _mm_div_ps(y, len));
+   _mm_storeu_ps(&batch->nz[i], _mm_div_ps(z, len));
+}
+
+static unsigned transform_normals_simd(struct vertex_batch *batch, unsigned n, float mtx[4][4])
+{
+   unsigned i;
+   __m128 m[3][3];
+
+   for (i = 0; i < 9; i++)
+      m[i / 3][i % 3] = _mm_set1_ps(mtx[i / 3][i % 3]);
+
+   for (i = 0; i + 4 <= n; i += 4)
+   {
+      __m128 x  = _mm_loadu_ps(&batch->nx[i]);
+      __m128 y  = _mm_loadu_ps(&batch->ny[i]);
+      __m128 z  = _mm_loadu_ps(&batch->nz[i]);
+      __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][0], x), _mm_mul_ps(m[1][0], y)),
+            _mm_mul_ps(m[2][0], z));
+      __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][1], x), _mm_mul_ps(m[1][1], y)),
+            _mm_mul_ps(m[2][1], z));
+      __m128 tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][2], x), _mm_mul_ps(m[1][2], y)),
+            _mm_mul_ps(m[2][2], z));
+
+      normalize4(batch, i, tx, ty, tz);
+   }
+
+   return i;
+}
+
+static unsigned normalize_simd(struct vertex_batch *batch, unsigned n)
+{
+   unsigned i;
+
+   for (i = 0; i + 4 <= n; i += 4)
+      normalize4(batch, i, _mm_loadu_ps(&batch->nx[i]),
+            _mm_loadu_ps(&batch->ny[i]), _mm_loadu_ps(&batch->nz[i]));
+
+   return i;
+}
+
+static unsigned light_simd(struct vertex_batch *batch, unsigned n,
+      const struct vertex_batch_light *lights, unsigned num_lights,
+      const float ambient[3])
+{
+   unsigned i, l;
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 one  = _mm_set1_ps(1.0f);
+
+   for (i = 0; i + 4 <= n; i += 4)
+   {
+      __m128 nx = _mm_loadu_ps(&batch->nx[i]);
+      __m128 ny = _mm_loadu_ps(&batch->ny[i]);
+      __m128 nz = _mm_loadu_ps(&batch->nz[i]);
+      __m128 r  = _mm_set1_ps(ambient[0]);
+      __m128 g  = _mm_set1_ps(ambient[1]);
+      __m128 b  = _mm_set1_ps(ambient[2]);
+
+      for (l = 0; l < num_lights; l++)
+      {
+         __m128 intensity = _mm_add_ps(_mm_add_ps(
+                  _mm_mul_ps(nx, _mm_set1_ps(lights[l].dir[0])),
+                  _mm_mul_ps(ny, _mm_set1_ps(lights[l].dir[1]))),
+               _mm_mul_ps(nz, _mm_set1_ps(lights[l].dir[2])));
+
+         /* maxps returns its second operand for NaN, and for -0 with
+          * this order, like the scalar test */
+         intensity = _mm_max_ps(zero, intensity);
+         r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(lights[l].col[0]), intensity));
+         g = _mm_add_ps(g, _mm_mul_ps(_mm_set1_ps(lights[l].col[1]), intensity));
+         b = _mm_add_ps(b, _mm_mul_ps(_mm_set1_ps(lights[l].col[2]), intensity));
+      }
+
+      _mm_storeu_ps(&batch->r[i], _mm_min_ps(one, r));
+      _mm_storeu_ps(&batch->g[i], _mm_min_ps(one, g));
+      _mm_storeu_ps(&batch->b[i], _mm_min_ps(one, b));
+   }
+
+   return i;
+}
+
+static unsigned clip_simd(struct vertex_batch *batch, unsigned n, float w_min)
+{
+   unsigned i, k;
+   const __m128 sign = _mm_set1_ps(-0.0f);
+   const __m128 wmin = _mm_set1_ps(w_min);
+
+   for (i = 0; i + 4 <= n; i += 4)
+   {
+      __m128 x   = _mm_loadu_ps(&batch->x[i]);
+      __m128 y   = _mm_loadu_ps(&batch->y[i]);
+      __m128 w   = _mm_loadu_ps(&batch->w[i]);
+      __m128 neg = _mm_xor_ps(w, sign);
+      int posx   = _mm_movemask_ps(_mm_cmpgt_ps(x, w));
+      int negx   = _mm_movemask_ps(_mm_cmplt_ps(x, neg));
+      int posy   = _mm_movemask_ps(_mm_cmpgt_ps(y, w));
+      int negy   = _mm_movemask_ps(_mm_cmplt_ps(y, neg));
+      int z      = _mm_movemask_ps(_mm_cmplt_ps(w, wmin));
+
+      for (k = 0; k < 4; k++)
+         batch->clip[i + k] =
+              (((posx >> k) & 1) ? VERTEX_CLIP_POSX : 0)
+            | (((negx >> k) & 1) ? VERTEX_CLIP_NEGX : 0)
+            | (((posy >> k) & 1) ? VERTEX_CLIP_POSY : 0)
+            | (((negy >> k) & 1) ? VERTEX_CLIP_NEGY : 0)
+            | (((z    >> k) & 1) ? VERTEX_CLIP_Z    : 0);
+   }
+
+   return i;
+}
+
+#elif defined(VERTEX_BATCH_NEON)
+
+/* vmlaq is avoided on purpose, it may be fused on some cores. */
+
+static unsigned transform_simd(struct vertex_batch *batch, unsigned n, float mtx[4][4])
+{
+   unsigned i;
+
+   for (i = 0; i + 4 <= n; i += 4)
+   {
+      float32x4_t x = vld1q_f32(&batch->x[i]);
+      float32x4_t y = vld1q_f32(&batch->y[i]);
+      float32x4_t z = vld1q_f32(&batch->z[i]);
+
+#define TRANSFORM_ROW(out, c) \
+      vst1q_f32(&batch->out[i], vaddq_f32(vaddq_f32(vaddq_f32( \
+            vmulq_n_f32(x, mtx[0][c]), vmulq_n_f32(y, mtx[1][c])), \
+            vmulq_n_f32(z, mtx[2][c])), vdupq_n_f32(mtx[3][c])))
+      TRANSFORM_ROW(x, 0);
+      TRANSFORM_ROW(y, 1);
+      TRANSFORM_ROW(z, 2);
+      TRANSFORM_ROW(w, 3);
+#undef TRANSFORM_ROW
+   }
+
+   return i;
+}
+
+/* ARMv7 NEON has no exact square root or division, normalization stays
+ * on the scalar path. */
+static unsigned transform_normals_simd(struct vertex_batch *batch, unsigned n, float mtx[4][4])
+{
+   return 0;
+}
+
+static unsigned normalize_simd(struct vertex_batch *batch, unsigned n)
+{
+   return 0;
+}
+
+static unsigned light_simd(struct vertex_batch *batch, unsigned n,
+      const struct vertex_batch_light *lights, unsigned num_lights,
+      const float ambient[3])
+{
+   unsigned i, l;
+   const float32x4_t zero = vdupq_n_f32(0.0f);
+   const float32x4_t one  = vdupq_n_f32(1.0f);
+
+   for (i = 0; i + 4 <= n; i += 4)
+   {
+      float32x4_t nx = vld1q_f32(&batch->nx[i]);
+      float32x4_t ny = vld1q_f32(&batch->ny[i]);
+      float32x4_t nz = vld1q_f32(&batch->nz[i]);
+      float32x4_t r  = vdupq_n_f32(ambient[0]);
+      float32x4_t g  = vdupq_n_f32(ambient[1]);
+      float32x4_t b  = vdupq_n_f32(ambient[2]);
+
+      for (l = 0; l < num_lights; l++)
+      {
+         float32x4_t intensity = vaddq_f32(vaddq_f32(
+                  vmulq_n_f32(nx, lights[l].dir[0]),
+                  vmulq_n_f32(ny, lights[l].dir[1])),
+               vmulq_n_f32(nz, lights[l].dir[2]));
+
+         /* Selects rather than vmaxq, which turns -0 into +0 */
+         intensity = vbslq_f32(vcltq_f32(intensity, zero), zero, intensity);
+         r = vaddq_f32(r, vmulq_n_f32(intensity, lights[l].col[0]));
+         g = vaddq_f32(g, vmulq_n_f32(intensity, lights[l].col[1]));
+         b = vaddq_f32(b, vmulq_n_f32(intensity, lights[l].col[2]));
+      }
+
+      vst1q_f32(&batch->r[i], vbslq_f32(vcltq_f32(one, r), one, r));
+      vst1q_f32(&batch->g[i], vbslq_f32(vcltq_f32(one, g), one, g));
+      vst1q_f32(&batch->b[i], vbslq_f32(vcltq_f32(one, b), one, b));
+   }
+
+   return i;
+}
+
+static unsigned clip_simd(struct vertex_batch *batch, unsigned n, float w_min)
+{
+   unsigned i;
+   const float32x4_t wmin = vdupq_n_f32(w_min);
+
+   for (i = 0; i + 4 <= n; i += 4)
+   {
+      float32x4_t x   = vld1q_f32(&batch->x[i]);
+      float32x4_t y   = vld1q_f32(&batch->y[i]);
+      float32x4_t w   = vld1q_f32(&batch->w[i]);
+      float32x4_t neg = vnegq_f32(w);
+      uint32x4_t clip =
+         vandq_u32(vcgtq_f32(x, w), vdupq_n_u32(VERTEX_CLIP_POSX));
+
+      clip = vorrq_u32(clip, vandq_u32(vcltq_f32(x, neg), vdupq_n_u32(VERTEX_CLIP_NEGX)));
+      clip = vorrq_u32(clip, vandq_u32(vcgtq_f32(y, w), vdupq_n_u32(VERTEX_CLIP_POSY)));
+      clip = vorrq_u32(clip, vandq_u32(vcltq_f32(y, neg), vdupq_n_u32(VERTEX_CLIP_NEGY)));
+      clip = vorrq_u32(clip, vandq_u32(vcltq_f32(w, wmin), vdupq_n_u32(VERTEX_CLIP_Z)));
+      vst1q_u32(&batch->clip[i], clip);
+   }
+
+   return i;
+}
+
+#else
+
+static unsigned transform_simd(struct vertex_batch *batch, unsigned n, float mtx[4][4])
+{
+   return 0;
+}
+
+static unsigned transform_normals_simd(struct vertex_batch *batch, unsigned n, float mtx[4][4])
+{
+   return 0;
+}
+
+static unsigned normalize_simd(struct vertex_batch *batch, unsigned n)
+{
+   return 0;
+}
+
+static unsigned light_simd(struct vertex_batch *batch, unsigned n,
+      const struct vertex_batch_light *lights, unsigned num_lights,
+      const float ambient[3])
+{
+   return 0;
+}
+
+static unsigned clip_simd(struct vertex_batch *batch, unsigned n, float w_min)
+{
+   return 0;
+}
+
+#endif
+
+void gSPBatchTransform(struct vertex_batch *batch, unsigned n, float mtx[4][4])
+{
+   unsigned i;
+
+   for (i = transform_simd(batch, n, mtx); i < n; i++)
+      transform_scalar(batch, i, mtx);
+}
+
+void gSPBatchTransformNormals(struct vertex_batch *batch, unsigned n, float mtx[4][4])
+{
+   unsigned i;
+
+   for (i = transform_normals_simd(batch, n, mtx); i < n; i++)
+      transform_normal_scalar(batch, i, mtx);
+}
+
+void gSPBatchNormalize(struct vertex_batch *batch, unsigned n)
+{
+   unsigned i;
+
+   for (i = normalize_simd(batch, n); i < n; i++)
+      normalize_scalar(batch, i);
+}
+
+void gSPBatchLight(struct vertex_batch *batch, unsigned n,
+      const struct vertex_batch_light *lights, unsigned num_lights,
+      const float ambient[3])
+{
+   unsigned i;
+
+   for (i = light_simd(batch, n, lights, num_lights, ambient); i < n; i++)
+      light_scalar(batch, i, lights, num_lights, ambient);
+}
+
+void gSPBatchClip(struct vertex_batch *batch, unsigned n, float w_min)
+{
+   unsigned i;
+
+   for (i = clip_simd(batch, n, w_min); i < n; i++)
+      clip_scalar(batch, i, w_min);
+}
@@ -0,0 +1,72 @@
+#ifndef _GSP_VERTEX_H
+#define _GSP_VERTEX_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Batched vertex pipeline shared by the HLE plugins.
+ *
+ * A whole vertex load (G_VTX and friends) is kept as a structure of
+ * arrays so that four vertices at a time go through SSE or NEON. Each
+ * step gives the same results as the per-vertex float code it replaces;
+ * the plugins still do clipping, point lights and texgen their own way. */
+
+/* Largest vertex load of any plugin (GLideN64's INDEXMAP_SIZE). */
+#define VERTEX_BATCH_SIZE 80
+
+/* Clip codes, the same bits as the plugins' CLIP_* flags. */
+#define VERTEX_CLIP_NEGX 0x01
+#define VERTEX_CLIP_POSX 0x02
+#define VERTEX_CLIP_NEGY 0x04
+#define VERTEX_CLIP_POSY 0x08
+#define VERTEX_CLIP_Z    0x10
+
+struct vertex_batch
+{
+   float x[VERTEX_BATCH_SIZE];
+   float y[VERTEX_BATCH_SIZE];
+   float z[VERTEX_BATCH_SIZE];
+   float w[VERTEX_BATCH_SIZE];
+   float nx[VERTEX_BATCH_SIZE];
+   float ny[VERTEX_BATCH_SIZE];
+   float nz[VERTEX_BATCH_SIZE];
+   float r[VERTEX_BATCH_SIZE];
+   float g[VERTEX_BATCH_SIZE];
+   float b[VERTEX_BATCH_SIZE];
+   uint32_t clip[VERTEX_BATCH_SIZE];
+};
+
+struct vertex_batch_light
+{
+   float dir[3];
+   float col[3];
+};
+
+/* x, y, z (w = 1) -> x, y, z, w in clip space. */
+void gSPBatchTransform(struct vertex_batch *batch, unsigned n, float mtx[4][4]);
+
+/* Normals through the upper 3x3 of mtx, then normalized, like
+ * TransformVectorNormalize. */
+void gSPBatchTransformNormals(struct vertex_batch *batch, unsigned n, float mtx[4][4]);
+
+/* Normals normalized in place, like NormalizeVector. */
+void gSPBatchNormalize(struct vertex_batch *batch, unsigned n);
+
+/* Directional lighting: r, g, b = min(1, ambient + sum of
+ * max(0, dot(normal, dir)) * col). */
+void gSPBatchLight(struct vertex_batch *batch, unsigned n,
+      const struct vertex_batch_light *lights, unsigned num_lights,
+      const float ambient[3]);
+
+/* Clip codes of x, y, w, like gln64gSPClipVertex: x and y against -w and +w,
+ * and VERTEX_CLIP_Z below w_min. */
+void gSPBatchClip(struct vertex_batch *batch, unsigned n, float w_min);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,626 @@
+#include "texconv.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#define TEXCONV_SSSE3
+#endif
+#define TEXCONV_SSE2
+#define TEXCONV_SIMD
+#elif defined(__ARM_NEON__) && defined(HAVE_NEON)
+#include <arm_neon.h>
+#define TEXCONV_NEON
+#define TEXCONV_SIMD
+#endif
+
+/* Scalar texels. The expansions are the usual bit replications, the same
+ * values as Rice's FiveToEight/ThreeToEight/FourToEight tables. With
+ * TEXCONV_ROUND five bits are scaled like GLideN64's Five2Eight, that is
+ * c * 255 / 31 rounded, which (c * 527 + 23) >> 6 gives exactly. */
+
+static uint32_t five_to_eight(uint32_t c, unsigned flags)
+{
+   if (flags & TEXCONV_ROUND)
+      return (c * 527 + 23) >> 6;
+   return (c << 3) | (c >> 2);
+}
+
+static uint32_t three_to_eight(uint32_t c)
+{
+   return (c << 5) | (c << 2) | (c >> 1);
+}
+
+static uint32_t grey(uint32_t i, uint32_t a)
+{
+   return (a << 24) | (i << 16) | (i << 8) | i;
+}
+
+static uint32_t ia4_texel(uint32_t n)
+{
+   return grey(three_to_eight(n >> 1), (n & 1) ? 0xFF : 0x00);
+}
+
+static uint32_t ia16_texel(uint32_t w)
+{
+   return grey(w >> 8, w & 0xFF);
+}
+
+static uint32_t rgba16_texel(uint32_t w, unsigned flags)
+{
+   uint32_t r = five_to_eight(w >> 11, flags);
+   uint32_t g = five_to_eight((w >> 6) & 0x1F, flags);
+   uint32_t b = five_to_eight((w >> 1) & 0x1F, flags);
+   uint32_t a = (w & 1) ? 0xFF : 0x00;
+
+   if (flags & TEXCONV_ABGR)
+      return (a << 24) | (b << 16) | (g << 8) | r;
+   return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+static uint32_t load4(const uint8_t *src, unsigned offset, unsigned fiddle, unsigned k)
+{
+   uint32_t b = src[(offset + (k >> 1)) ^ fiddle];
+   return (k & 1) ? (b & 0x0F) : (b >> 4);
+}
+
+static uint32_t load16(const uint8_t *src, unsigned offset, unsigned fiddle)
+{
+   return src[offset ^ fiddle] | (src[(offset + 1) ^ fiddle] << 8);
+}
+
+/* Texels before the first 16 byte boundary of the source. */
+static unsigned head4(unsigned offset, unsigned count)
+{
+   unsigned head = ((16 - (offset & 15)) & 15) * 2;
+   return head < count ? head : count;
+}
+
+static unsigned head8(unsigned offset, unsigned count)
+{
+   unsigned head = (16 - (offset & 15)) & 15;
+   return head < count ? head : count;
+}
+
+static unsigned head16(unsigned offset, unsigned count)
+{
+   unsigned head = ((16 - (offset & 15)) & 15) / 2;
+   if (offset & 1)
+      return count;
+   return head < count ? head : count;
+}
+
+#if defined(TEXCONV_SSE2)
+
+typedef __m128i texv;
+
+#ifdef TEXCONV_SSSE3
+typedef __m128i swizzle_t;
+
+static swizzle_t make_swizzle(unsigned fiddle)
+{
+   return _mm_xor_si128(_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+            8, 9, 10, 11, 12, 13, 14, 15), _mm_set1_epi8((char)fiddle));
+}
+
+static __m128i load_block(const uint8_t *src, unsigned pos, swizzle_t sw)
+{
+   return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + pos)), sw);
+}
+#else
+typedef unsigned swizzle_t;
+
+static swizzle_t make_swizzle(unsigned fiddle)
+{
+   return fiddle;
+}
+
+/* Each fiddle bit swaps neighbours of one size: bytes, words, dwords
+ * and qwords. */
+static __m128i load_block(const uint8_t *src, unsigned pos, swizzle_t sw)
+{
+   __m128i v = _mm_loadu_si128((const __m128i*)(src + pos));
+
+   if (sw & 1)
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+   if (sw & 2)
+   {
+      v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+   }
+   if (sw & 4)
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+   if (sw & 8)
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+   return v;
+}
+#endif
+
+/* 16 texels from byte planes, c0 ending up in the low byte. */
+static void store4(uint32_t *dst, __m128i c0, __m128i c1, __m128i c2, __m128i c3)
+{
+   __m128i t0 = _mm_unpacklo_epi8(c0, c1);
+   __m128i t1 = _mm_unpackhi_epi8(c0, c1);
+   __m128i t2 = _mm_unpacklo_epi8(c2, c3);
+   __m128i t3 = _mm_unpackhi_epi8(c2, c3);
+
+   _mm_storeu_si128((__m128i*)dst + 0, _mm_unpacklo_epi16(t0, t2));
+   _mm_storeu_si128((__m128i*)dst + 1, _mm_unpackhi_epi16(t0, t2));
+   _mm_storeu_si128((__m128i*)dst + 2, _mm_unpacklo_epi16(t1, t3));
+   _mm_storeu_si128((__m128i*)dst + 3, _mm_unpackhi_epi16(t1, t3));
+}
+
+static void store_bytes(uint8_t *dst, __m128i v)
+{
+   _mm_storeu_si128((__m128i*)dst, v);
+}
+
+/* High and low nibbles, each times 0x11. */
+static __m128i expand_hi(__m128i b)
+{
+   __m128i h = _mm_and_si128(b, _mm_set1_epi8((char)0xF0));
+   return _mm_or_si128(h, _mm_srli_epi16(h, 4));
+}
+
+static __m128i expand_lo(__m128i b)
+{
+   __m128i l = _mm_and_si128(b, _mm_set1_epi8(0x0F));
+   return _mm_or_si128(l, _mm_slli_epi16(l, 4));
+}
+
+/* The 32 nibbles of b in texel order. */
+static void split_nibbles(__m128i b, __m128i *n0, __m128i *n1)
+{
+   __m128i mask = _mm_set1_epi8(0x0F);
+   __m128i hi   = _mm_and_si128(_mm_srli_epi16(b, 4), mask);
+   __m128i lo   = _mm_and_si128(b, mask);
+
+   *n0 = _mm_unpacklo_epi8(hi, lo);
+   *n1 = _mm_unpackhi_epi8(hi, lo);
+}
+
+static void i4_block(uint32_t *dst, __m128i b)
+{
+   __m128i hi = expand_hi(b);
+   __m128i lo = expand_lo(b);
+   __m128i p0 = _mm_unpacklo_epi8(hi, lo);
+   __m128i p1 = _mm_unpackhi_epi8(hi, lo);
+
+   store4(dst, p0, p0, p0, p0);
+   store4(dst + 16, p1, p1, p1, p1);
+}
+
+static void ia4_nibbles(uint32_t *dst, __m128i n)
+{
+#ifdef TEXCONV_SSSE3
+   __m128i i = _mm_shuffle_epi8(_mm_setr_epi8(
+            0x00, 0x00, 0x24, 0x24, 0x49, 0x49, 0x6D, 0x6D,
+            (char)0x92, (char)0x92, (char)0xB6, (char)0xB6,
+            (char)0xDB, (char)0xDB, (char)0xFF, (char)0xFF), n);
+#else
+   __m128i e = _mm_and_si128(n, _mm_set1_epi8(0x0E));
+   __m128i i = _mm_or_si128(
+         _mm_and_si128(_mm_slli_epi16(e, 4), _mm_set1_epi8((char)0xE0)),
+         _mm_or_si128(
+            _mm_and_si128(_mm_slli_epi16(e, 1), _mm_set1_epi8(0x1C)),
+            _mm_and_si128(_mm_srli_epi16(e, 2), _mm_set1_epi8(0x03))));
+#endif
+   __m128i one = _mm_set1_epi8(1);
+   __m128i a   = _mm_cmpeq_epi8(_mm_and_si128(n, one), one);
+
+   store4(dst, i, i, i, a);
+}
+
+static void ia4_block(uint32_t *dst, __m128i b)
+{
+   __m128i n0, n1;
+
+   split_nibbles(b, &n0, &n1);
+   ia4_nibbles(dst, n0);
+   ia4_nibbles(dst + 16, n1);
+}
+
+static void i8_block(uint32_t *dst, __m128i b)
+{
+   store4(dst, b, b, b, b);
+}
+
+static void ia8_block(uint32_t *dst, __m128i b)
+{
+   __m128i i = expand_hi(b);
+   store4(dst, i, i, i, expand_lo(b));
+}
+
+static void ia16_block(uint32_t *dst, __m128i w0, __m128i w1)
+{
+   __m128i lo = _mm_set1_epi16(0xFF);
+   __m128i i  = _mm_packus_epi16(_mm_srli_epi16(w0, 8), _mm_srli_epi16(w1, 8));
+   __m128i a  = _mm_packus_epi16(_mm_and_si128(w0, lo), _mm_and_si128(w1, lo));
+
+   store4(dst, i, i, i, a);
+}
+
+static __m128i round5(__m128i c)
+{
+   return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(c, _mm_set1_epi16(527)),
+            _mm_set1_epi16(23)), 6);
+}
+
+static void rgba16_channels(__m128i w, __m128i *r, __m128i *g, __m128i *b, __m128i *a,
+      unsigned flags)
+{
+   __m128i one = _mm_set1_epi16(1);
+
+   if (flags & TEXCONV_ROUND)
+   {
+      __m128i five = _mm_set1_epi16(0x1F);
+
+      *r = round5(_mm_srli_epi16(w, 11));
+      *g = round5(_mm_and_si128(_mm_srli_epi16(w, 6), five));
+      *b = round5(_mm_and_si128(_mm_srli_epi16(w, 1), five));
+   }
+   else
+   {
+      __m128i top = _mm_set1_epi16(0xF8);
+      __m128i low = _mm_set1_epi16(0x07);
+
+      *r = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(w, 8), top), _mm_srli_epi16(w, 13));
+      *g = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(w, 3), top),
+            _mm_and_si128(_mm_srli_epi16(w, 8), low));
+      *b = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(w, 2), top),
+            _mm_and_si128(_mm_srli_epi16(w, 3), low));
+   }
+   *a = _mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(w, one), one), _mm_set1_epi16(0xFF));
+}
+
+static void rgba16_block(uint32_t *dst, __m128i w0, __m128i w1, unsigned flags)
+{
+   __m128i r0, g0, b0, a0, r1, g1, b1, a1, r, g, b, a;
+
+   rgba16_channels(w0, &r0, &g0, &b0, &a0, flags);
+   rgba16_channels(w1, &r1, &g1, &b1, &a1, flags);
+   r = _mm_packus_epi16(r0, r1);
+   g = _mm_packus_epi16(g0, g1);
+   b = _mm_packus_epi16(b0, b1);
+   a = _mm_packus_epi16(a0, a1);
+
+   if (flags & TEXCONV_ABGR)
+      store4(dst, r, g, b, a);
+   else
+      store4(dst, b, g, r, a);
+}
+
+#elif defined(TEXCONV_NEON)
+
+typedef uint8x16_t texv;
+typedef unsigned swizzle_t;
+
+static swizzle_t make_swizzle(unsigned fiddle)
+{
+   return fiddle;
+}
+
+static uint8x16_t load_block(const uint8_t *src, unsigned pos, swizzle_t sw)
+{
+   uint8x16_t v = vld1q_u8(src + pos);
+
+   if (sw & 1)
+      v = vrev16q_u8(v);
+   if (sw & 2)
+      v = vreinterpretq_u8_u16(vrev32q_u16(vreinterpretq_u16_u8(v)));
+   if (sw & 4)
+      v = vreinterpretq_u8_u32(vrev64q_u32(vreinterpretq_u32_u8(v)));
+   if (sw & 8)
+      v = vcombine_u8(vget_high_u8(v), vget_low_u8(v));
+   return v;
+}
+
+static void store4(uint32_t *dst, uint8x16_t c0, uint8x16_t c1, uint8x16_t c2, uint8x16_t c3)
+{
+   uint8x16x4_t t;
+
+   t.val[0] = c0;
+   t.val[1] = c1;
+   t.val[2] = c2;
+   t.val[3] = c3;
+   vst4q_u8((uint8_t*)dst, t);
+}
+
+static void store_bytes(uint8_t *dst, uint8x16_t v)
+{
+   vst1q_u8(dst, v);
+}
+
+static uint8x16_t expand_hi(uint8x16_t b)
+{
+   uint8x16_t n = vshrq_n_u8(b, 4);
+   return vsliq_n_u8(n, n, 4);
+}
+
+static uint8x16_t expand_lo(uint8x16_t b)
+{
+   uint8x16_t n = vandq_u8(b, vdupq_n_u8(0x0F));
+   return vsliq_n_u8(n, n, 4);
+}
+
+static void split_nibbles(uint8x16_t b, uint8x16_t *n0, uint8x16_t *n1)
+{
+   uint8x16x2_t z = vzipq_u8(vshrq_n_u8(b, 4), vandq_u8(b, vdupq_n_u8(0x0F)));
+
+   *n0 = z.val[0];
+   *n1 = z.val[1];
+}
+
+static void i4_block(uint32_t *dst, uint8x16_t b)
+{
+   uint8x16x2_t p = vzipq_u8(expand_hi(b), expand_lo(b));
+
+   store4(dst, p.val[0], p.val[0], p.val[0], p.val[0]);
+   store4(dst + 16, p.val[1], p.val[1], p.val[1], p.val[1]);
+}
+
+static void ia4_nibbles(uint32_t *dst, uint8x16_t n)
+{
+   uint8x16_t e = vandq_u8(n, vdupq_n_u8(0x0E));
+   uint8x16_t i = vorrq_u8(vshlq_n_u8(e, 4), vorrq_u8(vshlq_n_u8(e, 1), vshrq_n_u8(e, 2)));
+
+   store4(dst, i, i, i, vtstq_u8(n, vdupq_n_u8(1)));
+}
+
+static void ia4_block(uint32_t *dst, uint8x16_t b)
+{
+   uint8x16_t n0, n1;
+
+   split_nibbles(b, &n0, &n1);
+   ia4_nibbles(dst, n0);
+   ia4_nibbles(dst + 16, n1);
+}
+
+static void i8_block(uint32_t *dst, uint8x16_t b)
+{
+   store4(dst, b, b, b, b);
+}
+
+static void ia8_block(uint32_t *dst, uint8x16_t b)
+{
+   uint8x16_t i = expand_hi(b);
+   store4(dst, i, i, i, expand_lo(b));
+}
+
+static void ia16_block(uint32_t *dst, uint8x16_t b0, uint8x16_t b1)
+{
+   uint16x8_t w0 = vreinterpretq_u16_u8(b0);
+   uint16x8_t w1 = vreinterpretq_u16_u8(b1);
+   uint8x16_t i  = vcombine_u8(vshrn_n_u16(w0, 8), vshrn_n_u16(w1, 8));
+   uint8x16_t a  = vcombine_u8(vmovn_u16(w0), vmovn_u16(w1));
+
+   store4(dst, i, i, i, a);
+}
+
+static uint8x8_t round5(uint16x8_t c)
+{
+   return vmovn_u16(vshrq_n_u16(vmlaq_n_u16(vdupq_n_u16(23), c, 527), 6));
+}
+
+static void rgba16_channels(uint8x16_t v, uint8x8_t *r, uint8x8_t *g, uint8x8_t *b, uint8x8_t *a,
+      unsigned flags)
+{
+   uint16x8_t w = vreinterpretq_u16_u8(v);
+
+   if (flags & TEXCONV_ROUND)
+   {
+      uint16x8_t five = vdupq_n_u16(0x1F);
+
+      *r = round5(vshrq_n_u16(w, 11));
+      *g = round5(vandq_u16(vshrq_n_u16(w, 6), five));
+      *b = round5(vandq_u16(vshrq_n_u16(w, 1), five));
+   }
+   else
+   {
+      uint16x8_t top = vdupq_n_u16(0xF8);
+      uint16x8_t low = vdupq_n_u16(0x07);
+
+      *r = vmovn_u16(vorrq_u16(vandq_u16(vshrq_n_u16(w, 8), top), vshrq_n_u16(w, 13)));
+      *g = vmovn_u16(vorrq_u16(vandq_u16(vshrq_n_u16(w, 3), top),
+               vandq_u16(vshrq_n_u16(w, 8), low)));
+      *b = vmovn_u16(vorrq_u16(vandq_u16(vshlq_n_u16(w, 2), top),
+               vandq_u16(vshrq_n_u16(w, 3), low)));
+   }
+   *a = vmovn_u16(vtstq_u16(w, vdupq_n_u16(1)));
+}
+
+static void rgba16_block(uint32_t *dst, uint8x16_t b0, uint8x16_t b1, unsigned flags)
+{
+   uint8x8_t r0, g0, bl0, a0, r1, g1, bl1, a1;
+   uint8x16_t r, g, b, a;
+
+   rgba16_channels(b0, &r0, &g0, &bl0, &a0, flags);
+   rgba16_channels(b1, &r1, &g1, &bl1, &a1, flags);
+   r = vcombine_u8(r0, r1);
+   g = vcombine_u8(g0, g1);
+   b = vcombine_u8(bl0, bl1);
+   a = vcombine_u8(a0, a1);
+
+   if (flags & TEXCONV_ABGR)
+      store4(dst, r, g, b, a);
+   else
+      store4(dst, b, g, r, a);
+}
+
+#endif
+
+void texconv_i4(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count)
+{
+   unsigned k = 0;
+#ifdef TEXCONV_SIMD
+   swizzle_t sw = make_swizzle(fiddle);
+
+   for (; k < head4(offset, count); k++)
+      dst[k] = 0x11111111 * load4(src, offset, fiddle, k);
+   for (; k + 32 <= count; k += 32)
+      i4_block(dst + k, load_block(src, offset + k / 2, sw));
+#endif
+   for (; k < count; k++)
+      dst[k] = 0x11111111 * load4(src, offset, fiddle, k);
+}
+
+void texconv_ia4(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count)
+{
+   unsigned k = 0;
+#ifdef TEXCONV_SIMD
+   swizzle_t sw = make_swizzle(fiddle);
+
+   for (; k < head4(offset, count); k++)
+      dst[k] = ia4_texel(load4(src, offset, fiddle, k));
+   for (; k + 32 <= count; k += 32)
+      ia4_block(dst + k, load_block(src, offset + k / 2, sw));
+#endif
+   for (; k < count; k++)
+      dst[k] = ia4_texel(load4(src, offset, fiddle, k));
+}
+
+void texconv_i8(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count)
+{
+   unsigned k = 0;
+#ifdef TEXCONV_SIMD
+   swizzle_t sw = make_swizzle(fiddle);
+
+   for (; k < head8(offset, count); k++)
+      dst[k] = 0x01010101 * src[(offset + k) ^ fiddle];
+   for (; k + 16 <= count; k += 16)
+      i8_block(dst + k, load_block(src, offset + k, sw));
+#endif
+   for (; k < count; k++)
+      dst[k] = 0x01010101 * src[(offset + k) ^ fiddle];
+}
+
+void texconv_ia8(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count)
+{
+   unsigned k = 0;
+#ifdef TEXCONV_SIMD
+   swizzle_t sw = make_swizzle(fiddle);
+
+   for (; k < head8(offset, count); k++)
+   {
+      uint32_t b = src[(offset + k) ^ fiddle];
+      dst[k] = grey((b >> 4) * 0x11, (b & 0x0F) * 0x11);
+   }
+   for (; k + 16 <= count; k += 16)
+      ia8_block(dst + k, load_block(src, offset + k, sw));
+#endif
+   for (; k < count; k++)
+   {
+      uint32_t b = src[(offset + k) ^ fiddle];
+      dst[k] = grey((b >> 4) * 0x11, (b & 0x0F) * 0x11);
+   }
+}
+
+void texconv_ia16(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count)
+{
+   unsigned k = 0;
+#ifdef TEXCONV_SIMD
+   swizzle_t sw = make_swizzle(fiddle);
+
+   for (; k < head16(offset, count); k++)
+      dst[k] = ia16_texel(load16(src, offset + k * 2, fiddle));
+   for (; k + 16 <= count; k += 16)
+      ia16_block(dst + k, load_block(src, offset + k * 2, sw),
+            load_block(src, offset + k * 2 + 16, sw));
+#endif
+   for (; k < count; k++)
+      dst[k] = ia16_texel(load16(src, offset + k * 2, fiddle));
+}
+
+void texconv_rgba16(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count, unsigned flags)
+{
+   unsigned k = 0;
+#ifdef TEXCONV_SIMD
+   swizzle_t sw = make_swizzle(fiddle);
+
+   for (; k < head16(offset, count); k++)
+      dst[k] = rgba16_texel(load16(src, offset + k * 2, fiddle), flags);
+   for (; k + 16 <= count; k += 16)
+      rgba16_block(dst + k, load_block(src, offset + k * 2, sw),
+            load_block(src, offset + k * 2 + 16, sw), flags);
+#endif
+   for (; k < count; k++)
+      dst[k] = rgba16_texel(load16(src, offset + k * 2, fiddle), flags);
+}
+
+/* There is no gather before AVX2, so the indices are only unswizzled in
+ * vector registers and looked up one by one. */
+
+void texconv_ci4(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count, const uint32_t *palette)
+{
+   unsigned k = 0;
+#ifdef TEXCONV_SIMD
+   swizzle_t sw = make_swizzle(fiddle);
+
+   for (; k < head4(offset, count); k++)
+      dst[k] = palette[load4(src, offset, fiddle, k)];
+   for (; k + 32 <= count; k += 32)
+   {
+      unsigned j;
+      texv n0, n1;
+      uint8_t index[32];
+
+      split_nibbles(load_block(src, offset + k / 2, sw), &n0, &n1);
+      store_bytes(index, n0);
+      store_bytes(index + 16, n1);
+      for (j = 0; j < 32; j++)
+         dst[k + j] = palette[index[j]];
+   }
+#endif
+   for (; k < count; k++)
+      dst[k] = palette[load4(src, offset, fiddle, k)];
+}
+
+void texconv_ci8(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count, const uint32_t *palette)
+{
+   unsigned k = 0;
+#ifdef TEXCONV_SIMD
+   swizzle_t sw = make_swizzle(fiddle);
+
+   for (; k < head8(offset, count); k++)
+      dst[k] = palette[src[(offset + k) ^ fiddle]];
+   for (; k + 16 <= count; k += 16)
+   {
+      unsigned j;
+      uint8_t index[16];
+
+      store_bytes(index, load_block(src, offset + k, sw));
+      for (j = 0; j < 16; j++)
+         dst[k + j] = palette[index[j]];
+   }
+#endif
+   for (; k < count; k++)
+      dst[k] = palette[src[(offset + k) ^ fiddle]];
+}
+
+void texconv_palette_rgba16(uint32_t *dst, const uint16_t *pal,
+      unsigned count, unsigned index_xor, unsigned flags)
+{
+   unsigned k;
+   uint32_t alpha = (flags & TEXCONV_OPAQUE) ? 0xFF000000 : 0;
+
+   for (k = 0; k < count; k++)
+      dst[k] = rgba16_texel(pal[k ^ index_xor], flags) | alpha;
+}
+
+void texconv_palette_ia16(uint32_t *dst, const uint16_t *pal,
+      unsigned count, unsigned index_xor, unsigned flags)
+{
+   unsigned k;
+   uint32_t alpha = (flags & TEXCONV_OPAQUE) ? 0xFF000000 : 0;
+
+   for (k = 0; k < count; k++)
+      dst[k] = ia16_texel(pal[k ^ index_xor]) | alpha;
+}
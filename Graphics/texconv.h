@@ -0,0 +1,62 @@
+#ifndef _TEXCONV_H
+#define _TEXCONV_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Texel row decoders shared by the HLE plugins.
+ *
+ * Each call decodes 'count' texels of one row to 32-bit colours. Texel k
+ * lives at byte (offset + k * size) ^ fiddle of src, fiddle being the
+ * per-row XOR swizzle of the caller (3 or 7 for bytes and 2 or 6 for
+ * words on RDRAM, 0 or 4 on a word swapped TMEM copy). It must be below
+ * 16. 16-bit rows start at an even offset and are read big-endian when
+ * the fiddle is odd.
+ *
+ * 4-bit texels take the high nibble first. Intensity formats come out as
+ * 0xAAIIIIII, so they don't depend on the channel order; RGBA16 is
+ * 0xAARRGGBB, or 0xAABBGGRR with TEXCONV_ABGR, and TEXCONV_ROUND scales
+ * its 5-bit channels with rounding instead of replicating the top bits.
+ *
+ * The SSE2, SSSE3 and NEON paths decode 16 texels at a time and are
+ * bit-exact with the scalar code, which handles the unaligned ends. */
+
+#define TEXCONV_ABGR    (1 << 0)
+/* Palette only: alpha forced to 0xFF. */
+#define TEXCONV_OPAQUE  (1 << 1)
+#define TEXCONV_ROUND   (1 << 2)
+
+void texconv_i4(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count);
+void texconv_ia4(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count);
+void texconv_i8(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count);
+void texconv_ia8(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count);
+void texconv_ia16(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count);
+void texconv_rgba16(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count, unsigned flags);
+
+/* Colour indexed, through a palette already decoded by the helpers below
+ * (16 entries for CI4, 256 for CI8). */
+void texconv_ci4(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count, const uint32_t *palette);
+void texconv_ci8(uint32_t *dst, const uint8_t *src, unsigned offset,
+      unsigned fiddle, unsigned count, const uint32_t *palette);
+
+/* dst[k] = colour of pal[k ^ index_xor]. */
+void texconv_palette_rgba16(uint32_t *dst, const uint16_t *pal,
+      unsigned count, unsigned index_xor, unsigned flags);
+void texconv_palette_ia16(uint32_t *dst, const uint16_t *pal,
+      unsigned count, unsigned index_xor, unsigned flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,273 @@
+#include <string.h>
+
+#include "texexpand.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#define TEXEXPAND_SSSE3
+#endif
+#define TEXEXPAND_SSE2
+#elif defined(__ARM_NEON__) && defined(HAVE_NEON)
+#include <arm_neon.h>
+#define TEXEXPAND_NEON
+#endif
+
+/* Row kernels. */
+
+static void fill16(uint16_t *dst, uint16_t val, uint32_t count)
+{
+   uint32_t k = 0;
+#if defined(TEXEXPAND_SSE2)
+   __m128i v = _mm_set1_epi16((short)val);
+   for (; k + 8 <= count; k += 8)
+      _mm_storeu_si128((__m128i*)(dst + k), v);
+#elif defined(TEXEXPAND_NEON)
+   uint16x8_t v = vdupq_n_u16(val);
+   for (; k + 8 <= count; k += 8)
+      vst1q_u16(dst + k, v);
+#endif
+   for (; k < count; k++)
+      dst[k] = val;
+}
+
+static void fill32(uint32_t *dst, uint32_t val, uint32_t count)
+{
+   uint32_t k = 0;
+#if defined(TEXEXPAND_SSE2)
+   __m128i v = _mm_set1_epi32((int)val);
+   for (; k + 4 <= count; k += 4)
+      _mm_storeu_si128((__m128i*)(dst + k), v);
+#elif defined(TEXEXPAND_NEON)
+   uint32x4_t v = vdupq_n_u32(val);
+   for (; k + 4 <= count; k += 4)
+      vst1q_u32(dst + k, v);
+#endif
+   for (; k < count; k++)
+      dst[k] = val;
+}
+
+/* dst[k] = src[-k]. The source must not overlap the destination. */
+static void reverse16(uint16_t *dst, const uint16_t *src, uint32_t count)
+{
+   uint32_t k = 0;
+#if defined(TEXEXPAND_SSSE3)
+   const __m128i rev = _mm_set_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+         9, 8, 11, 10, 13, 12, 15, 14);
+   for (; k + 8 <= count; k += 8)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i*)(src - k - 7));
+      _mm_storeu_si128((__m128i*)(dst + k), _mm_shuffle_epi8(v, rev));
+   }
+#elif defined(TEXEXPAND_SSE2)
+   for (; k + 8 <= count; k += 8)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i*)(src - k - 7));
+      v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+      v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+      _mm_storeu_si128((__m128i*)(dst + k), v);
+   }
+#elif defined(TEXEXPAND_NEON)
+   for (; k + 8 <= count; k += 8)
+   {
+      uint16x8_t v = vrev64q_u16(vld1q_u16(src - k - 7));
+      vst1q_u16(dst + k, vcombine_u16(vget_high_u16(v), vget_low_u16(v)));
+   }
+#endif
+   for (; k < count; k++)
+      dst[k] = *(src - k);
+}
+
+static void reverse32(uint32_t *dst, const uint32_t *src, uint32_t count)
+{
+   uint32_t k = 0;
+#if defined(TEXEXPAND_SSE2)
+   for (; k + 4 <= count; k += 4)
+   {
+      __m128i v = _mm_loadu_si128((const __m128i*)(src - k - 3));
+      _mm_storeu_si128((__m128i*)(dst + k), _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)));
+   }
+#elif defined(TEXEXPAND_NEON)
+   for (; k + 4 <= count; k += 4)
+   {
+      uint32x4_t v = vrev64q_u32(vld1q_u32(src - k - 3));
+      vst1q_u32(dst + k, vcombine_u32(vget_high_u32(v), vget_low_u32(v)));
+   }
+#endif
+   for (; k < count; k++)
+      dst[k] = *(src - k);
+}
+
+/* Texel 'x' of 'line' takes texel 'from', for 'count' texels with 'from'
+ * going up ('step' 1) or down ('step' -1). Runs that read texels written
+ * by themselves go texel by texel so that they give the same result as
+ * the per-texel loops. */
+static void copy_run(uint8_t *line, unsigned size, uint32_t x, uint32_t from,
+      int step, uint32_t count)
+{
+   uint32_t k;
+
+   if (step > 0)
+   {
+      if (from == x)
+         return;
+      if (from + count <= x)
+      {
+         memcpy(line + x * size, line + from * size, count * size);
+         return;
+      }
+   }
+   else if (from < x)
+   {
+      if (size == 4)
+         reverse32((uint32_t*)line + x, (const uint32_t*)line + from, count);
+      else
+         reverse16((uint16_t*)line + x, (const uint16_t*)line + from, count);
+      return;
+   }
+
+   for (k = 0; k < count; k++, from += step)
+   {
+      if (size == 4)
+         ((uint32_t*)line)[x + k] = ((uint32_t*)line)[from];
+      else
+         ((uint16_t*)line)[x + k] = ((uint16_t*)line)[from];
+   }
+}
+
+static uint32_t min_u32(uint32_t a, uint32_t b)
+{
+   return a < b ? a : b;
+}
+
+void texexpand_clamp_s(void *array, unsigned size, uint32_t width,
+      uint32_t towidth, uint32_t pitch, uint32_t rows)
+{
+   uint32_t y;
+
+   if ((int)width <= 0 || (int)towidth < 0 || towidth <= width)
+      return;
+
+   for (y = 0; y < rows; y++)
+   {
+      if (size == 4)
+      {
+         uint32_t *line = (uint32_t*)array + y * pitch;
+         fill32(line + width, line[width - 1], towidth - width);
+      }
+      else
+      {
+         uint16_t *line = (uint16_t*)array + y * pitch;
+         fill16(line + width, line[width - 1], towidth - width);
+      }
+   }
+}
+
+void texexpand_clamp_t(void *array, unsigned size, uint32_t height,
+      uint32_t toheight, uint32_t pitch)
+{
+   uint8_t *linesrc;
+   uint32_t y;
+
+   if ((int)height <= 0 || (int)toheight < 0)
+      return;
+
+   linesrc = (uint8_t*)array + (height - 1) * pitch * size;
+   for (y = height; y < toheight; y++)
+      memcpy((uint8_t*)array + y * pitch * size, linesrc, pitch * size);
+}
+
+void texexpand_mirror_s(void *array, unsigned size, uint32_t width,
+      uint32_t mask, uint32_t towidth, uint32_t pitch, uint32_t rows)
+{
+   uint32_t maskval1 = (1 << mask) - 1;
+   uint32_t maskval2 = (1 << (mask + 1)) - 1;
+   uint32_t y;
+
+   for (y = 0; y < rows; y++)
+   {
+      uint8_t *line = (uint8_t*)array + y * pitch * size;
+      uint32_t x = width;
+
+      while (x < towidth)
+      {
+         uint32_t pos = x & maskval2;
+         uint32_t count;
+
+         if (pos <= maskval1)
+         {
+            count = min_u32(maskval1 + 1 - pos, towidth - x);
+            copy_run(line, size, x, pos, 1, count);
+         }
+         else
+         {
+            count = min_u32(maskval2 + 1 - pos, towidth - x);
+            copy_run(line, size, x, maskval2 - pos, -1, count);
+         }
+         x += count;
+      }
+   }
+}
+
+void texexpand_mirror_t(void *array, unsigned size, uint32_t height,
+      uint32_t mask, uint32_t toheight, uint32_t pitch)
+{
+   uint32_t maskval1 = (1 << mask) - 1;
+   uint32_t maskval2 = (1 << (mask + 1)) - 1;
+   uint32_t y;
+
+   for (y = height; y < toheight; y++)
+   {
+      uint32_t srcy = (y & maskval2) <= maskval1 ? y & maskval1 : maskval2 - (y & maskval2);
+
+      if (srcy != y)
+         memcpy((uint8_t*)array + y * pitch * size,
+               (uint8_t*)array + srcy * pitch * size, pitch * size);
+   }
+}
+
+void texexpand_wrap_s(void *array, unsigned size, uint32_t width,
+      uint32_t mask, uint32_t towidth, uint32_t pitch, uint32_t rows)
+{
+   uint32_t maskval = (1 << mask) - 1;
+   uint32_t y;
+
+   for (y = 0; y < rows; y++)
+   {
+      uint8_t *line = (uint8_t*)array + y * pitch * size;
+      uint32_t x = width;
+
+      while (x < towidth)
+      {
+         uint32_t pos = x & maskval;
+         uint32_t count = min_u32(maskval + 1 - pos, towidth - x);
+
+         if (pos < width)
+         {
+            count = min_u32(count, width - pos);
+            copy_run(line, size, x, pos, 1, count);
+         }
+         else
+            copy_run(line, size, x, towidth - pos, -1, count);
+         x += count;
+      }
+   }
+}
+
+void texexpand_wrap_t(void *array, unsigned size, uint32_t height,
+      uint32_t mask, uint32_t toheight, uint32_t pitch)
+{
+   uint32_t maskval = (1 << mask) - 1;
+   uint32_t y;
+
+   for (y = height; y < toheight; y++)
+   {
+      uint32_t srcy = y > maskval ? y & maskval : y - height;
+
+      if (srcy != y)
+         memcpy((uint8_t*)array + y * pitch * size,
+               (uint8_t*)array + srcy * pitch * size, pitch * size);
+   }
+}
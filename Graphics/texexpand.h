@@ -0,0 +1,41 @@
+#ifndef _TEXEXPAND_H
+#define _TEXEXPAND_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Clamp, mirror and wrap expansion of a loaded texture image into the
+ * rest of its surface, as done by Rice's texture manager.
+ *
+ * 'size' is the texel size in bytes, 2 or 4, and 'pitch' the row length
+ * of the surface in texels. The S functions extend the first 'width'
+ * texels of 'rows' rows up to 'towidth'; the T functions extend the first
+ * 'height' rows up to 'toheight', copying whole rows. 'mask' is the log2
+ * of the tile mask size.
+ *
+ * The results are the same as texel by texel loops. Runs of texels are
+ * copied with memcpy, or filled and reversed with SSE2, SSSE3 or NEON. */
+
+void texexpand_clamp_s(void *array, unsigned size, uint32_t width,
+      uint32_t towidth, uint32_t pitch, uint32_t rows);
+void texexpand_clamp_t(void *array, unsigned size, uint32_t height,
+      uint32_t toheight, uint32_t pitch);
+
+void texexpand_mirror_s(void *array, unsigned size, uint32_t width,
+      uint32_t mask, uint32_t towidth, uint32_t pitch, uint32_t rows);
+void texexpand_mirror_t(void *array, unsigned size, uint32_t height,
+      uint32_t mask, uint32_t toheight, uint32_t pitch);
+
+void texexpand_wrap_s(void *array, unsigned size, uint32_t width,
+      uint32_t mask, uint32_t towidth, uint32_t pitch, uint32_t rows);
+void texexpand_wrap_t(void *array, unsigned size, uint32_t height,
+      uint32_t mask, uint32_t toheight, uint32_t pitch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -26,6 +26,7 @@
 #include "../../Graphics/3dmath.h"
 #include "../../Graphics/RDP/gDP_state.h"
 #include "../../Graphics/RSP/gSP_state.h"
+#include "../../Graphics/RSP/gSP_vertex.h"
 #include "../../Graphics/image_convert.h"
 
 //Note: 0xC0 is used by 1080 alot, its an unknown command.
@@ -322,57 +323,134 @@ void gln64gSPClipVertex(uint32_t v)
    if (vtx->w < 0.01f)      vtx->clip |= CLIP_Z;
 }
 
-void gln64gSPProcessVertex(uint32_t v)
+/* Transforms and lights vertices v0 .. v0 + n - 1 of a vertex load.
+ * Transform, normals and directional lights go through the batched
+ * pipeline in Graphics/RSP, the rest is done per vertex. */
+void gln64gSPProcessVertices(uint32_t v0, uint32_t n)
 {
-   
-   float intensity, r, g, b;
-   struct SPVertex *vtx = (struct SPVertex*)&OGL.triangles.vertices[v];
+   unsigned i;
+   struct vertex_batch batch;
+   bool lighting    = (gSP.geometryMode & G_LIGHTING) != 0;
+   bool batch_light = lighting
+      && !(gSP.geometryMode & G_POINT_LIGHTING)
+      && gln64gSPLightVertex == gln64gSPLightVertex_default
+      && !config.generalEmulation.enableHWLighting;
 
    if (gSP.changed & CHANGED_MATRIX)
       gln64gSPCombineMatrices();
 
-   gln64gSPTransformVertex( &vtx->x, gSP.matrix.combined );
+   for (i = 0; i < n; i++)
+   {
+      struct SPVertex *vtx = &OGL.triangles.vertices[v0 + i];
+
+      batch.x[i] = vtx->x;
+      batch.y[i] = vtx->y;
+      batch.z[i] = vtx->z;
 
-   if (gSP.viewport.vscale[0] < 0)
-		vtx->x = -vtx->x;
+      if (lighting)
+      {
+         batch.nx[i] = vtx->nx;
+         batch.ny[i] = vtx->ny;
+         batch.nz[i] = vtx->nz;
+      }
+   }
 
-   if (gSP.matrix.billboard)
+   gSPBatchTransform(&batch, n, gSP.matrix.combined);
+
+   if (lighting)
+      gSPBatchTransformNormals(&batch, n, gSP.matrix.modelView[gSP.matrix.modelViewi]);
+
+   if (batch_light)
    {
-      int i = 0;
+      struct vertex_batch_light lights[12];
+      float ambient[3] = {
+         gSP.lights[gSP.numLights].r,
+         gSP.lights[gSP.numLights].g,
+         gSP.lights[gSP.numLights].b
+      };
 
-      gln64gSPBillboardVertex(v, i);
+      for (i = 0; i < gSP.numLights; i++)
+      {
+         lights[i].dir[0] = gSP.lights[i].x;
+         lights[i].dir[1] = gSP.lights[i].y;
+         lights[i].dir[2] = gSP.lights[i].z;
+         lights[i].col[0] = gSP.lights[i].r;
+         lights[i].col[1] = gSP.lights[i].g;
+         lights[i].col[2] = gSP.lights[i].b;
+      }
+
+      gSPBatchLight(&batch, n, lights, gSP.numLights, ambient);
    }
 
-   gln64gSPClipVertex(v);
+   if (gSP.viewport.vscale[0] < 0)
+      for (i = 0; i < n; i++)
+         batch.x[i] = -batch.x[i];
+
+   /* Billboarding moves the vertices first */
+   if (!gSP.matrix.billboard)
+      gSPBatchClip(&batch, n, 0.01f);
 
-   if (gSP.geometryMode & G_LIGHTING)
+   for (i = 0; i < n; i++)
    {
-      float vPos[3];
-      vPos[0] = (float)vtx->x;
-      vPos[1] = (float)vtx->y;
-      vPos[2] = (float)vtx->z;
-
-      TransformVectorNormalize( &vtx->nx, gSP.matrix.modelView[gSP.matrix.modelViewi] );
-		if (gSP.geometryMode & G_POINT_LIGHTING)
-			gln64gSPPointLightVertex(vtx, vPos);
+      uint32_t v           = v0 + i;
+      struct SPVertex *vtx = &OGL.triangles.vertices[v];
+
+      vtx->x = batch.x[i];
+      vtx->y = batch.y[i];
+      vtx->z = batch.z[i];
+      vtx->w = batch.w[i];
+
+      if (gSP.matrix.billboard)
+      {
+         gln64gSPBillboardVertex(v, 0);
+         gln64gSPClipVertex(v);
+      }
+      else
+         vtx->clip = batch.clip[i];
+
+      if (!lighting)
+      {
+         vtx->HWLight = 0;
+         continue;
+      }
+
+      vtx->nx = batch.nx[i];
+      vtx->ny = batch.ny[i];
+      vtx->nz = batch.nz[i];
+
+      if (batch_light)
+      {
+         vtx->HWLight = 0;
+         vtx->r       = batch.r[i];
+         vtx->g       = batch.g[i];
+         vtx->b       = batch.b[i];
+      }
+      else if (gSP.geometryMode & G_POINT_LIGHTING)
+      {
+         float vPos[3];
+         vPos[0] = (float)vtx->x;
+         vPos[1] = (float)vtx->y;
+         vPos[2] = (float)vtx->z;
+         gln64gSPPointLightVertex(vtx, vPos);
+      }
       else
-			gln64gSPLightVertex(vtx);
+         gln64gSPLightVertex(vtx);
 
       if (/* GBI.isTextureGen() && */ gSP.geometryMode & G_TEXTURE_GEN)
       {
-			float fLightDir[3] = {vtx->nx, vtx->ny, vtx->nz};
-			float x, y;
+         float fLightDir[3] = {vtx->nx, vtx->ny, vtx->nz};
+         float x, y;
 
-			if (gSP.lookatEnable)
+         if (gSP.lookatEnable)
          {
-				x = DotProduct(&gSP.lookat[0].x, fLightDir);
-				y = DotProduct(&gSP.lookat[1].x, fLightDir);
-			}
+            x = DotProduct(&gSP.lookat[0].x, fLightDir);
+            y = DotProduct(&gSP.lookat[1].x, fLightDir);
+         }
          else
          {
-				x = fLightDir[0];
-				y = fLightDir[1];
-			}
+            x = fLightDir[0];
+            y = fLightDir[1];
+         }
 
          if (gSP.geometryMode & G_TEXTURE_GEN_LINEAR)
          {
@@ -386,8 +464,11 @@ void gln64gSPProcessVertex(uint32_t v)
          }
       }
    }
-   else
-		vtx->HWLight = 0;
+}
+
+void gln64gSPProcessVertex(uint32_t v)
+{
+   gln64gSPProcessVertices(v, 1);
 }
 
 void gln64gSPLoadUcodeEx( uint32_t uc_start, uint32_t uc_dstart, uint16_t uc_dsize )
@@ -656,9 +737,10 @@ void gln64gSPVertex( uint32_t v, uint32_t n, uint32_t v0 )
             vtx->a = vertex->color.a * 0.0039215689f;
          }
 
-         gln64gSPProcessVertex(v);
          vertex++;
       }
+
+      gln64gSPProcessVertices(v0, n);
    }
 }
 
@@ -704,9 +786,10 @@ void gln64gSPCIVertex( uint32_t v, uint32_t n, uint32_t v0 )
             vtx->a = color[0] * 0.0039215689f;
          }
 
-         gln64gSPProcessVertex(v);
          vertex++;
       }
+
+      gln64gSPProcessVertices(v0, n);
    }
 }
 
@@ -744,9 +827,10 @@ void gln64gSPDMAVertex( uint32_t v, uint32_t n, uint32_t v0 )
             vtx->a = *(uint8_t*)&gfx_info.RDRAM[(address + 9) ^ 3] * 0.0039215689f;
          }
 
-         gln64gSPProcessVertex(v);
          address += 10;
       }
+
+      gln64gSPProcessVertices(v0, n);
    }
 }
 
@@ -784,9 +868,10 @@ void gln64gSPCBFDVertex( uint32_t a, uint32_t n, uint32_t v0 )
 			vtx->g = vertex->color.g * 0.0039215689f;
 			vtx->b = vertex->color.b * 0.0039215689f;
 			vtx->a = vertex->color.a * 0.0039215689f;
-			gln64gSPProcessVertex(v);
 			vertex++;
 		}
+
+		gln64gSPProcessVertices(v0, n);
 	} else {
 		LOG(LOG_ERROR, "Using Vertex outside buffer v0=%i, n=%i\n", v0, n);
 	}
@@ -21,6 +21,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "ConvertImage.h"
 #include "RenderBase.h"
 
+#include "../../Graphics/texconv.h"
+
 ConvertFunction     gConvertFunctions_FullTMEM[ 8 ][ 4 ] = 
 {
     // 4bpp             8bpp            16bpp               32bpp
@@ -65,63 +67,22 @@ void ConvertRGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
 
-    // Copy of the base pointer
-    uint16_t * pSrc = (uint16_t*)(tinfo.pPhysicalAddress);
+    uint8_t * pByteSrc = (uint8_t *)(tinfo.pPhysicalAddress);
 
-    uint8_t * pByteSrc = (uint8_t *)pSrc;
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    uint32_t nFiddle;
-
-    if (tinfo.bSwapped)
-    {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            if ((y&1) == 0)
-                nFiddle = 0x2;
-            else
-                nFiddle = 0x2 | 0x4;
-
-            // dwDst points to start of destination row
-            uint32_t * dwDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y*dInfo.lPitch);
-
-            // DWordOffset points to the current dword we're looking at
-            // (process 2 pixels at a time). May be a problem if we don't start on even pixel
-            uint32_t dwWordOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad * 2);
-
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint16_t w = *(uint16_t *)&pByteSrc[dwWordOffset ^ nFiddle];
-
-                dwDst[x] = Convert555ToRGBA(w);
-                
-                // Increment word offset to point to the next two pixels
-                dwWordOffset += 2;
-            }
-        }
-    }
-    else
+    for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            // dwDst points to start of destination row
-            uint32_t * dwDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y*dInfo.lPitch);
+        // For odd lines, swap words too
+        uint32_t nFiddle = (tinfo.bSwapped && (y&1)) ? 0x6 : 0x2;
 
-            // DWordOffset points to the current dword we're looking at
-            // (process 2 pixels at a time). May be a problem if we don't start on even pixel
-            uint32_t dwWordOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad * 2);
+        // dwDst points to start of destination row
+        uint32_t * dwDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y*dInfo.lPitch);
 
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint16_t w = *(uint16_t *)&pByteSrc[dwWordOffset ^ 0x2];
+        uint32_t dwWordOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad * 2);
 
-                dwDst[x] = Convert555ToRGBA(w);
-                
-                // Increment word offset to point to the next two pixels
-                dwWordOffset += 2;
-            }
-        }
+        texconv_rgba16(dwDst, pByteSrc, dwWordOffset, nFiddle, tinfo.WidthToLoad, 0);
     }
 
     pTexture->EndUpdate(&dInfo);
@@ -229,12 +190,18 @@ void ConvertRGBA32(CTexture *pTexture, const TxtrInfo &tinfo)
     pTexture->SetOthersVariables();
 }
 
+// 4-bit rows are decoded two texels at a time; odd widths round up
+// except for the single texel corner case.
+static inline uint32_t Width4b(const TxtrInfo &tinfo)
+{
+    return tinfo.WidthToLoad == 1 ? 1 : (tinfo.WidthToLoad + 1) & ~1;
+}
+
 // E.g. Dear Mario text
 // Copy, Score etc
 void ConvertIA4(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32_t nFiddle;
 
     uint8_t * pSrc = (uint8_t*)(tinfo.pPhysicalAddress);
 
@@ -245,88 +212,16 @@ void ConvertIA4(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
-    {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8_t *pDst = (uint8_t *)dInfo.lpSurface + y * dInfo.lPitch;
-
-            // For odd lines, swap words too
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
-
-
-            // This may not work if X is not even?
-            uint32_t dwByteOffset = (y+tinfo.TopToLoad) * tinfo.Pitch + (tinfo.LeftToLoad/2);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = OneToEight[(b & 0x10) >> 4];  
-            }
-            else for (uint32_t x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // Do two pixels at a time
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
-
-                // Even
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = OneToEight[(b & 0x10) >> 4];  
-                // Odd
-                *pDst++ = ThreeToEight[(b & 0x0E) >> 1];
-                *pDst++ = ThreeToEight[(b & 0x0E) >> 1];
-                *pDst++ = ThreeToEight[(b & 0x0E) >> 1];
-                *pDst++ = OneToEight[(b & 0x01)     ];
-
-                dwByteOffset++;
-            }
-        }
-    }
-    else
+    for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8_t *pDst = (uint8_t *)dInfo.lpSurface + (y * dInfo.lPitch);
+        // For odd lines, swap words too
+        uint32_t nFiddle = (tinfo.bSwapped && (y&1)) ? 0x7 : 0x3;
+        uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
 
-            // This may not work if X is not even?
-            uint32_t dwByteOffset = (y+tinfo.TopToLoad) * tinfo.Pitch + (tinfo.LeftToLoad/2);
+        // This may not work if X is not even?
+        uint32_t dwByteOffset = (y+tinfo.TopToLoad) * tinfo.Pitch + (tinfo.LeftToLoad/2);
 
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8_t b = pSrc[dwByteOffset ^ 0x3];
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = OneToEight[(b & 0x10) >> 4];  
-            }
-            else for (uint32_t x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // Do two pixels at a time
-                uint8_t b = pSrc[dwByteOffset ^ 0x3];
-
-                // Even
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = ThreeToEight[(b & 0xE0) >> 5];
-                *pDst++ = OneToEight[(b & 0x10) >> 4];  
-                // Odd
-                *pDst++ = ThreeToEight[(b & 0x0E) >> 1];
-                *pDst++ = ThreeToEight[(b & 0x0E) >> 1];
-                *pDst++ = ThreeToEight[(b & 0x0E) >> 1];
-                *pDst++ = OneToEight[(b & 0x01)     ];
-
-                dwByteOffset++;
-            }
-        }
+        texconv_ia4(pDst, pSrc, dwByteOffset, nFiddle, Width4b(tinfo));
     }
 
     pTexture->EndUpdate(&dInfo);
@@ -338,7 +233,6 @@ void ConvertIA4(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertIA8(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32_t nFiddle;
 
     uint8_t * pSrc = (uint8_t*)(tinfo.pPhysicalAddress);
 
@@ -349,57 +243,18 @@ void ConvertIA8(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
+    for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            // For odd lines, swap words too
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
-
-            uint8_t *pDst = (uint8_t *)dInfo.lpSurface + y * dInfo.lPitch;
-            // Points to current byte
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
-                uint8_t I = FourToEight[(b & 0xf0)>>4];
+        // For odd lines, swap words too
+        uint32_t nFiddle = (tinfo.bSwapped && (y&1)) ? 0x7 : 0x3;
+        uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
 
-                *pDst++ = I;
-                *pDst++ = I;
-                *pDst++ = I;
-                *pDst++ = FourToEight[(b & 0x0f)   ];
+        // Points to current byte
+        uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
 
-                dwByteOffset++;
-            }
-        }
+        texconv_ia8(pDst, pSrc, dwByteOffset, nFiddle, tinfo.WidthToLoad);
     }
-    else
-    {
-        const uint8_t* FourToEightArray = &FourToEight[0];
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8_t *pDst = (uint8_t *)dInfo.lpSurface + y * dInfo.lPitch;
-
-            // Points to current byte
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8_t b = pSrc[(dwByteOffset++) ^ 0x3];
-                uint8_t I = *(FourToEightArray+(b>>4));
 
-                *pDst++ = I;
-                *pDst++ = I;
-                *pDst++ = I;
-                *pDst++ = *(FourToEightArray+(b&0xF));
-            }
-        }
-    }   
-    
     pTexture->EndUpdate(&dInfo);
     pTexture->SetOthersVariables();
 
@@ -409,65 +264,23 @@ void ConvertIA8(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertIA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32_t nFiddle;
 
-    uint16_t * pSrc = (uint16_t*)(tinfo.pPhysicalAddress);
-    uint8_t * pByteSrc = (uint8_t *)pSrc;
+    uint8_t * pByteSrc = (uint8_t *)(tinfo.pPhysicalAddress);
 
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
-    {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8_t *pDst = (uint8_t *)dInfo.lpSurface + y * dInfo.lPitch;
-
-            if ((y%2) == 0)
-                nFiddle = 0x2;
-            else
-                nFiddle = 0x4 | 0x2;
-
-            // Points to current word
-            uint32_t dwWordOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad * 2);
-
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint16_t w = *(uint16_t *)&pByteSrc[dwWordOffset^nFiddle];
-
-                *pDst++ = (uint8_t)(w >> 8);
-                *pDst++ = (uint8_t)(w >> 8);
-                *pDst++ = (uint8_t)(w >> 8);
-                *pDst++ = (uint8_t)(w & 0xFF);
-
-                dwWordOffset += 2;
-            }
-        }
-    }
-    else
+    for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8_t *pDst = (uint8_t *)dInfo.lpSurface + y * dInfo.lPitch;
+        uint32_t nFiddle = (tinfo.bSwapped && (y&1)) ? 0x6 : 0x2;
+        uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
 
-            // Points to current word
-            uint32_t dwWordOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad * 2);
-
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint16_t w = *(uint16_t *)&pByteSrc[dwWordOffset^0x2];
+        // Points to current word
+        uint32_t dwWordOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad * 2);
 
-                *pDst++ = (uint8_t)(w >> 8);
-                *pDst++ = (uint8_t)(w >> 8);
-                *pDst++ = (uint8_t)(w >> 8);
-                *pDst++ = (uint8_t)(w & 0xFF);
-
-                dwWordOffset += 2;
-            }
-        }       
+        texconv_ia16(pDst, pByteSrc, dwWordOffset, nFiddle, tinfo.WidthToLoad);
     }
 
-
     pTexture->EndUpdate(&dInfo);
     pTexture->SetOthersVariables();
 }
@@ -478,7 +291,6 @@ void ConvertIA16(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertI4(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32_t nFiddle;
 
     uint8_t * pSrc = (uint8_t*)(tinfo.pPhysicalAddress);
 
@@ -489,100 +301,28 @@ void ConvertI4(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
+    for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8_t *pDst = (uint8_t *)dInfo.lpSurface + y * dInfo.lPitch;
+        uint32_t nFiddle = 0x3;
+        uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
 
-            // Might not work with non-even starting X
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
+        // Might not work with non-even starting X
+        uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
 
-            // For odd lines, swap words too
+        // For odd lines, swap words too
+        if (tinfo.bSwapped)
+        {
             if( !conkerSwapHack || (y&4) == 0 )
-            {
-                if ((y%2) == 0)
-                    nFiddle = 0x3;
-                else
-                    nFiddle = 0x7;
-            }
+                nFiddle = (y&1) ? 0x7 : 0x3;
             else
-            {
-                if ((y%2) == 1)
-                    nFiddle = 0x3;
-                else
-                    nFiddle = 0x7;
-            }
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   
-            }
-            else for (uint32_t x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two pixels at a time
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
-
-                // Even
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   // Other implementations seem to or in (b&0xF0)>>4
-                *pDst++ = FourToEight[(b & 0xF0)>>4]; // why?
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   
-                // Odd
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-
-                dwByteOffset++;
-            }
+                nFiddle = (y&1) ? 0x3 : 0x7;
         }
 
-        conkerSwapHack = false;
+        texconv_i4(pDst, pSrc, dwByteOffset, nFiddle, Width4b(tinfo));
     }
-    else
-    {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8_t *pDst = (uint8_t *)dInfo.lpSurface + y * dInfo.lPitch;
 
-            // Might not work with non-even starting X
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8_t b = pSrc[dwByteOffset ^ 0x3];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   
-            }
-            else for (uint32_t x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two pixels at a time
-                uint8_t b = pSrc[dwByteOffset ^ 0x3];
-
-                // Even
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   // Other implementations seem to or in (b&0xF0)>>4
-                *pDst++ = FourToEight[(b & 0xF0)>>4]; // why?
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   
-                // Odd
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-
-                dwByteOffset++;
-            }
-        }
-    }
+    if (tinfo.bSwapped)
+        conkerSwapHack = false;
 
     pTexture->EndUpdate(&dInfo);
     pTexture->SetOthersVariables();
@@ -592,58 +332,23 @@ void ConvertI4(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertI8(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32_t nFiddle;
 
-    int64_t pSrc = (int64_t) tinfo.pPhysicalAddress;
+    // The swizzle applies to the address rather than the offset here,
+    // so decode from the 16 byte boundary below the source.
+    uint32_t nMisalign = (uint32_t)((uintptr_t)tinfo.pPhysicalAddress & 0xF);
+    uint8_t * pBase = (uint8_t*)tinfo.pPhysicalAddress - nMisalign;
+
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
-    {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
-
-            uint8_t *pDst = (uint8_t *)dInfo.lpSurface + y * dInfo.lPitch;
-
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8_t b = *(uint8_t*)((pSrc+dwByteOffset)^nFiddle);
-
-                *pDst++ = b;
-                *pDst++ = b;
-                *pDst++ = b;
-                *pDst++ = b;        // Alpha not 255?
-
-                dwByteOffset++;
-            }
-        }
-    }
-    else
+    for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8_t *pDst = (uint8_t *)dInfo.lpSurface + y * dInfo.lPitch;
-
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8_t b = *(uint8_t*)((pSrc+dwByteOffset)^0x3);
+        uint32_t nFiddle = (tinfo.bSwapped && (y&1)) ? 0x7 : 0x3;
+        uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
 
-                *pDst++ = b;
-                *pDst++ = b;
-                *pDst++ = b;
-                *pDst++ = b;        // Alpha not 255?
+        uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
 
-                dwByteOffset++;
-            }
-        }
+        texconv_i8(pDst, pBase, dwByteOffset + nMisalign, nFiddle, tinfo.WidthToLoad);
     }
 
     pTexture->EndUpdate(&dInfo);
@@ -685,7 +390,7 @@ void ConvertCI8( CTexture * p_texture, const TxtrInfo & tinfo )
 void ConvertCI4_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32_t nFiddle;
+    uint32_t pal[16];
 
     uint8_t * pSrc = (uint8_t*)(tinfo.pPhysicalAddress);
     uint16_t * pPal = (uint16_t *)tinfo.PalAddress;
@@ -694,94 +399,19 @@ void ConvertCI4_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
-    {
-        for (uint32_t y = 0; y <  tinfo.HeightToLoad; y++)
-        {
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
-
-            uint32_t * pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
-                uint8_t bhi = (b&0xf0)>>4;
-                *pDst = Convert555ToRGBA(pPal[bhi^1]);    // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                {
-                    *pDst |= 0xFF000000;
-                }
-            }
-            else for (uint32_t x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two at a time
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
-
-                uint8_t bhi = (b&0xf0)>>4;
-                uint8_t blo = (b&0x0f);
-
-                pDst[0] = Convert555ToRGBA(pPal[bhi^1]);    // Remember palette is in different endian order!
-                pDst[1] = Convert555ToRGBA(pPal[blo^1]);    // Remember palette is in different endian order!
-
-                if( bIgnoreAlpha )
-                {
-                    pDst[0] |= 0xFF000000;
-                    pDst[1] |= 0xFF000000;
-                }
+    // Remember palette is in different endian order!
+    texconv_palette_rgba16(pal, pPal, 16, 1, bIgnoreAlpha ? TEXCONV_OPAQUE : 0);
 
-                pDst+=2;
-
-                dwByteOffset++;
-            }
-        }
-    }
-    else
+    for (uint32_t y = 0; y <  tinfo.HeightToLoad; y++)
     {
-        for (uint32_t y = 0; y <  tinfo.HeightToLoad; y++)
-        {
-            uint32_t * pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8_t b = pSrc[dwByteOffset ^ 0x3];
-                uint8_t bhi = (b&0xf0)>>4;
-                *pDst = Convert555ToRGBA(pPal[bhi^1]);    // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                {
-                    *pDst |= 0xFF000000;
-                }
-            }
-            else for (uint32_t x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two at a time
-                uint8_t b = pSrc[dwByteOffset ^ 0x3];
-
-                uint8_t bhi = (b&0xf0)>>4;
-                uint8_t blo = (b&0x0f);
-
-                pDst[0] = Convert555ToRGBA(pPal[bhi^1]);    // Remember palette is in different endian order!
-                pDst[1] = Convert555ToRGBA(pPal[blo^1]);    // Remember palette is in different endian order!
-                
-                if( bIgnoreAlpha )
-                {
-                    pDst[0] |= 0xFF000000;
-                    pDst[1] |= 0xFF000000;
-                }
+        uint32_t nFiddle = (tinfo.bSwapped && (y&1)) ? 0x7 : 0x3;
+        uint32_t * pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
 
-                pDst+=2;
+        uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch);
+        if (!tinfo.bSwapped)
+            dwByteOffset += (tinfo.LeftToLoad / 2);
 
-                dwByteOffset++;
-            }
-        }
+        texconv_ci4(pDst, pSrc, dwByteOffset, nFiddle, Width4b(tinfo), pal);
     }
     pTexture->EndUpdate(&dInfo);
     pTexture->SetOthersVariables();
@@ -791,7 +421,7 @@ void ConvertCI4_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertCI4_IA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32_t nFiddle;
+    uint32_t pal[16];
 
     uint8_t * pSrc = (uint8_t*)(tinfo.pPhysicalAddress);
 
@@ -805,90 +435,17 @@ void ConvertCI4_IA16(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
-    {
-        for (uint32_t y = 0; y <  tinfo.HeightToLoad; y++)
-        {
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
-
-            uint32_t * pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
-                uint8_t bhi = (b&0xf0)>>4;
-                *pDst = ConvertIA16ToRGBA(pPal[bhi^1]);   // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                    *pDst |= 0xFF000000;
-            }
-            else for (uint32_t x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two at a time
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
-
-                uint8_t bhi = (b&0xf0)>>4;
-                uint8_t blo = (b&0x0f);
-
-                pDst[0] = ConvertIA16ToRGBA(pPal[bhi^1]);   // Remember palette is in different endian order!
-                pDst[1] = ConvertIA16ToRGBA(pPal[blo^1]);   // Remember palette is in different endian order!
-                
-                if( bIgnoreAlpha )
-                {
-                    pDst[0] |= 0xFF000000;
-                    pDst[1] |= 0xFF000000;
-                }
-
-                pDst+=2;
+    // Remember palette is in different endian order!
+    texconv_palette_ia16(pal, pPal, 16, 1, bIgnoreAlpha ? TEXCONV_OPAQUE : 0);
 
-                dwByteOffset++;
-            }
-        }
-    }
-    else
+    for (uint32_t y = 0; y <  tinfo.HeightToLoad; y++)
     {
-        for (uint32_t y = 0; y <  tinfo.HeightToLoad; y++)
-        {
-            uint32_t * pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8_t b = pSrc[dwByteOffset ^ 0x3];
-                uint8_t bhi = (b&0xf0)>>4;
-                *pDst = ConvertIA16ToRGBA(pPal[bhi^1]);   // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                    *pDst |= 0xFF000000;
-            }
-            else for (uint32_t x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two pixels at a time
-                uint8_t b = pSrc[dwByteOffset ^ 0x3];
-
-                uint8_t bhi = (b&0xf0)>>4;
-                uint8_t blo = (b&0x0f);
-
-                pDst[0] = ConvertIA16ToRGBA(pPal[bhi^1]);   // Remember palette is in different endian order!
-                pDst[1] = ConvertIA16ToRGBA(pPal[blo^1]);   // Remember palette is in different endian order!
-                
-                if( bIgnoreAlpha )
-                {
-                    pDst[0] |= 0xFF000000;
-                    pDst[1] |= 0xFF000000;
-                }
+        uint32_t nFiddle = (tinfo.bSwapped && (y&1)) ? 0x7 : 0x3;
+        uint32_t * pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
 
-                pDst+=2;
+        uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
 
-                dwByteOffset++;
-            }
-        }
+        texconv_ci4(pDst, pSrc, dwByteOffset, nFiddle, Width4b(tinfo), pal);
     }
     pTexture->EndUpdate(&dInfo);
     pTexture->SetOthersVariables();
@@ -899,7 +456,7 @@ void ConvertCI4_IA16(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertCI8_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32_t nFiddle;
+    uint32_t pal[256];
 
     uint8_t * pSrc = (uint8_t*)(tinfo.pPhysicalAddress);
 
@@ -912,56 +469,18 @@ void ConvertCI8_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 
     if (!pTexture->StartUpdate(&dInfo))
         return;
-    
-    if (tinfo.bSwapped)
-    {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
 
-            uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
+    // Remember palette is in different endian order!
+    texconv_palette_rgba16(pal, pPal, 256, 1, bIgnoreAlpha ? TEXCONV_OPAQUE : 0);
 
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-            
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
-
-                *pDst++ = Convert555ToRGBA(pPal[b^1]);  // Remember palette is in different endian order!
-                
-                if( bIgnoreAlpha )
-                {
-                    *(pDst-1) |= 0xFF000000;
-                }
-
-                dwByteOffset++;
-            }
-        }
-    }
-    else
+    for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
+        uint32_t nFiddle = (tinfo.bSwapped && (y&1)) ? 0x7 : 0x3;
+        uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
 
-            int dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-            
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8_t b = pSrc[dwByteOffset ^ 0x3];
+        uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
 
-                *pDst++ = Convert555ToRGBA(pPal[b^1]);  // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                {
-                    *(pDst-1) |= 0xFF000000;
-                }
-
-                dwByteOffset++;
-            }
-        }
+        texconv_ci8(pDst, pSrc, dwByteOffset, nFiddle, tinfo.WidthToLoad, pal);
     }
 
     pTexture->EndUpdate(&dInfo);
@@ -974,7 +493,7 @@ void ConvertCI8_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertCI8_IA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32_t nFiddle;
+    uint32_t pal[256];
 
     uint8_t * pSrc = (uint8_t*)(tinfo.pPhysicalAddress);
 
@@ -988,60 +507,24 @@ void ConvertCI8_IA16(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
-    {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
-
-            uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-            
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8_t b = pSrc[dwByteOffset ^ nFiddle];
+    // Remember palette is in different endian order!
+    texconv_palette_ia16(pal, pPal, 256, 1, bIgnoreAlpha ? TEXCONV_OPAQUE : 0);
 
-                *pDst++ = ConvertIA16ToRGBA(pPal[b^1]); // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                {
-                    *(pDst-1) |= 0xFF000000;
-                }
-
-                dwByteOffset++;
-            }
-        }
-    }
-    else
+    for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32_t y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-            
-            for (uint32_t x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8_t b = pSrc[dwByteOffset ^ 0x3];
+        uint32_t nFiddle = (tinfo.bSwapped && (y&1)) ? 0x7 : 0x3;
+        uint32_t *pDst = (uint32_t *)((uint8_t *)dInfo.lpSurface + y * dInfo.lPitch);
 
-                *pDst++ = ConvertIA16ToRGBA(pPal[b^1]); // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                {
-                    *(pDst-1) |= 0xFF000000;
-                }
+        uint32_t dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
 
-                dwByteOffset++;
-            }
-        }
+        texconv_ci8(pDst, pSrc, dwByteOffset, nFiddle, tinfo.WidthToLoad, pal);
     }
 
     pTexture->EndUpdate(&dInfo);
     pTexture->SetOthersVariables();
 }
 
+
 void ConvertYUV(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
@@ -17,71 +17,37 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 */
 
-#include <math.h>
-
 #include "ConvertImage.h"
 #include "DeviceBuilder.h"
 #include "FrameBuffer.h"
 #include "RenderBase.h"
 #include "TextureManager.h"
 
+#include "../../Graphics/texexpand.h"
+
 CTextureManager gTextureManager;
 
-unsigned int g_maxTextureMemUsage = (5*1024*1024);
+// Bytes of texture memory the cache may hold before it starts evicting the
+// least recently used entries, and how much extra to free once it does
+unsigned int g_maxTextureMemUsage = (64*1024*1024);
 unsigned int g_amountToFree = (512*1024);
-bool g_bUseSetTextureMem = false;
-
-// Returns the first prime greater than or equal to nFirst
-inline int GetNextPrime(int nFirst)
-{
-   int nCurrent = nFirst;
-
-   // Just make sure it's odd
-   if ((nCurrent % 2) == 0)
-      nCurrent++;
 
-   for (;;)
-   {
-      // nSqrtCurrent = nCurrent^0.5 + 1 (round up)
-      int nSqrtCurrent  = (int)sqrt((double)nCurrent) + 1;
-      bool bIsComposite = false;
-
-      // Test all odd numbers from 3..nSqrtCurrent
-      for (int i = 3; i <= nSqrtCurrent; i+=2)
-      {
-         if ((nCurrent % i) == 0)
-         {
-            bIsComposite = true;
-            break;
-         }
-      }
-
-      if (!bIsComposite)
-         return nCurrent;
-
-      // Select next odd candidate...
-      nCurrent += 2;
-   }
-}
+#define TXTR_CACHE_MIN_SLOTS    1024
 
 ///////////////////////////////////////////////////////////////////////
 //
 ///////////////////////////////////////////////////////////////////////
 CTextureManager::CTextureManager() :
-    m_pHead(NULL),
     m_pCacheTxtrList(NULL),
-    m_numOfCachedTxtrList(809)
+    m_numOfCachedTxtrList(TXTR_CACHE_MIN_SLOTS)
 {
-    m_numOfCachedTxtrList = GetNextPrime(800);
-
     m_currentTextureMemUsage    = 0;
     m_pYoungestTexture          = NULL;
     m_pOldestTexture            = NULL;
 
-    m_pCacheTxtrList = new TxtrCacheEntry *[m_numOfCachedTxtrList];
-
-    for (uint32_t i = 0; i < m_numOfCachedTxtrList; i++)
-        m_pCacheTxtrList[i] = NULL;
+    m_pCacheTxtrList = new TxtrCacheSlot[m_numOfCachedTxtrList];
+    memset(m_pCacheTxtrList, 0, m_numOfCachedTxtrList * sizeof(TxtrCacheSlot));
+    memset(&m_stats, 0, sizeof(m_stats));
 
     memset(&m_blackTextureEntry, 0, sizeof(TxtrCacheEntry));
     memset(&m_PrimColorTextureEntry, 0, sizeof(TxtrCacheEntry));
@@ -104,17 +70,6 @@ bool CTextureManager::CleanUp()
 {
     RecycleAllTextures();
 
-    if (!g_bUseSetTextureMem)
-    {
-        while (m_pHead)
-        {
-            TxtrCacheEntry * pVictim = m_pHead;
-            m_pHead = pVictim->pNext;
-
-            delete pVictim;
-        }
-    }
-
     if( m_blackTextureEntry.pTexture )      delete m_blackTextureEntry.pTexture;    
     if( m_PrimColorTextureEntry.pTexture )  delete m_PrimColorTextureEntry.pTexture;
     if( m_EnvColorTextureEntry.pTexture )   delete m_EnvColorTextureEntry.pTexture;
@@ -143,57 +98,21 @@ bool CTextureManager::TCacheEntryIsLoaded(TxtrCacheEntry *pEntry)
 // Purge any textures whos last usage was over 5 seconds ago
 void CTextureManager::PurgeOldTextures()
 {
-    if (m_pCacheTxtrList == NULL)
-        return;
-    
-    if (g_bUseSetTextureMem)
-        return;
-
     static const uint32_t dwFramesToKill = 5*30;          // 5 secs at 30 fps
-    static const uint32_t dwFramesToDelete = 30*30;       // 30 secs at 30 fps
-    
-    for ( uint32_t i = 0; i < m_numOfCachedTxtrList; i++ )
-    {
-        TxtrCacheEntry * pEntry;
-        TxtrCacheEntry * pNext;
-        
-        pEntry = m_pCacheTxtrList[i];
-        while (pEntry)
-        {
-            pNext = pEntry->pNext;
-            
-            if ( status.gDlistCount - pEntry->FrameLastUsed > dwFramesToKill && !TCacheEntryIsLoaded(pEntry))
-                RemoveTexture(pEntry);
-            pEntry = pNext;
-        }
-    }
-    
-    
-    // Remove any old textures that haven't been recycled in 1 minute or so
-    // Normally these would be reused
-    TxtrCacheEntry* pPrev = NULL;
-    TxtrCacheEntry* pCurr = m_pHead;
-    TxtrCacheEntry * pNext;
 
-    while (pCurr)
+    // The age list is ordered by last use, so stop at the first texture
+    // that is still fresh
+    TxtrCacheEntry *pEntry = m_pOldestTexture;
+    while (pEntry && status.gDlistCount - pEntry->FrameLastUsed > dwFramesToKill)
     {
-        pNext = pCurr->pNext;
-        
-        if ( status.gDlistCount - pCurr->FrameLastUsed > dwFramesToDelete && !TCacheEntryIsLoaded(pCurr) )
-        {
-            if (pPrev != NULL)
-               pPrev->pNext = pCurr->pNext;
-            else
-               m_pHead      = pCurr->pNext;
-            
-            delete pCurr;
-            pCurr = pNext;  
-        }
-        else
+        TxtrCacheEntry *pNext = pEntry->pNextYoungest;
+
+        if (!TCacheEntryIsLoaded(pEntry))
         {
-            pPrev = pCurr;
-            pCurr = pNext;
+            RemoveTexture(pEntry);
+            m_stats.dwPurges++;
         }
+        pEntry = pNext;
     }
 }
 
@@ -204,117 +123,108 @@ void CTextureManager::RecycleAllTextures()
     
     uint32_t dwCount = 0;
     uint32_t dwTotalUses = 0;
-    
-    m_pYoungestTexture          = NULL;
-    m_pOldestTexture            = NULL;
 
-    for (uint32_t i = 0; i < m_numOfCachedTxtrList; i++)
+    while (m_pOldestTexture)
     {
-        while (m_pCacheTxtrList[i])
-        {
-            TxtrCacheEntry *pTVictim = m_pCacheTxtrList[i];
-            m_pCacheTxtrList[i] = pTVictim->pNext;
-            
-            dwTotalUses += pTVictim->dwUses;
-            dwCount++;
-            if (g_bUseSetTextureMem)
-                delete pTVictim;
-            else
-               RecycleTexture(pTVictim);
-        }
+        TxtrCacheEntry *pTVictim = m_pOldestTexture;
+        m_pOldestTexture = pTVictim->pNextYoungest;
+
+        dwTotalUses += pTVictim->dwUses;
+        dwCount++;
+        RecycleTexture(pTVictim);
     }
+
+    if (dwCount)
+        DebugMessage(M64MSG_VERBOSE, "Texture cache: %u textures, %u uses, %u hits, %u misses, %u evicted, %u purged, peak %u KB",
+              dwCount, dwTotalUses, m_stats.dwHits, m_stats.dwMisses, m_stats.dwEvictions, m_stats.dwPurges, m_stats.dwPeakBytes >> 10);
+
+    m_pYoungestTexture          = NULL;
+    m_pOldestTexture            = NULL;
+    m_currentTextureMemUsage    = 0;
+    m_stats.dwEntries           = 0;
+    m_stats.dwBytes             = 0;
+    memset(m_pCacheTxtrList, 0, m_numOfCachedTxtrList * sizeof(TxtrCacheSlot));
 }
 
 void CTextureManager::RecheckHiresForAllTextures()
 {
-    if (m_pCacheTxtrList == NULL)
-        return;
+    TxtrCacheEntry *pEntry;
 
-    for (uint32_t i = 0; i < m_numOfCachedTxtrList; i++)
-    {
-        while (m_pCacheTxtrList[i])
-        {
-            TxtrCacheEntry *pTVictim = m_pCacheTxtrList[i];
-            m_pCacheTxtrList[i] = pTVictim->pNext;
-            pTVictim->bExternalTxtrChecked = false;
+    for (pEntry = m_pOldestTexture; pEntry; pEntry = pEntry->pNextYoungest)
+        pEntry->bExternalTxtrChecked = false;
+}
 
-        }
-    }
+void CTextureManager::GetStats(TextureCacheStats *stats)
+{
+    m_stats.dwBytes = m_currentTextureMemUsage;
+    *stats = m_stats;
+}
+
+void CTextureManager::ResetStats()
+{
+    uint32_t dwEntries = m_stats.dwEntries;
+
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.dwEntries   = dwEntries;
+    m_stats.dwBytes     = m_currentTextureMemUsage;
+    m_stats.dwPeakBytes = m_currentTextureMemUsage;
 }
 
 
-// Add to the recycle list
 void CTextureManager::RecycleTexture(TxtrCacheEntry *pEntry)
 {
-   if (g_bUseSetTextureMem)
-      return;
-
    // Fix me, why I can not reuse the texture in OpenGL,
    // how can I unload texture from video card memory for OpenGL
    delete pEntry;
 }
 
-// Search for a texture of the specified dimensions to recycle
-TxtrCacheEntry * CTextureManager::ReviveTexture( uint32_t width, uint32_t height )
+
+uint32_t CTextureManager::Hash(const TxtrInfo &ti)
 {
-    if (g_bUseSetTextureMem)
-        return NULL;
+    // Only fields that operator== compares and that stay put while the
+    // entry is in the table. Most textures are on a 4 byte boundary, so
+    // the bottom bits of the address carry little information.
+    uint32_t h = (ti.Address >> 2) * 0x9E3779B1u;
+    h ^= (ti.WidthToCreate | (ti.HeightToCreate << 16)) * 0x85EBCA77u;
+    h ^= (ti.Format | (ti.Size << 4) | (ti.TLutFmt << 8) | (ti.Palette << 16)) * 0xC2B2AE3Du;
+    h ^= (ti.maskS | (ti.maskT << 8)) * 0x27D4EB2Fu;
+    return h ^ (h >> 15);
+}
 
-    TxtrCacheEntry* pPrev = NULL;
-    TxtrCacheEntry* pCurr = m_pHead;
+void CTextureManager::GrowTable()
+{
+    TxtrCacheSlot *pOld = m_pCacheTxtrList;
+    uint32_t dwOldSize = m_numOfCachedTxtrList;
+    uint32_t dwMask;
 
-    while (pCurr)
+    m_numOfCachedTxtrList = dwOldSize * 2;
+    m_pCacheTxtrList = new TxtrCacheSlot[m_numOfCachedTxtrList];
+    memset(m_pCacheTxtrList, 0, m_numOfCachedTxtrList * sizeof(TxtrCacheSlot));
+    dwMask = m_numOfCachedTxtrList - 1;
+
+    for (uint32_t i = 0; i < dwOldSize; i++)
     {
-        if (pCurr->ti.WidthToCreate == width &&
-            pCurr->ti.HeightToCreate == height)
-        {
-            // Remove from list
-            if (pPrev != NULL) pPrev->pNext        = pCurr->pNext;
-            else               m_pHead = pCurr->pNext;
-            
-            return pCurr;
-        }
-        
-        pPrev = pCurr;
-        pCurr = pCurr->pNext;
-    }
-    
-    return NULL;
-}
+        uint32_t j;
 
+        if (pOld[i].pEntry == NULL)
+            continue;
 
-uint32_t CTextureManager::Hash(uint32_t dwValue)
-{
-    // Divide by four, because most textures will be on a 4 byte boundry, so bottom four
-    // bits are null
-    return (dwValue>>2) % m_numOfCachedTxtrList;
+        for (j = pOld[i].dwHash & dwMask; m_pCacheTxtrList[j].pEntry; j = (j + 1) & dwMask)
+            ;
+        m_pCacheTxtrList[j] = pOld[i];
+    }
+
+    delete []pOld;
 }
 
 void CTextureManager::MakeTextureYoungest(TxtrCacheEntry *pEntry)
 {
-    if (!g_bUseSetTextureMem)
-        return;
-
     if (pEntry == m_pYoungestTexture)
         return;
 
-    // if its the oldest, then change the oldest pointer
-    if (pEntry == m_pOldestTexture)
-        m_pOldestTexture = pEntry->pNextYoungest;
-
     // if its a not a new texture, close the gap in the age list
     // where pEntry use to reside
-    if (pEntry->pNextYoungest != NULL || pEntry->pLastYoungest != NULL)
-    {
-        if (pEntry->pNextYoungest != NULL)
-        {
-            pEntry->pNextYoungest->pLastYoungest = pEntry->pLastYoungest;
-        }
-        if (pEntry->pLastYoungest != NULL)
-        {
-            pEntry->pLastYoungest->pNextYoungest = pEntry->pNextYoungest;
-        }
-    }
+    UnlinkTexture(pEntry);
 
     // this texture is now the youngest, so place it on the end of the list
     if (m_pYoungestTexture != NULL)
@@ -331,18 +241,45 @@ void CTextureManager::MakeTextureYoungest(TxtrCacheEntry *pEntry)
     }
 }
 
+void CTextureManager::UnlinkTexture(TxtrCacheEntry *pEntry)
+{
+    if (pEntry == m_pOldestTexture)
+        m_pOldestTexture = pEntry->pNextYoungest;
+    if (pEntry == m_pYoungestTexture)
+        m_pYoungestTexture = pEntry->pLastYoungest;
+
+    if (pEntry->pNextYoungest != NULL)
+        pEntry->pNextYoungest->pLastYoungest = pEntry->pLastYoungest;
+    if (pEntry->pLastYoungest != NULL)
+        pEntry->pLastYoungest->pNextYoungest = pEntry->pNextYoungest;
+
+    pEntry->pNextYoungest = NULL;
+    pEntry->pLastYoungest = NULL;
+}
+
 void CTextureManager::AddTexture(TxtrCacheEntry *pEntry)
 {   
-    uint32_t dwKey = Hash(pEntry->ti.Address);
-    
+    uint32_t dwHash = Hash(pEntry->ti);
+    uint32_t dwMask;
+    uint32_t i;
+
     if (m_pCacheTxtrList == NULL)
         return;
-    
-    //TxtrCacheEntry **p = &m_pCacheTxtrList[dwKey];
-    
-    // Add to head (not tail, for speed - new textures are more likely to be accessed next)
-    pEntry->pNext = m_pCacheTxtrList[dwKey];
-    m_pCacheTxtrList[dwKey] = pEntry;
+
+    // Keep the load factor under 3/4 so that probe runs stay short
+    if ((m_stats.dwEntries + 1) * 4 > m_numOfCachedTxtrList * 3)
+        GrowTable();
+
+    dwMask = m_numOfCachedTxtrList - 1;
+    for (i = dwHash & dwMask; m_pCacheTxtrList[i].pEntry; i = (i + 1) & dwMask)
+        ;
+    m_pCacheTxtrList[i].dwHash = dwHash;
+    m_pCacheTxtrList[i].pEntry = pEntry;
+    m_stats.dwEntries++;
+
+    m_currentTextureMemUsage += pEntry->dwMemSize;
+    if (m_currentTextureMemUsage > m_stats.dwPeakBytes)
+        m_stats.dwPeakBytes = m_currentTextureMemUsage;
 
     // Move the texture to the top of the age list
     MakeTextureYoungest(pEntry);
@@ -352,17 +289,22 @@ void CTextureManager::AddTexture(TxtrCacheEntry *pEntry)
 
 TxtrCacheEntry * CTextureManager::GetTxtrCacheEntry(TxtrInfo * pti)
 {
-    TxtrCacheEntry *pEntry;
+    uint32_t dwHash;
+    uint32_t dwMask;
+    uint32_t i;
     
     if (m_pCacheTxtrList == NULL)
         return NULL;
     
     // See if it is already in the hash table
-    uint32_t dwKey = Hash(pti->Address);
+    dwHash = Hash(*pti);
+    dwMask = m_numOfCachedTxtrList - 1;
 
-    for (pEntry = m_pCacheTxtrList[dwKey]; pEntry; pEntry = pEntry->pNext)
+    for (i = dwHash & dwMask; m_pCacheTxtrList[i].pEntry; i = (i + 1) & dwMask)
     {
-        if ( pEntry->ti == *pti )
+        TxtrCacheEntry *pEntry = m_pCacheTxtrList[i].pEntry;
+
+        if ( m_pCacheTxtrList[i].dwHash == dwHash && pEntry->ti == *pti )
         {
             MakeTextureYoungest(pEntry);
             return pEntry;
@@ -376,105 +318,99 @@ TxtrCacheEntry * CTextureManager::GetTxtrCacheEntry(TxtrInfo * pti)
 
 void CTextureManager::RemoveTexture(TxtrCacheEntry * pEntry)
 {
+    uint32_t dwMask;
+    uint32_t i;
+    uint32_t j;
+
     if (m_pCacheTxtrList == NULL)
         return;
 
-    // See if it is already in the hash table
-    uint32_t dwKey = Hash(pEntry->ti.Address);
-
-    TxtrCacheEntry* pPrev = NULL;
-    TxtrCacheEntry* pCurr = m_pCacheTxtrList[dwKey];
+    dwMask = m_numOfCachedTxtrList - 1;
+    for (i = Hash(pEntry->ti) & dwMask; m_pCacheTxtrList[i].pEntry != pEntry; i = (i + 1) & dwMask)
+    {
+        if (m_pCacheTxtrList[i].pEntry == NULL)
+            return;
+    }
 
-    while (pCurr)
+    // Shift the rest of the probe run back over the hole, so that lookups
+    // never need tombstones
+    for (j = (i + 1) & dwMask; m_pCacheTxtrList[j].pEntry; j = (j + 1) & dwMask)
     {
-        // Check that the attributes match
-        if ( pCurr->ti == pEntry->ti )
+        uint32_t home = m_pCacheTxtrList[j].dwHash & dwMask;
+
+        if (((j - home) & dwMask) >= ((j - i) & dwMask))
         {
-            if (pPrev != NULL) 
-                pPrev->pNext = pCurr->pNext;
-            else
-               m_pCacheTxtrList[dwKey] = pCurr->pNext;
+            m_pCacheTxtrList[i] = m_pCacheTxtrList[j];
+            i = j;
+        }
+    }
+    m_pCacheTxtrList[i].pEntry = NULL;
+    m_stats.dwEntries--;
 
-            if (g_bUseSetTextureMem)
-            {
-                // remove the texture from the age list
-                if (pEntry->pNextYoungest != NULL)
-                    pEntry->pNextYoungest->pLastYoungest = pEntry->pLastYoungest;
-                if (pEntry->pLastYoungest != NULL)
-                    pEntry->pLastYoungest->pNextYoungest = pEntry->pNextYoungest;
-
-                // decrease the mem usage counter
-                m_currentTextureMemUsage -= (pEntry->pTexture->m_dwWidth * pEntry->pTexture->m_dwHeight * 4);
-            
-                delete pEntry;
-            }
-            else
-                RecycleTexture(pEntry);
+    // remove the texture from the age list
+    UnlinkTexture(pEntry);
 
-            break;
-        }
+    // decrease the mem usage counter
+    m_currentTextureMemUsage -= pEntry->dwMemSize;
 
-        pPrev = pCurr;
-        pCurr = pCurr->pNext;
-    }
+    RecycleTexture(pEntry);
 }
-    
-TxtrCacheEntry * CTextureManager::CreateNewCacheEntry(uint32_t dwAddr, uint32_t dwWidth, uint32_t dwHeight)
-{
-   TxtrCacheEntry * pEntry = NULL;
 
-   if (g_bUseSetTextureMem)
-   {
-      uint32_t widthToCreate = dwWidth;
-      uint32_t heightToCreate = dwHeight;
-      unsigned int freeUpSize = (widthToCreate * heightToCreate * 4) + g_amountToFree;
+// Evict the least recently used textures until dwSize more bytes fit in
+// the budget. Textures bound or used in the current frame are kept, so the
+// budget may be overrun for a frame that needs more than it allows.
+void CTextureManager::FreeTextureMem(uint32_t dwSize)
+{
+    if (m_currentTextureMemUsage + dwSize <= g_maxTextureMemUsage)
+        return;
 
-      // make sure there is enough room for the new texture by deleting old textures
-      while ((m_currentTextureMemUsage + freeUpSize) > g_maxTextureMemUsage && m_pOldestTexture != NULL)
-      {
-         TxtrCacheEntry *nextYoungest = m_pOldestTexture->pNextYoungest;
+    dwSize += g_amountToFree;
 
-         RemoveTexture(m_pOldestTexture);
+    TxtrCacheEntry *pEntry = m_pOldestTexture;
+    while (pEntry && m_currentTextureMemUsage + dwSize > g_maxTextureMemUsage &&
+          pEntry->FrameLastUsed != status.gDlistCount)
+    {
+        TxtrCacheEntry *pNext = pEntry->pNextYoungest;
 
-         m_pOldestTexture = nextYoungest;
+        if (!TCacheEntryIsLoaded(pEntry))
+        {
+            RemoveTexture(pEntry);
+            m_stats.dwEvictions++;
+        }
+        pEntry = pNext;
+    }
+}
+    
+TxtrCacheEntry * CTextureManager::CreateNewCacheEntry(TxtrInfo * pti)
+{
+   TxtrCacheEntry * pEntry = NULL;
+   uint32_t dwWidth  = pti->WidthToCreate;
+   uint32_t dwHeight = pti->HeightToCreate;
 
-         //printf("Freeing Texture\n");
-      }
+   // make sure there is enough room for the new texture by deleting old textures
+   FreeTextureMem(dwWidth * dwHeight * 4);
 
-      m_currentTextureMemUsage += widthToCreate * heightToCreate * 4;
-   }
-   else
+   pEntry = new TxtrCacheEntry;
+   if (pEntry == NULL)
    {
-      // Find a used texture
-      pEntry = ReviveTexture(dwWidth, dwHeight);
+      _VIDEO_DisplayTemporaryMessage("Error to create an texture entry");
+      return NULL;
    }
 
-   if (pEntry == NULL || g_bUseSetTextureMem)
+   pEntry->pTexture = CDeviceBuilder::GetBuilder()->CreateTexture(dwWidth, dwHeight);
+   if (pEntry->pTexture == NULL || pEntry->pTexture->GetTexture() == NULL)
    {
-      // Couldn't find on - recreate!
-      pEntry = new TxtrCacheEntry;
-      if (pEntry == NULL)
-      {
-         _VIDEO_DisplayTemporaryMessage("Error to create an texture entry");
-         return NULL;
-      }
-
-      pEntry->pTexture = CDeviceBuilder::GetBuilder()->CreateTexture(dwWidth, dwHeight);
-      if (pEntry->pTexture == NULL || pEntry->pTexture->GetTexture() == NULL)
-      {
-         _VIDEO_DisplayTemporaryMessage("Error to create an texture");
-         TRACE2("Warning, unable to create %d x %d texture!", dwWidth, dwHeight);
-      }
-      else
-      {
-         pEntry->pTexture->m_bScaledS = false;
-         pEntry->pTexture->m_bScaledT = false;
-      }
+      _VIDEO_DisplayTemporaryMessage("Error to create an texture");
+      TRACE2("Warning, unable to create %d x %d texture!", dwWidth, dwHeight);
+   }
+   else
+   {
+      pEntry->pTexture->m_bScaledS = false;
+      pEntry->pTexture->m_bScaledT = false;
    }
 
    // Initialize
-   pEntry->ti.Address = dwAddr;
-   pEntry->pNext = NULL;
+   pEntry->ti = *pti;
    pEntry->pNextYoungest = NULL;
    pEntry->pLastYoungest = NULL;
    pEntry->dwUses = 0;
@@ -486,6 +422,12 @@ TxtrCacheEntry * CTextureManager::CreateNewCacheEntry(uint32_t dwAddr, uint32_t
    pEntry->bExternalTxtrChecked = false;
    pEntry->maxCI = -1;
 
+   // The device may round the size up to a power of two
+   if (pEntry->pTexture)
+      pEntry->dwMemSize = pEntry->pTexture->m_dwCreatedTextureWidth * pEntry->pTexture->m_dwCreatedTextureHeight * 4;
+   else
+      pEntry->dwMemSize = dwWidth * dwHeight * 4;
+
    // Add to the hash table
    AddTexture(pEntry);
    return pEntry;  
@@ -625,6 +567,7 @@ TxtrCacheEntry * CTextureManager::GetTexture(TxtrInfo * pgti, bool fromTMEM, boo
             pEntry->lastEntry = g_lastTextureEntry;
             g_lastTextureEntry = pEntry;
             lastEntryModified = false;
+            m_stats.dwHits++;
 
             return pEntry;
         }
@@ -634,11 +577,13 @@ TxtrCacheEntry * CTextureManager::GetTexture(TxtrInfo * pgti, bool fromTMEM, boo
         }
     }
 
+    m_stats.dwMisses++;
+
     if (pEntry == NULL)
     {
         // We need to create a new entry, and add it
         //  to the hash table.
-        pEntry = CreateNewCacheEntry(pgti->Address, pgti->WidthToCreate, pgti->HeightToCreate);
+        pEntry = CreateNewCacheEntry(pgti);
 
         if (pEntry == NULL)
         {
@@ -714,8 +659,7 @@ TxtrCacheEntry * CTextureManager::GetTexture(TxtrInfo * pgti, bool fromTMEM, boo
 
        if( AutoExtendTexture )
        {
-          ExpandTextureS(pEntry);
-          ExpandTextureT(pEntry);
+          ExpandTextureST(pEntry);
        }
 
 #ifdef DEBUGGER
@@ -823,14 +767,14 @@ void CTextureManager::ConvertTexture_16(TxtrCacheEntry * pEntry, bool fromTMEM)
     dwCount++;
 }
 
-void CTextureManager::ExpandTexture(TxtrCacheEntry * pEntry, uint32_t sizeToLoad, uint32_t sizeToCreate, uint32_t sizeCreated,
+// Returns false if the surface was left as it is
+bool CTextureManager::ExpandTexture(void *surface, int size, uint32_t sizeToLoad, uint32_t sizeToCreate, uint32_t sizeCreated,
     int arrayWidth, int flag, int mask, int mirror, int clamp, uint32_t otherSize)
 {
     if( sizeToLoad >= sizeCreated )
-        return;
+        return false;
 
     uint32_t maskWidth = (1<<mask);
-    int size = pEntry->pTexture->GetPixelSize();
 
 #ifdef DEBUGGER
     // Some checks
@@ -842,35 +786,24 @@ void CTextureManager::ExpandTexture(TxtrCacheEntry * pEntry, uint32_t sizeToLoad
     // Image has been loaded with width=WidthToLoad, we need to enlarge the image
     // to width = pEntry->ti.WidthToCreate by doing mirroring or wrapping
 
-    DrawInfo di;
-    if( !(pEntry->pTexture->StartUpdate(&di)) )
-    {
-        TRACE0("Can't update the texture");
-        return;
-    }
-
-
     if( mask == 0 )
     {
         // Clamp
-        Clamp(di.lpSurface, sizeToLoad, sizeCreated, arrayWidth, otherSize, 
+        Clamp(surface, sizeToLoad, sizeCreated, arrayWidth, otherSize, 
             flag, size);
-        pEntry->pTexture->EndUpdate(&di);
-        return;
+        return true;
     }
 
 #ifdef DEBUGGER
     if( sizeToLoad > maskWidth )
     {
         TRACE0("Something is wrong, check me here in ExpandTextureS");
-        pEntry->pTexture->EndUpdate(&di);
-        return;
+        return false;
     }
     if( sizeToLoad == maskWidth && maskWidth == sizeToCreate && sizeToCreate != sizeCreated )
     {
         TRACE0("Something is wrong, check me here in ExpandTextureS");
-        pEntry->pTexture->EndUpdate(&di);
-        return;
+        return false;
     }
 #endif
 
@@ -879,33 +812,31 @@ void CTextureManager::ExpandTexture(TxtrCacheEntry * pEntry, uint32_t sizeToLoad
         uint32_t tempwidth = clamp ? sizeToCreate : sizeCreated;
         if( mirror )
         {
-            Mirror(di.lpSurface, sizeToLoad, mask, tempwidth,
+            Mirror(surface, sizeToLoad, mask, tempwidth,
                 arrayWidth, otherSize, flag, size );
         }
         else
         {
-            Wrap(di.lpSurface, sizeToLoad, mask, tempwidth,
+            Wrap(surface, sizeToLoad, mask, tempwidth,
                 arrayWidth, otherSize, flag, size );
         }
 
         if( tempwidth < sizeCreated )
         {
-            Clamp(di.lpSurface, tempwidth, sizeCreated, arrayWidth, otherSize, 
+            Clamp(surface, tempwidth, sizeCreated, arrayWidth, otherSize, 
                 flag, size );
         }
 
-        pEntry->pTexture->EndUpdate(&di);
-        return;
+        return true;
     }
 
 
     if( sizeToLoad < sizeToCreate && sizeToCreate == maskWidth && maskWidth == sizeCreated )
     {
         // widthToLoad < widthToCreate = maskWidth
-        Wrap(di.lpSurface, sizeToLoad, mask, sizeCreated, arrayWidth, otherSize, flag, size );
+        Wrap(surface, sizeToLoad, mask, sizeCreated, arrayWidth, otherSize, flag, size );
 
-        pEntry->pTexture->EndUpdate(&di);
-        return;
+        return true;
     }
 
     if( sizeToLoad == sizeToCreate && sizeToCreate < maskWidth )
@@ -913,10 +844,9 @@ void CTextureManager::ExpandTexture(TxtrCacheEntry * pEntry, uint32_t sizeToLoad
 #ifdef DEBUGGER
         if( maskWidth < sizeToCreate )  TRACE0("Incorrect condition, check me");
 #endif
-        Clamp(di.lpSurface, sizeToLoad, sizeCreated, arrayWidth, otherSize, flag, size );
+        Clamp(surface, sizeToLoad, sizeCreated, arrayWidth, otherSize, flag, size );
 
-        pEntry->pTexture->EndUpdate(&di);
-        return;
+        return true;
     }
 
     if( sizeToLoad < sizeToCreate && sizeToCreate < maskWidth )
@@ -925,243 +855,64 @@ void CTextureManager::ExpandTexture(TxtrCacheEntry * pEntry, uint32_t sizeToLoad
         if( clamp ) TRACE0("Incorrect condition, check me");
         if( maskWidth < sizeCreated )   TRACE0("Incorrect condition, check me");
 #endif
-        Clamp(di.lpSurface, sizeToLoad, sizeCreated, arrayWidth, otherSize, flag, size );
-        pEntry->pTexture->EndUpdate(&di);
-        return;
+        Clamp(surface, sizeToLoad, sizeCreated, arrayWidth, otherSize, flag, size );
+        return true;
     }
 
     TRACE0("Check me, should not get here");
-    pEntry->pTexture->EndUpdate(&di);
+    return false;
 }
 
-void CTextureManager::ExpandTextureS(TxtrCacheEntry * pEntry)
+// Expands in S then in T, so that the rows copied in T are already
+// complete, and uploads the texture once for both.
+void CTextureManager::ExpandTextureST(TxtrCacheEntry * pEntry)
 {
     TxtrInfo &ti =  pEntry->ti;
     uint32_t textureWidth = pEntry->pTexture->m_dwCreatedTextureWidth;
-    ExpandTexture(pEntry, ti.WidthToLoad, ti.WidthToCreate, textureWidth, 
-        textureWidth, S_FLAG, ti.maskS, ti.mirrorS, ti.clampS, ti.HeightToLoad);
-}
-
-void CTextureManager::ExpandTextureT(TxtrCacheEntry * pEntry)
-{
-    TxtrInfo &ti =  pEntry->ti;
     uint32_t textureHeight = pEntry->pTexture->m_dwCreatedTextureHeight;
-    uint32_t textureWidth = pEntry->pTexture->m_dwCreatedTextureWidth;
-    ExpandTexture(pEntry, ti.HeightToLoad, ti.HeightToCreate, textureHeight,
-        textureWidth, T_FLAG, ti.maskT, ti.mirrorT, ti.clampT, ti.WidthToLoad);
-}
-
-
-void CTextureManager::ClampS32(uint32_t *array, uint32_t width, uint32_t towidth, uint32_t arrayWidth, uint32_t rows)
-{
-   if ((int) width <= 0 || (int) towidth < 0)
-      return;
-
-   for( uint32_t y = 0; y<rows; y++ )
-   {
-      uint32_t* line = array+y*arrayWidth;
-      uint32_t val = line[width-1];
-      for( uint32_t x=width; x<towidth; x++ )
-         line[x] = val;
-   }
-}
-
-void CTextureManager::ClampS16(uint16_t *array, uint32_t width, uint32_t towidth, uint32_t arrayWidth, uint32_t rows)
-{
-   if ((int) width <= 0 || (int) towidth < 0)
-      return;
-
-   for( uint32_t y = 0; y<rows; y++ )
-   {
-      uint16_t* line = array+y*arrayWidth;
-      uint16_t val = line[width-1];
-      for( uint32_t x=width; x<towidth; x++ )
-         line[x] = val;
-   }
-}
-
-void CTextureManager::ClampT32(uint32_t *array, uint32_t height, uint32_t toheight, uint32_t arrayWidth, uint32_t cols)
-{
-   if ((int) height <= 0 || (int) toheight < 0)
-      return;
-
-   uint32_t* linesrc = array+arrayWidth*(height-1);
-   for( uint32_t y = height; y<toheight; y++ )
-   {
-      uint32_t* linedst = array+arrayWidth*y;
-      for( uint32_t x=0; x<arrayWidth; x++ )
-         linedst[x] = linesrc[x];
-   }
-}
-
-void CTextureManager::ClampT16(uint16_t *array, uint32_t height, uint32_t toheight, uint32_t arrayWidth, uint32_t cols)
-{
-   if ((int) height <= 0 || (int) toheight < 0)
-      return;
-
-   uint16_t* linesrc = array+arrayWidth*(height-1);
-   for( uint32_t y = height; y<toheight; y++ )
-   {
-      uint16_t* linedst = array+arrayWidth*y;
-      for( uint32_t x=0; x<arrayWidth; x++ )
-         linedst[x] = linesrc[x];
-   }
-}
-
-void CTextureManager::MirrorS32(uint32_t *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows)
-{
-   uint32_t maskval1 = (1<<mask)-1;
-   uint32_t maskval2 = (1<<(mask+1))-1;
-
-   for( uint32_t y = 0; y<rows; y++ )
-   {
-      uint32_t* line = array+y*arrayWidth;
-      for( uint32_t x=width; x<towidth; x++ )
-         line[x] = (x&maskval2)<=maskval1 ? line[x&maskval1] : line[maskval2-(x&maskval2)];
-   }
-}
-
-void CTextureManager::MirrorS16(uint16_t *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows)
-{
-   uint32_t maskval1 = (1<<mask)-1;
-   uint32_t maskval2 = (1<<(mask+1))-1;
-
-   for( uint32_t y = 0; y<rows; y++ )
-   {
-      uint16_t* line = array+y*arrayWidth;
-      for( uint32_t x=width; x<towidth; x++ )
-         line[x] = (x&maskval2)<=maskval1 ? line[x&maskval1] : line[maskval2-(x&maskval2)];
-   }
-}
-
-void CTextureManager::MirrorT32(uint32_t *array, uint32_t height, uint32_t mask, uint32_t toheight, uint32_t arrayWidth, uint32_t cols)
-{
-   uint32_t maskval1 = (1<<mask)-1;
-   uint32_t maskval2 = (1<<(mask+1))-1;
-
-   for( uint32_t y = height; y<toheight; y++ )
-   {
-      uint32_t srcy = (y&maskval2)<=maskval1 ? y&maskval1 : maskval2-(y&maskval2);
-      uint32_t* linesrc = array+arrayWidth*srcy;
-      uint32_t* linedst = array+arrayWidth*y;;
-      for( uint32_t x=0; x<arrayWidth; x++ )
-         linedst[x] = linesrc[x];
-   }
-}
-
-void CTextureManager::MirrorT16(uint16_t *array, uint32_t height, uint32_t mask, uint32_t toheight, uint32_t arrayWidth, uint32_t cols)
-{
-   uint32_t maskval1 = (1<<mask)-1;
-   uint32_t maskval2 = (1<<(mask+1))-1;
-
-   for( uint32_t y = height; y<toheight; y++ )
-   {
-      uint32_t srcy = (y&maskval2)<=maskval1 ? y&maskval1 : maskval2-(y&maskval2);
-      uint16_t* linesrc = array+arrayWidth*srcy;
-      uint16_t* linedst = array+arrayWidth*y;;
-      for( uint32_t x=0; x<arrayWidth; x++ )
-         linedst[x] = linesrc[x];
-   }
-}
-
-void CTextureManager::WrapS32(uint32_t *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows)
-{
-   uint32_t maskval = (1<<mask)-1;
+    int size = pEntry->pTexture->GetPixelSize();
+    bool expanded;
 
-   for( uint32_t y = 0; y<rows; y++ )
-   {
-      uint32_t* line = array+y*arrayWidth;
-      for( uint32_t x=width; x<towidth; x++ )
-         line[x] = line[(x&maskval)<width?(x&maskval):towidth-(x&maskval)];
-   }
-}
+    if( ti.WidthToLoad >= textureWidth && ti.HeightToLoad >= textureHeight )
+        return;
 
-void CTextureManager::WrapS16(uint16_t *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows)
-{
-   uint32_t maskval = (1<<mask)-1;
+    DrawInfo di;
+    if( !(pEntry->pTexture->StartUpdate(&di)) )
+    {
+        TRACE0("Can't update the texture");
+        return;
+    }
 
-   for( uint32_t y = 0; y<rows; y++ )
-   {
-      uint16_t* line = array+y*arrayWidth;
-      for( uint32_t x=width; x<towidth; x++ )
-         line[x] = line[(x&maskval)<width?(x&maskval):towidth-(x&maskval)];
-   }
-}
+    expanded = ExpandTexture(di.lpSurface, size, ti.WidthToLoad, ti.WidthToCreate, textureWidth,
+        textureWidth, S_FLAG, ti.maskS, ti.mirrorS, ti.clampS, ti.HeightToLoad);
+    expanded |= ExpandTexture(di.lpSurface, size, ti.HeightToLoad, ti.HeightToCreate, textureHeight,
+        textureWidth, T_FLAG, ti.maskT, ti.mirrorT, ti.clampT, ti.WidthToLoad);
 
-void CTextureManager::WrapT32(uint32_t *array, uint32_t height, uint32_t mask, uint32_t toheight, uint32_t arrayWidth, uint32_t cols)
-{
-   uint32_t maskval = (1<<mask)-1;
-   for( uint32_t y = height; y<toheight; y++ )
-   {
-      uint32_t* linesrc = array+arrayWidth*(y>maskval?y&maskval:y-height);
-      uint32_t* linedst = array+arrayWidth*y;;
-      for( uint32_t x=0; x<arrayWidth; x++ )
-         linedst[x] = linesrc[x];
-   }
+    if( expanded )
+        pEntry->pTexture->EndUpdate(&di);
 }
 
-void CTextureManager::WrapT16(uint16_t *array, uint32_t height, uint32_t mask, uint32_t toheight, uint32_t arrayWidth, uint32_t cols)
-{
-   uint32_t maskval = (1<<mask)-1;
-   for( uint32_t y = height; y<toheight; y++ )
-   {
-      uint16_t* linesrc = array+arrayWidth*(y>maskval?y&maskval:y-height);
-      uint16_t* linedst = array+arrayWidth*y;;
-      for( uint32_t x=0; x<arrayWidth; x++ )
-         linedst[x] = linesrc[x];
-   }
-}
 
 void CTextureManager::Clamp(void *array, uint32_t width, uint32_t towidth, uint32_t arrayWidth, uint32_t rows, int flag, int size )
 {
    if( flag == S_FLAG )    // s
-   {
-      if( size == 4 ) // 32 bit
-         ClampS32((uint32_t*)array, width, towidth, arrayWidth, rows);
-      else    // 16 bits
-         ClampS16((uint16_t*)array, width, towidth, arrayWidth, rows);
-   }
+      texexpand_clamp_s(array, size == 4 ? 4 : 2, width, towidth, arrayWidth, rows);
    else    // t
-   {
-      if( size == 4 ) // 32 bit
-         ClampT32((uint32_t*)array, width, towidth, arrayWidth, rows);
-      else    // 16 bits
-         ClampT16((uint16_t*)array, width, towidth, arrayWidth, rows);
-   }
+      texexpand_clamp_t(array, size == 4 ? 4 : 2, width, towidth, arrayWidth);
 }
 void CTextureManager::Wrap(void *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows, int flag, int size )
 {
-    if( flag == S_FLAG )    // s
-    {
-        if( size == 4 ) // 32 bit
-            WrapS32((uint32_t*)array, width, mask, towidth, arrayWidth, rows);
-        else    // 16 bits
-            WrapS16((uint16_t*)array, width, mask, towidth, arrayWidth, rows);
-    }
-    else    // t
-    {
-        if( size == 4 ) // 32 bit
-            WrapT32((uint32_t*)array, width, mask, towidth, arrayWidth, rows);
-        else    // 16 bits
-            WrapT16((uint16_t*)array, width, mask, towidth, arrayWidth, rows);
-    }
+   if( flag == S_FLAG )    // s
+      texexpand_wrap_s(array, size == 4 ? 4 : 2, width, mask, towidth, arrayWidth, rows);
+   else    // t
+      texexpand_wrap_t(array, size == 4 ? 4 : 2, width, mask, towidth, arrayWidth);
 }
 void CTextureManager::Mirror(void *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows, int flag, int size )
 {
    if( flag == S_FLAG )    // s
-   {
-      if( size == 4 ) // 32 bit
-         MirrorS32((uint32_t*)array, width, mask, towidth, arrayWidth, rows);
-      else    // 16 bits
-         MirrorS16((uint16_t*)array, width, mask, towidth, arrayWidth, rows);
-   }
+      texexpand_mirror_s(array, size == 4 ? 4 : 2, width, mask, towidth, arrayWidth, rows);
    else    // t
-   {
-      if( size == 4 ) // 32 bit
-         MirrorT32((uint32_t*)array, width, mask, towidth, arrayWidth, rows);
-      else    // 16 bits
-         MirrorT16((uint16_t*)array, width, mask, towidth, arrayWidth, rows);
-   }
+      texexpand_mirror_t(array, size == 4 ? 4 : 2, width, mask, towidth, arrayWidth);
 }
 
 
@@ -1169,45 +920,22 @@ void CTextureManager::Mirror(void *array, uint32_t width, uint32_t mask, uint32_
 TxtrCacheEntry * CTextureManager::GetCachedTexture(uint32_t tex)
 {
    uint32_t size = 0;
-   for( uint32_t i=0; i<m_numOfCachedTxtrList; i++ )
+   TxtrCacheEntry *pEntry;
+
+   for (pEntry = m_pOldestTexture; pEntry; pEntry = pEntry->pNextYoungest)
    {
-      if( m_pCacheTxtrList[i] == NULL )
-         continue;
+      if( size == tex )
+         return pEntry;
       else
-      {
-         TxtrCacheEntry *pEntry;
-
-         for (pEntry = m_pCacheTxtrList[i]; pEntry; pEntry = pEntry->pNext)
-         {
-            if( size == tex )
-               return pEntry;
-            else
-               size++;
-         }
-      }
+         size++;
    }
    return NULL;
 }
 
 uint32_t CTextureManager::GetNumOfCachedTexture()
 {
-   uint32_t size = 0;
-   for( uint32_t i=0; i<m_numOfCachedTxtrList; i++ )
-   {
-      if( m_pCacheTxtrList[i] == NULL )
-         continue;
-      else
-      {
-         TxtrCacheEntry *pEntry;
-
-         for (pEntry = m_pCacheTxtrList[i]; pEntry; pEntry = pEntry->pNext)
-         {
-            size++;
-         }
-      }
-   }
-   TRACE1("Totally %d texture cached", size);
-   return size;
+   TRACE1("Totally %d texture cached", m_stats.dwEntries);
+   return m_stats.dwEntries;
 }
 #endif
 
@@ -140,8 +140,6 @@ typedef struct TxtrCacheEntry
        pEnhancedTexture = NULL;
     }
     
-    struct TxtrCacheEntry *pNext;       // Must be first element!
-
     struct TxtrCacheEntry *pNextYoungest;
     struct TxtrCacheEntry *pLastYoungest;
 
@@ -154,6 +152,7 @@ typedef struct TxtrCacheEntry
     uint32_t  dwTimeLastUsed; // timeGetTime of time of last usage
     uint32_t  FrameLastUsed;  // Frame # that this was last used
     uint32_t  FrameLastUpdated;
+    uint32_t  dwMemSize;      // Bytes charged to the cache budget
 
     CTexture    *pTexture;
     CTexture    *pEnhancedTexture;
@@ -166,43 +165,46 @@ typedef struct TxtrCacheEntry
 } TxtrCacheEntry;
 
 
+typedef struct
+{
+    uint32_t  dwHits;
+    uint32_t  dwMisses;
+    uint32_t  dwEvictions;    // Removed to stay within the byte budget
+    uint32_t  dwPurges;       // Removed for not being used for a while
+    uint32_t  dwEntries;
+    uint32_t  dwBytes;
+    uint32_t  dwPeakBytes;
+} TextureCacheStats;
+
+typedef struct
+{
+    uint32_t        dwHash;
+    TxtrCacheEntry *pEntry;     // NULL if the slot is free
+} TxtrCacheSlot;
+
+
 //*****************************************************************************
 // Texture cache implementation
 //*****************************************************************************
 class CTextureManager
 {
 protected:
-    TxtrCacheEntry * CreateNewCacheEntry(uint32_t dwAddr, uint32_t dwWidth, uint32_t dwHeight);
+    TxtrCacheEntry * CreateNewCacheEntry(TxtrInfo * pti);
     void AddTexture(TxtrCacheEntry *pEntry);
     void RemoveTexture(TxtrCacheEntry * pEntry);
     void RecycleTexture(TxtrCacheEntry *pEntry);
-    TxtrCacheEntry * ReviveTexture( uint32_t width, uint32_t height );
+    void FreeTextureMem(uint32_t dwSize);
     TxtrCacheEntry * GetTxtrCacheEntry(TxtrInfo * pti);
     
     void ConvertTexture(TxtrCacheEntry * pEntry, bool fromTMEM);
     void ConvertTexture_16(TxtrCacheEntry * pEntry, bool fromTMEM);
 
-    void ClampS32(uint32_t *array, uint32_t width, uint32_t towidth, uint32_t arrayWidth, uint32_t rows);
-    void ClampS16(uint16_t *array, uint32_t width, uint32_t towidth, uint32_t arrayWidth, uint32_t rows);
-    void ClampT32(uint32_t *array, uint32_t height, uint32_t toheight, uint32_t arrayWidth, uint32_t cols);
-    void ClampT16(uint16_t *array, uint32_t height, uint32_t toheight, uint32_t arrayWidth, uint32_t cols);
-
-    void MirrorS32(uint32_t *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows);
-    void MirrorS16(uint16_t *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows);
-    void MirrorT32(uint32_t *array, uint32_t height, uint32_t mask, uint32_t toheight, uint32_t arrayWidth, uint32_t cols);
-    void MirrorT16(uint16_t *array, uint32_t height, uint32_t mask, uint32_t toheight, uint32_t arrayWidth, uint32_t cols);
-
-    void WrapS32(uint32_t *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows);
-    void WrapS16(uint16_t *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows);
-    void WrapT32(uint32_t *array, uint32_t height, uint32_t mask, uint32_t toheight, uint32_t arrayWidth, uint32_t cols);
-    void WrapT16(uint16_t *array, uint32_t height, uint32_t mask, uint32_t toheight, uint32_t arrayWidth, uint32_t cols);
-
-    void ExpandTextureS(TxtrCacheEntry * pEntry);
-    void ExpandTextureT(TxtrCacheEntry * pEntry);
-    void ExpandTexture(TxtrCacheEntry * pEntry, uint32_t sizeOfLoad, uint32_t sizeToCreate, uint32_t sizeCreated,
+    void ExpandTextureST(TxtrCacheEntry * pEntry);
+    bool ExpandTexture(void *surface, int size, uint32_t sizeOfLoad, uint32_t sizeToCreate, uint32_t sizeCreated,
         int arrayWidth, int flag, int mask, int mirror, int clamp, uint32_t otherSize);
 
-    uint32_t Hash(uint32_t dwValue);
+    uint32_t Hash(const TxtrInfo &ti);
+    void GrowTable();
     bool TCacheEntryIsLoaded(TxtrCacheEntry *pEntry);
 
     void updateColorTexture(CTexture *ptexture, uint32_t color);
@@ -213,8 +215,8 @@ public:
     void Mirror(void *array, uint32_t width, uint32_t mask, uint32_t towidth, uint32_t arrayWidth, uint32_t rows, int flag, int size );
     
 protected:
-    TxtrCacheEntry * m_pHead;
-    TxtrCacheEntry ** m_pCacheTxtrList;
+    // Open addressed with linear probing, the size is a power of two
+    TxtrCacheSlot * m_pCacheTxtrList;
     uint32_t m_numOfCachedTxtrList;
 
     TxtrCacheEntry m_blackTextureEntry;
@@ -228,9 +230,11 @@ protected:
     TxtrCacheEntry * GetPrimLODFracTexture(uint8_t fac);
 
     void MakeTextureYoungest(TxtrCacheEntry *pEntry);
+    void UnlinkTexture(TxtrCacheEntry *pEntry);
     unsigned int m_currentTextureMemUsage;
     TxtrCacheEntry *m_pYoungestTexture;
     TxtrCacheEntry *m_pOldestTexture;
+    TextureCacheStats m_stats;
 
 public:
     CTextureManager();
@@ -244,6 +248,9 @@ public:
     void RecycleAllTextures();
     void RecheckHiresForAllTextures();
     bool CleanUp();
+
+    void GetStats(TextureCacheStats *stats);
+    void ResetStats();
     
 #ifdef DEBUGGER
     TxtrCacheEntry * GetCachedTexture(uint32_t tex);
@@ -13924,33 +13924,87 @@ void CountCombine(void)
    //alpha_cmb_list_count = sizeof(alpha_cmb_list) >> 3;
 }
 
+//****************************************************************
+// Combine cache
+//
+// What CombineResolve() produces only depends on the state gathered in
+// COMBINE_KEY, so its result is kept in a small direct-mapped cache and
+// restored as a whole on a hit, skipping both the list search and the
+// combiner function.
+//****************************************************************
+
+#define COMBINE_CACHE_SIZE 256
+
+typedef struct
+{
+   uint32_t cycle1, cycle2;
+   uint32_t other_mode_h, other_mode_l;
+   uint32_t prim_color, env_color, fog_color, blend_color;
+   uint32_t key_center, key_scale;
+   uint32_t k4, k5, prim_lod_frac, lod_frac;
+   uint32_t cur_tile, last_tile, tile_format;
+   uint32_t hacks, ucode;
+} COMBINE_KEY;
+
+typedef struct
+{
+   bool valid;
+   COMBINE_KEY key;
+   COMBINE cmb;
+   float col[4], coladd[4], col_2[4], shade_factor;
+   uint32_t cmb_flags, cmb_flags_2;
+   unsigned noise;
+} COMBINE_CACHE_ENTRY;
+
+static COMBINE_CACHE_ENTRY combine_cache[COMBINE_CACHE_SIZE];
+static uint32_t combine_cache_hits, combine_cache_misses;
+
+static void CombineKey(COMBINE_KEY *key)
+{
+   key->cycle1        = rdp.cycle1;
+   key->cycle2        = rdp.cycle2;
+   key->other_mode_h  = gDP.otherMode.h;
+   key->other_mode_l  = gDP.otherMode.l;
+   key->prim_color    = g_gdp.prim_color.total;
+   key->env_color     = g_gdp.env_color.total;
+   key->fog_color     = g_gdp.fog_color.total;
+   key->blend_color   = g_gdp.blend_color.total;
+   key->key_center    = g_gdp.key_center.total;
+   key->key_scale     = g_gdp.key_scale.total;
+   key->k4            = g_gdp.k4;
+   key->k5            = g_gdp.k5;
+   key->prim_lod_frac = g_gdp.primitive_lod_frac;
+   key->lod_frac      = lod_frac;
+   key->cur_tile      = rdp.cur_tile;
+   key->last_tile     = rdp.last_tile;
+   key->tile_format   = g_gdp.tile[rdp.cur_tile].format;
+   key->hacks         = settings.hacks;
+   key->ucode         = settings.ucode;
+}
+
+static uint32_t CombineKeyHash(const COMBINE_KEY *key)
+{
+   const uint32_t *w = (const uint32_t*)key;
+   uint32_t hash     = 0x811C9DC5;
+   unsigned i;
+
+   for (i = 0; i < sizeof(*key) / sizeof(uint32_t); i++)
+      hash = (hash ^ w[i]) * 0x01000193;
+   return hash ^ (hash >> 16);
+}
+
 //****************************************************************
 // Main Combine
 //****************************************************************
 
-void Combine(void)
+// Looks up the color and alpha combine modes and runs their functions,
+// which fill in cmb and the rdp color modifiers.
+static void CombineResolve(void)
 {
    uint32_t found, cmb_mode_a, cmb_mode_c;
    uint32_t actual_combine, current_combine, color_combine, alpha_combine;
    int left, right, current, last;
 
-#if 0
-   FRDP (" | |- color combine: %08lx, #1: (%s-%s)*%s+%s, #2: (%s-%s)*%s+%s\n",
-         ((rdp.cycle1 & 0xFFFF) << 16) | (rdp.cycle2 & 0xFFFF),
-         Mode0[rdp.cycle1&0xF], Mode1[(rdp.cycle1>>4)&0xF], Mode2[(rdp.cycle1>>8)&0x1F], Mode3[(rdp.cycle1>>13)&7],
-         Mode0[rdp.cycle2&0xF], Mode1[(rdp.cycle2>>4)&0xF], Mode2[(rdp.cycle2>>8)&0x1F], Mode3[(rdp.cycle2>>13)&7]);
-   FRDP (" | |- alpha combine: %08lx, #1: (%s-%s)*%s+%s, #2: (%s-%s)*%s+%s\n",
-         (rdp.cycle1 & 0x0FFF0000) | ((rdp.cycle2 & 0x0FFF0000) >> 16),
-         Alpha0[(rdp.cycle1>>16)&7], Alpha1[(rdp.cycle1>>19)&7], Alpha2[(rdp.cycle1>>22)&7], Alpha3[(rdp.cycle1>>25)&7],
-         Alpha0[(rdp.cycle2>>16)&7], Alpha1[(rdp.cycle2>>19)&7], Alpha2[(rdp.cycle2>>22)&7], Alpha3[(rdp.cycle2>>25)&7]);
-#endif
-   if (!(gDP.otherMode.textureLOD) || rdp.cur_tile == gDP.otherMode.textureDetail)
-      lod_frac = g_gdp.primitive_lod_frac;
-   else if (settings.lodmode == 0)
-      lod_frac = 0;
-   else
-      lod_frac = 10;
-
    rdp.noise = NOISE_MODE_NONE;
 
    found = true;
@@ -14092,6 +14146,65 @@ void Combine(void)
    {
       ac_t0();
    }
+}
+
+void Combine(void)
+{
+   COMBINE_KEY key;
+   COMBINE_CACHE_ENTRY *entry;
+
+#if 0
+   FRDP (" | |- color combine: %08lx, #1: (%s-%s)*%s+%s, #2: (%s-%s)*%s+%s\n",
+         ((rdp.cycle1 & 0xFFFF) << 16) | (rdp.cycle2 & 0xFFFF),
+         Mode0[rdp.cycle1&0xF], Mode1[(rdp.cycle1>>4)&0xF], Mode2[(rdp.cycle1>>8)&0x1F], Mode3[(rdp.cycle1>>13)&7],
+         Mode0[rdp.cycle2&0xF], Mode1[(rdp.cycle2>>4)&0xF], Mode2[(rdp.cycle2>>8)&0x1F], Mode3[(rdp.cycle2>>13)&7]);
+   FRDP (" | |- alpha combine: %08lx, #1: (%s-%s)*%s+%s, #2: (%s-%s)*%s+%s\n",
+         (rdp.cycle1 & 0x0FFF0000) | ((rdp.cycle2 & 0x0FFF0000) >> 16),
+         Alpha0[(rdp.cycle1>>16)&7], Alpha1[(rdp.cycle1>>19)&7], Alpha2[(rdp.cycle1>>22)&7], Alpha3[(rdp.cycle1>>25)&7],
+         Alpha0[(rdp.cycle2>>16)&7], Alpha1[(rdp.cycle2>>19)&7], Alpha2[(rdp.cycle2>>22)&7], Alpha3[(rdp.cycle2>>25)&7]);
+#endif
+   if (!(gDP.otherMode.textureLOD) || rdp.cur_tile == gDP.otherMode.textureDetail)
+      lod_frac = g_gdp.primitive_lod_frac;
+   else if (settings.lodmode == 0)
+      lod_frac = 0;
+   else
+      lod_frac = 10;
+
+   CombineKey(&key);
+   entry = &combine_cache[CombineKeyHash(&key) & (COMBINE_CACHE_SIZE - 1)];
+
+   if (entry->valid && memcmp(&entry->key, &key, sizeof(key)) == 0)
+   {
+      cmb = entry->cmb;
+      memcpy(rdp.col, entry->col, sizeof(rdp.col));
+      memcpy(rdp.coladd, entry->coladd, sizeof(rdp.coladd));
+      memcpy(rdp.col_2, entry->col_2, sizeof(rdp.col_2));
+      rdp.shade_factor = entry->shade_factor;
+      rdp.cmb_flags    = entry->cmb_flags;
+      rdp.cmb_flags_2  = entry->cmb_flags_2;
+      rdp.noise        = entry->noise;
+      combine_cache_hits++;
+   }
+   else
+   {
+      CombineResolve();
+
+      entry->valid        = true;
+      entry->key          = key;
+      entry->cmb          = cmb;
+      memcpy(entry->col, rdp.col, sizeof(rdp.col));
+      memcpy(entry->coladd, rdp.coladd, sizeof(rdp.coladd));
+      memcpy(entry->col_2, rdp.col_2, sizeof(rdp.col_2));
+      entry->shade_factor = rdp.shade_factor;
+      entry->cmb_flags    = rdp.cmb_flags;
+      entry->cmb_flags_2  = rdp.cmb_flags_2;
+      entry->noise        = rdp.noise;
+      combine_cache_misses++;
+   }
+
+   if (((combine_cache_hits + combine_cache_misses) & 0xFFFF) == 0)
+      VLOG("Combine cache: %u hits, %u misses\n",
+            combine_cache_hits, combine_cache_misses);
 
    LRDP(" | |- Alpha done\n");
 
@@ -14301,6 +14414,9 @@ void InitCombine(void)
    cmb.dc0_lodbias = cmb.dc1_lodbias = 31;
    cmb.dc0_detailscale = cmb.dc1_detailscale = 7;
    cmb.lodbias0 = cmb.lodbias1 = 1.0f;
+
+   memset(combine_cache, 0, sizeof(combine_cache));
+   combine_cache_hits = combine_cache_misses = 0;
 }
 
 void ColorCombinerToExtension(void)
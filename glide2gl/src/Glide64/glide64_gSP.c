@@ -4,6 +4,7 @@
 #include "../../../Graphics/3dmath.h"
 #include "../../../Graphics/RDP/gDP_state.h"
 #include "../../../Graphics/RSP/gSP_state.h"
+#include "../../../Graphics/RSP/gSP_vertex.h"
 
 #include "glide64_gDP.h"
 #include "glide64_gSP.h"
@@ -143,18 +144,6 @@ void glide64gSPClipRatio(uint32_t r)
    g_gdp.flags |= UPDATE_VIEWPORT;
 }
 
-void glide64gSPClipVertex(uint32_t v)
-{
-   VERTEX *vtx = (VERTEX*)&rdp.vtx[v];
-
-   vtx->scr_off = 0;
-   if (vtx->x > +vtx->w)   vtx->scr_off |= 2;
-   if (vtx->x < -vtx->w)   vtx->scr_off |= 1;
-   if (vtx->y > +vtx->w)   vtx->scr_off |= 8;
-   if (vtx->y < -vtx->w)   vtx->scr_off |= 4;
-   if (vtx->w < 0.1f)      vtx->scr_off |= 16;
-}
-
 void glide64gSPLookAt(uint32_t l, uint32_t n)
 {
    int8_t  *rdram_s8  = (int8_t*) (gfx_info.RDRAM  + RSP_SegmentToPhysical(l));
@@ -451,72 +440,105 @@ static INLINE void pre_update(void)
    }
 }
 
-/*
- * Loads into the RSP vertex buffer the vertices that will be used by the 
- * gSP1Triangle commands to generate polygons.
- *
- * v  - Segment address of the vertex list  pointer to a list of vertices.
- * n  - Number of vertices (1 - 32).
- * v0 - Starting index in vertex buffer where vertices are to be loaded into.
- */
-void glide64gSPVertex(uint32_t v, uint32_t n, uint32_t v0)
+/* Transforms and lights up to VERTEX_BATCH_SIZE vertices of a load. */
+static void glide64gSPVertexBatch(uint8_t *rdram_u8, uint32_t n, uint32_t v0)
 {
    unsigned int i;
-   float x, y, z;
+   struct vertex_batch batch;
    uint32_t iter = 16;
-   void   *vertex  = (void*)(gfx_info.RDRAM + v);
+   int lighting      = (gSP.geometryMode & G_LIGHTING) != 0;
+   int point_light   = lighting && settings.ucode == 2 && (gSP.geometryMode & G_POINT_LIGHTING);
 
-   pre_update();
+   for (i = 0; i < n; i++)
+   {
+      int16_t *rdram = (int16_t*)(rdram_u8 + i * iter);
+      uint8_t *color = rdram_u8 + i * iter + 12;
 
-   for (i=0; i < (n * iter); i+= iter)
+      batch.y[i] = (float)rdram[0];
+      batch.x[i] = (float)rdram[1];
+      batch.z[i] = (float)rdram[3];
+
+      if (lighting)
+      {
+         batch.nx[i] = (int8_t)color[3];
+         batch.ny[i] = (int8_t)color[2];
+         batch.nz[i] = (int8_t)color[1];
+      }
+   }
+
+   gSPBatchTransform(&batch, n, rdp.combined);
+
+   /* w is kept off zero before its clip codes */
+   for (i = 0; i < n; i++)
+      if (fabs(batch.w[i]) < 0.001)
+         batch.w[i] = 0.001f;
+   gSPBatchClip(&batch, n, 0.1f);
+
+   if (lighting && !point_light)
    {
-      VERTEX *vtx = (VERTEX*)&rdp.vtx[v0 + (i / iter)];
-      int16_t *rdram    = (int16_t*)vertex;
-      uint8_t *rdram_u8 = (uint8_t*)vertex;
-      uint8_t *color = (uint8_t*)(rdram_u8 + 12);
-      y                 = (float)rdram[0];
-      x                 = (float)rdram[1];
+      struct vertex_batch_light lights[12];
+
+      for (i = 0; i < gSP.numLights; i++)
+      {
+         lights[i].dir[0] = rdp.light_vector[i][0];
+         lights[i].dir[1] = rdp.light_vector[i][1];
+         lights[i].dir[2] = rdp.light_vector[i][2];
+         lights[i].col[0] = rdp.light[i].col[0];
+         lights[i].col[1] = rdp.light[i].col[1];
+         lights[i].col[2] = rdp.light[i].col[2];
+      }
+
+      gSPBatchNormalize(&batch, n);
+      gSPBatchLight(&batch, n, lights, gSP.numLights, rdp.light[gSP.numLights].col);
+   }
+
+   for (i = 0; i < n; i++)
+   {
+      VERTEX *vtx = (VERTEX*)&rdp.vtx[v0 + i];
+      int16_t *rdram    = (int16_t*)(rdram_u8 + i * iter);
+      uint8_t *color    = rdram_u8 + i * iter + 12;
       vtx->flags        = (uint16_t)rdram[2];
-      z                 = (float)rdram[3];
       vtx->ov           = (float)rdram[4];
       vtx->ou           = (float)rdram[5];
       vtx->uv_scaled    = 0;
       vtx->a            = color[0];
 
-      vtx->x = x*rdp.combined[0][0] + y*rdp.combined[1][0] + z*rdp.combined[2][0] + rdp.combined[3][0];
-      vtx->y = x*rdp.combined[0][1] + y*rdp.combined[1][1] + z*rdp.combined[2][1] + rdp.combined[3][1];
-      vtx->z = x*rdp.combined[0][2] + y*rdp.combined[1][2] + z*rdp.combined[2][2] + rdp.combined[3][2];
-      vtx->w = x*rdp.combined[0][3] + y*rdp.combined[1][3] + z*rdp.combined[2][3] + rdp.combined[3][3];
+      vtx->x = batch.x[i];
+      vtx->y = batch.y[i];
+      vtx->z = batch.z[i];
+      vtx->w = batch.w[i];
 
       vtx->uv_calculated = 0xFFFFFFFF;
       vtx->screen_translated = 0;
       vtx->shade_mod = 0;
 
-      if (fabs(vtx->w) < 0.001)
-         vtx->w = 0.001f;
       vtx->oow = 1.0f / vtx->w;
       vtx->x_w = vtx->x * vtx->oow;
       vtx->y_w = vtx->y * vtx->oow;
       vtx->z_w = vtx->z * vtx->oow;
       calculateVertexFog (vtx);
 
-      gSPClipVertex(v0 + (i / iter));
+      vtx->scr_off = batch.clip[i];
 
-      if (gSP.geometryMode & G_LIGHTING)
+      if (lighting)
       {
-         vtx->vec[0] = (int8_t)color[3];
-         vtx->vec[1] = (int8_t)color[2];
-         vtx->vec[2] = (int8_t)color[1];
+         vtx->vec[0] = batch.nx[i];
+         vtx->vec[1] = batch.ny[i];
+         vtx->vec[2] = batch.nz[i];
 
-         if (settings.ucode == 2 && gSP.geometryMode & G_POINT_LIGHTING)
+         if (point_light)
          {
-            float tmpvec[3] = {x, y, z};
+            float tmpvec[3];
+            tmpvec[0] = (float)rdram[1];
+            tmpvec[1] = (float)rdram[0];
+            tmpvec[2] = (float)rdram[3];
             glide64gSPPointLightVertex(vtx, tmpvec);
          }
          else
          {
-            NormalizeVector (vtx->vec);
-            glide64gSPLightVertex(vtx);
+            vtx->r = (uint8_t)(255.0f * clamp_float(batch.r[i], 0.0, 1.0));
+            vtx->g = (uint8_t)(255.0f * clamp_float(batch.g[i], 0.0, 1.0));
+            vtx->b = (uint8_t)(255.0f * clamp_float(batch.b[i], 0.0, 1.0));
          }
 
          if (gSP.geometryMode & G_TEXTURE_GEN)
@@ -534,7 +556,31 @@ void glide64gSPVertex(uint32_t v, uint32_t n, uint32_t v0)
          vtx->g = color[2];
          vtx->b = color[1];
       }
-      vertex = (char*)vertex + iter;
+   }
+}
+
+/*
+ * Loads into the RSP vertex buffer the vertices that will be used by the 
+ * gSP1Triangle commands to generate polygons.
+ *
+ * v  - Segment address of the vertex list  pointer to a list of vertices.
+ * n  - Number of vertices (1 - 32).
+ * v0 - Starting index in vertex buffer where vertices are to be loaded into.
+ */
+void glide64gSPVertex(uint32_t v, uint32_t n, uint32_t v0)
+{
+   uint8_t *rdram_u8 = (uint8_t*)(gfx_info.RDRAM + v);
+
+   pre_update();
+
+   while (n)
+   {
+      uint32_t count = n < VERTEX_BATCH_SIZE ? n : VERTEX_BATCH_SIZE;
+
+      glide64gSPVertexBatch(rdram_u8, count, v0);
+      rdram_u8 += count * 16;
+      v0       += count;
+      n        -= count;
    }
 }
 
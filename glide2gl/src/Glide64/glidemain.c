@@ -251,6 +251,8 @@ int glide64InitGfx(void)
       return false;
    }
 
+   grShaderCacheLoad(rdp.RomName);
+
    // get the # of TMUs available
    voodoo.tex_max_addr = grTexMaxAddress(GR_TMU0);
 
@@ -384,6 +384,9 @@ void grErrorSetCallback( GrErrorCallbackFnc_t fnc );
 */
 uint32_t grSstWinOpen(void);
 
+/* Loads the shader programs saved for this ROM, after grSstWinOpen. */
+void grShaderCacheLoad(const char *rom_name);
+
  int32_t 
 grSstWinClose( uint32_t context );
 
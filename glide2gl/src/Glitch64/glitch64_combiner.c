@@ -27,18 +27,26 @@
 #endif // _WIN32
 #include <math.h>
 
+#include <retro_miscellaneous.h>
+
 #include "glide.h"
 #include "glitchmain.h"
+#include "uthash.h"
 #include "../../libretro/libretro_private.h"
+#include "m64p_config.h"
 
 #include "../../Graphics/RDP/RDP_state.h"
 
 float glide64_pow(float a, float b);
 
-typedef struct _shader_program_key
-{
-   int index;
+#if !defined(HAVE_OPENGLES) || defined(HAVE_OPENGLES_3_1)
+#define HAVE_SHADER_CACHE
+#endif
 
+/* Everything the generated fragment shader depends on. Compared and
+ * hashed as a whole, so it must stay free of padding. */
+typedef struct
+{
    int color_combiner;
    int alpha_combiner;
    int texture0_combiner;
@@ -50,6 +58,13 @@ typedef struct _shader_program_key
    int dither_enabled;
    int three_point_filter0;
    int three_point_filter1;
+} shader_key;
+
+typedef struct _shader_program_key
+{
+   shader_key key;
+   unsigned uses;
+
    GLuint program_object;
    int texture0_location;
    int texture1_location;
@@ -65,6 +80,8 @@ typedef struct _shader_program_key
    int constant_color_location;
    int ccolor0_location;
    int ccolor1_location;
+
+   UT_hash_handle hh;
 } shader_program_key;
 
 static int fct[4], source0[4], operand0[4], source1[4], operand1[4], source2[4], operand2[4];
@@ -75,7 +92,6 @@ bool alpha_test = 0;
 static shader_program_key *shader_programs = NULL;
 static shader_program_key *current_shader  = NULL;
 
-static int number_of_programs = 0;
 static int color_combiner_key;
 static int alpha_combiner_key;
 static int texture0_combiner_key;
@@ -100,6 +116,12 @@ float lambda_color[2][4];
 // shaders variables
 int need_to_compile;
 
+#ifdef HAVE_SHADER_CACHE
+static bool shader_cache_supported;
+static char shader_cache_path[PATH_MAX_LENGTH];
+static void shader_cache_save(void);
+#endif
+
 static char *fragment_shader;
 static GLuint vertex_shader_object;
 GLuint program_object_default;
@@ -440,36 +462,6 @@ void check_link(GLuint program)
    }
 }
 
-static void append_shader_program(shader_program_key *shader)
-{
-   int curr_index;
-   int                   index = number_of_programs;
-
-   if (current_shader)
-      curr_index = current_shader->index;
-
-   shader->index = index;
-
-   if (!shader_programs)
-      shader_programs = (shader_program_key*)malloc(sizeof(shader_program_key));
-   else
-   {
-      shader_program_key *new_ptr = (shader_program_key*)
-         realloc(shader_programs, (index + 1) * sizeof(shader_program_key));
-      if (!new_ptr)
-         return;
-
-      shader_programs = new_ptr;
-   }
-
-   if (current_shader)
-      current_shader = &shader_programs[curr_index];
-
-   shader_programs[index] = *shader;
-
-   ++number_of_programs;
-}
-
 static void shader_bind_attributes(shader_program_key *shader)
 {
    GLuint prog = shader->program_object;
@@ -483,7 +475,7 @@ static void shader_bind_attributes(shader_program_key *shader)
 
 static void use_shader_program(shader_program_key *shader)
 {
-   current_shader = &shader_programs[shader->index];
+   current_shader = shader;
    glUseProgram(shader->program_object);
 }
 
@@ -509,6 +501,303 @@ static void shader_find_uniforms(shader_program_key *shader)
    shader->alphaRef_location       = glGetUniformLocation(prog, "alphaRef");
 }
 
+#ifdef HAVE_SHADER_CACHE
+/* Shader cache
+ *
+ * Linked programs are written to the user cache folder, one file per ROM,
+ * when the window is closed and loaded back by grShaderCacheLoad() when it
+ * is opened, so a ROM starts with the programs it used before instead of
+ * compiling them on the first frames that need them. Only the most used
+ * programs are kept; use counts are halved on every save so programs that
+ * are no longer used age out.
+ *
+ * Layout: magic, version, environment hash, then records of
+ * shader_key, uses, binary format, binary length, binary, and a trailing
+ * FNV-1a hash of everything before it. The environment hash covers the
+ * shader sources that aren't part of the key and the GL driver strings.
+ * Bump SHADER_CACHE_VERSION when the generated fragment shaders change. */
+#define SHADER_CACHE_MAGIC    0x53343647 /* "G64S" */
+#define SHADER_CACHE_VERSION  1
+#define SHADER_CACHE_MAX      512
+#define FNV_BASIS             0x811C9DC5
+
+static uint32_t shader_cache_hash(uint32_t hash, const void *data, size_t size)
+{
+   const uint8_t *p = (const uint8_t*)data;
+
+   while (size--)
+      hash = (hash ^ *p++) * 0x01000193;
+   return hash;
+}
+
+static uint32_t shader_cache_environment(void)
+{
+   static const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+   uint32_t hash = FNV_BASIS;
+   unsigned i;
+
+   hash = shader_cache_hash(hash, vertex_shader, strlen(vertex_shader));
+   hash = shader_cache_hash(hash, fragment_shader_header, strlen(fragment_shader_header));
+
+   for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+   {
+      const char *str = (const char*)glGetString(names[i]);
+      if (str)
+         hash = shader_cache_hash(hash, str, strlen(str));
+      hash = shader_cache_hash(hash, "\n", 1);
+   }
+
+   return hash;
+}
+
+static bool shader_cache_read(const uint8_t **p, const uint8_t *end,
+      void *dst, size_t size)
+{
+   if ((size_t)(end - *p) < size)
+      return false;
+   memcpy(dst, *p, size);
+   *p += size;
+   return true;
+}
+
+static bool shader_cache_write(FILE *f, uint32_t *hash,
+      const void *src, size_t size)
+{
+   *hash = shader_cache_hash(*hash, src, size);
+   return fwrite(src, 1, size, f) == size;
+}
+
+static int shader_cache_compare(const void *a, const void *b)
+{
+   const shader_program_key *sa = *(const shader_program_key**)a;
+   const shader_program_key *sb = *(const shader_program_key**)b;
+
+   if (sa->uses != sb->uses)
+      return sa->uses > sb->uses ? -1 : 1;
+   return 0;
+}
+
+void grShaderCacheLoad(const char *rom_name)
+{
+   FILE *f;
+   long size;
+   uint32_t header[3], hash;
+   uint8_t *data         = NULL;
+   const uint8_t *p, *end;
+   unsigned loaded       = 0;
+   unsigned records      = 0;
+
+   shader_cache_path[0] = '\0';
+
+   if (!shader_cache_supported || !rom_name)
+      return;
+
+   snprintf(shader_cache_path, sizeof(shader_cache_path),
+         "%s/glide64_%08x.shaders", ConfigGetUserCachePath(),
+         shader_cache_hash(FNV_BASIS, rom_name, strlen(rom_name)));
+
+   f = fopen(shader_cache_path, "rb");
+   if (!f)
+      return;
+
+   fseek(f, 0, SEEK_END);
+   size = ftell(f);
+   fseek(f, 0, SEEK_SET);
+
+   if (size > (long)(sizeof(header) + sizeof(hash)))
+   {
+      data = (uint8_t*)malloc(size);
+      if (data && fread(data, 1, size, f) != (size_t)size)
+      {
+         free(data);
+         data = NULL;
+      }
+   }
+   fclose(f);
+
+   if (!data)
+      return;
+
+   p   = data;
+   end = data + size - sizeof(hash);
+   memcpy(&hash, end, sizeof(hash));
+
+   if (hash != shader_cache_hash(FNV_BASIS, data, end - data))
+   {
+      if (log_cb)
+         log_cb(RETRO_LOG_WARN, "Shader cache %s is damaged, ignoring it.\n",
+               shader_cache_path);
+      goto done;
+   }
+
+   shader_cache_read(&p, end, header, sizeof(header));
+   if (header[0] != SHADER_CACHE_MAGIC || header[1] != SHADER_CACHE_VERSION ||
+         header[2] != shader_cache_environment())
+   {
+      if (log_cb)
+         log_cb(RETRO_LOG_INFO, "Shader cache %s is out of date, ignoring it.\n",
+               shader_cache_path);
+      goto done;
+   }
+
+   while (p < end)
+   {
+      shader_key key;
+      shader_program_key *shader;
+      uint32_t uses, format, length;
+      GLint linked = 0;
+
+      if (!shader_cache_read(&p, end, &key, sizeof(key)) ||
+            !shader_cache_read(&p, end, &uses, sizeof(uses)) ||
+            !shader_cache_read(&p, end, &format, sizeof(format)) ||
+            !shader_cache_read(&p, end, &length, sizeof(length)) ||
+            (size_t)(end - p) < length)
+         break;
+
+      records++;
+
+      HASH_FIND(hh, shader_programs, &key, sizeof(key), shader);
+      if (shader)
+      {
+         p += length;
+         continue;
+      }
+
+      shader                 = (shader_program_key*)calloc(1, sizeof(*shader));
+      shader->key            = key;
+      shader->uses           = uses;
+      shader->program_object = glCreateProgram();
+
+      glProgramParameteri(shader->program_object,
+            GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      glProgramBinary(shader->program_object, format, p, length);
+      p += length;
+
+      /* The driver may still turn down a binary it wrote itself. */
+      glGetProgramiv(shader->program_object, GL_LINK_STATUS, &linked);
+      if (!linked)
+      {
+         glDeleteProgram(shader->program_object);
+         free(shader);
+         continue;
+      }
+
+      shader_find_uniforms(shader);
+      HASH_ADD(hh, shader_programs, key, sizeof(shader_key), shader);
+      loaded++;
+   }
+
+   if (log_cb)
+      log_cb(RETRO_LOG_INFO, "Loaded %u of %u shader programs from %s.\n",
+            loaded, records, shader_cache_path);
+
+done:
+   free(data);
+}
+
+static void shader_cache_save(void)
+{
+   FILE *f;
+   shader_program_key **list, *shader, *tmp;
+   char tmp_path[PATH_MAX_LENGTH + 4];
+   uint32_t header[3];
+   uint32_t hash    = FNV_BASIS;
+   uint8_t *binary  = NULL;
+   GLint capacity   = 0;
+   unsigned count   = 0;
+   unsigned written = 0;
+   unsigned i;
+   bool ok          = true;
+
+   if (!shader_cache_path[0] || !shader_programs)
+      return;
+
+   list = (shader_program_key**)malloc(HASH_COUNT(shader_programs) * sizeof(*list));
+   if (!list)
+      return;
+
+   HASH_ITER(hh, shader_programs, shader, tmp)
+      list[count++] = shader;
+   qsort(list, count, sizeof(*list), shader_cache_compare);
+   if (count > SHADER_CACHE_MAX)
+      count = SHADER_CACHE_MAX;
+
+   snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", shader_cache_path);
+   f = fopen(tmp_path, "wb");
+   if (!f)
+   {
+      free(list);
+      return;
+   }
+
+   header[0] = SHADER_CACHE_MAGIC;
+   header[1] = SHADER_CACHE_VERSION;
+   header[2] = shader_cache_environment();
+   ok = shader_cache_write(f, &hash, header, sizeof(header));
+
+   for (i = 0; i < count && ok; i++)
+   {
+      GLint length  = 0;
+      GLenum format = 0;
+      uint32_t uses, format32, length32;
+
+      shader = list[i];
+      glGetProgramiv(shader->program_object, GL_PROGRAM_BINARY_LENGTH, &length);
+      if (length <= 0)
+         continue;
+
+      if (length > capacity)
+      {
+         uint8_t *new_binary = (uint8_t*)realloc(binary, length);
+         if (!new_binary)
+            continue;
+         binary   = new_binary;
+         capacity = length;
+      }
+
+      glGetProgramBinary(shader->program_object, capacity, &length, &format, binary);
+      if (length <= 0)
+         continue;
+
+      uses     = (shader->uses + 1) / 2;
+      format32 = format;
+      length32 = length;
+
+      ok = shader_cache_write(f, &hash, &shader->key, sizeof(shader->key)) &&
+         shader_cache_write(f, &hash, &uses, sizeof(uses)) &&
+         shader_cache_write(f, &hash, &format32, sizeof(format32)) &&
+         shader_cache_write(f, &hash, &length32, sizeof(length32)) &&
+         shader_cache_write(f, &hash, binary, length);
+      written++;
+   }
+
+   if (ok)
+      ok = fwrite(&hash, 1, sizeof(hash), f) == sizeof(hash);
+   if (fclose(f) != 0)
+      ok = false;
+
+   /* Nothing could be read back (e.g. the context is already gone), keep
+    * the previous file. */
+   if (!ok || written == 0)
+      remove(tmp_path);
+   else
+   {
+      remove(shader_cache_path);
+      if (rename(tmp_path, shader_cache_path) == 0 && log_cb)
+         log_cb(RETRO_LOG_INFO, "Saved %u shader programs to %s.\n",
+               written, shader_cache_path);
+   }
+
+   shader_cache_path[0] = '\0';
+   free(binary);
+   free(list);
+}
+#else
+void grShaderCacheLoad(const char *rom_name)
+{
+}
+#endif
+
 static void finish_shader_program_setup(shader_program_key *shader)
 {
    GLuint fragshader = glCreateShader(GL_FRAGMENT_SHADER);
@@ -523,29 +812,48 @@ static void finish_shader_program_setup(shader_program_key *shader)
 
    shader_bind_attributes(shader);
 
+#ifdef HAVE_SHADER_CACHE
+   if (shader_cache_supported)
+      glProgramParameteri(shader->program_object,
+            GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+
    glLinkProgram(shader->program_object);
    check_link(shader->program_object);
+   glDeleteShader(fragshader);
    glUseProgram(shader->program_object);
 
    shader_find_uniforms(shader);
-   append_shader_program(shader);
+   HASH_ADD(hh, shader_programs, key, sizeof(shader_key), shader);
 }
 
 void init_combiner(void)
 {
-   shader_program_key shader;
+   shader_program_key *shader, *tmp;
 
-   if (shader_programs)
-      free(shader_programs);
+   /* Left over from a previous context, the programs are gone with it. */
+   HASH_ITER(hh, shader_programs, shader, tmp)
+   {
+      HASH_DEL(shader_programs, shader);
+      free(shader);
+   }
+   current_shader = NULL;
 
-   number_of_programs = 0;
-   shader_programs    = NULL;
-   current_shader     = NULL;
+   if (fragment_shader)
+      free(fragment_shader);
    fragment_shader    = (char*)malloc(4096*2);
    need_to_compile    = true;
 
+#ifdef HAVE_SHADER_CACHE
+   {
+      GLint formats = 0;
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+      shader_cache_supported = formats > 0;
+   }
+#endif
+
    /* default shader */
-   memset(&shader, 0, sizeof(shader));
+   shader = (shader_program_key*)calloc(1, sizeof(*shader));
 
    strcpy(fragment_shader, fragment_shader_header);
    strcat(fragment_shader, fragment_shader_default);
@@ -556,13 +864,13 @@ void init_combiner(void)
    glCompileShader(vertex_shader_object);
    check_compile(vertex_shader_object);
 
-   finish_shader_program_setup(&shader);
-   program_object_default = shader.program_object;
+   finish_shader_program_setup(shader);
+   program_object_default = shader->program_object;
 
-   use_shader_program(&shader);
+   use_shader_program(shader);
 
-   glUniform1i(shader.texture0_location, 0);
-   glUniform1i(shader.texture1_location, 1);
+   glUniform1i(shader->texture0_location, 0);
+   glUniform1i(shader->texture1_location, 1);
 
    strcpy(fragment_shader_color_combiner, "");
    strcpy(fragment_shader_alpha_combiner, "");
@@ -666,57 +974,35 @@ static void update_uniforms(const shader_program_key *prog)
 
 void compile_shader(void)
 {
-   shader_program_key shader;
-   int i;
+   shader_key key;
+   shader_program_key *shader;
 
    need_to_compile = 0;
 
-   for( i = 0; i < number_of_programs; i++)
+   key.color_combiner      = color_combiner_key;
+   key.alpha_combiner      = alpha_combiner_key;
+   key.texture0_combiner   = texture0_combiner_key;
+   key.texture1_combiner   = texture1_combiner_key;
+   key.texture0_combinera  = texture0_combinera_key;
+   key.texture1_combinera  = texture1_combinera_key;
+   key.fog_enabled         = fog_enabled;
+   key.chroma_enabled      = chroma_enabled;
+   key.dither_enabled      = dither_enabled;
+   key.three_point_filter0 = three_point_filter[0];
+   key.three_point_filter1 = three_point_filter[1];
+
+   HASH_FIND(hh, shader_programs, &key, sizeof(key), shader);
+   if (shader)
    {
-      shader_program_key *program = &shader_programs[i];
-      if(program->color_combiner == color_combiner_key &&
-            program->alpha_combiner == alpha_combiner_key &&
-            program->texture0_combiner == texture0_combiner_key &&
-            program->texture1_combiner == texture1_combiner_key &&
-            program->texture0_combinera == texture0_combinera_key &&
-            program->texture1_combinera == texture1_combinera_key &&
-            program->fog_enabled == fog_enabled &&
-            program->chroma_enabled == chroma_enabled &&
-            program->dither_enabled == dither_enabled &&
-            program->three_point_filter0 == three_point_filter[0] &&
-            program->three_point_filter1 == three_point_filter[1])
-      {
-         use_shader_program(program);
-         update_uniforms(program);
-         return;
-      }
+      shader->uses++;
+      use_shader_program(shader);
+      update_uniforms(shader);
+      return;
    }
 
-   shader.color_combiner        = color_combiner_key;
-   shader.alpha_combiner        = alpha_combiner_key;
-   shader.texture0_combiner     = texture0_combiner_key;
-   shader.texture1_combiner     = texture1_combiner_key;
-   shader.texture0_combinera    = texture0_combinera_key;
-   shader.texture1_combinera    = texture1_combinera_key;
-   shader.fog_enabled           = fog_enabled;
-   shader.chroma_enabled        = chroma_enabled;
-   shader.dither_enabled        = dither_enabled;
-   shader.three_point_filter0   = three_point_filter[0];
-   shader.three_point_filter1   = three_point_filter[1];
-   shader.program_object        = 0;
-   shader.texture0_location     = 0;
-   shader.texture1_location     = 0;
-   shader.vertexOffset_location = 0;
-   shader.textureSizes_location = 0;
-   shader.exactSizes_location   = 0;
-   shader.fogModeEndScale_location   = 0;
-   shader.fogColor_location     = 0;
-   shader.alphaRef_location     = 0;
-   shader.chroma_color_location = 0;
-   shader.lambda_location       = 0;
-   shader.constant_color_location = 0;
-   shader.ccolor0_location      = 0;
-   shader.ccolor1_location      = 0;
+   shader       = (shader_program_key*)calloc(1, sizeof(*shader));
+   shader->key  = key;
+   shader->uses = 1;
 
    strcpy(fragment_shader, fragment_shader_header);
 
@@ -742,24 +1028,26 @@ void compile_shader(void)
 
    strcat(fragment_shader, fragment_shader_end);
 
-   finish_shader_program_setup(&shader);
+   finish_shader_program_setup(shader);
+   current_shader = shader;
 
-   update_uniforms(&shader);
+   update_uniforms(shader);
 }
 
 void free_combiners(void)
 {
-   if (shader_programs)
-   {
-      shader_program_key *s = shader_programs;
+   shader_program_key *shader, *tmp;
 
-      while (number_of_programs--)
-      {
-         if (glIsProgram(s->program_object))
-            glDeleteProgram(s->program_object);
-      }
+#ifdef HAVE_SHADER_CACHE
+   shader_cache_save();
+#endif
 
-      free(shader_programs);
+   HASH_ITER(hh, shader_programs, shader, tmp)
+   {
+      HASH_DEL(shader_programs, shader);
+      if (glIsProgram(shader->program_object))
+         glDeleteProgram(shader->program_object);
+      free(shader);
    }
 
    if (fragment_shader)
@@ -768,8 +1056,6 @@ void free_combiners(void)
    shader_programs = NULL;
    current_shader  = NULL;
    fragment_shader = NULL;
-
-   number_of_programs = 0;
 }
 
 void set_copy_shader(void)
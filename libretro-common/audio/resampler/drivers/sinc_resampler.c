@@ -38,9 +38,25 @@
 #include <xmmintrin.h>
 #endif
 
-#if defined(__AVX__) && ENABLE_AVX
+/* AVX and AVX2/FMA kernels are built with per-function target attributes
+ * and picked at runtime from the CPU feature mask. */
+#if (defined(__x86_64__) || defined(__i386__)) && \
+   (defined(__clang__) || (defined(__GNUC__) && \
+   (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SINC_HAVE_AVX_DISPATCH 1
+#define SINC_TARGET_AVX __attribute__((target("avx")))
+#define SINC_TARGET_FMA __attribute__((target("avx2,fma")))
 #include <immintrin.h>
+#elif defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define SINC_KERNEL static INLINE __attribute__((always_inline))
+#else
+#define SINC_KERNEL static INLINE
 #endif
+#define SINC_TARGET_NONE
 
 /* Rough SNR values for upsampling:
  * LOWEST: 40 dB
@@ -108,7 +124,9 @@
  * SSE1 is faster than AVX for some reason.
  * AVX code is kept here though as by increasing number
  * of sinc taps, the AVX code is clearly faster than SSE1.
+ * When AVX is picked at runtime, this is the cutoff.
  */
+#define SINC_AVX_MIN_TAPS 32
 
 #define PHASES (1 << (PHASE_BITS + SUBPHASE_BITS))
 
@@ -132,187 +150,393 @@ typedef struct rarch_sinc_resampler
     * Ensure that we get as good cache locality as we can hope for. */
    float *main_buffer;
 
-   bool neon_enabled;
+   /* Picked from the CPU feature mask in resampler_sinc_new(). */
+   void (*process)(struct rarch_sinc_resampler *resamp,
+         struct resampler_data *data);
+   void (*process_s16)(struct rarch_sinc_resampler *resamp,
+         struct resampler_data_s16 *data);
 } rarch_sinc_resampler_t;
 
-#if defined(__ARM_NEON__) && !defined(SINC_COEFF_LERP)
+#if defined(__ARM_NEON__) && defined(HAVE_NEON) && !SINC_COEFF_LERP
+#define SINC_HAVE_NEON 1
 /* Assumes that taps >= 8, and that taps is a multiple of 8. */
 void process_sinc_neon_asm(float *out, const float *left, 
       const float *right, const float *coeff, unsigned taps);
 #endif
 
-static void resampler_sinc_process(void *re_, struct resampler_data *data)
-{
-   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+/* Each kernel computes one stereo output frame for the current
+ * resampler position. */
 
-   uint32_t ratio                 = PHASES / data->ratio;
-   const float *input             = data->data_in;
-   float *output                  = data->data_out;
-   size_t frames                  = data->input_frames;
-   size_t out_frames              = 0;
+SINC_KERNEL void sinc_kernel_c(const rarch_sinc_resampler_t *resamp,
+      float *output)
+{
+   unsigned i;
+   const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+   const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+   unsigned taps            = resamp->taps;
+   unsigned phase           = resamp->time >> SUBPHASE_BITS;
+   float sum_l              = 0.0f;
+   float sum_r              = 0.0f;
+#if SINC_COEFF_LERP
+   const float *phase_table = resamp->phase_table + phase * taps * 2;
+   const float *delta_table = phase_table + taps;
+   float delta              = (float)
+      (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD;
+#else
+   const float *phase_table = resamp->phase_table + phase * taps;
+#endif
 
-   while (frames)
+   for (i = 0; i < taps; i++)
    {
-      while (frames && resamp->time >= PHASES)
-      {
-         /* Push in reverse to make filter more obvious. */
-         if (!resamp->ptr)
-            resamp->ptr = resamp->taps;
-         resamp->ptr--;
+#if SINC_COEFF_LERP
+      float sinc_val = phase_table[i] + delta_table[i] * delta;
+#else
+      float sinc_val = phase_table[i];
+#endif
+      sum_l         += buffer_l[i] * sinc_val;
+      sum_r         += buffer_r[i] * sinc_val;
+   }
 
-         resamp->buffer_l[resamp->ptr + resamp->taps] = 
-         resamp->buffer_l[resamp->ptr]                = *input++;
+   output[0] = sum_l;
+   output[1] = sum_r;
+}
 
-         resamp->buffer_r[resamp->ptr + resamp->taps] = 
-         resamp->buffer_r[resamp->ptr]                = *input++;
+#if defined(__SSE__)
+SINC_KERNEL void sinc_kernel_sse(const rarch_sinc_resampler_t *resamp,
+      float *output)
+{
+   unsigned i;
+   __m128 sum;
+   const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+   const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+   unsigned taps            = resamp->taps;
+   unsigned phase           = resamp->time >> SUBPHASE_BITS;
+   __m128 sum_l             = _mm_setzero_ps();
+   __m128 sum_r             = _mm_setzero_ps();
+#if SINC_COEFF_LERP
+   const float *phase_table = resamp->phase_table + phase * taps * 2;
+   const float *delta_table = phase_table + taps;
+   __m128 delta             = _mm_set1_ps((float)
+         (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD);
+#else
+   const float *phase_table = resamp->phase_table + phase * taps;
+#endif
 
-         resamp->time                                -= PHASES;
-         frames--;
-      }
+   for (i = 0; i < taps; i += 4)
+   {
+      __m128 buf_l = _mm_loadu_ps(buffer_l + i);
+      __m128 buf_r = _mm_loadu_ps(buffer_r + i);
 
-      while (resamp->time < PHASES)
-      {
-         unsigned i;
-         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
-         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
-         unsigned taps            = resamp->taps;
-         unsigned phase           = resamp->time >> SUBPHASE_BITS;
 #if SINC_COEFF_LERP
-         const float *phase_table = resamp->phase_table + phase * taps * 2;
-         const float *delta_table = phase_table + taps;
+      __m128 deltas = _mm_load_ps(delta_table + i);
+      __m128 _sinc  = _mm_add_ps(_mm_load_ps(phase_table + i),
+            _mm_mul_ps(deltas, delta));
 #else
-         const float *phase_table = resamp->phase_table + phase * taps;
+      __m128 _sinc = _mm_load_ps(phase_table + i);
 #endif
+      sum_l        = _mm_add_ps(sum_l, _mm_mul_ps(buf_l, _sinc));
+      sum_r        = _mm_add_ps(sum_r, _mm_mul_ps(buf_r, _sinc));
+   }
 
-#if defined(__AVX__) && ENABLE_AVX
-         __m256 sum_l             = _mm256_setzero_ps();
-         __m256 sum_r             = _mm256_setzero_ps();
-#if SINC_COEFF_LERP
-         __m256 delta             = _mm256_set1_ps((float)
-               (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD);
+   /* Them annoying shuffles.
+    * sum_l = { l3, l2, l1, l0 }
+    * sum_r = { r3, r2, r1, r0 }
+    */
+
+   sum = _mm_add_ps(_mm_shuffle_ps(sum_l, sum_r,
+            _MM_SHUFFLE(1, 0, 1, 0)),
+         _mm_shuffle_ps(sum_l, sum_r, _MM_SHUFFLE(3, 2, 3, 2)));
+
+   /* sum   = { r1, r0, l1, l0 } + { r3, r2, l3, l2 }
+    * sum   = { R1, R0, L1, L0 }
+    */
+
+   sum = _mm_add_ps(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 1, 1)), sum);
+
+   /* sum   = {R1, R1, L1, L1 } + { R1, R0, L1, L0 }
+    * sum   = { X,  R,  X,  L } 
+    */
+
+   /* Store L */
+   _mm_store_ss(output + 0, sum);
+
+   /* movehl { X, R, X, L } == { X, R, X, R } */
+   _mm_store_ss(output + 1, _mm_movehl_ps(sum, sum));
+}
 #endif
 
-         for (i = 0; i < taps; i += 8)
-         {
-            __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
-            __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+#if defined(SINC_HAVE_AVX_DISPATCH) || (defined(__AVX__) && ENABLE_AVX)
+#ifndef SINC_TARGET_AVX
+#define SINC_TARGET_AVX
+#endif
 
+/* Folds the two 256-bit accumulators down to { L, R }. */
+#define SINC_AVX_STORE(output, sum_l, sum_r) \
+   do { \
+      /* hadd on AVX is weird, and acts on low-lanes \
+       * and high-lanes separately. */ \
+      __m256 res_l = _mm256_hadd_ps(sum_l, sum_l); \
+      __m256 res_r = _mm256_hadd_ps(sum_r, sum_r); \
+      res_l        = _mm256_hadd_ps(res_l, res_l); \
+      res_r        = _mm256_hadd_ps(res_r, res_r); \
+      res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l); \
+      res_r        = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r); \
+      _mm_store_ss(output + 0, _mm256_castps256_ps128(res_l)); \
+      _mm_store_ss(output + 1, _mm256_castps256_ps128(res_r)); \
+   } while (0)
+
+SINC_KERNEL SINC_TARGET_AVX void sinc_kernel_avx(
+      const rarch_sinc_resampler_t *resamp, float *output)
+{
+   unsigned i;
+   const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+   const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+   unsigned taps            = resamp->taps;
+   unsigned phase           = resamp->time >> SUBPHASE_BITS;
+   __m256 sum_l             = _mm256_setzero_ps();
+   __m256 sum_r             = _mm256_setzero_ps();
 #if SINC_COEFF_LERP
-            __m256 deltas = _mm256_load_ps(delta_table + i);
-            __m256 sinc   = _mm256_add_ps(_mm256_load_ps(phase_table + i),
-                  _mm256_mul_ps(deltas, delta));
+   const float *phase_table = resamp->phase_table + phase * taps * 2;
+   const float *delta_table = phase_table + taps;
+   __m256 delta             = _mm256_set1_ps((float)
+         (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD);
 #else
-            __m256 sinc   = _mm256_load_ps(phase_table + i);
+   const float *phase_table = resamp->phase_table + phase * taps;
 #endif
-            sum_l         = _mm256_add_ps(sum_l, _mm256_mul_ps(buf_l, sinc));
-            sum_r         = _mm256_add_ps(sum_r, _mm256_mul_ps(buf_r, sinc));
-         }
 
-         /* hadd on AVX is weird, and acts on low-lanes 
-          * and high-lanes separately. */
-         __m256 res_l = _mm256_hadd_ps(sum_l, sum_l);
-         __m256 res_r = _mm256_hadd_ps(sum_r, sum_r);
-         res_l        = _mm256_hadd_ps(res_l, res_l);
-         res_r        = _mm256_hadd_ps(res_r, res_r);
-         res_l        = _mm256_add_ps(_mm256_permute2f128_ps(res_l, res_l, 1), res_l);
-         res_r        = _mm256_add_ps(_mm256_permute2f128_ps(res_r, res_r, 1), res_r);
-
-         /* This is optimized to mov %xmmN, [mem].
-          * There doesn't seem to be any _mm256_store_ss intrinsic. */
-         _mm_store_ss(output + 0, _mm256_extractf128_ps(res_l, 0));
-         _mm_store_ss(output + 1, _mm256_extractf128_ps(res_r, 0));
-#elif defined(__SSE__)
-         __m128 sum;
-         __m128 sum_l             = _mm_setzero_ps();
-         __m128 sum_r             = _mm_setzero_ps();
+   for (i = 0; i < taps; i += 8)
+   {
+      __m256 buf_l  = _mm256_loadu_ps(buffer_l + i);
+      __m256 buf_r  = _mm256_loadu_ps(buffer_r + i);
+
 #if SINC_COEFF_LERP
-         __m128 delta             = _mm_set1_ps((float)
-               (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD);
+      __m256 deltas = _mm256_load_ps(delta_table + i);
+      __m256 sinc   = _mm256_add_ps(_mm256_load_ps(phase_table + i),
+            _mm256_mul_ps(deltas, delta));
+#else
+      __m256 sinc   = _mm256_load_ps(phase_table + i);
 #endif
+      sum_l         = _mm256_add_ps(sum_l, _mm256_mul_ps(buf_l, sinc));
+      sum_r         = _mm256_add_ps(sum_r, _mm256_mul_ps(buf_r, sinc));
+   }
 
-         for (i = 0; i < taps; i += 4)
-         {
-            __m128 buf_l = _mm_loadu_ps(buffer_l + i);
-            __m128 buf_r = _mm_loadu_ps(buffer_r + i);
+   SINC_AVX_STORE(output, sum_l, sum_r);
+}
+#endif
 
+#if defined(SINC_HAVE_AVX_DISPATCH)
+SINC_KERNEL SINC_TARGET_FMA void sinc_kernel_fma(
+      const rarch_sinc_resampler_t *resamp, float *output)
+{
+   unsigned i;
+   const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+   const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+   unsigned taps            = resamp->taps;
+   unsigned phase           = resamp->time >> SUBPHASE_BITS;
+   __m256 sum_l             = _mm256_setzero_ps();
+   __m256 sum_r             = _mm256_setzero_ps();
 #if SINC_COEFF_LERP
-            __m128 deltas = _mm_load_ps(delta_table + i);
-            __m128 _sinc  = _mm_add_ps(_mm_load_ps(phase_table + i),
-                  _mm_mul_ps(deltas, delta));
+   const float *phase_table = resamp->phase_table + phase * taps * 2;
+   const float *delta_table = phase_table + taps;
+   __m256 delta             = _mm256_set1_ps((float)
+         (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD);
 #else
-            __m128 _sinc = _mm_load_ps(phase_table + i);
+   const float *phase_table = resamp->phase_table + phase * taps;
 #endif
-            sum_l        = _mm_add_ps(sum_l, _mm_mul_ps(buf_l, _sinc));
-            sum_r        = _mm_add_ps(sum_r, _mm_mul_ps(buf_r, _sinc));
-         }
 
-         /* Them annoying shuffles.
-          * sum_l = { l3, l2, l1, l0 }
-          * sum_r = { r3, r2, r1, r0 }
-          */
+   for (i = 0; i < taps; i += 8)
+   {
+#if SINC_COEFF_LERP
+      __m256 sinc = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i),
+            delta, _mm256_load_ps(phase_table + i));
+#else
+      __m256 sinc = _mm256_load_ps(phase_table + i);
+#endif
+      sum_l       = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i), sinc, sum_l);
+      sum_r       = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i), sinc, sum_r);
+   }
 
-         sum = _mm_add_ps(_mm_shuffle_ps(sum_l, sum_r,
-                  _MM_SHUFFLE(1, 0, 1, 0)),
-               _mm_shuffle_ps(sum_l, sum_r, _MM_SHUFFLE(3, 2, 3, 2)));
+   SINC_AVX_STORE(output, sum_l, sum_r);
+}
+#endif
 
-         /* sum   = { r1, r0, l1, l0 } + { r3, r2, l3, l2 }
-          * sum   = { R1, R0, L1, L0 }
-          */
+#if defined(SINC_HAVE_NEON)
+SINC_KERNEL void sinc_kernel_neon(const rarch_sinc_resampler_t *resamp,
+      float *output)
+{
+   process_sinc_neon_asm(output,
+         resamp->buffer_l + resamp->ptr,
+         resamp->buffer_r + resamp->ptr,
+         resamp->phase_table + (resamp->time >> SUBPHASE_BITS) * resamp->taps,
+         resamp->taps);
+}
+#endif
 
-         sum = _mm_add_ps(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 1, 1)), sum);
+typedef void (*sinc_kernel_t)(const rarch_sinc_resampler_t *resamp,
+      float *output);
 
-         /* sum   = {R1, R1, L1, L1 } + { R1, R0, L1, L0 }
-          * sum   = { X,  R,  X,  L } 
-          */
+SINC_KERNEL void sinc_push_frame(rarch_sinc_resampler_t *resamp,
+      float l, float r)
+{
+   /* Push in reverse to make filter more obvious. */
+   if (!resamp->ptr)
+      resamp->ptr = resamp->taps;
+   resamp->ptr--;
 
-         /* Store L */
-         _mm_store_ss(output + 0, sum);
+   resamp->buffer_l[resamp->ptr + resamp->taps] = 
+   resamp->buffer_l[resamp->ptr]                = l;
 
-         /* movehl { X, R, X, L } == { X, R, X, R } */
-         _mm_store_ss(output + 1, _mm_movehl_ps(sum, sum));
-#elif defined(__ARM_NEON__) && !defined(SINC_COEFF_LERP)
-         if (resamp->neon_enabled)
-         {
-            process_sinc_neon_asm(output, buffer_l, buffer_r, phase_table, taps);
+   resamp->buffer_r[resamp->ptr + resamp->taps] = 
+   resamp->buffer_r[resamp->ptr]                = r;
+}
 
-            output += 2;
-            out_frames++;
-            resamp->time += ratio;
-            continue;
-         }
-#else
-         {
-            /* Plain ol' C */
-            float sum_l              = 0.0f;
-            float sum_r              = 0.0f;
-#if SINC_COEFF_LERP
-            float delta              = (float)
-               (resamp->time & SUBPHASE_MASK) * SUBPHASE_MOD;
+SINC_KERNEL void sinc_process_float(rarch_sinc_resampler_t *resamp,
+      struct resampler_data *data, sinc_kernel_t kernel)
+{
+   uint32_t ratio                 = PHASES / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= PHASES)
+      {
+         sinc_push_frame(resamp, input[0], input[1]);
+         input        += 2;
+         resamp->time -= PHASES;
+         frames--;
+      }
+
+      while (resamp->time < PHASES)
+      {
+         kernel(resamp, output);
+         output += 2;
+         out_frames++;
+         resamp->time += ratio;
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+
+/* Output frames are converted to s16 in blocks of this many frames,
+ * converting each frame on its own costs more than the kernel. */
+#define SINC_S16_BLOCK 64
+
+SINC_KERNEL void sinc_block_to_s16(int16_t *out, const float *in,
+      size_t samples)
+{
+   size_t i = 0;
+#if defined(__SSE2__)
+   __m128 factor = _mm_set1_ps((float)0x8000);
+
+   for (; i + 8 <= samples; i += 8)
+   {
+      __m128i ints_l = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(in + i), factor));
+      __m128i ints_r = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(in + i + 4), factor));
+      _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(ints_l, ints_r));
+   }
 #endif
 
-            for (i = 0; i < taps; i++)
-            {
-#if SINC_COEFF_LERP
-               float sinc_val = phase_table[i] + delta_table[i] * delta;
+   for (; i < samples; i++)
+   {
+      /* Biasing by 0x8000 keeps the value positive so truncation rounds
+       * to nearest for both signs. */
+      float val = in[i] * (float)0x8000 + ((float)0x8000 + 0.5f);
+      val       = val < 0.0f ? 0.0f : val;
+      val       = val > (float)0xFFFF ? (float)0xFFFF : val;
+      out[i]    = (int16_t)((int32_t)val - 0x8000);
+   }
+}
+
+/* Same as sinc_process_float(), but reads and writes interleaved s16
+ * directly so callers don't need the two full-buffer conversions. */
+SINC_KERNEL void sinc_process_s16(rarch_sinc_resampler_t *resamp,
+      struct resampler_data_s16 *data, sinc_kernel_t kernel)
+{
+#if defined(__GNUC__)
+   float block[2 * SINC_S16_BLOCK] __attribute__((aligned(16)));
 #else
-               float sinc_val = phase_table[i];
+   float block[2 * SINC_S16_BLOCK];
 #endif
-               sum_l         += buffer_l[i] * sinc_val;
-               sum_r         += buffer_r[i] * sinc_val;
-            }
+   unsigned block_frames          = 0;
+   const float scale              = 1.0f / 0x8000;
+   uint32_t ratio                 = PHASES / data->ratio;
+   const int16_t *input           = data->data_in;
+   int16_t *output                = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
 
-            output[0] = sum_l;
-            output[1] = sum_r;
-         }
-#endif
+   while (frames)
+   {
+      while (frames && resamp->time >= PHASES)
+      {
+         sinc_push_frame(resamp, input[0] * scale, input[1] * scale);
+         input        += 2;
+         resamp->time -= PHASES;
+         frames--;
+      }
 
-         output += 2;
-         out_frames++;
+      while (resamp->time < PHASES)
+      {
+         kernel(resamp, block + 2 * block_frames);
          resamp->time += ratio;
+
+         if (++block_frames == SINC_S16_BLOCK)
+         {
+            sinc_block_to_s16(output, block, 2 * SINC_S16_BLOCK);
+            output       += 2 * SINC_S16_BLOCK;
+            out_frames   += SINC_S16_BLOCK;
+            block_frames  = 0;
+         }
       }
    }
 
-   data->output_frames = out_frames;
+   sinc_block_to_s16(output, block, 2 * block_frames);
+   data->output_frames = out_frames + block_frames;
+}
+
+/* Instantiates both process loops with the kernel inlined, compiled for
+ * the kernel's instruction set. */
+#define SINC_DEFINE_PROCESS(name, target) \
+static target void resampler_sinc_process_##name( \
+      rarch_sinc_resampler_t *resamp, struct resampler_data *data) \
+{ \
+   sinc_process_float(resamp, data, sinc_kernel_##name); \
+} \
+static target void resampler_sinc_process_s16_##name( \
+      rarch_sinc_resampler_t *resamp, struct resampler_data_s16 *data) \
+{ \
+   sinc_process_s16(resamp, data, sinc_kernel_##name); \
+}
+
+SINC_DEFINE_PROCESS(c, SINC_TARGET_NONE)
+#if defined(__SSE__)
+SINC_DEFINE_PROCESS(sse, SINC_TARGET_NONE)
+#endif
+#if defined(SINC_HAVE_AVX_DISPATCH) || (defined(__AVX__) && ENABLE_AVX)
+SINC_DEFINE_PROCESS(avx, SINC_TARGET_AVX)
+#endif
+#if defined(SINC_HAVE_AVX_DISPATCH)
+SINC_DEFINE_PROCESS(fma, SINC_TARGET_FMA)
+#endif
+#if defined(SINC_HAVE_NEON)
+SINC_DEFINE_PROCESS(neon, SINC_TARGET_NONE)
+#endif
+
+static void resampler_sinc_process(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   resamp->process(resamp, data);
+}
+
+static void resampler_sinc_process_s16(void *re_,
+      struct resampler_data_s16 *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   resamp->process_s16(resamp, data);
 }
 
 static void sinc_init_table(rarch_sinc_resampler_t *resamp, double cutoff,
@@ -380,11 +604,67 @@ static void resampler_sinc_free(void *data)
    free(resamp);
 }
 
+/* Picks the process loops for the running CPU.
+ * Returns the number of taps the chosen kernel handles per step. */
+static unsigned resampler_sinc_select(rarch_sinc_resampler_t *re,
+      resampler_simd_mask_t mask)
+{
+#if defined(SINC_HAVE_AVX_DISPATCH)
+   /* The 256-bit horizontal sum only pays off with long filters,
+    * for the short ones SSE wins (see tools/resampler_bench.c). */
+   if (re->taps < SINC_AVX_MIN_TAPS)
+      mask &= ~(RESAMPLER_SIMD_AVX | RESAMPLER_SIMD_AVX2);
+
+   /* There is no FMA bit in the mask, every AVX2 CPU we care about
+    * has it but ask the compiler's CPU probe to be sure. */
+   __builtin_cpu_init();
+   if ((mask & RESAMPLER_SIMD_AVX2) && __builtin_cpu_supports("fma"))
+   {
+      re->process     = resampler_sinc_process_fma;
+      re->process_s16 = resampler_sinc_process_s16_fma;
+      return 8;
+   }
+   if (mask & RESAMPLER_SIMD_AVX)
+   {
+      re->process     = resampler_sinc_process_avx;
+      re->process_s16 = resampler_sinc_process_s16_avx;
+      return 8;
+   }
+#elif defined(__AVX__) && ENABLE_AVX
+   if (mask & RESAMPLER_SIMD_AVX)
+   {
+      re->process     = resampler_sinc_process_avx;
+      re->process_s16 = resampler_sinc_process_s16_avx;
+      return 8;
+   }
+#endif
+#if defined(__SSE__)
+   if (mask & RESAMPLER_SIMD_SSE)
+   {
+      re->process     = resampler_sinc_process_sse;
+      re->process_s16 = resampler_sinc_process_s16_sse;
+      return 4;
+   }
+#endif
+#if defined(SINC_HAVE_NEON)
+   if (mask & RESAMPLER_SIMD_NEON)
+   {
+      re->process     = resampler_sinc_process_neon;
+      re->process_s16 = resampler_sinc_process_s16_neon;
+      return 8;
+   }
+#endif
+   re->process     = resampler_sinc_process_c;
+   re->process_s16 = resampler_sinc_process_s16_c;
+   return 4;
+}
+
 static void *resampler_sinc_new(const struct resampler_config *config,
       double bandwidth_mod, resampler_simd_mask_t mask)
 {
    double cutoff;
    size_t phase_elems, elems;
+   unsigned simd_width;
    rarch_sinc_resampler_t *re = (rarch_sinc_resampler_t*)
       calloc(1, sizeof(*re));
 
@@ -405,11 +685,8 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    }
 
    /* Be SIMD-friendly. */
-#if (defined(__AVX__) && ENABLE_AVX) || (defined(__ARM_NEON__))
-   re->taps     = (re->taps + 7) & ~7;
-#else
-   re->taps     = (re->taps + 3) & ~3;
-#endif
+   simd_width   = resampler_sinc_select(re, mask);
+   re->taps     = (re->taps + simd_width - 1) & ~(simd_width - 1);
 
    phase_elems  = (1 << PHASE_BITS) * re->taps;
 #if SINC_COEFF_LERP
@@ -428,11 +705,6 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    sinc_init_table(re, cutoff, re->phase_table,
          1 << PHASE_BITS, re->taps, SINC_COEFF_LERP);
 
-#if defined(__ARM_NEON__) 
-   if (mask & RESAMPLER_SIMD_NEON)
-      re->neon_enabled = true;
-#endif
-
    return re;
 
 error:
@@ -446,5 +718,6 @@ retro_resampler_t sinc_resampler = {
    resampler_sinc_free,
    RESAMPLER_API_VERSION,
    "sinc",
-   "sinc"
+   "sinc",
+   resampler_sinc_process_s16
 };
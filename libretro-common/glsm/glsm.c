@@ -22,9 +22,16 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <retro_inline.h>
 #include <glsym/glsym.h>
 #include <glsm/glsm.h>
 
+#ifdef GLSM_DEBUG
+#include <retro_assert.h>
+#endif
+
 #ifndef GL_DEPTH_CLAMP
 #define GL_DEPTH_CLAMP                    0x864F
 #define GL_RASTERIZER_DISCARD             0x8C89
@@ -41,6 +48,7 @@ struct gl_cached_state
    struct
    {
       bool used[MAX_ATTRIB];
+      bool known[MAX_ATTRIB];
       GLint size[MAX_ATTRIB];
       GLenum type[MAX_ATTRIB];
       GLboolean normalized[MAX_ATTRIB];
@@ -66,10 +74,11 @@ struct gl_cached_state
 
    struct
    {
-      GLuint r;
-      GLuint g;
-      GLuint b;
-      GLuint a;
+      bool used;
+      GLclampf r;
+      GLclampf g;
+      GLclampf b;
+      GLclampf a;
    } clear_color;
 
    struct
@@ -83,6 +92,7 @@ struct gl_cached_state
 
    struct
    {
+      bool used;
       GLint x;
       GLint y;
       GLsizei w;
@@ -189,15 +199,354 @@ struct gl_cached_state
    GLuint vao;
    GLuint framebuf;
    GLuint array_buffer;
+   GLuint element_array_buffer;
    GLuint program; 
    GLenum active_texture;
    int cap_state[SGL_CAP_MAX];
    int cap_translate[SGL_CAP_MAX];
+
+   /* Set between GLSM_CTL_STATE_BIND and GLSM_CTL_STATE_UNBIND, when
+    * the context holds the state above. Calls that would not change it
+    * are dropped then. The frontend is free to change the state outside
+    * of that, and with HAVE_SHARED_CONTEXT it is never set. */
+   bool bound;
+   /* What the context holds of the state above, once bound. A
+    * disabled capability was left as the frontend had it, a vertex
+    * array object of the core's own holds attributes glsm has not seen,
+    * and the framebuffer is unknown after binding a read or draw one. */
+   bool cap_known[SGL_CAP_MAX];
+   bool vao_known;
+   bool framebuf_known;
+};
+
+/* Uniform values of the linked programs, by program and location, so that
+ * setting a uniform to the value it holds is dropped. Only single values
+ * of up to four 32-bit components are kept; a slot taken by another
+ * uniform after GLSM_UNIFORM_PROBES tries is overwritten. */
+#define GLSM_UNIFORM_SLOTS  1024
+#define GLSM_UNIFORM_PROBES 8
+
+struct glsm_uniform
+{
+   GLuint program;
+   GLint location;
+   unsigned count;
+   bool integer;
+   uint32_t value[4];
 };
 
 static GLint glsm_max_textures;
 static struct retro_hw_render_callback hw_render;
 static struct gl_cached_state gl_state;
+static struct glsm_uniform glsm_uniforms[GLSM_UNIFORM_SLOTS];
+/* Set by a uniform call made while not bound, which went to whichever
+ * program the context had. The values above are forgotten at the next
+ * bind. */
+static bool glsm_uniforms_stale;
+static glsm_stats_t glsm_stats;
+
+/* Counts the call as issued, or as elided and returns true when it is
+ * 'redundant' and the context is bound. */
+static INLINE bool glsm_redundant(unsigned stat, bool redundant)
+{
+   if (gl_state.bound && redundant)
+   {
+      glsm_stats.elided[stat]++;
+      return true;
+   }
+   glsm_stats.issued[stat]++;
+   return false;
+}
+
+static INLINE unsigned glsm_uniform_hash(GLuint program, GLint location)
+{
+   return (program * 2654435761u + (unsigned)location * 40503u)
+      & (GLSM_UNIFORM_SLOTS - 1);
+}
+
+/* Returns true when 'location' of the current program already holds the
+ * 'count' 32-bit components and the context is bound, otherwise
+ * remembers them. */
+static bool glsm_uniform_redundant(GLint location, unsigned count,
+      bool integer, const void *value)
+{
+   struct glsm_uniform *slot, *victim = NULL;
+   unsigned hash, i;
+
+   if (!gl_state.bound)
+   {
+      glsm_uniforms_stale = true;
+      glsm_stats.issued[GLSM_STAT_UNIFORM]++;
+      return false;
+   }
+
+   if (location < 0 || !gl_state.program)
+   {
+      glsm_stats.issued[GLSM_STAT_UNIFORM]++;
+      return false;
+   }
+
+   hash = glsm_uniform_hash(gl_state.program, location);
+   for (i = 0; i < GLSM_UNIFORM_PROBES; i++)
+   {
+      slot = &glsm_uniforms[(hash + i) & (GLSM_UNIFORM_SLOTS - 1)];
+      if (slot->program == gl_state.program && slot->location == location)
+      {
+         if (slot->count == count && slot->integer == integer
+               && !memcmp(slot->value, value, count * sizeof(uint32_t)))
+         {
+            glsm_stats.elided[GLSM_STAT_UNIFORM]++;
+            return true;
+         }
+         victim = slot;
+         break;
+      }
+      if (!victim && !slot->program)
+         victim = slot;
+   }
+
+   if (!victim)
+      victim = &glsm_uniforms[hash];
+
+   victim->program  = gl_state.program;
+   victim->location = location;
+   victim->count    = count;
+   victim->integer  = integer;
+   memcpy(victim->value, value, count * sizeof(uint32_t));
+
+   glsm_stats.issued[GLSM_STAT_UNIFORM]++;
+   return false;
+}
+
+/* Linking resets the uniforms of a program and deleting frees its name. */
+static void glsm_uniform_forget(GLuint program)
+{
+   unsigned i;
+
+   for (i = 0; i < GLSM_UNIFORM_SLOTS; i++)
+      if (glsm_uniforms[i].program == program)
+         glsm_uniforms[i].program = 0;
+}
+
+/* Arrays are set past 'location', one location per element. */
+static void glsm_uniform_forget_array(GLint location, GLsizei count)
+{
+   unsigned i;
+
+   glsm_stats.issued[GLSM_STAT_UNIFORM]++;
+
+   for (i = 0; i < GLSM_UNIFORM_SLOTS; i++)
+      if (glsm_uniforms[i].program == gl_state.program
+            && glsm_uniforms[i].location >= location
+            && glsm_uniforms[i].location < location + count)
+         glsm_uniforms[i].program = 0;
+}
+
+#ifdef GLSM_DEBUG
+static bool glsm_check_failed;
+
+static void glsm_check(const char *name, bool ok)
+{
+   if (ok)
+      return;
+   fprintf(stderr, "[glsm]: %s differs from its shadow.\n", name);
+   glsm_check_failed = true;
+}
+
+static GLint glsm_get_int(GLenum pname)
+{
+   GLint value = 0;
+   glGetIntegerv(pname, &value);
+   return value;
+}
+
+static GLfloat glsm_get_float(GLenum pname)
+{
+   GLfloat value = 0;
+   glGetFloatv(pname, &value);
+   return value;
+}
+
+/* Compares what the calls dropped as redundant rely on with the context,
+ * before each draw. */
+static void glsm_state_check(void)
+{
+   GLint vec[4];
+   GLfloat fvec[4];
+   GLboolean bvec[4];
+   GLint i, unit;
+
+   if (gl_state.bound)
+   {
+      glsm_check("program",
+            glsm_get_int(GL_CURRENT_PROGRAM) == (GLint)gl_state.program);
+      glsm_check("active texture", glsm_get_int(GL_ACTIVE_TEXTURE)
+            == (GLint)(GL_TEXTURE0 + gl_state.active_texture));
+      for (unit = 0; unit < glsm_max_textures; unit++)
+      {
+         glActiveTexture(GL_TEXTURE0 + unit);
+         glsm_check("texture", glsm_get_int(GL_TEXTURE_BINDING_2D)
+               == (GLint)gl_state.bind_textures.ids[unit]);
+      }
+      glActiveTexture(GL_TEXTURE0 + gl_state.active_texture);
+
+      glsm_check("array buffer", glsm_get_int(GL_ARRAY_BUFFER_BINDING)
+            == (GLint)gl_state.array_buffer);
+      if (gl_state.vao_known)
+         glsm_check("element array buffer",
+               glsm_get_int(GL_ELEMENT_ARRAY_BUFFER_BINDING)
+               == (GLint)gl_state.element_array_buffer);
+      if (gl_state.framebuf_known)
+         glsm_check("framebuffer", glsm_get_int(GL_FRAMEBUFFER_BINDING)
+               == (GLint)gl_state.framebuf);
+
+      for (i = 0; i < SGL_CAP_MAX; i++)
+      {
+         GLboolean enabled;
+         if (!gl_state.cap_known[i])
+            continue;
+         enabled = glIsEnabled(gl_state.cap_translate[i]);
+         /* Capabilities the context does not have */
+         if (glGetError() != GL_NO_ERROR)
+            continue;
+         glsm_check("capability", !enabled == !gl_state.cap_state[i]);
+      }
+
+      if (gl_state.blendfunc.used)
+      {
+         glsm_check("blend function",
+               glsm_get_int(GL_BLEND_SRC_RGB) == (GLint)gl_state.blendfunc.sfactor
+               && glsm_get_int(GL_BLEND_DST_RGB) == (GLint)gl_state.blendfunc.dfactor
+               && glsm_get_int(GL_BLEND_SRC_ALPHA) == (GLint)gl_state.blendfunc.sfactor
+               && glsm_get_int(GL_BLEND_DST_ALPHA) == (GLint)gl_state.blendfunc.dfactor);
+      }
+      if (gl_state.blendfunc_separate.used)
+      {
+         glsm_check("separate blend function",
+               glsm_get_int(GL_BLEND_SRC_RGB) == (GLint)gl_state.blendfunc_separate.srcRGB
+               && glsm_get_int(GL_BLEND_DST_RGB) == (GLint)gl_state.blendfunc_separate.dstRGB
+               && glsm_get_int(GL_BLEND_SRC_ALPHA) == (GLint)gl_state.blendfunc_separate.srcAlpha
+               && glsm_get_int(GL_BLEND_DST_ALPHA) == (GLint)gl_state.blendfunc_separate.dstAlpha);
+      }
+      if (gl_state.colormask.used)
+      {
+         glGetBooleanv(GL_COLOR_WRITEMASK, bvec);
+         glsm_check("color mask",
+               !bvec[0] == !gl_state.colormask.red
+               && !bvec[1] == !gl_state.colormask.green
+               && !bvec[2] == !gl_state.colormask.blue
+               && !bvec[3] == !gl_state.colormask.alpha);
+      }
+      if (gl_state.depthmask.used)
+      {
+         glGetBooleanv(GL_DEPTH_WRITEMASK, bvec);
+         glsm_check("depth mask", !bvec[0] == !gl_state.depthmask.mask);
+      }
+      if (gl_state.depthfunc.used)
+         glsm_check("depth function",
+               glsm_get_int(GL_DEPTH_FUNC) == (GLint)gl_state.depthfunc.func);
+      if (gl_state.depthrange.used)
+      {
+         glGetFloatv(GL_DEPTH_RANGE, fvec);
+         glsm_check("depth range",
+               fvec[0] == (GLfloat)gl_state.depthrange.zNear
+               && fvec[1] == (GLfloat)gl_state.depthrange.zFar);
+      }
+      if (gl_state.cleardepth.used)
+         glsm_check("clear depth", glsm_get_float(GL_DEPTH_CLEAR_VALUE)
+               == (GLfloat)gl_state.cleardepth.depth);
+      if (gl_state.clear_color.used)
+      {
+         glGetFloatv(GL_COLOR_CLEAR_VALUE, fvec);
+         glsm_check("clear color",
+               fvec[0] == gl_state.clear_color.r
+               && fvec[1] == gl_state.clear_color.g
+               && fvec[2] == gl_state.clear_color.b
+               && fvec[3] == gl_state.clear_color.a);
+      }
+      if (gl_state.cullface.used)
+         glsm_check("cull face",
+               glsm_get_int(GL_CULL_FACE_MODE) == (GLint)gl_state.cullface.mode);
+      if (gl_state.frontface.used)
+         glsm_check("front face",
+               glsm_get_int(GL_FRONT_FACE) == (GLint)gl_state.frontface.mode);
+      if (gl_state.polygonoffset.used)
+         glsm_check("polygon offset",
+               glsm_get_float(GL_POLYGON_OFFSET_FACTOR) == gl_state.polygonoffset.factor
+               && glsm_get_float(GL_POLYGON_OFFSET_UNITS) == gl_state.polygonoffset.units);
+      if (gl_state.scissor.used)
+      {
+         glGetIntegerv(GL_SCISSOR_BOX, vec);
+         glsm_check("scissor box",
+               vec[0] == gl_state.scissor.x && vec[1] == gl_state.scissor.y
+               && vec[2] == gl_state.scissor.w && vec[3] == gl_state.scissor.h);
+      }
+      if (gl_state.viewport.used)
+      {
+         glGetIntegerv(GL_VIEWPORT, vec);
+         glsm_check("viewport",
+               vec[0] == gl_state.viewport.x && vec[1] == gl_state.viewport.y
+               && vec[2] == gl_state.viewport.w && vec[3] == gl_state.viewport.h);
+      }
+      if (gl_state.stencilfunc.used)
+         glsm_check("stencil function",
+               glsm_get_int(GL_STENCIL_FUNC) == (GLint)gl_state.stencilfunc.func
+               && glsm_get_int(GL_STENCIL_REF) == gl_state.stencilfunc.ref
+               && (GLuint)glsm_get_int(GL_STENCIL_VALUE_MASK) == gl_state.stencilfunc.mask);
+      if (gl_state.stencilop.used)
+         glsm_check("stencil operation",
+               glsm_get_int(GL_STENCIL_FAIL) == (GLint)gl_state.stencilop.sfail
+               && glsm_get_int(GL_STENCIL_PASS_DEPTH_FAIL) == (GLint)gl_state.stencilop.dpfail
+               && glsm_get_int(GL_STENCIL_PASS_DEPTH_PASS) == (GLint)gl_state.stencilop.dppass);
+      if (gl_state.stencilmask.used)
+         glsm_check("stencil mask", (GLuint)glsm_get_int(GL_STENCIL_WRITEMASK)
+               == gl_state.stencilmask.mask);
+
+      for (i = 0; gl_state.vao_known && i < MAX_ATTRIB; i++)
+      {
+         GLint value;
+         GLvoid *pointer = NULL;
+
+         glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &value);
+         glsm_check("vertex attribute array",
+               !value == !gl_state.vertex_attrib_pointer.enabled[i]);
+         if (!gl_state.attrib_pointer.known[i])
+            continue;
+         glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &vec[0]);
+         glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &vec[1]);
+         glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &vec[2]);
+         glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &vec[3]);
+         glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &value);
+         glGetVertexAttribPointerv(i, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+         glsm_check("vertex attribute pointer",
+               vec[0] == gl_state.attrib_pointer.size[i]
+               && vec[1] == (GLint)gl_state.attrib_pointer.type[i]
+               && vec[2] == gl_state.attrib_pointer.stride[i]
+               && vec[3] == (GLint)gl_state.attrib_pointer.buffer[i]
+               && !value == !gl_state.attrib_pointer.normalized[i]
+               && pointer == gl_state.attrib_pointer.pointer[i]);
+      }
+   }
+
+   /* Uniforms hold their values whoever binds what */
+   for (i = 0; gl_state.program && i < GLSM_UNIFORM_SLOTS; i++)
+   {
+      const struct glsm_uniform *slot = &glsm_uniforms[i];
+      uint32_t value[16];
+
+      if (slot->program != gl_state.program)
+         continue;
+      if (slot->integer)
+         glGetUniformiv(slot->program, slot->location, (GLint*)value);
+      else
+         glGetUniformfv(slot->program, slot->location, (GLfloat*)value);
+      glsm_check("uniform",
+            !memcmp(value, slot->value, slot->count * sizeof(uint32_t)));
+   }
+
+   retro_assert(!glsm_check_failed);
+}
+#endif
 
 /* GL wrapper-side */
 
@@ -310,6 +659,9 @@ void rglReadBuffer(GLenum mode)
  */
 void rglClearDepth(GLdouble depth)
 {
+   if (glsm_redundant(GLSM_STAT_STATE,
+            gl_state.cleardepth.used && gl_state.cleardepth.depth == depth))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
 #ifdef HAVE_OPENGLES
    glClearDepthf(depth);
@@ -339,6 +691,10 @@ void rglPixelStorei(GLenum pname, GLint param)
  */
 void rglDepthRange(GLclampd zNear, GLclampd zFar)
 {
+   if (glsm_redundant(GLSM_STAT_STATE, gl_state.depthrange.used
+            && gl_state.depthrange.zNear == zNear
+            && gl_state.depthrange.zFar  == zFar))
+      return;
 #ifdef HAVE_OPENGLES
    glDepthRangef(zNear, zFar);
 #else
@@ -356,6 +712,9 @@ void rglDepthRange(GLclampd zNear, GLclampd zFar)
  */
 void rglFrontFace(GLenum mode)
 {
+   if (glsm_redundant(GLSM_STAT_STATE,
+            gl_state.frontface.used && gl_state.frontface.mode == mode))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glFrontFace(mode);
    gl_state.frontface.used = true;
@@ -369,6 +728,9 @@ void rglFrontFace(GLenum mode)
  */
 void rglDepthFunc(GLenum func)
 {
+   if (glsm_redundant(GLSM_STAT_STATE,
+            gl_state.depthfunc.used && gl_state.depthfunc.func == func))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    gl_state.depthfunc.used = true;
    gl_state.depthfunc.func = func;
@@ -383,6 +745,12 @@ void rglDepthFunc(GLenum func)
 void rglColorMask(GLboolean red, GLboolean green,
       GLboolean blue, GLboolean alpha)
 {
+   if (glsm_redundant(GLSM_STAT_STATE, gl_state.colormask.used
+            && gl_state.colormask.red   == red
+            && gl_state.colormask.green == green
+            && gl_state.colormask.blue  == blue
+            && gl_state.colormask.alpha == alpha))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glColorMask(red, green, blue, alpha);
    gl_state.colormask.red   = red;
@@ -399,6 +767,9 @@ void rglColorMask(GLboolean red, GLboolean green,
  */
 void rglCullFace(GLenum mode)
 {
+   if (glsm_redundant(GLSM_STAT_STATE,
+            gl_state.cullface.used && gl_state.cullface.mode == mode))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glCullFace(mode);
    gl_state.cullface.used = true;
@@ -412,6 +783,11 @@ void rglCullFace(GLenum mode)
  */
 void rglStencilOp(GLenum sfail, GLenum dpfail, GLenum dppass)
 {
+   if (glsm_redundant(GLSM_STAT_STATE, gl_state.stencilop.used
+            && gl_state.stencilop.sfail  == sfail
+            && gl_state.stencilop.dpfail == dpfail
+            && gl_state.stencilop.dppass == dppass))
+      return;
    glStencilOp(sfail, dpfail, dppass);
    gl_state.stencilop.used   = true;
    gl_state.stencilop.sfail  = sfail;
@@ -426,6 +802,11 @@ void rglStencilOp(GLenum sfail, GLenum dpfail, GLenum dppass)
  */
 void rglStencilFunc(GLenum func, GLint ref, GLuint mask)
 {
+   if (glsm_redundant(GLSM_STAT_STATE, gl_state.stencilfunc.used
+            && gl_state.stencilfunc.func == func
+            && gl_state.stencilfunc.ref  == ref
+            && gl_state.stencilfunc.mask == mask))
+      return;
    glStencilFunc(func, ref, mask);
    gl_state.stencilfunc.used = true;
    gl_state.stencilfunc.func = func;
@@ -451,8 +832,15 @@ GLboolean rglIsEnabled(GLenum cap)
 void rglClearColor(GLclampf red, GLclampf green,
       GLclampf blue, GLclampf alpha)
 {
+   if (glsm_redundant(GLSM_STAT_STATE, gl_state.clear_color.used
+            && gl_state.clear_color.r == red
+            && gl_state.clear_color.g == green
+            && gl_state.clear_color.b == blue
+            && gl_state.clear_color.a == alpha))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glClearColor(red, green, blue, alpha);
+   gl_state.clear_color.used = true;
    gl_state.clear_color.r = red;
    gl_state.clear_color.g = green;
    gl_state.clear_color.b = blue;
@@ -466,6 +854,10 @@ void rglClearColor(GLclampf red, GLclampf green,
  */
 void rglScissor(GLint x, GLint y, GLsizei width, GLsizei height)
 {
+   if (glsm_redundant(GLSM_STAT_STATE, gl_state.scissor.used
+            && gl_state.scissor.x == x && gl_state.scissor.y == y
+            && gl_state.scissor.w == width && gl_state.scissor.h == height))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glScissor(x, y, width, height);
    gl_state.scissor.used = true;
@@ -482,8 +874,13 @@ void rglScissor(GLint x, GLint y, GLsizei width, GLsizei height)
  */
 void rglViewport(GLint x, GLint y, GLsizei width, GLsizei height)
 {
+   if (glsm_redundant(GLSM_STAT_STATE, gl_state.viewport.used
+            && gl_state.viewport.x == x && gl_state.viewport.y == y
+            && gl_state.viewport.w == width && gl_state.viewport.h == height))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glViewport(x, y, width, height);
+   gl_state.viewport.used = true;
    gl_state.viewport.x = x;
    gl_state.viewport.y = y;
    gl_state.viewport.w = width;
@@ -492,10 +889,15 @@ void rglViewport(GLint x, GLint y, GLsizei width, GLsizei height)
 
 void rglBlendFunc(GLenum sfactor, GLenum dfactor)
 {
+   if (glsm_redundant(GLSM_STAT_STATE, gl_state.blendfunc.used
+            && gl_state.blendfunc.sfactor == sfactor
+            && gl_state.blendfunc.dfactor == dfactor))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
-   gl_state.blendfunc.used    = true;
-   gl_state.blendfunc.sfactor = sfactor;
-   gl_state.blendfunc.dfactor = dfactor;
+   gl_state.blendfunc.used          = true;
+   gl_state.blendfunc.sfactor       = sfactor;
+   gl_state.blendfunc.dfactor       = dfactor;
+   gl_state.blendfunc_separate.used = false;
    glBlendFunc(sfactor, dfactor);
 }
 
@@ -505,15 +907,23 @@ void rglBlendFunc(GLenum sfactor, GLenum dfactor)
  * Core in:
  * OpenGL    : 1.4
  */
-void rglBlendFuncSeparate(GLenum sfactor, GLenum dfactor)
+void rglBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB,
+      GLenum srcAlpha, GLenum dstAlpha)
 {
+   if (glsm_redundant(GLSM_STAT_STATE, gl_state.blendfunc_separate.used
+            && gl_state.blendfunc_separate.srcRGB   == srcRGB
+            && gl_state.blendfunc_separate.dstRGB   == dstRGB
+            && gl_state.blendfunc_separate.srcAlpha == srcAlpha
+            && gl_state.blendfunc_separate.dstAlpha == dstAlpha))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    gl_state.blendfunc_separate.used     = true;
-   gl_state.blendfunc_separate.srcRGB   = sfactor;
-   gl_state.blendfunc_separate.dstRGB   = dfactor;
-   gl_state.blendfunc_separate.srcAlpha = sfactor;
-   gl_state.blendfunc_separate.dstAlpha = dfactor;
-   glBlendFunc(sfactor, dfactor);
+   gl_state.blendfunc_separate.srcRGB   = srcRGB;
+   gl_state.blendfunc_separate.dstRGB   = dstRGB;
+   gl_state.blendfunc_separate.srcAlpha = srcAlpha;
+   gl_state.blendfunc_separate.dstAlpha = dstAlpha;
+   gl_state.blendfunc.used              = false;
+   glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
 }
 
 /*
@@ -524,6 +934,9 @@ void rglBlendFuncSeparate(GLenum sfactor, GLenum dfactor)
  */
 void rglActiveTexture(GLenum texture)
 {
+   if (glsm_redundant(GLSM_STAT_TEXTURE,
+            gl_state.active_texture == texture - GL_TEXTURE0))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glActiveTexture(texture);
    gl_state.active_texture = texture - GL_TEXTURE0;
@@ -536,9 +949,14 @@ void rglActiveTexture(GLenum texture)
  */
 void rglBindTexture(GLenum target, GLuint texture)
 {
+   /* Only the 2D bindings are restored, and so known */
+   if (glsm_redundant(GLSM_STAT_TEXTURE, target == GL_TEXTURE_2D
+            && gl_state.bind_textures.ids[gl_state.active_texture] == texture))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glBindTexture(target, texture);
-   gl_state.bind_textures.ids[gl_state.active_texture] = texture;
+   if (target == GL_TEXTURE_2D)
+      gl_state.bind_textures.ids[gl_state.active_texture] = texture;
 }
 
 /*
@@ -548,9 +966,13 @@ void rglBindTexture(GLenum target, GLuint texture)
  */
 void rglDisable(GLenum cap)
 {
+   if (glsm_redundant(GLSM_STAT_CAP,
+            gl_state.cap_known[cap] && !gl_state.cap_state[cap]))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glDisable(gl_state.cap_translate[cap]);
    gl_state.cap_state[cap] = 0;
+   gl_state.cap_known[cap] = true;
 }
 
 /*
@@ -560,9 +982,13 @@ void rglDisable(GLenum cap)
  */
 void rglEnable(GLenum cap)
 {
+   if (glsm_redundant(GLSM_STAT_CAP,
+            gl_state.cap_known[cap] && gl_state.cap_state[cap]))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glEnable(gl_state.cap_translate[cap]);
    gl_state.cap_state[cap] = 1;
+   gl_state.cap_known[cap] = true;
 }
 
 /*
@@ -573,6 +999,8 @@ void rglEnable(GLenum cap)
  */
 void rglUseProgram(GLuint program)
 {
+   if (glsm_redundant(GLSM_STAT_PROGRAM, gl_state.program == program))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    gl_state.program = program;
    glUseProgram(program);
@@ -585,6 +1013,9 @@ void rglUseProgram(GLuint program)
  */
 void rglDepthMask(GLboolean flag)
 {
+   if (glsm_redundant(GLSM_STAT_STATE,
+            gl_state.depthmask.used && gl_state.depthmask.mask == flag))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glDepthMask(flag);
    gl_state.depthmask.used = true;
@@ -598,6 +1029,9 @@ void rglDepthMask(GLboolean flag)
  */
 void rglStencilMask(GLenum mask)
 {
+   if (glsm_redundant(GLSM_STAT_STATE,
+            gl_state.stencilmask.used && gl_state.stencilmask.mask == mask))
+      return;
    glStencilMask(mask);
    gl_state.stencilmask.used = true;
    gl_state.stencilmask.mask = mask;
@@ -632,8 +1066,17 @@ void rglBufferSubData(GLenum target, GLintptr offset,
  */
 void rglBindBuffer(GLenum target, GLuint buffer)
 {
+   /* The element array binding belongs to the vertex array object */
+   if (glsm_redundant(GLSM_STAT_BUFFER,
+            (target == GL_ARRAY_BUFFER
+             && gl_state.array_buffer == buffer)
+            || (target == GL_ELEMENT_ARRAY_BUFFER && gl_state.vao_known
+             && gl_state.element_array_buffer == buffer)))
+      return;
    if (target == GL_ARRAY_BUFFER)
       gl_state.array_buffer = buffer;
+   else if (target == GL_ELEMENT_ARRAY_BUFFER)
+      gl_state.element_array_buffer = buffer;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glBindBuffer(target, buffer);
 }
@@ -646,6 +1089,7 @@ void rglBindBuffer(GLenum target, GLuint buffer)
  */
 void rglLinkProgram(GLuint program)
 {
+   glsm_uniform_forget(program);
    glLinkProgram(program);
 }
 
@@ -684,6 +1128,9 @@ void rglFramebufferTexture(GLenum target, GLenum attachment,
  */
 void rglDrawArrays(GLenum mode, GLint first, GLsizei count)
 {
+#ifdef GLSM_DEBUG
+   glsm_state_check();
+#endif
    glDrawArrays(mode, first, count);
 }
 
@@ -695,6 +1142,9 @@ void rglDrawArrays(GLenum mode, GLint first, GLsizei count)
 void rglDrawElements(GLenum mode, GLsizei count, GLenum type,
                            const GLvoid * indices)
 {
+#ifdef GLSM_DEBUG
+   glsm_state_check();
+#endif
    glDrawElements(mode, count, type, indices);
 }
 
@@ -709,11 +1159,26 @@ void rglCompressedTexImage2D(GLenum target, GLint level,
 
 void rglDeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
 {
+   /* Deleting the bound framebuffer binds 0, but that of a read or draw
+    * binding is not followed */
+   gl_state.framebuf_known = false;
    glDeleteFramebuffers(n, framebuffers);
 }
 
 void rglDeleteTextures(GLsizei n, const GLuint *textures)
 {
+   GLsizei i;
+   GLint unit;
+
+   /* Deleting bound textures binds 0 in their place */
+   for (i = 0; i < n; i++)
+   {
+      if (!textures[i])
+         continue;
+      for (unit = 0; unit < glsm_max_textures; unit++)
+         if (gl_state.bind_textures.ids[unit] == textures[i])
+            gl_state.bind_textures.ids[unit] = 0;
+   }
    glDeleteTextures(n, textures);
 }
 
@@ -1169,6 +1634,9 @@ void rglTexCoord2f(GLfloat s, GLfloat t)
  */
 void rglDisableVertexAttribArray(GLuint index)
 {
+   if (glsm_redundant(GLSM_STAT_ATTRIB, gl_state.vao_known
+            && !gl_state.vertex_attrib_pointer.enabled[index]))
+      return;
    gl_state.vertex_attrib_pointer.enabled[index] = 0;
    glDisableVertexAttribArray(index);
 }
@@ -1181,6 +1649,9 @@ void rglDisableVertexAttribArray(GLuint index)
  */
 void rglEnableVertexAttribArray(GLuint index)
 {
+   if (glsm_redundant(GLSM_STAT_ATTRIB, gl_state.vao_known
+            && gl_state.vertex_attrib_pointer.enabled[index]))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    gl_state.vertex_attrib_pointer.enabled[index] = 1;
    glEnableVertexAttribArray(index);
@@ -1226,7 +1697,17 @@ void rglVertexAttribPointer(GLuint name, GLint size,
       GLenum type, GLboolean normalized, GLsizei stride,
       const GLvoid* pointer)
 {
+   if (glsm_redundant(GLSM_STAT_ATTRIB, gl_state.vao_known
+            && gl_state.attrib_pointer.known[name]
+            && gl_state.attrib_pointer.size[name]       == size
+            && gl_state.attrib_pointer.type[name]       == type
+            && gl_state.attrib_pointer.normalized[name] == normalized
+            && gl_state.attrib_pointer.stride[name]     == stride
+            && gl_state.attrib_pointer.pointer[name]    == pointer
+            && gl_state.attrib_pointer.buffer[name]     == gl_state.array_buffer))
+      return;
    gl_state.attrib_pointer.used[name] = 1;
+   gl_state.attrib_pointer.known[name] = true;
    gl_state.attrib_pointer.size[name] = size;
    gl_state.attrib_pointer.type[name] = type;
    gl_state.attrib_pointer.normalized[name] = normalized;
@@ -1287,6 +1768,7 @@ GLuint rglCreateShader(GLenum shaderType)
  */
 void rglDeleteProgram(GLuint program)
 {
+   glsm_uniform_forget(program);
    glDeleteProgram(program);
 }
 
@@ -1320,6 +1802,23 @@ GLint rglGetUniformLocation(GLuint program, const GLchar *name)
  */
 void rglDeleteBuffers(GLsizei n, const GLuint *buffers)
 {
+   GLsizei i;
+   unsigned j;
+
+   /* Deleting bound buffers binds 0 in their place, and detaches them
+    * from the attributes of the bound vertex array object */
+   for (i = 0; i < n; i++)
+   {
+      if (!buffers[i])
+         continue;
+      if (gl_state.array_buffer == buffers[i])
+         gl_state.array_buffer = 0;
+      if (gl_state.element_array_buffer == buffers[i])
+         gl_state.element_array_buffer = 0;
+      for (j = 0; j < MAX_ATTRIB; j++)
+         if (gl_state.attrib_pointer.buffer[j] == buffers[i])
+            gl_state.attrib_pointer.known[j] = false;
+   }
    glDeleteBuffers(n, buffers);
 }
 
@@ -1342,6 +1841,8 @@ void rglGenBuffers(GLsizei n, GLuint *buffers)
  */
 void rglUniform1f(GLint location, GLfloat v0)
 {
+   if (glsm_uniform_redundant(location, 1, false, &v0))
+      return;
    glUniform1f(location, v0);
 }
 
@@ -1353,6 +1854,10 @@ void rglUniform1f(GLint location, GLfloat v0)
  */
 void rglUniform1fv(GLint location,  GLsizei count,  const GLfloat *value)
 {
+   if (count != 1)
+      glsm_uniform_forget_array(location, count);
+   else if (glsm_uniform_redundant(location, 1, false, value))
+      return;
    glUniform1fv(location, count, value);
 }
 
@@ -1364,6 +1869,10 @@ void rglUniform1fv(GLint location,  GLsizei count,  const GLfloat *value)
  */
 void rglUniform1iv(GLint location,  GLsizei count,  const GLint *value)
 {
+   if (count != 1)
+      glsm_uniform_forget_array(location, count);
+   else if (glsm_uniform_redundant(location, 1, true, value))
+      return;
    glUniform1iv(location, count, value);
 }
 
@@ -1433,6 +1942,8 @@ void rglRenderbufferStorageMultisample( 	GLenum target,
  */
 void rglUniform1i(GLint location, GLint v0)
 {
+   if (glsm_uniform_redundant(location, 1, true, &v0))
+      return;
    glUniform1i(location, v0);
 }
 
@@ -1444,6 +1955,11 @@ void rglUniform1i(GLint location, GLint v0)
  */
 void rglUniform2f(GLint location, GLfloat v0, GLfloat v1)
 {
+   GLfloat value[2];
+   value[0] = v0;
+   value[1] = v1;
+   if (glsm_uniform_redundant(location, 2, false, value))
+      return;
    glUniform2f(location, v0, v1);
 }
 
@@ -1455,6 +1971,11 @@ void rglUniform2f(GLint location, GLfloat v0, GLfloat v1)
  */
 void rglUniform2i(GLint location, GLint v0, GLint v1)
 {
+   GLint value[2];
+   value[0] = v0;
+   value[1] = v1;
+   if (glsm_uniform_redundant(location, 2, true, value))
+      return;
    glUniform2i(location, v0, v1);
 }
 
@@ -1466,6 +1987,10 @@ void rglUniform2i(GLint location, GLint v0, GLint v1)
  */
 void rglUniform2fv(GLint location, GLsizei count, const GLfloat *value)
 {
+   if (count != 1)
+      glsm_uniform_forget_array(location, count);
+   else if (glsm_uniform_redundant(location, 2, false, value))
+      return;
    glUniform2fv(location, count, value);
 }
 
@@ -1477,6 +2002,12 @@ void rglUniform2fv(GLint location, GLsizei count, const GLfloat *value)
  */
 void rglUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
 {
+   GLfloat value[3];
+   value[0] = v0;
+   value[1] = v1;
+   value[2] = v2;
+   if (glsm_uniform_redundant(location, 3, false, value))
+      return;
    glUniform3f(location, v0, v1, v2);
 }
 
@@ -1488,6 +2019,10 @@ void rglUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
  */
 void rglUniform3fv(GLint location, GLsizei count, const GLfloat *value)
 {
+   if (count != 1)
+      glsm_uniform_forget_array(location, count);
+   else if (glsm_uniform_redundant(location, 3, false, value))
+      return;
    glUniform3fv(location, count, value);
 }
 
@@ -1499,6 +2034,13 @@ void rglUniform3fv(GLint location, GLsizei count, const GLfloat *value)
  */
 void rglUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3)
 {
+   GLint value[4];
+   value[0] = v0;
+   value[1] = v1;
+   value[2] = v2;
+   value[3] = v3;
+   if (glsm_uniform_redundant(location, 4, true, value))
+      return;
    glUniform4i(location, v0, v1, v2, v3);
 }
 
@@ -1510,6 +2052,13 @@ void rglUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3)
  */
 void rglUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
 {
+   GLfloat value[4];
+   value[0] = v0;
+   value[1] = v1;
+   value[2] = v2;
+   value[3] = v3;
+   if (glsm_uniform_redundant(location, 4, false, value))
+      return;
    glUniform4f(location, v0, v1, v2, v3);
 }
 
@@ -1521,6 +2070,10 @@ void rglUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3
  */
 void rglUniform4fv(GLint location, GLsizei count, const GLfloat *value)
 {
+   if (count != 1)
+      glsm_uniform_forget_array(location, count);
+   else if (glsm_uniform_redundant(location, 4, false, value))
+      return;
    glUniform4fv(location, count, value);
 }
 
@@ -1532,6 +2085,10 @@ void rglUniform4fv(GLint location, GLsizei count, const GLfloat *value)
  */
 void rglPolygonOffset(GLfloat factor, GLfloat units)
 {
+   if (glsm_redundant(GLSM_STAT_STATE, gl_state.polygonoffset.used
+            && gl_state.polygonoffset.factor == factor
+            && gl_state.polygonoffset.units  == units))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glPolygonOffset(factor, units);
    gl_state.polygonoffset.used   = true;
@@ -1558,9 +2115,13 @@ void rglGenFramebuffers(GLsizei n, GLuint *ids)
  */
 void rglBindFramebuffer(GLenum target, GLuint framebuffer)
 {
+   if (glsm_redundant(GLSM_STAT_FRAMEBUFFER, target == RARCH_GL_FRAMEBUFFER
+            && gl_state.framebuf_known && gl_state.framebuf == framebuffer))
+      return;
    glsm_ctl(GLSM_CTL_IMM_VBO_DRAW, NULL);
    glBindFramebuffer(target, framebuffer);
-   gl_state.framebuf = framebuffer;
+   gl_state.framebuf       = framebuffer;
+   gl_state.framebuf_known = target == RARCH_GL_FRAMEBUFFER;
 }
 
 /*
@@ -1693,6 +2254,7 @@ void rglProgramBinary(GLuint program,
   	GLsizei length)
 {
 #if !defined(HAVE_OPENGLES) || defined(HAVE_OPENGLES) && defined(HAVE_OPENGLES_3_1)
+   glsm_uniform_forget(program);
    glProgramBinary(program, binaryFormat, binary, length);
 #else
    printf("WARNING! Not implemented.\n");
@@ -1811,6 +2373,7 @@ void rglCopyImageSubData( 	GLuint srcName,
 void rglBindVertexArray(GLuint array)
 {
 #if defined(HAVE_OPENGL) || defined(HAVE_OPENGLES) && defined(HAVE_OPENGLES3)
+   gl_state.vao_known = false;
    glBindVertexArray(array);
 #endif
 }
@@ -1936,6 +2499,9 @@ GLenum rglClientWaitSync(void *sync, GLbitfield flags, uint64_t timeout)
 void rglDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type,
 			       GLvoid *indices, GLint basevertex) {
 #if defined(HAVE_OPENGL)
+#ifdef GLSM_DEBUG
+  glsm_state_check();
+#endif
   glDrawElementsBaseVertex(mode, count, type, indices, basevertex);
 #endif
 }
@@ -1965,8 +2531,12 @@ static void glsm_state_setup(void)
    {
       gl_state.vertex_attrib_pointer.enabled[i] = 0;
       gl_state.attrib_pointer.used[i] = 0;
+      gl_state.attrib_pointer.known[i] = false;
    }
 
+   /* A new context holds none of the programs */
+   memset(glsm_uniforms, 0, sizeof(glsm_uniforms));
+
    glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &glsm_max_textures);
 
    gl_state.bind_textures.ids           = (GLuint*)calloc(glsm_max_textures, sizeof(GLuint));
@@ -2009,6 +2579,7 @@ static void glsm_state_bind(void)
    glBindVertexArray(gl_state.vao);
 #endif
    glBindBuffer(GL_ARRAY_BUFFER, gl_state.array_buffer);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl_state.element_array_buffer);
 
    for (i = 0; i < MAX_ATTRIB; i++)
    {
@@ -2017,8 +2588,11 @@ static void glsm_state_bind(void)
       else
          glDisableVertexAttribArray(i);
 
+      gl_state.attrib_pointer.known[i] = false;
+
       if (gl_state.attrib_pointer.used[i] && gl_state.attrib_pointer.buffer[i] == gl_state.array_buffer)
       {
+         gl_state.attrib_pointer.known[i] = true;
          glVertexAttribPointer(
                i,
                gl_state.attrib_pointer.size[i],
@@ -2029,7 +2603,8 @@ static void glsm_state_bind(void)
       }
    }
 
-   glBindFramebuffer(RARCH_GL_FRAMEBUFFER, hw_render.get_current_framebuffer());
+   gl_state.framebuf = hw_render.get_current_framebuffer();
+   glBindFramebuffer(RARCH_GL_FRAMEBUFFER, gl_state.framebuf);
 
    if (gl_state.blendfunc.used)
       glBlendFunc(
@@ -2044,11 +2619,26 @@ static void glsm_state_bind(void)
             gl_state.blendfunc_separate.dstAlpha
             );
 
-   glClearColor(
-         gl_state.clear_color.r,
-         gl_state.clear_color.g,
-         gl_state.clear_color.b,
-         gl_state.clear_color.a);
+   if (gl_state.clear_color.used)
+      glClearColor(
+            gl_state.clear_color.r,
+            gl_state.clear_color.g,
+            gl_state.clear_color.b,
+            gl_state.clear_color.a);
+
+   if (gl_state.cleardepth.used)
+#ifdef HAVE_OPENGLES
+      glClearDepthf(gl_state.cleardepth.depth);
+#else
+      glClearDepth(gl_state.cleardepth.depth);
+#endif
+
+   if (gl_state.depthrange.used)
+#ifdef HAVE_OPENGLES
+      glDepthRangef(gl_state.depthrange.zNear, gl_state.depthrange.zFar);
+#else
+      glDepthRange(gl_state.depthrange.zNear, gl_state.depthrange.zFar);
+#endif
 
    if (gl_state.depthfunc.used)
       glDepthFunc(gl_state.depthfunc.func);
@@ -2080,16 +2670,18 @@ static void glsm_state_bind(void)
 
    glUseProgram(gl_state.program);
 
-   glViewport(
-         gl_state.viewport.x,
-         gl_state.viewport.y,
-         gl_state.viewport.w,
-         gl_state.viewport.h);
+   if (gl_state.viewport.used)
+      glViewport(
+            gl_state.viewport.x,
+            gl_state.viewport.y,
+            gl_state.viewport.w,
+            gl_state.viewport.h);
 
    for(i = 0; i < SGL_CAP_MAX; i ++)
    {
       if (gl_state.cap_state[i])
          glEnable(gl_state.cap_translate[i]);
+      gl_state.cap_known[i] = gl_state.cap_state[i] != 0;
    }
 
    if (gl_state.frontface.used)
@@ -2116,11 +2708,23 @@ static void glsm_state_bind(void)
    }
 
    glActiveTexture(GL_TEXTURE0 + gl_state.active_texture);
+
+   if (glsm_uniforms_stale)
+   {
+      memset(glsm_uniforms, 0, sizeof(glsm_uniforms));
+      glsm_uniforms_stale = false;
+   }
+
+   gl_state.vao_known      = true;
+   gl_state.framebuf_known = true;
+   gl_state.bound          = true;
 }
 
 static void glsm_state_unbind(void)
 {
    unsigned i;
+
+   gl_state.bound = false;
 #ifdef CORE
    glBindVertexArray(0);
 #endif
@@ -2150,7 +2754,11 @@ static void glsm_state_unbind(void)
    glClearColor(0,0,0,0.0f);
 
    if (gl_state.depthrange.used)
-      rglDepthRange(0, 1);
+#ifdef HAVE_OPENGLES
+      glDepthRangef(0, 1);
+#else
+      glDepthRange(0, 1);
+#endif
 
    glStencilMask(1);
    glFrontFace(GL_CCW);
@@ -2179,6 +2787,8 @@ static void glsm_state_unbind(void)
 
 static bool glsm_state_ctx_destroy(void *data)
 {
+   gl_state.bound = false;
+
    if (gl_state.bind_textures.ids)
       free(gl_state.bind_textures.ids);
    gl_state.bind_textures.ids = NULL;
@@ -2269,6 +2879,14 @@ bool glsm_ctl(enum glsm_state_ctl state, void *data)
       case GLSM_CTL_STATE_BIND:
          glsm_state_bind();
          break;
+      case GLSM_CTL_STATS_GET:
+         {
+            glsm_stats_t *stats = (glsm_stats_t*)data;
+            if (stats)
+               *stats = glsm_stats;
+            memset(&glsm_stats, 0, sizeof(glsm_stats));
+         }
+         break;
       case GLSM_CTL_NONE:
       default:
          break;
@@ -66,6 +66,17 @@ struct resampler_data
    double ratio;
 };
 
+struct resampler_data_s16
+{
+   const int16_t *data_in;
+   int16_t *data_out;
+
+   size_t input_frames;
+   size_t output_frames;
+
+   double ratio;
+};
+
 /* Returns true if config key was found. Otherwise, 
  * returns false, and sets value to default value.
  */
@@ -116,6 +127,10 @@ typedef void (*resampler_free_t)(void *data);
 /* Processes input data. */
 typedef void (*resampler_process_t)(void *_data, struct resampler_data *data);
 
+/* Processes interleaved s16 input data into interleaved s16 output. */
+typedef void (*resampler_process_s16_t)(void *_data,
+      struct resampler_data_s16 *data);
+
 typedef struct retro_resampler
 {
    resampler_init_t     init;
@@ -131,6 +146,10 @@ typedef struct retro_resampler
    /* Computer-friendly short version of ident.
     * Lower case, no spaces and special characters, etc. */
    const char *short_ident; 
+
+   /* Optional, can be NULL. Same as process, but skips the
+    * s16 <-> float conversions on both ends. */
+   resampler_process_s16_t process_s16;
 } retro_resampler_t;
 
 typedef struct audio_frame_float
@@ -123,9 +123,33 @@ enum glsm_state_ctl
    GLSM_CTL_UNSET_IMM_VBO,
    GLSM_CTL_IMM_VBO_DISABLE,
    GLSM_CTL_IMM_VBO_DRAW,
-   GLSM_CTL_PROC_ADDRESS_GET
+   GLSM_CTL_PROC_ADDRESS_GET,
+   GLSM_CTL_STATS_GET
 };
 
+/* Calls counted by glsm, by kind. */
+enum glsm_stat
+{
+   GLSM_STAT_TEXTURE = 0,  /* texture unit and 2D texture bindings */
+   GLSM_STAT_PROGRAM,
+   GLSM_STAT_BUFFER,       /* array and element array buffer bindings */
+   GLSM_STAT_FRAMEBUFFER,
+   GLSM_STAT_CAP,          /* enabled capabilities */
+   GLSM_STAT_STATE,        /* blending, depth, stencil, masks, rectangles */
+   GLSM_STAT_ATTRIB,       /* vertex attribute arrays and pointers */
+   GLSM_STAT_UNIFORM,
+   GLSM_STAT_MAX
+};
+
+/* Filled in by GLSM_CTL_STATS_GET with the calls made since the previous
+ * GLSM_CTL_STATS_GET: those passed on to GL and those dropped because
+ * they would not have changed the state. */
+typedef struct glsm_stats
+{
+   unsigned issued[GLSM_STAT_MAX];
+   unsigned elided[GLSM_STAT_MAX];
+} glsm_stats_t;
+
 typedef bool (*glsm_imm_vbo_draw)(void *);
 typedef bool (*glsm_imm_vbo_disable)(void *);
 typedef bool (*glsm_framebuffer_lock)(void *);
@@ -0,0 +1,471 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "api/libretro.h"
+#include "emu_thread.h"
+
+/* Must be a power of two. One slot is being presented while the
+ * emulator fills the other. */
+#define FRAME_SLOTS        2
+#define INPUT_PORTS        4
+#define JOYPAD_BUTTONS     (RETRO_DEVICE_ID_JOYPAD_R3 + 1)
+
+extern retro_log_printf_t log_cb;
+extern retro_video_refresh_t video_cb;
+extern retro_input_poll_t poll_cb;
+extern retro_input_state_t input_cb;
+extern retro_audio_sample_batch_t audio_batch_cb;
+extern struct retro_rumble_interface rumble;
+
+struct frame_slot
+{
+   /* video */
+   bool video;                /* video_cb was called */
+   bool dupe;                 /* ...and only with NULL */
+   uint8_t *pixels;
+   size_t pixels_size;
+   unsigned width;
+   unsigned height;
+   size_t pitch;
+
+   /* audio, interleaved stereo */
+   int16_t *audio;
+   size_t audio_frames;
+   size_t audio_capacity;
+
+   /* last rumble strength per port and effect, rumble_set is a bitmask */
+   uint16_t rumble[INPUT_PORTS][2];
+   unsigned rumble_set;
+};
+
+struct input_snapshot
+{
+   int16_t joypad[INPUT_PORTS][JOYPAD_BUTTONS];
+   int16_t analog[INPUT_PORTS][2][2];
+};
+
+static struct
+{
+   bool running;
+   bool quit;
+   unsigned latency;
+   bool primed;               /* a frame is in flight ahead of retro_run */
+   emu_thread_frame_t run_frame;
+
+   pthread_t thread;
+
+   /* Only taken to sleep, when a side finds the ring empty or full, and
+    * by the other side to wake it up. */
+   pthread_mutex_t lock;
+   pthread_cond_t cond;
+   unsigned emu_waiting;      /* the emulator thread, for a kick */
+   unsigned run_waiting;      /* retro_run, for a finished frame */
+
+   /* Frames requested, only written by retro_run. */
+   unsigned kicked;
+
+   /* Ring indices. head is only written by the emulator thread and
+    * counts finished frames, tail only by retro_run. */
+   unsigned head;
+   unsigned tail;
+   struct frame_slot slots[FRAME_SLOTS];
+
+   /* Written by retro_run while no frame is in flight. */
+   struct input_snapshot input;
+
+   /* The last picture shown, duped when a retro_run has no new one. */
+   bool shown;
+   unsigned shown_width;
+   unsigned shown_height;
+   size_t shown_pitch;
+
+   /* The frontend's callbacks while ours are installed. */
+   retro_video_refresh_t video_cb;
+   retro_input_poll_t poll_cb;
+   retro_input_state_t input_cb;
+   retro_audio_sample_batch_t audio_batch_cb;
+   retro_set_rumble_state_t set_rumble_state;
+} emu;
+
+static unsigned load_head(void)
+{
+   return __atomic_load_n(&emu.head, __ATOMIC_ACQUIRE);
+}
+
+/* Publishes a new value of kicked or head, then wakes the other side if
+ * it went to sleep. The store and the load of its flag are sequentially
+ * consistent, as are the flag's store and the recheck in sleep_while(): either
+ * the sleeper sees the new value or this sees the flag. */
+static void publish(unsigned *index, unsigned value, unsigned *waiting)
+{
+   __atomic_store_n(index, value, __ATOMIC_SEQ_CST);
+   if (__atomic_load_n(waiting, __ATOMIC_SEQ_CST))
+   {
+      pthread_mutex_lock(&emu.lock);
+      pthread_cond_broadcast(&emu.cond);
+      pthread_mutex_unlock(&emu.lock);
+   }
+}
+
+/* Sleeps until *index moves past value, or the thread is told to quit. */
+static void sleep_while(const unsigned *index, unsigned value, unsigned *waiting)
+{
+   pthread_mutex_lock(&emu.lock);
+   __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+   while (__atomic_load_n(index, __ATOMIC_SEQ_CST) == value
+         && !__atomic_load_n(&emu.quit, __ATOMIC_SEQ_CST))
+      pthread_cond_wait(&emu.cond, &emu.lock);
+   __atomic_store_n(waiting, 0, __ATOMIC_RELAXED);
+   pthread_mutex_unlock(&emu.lock);
+}
+
+/* Emulator side: record into the slot being filled. */
+
+static struct frame_slot *current_slot(void)
+{
+   return &emu.slots[emu.head & (FRAME_SLOTS - 1)];
+}
+
+static void capture_video(const void *data, unsigned width,
+      unsigned height, size_t pitch)
+{
+   struct frame_slot *slot = current_slot();
+   size_t size             = pitch * height;
+
+   if (!data)
+   {
+      if (!slot->video)
+      {
+         slot->dupe   = true;
+         slot->width  = width;
+         slot->height = height;
+         slot->pitch  = pitch;
+      }
+      slot->video = true;
+      return;
+   }
+
+   if (size > slot->pixels_size)
+   {
+      uint8_t *pixels = (uint8_t*)realloc(slot->pixels, size);
+      if (!pixels)
+         return;
+      slot->pixels      = pixels;
+      slot->pixels_size = size;
+   }
+
+   memcpy(slot->pixels, data, size);
+   slot->video  = true;
+   slot->dupe   = false;
+   slot->width  = width;
+   slot->height = height;
+   slot->pitch  = pitch;
+}
+
+static size_t capture_audio(const int16_t *data, size_t frames)
+{
+   struct frame_slot *slot = current_slot();
+
+   if (slot->audio_frames + frames > slot->audio_capacity)
+   {
+      size_t capacity = (slot->audio_frames + frames) * 2;
+      int16_t *audio  = (int16_t*)realloc(slot->audio,
+            capacity * 2 * sizeof(int16_t));
+      if (!audio)
+         return frames;
+      slot->audio          = audio;
+      slot->audio_capacity = capacity;
+   }
+
+   memcpy(slot->audio + slot->audio_frames * 2, data,
+         frames * 2 * sizeof(int16_t));
+   slot->audio_frames += frames;
+   return frames;
+}
+
+static void capture_poll(void)
+{
+   /* Input was polled by retro_run. */
+}
+
+static int16_t capture_input(unsigned port, unsigned device,
+      unsigned index, unsigned id)
+{
+   if (port >= INPUT_PORTS)
+      return 0;
+
+   switch (device)
+   {
+      case RETRO_DEVICE_JOYPAD:
+         if (id < JOYPAD_BUTTONS)
+            return emu.input.joypad[port][id];
+         break;
+      case RETRO_DEVICE_ANALOG:
+         if (index < 2 && id < 2)
+            return emu.input.analog[port][index][id];
+         break;
+   }
+
+   return 0;
+}
+
+static bool capture_rumble(unsigned port, enum retro_rumble_effect effect,
+      uint16_t strength)
+{
+   struct frame_slot *slot = current_slot();
+
+   if (port >= INPUT_PORTS || (unsigned)effect > RETRO_RUMBLE_WEAK)
+      return false;
+
+   slot->rumble[port][effect] = strength;
+   slot->rumble_set          |= 1 << (port * 2 + effect);
+   return true;
+}
+
+static void *emu_thread_entry(void *data)
+{
+   unsigned done = 0;
+
+   for (;;)
+   {
+      struct frame_slot *slot;
+
+      if (__atomic_load_n(&emu.kicked, __ATOMIC_ACQUIRE) == done)
+         sleep_while(&emu.kicked, done, &emu.emu_waiting);
+      if (__atomic_load_n(&emu.quit, __ATOMIC_ACQUIRE))
+         break;
+
+      /* retro_run never has more than one frame in flight and pops the
+       * previous one before asking for the next, so this slot is free. */
+      slot               = current_slot();
+      slot->video        = false;
+      slot->dupe         = false;
+      slot->audio_frames = 0;
+      slot->rumble_set   = 0;
+
+      emu.run_frame();
+
+      done++;
+      publish(&emu.head, done, &emu.run_waiting);
+   }
+
+   return NULL;
+}
+
+/* Frontend side. */
+
+static void wait_frames(void)
+{
+   unsigned head;
+
+   while ((head = load_head()) != emu.kicked)
+      sleep_while(&emu.head, head, &emu.run_waiting);
+}
+
+static void kick_frame(void)
+{
+   unsigned port, i;
+   struct input_snapshot *input = &emu.input;
+
+   emu.poll_cb();
+
+   for (port = 0; port < INPUT_PORTS; port++)
+   {
+      for (i = 0; i < JOYPAD_BUTTONS; i++)
+         input->joypad[port][i] = emu.input_cb(port, RETRO_DEVICE_JOYPAD, 0, i);
+      for (i = 0; i < 4; i++)
+         input->analog[port][i >> 1][i & 1] = emu.input_cb(port,
+               RETRO_DEVICE_ANALOG, i >> 1, i & 1);
+   }
+
+   publish(&emu.kicked, emu.kicked + 1, &emu.emu_waiting);
+}
+
+/* Plays back every frame finished before 'end'. All of the audio is
+ * pushed, only the newest picture is shown. The slots are released
+ * once the frontend is done with them. */
+static void present_frames(unsigned end)
+{
+   unsigned i;
+   struct frame_slot *shown = NULL;
+
+   for (i = emu.tail; i != end; i++)
+   {
+      unsigned port, effect;
+      struct frame_slot *slot = &emu.slots[i & (FRAME_SLOTS - 1)];
+      const int16_t *audio    = slot->audio;
+      size_t frames           = slot->audio_frames;
+
+      while (frames)
+      {
+         size_t ret = emu.audio_batch_cb(audio, frames);
+         frames    -= ret;
+         audio     += ret * 2;
+      }
+
+      if (slot->rumble_set && emu.set_rumble_state)
+      {
+         for (port = 0; port < INPUT_PORTS; port++)
+            for (effect = 0; effect < 2; effect++)
+               if (slot->rumble_set & (1 << (port * 2 + effect)))
+                  emu.set_rumble_state(port,
+                        (enum retro_rumble_effect)effect,
+                        slot->rumble[port][effect]);
+      }
+
+      if (slot->video && (!slot->dupe || !shown))
+         shown = slot;
+   }
+
+   if (shown)
+   {
+      emu.video_cb(shown->dupe ? NULL : shown->pixels,
+            shown->width, shown->height, shown->pitch);
+      emu.shown        = true;
+      emu.shown_width  = shown->width;
+      emu.shown_height = shown->height;
+      emu.shown_pitch  = shown->pitch;
+   }
+   else if (emu.shown)
+      emu.video_cb(NULL, emu.shown_width, emu.shown_height, emu.shown_pitch);
+
+   __atomic_store_n(&emu.tail, end, __ATOMIC_RELEASE);
+}
+
+void emu_thread_run(void)
+{
+   unsigned ready;
+
+   wait_frames();
+   ready = emu.kicked;
+
+   kick_frame();
+
+   if (emu.latency == 0 || !emu.primed)
+   {
+      /* With latency 1 the first frame is waited for as well and the next
+       * one started right away, so that every retro_run has a frame. */
+      wait_frames();
+      ready = emu.kicked;
+      if (emu.latency)
+         kick_frame();
+      emu.primed = emu.latency != 0;
+   }
+
+   present_frames(ready);
+}
+
+void emu_thread_sync(void)
+{
+   if (emu.running)
+      wait_frames();
+}
+
+void emu_thread_set_latency(unsigned latency)
+{
+   emu_thread_sync();
+   emu.latency = latency;
+   emu.primed  = false;
+}
+
+bool emu_thread_is_running(void)
+{
+   return emu.running;
+}
+
+bool emu_thread_start(emu_thread_frame_t run_frame, unsigned latency)
+{
+   if (emu.running)
+      return true;
+
+   emu.quit      = false;
+   emu.latency   = latency;
+   emu.primed    = false;
+   emu.shown     = false;
+   emu.run_frame = run_frame;
+   emu.kicked    = 0;
+   emu.head      = 0;
+   emu.tail      = 0;
+   emu.emu_waiting = 0;
+   emu.run_waiting = 0;
+
+   if (pthread_mutex_init(&emu.lock, NULL) != 0)
+      return false;
+   if (pthread_cond_init(&emu.cond, NULL) != 0)
+   {
+      pthread_mutex_destroy(&emu.lock);
+      return false;
+   }
+
+   emu.video_cb         = video_cb;
+   emu.poll_cb          = poll_cb;
+   emu.input_cb         = input_cb;
+   emu.audio_batch_cb   = audio_batch_cb;
+   emu.set_rumble_state = rumble.set_rumble_state;
+
+   video_cb       = capture_video;
+   poll_cb        = capture_poll;
+   input_cb       = capture_input;
+   audio_batch_cb = capture_audio;
+   if (rumble.set_rumble_state)
+      rumble.set_rumble_state = capture_rumble;
+
+   if (pthread_create(&emu.thread, NULL, emu_thread_entry, NULL) != 0)
+   {
+      video_cb                = emu.video_cb;
+      poll_cb                 = emu.poll_cb;
+      input_cb                = emu.input_cb;
+      audio_batch_cb          = emu.audio_batch_cb;
+      rumble.set_rumble_state = emu.set_rumble_state;
+      pthread_cond_destroy(&emu.cond);
+      pthread_mutex_destroy(&emu.lock);
+      return false;
+   }
+
+   emu.running = true;
+
+   if (log_cb)
+      log_cb(RETRO_LOG_INFO, "Threaded emulation started, %u frame(s) of latency.\n",
+            latency);
+   return true;
+}
+
+void emu_thread_stop(void)
+{
+   unsigned i;
+
+   if (!emu.running)
+      return;
+
+   wait_frames();
+
+   pthread_mutex_lock(&emu.lock);
+   __atomic_store_n(&emu.quit, true, __ATOMIC_SEQ_CST);
+   pthread_cond_broadcast(&emu.cond);
+   pthread_mutex_unlock(&emu.lock);
+   pthread_join(emu.thread, NULL);
+
+   pthread_cond_destroy(&emu.cond);
+   pthread_mutex_destroy(&emu.lock);
+
+   /* A frame that was never presented is dropped. */
+   video_cb                = emu.video_cb;
+   poll_cb                 = emu.poll_cb;
+   input_cb                = emu.input_cb;
+   audio_batch_cb          = emu.audio_batch_cb;
+   rumble.set_rumble_state = emu.set_rumble_state;
+
+   for (i = 0; i < FRAME_SLOTS; i++)
+   {
+      free(emu.slots[i].pixels);
+      free(emu.slots[i].audio);
+   }
+   memset(emu.slots, 0, sizeof(emu.slots));
+
+   emu.running = false;
+
+   if (log_cb)
+      log_cb(RETRO_LOG_INFO, "Threaded emulation stopped.\n");
+}
@@ -0,0 +1,56 @@
+#ifndef _EMU_THREAD_H_
+#define _EMU_THREAD_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Threaded emulation.
+ *
+ * Instead of co_switching into the emulator from retro_run, a worker
+ * thread runs one frame at a time through run_frame (which does the
+ * co_switch loop itself) while retro_run presents the previous one.
+ * Finished frames and their audio are handed back through a small
+ * single producer / single consumer ring. Its indices are atomics; a side
+ * only takes a lock to sleep when it finds the ring empty (the emulator,
+ * waiting for a kick) or full (retro_run, waiting for a frame).
+ *
+ * While the thread is running the video, audio, input and rumble
+ * callbacks seen by the emulator are replaced with ones that record into
+ * the frame being produced; retro_run replays them on the frontend's
+ * thread. Input is sampled once per retro_run.
+ *
+ * With latency 1 the emulator runs a frame ahead: the frame kicked in one
+ * retro_run is shown in the next, so emulation overlaps the frontend. The
+ * first retro_run waits for its frame and kicks the next one, so none goes
+ * without a picture. With latency 0 retro_run waits for the frame it
+ * kicked, which keeps input latency unchanged.
+ *
+ * With latency 1 the emulator also runs between two retro_runs: memory
+ * the frontend reads then, through retro_get_memory_data, belongs to the
+ * frame in flight. The core's entry points that touch emulator state sync
+ * first. */
+
+typedef void (*emu_thread_frame_t)(void);
+
+bool emu_thread_start(emu_thread_frame_t run_frame, unsigned latency);
+void emu_thread_stop(void);
+bool emu_thread_is_running(void);
+
+/* Waits for the frame in flight before switching. */
+void emu_thread_set_latency(unsigned latency);
+
+/* Body of retro_run while the thread is running. */
+void emu_thread_run(void);
+
+/* Waits for the frame in flight, if any. Call before touching emulator
+ * state from the frontend's thread (savestates, reset, cheats...). */
+void emu_thread_sync(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
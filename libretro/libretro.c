@@ -14,16 +14,23 @@
 #include "api/m64p_frontend.h"
 #include "plugin/plugin.h"
 #include "api/m64p_types.h"
+#include "r4300/block_profiler.h"
 #include "r4300/r4300.h"
+#include "r4300/cp1.h"
+#include "r4300/hacktarux_dynarec/codecache.h"
 #include "memory/memory.h"
 #include "main/main.h"
 #include "main/cheat.h"
+#include "main/movie.h"
 #include "main/version.h"
 #include "main/savestates.h"
 #include "dd/dd_disk.h"
 #include "pi/pi_controller.h"
 #include "si/pif.h"
 #include "libretro_memory.h"
+#ifdef HAVE_THREADED_EMU
+#include "emu_thread.h"
+#endif
 
 /* Cxd4 RSP */
 #include "../mupen64plus-rsp-cxd4/config.h"
@@ -72,6 +79,17 @@ save_memory_data saved_memory;
 #ifndef EMSCRIPTEN
 cothread_t main_thread;
 static cothread_t game_thread;
+
+/* Runs the emulator until it switches back to main_thread, which is made
+ * the context of the calling thread. The emulator thread drives the
+ * coroutine too, and libco backends that keep the active context per
+ * thread (LIBCO_MP, fibers) need it to switch back there and not to the
+ * frontend's thread. */
+static void switch_to_game_thread(void)
+{
+   main_thread = co_active();
+   co_switch(game_thread);
+}
 #endif
 
 float polygonOffsetFactor           = 0.0f;
@@ -116,6 +134,11 @@ bool alternate_mapping;
 
 static bool initializing            = true;
 
+#ifdef HAVE_THREADED_EMU
+static bool     threaded_emu        = false;
+static unsigned threaded_latency    = 1;
+#endif
+
 extern uint32_t VI_REFRESH;
 
 /* after the controller's CONTROL* member has been assigned we can update
@@ -287,6 +310,10 @@ static void setup_variables(void)
 #endif
 #else
          "CPU Core; cached_interpreter|pure_interpreter" },
+#endif
+#if defined(DYNAREC) && !defined(NEW_DYNAREC)
+      { NAME_PREFIX "-dynarec-cache",
+         "Dynarec Code Cache (restart); disabled|enabled" },
 #endif
       {NAME_PREFIX "-audio-buffer-size",
          "Audio Buffer Size (restart); 2048|1024"},
@@ -339,6 +366,14 @@ static void setup_variables(void)
       { NAME_PREFIX "-angrylion-vioverlay",
        "(Angrylion) VI Overlay; disabled|enabled"
       },
+      { NAME_PREFIX "-angrylion-threads",
+       "(Angrylion) Threads; auto|1|2|3|4|6|8"
+      },
+#ifdef HAVE_ANGRYLION_TILES
+      { NAME_PREFIX "-angrylion-parallel-rdp",
+       "(Angrylion) Multi-threaded rasterizer; disabled|enabled"
+      },
+#endif
       { NAME_PREFIX "-virefresh",
          "VI Refresh (Overclock); 1500|2200" },
       { NAME_PREFIX "-bufferswap",
@@ -358,6 +393,18 @@ static void setup_variables(void)
          "Boot Device; Default|64DD IPL" },
       { NAME_PREFIX "-64dd-hardware",
          "64DD Hardware; disabled|enabled" },
+      { NAME_PREFIX "-movie",
+         "Input Movie; disabled|record|play" },
+#ifdef PROFILE_BLOCKS
+      { NAME_PREFIX "-block-profiler",
+         "R4300 Block Profiler; disabled|enabled" },
+#endif
+#ifdef HAVE_THREADED_EMU
+      { NAME_PREFIX "-threaded-emu",
+         "(Angrylion) Threaded Emulation; disabled|enabled" },
+      { NAME_PREFIX "-threaded-latency",
+         "(Angrylion) Threaded Emulation Latency; 1|0" },
+#endif
       { NULL, NULL },
    };
 
@@ -551,6 +598,30 @@ bool emu_step_render(void)
    return false;
 }
 
+#ifdef HAVE_THREADED_EMU
+/* One frame on the emulator thread. Only used with the software
+ * renderer, nothing here needs a GL or Vulkan context. */
+static void emu_step_frame(void)
+{
+   blitter_buf_lock = blitter_buf;
+   FAKE_SDL_TICKS += 16;
+   pushed_frame = false;
+
+   movie_update();
+
+   do
+   {
+      switch_to_game_thread();
+   } while (emu_step_render());
+}
+
+static bool emu_thread_wanted(void)
+{
+   return threaded_emu && gfx_plugin == GFX_ANGRYLION
+      && !initializing && !first_time && !stop;
+}
+#endif
+
 static void emu_step_initialize(void)
 {
    if (emu_initialized)
@@ -575,7 +646,7 @@ void reinit_gfx_plugin(void)
     {
         first_context_reset = false;
 #ifndef EMSCRIPTEN
-        co_switch(game_thread);
+        switch_to_game_thread();
 #endif
     }
 
@@ -891,6 +962,9 @@ void retro_init(void)
 
 void retro_deinit(void)
 {
+#ifdef HAVE_THREADED_EMU
+   emu_thread_stop();
+#endif
    mupen_main_stop();
    mupen_main_exit();
 
@@ -918,6 +992,8 @@ void retro_deinit(void)
 extern void glide_set_filtering(unsigned value);
 #endif
 extern void angrylion_set_filtering(unsigned value);
+extern void angrylion_set_threads(unsigned count);
+extern void angrylion_set_parallel_rdp(unsigned enable);
 extern void ChangeSize();
 
 void update_variables(bool startup)
@@ -1017,6 +1093,20 @@ void update_variables(bool startup)
    else
       overlay = 1;
 
+   var.key = NAME_PREFIX "-angrylion-threads";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      angrylion_set_threads(strcmp(var.value, "auto") ? atoi(var.value) : 0);
+
+#ifdef HAVE_ANGRYLION_TILES
+   var.key = NAME_PREFIX "-angrylion-parallel-rdp";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      angrylion_set_parallel_rdp(!strcmp(var.value, "enabled"));
+#endif
+
    CFG_HLE_GFX = (gfx_plugin != GFX_ANGRYLION) && (gfx_plugin != GFX_PARALLEL) ? 1 : 0;
    CFG_HLE_AUD = 0; /* There is no HLE audio code in libretro audio plugin. */
 
@@ -1150,6 +1240,49 @@ void update_variables(bool startup)
          alternate_mapping = true;
    }
 
+#if defined(DYNAREC) && !defined(NEW_DYNAREC)
+   var.key = NAME_PREFIX "-dynarec-cache";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      codecache_enabled = !strcmp(var.value, "enabled");
+#endif
+
+   var.key = NAME_PREFIX "-movie";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (!strcmp(var.value, "record"))
+         movie_request(MOVIE_RECORD);
+      else if (!strcmp(var.value, "play"))
+         movie_request(MOVIE_PLAY);
+      else
+         movie_request(MOVIE_OFF);
+   }
+
+#ifdef PROFILE_BLOCKS
+   var.key = NAME_PREFIX "-block-profiler";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      block_profiler_set_enabled(!strcmp(var.value, "enabled"));
+#endif
+
+#ifdef HAVE_THREADED_EMU
+   var.key = NAME_PREFIX "-threaded-emu";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      threaded_emu = !strcmp(var.value, "enabled");
+
+   var.key = NAME_PREFIX "-threaded-latency";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      threaded_latency = !strcmp(var.value, "0") ? 0 : 1;
+#endif
+
 
    {
       struct retro_variable pk1var = { NAME_PREFIX "-pak1" };
@@ -1302,7 +1435,7 @@ bool retro_load_game(const struct retro_game_info *game)
    /* Finish ROM load before doing anything funny,
     * so we can return failure if needed. */
 #ifndef EMSCRIPTEN
-   co_switch(game_thread);
+   switch_to_game_thread();
 #endif
    if (stop)
       return false;
@@ -1314,11 +1447,14 @@ bool retro_load_game(const struct retro_game_info *game)
 
 void retro_unload_game(void)
 {
+#ifdef HAVE_THREADED_EMU
+    emu_thread_stop();
+#endif
     stop = 1;
     first_time = 1;
 
 #ifndef EMSCRIPTEN
-    co_switch(game_thread);
+    switch_to_game_thread();
 #endif
 
     CoreDoCommand(M64CMD_ROM_CLOSE, 0, NULL);
@@ -1326,6 +1462,29 @@ void retro_unload_game(void)
 }
 
 #if defined(HAVE_OPENGL) || defined(HAVE_OPENGLES)
+#ifdef GLSM_DEBUG
+/* GL calls per frame passed on and dropped by glsm, every 300 frames */
+static void glsm_log_stats(void)
+{
+   static const char *names[GLSM_STAT_MAX] = {
+      "texture", "program", "buffer", "framebuffer",
+      "cap", "state", "attrib", "uniform"
+   };
+   static unsigned frames = 0;
+   glsm_stats_t stats;
+   unsigned i;
+
+   if (++frames < 300)
+      return;
+
+   glsm_ctl(GLSM_CTL_STATS_GET, &stats);
+   for (i = 0; i < GLSM_STAT_MAX; i++)
+      log_cb(RETRO_LOG_DEBUG, "glsm: %-12s %8.1f issued %8.1f elided per frame\n",
+            names[i], stats.issued[i] / (float)frames, stats.elided[i] / (float)frames);
+   frames = 0;
+}
+#endif
+
 static void glsm_exit(void)
 {
 #ifndef HAVE_SHARED_CONTEXT
@@ -1354,6 +1513,9 @@ static void glsm_enter(void)
 #endif
    glsm_ctl(GLSM_CTL_STATE_BIND, NULL);
 #endif
+#ifdef GLSM_DEBUG
+   glsm_log_stats();
+#endif
 }
 #endif
 
@@ -1361,14 +1523,19 @@ void retro_run (void)
 {
    static bool updated = false;
 
-   blitter_buf_lock = blitter_buf;
-
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
    {
       static float last_aspect = 4.0 / 3.0;
       struct retro_variable var;
 
+#ifdef HAVE_THREADED_EMU
+      emu_thread_sync();
+#endif
       update_variables(false);
+#ifdef HAVE_THREADED_EMU
+      if (emu_thread_is_running())
+         emu_thread_set_latency(threaded_latency);
+#endif
 
       var.key = NAME_PREFIX "-aspectratiohint";
       var.value = NULL;
@@ -1426,9 +1593,6 @@ void retro_run (void)
       }
    }
 
-   FAKE_SDL_TICKS += 16;
-   pushed_frame = false;
-
    if (reinit_screen)
    {
       bool ret;
@@ -1447,6 +1611,32 @@ void retro_run (void)
       reinit_screen = false;
    }
 
+#ifdef HAVE_THREADED_EMU
+   if (emu_thread_wanted())
+   {
+      if (emu_thread_start(emu_step_frame, threaded_latency))
+      {
+         emu_thread_run();
+         return;
+      }
+
+      if (log_cb)
+         log_cb(RETRO_LOG_ERROR, "Could not start the emulator thread.\n");
+      threaded_emu = false;
+   }
+   else
+      emu_thread_stop();
+#endif
+
+   blitter_buf_lock = blitter_buf;
+   FAKE_SDL_TICKS += 16;
+   pushed_frame = false;
+
+   /* Once per frame, as emu_step_frame() does: the loop below runs the
+    * emulator again until it has pushed a frame. */
+   if (!first_time && !initializing)
+      movie_update();
+
    do
    {
       switch (gfx_plugin)
@@ -1474,7 +1664,7 @@ void retro_run (void)
       }
 
 #ifndef EMSCRIPTEN
-      co_switch(game_thread);
+      switch_to_game_thread();
 #endif
 
       switch (gfx_plugin)
@@ -1495,16 +1685,36 @@ void retro_run (void)
 
 void retro_reset (void)
 {
+#ifdef HAVE_THREADED_EMU
+    emu_thread_sync();
+#endif
     CoreDoCommand(M64CMD_RESET, 1, (void*)0);
 }
 
 void *retro_get_memory_data(unsigned type)
 {
-   return (type == RETRO_MEMORY_SAVE_RAM) ? &saved_memory : 0;
+#ifdef HAVE_THREADED_EMU
+   emu_thread_sync();
+#endif
+   switch (type)
+   {
+      case RETRO_MEMORY_SAVE_RAM:
+         return &saved_memory;
+      case RETRO_MEMORY_SYSTEM_RAM:
+         return g_rdram;
+      default:
+         return 0;
+   }
 }
 
 size_t retro_get_memory_size(unsigned type)
 {
+#ifdef HAVE_THREADED_EMU
+   emu_thread_sync();
+#endif
+   if (type == RETRO_MEMORY_SYSTEM_RAM)
+      return RDRAM_MAX_SIZE;
+
    if (type != RETRO_MEMORY_SAVE_RAM)
       return 0;
 
@@ -1524,6 +1734,9 @@ bool retro_serialize(void *data, size_t size)
     if (initializing)
        return false;
 
+#ifdef HAVE_THREADED_EMU
+    emu_thread_sync();
+#endif
     if (savestates_save_m64p(data, size))
         return true;
 
@@ -1535,6 +1748,9 @@ bool retro_unserialize(const void * data, size_t size)
     if (initializing)
        return false;
 
+#ifdef HAVE_THREADED_EMU
+    emu_thread_sync();
+#endif
     if (savestates_load_m64p(data, size))
         return true;
 
@@ -1549,6 +1765,9 @@ bool retro_unserialize(const void * data, size_t size)
  */
 void retro_set_controller_port_device(unsigned in_port, unsigned device)
 {
+#ifdef HAVE_THREADED_EMU
+   emu_thread_sync();
+#endif
    if (in_port < 4)
    {
       switch(device)
@@ -1591,6 +1810,9 @@ bool retro_load_game_special(unsigned game_type, const struct retro_game_info *i
 
 void retro_cheat_reset(void)
 {
+#ifdef HAVE_THREADED_EMU
+	emu_thread_sync();
+#endif
 	cheat_delete_all();
 }
 
@@ -1631,6 +1853,9 @@ void retro_cheat_set(unsigned index, bool enabled, const char* codeLine)
 	}
 
 	//Assign to mupenCode
+#ifdef HAVE_THREADED_EMU
+	emu_thread_sync();
+#endif
 	cheat_add_new(name,mupenCode,partCount/2);
 	cheat_set_enabled(name,enabled);
 }
@@ -1653,5 +1878,7 @@ int retro_return(int just_flipping)
    co_switch(main_thread);
 #endif
 
+   invalidate_host_rounding_mode();
+
    return 0;
 }
@@ -9,10 +9,12 @@ extern "C" {
 
 extern struct retro_perf_callback perf_cb;
 
-#if 1
-#define RETRO_PERFORMANCE_INIT(perf_cb, name) static struct retro_perf_counter name = {#name}; if (!name.registered) perf_cb.perf_register(&(name))
-#define RETRO_PERFORMANCE_START(perf_cb, name) perf_cb.perf_start(&(name))
-#define RETRO_PERFORMANCE_STOP(perf_cb, name) perf_cb.perf_stop(&(name))
+/* Counters are only compiled in with PERF_TEST=1 and stay inert when the
+ * frontend doesn't provide a perf interface. */
+#ifdef PERF_TEST
+#define RETRO_PERFORMANCE_INIT(perf_cb, name) static struct retro_perf_counter name = {#name}; if (!name.registered && perf_cb.perf_register) perf_cb.perf_register(&(name))
+#define RETRO_PERFORMANCE_START(perf_cb, name) do { if (name.registered) perf_cb.perf_start(&(name)); } while (0)
+#define RETRO_PERFORMANCE_STOP(perf_cb, name) do { if (name.registered) perf_cb.perf_stop(&(name)); } while (0)
 #else
 #define RETRO_PERFORMANCE_INIT(perf_cb, name)
 #define RETRO_PERFORMANCE_START(perf_cb, name)
@@ -46,6 +46,7 @@
 #include "main.h"
 #include "cheat.h"
 #include "eventloop.h"
+#include "movie.h"
 #include "rom.h"
 #include "savestates.h"
 #include "util.h"
@@ -260,6 +261,8 @@ void mupen_main_exit(void)
       destroy_debugger();
 #endif
 
+   movie_rom_closed();
+
    if (rsp.romClosed) rsp.romClosed();
    if (input.romClosed) input.romClosed();
    if (gfx.romClosed) gfx.romClosed();
@@ -292,6 +295,8 @@ void new_vi(void)
 
    main_check_inputs();
 
+   movie_new_vi();
+
 #if 0
    timed_sections_refresh();
 
@@ -453,6 +458,8 @@ m64p_error main_init(void)
    g_EmulatorRunning = 1;
    StateChanged(M64CORE_EMU_STATE, M64EMU_RUNNING);
 
+   movie_rom_open(ROM_SETTINGS.MD5);
+
    /* call r4300 CPU core and run the game */
    r4300_reset_hard();
    r4300_reset_soft();
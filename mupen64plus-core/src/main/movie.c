@@ -0,0 +1,355 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - movie.c                                                 *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+
+#include "movie.h"
+#include "savestates.h"
+
+#include "api/callbacks.h"
+#include "api/libretro.h"
+#include "api/m64p_config.h"
+#include "api/m64p_types.h"
+
+/* File layout, little endian:
+ *   "N64M", version, ROM md5 (32 chars), RTC start (64-bit seconds),
+ *   savestate size (0 when the movie starts at power on), savestate,
+ *   then for each VI the four controller words. */
+#define MOVIE_MAGIC       "N64M"
+#define MOVIE_VERSION     1
+#define MOVIE_HEADER_SIZE (4 + 4 + 32 + 8 + 4)
+#define MOVIE_FRAME_SIZE  (4 * 4)
+
+/* The RTC advances by one second every 60 VIs. */
+#define MOVIE_VI_PER_SECOND 60
+
+static enum movie_mode requested;
+static enum movie_mode mode;
+
+static FILE *movie_fp;
+static char movie_path[PATH_MAX_LENGTH];
+static char movie_md5[33];
+
+static uint32_t movie_keys[4];
+static uint32_t movie_frames;
+static int64_t movie_rtc_base;
+
+/* A played movie's savestate, loaded by movie_update() between frames. */
+static unsigned char *movie_state;
+static uint32_t movie_state_size;
+
+static void put32(unsigned char *p, uint32_t v)
+{
+   p[0] = v;
+   p[1] = v >> 8;
+   p[2] = v >> 16;
+   p[3] = v >> 24;
+}
+
+static uint32_t get32(const unsigned char *p)
+{
+   return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void movie_close(void)
+{
+   if (movie_fp)
+      fclose(movie_fp);
+   movie_fp = NULL;
+
+   free(movie_state);
+   movie_state = NULL;
+   movie_state_size = 0;
+
+   mode = MOVIE_OFF;
+}
+
+static int write_frame(void)
+{
+   unsigned char buf[MOVIE_FRAME_SIZE];
+   int i;
+
+   for (i = 0; i < 4; i++)
+      put32(&buf[i * 4], movie_keys[i]);
+
+   return fwrite(buf, 1, MOVIE_FRAME_SIZE, movie_fp) == MOVIE_FRAME_SIZE;
+}
+
+static int read_frame(void)
+{
+   unsigned char buf[MOVIE_FRAME_SIZE];
+   int i;
+
+   if (fread(buf, 1, MOVIE_FRAME_SIZE, movie_fp) != MOVIE_FRAME_SIZE)
+      return 0;
+
+   for (i = 0; i < 4; i++)
+      movie_keys[i] = get32(&buf[i * 4]);
+   return 1;
+}
+
+static void movie_stop(void)
+{
+   if (mode == MOVIE_RECORD)
+   {
+      /* The input read after the last VI */
+      write_frame();
+      DebugMessage(M64MSG_INFO, "Recorded %u VIs to %s.", movie_frames + 1, movie_path);
+   }
+   else if (mode == MOVIE_PLAY)
+      DebugMessage(M64MSG_INFO, "Movie stopped after %u VIs.", movie_frames);
+
+   movie_close();
+}
+
+static void movie_start_record(int running)
+{
+   unsigned char header[MOVIE_HEADER_SIZE];
+   unsigned char *state = NULL;
+   uint32_t state_size = 0;
+   int ok;
+
+   if (running)
+   {
+      state_size = retro_serialize_size();
+      state = (unsigned char*)malloc(state_size);
+      if (!state || !savestates_save_m64p(state, state_size))
+      {
+         DebugMessage(M64MSG_ERROR, "Could not save the state a movie starts from.");
+         free(state);
+         return;
+      }
+   }
+
+   movie_fp = fopen(movie_path, "wb");
+   if (!movie_fp)
+   {
+      DebugMessage(M64MSG_ERROR, "Could not create movie %s.", movie_path);
+      free(state);
+      return;
+   }
+
+   movie_rtc_base = (int64_t)time(NULL);
+
+   memcpy(header, MOVIE_MAGIC, 4);
+   put32(&header[4], MOVIE_VERSION);
+   memcpy(&header[8], movie_md5, 32);
+   put32(&header[40], (uint32_t)movie_rtc_base);
+   put32(&header[44], (uint32_t)((uint64_t)movie_rtc_base >> 32));
+   put32(&header[48], state_size);
+
+   ok = fwrite(header, 1, MOVIE_HEADER_SIZE, movie_fp) == MOVIE_HEADER_SIZE;
+   if (ok && state_size)
+      ok = fwrite(state, 1, state_size, movie_fp) == state_size;
+   free(state);
+
+   if (!ok)
+   {
+      DebugMessage(M64MSG_ERROR, "Could not write movie %s.", movie_path);
+      movie_close();
+      return;
+   }
+
+   memset(movie_keys, 0, sizeof(movie_keys));
+   movie_frames = 0;
+   mode = MOVIE_RECORD;
+   DebugMessage(M64MSG_INFO, "Recording movie %s from %s.", movie_path,
+         running ? "the current state" : "power on");
+}
+
+static void movie_start_play(int running)
+{
+   unsigned char header[MOVIE_HEADER_SIZE];
+
+   movie_fp = fopen(movie_path, "rb");
+   if (!movie_fp)
+   {
+      DebugMessage(M64MSG_ERROR, "Could not open movie %s.", movie_path);
+      return;
+   }
+
+   if (fread(header, 1, MOVIE_HEADER_SIZE, movie_fp) != MOVIE_HEADER_SIZE
+         || memcmp(header, MOVIE_MAGIC, 4)
+         || get32(&header[4]) != MOVIE_VERSION)
+   {
+      DebugMessage(M64MSG_ERROR, "%s is not a movie this core can play.", movie_path);
+      movie_close();
+      return;
+   }
+
+   if (memcmp(&header[8], movie_md5, 32))
+      DebugMessage(M64MSG_WARNING, "Movie %s was recorded with another ROM.", movie_path);
+
+   movie_rtc_base = (int64_t)((uint64_t)get32(&header[44]) << 32 | get32(&header[40]));
+   movie_state_size = get32(&header[48]);
+
+   if (movie_state_size)
+   {
+      movie_state = (unsigned char*)malloc(movie_state_size);
+      if (!movie_state
+            || fread(movie_state, 1, movie_state_size, movie_fp) != movie_state_size)
+      {
+         DebugMessage(M64MSG_ERROR, "Movie %s is truncated.", movie_path);
+         movie_close();
+      }
+      /* Played once the state is loaded */
+      return;
+   }
+
+   if (running)
+   {
+      DebugMessage(M64MSG_ERROR, "Movie %s starts at power on, restart the game to play it.",
+            movie_path);
+      movie_close();
+      return;
+   }
+
+   movie_frames = 0;
+   if (!read_frame())
+      memset(movie_keys, 0, sizeof(movie_keys));
+   mode = MOVIE_PLAY;
+   DebugMessage(M64MSG_INFO, "Playing movie %s from power on.", movie_path);
+}
+
+static void movie_start(int running)
+{
+   if (!movie_md5[0])
+      return;
+
+   if (requested == MOVIE_RECORD)
+      movie_start_record(running);
+   else if (requested == MOVIE_PLAY)
+      movie_start_play(running);
+
+   /* Don't try again every frame */
+   if (mode == MOVIE_OFF && !movie_state)
+      requested = MOVIE_OFF;
+}
+
+void movie_request(enum movie_mode new_mode)
+{
+   requested = new_mode;
+}
+
+void movie_rom_open(const char *rom_md5)
+{
+   const char *dir = ConfigGetUserDataPath();
+
+   movie_close();
+   movie_md5[0] = '\0';
+   if (!rom_md5 || strlen(rom_md5) != 32 || !dir)
+      return;
+
+   memcpy(movie_md5, rom_md5, 33);
+   snprintf(movie_path, sizeof(movie_path), "%s/mupen64plus_%s.movie", dir, rom_md5);
+
+   movie_start(0);
+}
+
+void movie_rom_closed(void)
+{
+   movie_stop();
+   movie_md5[0] = '\0';
+}
+
+/* Called between frames, where the state can be saved and loaded. */
+void movie_update(void)
+{
+   if (movie_state)
+   {
+      if (!savestates_load_m64p(movie_state, movie_state_size))
+      {
+         DebugMessage(M64MSG_ERROR, "Could not load the state movie %s starts from.", movie_path);
+         movie_close();
+         requested = MOVIE_OFF;
+         return;
+      }
+
+      free(movie_state);
+      movie_state = NULL;
+      movie_frames = 0;
+      if (!read_frame())
+         memset(movie_keys, 0, sizeof(movie_keys));
+      mode = MOVIE_PLAY;
+      DebugMessage(M64MSG_INFO, "Playing movie %s from its savestate.", movie_path);
+      return;
+   }
+
+   if (requested != mode)
+   {
+      movie_stop();
+      movie_start(1);
+   }
+}
+
+void movie_new_vi(void)
+{
+   switch (mode)
+   {
+      case MOVIE_RECORD:
+         if (!write_frame())
+         {
+            DebugMessage(M64MSG_ERROR, "Could not write movie %s.", movie_path);
+            movie_close();
+            requested = MOVIE_OFF;
+            return;
+         }
+         movie_frames++;
+         break;
+      case MOVIE_PLAY:
+         movie_frames++;
+         if (!read_frame())
+         {
+            movie_stop();
+            requested = MOVIE_OFF;
+         }
+         break;
+      default:
+         break;
+   }
+}
+
+int movie_get_input(int channel, uint32_t *keys)
+{
+   if (mode != MOVIE_PLAY)
+      return 0;
+
+   *keys = movie_keys[channel & 3];
+   return 1;
+}
+
+void movie_record_input(int channel, uint32_t keys)
+{
+   if (mode == MOVIE_RECORD)
+      movie_keys[channel & 3] = keys;
+}
+
+int movie_get_time(time_t *t)
+{
+   if (mode == MOVIE_OFF)
+      return 0;
+
+   *t = (time_t)(movie_rtc_base + movie_frames / MOVIE_VI_PER_SECOND);
+   return 1;
+}
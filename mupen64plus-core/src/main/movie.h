@@ -0,0 +1,56 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - movie.h                                                 *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_MOVIE_H
+#define M64P_MAIN_MOVIE_H
+
+#include <stdint.h>
+#include <time.h>
+
+/* Input movies.
+ *
+ * A movie holds the controller words the game read on each VI, from power
+ * on or from a savestate embedded in the movie, and the time the AF-RTC
+ * starts from. While a movie is recorded or played the RTC counts VIs
+ * instead of following the host clock, so a replay reads the same input
+ * and time as the recording and runs the same frames.
+ *
+ * The movie of a ROM is mupen64plus_<md5>.movie in the user data folder.
+ * The mode is requested through the core option: at ROM open it starts
+ * from power on, later on from the current state. */
+enum movie_mode
+{
+   MOVIE_OFF = 0,
+   MOVIE_RECORD,
+   MOVIE_PLAY
+};
+
+void movie_request(enum movie_mode mode);
+
+void movie_rom_open(const char *rom_md5);
+void movie_rom_closed(void);
+void movie_update(void);
+
+void movie_new_vi(void);
+int movie_get_input(int channel, uint32_t *keys);
+void movie_record_input(int channel, uint32_t keys);
+int movie_get_time(time_t *t);
+
+#endif /* M64P_MAIN_MOVIE_H */
@@ -225,6 +225,7 @@ int savestates_load_m64p(const unsigned char *data, size_t size)
 
    COPYARRAY(tlb_LUT_r, curr, unsigned int, 0x100000);
    COPYARRAY(tlb_LUT_w, curr, unsigned int, 0x100000);
+   tlb_cache_flush();
 
    *r4300_llbit() = GETDATA(curr, unsigned int);
    COPYARRAY(r4300_regs(), curr, int64_t, 32);
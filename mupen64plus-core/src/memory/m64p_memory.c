@@ -208,8 +208,62 @@ static void write_nothingd(void)
 {
 }
 
+/* Looks the mapped page of address up in the TLB cache and returns the
+ * RDRAM word it hits, or NULL if the access has to go through
+ * virtual_to_physical_address() and the memory handlers. Only pages whose
+ * physical address is in plain RDRAM are cached, so there is no exception
+ * or handler side effect to skip. */
+static uint32_t* tlb_cache_lookup(uint32_t vaddr, int w)
+{
+    uint32_t page = vaddr >> 12;
+    struct tlb_cache_entry* entry = w
+        ? &tlb_cache_w[page & (TLB_CACHE_SIZE - 1)]
+        : &tlb_cache_r[page & (TLB_CACHE_SIZE - 1)];
+    uint32_t lut;
+    uint32_t phys;
+
+    if (entry->tag == page + 1)
+        goto hit;
+
+    if (vaddr >= UINT32_C(0x7f000000) && vaddr < UINT32_C(0x80000000) && isGoldeneyeRom)
+        return NULL;
+
+    lut = w ? tlb_LUT_w[page] : tlb_LUT_r[page];
+    if (lut == 0)
+        return NULL;
+
+    phys = lut & UINT32_C(0xFFFFF000);
+    if (w ? writemem[phys >> 16] != write_rdram : readmem[phys >> 16] != read_rdram)
+        return NULL;
+    if ((phys & UINT32_C(0xffffff)) + 0x1000 > g_ri.rdram.dram_size)
+        return NULL;
+
+    entry->tag  = page + 1;
+    entry->phys = phys;
+    entry->host = &g_ri.rdram.dram[(phys & UINT32_C(0xffffff)) >> 2];
+
+hit:
+    address = entry->phys | (vaddr & 0xFFF);
+    return &entry->host[(vaddr & 0xFFF) >> 2];
+}
+
+/* The TLB cache only holds pages whose handlers are the plain RDRAM ones,
+ * so it has to be dropped when one of the RDRAM regions is remapped. */
+static void tlb_cache_remap(uint16_t region)
+{
+    if ((region & 0xe000) == 0x8000 && (region & 0x1fff) < (RDRAM_MAX_SIZE >> 16))
+        tlb_cache_flush();
+}
+
 static void read_nomem(void)
 {
+    uint32_t* mem = tlb_cache_lookup(address, 0);
+    if (mem != NULL)
+    {
+        *rdword = *mem;
+        return;
+    }
+
     address = virtual_to_physical_address(address,0);
     if (address == 0x00000000) return;
     read_word_in_memory();
@@ -217,6 +271,13 @@ static void read_nomem(void)
 
 static void read_nomemb(void)
 {
+    uint32_t* mem = tlb_cache_lookup(address, 0);
+    if (mem != NULL)
+    {
+        *rdword = (*mem >> BSHIFT(address)) & 0xff;
+        return;
+    }
+
     address = virtual_to_physical_address(address,0);
     if (address == 0x00000000) return;
     read_byte_in_memory();
@@ -224,6 +285,13 @@ static void read_nomemb(void)
 
 static void read_nomemh(void)
 {
+    uint32_t* mem = tlb_cache_lookup(address, 0);
+    if (mem != NULL)
+    {
+        *rdword = (*mem >> HSHIFT(address)) & 0xffff;
+        return;
+    }
+
     address = virtual_to_physical_address(address,0);
     if (address == 0x00000000) return;
     read_hword_in_memory();
@@ -231,6 +299,13 @@ static void read_nomemh(void)
 
 static void read_nomemd(void)
 {
+    uint32_t* mem = tlb_cache_lookup(address, 0);
+    if (mem != NULL)
+    {
+        *rdword = ((uint64_t)mem[0] << 32) | mem[1];
+        return;
+    }
+
     address = virtual_to_physical_address(address,0);
     if (address == 0x00000000) return;
     read_dword_in_memory();
@@ -238,7 +313,16 @@ static void read_nomemd(void)
 
 static void write_nomem(void)
 {
+    uint32_t* mem;
+
     invalidate_r4300_cached_code(address, 4);
+    mem = tlb_cache_lookup(address, 1);
+    if (mem != NULL)
+    {
+        *mem = cpu_word;
+        return;
+    }
+
     address = virtual_to_physical_address(address,1);
     if (address == 0x00000000) return;
     write_word_in_memory();
@@ -246,7 +330,17 @@ static void write_nomem(void)
 
 static void write_nomemb(void)
 {
+    uint32_t* mem;
+
     invalidate_r4300_cached_code(address, 1);
+    mem = tlb_cache_lookup(address, 1);
+    if (mem != NULL)
+    {
+        unsigned int shift = BSHIFT(address);
+        *mem = (*mem & ~((uint32_t)0xff << shift)) | ((uint32_t)cpu_byte << shift);
+        return;
+    }
+
     address = virtual_to_physical_address(address,1);
     if (address == 0x00000000) return;
     write_byte_in_memory();
@@ -254,7 +348,17 @@ static void write_nomemb(void)
 
 static void write_nomemh(void)
 {
+    uint32_t* mem;
+
     invalidate_r4300_cached_code(address, 2);
+    mem = tlb_cache_lookup(address, 1);
+    if (mem != NULL)
+    {
+        unsigned int shift = HSHIFT(address);
+        *mem = (*mem & ~((uint32_t)0xffff << shift)) | ((uint32_t)cpu_hword << shift);
+        return;
+    }
+
     address = virtual_to_physical_address(address,1);
     if (address == 0x00000000) return;
     write_hword_in_memory();
@@ -262,7 +366,17 @@ static void write_nomemh(void)
 
 static void write_nomemd(void)
 {
+    uint32_t* mem;
+
     invalidate_r4300_cached_code(address, 8);
+    mem = tlb_cache_lookup(address, 1);
+    if (mem != NULL)
+    {
+        mem[0] = (uint32_t)(cpu_dword >> 32);
+        mem[1] = (uint32_t)cpu_dword;
+        return;
+    }
+
     address = virtual_to_physical_address(address,1);
     if (address == 0x00000000) return;
     write_dword_in_memory();
@@ -1104,6 +1218,7 @@ void activate_memory_break_read(uint32_t address)
    readmemh[region] = readmemh_with_bp_checks;
    readmem [region] = readmem_with_bp_checks;
    readmemd[region] = readmemd_with_bp_checks;
+   tlb_cache_remap(region);
 }
 
 void deactivate_memory_break_read(uint32_t address)
@@ -1121,6 +1236,7 @@ void deactivate_memory_break_read(uint32_t address)
    saved_readmemh[region] = NULL;
    saved_readmem [region] = NULL;
    saved_readmemd[region] = NULL;
+   tlb_cache_remap(region);
 }
 
 void activate_memory_break_write(uint32_t address)
@@ -1138,6 +1254,7 @@ void activate_memory_break_write(uint32_t address)
    writememh[region] = writememh_with_bp_checks;
    writemem [region] = writemem_with_bp_checks;
    writememd[region] = writememd_with_bp_checks;
+   tlb_cache_remap(region);
 }
 
 void deactivate_memory_break_write(uint32_t address)
@@ -1155,6 +1272,7 @@ void deactivate_memory_break_write(uint32_t address)
    saved_writememh[region] = NULL;
    saved_writemem [region] = NULL;
    saved_writememd[region] = NULL;
+   tlb_cache_remap(region);
 }
 
 int get_memory_type(uint32_t address)
@@ -1425,6 +1543,7 @@ static void map_region_r(uint16_t region,
       readmem [region] = read32;
       readmemd[region] = read64;
    }
+   tlb_cache_remap(region);
 }
 
 void map_region_w(uint16_t region,
@@ -1454,6 +1573,7 @@ void map_region_w(uint16_t region,
       writemem [region] = write32;
       writememd[region] = write64;
    }
+   tlb_cache_remap(region);
 }
 
 void map_region(uint16_t region,
@@ -38,6 +38,8 @@
 #include <audio/conversion/s16_to_float.h>
 #include <audio/audio_resampler.h>
 
+#include "libretro_perf.h"
+
 extern retro_audio_sample_batch_t audio_batch_cb;
 
 static unsigned MAX_AUDIO_FRAMES = 2048;
@@ -129,6 +131,7 @@ void push_audio_samples_via_libretro(void* user_data, const void* buffer, size_t
    /* save registers values */
    uint32_t saved_ai_length = g_ai.regs[AI_LEN_REG];
    uint32_t saved_ai_dram = g_ai.regs[AI_DRAM_ADDR_REG];
+   RETRO_PERFORMANCE_INIT(perf_cb, perf_audio);
 
    /* notify plugin of new samples to play.
     * Exploit the fact that buffer points in g_rdram to retreive dram_addr_reg value */
@@ -164,9 +167,26 @@ audio_batch:
    data.input_frames = frames;
    data.ratio        = ratio;
 
-   convert_s16_to_float(audio_in_buffer_float, raw_data, frames * 2, 1.0f);
-   resampler->process(resampler_audio_data, &data);
-   convert_float_to_s16(audio_out_buffer_s16, audio_out_buffer_float, data.output_frames * 2);
+   RETRO_PERFORMANCE_START(perf_cb, perf_audio);
+   if (resampler->process_s16)
+   {
+      struct resampler_data_s16 data_s16;
+
+      data_s16.data_in       = raw_data;
+      data_s16.data_out      = audio_out_buffer_s16;
+      data_s16.input_frames  = frames;
+      data_s16.output_frames = 0;
+      data_s16.ratio         = ratio;
+
+      resampler->process_s16(resampler_audio_data, &data_s16);
+      data.output_frames = data_s16.output_frames;
+   }
+   else
+   {
+      convert_s16_to_float(audio_in_buffer_float, raw_data, frames * 2, 1.0f);
+      resampler->process(resampler_audio_data, &data);
+      convert_float_to_s16(audio_out_buffer_s16, audio_out_buffer_float, data.output_frames * 2);
+   }
 
    out                    = audio_out_buffer_s16;
 
@@ -176,6 +196,7 @@ audio_batch:
       data.output_frames -= ret;
       out                += ret * 2;
    }
+   RETRO_PERFORMANCE_STOP(perf_cb, perf_audio);
    if (remain_frames)
    {
       raw_data = raw_data + frames * 2;
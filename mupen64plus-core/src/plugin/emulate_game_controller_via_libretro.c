@@ -25,6 +25,7 @@
 #include "api/m64p_plugin.h"
 #include "api/libretro.h"
 #include "si/game_controller.h"
+#include "main/movie.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -1016,9 +1017,13 @@ uint32_t egcvip_get_input(void* opaque)
     BUTTONS keys = { 0 };
     int channel = *(int*)opaque;
 
+    if (movie_get_input(channel, &keys.Value))
+       return keys.Value;
+
     if (getKeys)
        getKeys(channel, &keys);
 
+    movie_record_input(channel, keys.Value);
     return keys.Value;
 
 }
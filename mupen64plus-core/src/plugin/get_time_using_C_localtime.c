@@ -23,11 +23,17 @@
 
 #include <time.h>
 
+#include "main/movie.h"
+
 
 const struct tm* get_time_using_C_localtime(void* user_data)
 {
     time_t current_time;
 
+    /* Movies replay the same time on any host, whatever its time zone */
+    if (movie_get_time(&current_time))
+        return gmtime(&current_time);
+
     time(&current_time);
     return localtime(&current_time);
 }
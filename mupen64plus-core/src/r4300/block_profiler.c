@@ -0,0 +1,285 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - block_profiler.c                                        *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#if defined(PROFILE_BLOCKS)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "block_profiler.h"
+#include "cp0_private.h"
+#include "r4300.h"
+#include "tlb.h"
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "debugger/dbg_decoder.h"
+#include "memory/memory.h"
+
+#if defined(WIN32) && !defined(__MINGW32__)
+#include <windows.h>
+static long long int get_time(void)
+{
+   LARGE_INTEGER counter;
+   QueryPerformanceCounter(&counter);
+   return counter.QuadPart;
+}
+static long long int time_to_nsec(long long int time)
+{
+   static LARGE_INTEGER freq = { 0 };
+   if (freq.QuadPart == 0)
+      QueryPerformanceFrequency(&freq);
+   return time * 1000000000 / freq.QuadPart;
+}
+#else
+#include <time.h>
+static long long int get_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (long long int)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+static long long int time_to_nsec(long long int time)
+{
+   return time;
+}
+#endif
+
+/* open addressed hash table, must be a power of two */
+#define BLOCK_TABLE_SIZE   0x10000
+#define BLOCK_TABLE_LIMIT  (BLOCK_TABLE_SIZE / 4 * 3)
+#define REPORT_BLOCKS      32
+#define MAX_DISASM_INSTR   16
+
+struct block_entry
+{
+   int used;
+   uint32_t start;
+   uint64_t hits;
+   uint64_t cycles;
+   long long int host_time;
+};
+
+int g_block_profiler_enabled = 0;
+
+static struct block_entry block_table[BLOCK_TABLE_SIZE];
+static unsigned int block_count;
+static unsigned int dropped_entries;
+
+static struct block_entry *current_block;
+static uint32_t block_start_count;
+static long long int block_start_time;
+
+static struct block_entry *lookup_block(uint32_t pc)
+{
+   unsigned int i = ((pc >> 2) * UINT32_C(0x9E3779B1)) >> 16;
+
+   for (;;)
+   {
+      struct block_entry *e = &block_table[i & (BLOCK_TABLE_SIZE - 1)];
+
+      if (!e->used)
+      {
+         if (block_count >= BLOCK_TABLE_LIMIT)
+            return NULL;
+         e->used  = 1;
+         e->start = pc;
+         block_count++;
+         return e;
+      }
+      if (e->start == pc)
+         return e;
+      i++;
+   }
+}
+
+static void reset_table(void)
+{
+   memset(block_table, 0, sizeof(block_table));
+   block_count     = 0;
+   dropped_entries = 0;
+   current_block   = NULL;
+}
+
+void block_profiler_enter(uint32_t pc)
+{
+   uint32_t count = g_cp0_regs[CP0_COUNT_REG];
+   long long int now = get_time();
+
+   if (current_block != NULL)
+   {
+      current_block->cycles    += (uint32_t)(count - block_start_count);
+      current_block->host_time += now - block_start_time;
+   }
+
+   current_block = lookup_block(pc);
+   if (current_block != NULL)
+      current_block->hits++;
+   else
+      dropped_entries++;
+
+   block_start_count = count;
+   block_start_time  = now;
+}
+
+void block_profiler_enter_last_addr(void)
+{
+   if (g_block_profiler_enabled)
+      block_profiler_enter(last_addr);
+}
+
+/* Reads a guest instruction word without raising TLB exceptions. */
+static int read_guest_word(uint32_t addr, uint32_t *word)
+{
+   uint32_t *p;
+
+   if ((addr & UINT32_C(0xc0000000)) != UINT32_C(0x80000000))
+   {
+      uint32_t lut = tlb_LUT_r[addr >> 12];
+      if (lut == 0)
+         return 0;
+      addr = (lut & UINT32_C(0xFFFFF000)) | (addr & UINT32_C(0xFFF));
+   }
+
+   p = fast_mem_access(addr);
+   if (p == NULL)
+      return 0;
+
+   *word = *p;
+   return 1;
+}
+
+static int is_branch(uint32_t instr)
+{
+   switch (instr >> 26)
+   {
+      case 0: /* SPECIAL: JR, JALR */
+         return (instr & 0x3F) == 8 || (instr & 0x3F) == 9;
+      case 1: /* REGIMM */
+      case 2: case 3:
+      case 4: case 5: case 6: case 7:
+      case 20: case 21: case 22: case 23:
+         return 1;
+      case 17: /* COP1: BC1x */
+         return ((instr >> 21) & 0x1F) == 8;
+   }
+   return 0;
+}
+
+static void disassemble_block(uint32_t start)
+{
+   char opcode[64];
+   char args[128];
+   uint32_t pc = start;
+   int remaining = -1;
+   int i;
+
+   for (i = 0; i < MAX_DISASM_INSTR && remaining != 0; i++, pc += 4)
+   {
+      uint32_t instr;
+
+      if (!read_guest_word(pc, &instr))
+      {
+         DebugMessage(M64MSG_INFO, "      %08x: <unmapped>", pc);
+         return;
+      }
+
+      r4300_decode_op(instr, opcode, args, pc);
+      DebugMessage(M64MSG_INFO, "      %08x: %08x  %-8s %s", pc, instr, opcode, args);
+
+      if (remaining > 0)
+         remaining--;
+      else if (is_branch(instr))
+         remaining = 1; /* delay slot */
+   }
+}
+
+static int compare_cycles(const void *a, const void *b)
+{
+   const struct block_entry *ea = *(const struct block_entry * const *)a;
+   const struct block_entry *eb = *(const struct block_entry * const *)b;
+
+   if (ea->cycles != eb->cycles)
+      return ea->cycles < eb->cycles ? 1 : -1;
+   return ea->start < eb->start ? -1 : 1;
+}
+
+void block_profiler_report(void)
+{
+   struct block_entry **sorted;
+   uint64_t total_cycles = 0;
+   long long int total_time = 0;
+   unsigned int i, n = 0;
+
+   if (block_count == 0)
+      return;
+
+   sorted = (struct block_entry **)malloc(block_count * sizeof(*sorted));
+   if (sorted == NULL)
+      return;
+
+   for (i = 0; i < BLOCK_TABLE_SIZE; i++)
+   {
+      if (!block_table[i].used)
+         continue;
+      sorted[n++] = &block_table[i];
+      total_cycles += block_table[i].cycles;
+      total_time   += block_table[i].host_time;
+   }
+
+   qsort(sorted, n, sizeof(*sorted), compare_cycles);
+
+   DebugMessage(M64MSG_INFO, "Block profile: %u blocks, %llu cycles, %lld us host time",
+                n, (unsigned long long)total_cycles, time_to_nsec(total_time) / 1000);
+   if (dropped_entries > 0)
+      DebugMessage(M64MSG_WARNING, "Block profile: table full, %u block entries not recorded",
+                   dropped_entries);
+
+   for (i = 0; i < n && i < REPORT_BLOCKS; i++)
+   {
+      const struct block_entry *e = sorted[i];
+
+      DebugMessage(M64MSG_INFO, "  #%-2u %08x  hits %10llu  cycles %12llu (%5.2f%%)  host %8lld us",
+                   i + 1, e->start,
+                   (unsigned long long)e->hits,
+                   (unsigned long long)e->cycles,
+                   total_cycles ? 100.0 * e->cycles / total_cycles : 0.0,
+                   time_to_nsec(e->host_time) / 1000);
+      disassemble_block(e->start);
+   }
+
+   free(sorted);
+}
+
+void block_profiler_set_enabled(int enabled)
+{
+   if (enabled == g_block_profiler_enabled)
+      return;
+
+   if (enabled)
+      reset_table();
+   else
+      block_profiler_report();
+
+   g_block_profiler_enabled = enabled;
+}
+
+#endif /* PROFILE_BLOCKS */
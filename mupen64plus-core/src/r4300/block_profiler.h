@@ -0,0 +1,46 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - block_profiler.h                                        *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_R4300_BLOCK_PROFILER_H
+#define M64P_R4300_BLOCK_PROFILER_H
+
+#include <stdint.h>
+
+/* Guest basic block profiler.
+ *
+ * Every time control flow enters a new guest block (taken or not-taken
+ * branch, jump, dynarec dispatch) the cycles and host time spent since the
+ * previous transition are attributed to the block that was running.
+ * Compiled in with PROFILE_BLOCKS, toggled at runtime. */
+#if defined(PROFILE_BLOCKS)
+extern int g_block_profiler_enabled;
+
+void block_profiler_enter(uint32_t pc);
+void block_profiler_enter_last_addr(void);
+void block_profiler_set_enabled(int enabled);
+void block_profiler_report(void);
+
+#define BLOCK_PROFILER_ENTER(pc) \
+   do { if (g_block_profiler_enabled) block_profiler_enter(pc); } while (0)
+#else
+#define BLOCK_PROFILER_ENTER(pc) do { } while (0)
+#endif /* PROFILE_BLOCKS */
+
+#endif /* M64P_R4300_BLOCK_PROFILER_H */
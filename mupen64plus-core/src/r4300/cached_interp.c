@@ -30,6 +30,7 @@
 #include "api/debugger.h"
 #include "api/m64p_types.h"
 #include "cached_interp.h"
+#include "block_profiler.h"
 #include "cp0_private.h"
 #include "cp1_private.h"
 #include "exception.h"
@@ -52,6 +53,7 @@ char invalid_code[0x100000];
 precomp_block *blocks[0x100000];
 precomp_block *actual;
 uint32_t jump_to_address;
+struct smc_stats smc_stats;
 
 // -----------------------------------------------------------
 // Cached interpreter functions (and fallback for dynarec).
@@ -95,6 +97,7 @@ uint32_t jump_to_address;
          PC += 2; \
          cp0_update_count(); \
       } \
+      BLOCK_PROFILER_ENTER(PC->addr); \
       last_addr = PC->addr; \
       if (next_interupt <= g_cp0_regs[CP0_COUNT_REG]) gen_interupt(); \
    } \
@@ -126,6 +129,7 @@ uint32_t jump_to_address;
          PC += 2; \
          cp0_update_count(); \
       } \
+      BLOCK_PROFILER_ENTER(PC->addr); \
       last_addr = PC->addr; \
       if (next_interupt <= g_cp0_regs[CP0_COUNT_REG]) gen_interupt(); \
    } \
@@ -146,9 +150,7 @@ uint32_t jump_to_address;
 
 #define CHECK_MEMORY() \
    if (!invalid_code[address>>12]) \
-      if (blocks[address>>12]->block[(address&0xFFF)/4].ops != \
-          current_instruction_table.NOTCOMPILED) \
-         invalid_code[address>>12] = 1;
+      invalidate_code_word(address);
 
 // two functions are defined from the macros above but never used
 // these prototype declarations will prevent a warning
@@ -203,13 +205,24 @@ static void FIN_BLOCK(void)
 
 static void NOTCOMPILED(void)
 {
-   uint32_t *mem = fast_mem_access(blocks[PC->addr>>12]->start);
+   precomp_block *block = blocks[PC->addr>>12];
+   uint32_t *mem = fast_mem_access(block->start);
 #ifdef CORE_DBG
    DebugMessage(M64MSG_INFO, "NOTCOMPILED: addr = %x ops = %lx", PC->addr, (long) PC->ops);
 #endif
 
+   /* The dynarec only appends to the code of a block. Once most of it was
+    * dropped by self-modifying code, start the block over instead of
+    * growing it, dyna_jump() doesn't return into the old code. */
+   if (r4300emu == CORE_DYNAREC && block->words_dropped >= 0x1000/4
+         && block->words_dropped > block->words_compiled / 2)
+   {
+      init_block(block);
+      smc_stats.pages_compacted++;
+   }
+
    if (mem != NULL)
-      recompile_block(mem, blocks[PC->addr >> 12], PC->addr);
+      recompile_block(mem, block, PC->addr);
    else
       DebugMessage(M64MSG_ERROR, "not compiled exception");
 
@@ -578,6 +591,12 @@ void init_blocks(void)
 void free_blocks(void)
 {
    int i;
+
+   if (smc_stats.ranges_invalidated || smc_stats.pages_invalidated)
+      DebugMessage(M64MSG_VERBOSE, "SMC: %u ranges and %u pages invalidated, %u pages started over, %" PRIu64 " KB of code compiled",
+            smc_stats.ranges_invalidated, smc_stats.pages_invalidated,
+            smc_stats.pages_compacted, smc_stats.bytes_recompiled / 1024);
+   memset(&smc_stats, 0, sizeof(smc_stats));
    for (i=0; i<0x100000; i++)
    {
       if (blocks[i])
@@ -589,9 +608,69 @@ void free_blocks(void)
    }
 }
 
+static int is_code_word(uint32_t address)
+{
+   const precomp_block *block = blocks[address>>12];
+   unsigned int word = (address & 0xFFF) / 4;
+
+   return (block->code_map[word / 32] >> (word & 31)) & 1;
+}
+
+static void invalidate_code_at(uint32_t address)
+{
+   precomp_block *block = blocks[address>>12];
+   unsigned int word = (address & 0xFFF) / 4;
+
+   /* TLB mapped code is looked up through the physical pages, keep
+    * invalidating it by page */
+   if (block->aliased || block->start < 0x80000000 || block->start >= 0xc0000000)
+   {
+      invalid_code[address>>12] = 1;
+      smc_stats.pages_invalidated++;
+   }
+   else if (block->range_start[word] == NO_RANGE)
+   {
+      /* only compiled in the mirror, which the caller drops next */
+      if (block->block[word].ops == current_instruction_table.NOTCOMPILED2)
+         block->block[word].ops = current_instruction_table.NOTCOMPILED;
+      block->code_map[word / 32] &= ~(UINT32_C(1) << (word & 31));
+   }
+   else
+   {
+      invalidate_block_range(block, word);
+      smc_stats.ranges_invalidated++;
+   }
+}
+
+/* Invalidates the code compiled from the word at 'address', if any: the
+ * range holding it for kseg0 and kseg1, in both segments, the whole page
+ * otherwise. Stores to data sharing a page with code leave the code alone. */
+void invalidate_code_word(uint32_t address)
+{
+   uint32_t mirror;
+
+   if (invalid_code[address>>12])
+      return;
+   if (!blocks[address>>12])
+   {
+      invalid_code[address>>12] = 1;
+      return;
+   }
+   if (!is_code_word(address))
+      return;
+
+   invalidate_code_at(address);
+
+   /* the same word compiled through the other unmapped segment */
+   if (address < 0x80000000 || address >= 0xc0000000)
+      return;
+   mirror = address ^ 0x20000000;
+   if (!invalid_code[mirror>>12] && blocks[mirror>>12] && is_code_word(mirror))
+      invalidate_code_at(mirror);
+}
+
 void invalidate_cached_code_hacktarux(uint32_t address, size_t size)
 {
-   size_t i;
    uint32_t addr;
    uint32_t addr_max;
 
@@ -602,31 +681,26 @@ void invalidate_cached_code_hacktarux(uint32_t address, size_t size)
    }
    else
    {
-      /* invalidate blocks (if necessary) */
+      /* invalidate the ranges holding code words (if any) */
       addr_max = address+size;
 
-      for(addr = address; addr < addr_max; addr += 4)
+      for(addr = address & ~UINT32_C(3); addr < addr_max; addr += 4)
       {
-         i = (addr >> 12);
+         precomp_block *block = blocks[addr >> 12];
 
-         if (invalid_code[i] == 0)
+         if (invalid_code[addr >> 12])
          {
-            if (blocks[i] == NULL
-                  || blocks[i]->block[(addr & 0xfff) / 4].ops != current_instruction_table.NOTCOMPILED)
-            {
-               invalid_code[i] = 1;
-               /* go directly to next i */
-               addr &= ~0xfff;
-               addr |= 0xffc;
-            }
+            /* go directly to next page */
+            addr |= 0xffc;
          }
-         else
+         else if (block != NULL
+               && block->code_map[(addr & 0xfff) / 128] == 0)
          {
-            /* go directly to next i */
-            addr &= ~0xfff;
-            addr |= 0xffc;
+            /* go directly to the next 32 words */
+            addr |= 0x7c;
          }
+         else
+            invalidate_code_word(addr);
       }
    }
 }
-
@@ -35,11 +35,23 @@ extern precomp_block *actual;
 extern uint32_t jump_to_address;
 extern const cpu_instruction_table cached_interpreter_table;
 
+/* Self-modifying code counters, logged when the blocks are freed. */
+struct smc_stats
+{
+   unsigned int ranges_invalidated; /* compiled ranges dropped by a store */
+   unsigned int pages_invalidated;  /* whole pages dropped by a store */
+   unsigned int pages_compacted;    /* dynarec pages started over */
+   uint64_t bytes_recompiled;       /* r4300 code compiled, in bytes */
+};
+
+extern struct smc_stats smc_stats;
+
 void init_blocks(void);
 void free_blocks(void);
 void jump_to_func(void);
 
 void invalidate_cached_code_hacktarux(uint32_t address, size_t size);
+void invalidate_code_word(uint32_t address);
 
 /* Jumps to the given address. This is for the cached interpreter / dynarec. */
 #define jump_to(a) { jump_to_address = a; jump_to_func(); }
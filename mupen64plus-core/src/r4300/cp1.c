@@ -44,6 +44,10 @@ int64_t reg_cop1_fgr_64[32];
  * using 32-bit stores. */
 uint32_t rounding_mode = UINT32_C(0x33F);
 
+/* The FCR31 rounding mode the host FPU was last set to by set_rounding(),
+ * or ~0 when it may have been changed outside of the core. */
+uint32_t host_rounding_mode = ~UINT32_C(0);
+
 
 int64_t* r4300_cp1_regs(void)
 {
@@ -191,3 +195,10 @@ void update_x86_rounding_mode(uint32_t FCR31)
          break;
    }
 }
+
+/* The frontend shares the host FPU with the core, set the rounding mode
+ * again before the next operation that depends on it. */
+void invalidate_host_rounding_mode(void)
+{
+   host_rounding_mode = ~UINT32_C(0);
+}
@@ -35,6 +35,7 @@ void shuffle_fpr_data(uint32_t oldStatus, uint32_t newStatus);
 void set_fpr_pointers(uint32_t newStatus);
 
 void update_x86_rounding_mode(uint32_t FCR31);
+void invalidate_host_rounding_mode(void);
 
 #endif /* M64P_R4300_CP1_H */
 
@@ -31,6 +31,7 @@ extern double *reg_cop1_double[32];
 extern uint32_t FCR0, FCR31;
 extern int64_t reg_cop1_fgr_64[32];
 extern uint32_t rounding_mode;
+extern uint32_t host_rounding_mode;
 
 #endif /* M64P_R4300_CP1_PRIVATE_H */
 
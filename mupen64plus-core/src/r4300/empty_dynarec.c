@@ -21,6 +21,7 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "recomp.h"
+#include "hacktarux_dynarec/codecache.h"
 
 /* From assemble.c */
 
@@ -1042,3 +1043,26 @@ void dyna_stop()
 {
 }
 
+
+/* From codecache.c */
+
+const struct codecache_record *codecache_find(const precomp_block *block,
+      unsigned int first, const uint32_t *source)
+{
+   return NULL;
+}
+
+int codecache_apply(const struct codecache_record *record, precomp_block *block,
+      unsigned int end)
+{
+   return 0;
+}
+
+void codecache_record_begin(precomp_block *block, unsigned int first)
+{
+}
+
+void codecache_record_end(precomp_block *block, unsigned int end,
+      const uint32_t *source, unsigned int src_words)
+{
+}
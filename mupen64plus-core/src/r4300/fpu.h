@@ -55,11 +55,21 @@
 #endif
 #endif
 
+#if defined(__SSE4_1__)
+  #include <smmintrin.h>
+#endif
+
 #define FCR31_CMP_BIT UINT32_C(0x800000)
 
 
+/* Setting the host rounding mode serializes the host FPU, so it is only
+ * set when FCR31 asks for another mode than the one last set. */
 M64P_FPU_INLINE void set_rounding(void)
 {
+   if ((FCR31 & 3) == host_rounding_mode)
+      return;
+   host_rounding_mode = FCR31 & 3;
+
    /* TODO skogaby: fix this for real */
 #ifndef VITA
    switch(FCR31 & 3)
@@ -109,70 +119,131 @@ M64P_FPU_INLINE void cvt_s_d(const double *source,float *dest)
   *dest = (float) *source;
 }
 
+/* The conversions with an explicit rounding mode do not depend on the host
+ * one. ROUNDSS/ROUNDSD take the mode from the instruction; elsewhere the
+ * compiler inlines libm's or calls it. */
+#if defined(__SSE4_1__)
+M64P_FPU_INLINE float fpu_truncf(float x)
+{
+  return _mm_cvtss_f32(_mm_round_ss(_mm_setzero_ps(), _mm_set_ss(x),
+        _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+}
+M64P_FPU_INLINE float fpu_ceilf(float x)
+{
+  return _mm_cvtss_f32(_mm_round_ss(_mm_setzero_ps(), _mm_set_ss(x),
+        _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+}
+M64P_FPU_INLINE float fpu_floorf(float x)
+{
+  return _mm_cvtss_f32(_mm_round_ss(_mm_setzero_ps(), _mm_set_ss(x),
+        _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+}
+M64P_FPU_INLINE double fpu_trunc(double x)
+{
+  return _mm_cvtsd_f64(_mm_round_sd(_mm_setzero_pd(), _mm_set_sd(x),
+        _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+}
+M64P_FPU_INLINE double fpu_ceil(double x)
+{
+  return _mm_cvtsd_f64(_mm_round_sd(_mm_setzero_pd(), _mm_set_sd(x),
+        _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+}
+M64P_FPU_INLINE double fpu_floor(double x)
+{
+  return _mm_cvtsd_f64(_mm_round_sd(_mm_setzero_pd(), _mm_set_sd(x),
+        _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+}
+/* Halfway cases away from zero, as round(). x - trunc(x) is exact, and so
+ * is the step to the next integer as x has no fraction past 2^23 (2^52). */
+M64P_FPU_INLINE float fpu_roundf(float x)
+{
+  float t = fpu_truncf(x);
+  if (fabsf(x - t) >= 0.5f)
+    t += x < 0 ? -1.0f : 1.0f;
+  return t;
+}
+M64P_FPU_INLINE double fpu_round(double x)
+{
+  double t = fpu_trunc(x);
+  if (fabs(x - t) >= 0.5)
+    t += x < 0 ? -1.0 : 1.0;
+  return t;
+}
+#else
+#define fpu_truncf truncf
+#define fpu_ceilf  ceilf
+#define fpu_floorf floorf
+#define fpu_roundf roundf
+#define fpu_trunc  trunc
+#define fpu_ceil   ceil
+#define fpu_floor  floor
+#define fpu_round  round
+#endif
+
 M64P_FPU_INLINE void round_l_s(const float *source,int64_t *dest)
 {
-  *dest = (int64_t) roundf(*source);
+  *dest = (int64_t) fpu_roundf(*source);
 }
 M64P_FPU_INLINE void round_w_s(const float *source,int32_t *dest)
 {
-  *dest = (int32_t) roundf(*source);
+  *dest = (int32_t) fpu_roundf(*source);
 }
 M64P_FPU_INLINE void trunc_l_s(const float *source,int64_t *dest)
 {
-  *dest = (int64_t) truncf(*source);
+  *dest = (int64_t) fpu_truncf(*source);
 }
 M64P_FPU_INLINE void trunc_w_s(const float *source,int32_t *dest)
 {
-  *dest = (int32_t) truncf(*source);
+  *dest = (int32_t) fpu_truncf(*source);
 }
 M64P_FPU_INLINE void ceil_l_s(const float *source,int64_t *dest)
 {
-  *dest = (int64_t) ceilf(*source);
+  *dest = (int64_t) fpu_ceilf(*source);
 }
 M64P_FPU_INLINE void ceil_w_s(const float *source,int32_t *dest)
 {
-  *dest = (int32_t) ceilf(*source);
+  *dest = (int32_t) fpu_ceilf(*source);
 }
 M64P_FPU_INLINE void floor_l_s(const float *source,int64_t *dest)
 {
-  *dest = (int64_t) floorf(*source);
+  *dest = (int64_t) fpu_floorf(*source);
 }
 M64P_FPU_INLINE void floor_w_s(const float *source,int32_t *dest)
 {
-  *dest = (int32_t) floorf(*source);
+  *dest = (int32_t) fpu_floorf(*source);
 }
 
 M64P_FPU_INLINE void round_l_d(const double *source,int64_t *dest)
 {
-  *dest = (int64_t) round(*source);
+  *dest = (int64_t) fpu_round(*source);
 }
 M64P_FPU_INLINE void round_w_d(const double *source,int32_t *dest)
 {
-  *dest = (int32_t) round(*source);
+  *dest = (int32_t) fpu_round(*source);
 }
 M64P_FPU_INLINE void trunc_l_d(const double *source,int64_t *dest)
 {
-  *dest = (int64_t) trunc(*source);
+  *dest = (int64_t) fpu_trunc(*source);
 }
 M64P_FPU_INLINE void trunc_w_d(const double *source,int32_t *dest)
 {
-  *dest = (int32_t) trunc(*source);
+  *dest = (int32_t) fpu_trunc(*source);
 }
 M64P_FPU_INLINE void ceil_l_d(const double *source,int64_t *dest)
 {
-  *dest = (int64_t) ceil(*source);
+  *dest = (int64_t) fpu_ceil(*source);
 }
 M64P_FPU_INLINE void ceil_w_d(const double *source,int32_t *dest)
 {
-  *dest = (int32_t) ceil(*source);
+  *dest = (int32_t) fpu_ceil(*source);
 }
 M64P_FPU_INLINE void floor_l_d(const double *source,int64_t *dest)
 {
-  *dest = (int64_t) floor(*source);
+  *dest = (int64_t) fpu_floor(*source);
 }
 M64P_FPU_INLINE void floor_w_d(const double *source,int32_t *dest)
 {
-  *dest = (int32_t) floor(*source);
+  *dest = (int32_t) fpu_floor(*source);
 }
 
 M64P_FPU_INLINE void cvt_w_s(const float *source,int32_t *dest)
@@ -114,6 +114,8 @@ void free_assembler(void **block_jumps_table, int *block_jumps_number, void **bl
 
 void add_jump(unsigned int pc_addr, unsigned int mi_addr, unsigned int absolute64)
 {
+   codecache_note_jump(pc_addr, mi_addr, absolute64);
+
    if (jumps_number == max_jumps_number)
    {
       jump_table *new_ptr = NULL;
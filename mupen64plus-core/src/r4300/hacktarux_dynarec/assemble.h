@@ -24,6 +24,7 @@
 #define __ASSEMBLE_H__
 
 #include "r4300/recomph.h"
+#include "codecache.h"
 #include "api/callbacks.h"
 #include "osal/preproc.h"
 
@@ -124,6 +125,8 @@ static INLINE int rel_r15_offset(void *dest, const char *op_name)
    /* calculate the destination pointer's offset from the base of the r4300 registers */
    int64_t rel_offset = (int64_t) ((uint8_t *) dest - (uint8_t *) reg);
 
+   codecache_note_rel(dest);
+
    if (llabs(rel_offset) > 0x7fffffff)
    {
       DebugMessage(M64MSG_ERROR, "Error: destination %p more than 2GB away from r15 base %p in %s()", dest, reg, op_name);
@@ -321,6 +324,7 @@ static INLINE void mov_rax_memoffs64(uint64_t *memoffs64)
 {
    put8(0x48);
    put8(0xA1);
+   codecache_note_abs64(code_length, (uint64_t) memoffs64);
    put64((uint64_t) memoffs64);
 }
 
@@ -328,6 +332,7 @@ static INLINE void mov_memoffs64_rax(uint64_t *memoffs64)
 {
    put8(0x48);
    put8(0xA3);
+   codecache_note_abs64(code_length, (uint64_t) memoffs64);
    put64((uint64_t) memoffs64);
 }
 
@@ -676,6 +681,7 @@ static INLINE void mov_memoffs32_eax(unsigned int *memoffs32)
 {
    put8(0xA3);
 #ifdef __x86_64__
+   codecache_note_abs64(code_length, (uint64_t) memoffs32);
    put64((uint64_t) memoffs32);
 #else
    put32((unsigned int)(memoffs32));
@@ -839,6 +845,13 @@ static INLINE void je_near_rj(unsigned int saut)
    put32(saut);
 }
 
+static INLINE void ja_near_rj(unsigned int saut)
+{
+   put8(0x0F);
+   put8(0x87);
+   put32(saut);
+}
+
 static INLINE void mov_reg32_imm32(int reg32, unsigned int imm32)
 {
    put8(0xB8+reg32);
@@ -849,6 +862,7 @@ static INLINE void mov_reg64_imm64(int reg64, uint64_t imm64)
 {
    put8(0x48);
    put8(0xB8+reg64);
+   codecache_note_abs64(code_length, imm64);
    put64(imm64);
 }
 
@@ -0,0 +1,773 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - codecache.c                                             *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <retro_miscellaneous.h>
+
+#include "codecache.h"
+#include "assemble.h"
+
+#include "api/callbacks.h"
+#include "api/m64p_config.h"
+#include "api/m64p_types.h"
+#include "main/main.h"
+#include "memory/memory.h"
+#include "r4300/block_profiler.h"
+#include "r4300/cached_interp.h"
+#include "r4300/cp0_private.h"
+#include "r4300/cp1_private.h"
+#include "r4300/exception.h"
+#include "r4300/interupt.h"
+#include "r4300/r4300.h"
+#include "r4300/recomp.h"
+#include "r4300/recomph.h"
+
+/* File layout: magic, version, environment hash, then the records as they
+ * are kept in memory (header and payload), and a trailing FNV-1a hash of
+ * everything before it. The environment hash covers the distance from reg
+ * to code and data the generated code refers to, so a file written by
+ * another build of the core is ignored. Bump CODECACHE_VERSION when the
+ * code generators change. */
+#define CODECACHE_MAGIC     0x43443436 /* "64DC" */
+#define CODECACHE_VERSION   3
+#define CODECACHE_MAX_BYTES (32*1024*1024)
+#define CODECACHE_HASH_BITS 12
+#define FNV_BASIS           0x811C9DC5
+
+/* limits of a single record, past them the range isn't kept */
+#define MAX_RECORD_WORDS    (0x1000/4*2)
+#define MAX_RECORD_RELOCS   4096
+#define MAX_RECORD_JUMPS    1024
+#define MAX_RECORD_CODE     (1024*1024)
+
+/* what a 64-bit absolute operand points into */
+enum
+{
+   RELOC_IMAGE = 0,   /* one of image_ranges, relative to reg */
+   RELOC_INSTR,       /* the block's precomp_instr array */
+   RELOC_BLOCK        /* the precomp_block itself */
+};
+
+/* The payload follows the header, in 32-bit words:
+ *   words entries of local_addr (relative to the range's code), mask of
+ *     the needed registers, and their 8 offsets from reg,
+ *   relocs entries of code offset, kind, value,
+ *   jumps entries of code offset, mi_addr, absolute64,
+ *   src_words guest words the range was compiled from,
+ * then code_size bytes of code. */
+struct record_header
+{
+   uint32_t start;      /* with first, end and flags, the key */
+   uint32_t end;
+   uint32_t first;      /* first word compiled */
+   uint32_t words;      /* words set up, the FIN_BLOCK ones included */
+   uint32_t src_words;
+   uint32_t flags;      /* fast_memory, no_compiled_jump */
+   uint32_t code_size;
+   uint32_t relocs;
+   uint32_t jumps;
+   uint32_t reserved;
+};
+
+struct codecache_record
+{
+   struct codecache_record *next;
+   struct record_header h;
+};
+
+/* The core's code and data the generated code may point to, sorted by
+ * start. A function is one byte long, only its entry is expected. */
+struct image_range
+{
+   uintptr_t start;
+   uintptr_t size;
+};
+
+#define MAX_IMAGE_RANGES 512
+
+int codecache_enabled = 0;
+
+static int cache_open;
+static char cache_path[PATH_MAX_LENGTH];
+static struct codecache_record *cache_table[1 << CODECACHE_HASH_BITS];
+static size_t cache_bytes;
+static unsigned int cache_loaded, cache_added, cache_hits, cache_misses;
+static struct image_range image_ranges[MAX_IMAGE_RANGES];
+static unsigned int image_range_count;
+
+static struct
+{
+   int active;
+   int failed;
+   precomp_block *block;
+   unsigned int first;
+   unsigned int code_start;
+   unsigned int relocs;
+   unsigned int jumps;
+   uint32_t reloc[MAX_RECORD_RELOCS*3];
+   uint32_t jump[MAX_RECORD_JUMPS*3];
+} recording;
+
+static uint32_t cache_hash(uint32_t hash, const void *data, size_t size)
+{
+   const uint8_t *p = (const uint8_t*)data;
+
+   while (size--)
+      hash = (hash ^ *p++) * 0x01000193;
+   return hash;
+}
+
+static uint32_t cache_environment(void)
+{
+   const uintptr_t symbols[] = {
+      (uintptr_t)recompile_block, (uintptr_t)passe2, (uintptr_t)gencallinterp,
+      (uintptr_t)genlw, (uintptr_t)gensw, (uintptr_t)gendelayslot,
+      (uintptr_t)cached_interpreter_table.NOTCOMPILED,
+      (uintptr_t)g_rdram, (uintptr_t)blocks, (uintptr_t)invalid_code,
+      (uintptr_t)&PC, (uintptr_t)&count_per_op
+   };
+   const uint32_t sizes[] = {
+      sizeof(precomp_instr), sizeof(precomp_block), sizeof(struct record_header)
+   };
+   uint32_t hash = FNV_BASIS;
+   unsigned int i;
+
+   for (i = 0; i < sizeof(symbols) / sizeof(symbols[0]); i++)
+   {
+      int64_t offset = (int64_t)(symbols[i] - (uintptr_t)reg);
+      hash = cache_hash(hash, &offset, sizeof(offset));
+   }
+   return cache_hash(hash, sizes, sizeof(sizes));
+}
+
+static void add_image_range(const void *start, size_t size)
+{
+   if (image_range_count < MAX_IMAGE_RANGES)
+   {
+      image_ranges[image_range_count].start = (uintptr_t)start;
+      image_ranges[image_range_count].size  = size;
+      image_range_count++;
+   }
+}
+
+static int compare_image_ranges(const void *a, const void *b)
+{
+   uintptr_t x = ((const struct image_range*)a)->start;
+   uintptr_t y = ((const struct image_range*)b)->start;
+
+   return x < y ? -1 : x > y;
+}
+
+/* Everything the x86_64 generators pass to an absolute operand that isn't
+ * in the block: the handlers of cached_interpreter_table, which only holds
+ * function pointers, for gencallinterp(), and the rest by name. */
+static void init_image_ranges(void)
+{
+   void (*const *handlers)(void) = (void (*const *)(void))&cached_interpreter_table;
+   unsigned int i;
+
+   image_range_count = 0;
+
+   add_image_range(reg, sizeof(reg));
+   add_image_range(&hi, sizeof(hi));
+   add_image_range(&lo, sizeof(lo));
+   add_image_range(&local_rs, sizeof(local_rs));
+   add_image_range(&last_addr, sizeof(last_addr));
+   add_image_range(&FCR31, sizeof(FCR31));
+   add_image_range(&PC, sizeof(PC));
+   add_image_range(&fake_instr, sizeof(fake_instr));
+   add_image_range(g_rdram, sizeof(g_rdram));
+   add_image_range(blocks, sizeof(blocks));
+   add_image_range(invalid_code, sizeof(invalid_code));
+   add_image_range(readmem, sizeof(readmem));
+   add_image_range(readmemb, sizeof(readmemb));
+   add_image_range(readmemh, sizeof(readmemh));
+   add_image_range(readmemd, sizeof(readmemd));
+   add_image_range(writemem, sizeof(writemem));
+   add_image_range(writememb, sizeof(writememb));
+   add_image_range(writememh, sizeof(writememh));
+   add_image_range(writememd, sizeof(writememd));
+
+   add_image_range((const void*)read_rdram, 1);
+   add_image_range((const void*)read_rdramb, 1);
+   add_image_range((const void*)read_rdramh, 1);
+   add_image_range((const void*)read_rdramd, 1);
+   add_image_range((const void*)write_rdram, 1);
+   add_image_range((const void*)write_rdramb, 1);
+   add_image_range((const void*)write_rdramh, 1);
+   add_image_range((const void*)write_rdramd, 1);
+   add_image_range((const void*)gen_interupt, 1);
+   add_image_range((const void*)jump_to_func, 1);
+   add_image_range((const void*)dyna_jump, 1);
+   add_image_range((const void*)invalidate_code_at_address, 1);
+   add_image_range((const void*)check_cop1_unusable, 1);
+   add_image_range((const void*)exception_general, 1);
+#ifdef PROFILE_BLOCKS
+   add_image_range((const void*)block_profiler_enter_last_addr, 1);
+#endif
+
+   for (i = 0; i < sizeof(cached_interpreter_table) / sizeof(handlers[0]); i++)
+      add_image_range((const void*)handlers[i], 1);
+
+   qsort(image_ranges, image_range_count, sizeof(image_ranges[0]), compare_image_ranges);
+}
+
+static int in_image(uintptr_t value)
+{
+   unsigned int low = 0, high = image_range_count;
+
+   /* the last range starting at or before value */
+   while (low < high)
+   {
+      unsigned int mid = (low + high) / 2;
+
+      if (image_ranges[mid].start <= value)
+         low = mid + 1;
+      else
+         high = mid;
+   }
+   return low > 0 && value - image_ranges[low-1].start < image_ranges[low-1].size;
+}
+
+static unsigned int slot(uint32_t start, uint32_t first)
+{
+   return ((start + first*4) >> 2) * 2654435761u >> (32 - CODECACHE_HASH_BITS);
+}
+
+static uint32_t key_flags(void)
+{
+   return (fast_memory ? 1 : 0) | (no_compiled_jump ? 2 : 0);
+}
+
+/* only code in unmapped memory is always at the same address */
+static int cacheable(const precomp_block *block)
+{
+   return block->start >= UINT32_C(0x80000000) && block->start < UINT32_C(0xc0000000);
+}
+
+/* as init_block() allocates it */
+static size_t instr_count(const precomp_block *block)
+{
+   size_t length = (block->end - block->start) / 4;
+   return (length+1)+(length>>2);
+}
+
+static const uint32_t *payload(const struct codecache_record *record)
+{
+   return (const uint32_t*)(record + 1);
+}
+
+static size_t payload_size(const struct record_header *h)
+{
+   return 4 * ((size_t)h->words*10 + (size_t)h->relocs*3 + (size_t)h->jumps*3 + h->src_words)
+      + h->code_size;
+}
+
+/* the bounds a loaded record must fit in to be applied safely */
+static int record_valid(const struct codecache_record *record)
+{
+   const struct record_header *h = &record->h;
+   const uint32_t *info  = payload(record);
+   const uint32_t *reloc = info + h->words*10;
+   const uint32_t *jump  = reloc + h->relocs*3;
+   size_t count = (h->end - h->start) / 4;
+   unsigned int i;
+
+   if (h->start < UINT32_C(0x80000000) || h->start >= UINT32_C(0xc0000000) ||
+         h->end <= h->start || h->end - h->start > 0x1000)
+      return 0;
+   count = (count+1)+(count>>2);
+   if (h->words == 0 || h->first + h->words > count)
+      return 0;
+
+   for (i = 0; i < h->words; i++, info += 10)
+      if (info[0] > h->code_size)
+         return 0;
+   for (i = 0; i < h->relocs; i++, reloc += 3)
+      if (reloc[0] + 8 > h->code_size || reloc[1] > RELOC_BLOCK ||
+            (reloc[1] == RELOC_IMAGE && !in_image((uintptr_t)reg + (int32_t)reloc[2])) ||
+            (reloc[1] == RELOC_INSTR && reloc[2] > count * sizeof(precomp_instr)) ||
+            (reloc[1] == RELOC_BLOCK && reloc[2] >= sizeof(precomp_block)))
+         return 0;
+   for (i = 0; i < h->jumps; i++, jump += 3)
+      if (jump[0] + (jump[2] ? 8 : 4) > h->code_size ||
+            jump[1] < h->start || (jump[1] - h->start) / 4 >= count)
+         return 0;
+   return 1;
+}
+
+static void insert(struct codecache_record *record)
+{
+   unsigned int i = slot(record->h.start, record->h.first);
+
+   record->next   = cache_table[i];
+   cache_table[i] = record;
+   cache_bytes   += sizeof(record->h) + payload_size(&record->h);
+}
+
+static void cache_load(void)
+{
+   FILE *f;
+   long size;
+   uint32_t header[3], hash;
+   uint8_t *data = NULL;
+   const uint8_t *p, *end;
+
+   f = fopen(cache_path, "rb");
+   if (!f)
+      return;
+
+   fseek(f, 0, SEEK_END);
+   size = ftell(f);
+   fseek(f, 0, SEEK_SET);
+
+   if (size > (long)(sizeof(header) + sizeof(hash)) && size <= CODECACHE_MAX_BYTES * 2)
+   {
+      data = (uint8_t*)malloc(size);
+      if (data && fread(data, 1, size, f) != (size_t)size)
+      {
+         free(data);
+         data = NULL;
+      }
+   }
+   fclose(f);
+
+   if (!data)
+      return;
+
+   p   = data;
+   end = data + size - sizeof(hash);
+   memcpy(&hash, end, sizeof(hash));
+
+   if (hash != cache_hash(FNV_BASIS, data, end - data))
+   {
+      DebugMessage(M64MSG_WARNING, "Code cache %s is damaged, ignoring it.", cache_path);
+      goto done;
+   }
+
+   memcpy(header, p, sizeof(header));
+   p += sizeof(header);
+   if (header[0] != CODECACHE_MAGIC || header[1] != CODECACHE_VERSION ||
+         header[2] != cache_environment())
+   {
+      DebugMessage(M64MSG_INFO, "Code cache %s is out of date, ignoring it.", cache_path);
+      goto done;
+   }
+
+   while ((size_t)(end - p) >= sizeof(struct record_header))
+   {
+      struct record_header h;
+      struct codecache_record *record;
+      size_t length;
+
+      memcpy(&h, p, sizeof(h));
+      p += sizeof(h);
+
+      if (h.words > MAX_RECORD_WORDS || h.src_words > MAX_RECORD_WORDS ||
+            h.relocs > MAX_RECORD_RELOCS || h.jumps > MAX_RECORD_JUMPS ||
+            h.code_size > MAX_RECORD_CODE)
+         break;
+      length = payload_size(&h);
+      if ((size_t)(end - p) < length ||
+            cache_bytes + sizeof(h) + length > CODECACHE_MAX_BYTES)
+         break;
+
+      record = (struct codecache_record*)malloc(sizeof(*record) + length);
+      if (!record)
+         break;
+      record->h = h;
+      memcpy(record + 1, p, length);
+      p += length;
+
+      if (!record_valid(record))
+      {
+         free(record);
+         continue;
+      }
+      insert(record);
+      cache_loaded++;
+   }
+
+   DebugMessage(M64MSG_INFO, "Loaded %u code ranges from %s.", cache_loaded, cache_path);
+
+done:
+   free(data);
+}
+
+static int cache_write(FILE *f, uint32_t *hash, const void *src, size_t size)
+{
+   *hash = cache_hash(*hash, src, size);
+   return fwrite(src, 1, size, f) == size;
+}
+
+static void cache_save(void)
+{
+   FILE *f;
+   char tmp_path[PATH_MAX_LENGTH + 4];
+   uint32_t header[3];
+   uint32_t hash = FNV_BASIS;
+   unsigned int i, written = 0;
+   int ok;
+
+   snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", cache_path);
+   f = fopen(tmp_path, "wb");
+   if (!f)
+      return;
+
+   header[0] = CODECACHE_MAGIC;
+   header[1] = CODECACHE_VERSION;
+   header[2] = cache_environment();
+   ok = cache_write(f, &hash, header, sizeof(header));
+
+   for (i = 0; i < (1 << CODECACHE_HASH_BITS) && ok; i++)
+   {
+      const struct codecache_record *record;
+
+      for (record = cache_table[i]; record && ok; record = record->next)
+      {
+         ok = cache_write(f, &hash, &record->h, sizeof(record->h)) &&
+            cache_write(f, &hash, record + 1, payload_size(&record->h));
+         written++;
+      }
+   }
+
+   if (ok)
+      ok = fwrite(&hash, 1, sizeof(hash), f) == sizeof(hash);
+   if (fclose(f) != 0)
+      ok = 0;
+
+   if (!ok)
+      remove(tmp_path);
+   else
+   {
+      remove(cache_path);
+      if (rename(tmp_path, cache_path) == 0)
+         DebugMessage(M64MSG_INFO, "Saved %u code ranges to %s.", written, cache_path);
+   }
+}
+
+void codecache_open(const char *rom_md5)
+{
+   const char *dir;
+
+   codecache_close();
+
+#ifdef __x86_64__
+   if (!codecache_enabled || !rom_md5 || !rom_md5[0])
+      return;
+
+   dir = ConfigGetUserCachePath();
+   if (!dir)
+      return;
+
+   snprintf(cache_path, sizeof(cache_path), "%s/mupen64plus_%s.dynacache", dir, rom_md5);
+   cache_open   = 1;
+   cache_bytes  = 0;
+   cache_loaded = cache_added = cache_hits = cache_misses = 0;
+   init_image_ranges();
+   cache_load();
+#else
+   (void)dir;
+   (void)rom_md5;
+#endif
+}
+
+void codecache_close(void)
+{
+   struct codecache_record *record, *next;
+   unsigned int i;
+
+   if (!cache_open)
+      return;
+
+   DebugMessage(M64MSG_INFO, "Code cache: %u ranges reused, %u compiled, %u new.",
+         cache_hits, cache_misses, cache_added);
+
+   if (cache_added)
+      cache_save();
+
+   for (i = 0; i < (1 << CODECACHE_HASH_BITS); i++)
+   {
+      for (record = cache_table[i]; record; record = next)
+      {
+         next = record->next;
+         free(record);
+      }
+      cache_table[i] = NULL;
+   }
+
+   cache_open       = 0;
+   recording.active = 0;
+}
+
+const struct codecache_record *codecache_find(const precomp_block *block,
+      unsigned int first, const uint32_t *source)
+{
+   const struct codecache_record *record;
+   uint32_t flags;
+
+   if (!cache_open || !cacheable(block))
+      return NULL;
+
+   flags = key_flags();
+   for (record = cache_table[slot(block->start, first)]; record; record = record->next)
+   {
+      const struct record_header *h = &record->h;
+
+      if (h->start == block->start && h->end == block->end && h->first == first &&
+            h->flags == flags &&
+            !memcmp(payload(record) + h->words*10 + h->relocs*3 + h->jumps*3,
+               source + first, h->src_words*4))
+         return record;
+   }
+
+   cache_misses++;
+   return NULL;
+}
+
+int codecache_apply(const struct codecache_record *record, precomp_block *block,
+      unsigned int end)
+{
+   const struct record_header *h = &record->h;
+   const uint32_t *info  = payload(record);
+   const uint32_t *reloc = info + h->words*10;
+   const uint32_t *jump  = reloc + h->relocs*3;
+   const uint8_t *code   = (const uint8_t*)(jump + h->jumps*3 + h->src_words);
+   unsigned int code_start = code_length;
+   unsigned int i, r;
+
+   if (end != h->first + h->words)
+      return 0;
+
+   if (code_length + h->code_size >= (unsigned int)max_code_length)
+   {
+      int new_length = ((code_length + h->code_size) / 8192 + 1) * 8192;
+      *inst_pointer = (unsigned char*)realloc_exec(*inst_pointer, max_code_length, new_length);
+      max_code_length = new_length;
+   }
+
+   memcpy(*inst_pointer + code_start, code, h->code_size);
+   code_length += h->code_size;
+
+   for (i = 0; i < h->relocs; i++, reloc += 3)
+   {
+      uint64_t value = (int32_t)reloc[2];
+
+      if (reloc[1] == RELOC_IMAGE)
+         value += (uint64_t)(uintptr_t)reg;
+      else if (reloc[1] == RELOC_INSTR)
+         value += (uint64_t)(uintptr_t)block->block;
+      else
+         value += (uint64_t)(uintptr_t)block;
+      memcpy(*inst_pointer + code_start + reloc[0], &value, sizeof(value));
+   }
+
+   for (i = 0; i < h->words; i++, info += 10)
+   {
+      precomp_instr *instr = block->block + h->first + i;
+
+      instr->local_addr = code_start + info[0];
+      for (r = 0; r < 8; r++)
+         instr->reg_cache_infos.needed_registers[r] = (info[1] & (1 << r)) ?
+            (void*)((char*)reg + (int32_t)info[2+r]) : NULL;
+   }
+
+   for (i = 0; i < h->jumps; i++, jump += 3)
+      add_jump(code_start + jump[0], jump[1], jump[2]);
+
+   cache_hits++;
+   return 1;
+}
+
+void codecache_record_begin(precomp_block *block, unsigned int first)
+{
+   recording.active = cache_open && cacheable(block) &&
+      cache_bytes < CODECACHE_MAX_BYTES;
+   recording.failed     = 0;
+   recording.block      = block;
+   recording.first      = first;
+   recording.code_start = code_length;
+   recording.relocs     = 0;
+   recording.jumps      = 0;
+}
+
+void codecache_record_end(precomp_block *block, unsigned int end,
+      const uint32_t *source, unsigned int src_words)
+{
+   struct record_header h;
+   struct codecache_record *record;
+   uint32_t *info, *p;
+   unsigned int i, r;
+   size_t length;
+
+   if (!recording.active)
+      return;
+   recording.active = 0;
+
+   if (recording.failed || block != recording.block || end <= recording.first ||
+         end - recording.first > MAX_RECORD_WORDS || src_words > MAX_RECORD_WORDS ||
+         code_length - recording.code_start > MAX_RECORD_CODE)
+      return;
+
+   h.start     = block->start;
+   h.end       = block->end;
+   h.first     = recording.first;
+   h.words     = end - recording.first;
+   h.src_words = src_words;
+   h.flags     = key_flags();
+   h.code_size = code_length - recording.code_start;
+   h.relocs    = recording.relocs;
+   h.jumps     = recording.jumps;
+   h.reserved  = 0;
+
+   length = payload_size(&h);
+   if (cache_bytes + sizeof(h) + length > CODECACHE_MAX_BYTES)
+      return;
+
+   record = (struct codecache_record*)malloc(sizeof(*record) + length);
+   if (!record)
+      return;
+   record->h = h;
+   info = (uint32_t*)(record + 1);
+
+   for (i = 0; i < h.words; i++, info += 10)
+   {
+      const precomp_instr *instr = block->block + h.first + i;
+
+      if (instr->local_addr < recording.code_start || instr->local_addr > (unsigned int)code_length)
+      {
+         free(record);
+         return;
+      }
+      info[0] = instr->local_addr - recording.code_start;
+      info[1] = 0;
+      for (r = 0; r < 8; r++)
+      {
+         int64_t offset = (char*)instr->reg_cache_infos.needed_registers[r] - (char*)reg;
+
+         info[2+r] = 0;
+         if (!instr->reg_cache_infos.needed_registers[r])
+            continue;
+         if (offset > 0x7fffffff || offset < -0x7fffffff)
+         {
+            free(record);
+            return;
+         }
+         info[1]  |= 1 << r;
+         info[2+r] = (uint32_t)(int32_t)offset;
+      }
+   }
+
+   p = info;
+   memcpy(p, recording.reloc, h.relocs*3*4);
+   p += h.relocs*3;
+   memcpy(p, recording.jump, h.jumps*3*4);
+   p += h.jumps*3;
+   memcpy(p, source + h.first, h.src_words*4);
+   p += h.src_words;
+   memcpy(p, block->code + recording.code_start, h.code_size);
+
+   insert(record);
+   cache_added++;
+}
+
+void codecache_note_abs64(unsigned int pc_addr, uint64_t value)
+{
+   const char *v, *instr, *blk;
+   uint32_t kind;
+   int64_t offset;
+
+   if (!recording.active || recording.failed)
+      return;
+
+   v     = (const char*)(uintptr_t)value;
+   instr = (const char*)recording.block->block;
+   blk   = (const char*)recording.block;
+
+   if (v >= instr && v <= instr + instr_count(recording.block) * sizeof(precomp_instr))
+   {
+      kind   = RELOC_INSTR;
+      offset = v - instr;
+   }
+   else if (v >= blk && v < blk + sizeof(precomp_block))
+   {
+      kind   = RELOC_BLOCK;
+      offset = v - blk;
+   }
+   else
+   {
+      /* anything else, a heap pointer say, won't be at the same distance
+       * from reg in another process */
+      kind   = RELOC_IMAGE;
+      offset = v - (const char*)reg;
+      if (!in_image((uintptr_t)value) || offset > 0x7fffffff || offset < -0x7fffffff)
+      {
+         recording.failed = 1;
+         return;
+      }
+   }
+
+   if (recording.relocs == MAX_RECORD_RELOCS)
+   {
+      recording.failed = 1;
+      return;
+   }
+   recording.reloc[recording.relocs*3+0] = pc_addr - recording.code_start;
+   recording.reloc[recording.relocs*3+1] = kind;
+   recording.reloc[recording.relocs*3+2] = (uint32_t)(int32_t)offset;
+   recording.relocs++;
+}
+
+/* r15 relative accesses are position independent as long as they don't
+ * reach into the block */
+void codecache_note_rel(const void *dest)
+{
+   const char *d = (const char*)dest;
+   const char *instr, *blk;
+
+   if (!recording.active || recording.failed)
+      return;
+
+   instr = (const char*)recording.block->block;
+   blk   = (const char*)recording.block;
+   if ((d >= instr && d <= instr + instr_count(recording.block) * sizeof(precomp_instr)) ||
+         (d >= blk && d < blk + sizeof(precomp_block)))
+      recording.failed = 1;
+}
+
+void codecache_note_jump(unsigned int pc_addr, unsigned int mi_addr, unsigned int absolute64)
+{
+   if (!recording.active || recording.failed)
+      return;
+
+   if (recording.jumps == MAX_RECORD_JUMPS)
+   {
+      recording.failed = 1;
+      return;
+   }
+   recording.jump[recording.jumps*3+0] = pc_addr - recording.code_start;
+   recording.jump[recording.jumps*3+1] = mi_addr;
+   recording.jump[recording.jumps*3+2] = absolute64;
+   recording.jumps++;
+}
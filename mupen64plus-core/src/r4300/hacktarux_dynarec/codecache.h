@@ -0,0 +1,62 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - codecache.h                                             *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __CODECACHE_H__
+#define __CODECACHE_H__
+
+#include <stdint.h>
+
+/* Persistent code cache (x86_64 only).
+ *
+ * The code recompile_block() generates for a range of an unmapped block is
+ * kept, with the guest words it was compiled from, and written to the user
+ * cache folder, one file per ROM, when the emulation stops. When the same
+ * words are compiled again, in this run or a later one, the range is only
+ * decoded and its code copied back and relocated instead of being
+ * generated.
+ *
+ * The assembler reports the 64-bit absolute operands and the jumps it emits
+ * while a range is recorded. An operand may point into the block's
+ * precomp_instr array or precomp_block, or to one of the functions and
+ * data objects of the core the generators are known to use; a range with
+ * any other operand isn't kept. */
+
+struct _precomp_block;
+struct codecache_record;
+
+extern int codecache_enabled;
+
+void codecache_open(const char *rom_md5);
+void codecache_close(void);
+
+const struct codecache_record *codecache_find(const struct _precomp_block *block,
+      unsigned int first, const uint32_t *source);
+int codecache_apply(const struct codecache_record *record, struct _precomp_block *block,
+      unsigned int end);
+
+void codecache_record_begin(struct _precomp_block *block, unsigned int first);
+void codecache_record_end(struct _precomp_block *block, unsigned int end,
+      const uint32_t *source, unsigned int src_words);
+
+void codecache_note_abs64(unsigned int pc_addr, uint64_t value);
+void codecache_note_rel(const void *dest);
+void codecache_note_jump(unsigned int pc_addr, unsigned int mi_addr, unsigned int absolute64);
+
+#endif /* __CODECACHE_H__ */
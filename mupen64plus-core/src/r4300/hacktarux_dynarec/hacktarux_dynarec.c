@@ -33,6 +33,7 @@
 #include "api/callbacks.h"
 #include "main/main.h"
 #include "memory/memory.h"
+#include "r4300/block_profiler.h"
 #include "r4300/cached_interp.h"
 #include "r4300/recomp.h"
 #include "r4300/cp0_private.h"
@@ -50,10 +51,16 @@
 #define offsetof(TYPE,MEMBER) ((unsigned int) &((TYPE*)0)->MEMBER)
 #endif
 
-static precomp_instr fake_instr;
+precomp_instr fake_instr;
 
 int branch_taken = 0;
 
+/* conditional branches keep the registers cached along their not-taken path */
+#if defined(__x86_64__) && !defined(DBG) && !defined(PROFILE_BLOCKS)
+#define BRANCH_FALL_THROUGH
+static int branch_falls_through = 0;
+#endif
+
 /* that's where the dynarec will restart when going back from a C function */
 #if defined(__x86_64__)
 #ifdef _MSC_VER
@@ -323,8 +330,24 @@ static void genupdate_count(unsigned int addr)
 #endif
 }
 
+#ifdef PROFILE_BLOCKS
+static void genblock_profiler_enter(void)
+{
+#ifdef __x86_64__
+   mov_reg64_imm64(RAX, (uint64_t) block_profiler_enter_last_addr);
+   call_reg64(RAX);
+#else
+   mov_reg32_imm32(EAX, (unsigned int) block_profiler_enter_last_addr);
+   call_reg32(EAX);
+#endif
+}
+#endif
+
 static void gencheck_interupt(uint64_t instr_structure)
 {
+#ifdef PROFILE_BLOCKS
+   genblock_profiler_enter();
+#endif
 #ifdef __x86_64__
    mov_xreg32_m32rel(EAX, (void*)(&next_interupt));
    cmp_xreg32_m32rel(EAX, (void*)&g_cp0_regs[CP0_COUNT_REG]);
@@ -347,8 +370,32 @@ static void gencheck_interupt(uint64_t instr_structure)
 #endif
 }
 
+#ifdef BRANCH_FALL_THROUGH
+/* gencheck_interupt() for a path that goes on with the registers cached,
+ * EAX must be free */
+static void gencheck_interupt_live(uint64_t instr_structure)
+{
+   mov_xreg32_m32rel(EAX, (void*)(&next_interupt));
+   cmp_xreg32_m32rel(EAX, (void*)&g_cp0_regs[CP0_COUNT_REG]);
+   ja_near_rj(0);
+   jump_start_rel32();
+
+   flush_dirty_registers();
+   mov_reg64_imm64(RAX, (uint64_t) instr_structure);
+   mov_m64rel_xreg64((uint64_t *)(&PC), RAX);
+   mov_reg64_imm64(RAX, (uint64_t) gen_interupt);
+   call_reg64(RAX);
+   reload_registers();
+
+   jump_end_rel32();
+}
+#endif
+
 static void gencheck_interupt_out(unsigned int addr)
 {
+#ifdef PROFILE_BLOCKS
+   genblock_profiler_enter();
+#endif
 #ifdef __x86_64__
    mov_xreg32_m32rel(EAX, (void*)(&next_interupt));
    cmp_xreg32_m32rel(EAX, (void*)&g_cp0_regs[CP0_COUNT_REG]);
@@ -907,6 +954,13 @@ static void ld_register_alloc(int *pGpr1, int *pGpr2, int *pBase1, int *pBase2)
 #endif
 
 
+/* Called by the stores when they hit a compiled word, the address is passed
+ * in 'address' */
+void invalidate_code_at_address(void)
+{
+   invalidate_code_word(address);
+}
+
 /* global functions */
 
 void gennotcompiled(void)
@@ -991,6 +1045,30 @@ void gendelayslot(void)
 #endif
 }
 
+/* The delay slot of a conditional branch. When the word after it is
+ * compiled next, the registers stay cached through it and the not-taken
+ * path, gentest() then writes them back only on the side exits. */
+static void gendelayslot_cond(void)
+{
+#ifdef BRANCH_FALL_THROUGH
+   if (branch_can_fall_through())
+   {
+      branch_falls_through = 1;
+      mov_m32rel_imm32((void*)(&delay_slot), 1);
+      recompile_opcode();
+
+      /* used by genupdate_count() */
+      free_register(RAX);
+      free_register(RDX);
+      genupdate_count(dst->addr+4);
+
+      mov_m32rel_imm32((void*)(&delay_slot), 0);
+      return;
+   }
+#endif
+   gendelayslot();
+}
+
 void genni(void)
 {
    gencallinterp((native_type)cached_interpreter_table.NI, 0);
@@ -1008,6 +1086,14 @@ void genfin_block(void)
 
 void gencheck_interupt_reg(void) // addr is in EAX
 {
+#ifdef PROFILE_BLOCKS
+   genblock_profiler_enter();
+#ifdef __x86_64__
+   mov_xreg32_m32rel(EAX, (void*)&last_addr);
+#else
+   mov_eax_memoffs32((unsigned int *)&last_addr);
+#endif
+#endif
 #ifdef __x86_64__
    mov_xreg32_m32rel(EBX, (void*)&next_interupt);
    cmp_xreg32_m32rel(EBX, (void*)&g_cp0_regs[CP0_COUNT_REG]);
@@ -1267,6 +1353,10 @@ void gentest(void)
    je_near_rj(0);
    jump_start_rel32();
 
+#ifdef BRANCH_FALL_THROUGH
+   if (branch_falls_through)
+      flush_dirty_registers();
+#endif
    mov_m32rel_imm32((void*)(&last_addr), dst->addr + (dst-1)->f.i.immediate*4);
    gencheck_interupt((uint64_t) (dst + (dst-1)->f.i.immediate));
    jmp(dst->addr + (dst-1)->f.i.immediate*4);
@@ -1274,6 +1364,15 @@ void gentest(void)
    jump_end_rel32();
 
    mov_m32rel_imm32((void*)(&last_addr), dst->addr + 4);
+#ifdef BRANCH_FALL_THROUGH
+   if (branch_falls_through)
+   {
+      gencheck_interupt_live((uint64_t) (dst + 1));
+      branch_falls_through = 0;
+      fall_through = 1;
+      return;
+   }
+#endif
 #else
    cmp_m32_imm32((unsigned int *)(&branch_taken), 0);
    je_near_rj(0);
@@ -1305,7 +1404,7 @@ void genbeq(void)
    }
 
    genbeq_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest();
 #endif
 }
@@ -1317,6 +1416,10 @@ void gentest_out(void)
    je_near_rj(0);
    jump_start_rel32();
 
+#ifdef BRANCH_FALL_THROUGH
+   if (branch_falls_through)
+      flush_dirty_registers();
+#endif
    mov_m32rel_imm32((void*)(&last_addr), dst->addr + (dst-1)->f.i.immediate*4);
    gencheck_interupt_out(dst->addr + (dst-1)->f.i.immediate*4);
    mov_m32rel_imm32(&jump_to_address, dst->addr + (dst-1)->f.i.immediate*4);
@@ -1327,6 +1430,15 @@ void gentest_out(void)
    jump_end_rel32();
 
    mov_m32rel_imm32((void*)(&last_addr), dst->addr + 4);
+#ifdef BRANCH_FALL_THROUGH
+   if (branch_falls_through)
+   {
+      gencheck_interupt_live((uint64_t) (dst + 1));
+      branch_falls_through = 0;
+      fall_through = 1;
+      return;
+   }
+#endif
 #else
    cmp_m32_imm32((unsigned int *)(&branch_taken), 0);
    je_near_rj(0);
@@ -1361,7 +1473,7 @@ void genbeq_out(void)
    }
 
    genbeq_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest_out();
 #endif
 }
@@ -1437,7 +1549,7 @@ void genbne(void)
    }
 
    genbne_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest();
 #endif
 }
@@ -1455,7 +1567,7 @@ void genbne_out(void)
    }
 
    genbne_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest_out();
 #endif
 }
@@ -1491,7 +1603,7 @@ void genblez(void)
    }
 
    genblez_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest();
 #endif
 }
@@ -1509,7 +1621,7 @@ void genblez_out(void)
    }
 
    genblez_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest_out();
 #endif
 }
@@ -1545,7 +1657,7 @@ void genbgtz(void)
    }
 
    genbgtz_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest();
 #endif
 }
@@ -1563,7 +1675,7 @@ void genbgtz_out(void)
    }
 
    genbgtz_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest_out();
 #endif
 }
@@ -2722,11 +2834,12 @@ void gensb(void)
    xor_reg8_imm8(BL, 3); // 4
    mov_preg64preg64_reg8(RBX, RSI, CL); // 3
 
+   mov_m32rel_xreg32((unsigned int *)(&address), EAX);
    mov_reg64_imm64(RSI, (uint64_t) invalid_code);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg64preg64_imm8(RBX, RSI, 0);
-   jne_rj(65);
+   jne_rj(73);
 
    mov_reg64_imm64(RDI, (uint64_t) blocks); // 10
    mov_reg32_reg32(ECX, EBX); // 2
@@ -2739,8 +2852,9 @@ void gensb(void)
    mul_reg32(EDX); // 2
    mov_reg64_preg64preg64pimm32(RAX, RAX, RBX, (int) offsetof(precomp_instr, ops)); // 8
    cmp_reg64_reg64(RAX, RDI); // 3
-   je_rj(4); // 2
-   mov_preg64preg64_imm8(RCX, RSI, 1); // 4
+   je_rj(12); // 2
+   mov_reg64_imm64(RAX, (uint64_t) invalidate_code_at_address); // 10
+   call_reg64(RAX); // 2
 #else
    free_all_registers();
    simplify_access();
@@ -2775,6 +2889,7 @@ void gensb(void)
    xor_reg8_imm8(BL, 3); // 3
    mov_preg32pimm32_reg8(EBX, (unsigned int)g_rdram, CL); // 6
 
+   mov_m32_reg32((unsigned int *)(&address), EAX);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg32pimm32_imm8(EBX, (unsigned int)invalid_code, 0);
@@ -2790,7 +2905,8 @@ void gensb(void)
    mov_reg32_preg32preg32pimm32(EAX, EAX, EBX, (int)&dst->ops - (int)dst); // 7
    cmp_reg32_imm32(EAX, (unsigned int)cached_interpreter_table.NOTCOMPILED); // 6
    je_rj(7); // 2
-   mov_preg32pimm32_imm8(ECX, (unsigned int)invalid_code, 1); // 7
+   mov_reg32_imm32(EAX, (unsigned int)invalidate_code_at_address); // 5
+   call_reg32(EAX); // 2
 #endif
 #endif
 }
@@ -2838,11 +2954,12 @@ void gensh(void)
    xor_reg8_imm8(BL, 2); // 4
    mov_preg64preg64_reg16(RBX, RSI, CX); // 4
 
+   mov_m32rel_xreg32((unsigned int *)(&address), EAX);
    mov_reg64_imm64(RSI, (uint64_t) invalid_code);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg64preg64_imm8(RBX, RSI, 0);
-   jne_rj(65);
+   jne_rj(73);
 
    mov_reg64_imm64(RDI, (uint64_t) blocks); // 10
    mov_reg32_reg32(ECX, EBX); // 2
@@ -2855,8 +2972,9 @@ void gensh(void)
    mul_reg32(EDX); // 2
    mov_reg64_preg64preg64pimm32(RAX, RAX, RBX, (int) offsetof(precomp_instr, ops)); // 8
    cmp_reg64_reg64(RAX, RDI); // 3
-   je_rj(4); // 2
-   mov_preg64preg64_imm8(RCX, RSI, 1); // 4
+   je_rj(12); // 2
+   mov_reg64_imm64(RAX, (uint64_t) invalidate_code_at_address); // 10
+   call_reg64(RAX); // 2
 #else
    free_all_registers();
    simplify_access();
@@ -2891,6 +3009,7 @@ void gensh(void)
    xor_reg8_imm8(BL, 2); // 3
    mov_preg32pimm32_reg16(EBX, (unsigned int)g_rdram, CX); // 7
 
+   mov_m32_reg32((unsigned int *)(&address), EAX);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg32pimm32_imm8(EBX, (unsigned int)invalid_code, 0);
@@ -2906,7 +3025,8 @@ void gensh(void)
    mov_reg32_preg32preg32pimm32(EAX, EAX, EBX, (int)&dst->ops - (int)dst); // 7
    cmp_reg32_imm32(EAX, (unsigned int)cached_interpreter_table.NOTCOMPILED); // 6
    je_rj(7); // 2
-   mov_preg32pimm32_imm8(ECX, (unsigned int)invalid_code, 1); // 7
+   mov_reg32_imm32(EAX, (unsigned int)invalidate_code_at_address); // 5
+   call_reg32(EAX); // 2
 #endif
 #endif
 }
@@ -2958,11 +3078,12 @@ void gensw(void)
    and_reg32_imm32(EBX, 0x7FFFFF); // 6
    mov_preg64preg64_reg32(RBX, RSI, ECX); // 3
 
+   mov_m32rel_xreg32((unsigned int *)(&address), EAX);
    mov_reg64_imm64(RSI, (uint64_t) invalid_code);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg64preg64_imm8(RBX, RSI, 0);
-   jne_rj(65);
+   jne_rj(73);
 
    mov_reg64_imm64(RDI, (uint64_t) blocks); // 10
    mov_reg32_reg32(ECX, EBX); // 2
@@ -2975,8 +3096,9 @@ void gensw(void)
    mul_reg32(EDX); // 2
    mov_reg64_preg64preg64pimm32(RAX, RAX, RBX, (int) offsetof(precomp_instr, ops)); // 8
    cmp_reg64_reg64(RAX, RDI); // 3
-   je_rj(4); // 2
-   mov_preg64preg64_imm8(RCX, RSI, 1); // 4
+   je_rj(12); // 2
+   mov_reg64_imm64(RAX, (uint64_t) invalidate_code_at_address); // 10
+   call_reg64(RAX); // 2
 #else
    free_all_registers();
    simplify_access();
@@ -3010,6 +3132,7 @@ void gensw(void)
    and_reg32_imm32(EBX, 0x7FFFFF); // 6
    mov_preg32pimm32_reg32(EBX, (unsigned int)g_rdram, ECX); // 6
 
+   mov_m32_reg32((unsigned int *)(&address), EAX);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg32pimm32_imm8(EBX, (unsigned int)invalid_code, 0);
@@ -3025,7 +3148,8 @@ void gensw(void)
    mov_reg32_preg32preg32pimm32(EAX, EAX, EBX, (int)&dst->ops - (int)dst); // 7
    cmp_reg32_imm32(EAX, (unsigned int)cached_interpreter_table.NOTCOMPILED); // 6
    je_rj(7); // 2
-   mov_preg32pimm32_imm8(ECX, (unsigned int)invalid_code, 1); // 7
+   mov_reg32_imm32(EAX, (unsigned int)invalidate_code_at_address); // 5
+   call_reg32(EAX); // 2
 #endif
 #endif
 }
@@ -3290,11 +3414,12 @@ void genswc1(void)
    and_reg32_imm32(EBX, 0x7FFFFF); // 6
    mov_preg64preg64_reg32(RBX, RSI, ECX); // 3
 
+   mov_m32rel_xreg32((unsigned int *)(&address), EAX);
    mov_reg64_imm64(RSI, (uint64_t) invalid_code);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg64preg64_imm8(RBX, RSI, 0);
-   jne_rj(65);
+   jne_rj(73);
 
    mov_reg64_imm64(RDI, (uint64_t) blocks); // 10
    mov_reg32_reg32(ECX, EBX); // 2
@@ -3307,8 +3432,9 @@ void genswc1(void)
    mul_reg32(EDX); // 2
    mov_reg64_preg64preg64pimm32(RAX, RAX, RBX, (int) offsetof(precomp_instr, ops)); // 8
    cmp_reg64_reg64(RAX, RDI); // 3
-   je_rj(4); // 2
-   mov_preg64preg64_imm8(RCX, RSI, 1); // 4
+   je_rj(12); // 2
+   mov_reg64_imm64(RAX, (uint64_t) invalidate_code_at_address); // 10
+   call_reg64(RAX); // 2
 #else
    mov_reg32_m32(EDX, (unsigned int*)(&reg_cop1_simple[dst->f.lf.ft]));
    mov_reg32_preg32(ECX, EDX);
@@ -3341,6 +3467,7 @@ void genswc1(void)
    and_reg32_imm32(EBX, 0x7FFFFF); // 6
    mov_preg32pimm32_reg32(EBX, (unsigned int)g_rdram, ECX); // 6
 
+   mov_m32_reg32((unsigned int *)(&address), EAX);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg32pimm32_imm8(EBX, (unsigned int)invalid_code, 0);
@@ -3356,7 +3483,8 @@ void genswc1(void)
    mov_reg32_preg32preg32pimm32(EAX, EAX, EBX, (int)&dst->ops - (int)dst); // 7
    cmp_reg32_imm32(EAX, (unsigned int)cached_interpreter_table.NOTCOMPILED); // 6
    je_rj(7); // 2
-   mov_preg32pimm32_imm8(ECX, (unsigned int)invalid_code, 1); // 7
+   mov_reg32_imm32(EAX, (unsigned int)invalidate_code_at_address); // 5
+   call_reg32(EAX); // 2
 #endif
 #endif
 }
@@ -3407,11 +3535,12 @@ void gensdc1(void)
    mov_preg64preg64pimm32_reg32(RBX, RSI, 4, ECX); // 7
    mov_preg64preg64_reg32(RBX, RSI, EDX); // 3
 
+   mov_m32rel_xreg32((unsigned int *)(&address), EAX);
    mov_reg64_imm64(RSI, (uint64_t) invalid_code);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg64preg64_imm8(RBX, RSI, 0);
-   jne_rj(65);
+   jne_rj(73);
 
    mov_reg64_imm64(RDI, (uint64_t) blocks); // 10
    mov_reg32_reg32(ECX, EBX); // 2
@@ -3424,8 +3553,9 @@ void gensdc1(void)
    mul_reg32(EDX); // 2
    mov_reg64_preg64preg64pimm32(RAX, RAX, RBX, (int) offsetof(precomp_instr, ops)); // 8
    cmp_reg64_reg64(RAX, RDI); // 3
-   je_rj(4); // 2
-   mov_preg64preg64_imm8(RCX, RSI, 1); // 4
+   je_rj(12); // 2
+   mov_reg64_imm64(RAX, (uint64_t) invalidate_code_at_address); // 10
+   call_reg64(RAX); // 2
 #else
    mov_reg32_m32(ESI, (unsigned int*)(&reg_cop1_double[dst->f.lf.ft]));
    mov_reg32_preg32(ECX, ESI);
@@ -3461,6 +3591,7 @@ void gensdc1(void)
    mov_preg32pimm32_reg32(EBX, ((unsigned int)g_rdram)+4, ECX); // 6
    mov_preg32pimm32_reg32(EBX, ((unsigned int)g_rdram)+0, EDX); // 6
 
+   mov_m32_reg32((unsigned int *)(&address), EAX);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg32pimm32_imm8(EBX, (unsigned int)invalid_code, 0);
@@ -3476,7 +3607,8 @@ void gensdc1(void)
    mov_reg32_preg32preg32pimm32(EAX, EAX, EBX, (int)&dst->ops - (int)dst); // 7
    cmp_reg32_imm32(EAX, (unsigned int)cached_interpreter_table.NOTCOMPILED); // 6
    je_rj(7); // 2
-   mov_preg32pimm32_imm8(ECX, (unsigned int)invalid_code, 1); // 7
+   mov_reg32_imm32(EAX, (unsigned int)invalidate_code_at_address); // 5
+   call_reg32(EAX); // 2
 #endif
 #endif
 }
@@ -3527,11 +3659,12 @@ void gensd(void)
    mov_preg64preg64pimm32_reg32(RBX, RSI, 4, ECX); // 7
    mov_preg64preg64_reg32(RBX, RSI, EDX); // 3
 
+   mov_m32rel_xreg32((unsigned int *)(&address), EAX);
    mov_reg64_imm64(RSI, (uint64_t) invalid_code);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg64preg64_imm8(RBX, RSI, 0);
-   jne_rj(65);
+   jne_rj(73);
 
    mov_reg64_imm64(RDI, (uint64_t) blocks); // 10
    mov_reg32_reg32(ECX, EBX); // 2
@@ -3544,8 +3677,9 @@ void gensd(void)
    mul_reg32(EDX); // 2
    mov_reg64_preg64preg64pimm32(RAX, RAX, RBX, (int) offsetof(precomp_instr, ops)); // 8
    cmp_reg64_reg64(RAX, RDI); // 3
-   je_rj(4); // 2
-   mov_preg64preg64_imm8(RCX, RSI, 1); // 4
+   je_rj(12); // 2
+   mov_reg64_imm64(RAX, (uint64_t) invalidate_code_at_address); // 10
+   call_reg64(RAX); // 2
 #else
    free_all_registers();
    simplify_access();
@@ -3583,6 +3717,7 @@ void gensd(void)
    mov_preg32pimm32_reg32(EBX, ((unsigned int)g_rdram)+4, ECX); // 6
    mov_preg32pimm32_reg32(EBX, ((unsigned int)g_rdram)+0, EDX); // 6
 
+   mov_m32_reg32((unsigned int *)(&address), EAX);
    mov_reg32_reg32(EBX, EAX);
    shr_reg32_imm8(EBX, 12);
    cmp_preg32pimm32_imm8(EBX, (unsigned int)invalid_code, 0);
@@ -3598,7 +3733,8 @@ void gensd(void)
    mov_reg32_preg32preg32pimm32(EAX, EAX, EBX, (int)&dst->ops - (int)dst); // 7
    cmp_reg32_imm32(EAX, (unsigned int)cached_interpreter_table.NOTCOMPILED); // 6
    je_rj(7); // 2
-   mov_preg32pimm32_imm8(ECX, (unsigned int)invalid_code, 1); // 7
+   mov_reg32_imm32(EAX, (unsigned int)invalidate_code_at_address); // 5
+   call_reg32(EAX); // 2
 #endif
 #endif
 }
@@ -5370,7 +5506,7 @@ void genbc1f(void)
    
    gencheck_cop1_unusable();
    genbc1f_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest();
 #endif
 }
@@ -5389,7 +5525,7 @@ void genbc1f_out(void)
 
    gencheck_cop1_unusable();
    genbc1f_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest_out();
 #endif
 }
@@ -5427,7 +5563,7 @@ void genbc1t(void)
 
    gencheck_cop1_unusable();
    genbc1t_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest();
 #endif
 }
@@ -5446,7 +5582,7 @@ void genbc1t_out(void)
 
    gencheck_cop1_unusable();
    genbc1t_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest_out();
 #endif
 }
@@ -5651,7 +5787,7 @@ void genbltz(void)
    }
 
    genbltz_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest();
 #endif
 }
@@ -5669,7 +5805,7 @@ void genbltz_out(void)
    }
 
    genbltz_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest_out();
 #endif
 }
@@ -5755,7 +5891,7 @@ void genbgez(void)
    }
 
    genbgez_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest();
 #endif
 }
@@ -5773,7 +5909,7 @@ void genbgez_out(void)
    }
 
    genbgez_test();
-   gendelayslot();
+   gendelayslot_cond();
    gentest_out();
 #endif
 }
@@ -5970,7 +6106,7 @@ void genbltzal(void)
 
    genbltz_test();
    genbranchlink();
-   gendelayslot();
+   gendelayslot_cond();
    gentest();
 #endif
 }
@@ -5989,7 +6125,7 @@ void genbltzal_out(void)
 
    genbltz_test();
    genbranchlink();
-   gendelayslot();
+   gendelayslot_cond();
    gentest_out();
 #endif
 }
@@ -6027,7 +6163,7 @@ void genbgezal(void)
 
    genbgez_test();
    genbranchlink();
-   gendelayslot();
+   gendelayslot_cond();
    gentest();
 #endif
 }
@@ -6046,7 +6182,7 @@ void genbgezal_out(void)
 
    genbgez_test();
    genbranchlink();
-   gendelayslot();
+   gendelayslot_cond();
    gentest_out();
 #endif
 }
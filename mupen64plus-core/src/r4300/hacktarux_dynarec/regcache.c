@@ -94,6 +94,38 @@ void free_registers_move_start(void)
   /* now move the start of the new instruction down past the flushing instructions */
   simplify_access();
 }
+
+/* write the dirty registers back but keep them cached, for the side exits
+ * of a branch whose not-taken path goes on with the same registers */
+void flush_dirty_registers(void)
+{
+   int i;
+
+   for (i = 0; i < 8; i++)
+   {
+      if (!last_access[i] || !reg_content[i] || !dirty[i])
+         continue;
+      if (!r64[i])
+         movsxd_reg64_reg32(i, i);
+      mov_m64rel_xreg64((uint64_t*)reg_content[i], i);
+   }
+}
+
+/* load the cached registers again after a call that may have clobbered them */
+void reload_registers(void)
+{
+   int i;
+
+   for (i = 0; i < 8; i++)
+   {
+      if (!last_access[i] || !reg_content[i])
+         continue;
+      if (r64[i])
+         mov_xreg64_m64rel(i, (uint64_t*)reg_content[i]);
+      else
+         mov_xreg32_m32rel(i, (unsigned int*)reg_content[i]);
+   }
+}
 #endif
 
 // this function frees a specific X86 GPR
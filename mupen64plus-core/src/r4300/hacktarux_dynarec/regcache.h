@@ -29,6 +29,8 @@ void free_register(int reg);
 void init_cache(precomp_instr* start);
 #if defined(__x86_64__)
 void free_registers_move_start(void);
+void flush_dirty_registers(void);
+void reload_registers(void);
 int allocate_register_32(uint32_t *addr);
 int allocate_register_64(uint64_t *addr);
 int allocate_register_32_w(uint32_t *addr);
@@ -39,10 +39,19 @@
 // Thus the local variables are actually global and not on the stack.
 
 extern char *invc_ptr;
-extern char extra_memory[33554432];
 
-#define BASE_ADDR ((int)(&extra_memory))
-//#define TARGET_SIZE_2 24 // 2^24 = 16 megabytes
+// Size of the code cache, set with NEW_DYNAREC_TCACHE_SIZE_2 in Makefile.common.
+// Branches between blocks must reach across the whole cache, so it can't be
+// larger than 32 megabytes.
+#ifndef TARGET_SIZE_2
 #define TARGET_SIZE_2 25 // 2^25 = 32 megabytes
+#endif
+#if TARGET_SIZE_2 < 22 || TARGET_SIZE_2 > 25
+#error TARGET_SIZE_2 must be between 22 (4 megabytes) and 25 (32 megabytes)
+#endif
+
+extern char extra_memory[1<<TARGET_SIZE_2];
+
+#define BASE_ADDR ((int)(&extra_memory))
 
 #endif /* M64P_R4300_ASSEM_ARM_H */
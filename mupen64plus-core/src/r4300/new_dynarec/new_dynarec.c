@@ -50,6 +50,7 @@ extern "C" {
 #include "../../main/main.h"
 #include "../../memory/memory.h"
 #include "../../rsp/rsp_core.h"
+#include "../block_profiler.h"
 #include "../cached_interp.h"
 #include "../cp0_private.h"
 #include "../cp1_private.h"
@@ -185,7 +186,38 @@ struct ll_entry *jump_dirty[4096];
 ALIGN(16, u_int hash_table[65536][4]);
 ALIGN(16, static char shadow[2097152]);
 static char *copy;
+
+#ifdef REGION_EVICTION
+// The code cache is split into 8 regions, filled one at a time.  A block
+// never crosses into the next region; when the current one is full, the
+// next region not looked up since the previous change of region is expired
+// as a whole and filling goes on there.  Up to MAX_KEPT_REGIONS regions
+// are kept that way, so the hot code of a game doesn't have to be
+// recompiled each time the cache wraps around.
+#define TCACHE_REGIONS 8
+#define REGION_SHIFT (TARGET_SIZE_2-3)
+#define MAX_KEPT_REGIONS 2
+static u_int tcache_epoch;
+static u_int region_epoch[TCACHE_REGIONS]; // tcache_epoch of the last lookup
+static u_char region_kept[TCACHE_REGIONS];
+static int kept_regions;
+static struct
+{
+  u_int blocks;   // blocks compiled
+  u_int bytes;    // bytes of code emitted
+  u_int expired;  // entry points expired
+  u_int restored; // dirty blocks restored without recompiling
+  u_int kept;     // regions skipped to keep their blocks
+} tcache_stats;
+#define tcache_count(field,n) (tcache_stats.field+=(n))
+#else
+// The oldest blocks are expired a few jump table bins at a time after
+// each compiled block, see Pass 10 of new_recompile_block
 static int expirep;
+#define tcache_count(field,n) ((void)(n))
+#define mark_region_used(addr)
+#endif
+
 u_int using_tlb;
 static u_int stop_after_jal;
 
@@ -366,6 +398,18 @@ static void nullf() {}
 
 #define log_message(...) DebugMessage(M64MSG_VERBOSE, __VA_ARGS__)
 
+#ifdef REGION_EVICTION
+// Note a use of compiled code, so its region is kept if possible.  This is
+// only done where the hash table misses (and for new links), so that a hit
+// stays two compares: code only ever reached through the hash table, or
+// through the lookups of linkage_*.S, doesn't keep its region.
+static void mark_region_used(void *addr)
+{
+  u_int region=((u_int)addr-(u_int)base_addr)>>REGION_SHIFT;
+  if(region<TCACHE_REGIONS) region_epoch[region]=tcache_epoch;
+}
+#endif
+
 // Get address from virtual address
 // This is called from the recompiled JR/JALR instructions
 void *get_addr(u_int vaddr)
@@ -387,6 +431,7 @@ void *get_addr(u_int vaddr)
       ht_bin[2]=ht_bin[0];
       ht_bin[1]=(int)head->addr;
       ht_bin[0]=vaddr;
+      mark_region_used(head->addr);
       return head->addr;
     }
     head=head->next;
@@ -420,6 +465,8 @@ void *get_addr(u_int vaddr)
             ht_bin[1]=(int)head->addr;
             ht_bin[0]=vaddr;
           }
+          tcache_count(restored,1);
+          mark_region_used(head->addr);
           return head->addr;
         }
       }
@@ -442,6 +489,7 @@ void *get_addr(u_int vaddr)
 void *get_addr_ht(u_int vaddr)
 {
   //DebugMessage(M64MSG_VERBOSE, "TRACE: count=%d next=%d (get_addr_ht %x)",g_cp0_regs[CP0_COUNT_REG],next_interupt,vaddr);
+  BLOCK_PROFILER_ENTER(vaddr);
   u_int *ht_bin=hash_table[((vaddr>>16)^vaddr)&0xFFFF];
   if(ht_bin[0]==vaddr) return (void *)ht_bin[1];
   if(ht_bin[2]==vaddr) return (void *)ht_bin[3];
@@ -451,6 +499,7 @@ void *get_addr_ht(u_int vaddr)
 void *get_addr_32(u_int vaddr,u_int flags)
 {
   //DebugMessage(M64MSG_VERBOSE, "TRACE: count=%d next=%d (get_addr_32 %x,flags %x)",g_cp0_regs[CP0_COUNT_REG],next_interupt,vaddr,flags);
+  BLOCK_PROFILER_ENTER(vaddr);
   u_int *ht_bin=hash_table[((vaddr>>16)^vaddr)&0xFFFF];
   if(ht_bin[0]==vaddr) return (void *)ht_bin[1];
   if(ht_bin[2]==vaddr) return (void *)ht_bin[3];
@@ -479,6 +528,7 @@ void *get_addr_32(u_int vaddr,u_int flags)
         //ht_bin[1]=(int)head->addr;
         //ht_bin[0]=vaddr;
       }
+      mark_region_used(head->addr);
       return head->addr;
     }
     head=head->next;
@@ -515,6 +565,8 @@ void *get_addr_32(u_int vaddr,u_int flags)
             //ht_bin[1]=(int)head->addr;
             //ht_bin[0]=vaddr;
           }
+          tcache_count(restored,1);
+          mark_region_used(head->addr);
           return head->addr;
         }
       }
@@ -1079,24 +1131,33 @@ static void remove_hash(int vaddr)
   }
 }
 
-static void ll_remove_matching_addrs(struct ll_entry **head,int addr,int shift)
+// Remove the entries pointing into a region, returns how many were removed.
+// With REGION_EVICTION blocks don't cross regions, so an entry belongs to
+// the one holding its address.
+static int ll_remove_matching_addrs(struct ll_entry **head,int addr,int shift)
 {
   struct ll_entry *next;
+  int removed=0;
   while(*head) {
-    if((((u_int)((*head)->addr)-(u_int)base_addr)>>shift)==((addr-(u_int)base_addr)>>shift) ||
-       (((u_int)((*head)->addr)-(u_int)base_addr-MAX_OUTPUT_BLOCK_SIZE)>>shift)==((addr-(u_int)base_addr)>>shift))
+    if((((u_int)((*head)->addr)-(u_int)base_addr)>>shift)==((addr-(u_int)base_addr)>>shift)
+#ifndef REGION_EVICTION
+       ||(((u_int)((*head)->addr)-(u_int)base_addr-MAX_OUTPUT_BLOCK_SIZE)>>shift)==((addr-(u_int)base_addr)>>shift)
+#endif
+      )
     {
       inv_debug("EXP: Remove pointer to %x (%x)\n",(int)(*head)->addr,(*head)->vaddr);
       remove_hash((*head)->vaddr);
       next=(*head)->next;
       free(*head);
       *head=next;
+      removed++;
     }
     else
     {
       head=&((*head)->next);
     }
   }
+  return removed;
 }
 
 // Remove all entries from linked list
@@ -1120,8 +1181,11 @@ static void ll_kill_pointers(struct ll_entry *head,int addr,int shift)
   while(head) {
     u_int ptr=get_pointer(head->addr);
     inv_debug("EXP: Lookup pointer to %x at %x (%x)\n",(int)ptr,(int)head->addr,head->vaddr);
-    if((((ptr-(u_int)base_addr)>>shift)==((addr-(u_int)base_addr)>>shift)) ||
-       (((ptr-(u_int)base_addr-MAX_OUTPUT_BLOCK_SIZE)>>shift)==((addr-(u_int)base_addr)>>shift)))
+    if((((ptr-(u_int)base_addr)>>shift)==((addr-(u_int)base_addr)>>shift))
+#ifndef REGION_EVICTION
+       ||(((ptr-(u_int)base_addr-MAX_OUTPUT_BLOCK_SIZE)>>shift)==((addr-(u_int)base_addr)>>shift))
+#endif
+      )
     {
       inv_debug("EXP: Kill pointer at %x (%x)\n",(int)head->addr,head->vaddr);
       u_int host_addr=(int)kill_pointer(head->addr);
@@ -1304,6 +1368,7 @@ void add_link(u_int vaddr,void *src)
   if(page>4095) page=2048+(page&2047);
   inv_debug("add_link: %x -> %x (%d)\n",(int)src,vaddr,page);
   ll_add(jump_out+page,vaddr,src);
+  mark_region_used(src);
   //int ptr=get_pointer(src);
   //inv_debug("add_link: Pointer is to %x\n",(int)ptr);
 }
@@ -1349,6 +1414,7 @@ void clean_blocks(u_int page)
               //DebugMessage(M64MSG_VERBOSE, "page=%x, addr=%x",page,head->vaddr);
               //assert(head->vaddr>>12==(page|0x80000));
               ll_add_32(jump_in+ppage,head->vaddr,head->reg_sv_flags,clean_addr);
+              tcache_count(restored,1);
               u_int *ht_bin=hash_table[((head->vaddr>>16)^head->vaddr)&0xFFFF];
               if(!head->reg_sv_flags) {
                 if(ht_bin[0]==head->vaddr) {
@@ -1367,6 +1433,73 @@ void clean_blocks(u_int page)
   }
 }
 
+#ifdef REGION_EVICTION
+// Free a region of the code cache, and everything pointing into it
+static void expire_region(int region)
+{
+  int shift=REGION_SHIFT;
+  int base=(int)base_addr+(region<<shift);
+  int n;
+  inv_debug("EXP: Region %d\n",region);
+  // Clear jump_in and jump_dirty
+  for(n=0;n<4096;n++) {
+    tcache_count(expired,ll_remove_matching_addrs(jump_in+n,base,shift));
+    ll_remove_matching_addrs(jump_dirty+n,base,shift);
+  }
+  // Clear pointers
+  for(n=0;n<4096;n++)
+    ll_kill_pointers(jump_out[n],base,shift);
+  // Clear hash table
+  for(n=0;n<65536;n++) {
+    u_int *ht_bin=hash_table[n];
+    if(((ht_bin[3]-(u_int)base_addr)>>shift)==(u_int)region) {
+      inv_debug("EXP: Remove hash %x -> %x\n",ht_bin[2],ht_bin[3]);
+      ht_bin[2]=ht_bin[3]=-1;
+    }
+    if(((ht_bin[1]-(u_int)base_addr)>>shift)==(u_int)region) {
+      inv_debug("EXP: Remove hash %x -> %x\n",ht_bin[0],ht_bin[1]);
+      ht_bin[0]=ht_bin[2];
+      ht_bin[1]=ht_bin[3];
+      ht_bin[2]=ht_bin[3]=-1;
+    }
+  }
+  // Clear jump_out
+  #if NEW_DYNAREC == NEW_DYNAREC_ARM
+  do_clear_cache();
+  #endif
+  for(n=0;n<4096;n++)
+    ll_remove_matching_addrs(jump_out+n,base,shift);
+}
+
+// Called when the current region can't hold another block: pick the
+// region to fill next, skipping the ones used since the last call
+static void next_region(void)
+{
+  int region=((u_int)out-(u_int)base_addr)>>REGION_SHIFT;
+  int next=region;
+  int i;
+  for(i=1;i<TCACHE_REGIONS;i++) {
+    next=(region+i)%TCACHE_REGIONS;
+    if(region_epoch[next]!=tcache_epoch) break;
+    if(!region_kept[next]) {
+      if(kept_regions>=MAX_KEPT_REGIONS) break;
+      region_kept[next]=1;
+      kept_regions++;
+      tcache_stats.kept++;
+    }
+  }
+  if(region_kept[next]) {
+    region_kept[next]=0;
+    kept_regions--;
+  }
+  log_message("new_dynarec: region %d full, %u blocks (%u KB), %u entry points expired, %u blocks restored, %u regions kept",
+    region,tcache_stats.blocks,tcache_stats.bytes>>10,tcache_stats.expired,tcache_stats.restored,tcache_stats.kept);
+  memset(&tcache_stats,0,sizeof(tcache_stats));
+  expire_region(next);
+  out=(u_char *)base_addr+(next<<REGION_SHIFT);
+  tcache_epoch++;
+}
+#endif
 
 static void mov_alloc(struct regstat *current,int i)
 {
@@ -7662,7 +7795,15 @@ void new_dynarec_init(void)
   memset(mini_ht,-1,sizeof(mini_ht));
   memset(restore_candidate,0,sizeof(restore_candidate));
   copy=shadow;
+#ifdef REGION_EVICTION
+  tcache_epoch=1;
+  memset(region_epoch,0,sizeof(region_epoch));
+  memset(region_kept,0,sizeof(region_kept));
+  kept_regions=0;
+  memset(&tcache_stats,0,sizeof(tcache_stats));
+#else
   expirep=16384; // Expiry pointer, +2 blocks
+#endif
   pending_exception=0;
   literalcount=0;
 #ifdef HOST_IMM8
@@ -11002,10 +11143,24 @@ int new_recompile_block(int addr)
 
   end_block(beginning);
 
+#ifdef REGION_EVICTION
+  tcache_stats.blocks++;
+  tcache_stats.bytes+=(u_int)out-(u_int)beginning;
+
+  // Move on to another region if the next block may not fit in this one
+  {
+    int region=((u_int)out-(u_int)base_addr)>>REGION_SHIFT;
+    u_int limit=(u_int)base_addr+((region+1)<<REGION_SHIFT);
+    if(region==TCACHE_REGIONS-1) limit-=JUMP_TABLE_SIZE;
+    if((u_int)out+MAX_OUTPUT_BLOCK_SIZE>limit)
+      next_region();
+  }
+#else
   // If we're within 256K of the end of the buffer,
   // start over from the beginning. (Is 256K enough?)
   if((u_int)out > (u_char *)((u_char *)base_addr+(1<<TARGET_SIZE_2)-MAX_OUTPUT_BLOCK_SIZE-JUMP_TABLE_SIZE))
     out=(u_char *)base_addr;
+#endif
 
   // Trap writes to any of the pages we compiled
   for(i=start>>12;i<=(int)((start+slen*4)>>12);i++) {
@@ -11020,6 +11175,7 @@ int new_recompile_block(int addr)
     }
   }
 
+#ifndef REGION_EVICTION
   /* Pass 10 - Free memory by expiring oldest blocks */
 
   int end=((((intptr_t)out-(intptr_t)base_addr)>>(TARGET_SIZE_2-16))+16384)&65535;
@@ -11072,6 +11228,7 @@ int new_recompile_block(int addr)
     }
     expirep=(expirep+1)&65535;
   }
+#endif
   return 0;
 }
 
@@ -22,7 +22,12 @@ extern void *base_addr; // Code generator target address
 }
 #endif
 
+#ifndef TARGET_SIZE_2
 #define TARGET_SIZE_2 25 // 2^25 = 32 megabytes
+#endif
+#if TARGET_SIZE_2 < 22
+#error TARGET_SIZE_2 must be at least 22 (4 megabytes)
+#endif
 #define JUMP_TABLE_SIZE 0 // Not needed for 32-bit x86
 
 /* x86 calling convention:
@@ -27,6 +27,7 @@
 #include "api/callbacks.h"
 #include "api/debugger.h"
 #include "api/m64p_types.h"
+#include "block_profiler.h"
 /* TLBWrite requires invalid_code and blocks from cached_interp.h, but only if
  * (at run time) the active core is not the Pure Interpreter. */
 #include "cached_interp.h"
@@ -80,6 +81,7 @@ static void InterpretOpcode(void);
          interp_PC.addr += 8; \
          cp0_update_count(); \
       } \
+      BLOCK_PROFILER_ENTER(interp_PC.addr); \
       last_addr = interp_PC.addr; \
       if (next_interupt <= g_cp0_regs[CP0_COUNT_REG]) gen_interupt(); \
    } \
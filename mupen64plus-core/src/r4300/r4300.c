@@ -27,9 +27,11 @@
 #include "api/callbacks.h"
 #include "api/debugger.h"
 #include "api/m64p_types.h"
+#include "block_profiler.h"
 #include "cached_interp.h"
 #include "cp0_private.h"
 #include "cp1_private.h"
+#include "hacktarux_dynarec/codecache.h"
 #include "interupt.h"
 #include "main/main.h"
 #include "main/rom.h"
@@ -127,6 +129,7 @@ void r4300_reset_hard(void)
         tlb_LUT_r[i] = 0;
         tlb_LUT_w[i] = 0;
     }
+    tlb_cache_flush();
     llbit=0;
     hi=0;
     lo=0;
@@ -282,8 +285,10 @@ void r4300_execute(void)
         new_dyna_start();
         new_dynarec_cleanup();
 #else
+        codecache_open(ROM_SETTINGS.MD5);
         dyna_start(dynarec_setup_code);
         PC++;
+        codecache_close();
 #endif
         free_blocks();
     }
@@ -306,6 +311,11 @@ void r4300_execute(void)
         free_blocks();
     }
 
+#if defined(PROFILE_BLOCKS)
+    if (g_block_profiler_enabled)
+        block_profiler_report();
+#endif
+
     DebugMessage(M64MSG_INFO, "R4300 emulator finished.");
 }
 
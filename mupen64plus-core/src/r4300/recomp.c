@@ -39,6 +39,7 @@
 #include "api/m64p_types.h"
 #include "cached_interp.h"
 #include "cp0_private.h"
+#include "hacktarux_dynarec/codecache.h"
 #include "main/profile.h"
 #include "memory/memory.h"
 #include "ops.h"
@@ -67,6 +68,15 @@ static const uint32_t *SRC  = NULL;  /* currently recompiled instruction in the
 static int delay_slot_compiled = 0;
 static int check_nop;                /* next instruction is NOP ? */
 
+int fall_through;                    /* set by a branch whose not-taken path
+                                      * goes on with the registers cached */
+static int fall_through_end;         /* words of the block a branch may fall
+                                      * through to, 0 outside the main stream */
+/* delay slots a branch falling through compiled in line, compiled again on
+ * their own after the rest of the block for the jumps to them */
+static unsigned short deferred_slots[0x1000/4];
+static unsigned int deferred_number;
+
 static void RSV(void)
 {
    dst->ops = current_instruction_table.RESERVED;
@@ -2156,13 +2166,51 @@ static size_t get_block_memsize(const precomp_block *block)
   return ((length+1)+(length>>2)) * sizeof(precomp_instr);
 }
 
+/* length of the not-compiled stubs emitted by init_block, the stub of word i
+ * is at i * (init_length / length) */
+static int init_length;
+
+/* The block of the same physical page through the other one of kseg0 and
+ * kseg1, NULL for mapped pages or if it was never set up. */
+static precomp_block *get_mirror_block(const precomp_block *block)
+{
+   precomp_block *mirror;
+
+   if (block->start < UINT32_C(0x80000000) || block->start >= UINT32_C(0xc0000000))
+      return NULL;
+   mirror = blocks[(block->start ^ UINT32_C(0x20000000)) >> 12];
+   return mirror && mirror->block ? mirror : NULL;
+}
+
+/* Word i of 'block' is compiled in its mirror: a store to it through this
+ * segment must reach invalidate_code_word() too. The stores only call it
+ * for words whose ops aren't NOTCOMPILED, hence NOTCOMPILED2, as for the
+ * physical pages of TLB mapped code. */
+static void mark_mirror_word(precomp_block *block, unsigned int i)
+{
+   if (block->block[i].ops == current_instruction_table.NOTCOMPILED)
+      block->block[i].ops = current_instruction_table.NOTCOMPILED2;
+   block->code_map[i / 32] |= UINT32_C(1) << (i & 31);
+}
+
+static void mark_mirror_ranges(precomp_block *block)
+{
+   precomp_block *mirror = get_mirror_block(block);
+   int i, length = get_block_length(block);
+
+   if (!mirror || invalid_code[mirror->start >> 12])
+      return;
+   for (i = 0; i < length; i++)
+      if (mirror->range_start[i] != NO_RANGE)
+         mark_mirror_word(block, i);
+}
+
 /**********************************************************************
  ******************** initialize an empty block ***********************
  **********************************************************************/
 void init_block(precomp_block *block)
 {
   int i, length, already_exist = 1;
-  static int init_length;
   timed_section_start(TIMED_SECTION_COMPILER);
 #ifdef CORE_DBG
   DebugMessage(M64MSG_INFO, "init block %" PRIX32 " - %" PRIX32, block->start, block->end);
@@ -2245,6 +2293,14 @@ void init_block(precomp_block *block)
       dst->ops = current_instruction_table.NOTCOMPILED;
     }
   }
+
+  for (i=0; i<length; i++)
+    block->range_start[i] = NO_RANGE;
+  memset(block->code_map, 0, sizeof(block->code_map));
+  block->aliased = 0;
+  block->words_compiled = 0;
+  block->words_dropped = 0;
+  mark_mirror_ranges(block);
    
   if (r4300emu == CORE_DYNAREC)
   {
@@ -2328,13 +2384,100 @@ void free_block(precomp_block *block)
     if (block->riprel_table) { free(block->riprel_table); block->riprel_table = NULL; }
 }
 
+/* Puts the words of the range starting at 'start' back to their not-compiled
+ * stubs, except for those in [keep_first, keep_end). */
+static void reset_range(precomp_block *block, unsigned int start,
+      unsigned int keep_first, unsigned int keep_end)
+{
+   precomp_block *mirror = get_mirror_block(block);
+   unsigned int i, length = get_block_length(block);
+
+   for (i = start; i < length && block->range_start[i] == start; i++)
+   {
+      precomp_instr *instr = block->block + i;
+
+      if (i >= keep_first && i < keep_end)
+         continue;
+
+      instr->ops = current_instruction_table.NOTCOMPILED;
+      instr->local_addr = i * (init_length / length);
+      instr->reg_cache_infos.need_map = 0;
+      block->range_start[i] = NO_RANGE;
+      block->words_dropped++;
+      /* the TLB mapped code compiled from an aliased page isn't tracked by
+       * range, its words must stay marked */
+      if (block->aliased)
+         continue;
+      if (mirror && mirror->range_start[i] != NO_RANGE)
+         mark_mirror_word(block, i);
+      else
+         block->code_map[i / 32] &= ~(UINT32_C(1) << (i & 31));
+   }
+}
+
+/* Marks the words [first, end) as compiled by one range. Whatever is left of
+ * the older ranges it overlaps is dropped, so that the ranges stay disjoint
+ * and a store only has to drop the one holding the word. */
+static void mark_range(precomp_block *block, unsigned int first, unsigned int end)
+{
+   precomp_block *mirror = get_mirror_block(block);
+   unsigned int i;
+
+   for (i = first; i < end; i++)
+   {
+      unsigned int old = block->range_start[i];
+      if (old != NO_RANGE && old != first)
+         reset_range(block, old, first, end);
+   }
+
+   for (i = first; i < end; i++)
+   {
+      block->range_start[i] = first;
+      block->code_map[i / 32] |= UINT32_C(1) << (i & 31);
+      if (mirror && mirror->range_start[i] == NO_RANGE)
+         mark_mirror_word(mirror, i);
+   }
+   block->words_compiled += end - first;
+   smc_stats.bytes_recompiled += (end - first) * 4;
+}
+
+/* Drops the compiled range holding 'word', leaving the rest of the block
+ * compiled. */
+void invalidate_block_range(precomp_block *block, unsigned int word)
+{
+   reset_range(block, block->range_start[word], 0, 0);
+
+   if (r4300emu == CORE_DYNAREC)
+   {
+      /* the jumps of the other ranges into this one now go to the stubs */
+      code_length = block->code_length;
+      max_code_length = block->max_code_length;
+      inst_pointer = &block->code;
+      init_assembler(block->jumps_table, block->jumps_number, block->riprel_table, block->riprel_number);
+      passe2(block->block, 0, 0, block);
+      block->code_length = code_length;
+      block->max_code_length = max_code_length;
+      free_assembler(&block->jumps_table, &block->jumps_number, &block->riprel_table, &block->riprel_number);
+   }
+}
+
+/* A conditional branch may keep the registers cached through its delay slot
+ * and its not-taken path when the word after the delay slot is compiled
+ * right after it, in the same page. */
+int branch_can_fall_through(void)
+{
+   return dst - dst_block->block + 2 < fall_through_end;
+}
+
 /**********************************************************************
  ********************* recompile a block of code **********************
  **********************************************************************/
 void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func)
 {
-   uint32_t i;
+   uint32_t i, src_words;
    int length, finished=0;
+   /* code of the same words compiled before, only decoded then */
+   const struct codecache_record *cached = NULL;
    timed_section_start(TIMED_SECTION_COMPILER);
    length = (block->end-block->start)/4;
    dst_block = block;
@@ -2348,10 +2491,20 @@ void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func
     max_code_length = block->max_code_length;
     inst_pointer = &block->code;
     init_assembler(block->jumps_table, block->jumps_number, block->riprel_table, block->riprel_number);
+    cached = codecache_find(block, (func & 0xFFF) / 4, source);
+     }
+
+compile:
+   if (r4300emu == CORE_DYNAREC && cached == NULL)
+     {
     init_cache(block->block + (func & 0xFFF) / 4);
+    codecache_record_begin(block, (func & 0xFFF) / 4);
+    fall_through_end = length;
      }
+   fall_through = 0;
+   deferred_number = 0;
 
-   for (i = (func & 0xFFF) / 4; finished != 2; i++)
+   for (i = (func & 0xFFF) / 4, finished = 0; finished != 2; i++)
      {
     if(block->start < UINT32_C(0x80000000) || UINT32_C(block->start >= 0xc0000000))
       {
@@ -2359,6 +2512,9 @@ void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func
            virtual_to_physical_address(block->start + i*4, 0);
          if(blocks[address2>>12]->block[(address2&UINT32_C(0xFFF))/4].ops == current_instruction_table.NOTCOMPILED)
            blocks[address2>>12]->block[(address2&UINT32_C(0xFFF))/4].ops = current_instruction_table.NOTCOMPILED2;
+         blocks[address2>>12]->code_map[(address2&UINT32_C(0xFFF))/4/32] |=
+           UINT32_C(1) << (((address2&UINT32_C(0xFFF))/4) & 31);
+         blocks[address2>>12]->aliased = 1;
       }
     
     SRC = source + i;
@@ -2370,8 +2526,18 @@ void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func
     dst->local_addr = code_length;
     recomp_func = NULL;
     recomp_ops[((src >> 26) & 0x3F)]();
-    if (r4300emu == CORE_DYNAREC) recomp_func();
+    if (deferred_number && deferred_slots[deferred_number-1] == i)
+      {
+         /* the delay slot of the branch before, compiled below */
+      }
+    else if (r4300emu == CORE_DYNAREC && cached == NULL) recomp_func();
     dst = block->block + i;
+    if (fall_through)
+      {
+         fall_through = 0;
+         delay_slot_compiled = 0;
+         deferred_slots[deferred_number++] = i+1;
+      }
 
     /*if ((dst+1)->ops != NOTCOMPILED && !delay_slot_compiled &&
         i < length)
@@ -2399,6 +2565,10 @@ void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func
       finished = 1;
      }
 
+   mark_range(block, (func & 0xFFF) / 4, i < (uint32_t)length ? i : (uint32_t)length);
+   /* the last word decoded looked one word further */
+   src_words = i + 1 - (func & 0xFFF) / 4;
+
    if (i >= length)
      {
     dst = block->block + i;
@@ -2406,7 +2576,7 @@ void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func
     dst->reg_cache_infos.need_map = 0;
     dst->local_addr = code_length;
     RFIN_BLOCK();
-    if (r4300emu == CORE_DYNAREC) recomp_func();
+    if (r4300emu == CORE_DYNAREC && cached == NULL) recomp_func();
     i++;
     if (i < length-1+(length>>2)) // useful when last opcode is a jump
       {
@@ -2415,15 +2585,44 @@ void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func
          dst->reg_cache_infos.need_map = 0;
          dst->local_addr = code_length;
          RFIN_BLOCK();
-         if (r4300emu == CORE_DYNAREC) recomp_func();
+         if (r4300emu == CORE_DYNAREC && cached == NULL) recomp_func();
          i++;
       }
      }
-   else if (r4300emu == CORE_DYNAREC) genlink_subblock();
+   else if (r4300emu == CORE_DYNAREC && cached == NULL) genlink_subblock();
 
    if (r4300emu == CORE_DYNAREC)
      {
-    free_all_registers();
+    if (cached == NULL)
+      {
+         uint32_t k, n;
+
+         free_all_registers();
+         fall_through_end = 0;
+         for (n = 0; n < deferred_number; n++)
+           {
+              k = deferred_slots[n];
+              SRC = source + k;
+              src = source[k];
+              check_nop = source[k+1] == 0;
+              dst = block->block + k;
+              init_cache(dst);
+              simplify_access();
+              recomp_func = NULL;
+              recomp_ops[((src >> 26) & 0x3F)]();
+              recomp_func();
+              dst = block->block + k;
+              delay_slot_compiled = 0;
+              genlink_subblock();
+           }
+         codecache_record_end(block, i, source, src_words);
+      }
+    else if (!codecache_apply(cached, block, i))
+      {
+         /* not reached while the words match, nothing was generated yet */
+         cached = NULL;
+         goto compile;
+      }
     passe2(block->block, (func&0xFFF)/4, i, block);
     block->code_length = code_length;
     block->max_code_length = max_code_length;
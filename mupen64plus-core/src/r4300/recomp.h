@@ -86,11 +86,28 @@ typedef struct _precomp_block
    int riprel_number;
    //unsigned char md5[16];
    unsigned int adler32;
+   /* Compiled ranges, for sub-page invalidation of self-modifying code.
+    * range_start[i] is the first word of the range that compiled word i,
+    * NO_RANGE if none did. code_map has a bit set for every word whose
+    * modification must invalidate something, here or in the kseg0/kseg1
+    * mirror of the page. */
+   uint16_t range_start[0x1000/4];
+   uint32_t code_map[0x1000/4/32];
+   /* words compiled since init_block and words of them dropped since, the
+    * dynarec starts the block over once most of its code is dropped */
+   unsigned int words_compiled;
+   unsigned int words_dropped;
+   /* set when TLB mapped code was compiled from this page, which is then
+    * only invalidated as a whole */
+   int aliased;
 } precomp_block;
 
+#define NO_RANGE 0xFFFF
+
 void recompile_block(const uint32_t *source, precomp_block *block, uint32_t func);
 void init_block(precomp_block *block);
 void free_block(precomp_block *block);
+void invalidate_block_range(precomp_block *block, unsigned int word);
 void recompile_opcode(void);
 void dyna_jump(void);
 void dyna_start(void *code);
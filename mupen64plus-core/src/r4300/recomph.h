@@ -30,12 +30,17 @@ extern unsigned char **inst_pointer;
 extern precomp_block* dst_block;
 extern int fast_memory;
 extern uint32_t src;   /* opcode of r4300 instruction being recompiled */
+extern int fall_through; /* the branch just generated goes on with the next word when not taken */
+extern precomp_instr fake_instr; /* PC of the interrupt checks jumping out of the block */
+
+int branch_can_fall_through(void);
 
 void passe2(precomp_instr *dest, int start, int end, precomp_block* block);
 void init_assembler(void *block_jumps_table, int block_jumps_number, void *block_riprel_table, int block_riprel_number);
 void free_assembler(void **block_jumps_table, int *block_jumps_number, void **block_riprel_table, int *block_riprel_number);
 
 void gencallinterp(uintptr_t addr, int jump);
+void invalidate_code_at_address(void);
 
 void genupdate_system(int type);
 void genbnel(void);
@@ -19,6 +19,8 @@
  *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#include <string.h>
+
 #include "tlb.h"
 
 #include "api/m64p_types.h"
@@ -30,6 +32,50 @@ tlb tlb_e[32];
 uint32_t tlb_LUT_r[0x100000];
 uint32_t tlb_LUT_w[0x100000];
 
+struct tlb_cache_entry tlb_cache_r[TLB_CACHE_SIZE];
+struct tlb_cache_entry tlb_cache_w[TLB_CACHE_SIZE];
+
+void tlb_cache_flush(void)
+{
+    memset(tlb_cache_r, 0, sizeof(tlb_cache_r));
+    memset(tlb_cache_w, 0, sizeof(tlb_cache_w));
+}
+
+/* Drops the cached pages from start to end, the range of one half of a
+ * TLB entry. A large page covers more than the cache holds, then the
+ * tags are checked instead. */
+static void tlb_cache_invalidate(unsigned int start, unsigned int end)
+{
+    uint32_t first, last, page;
+
+    if (start >= end)
+        return;
+
+    first = start >> 12;
+    last  = (end - 1) >> 12;
+
+    if (last - first < TLB_CACHE_SIZE)
+    {
+        for (page = first; page <= last; page++)
+        {
+            if (tlb_cache_r[page & (TLB_CACHE_SIZE - 1)].tag == page + 1)
+                tlb_cache_r[page & (TLB_CACHE_SIZE - 1)].tag = 0;
+            if (tlb_cache_w[page & (TLB_CACHE_SIZE - 1)].tag == page + 1)
+                tlb_cache_w[page & (TLB_CACHE_SIZE - 1)].tag = 0;
+        }
+    }
+    else
+    {
+        for (page = 0; page < TLB_CACHE_SIZE; page++)
+        {
+            if (tlb_cache_r[page].tag - 1 - first <= last - first)
+                tlb_cache_r[page].tag = 0;
+            if (tlb_cache_w[page].tag - 1 - first <= last - first)
+                tlb_cache_w[page].tag = 0;
+        }
+    }
+}
+
 void tlb_unmap(tlb *entry)
 {
     unsigned int i;
@@ -41,6 +87,7 @@ void tlb_unmap(tlb *entry)
         if (entry->d_even)
             for (i=entry->start_even; i<entry->end_even; i += 0x1000)
                 tlb_LUT_w[i>>12] = 0;
+        tlb_cache_invalidate(entry->start_even, entry->end_even);
     }
 
     if (entry->v_odd)
@@ -50,6 +97,7 @@ void tlb_unmap(tlb *entry)
         if (entry->d_odd)
             for (i=entry->start_odd; i<entry->end_odd; i += 0x1000)
                 tlb_LUT_w[i>>12] = 0;
+        tlb_cache_invalidate(entry->start_odd, entry->end_odd);
     }
 }
 
@@ -68,6 +116,7 @@ void tlb_map(tlb *entry)
             if (entry->d_even)
                 for (i=entry->start_even;i<entry->end_even;i+=0x1000)
                     tlb_LUT_w[i>>12] = UINT32_C(0x80000000) | (entry->phys_even + (i - entry->start_even) + 0xFFF);
+            tlb_cache_invalidate(entry->start_even, entry->end_even);
         }
     }
 
@@ -82,6 +131,7 @@ void tlb_map(tlb *entry)
             if (entry->d_odd)
                 for (i=entry->start_odd;i<entry->end_odd;i+=0x1000)
                     tlb_LUT_w[i>>12] = UINT32_C(0x80000000) | (entry->phys_odd + (i - entry->start_odd) + 0xFFF);
+            tlb_cache_invalidate(entry->start_odd, entry->end_odd);
         }
     }
 }
@@ -53,6 +53,27 @@ extern tlb tlb_e[32];
 extern uint32_t tlb_LUT_r[0x100000];
 extern uint32_t tlb_LUT_w[0x100000];
 
+/* Direct-mapped cache of the last mapped pages that hit RDRAM, indexed by
+ * the low bits of the virtual page. tag is the virtual page + 1 (0 is an
+ * empty slot), phys the physical page address and host the RDRAM word it
+ * starts at. Filled by the memory handlers of the mapped segments.
+ * tlb_map() and tlb_unmap() drop the pages of the entry they change; the
+ * whole cache is flushed on reset, savestate load and when the RDRAM
+ * handlers change. */
+#define TLB_CACHE_SIZE 256
+
+struct tlb_cache_entry
+{
+   uint32_t tag;
+   uint32_t phys;
+   uint32_t *host;
+};
+
+extern struct tlb_cache_entry tlb_cache_r[TLB_CACHE_SIZE];
+extern struct tlb_cache_entry tlb_cache_w[TLB_CACHE_SIZE];
+
+void tlb_cache_flush(void);
+
 void tlb_unmap(tlb *entry);
 void tlb_map(tlb *entry);
 uint32_t virtual_to_physical_address(uint32_t addresse, int w);
@@ -26,6 +26,8 @@
 #include "../r4300/r4300_core.h"
 #include "../rsp/rsp_core.h"
 
+#include "libretro_perf.h"
+
 #include <string.h>
 
 static int update_dpc_status(struct rdp_core* dp, uint32_t w)
@@ -94,6 +96,7 @@ int write_dpc_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mask
 {
    struct rdp_core* dp = (struct rdp_core*)opaque;
    uint32_t reg        = DPC_REG(address);
+   RETRO_PERFORMANCE_INIT(perf_cb, perf_rdp);
 
    switch(reg)
    {
@@ -116,7 +119,9 @@ int write_dpc_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mask
          dp->dpc_regs[DPC_CURRENT_REG] = dp->dpc_regs[DPC_START_REG];
          break;
       case DPC_END_REG:
+         RETRO_PERFORMANCE_START(perf_cb, perf_rdp);
          gfx.processRDPList();
+         RETRO_PERFORMANCE_STOP(perf_cb, perf_rdp);
          signal_rcp_interrupt(dp->r4300, MI_INTR_DP);
          break;
    }
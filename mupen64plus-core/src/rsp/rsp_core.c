@@ -29,6 +29,8 @@
 #include "../rdp/rdp_core.h"
 #include "../ri/ri_controller.h"
 
+#include "libretro_perf.h"
+
 #include <stdio.h>
 #include <string.h>
 
@@ -259,6 +261,7 @@ int write_rsp_regs2(void* opaque, uint32_t address, uint32_t value, uint32_t mas
 void do_SP_Task(struct rsp_core* sp)
 {
     uint32_t save_pc = sp->regs2[SP_PC_REG] & ~0xfff;
+    RETRO_PERFORMANCE_INIT(perf_cb, perf_rsp);
 
     if (sp->mem[0xfc0/4] == 1)
     {
@@ -274,7 +277,9 @@ void do_SP_Task(struct rsp_core* sp)
 
         sp->regs2[SP_PC_REG] &= 0xfff;
         timed_section_start(TIMED_SECTION_GFX);
+        RETRO_PERFORMANCE_START(perf_cb, perf_rsp);
         rsp.doRspCycles(0xffffffff);
+        RETRO_PERFORMANCE_STOP(perf_cb, perf_rsp);
         timed_section_end(TIMED_SECTION_GFX);
         sp->regs2[SP_PC_REG] |= save_pc;
         new_frame();
@@ -294,7 +299,9 @@ void do_SP_Task(struct rsp_core* sp)
        /* Audio List */
         sp->regs2[SP_PC_REG] &= 0xfff;
         timed_section_start(TIMED_SECTION_AUDIO);
+        RETRO_PERFORMANCE_START(perf_cb, perf_rsp);
         rsp.doRspCycles(0xffffffff);
+        RETRO_PERFORMANCE_STOP(perf_cb, perf_rsp);
         timed_section_end(TIMED_SECTION_AUDIO);
         sp->regs2[SP_PC_REG] |= save_pc;
 
@@ -308,7 +315,9 @@ void do_SP_Task(struct rsp_core* sp)
     {
        /* Unknown list */
         sp->regs2[SP_PC_REG] &= 0xfff;
+        RETRO_PERFORMANCE_START(perf_cb, perf_rsp);
         rsp.doRspCycles(0xffffffff);
+        RETRO_PERFORMANCE_STOP(perf_cb, perf_rsp);
         sp->regs2[SP_PC_REG] |= save_pc;
 
         cp0_update_count();
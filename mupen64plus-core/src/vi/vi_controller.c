@@ -27,6 +27,8 @@
 #include "r4300/r4300_core.h"
 #include "r4300/interupt.h"
 
+#include "libretro_perf.h"
+
 #include <string.h>
 
 extern unsigned alternate_vi_timing;
@@ -105,7 +107,11 @@ int write_vi_regs(void* opaque, uint32_t address,
 
 void vi_vertical_interrupt_event(struct vi_controller* vi)
 {
+   RETRO_PERFORMANCE_INIT(perf_cb, perf_vi);
+
+   RETRO_PERFORMANCE_START(perf_cb, perf_vi);
    gfx.updateScreen();
+   RETRO_PERFORMANCE_STOP(perf_cb, perf_vi);
 
    /* allow main module to do things on VI event */
    new_vi();
@@ -1,4 +1,5 @@
 #include <stdarg.h>
+#include <stddef.h>
 #include <string.h>
 
 
@@ -7,6 +8,7 @@
 #include "tctables.h"
 #include "vi.h"
 #include "rdp.h"
+#include "workers.h"
 
 #if 0
 #define EXTRALOGGING
@@ -135,56 +137,261 @@ static int render_cycle_mode_counts[4];
 
 int32_t irand(void);
 
-static int8_t get_dither_noise_type;
-static int scfield;
-static int sckeepodd;
-
-static int ti_format;
-static int ti_size;
-static int ti_width;
-static uint32_t ti_address;
-
-static int fb_format;
-static int fb_size;
-static int fb_width;
-static uint32_t fb_address;
-static uint32_t zb_address;
-
-static uint32_t max_level;
-static int32_t min_level;
-static int16_t primitive_lod_frac;
-
-static uint32_t primitive_z;
-static uint16_t primitive_delta_z;
-
-static uint32_t fill_color;
-
-static int16_t *combiner_rgbsub_a_r[2];
-static int16_t *combiner_rgbsub_a_g[2];
-static int16_t *combiner_rgbsub_a_b[2];
-static int16_t *combiner_rgbsub_b_r[2];
-static int16_t *combiner_rgbsub_b_g[2];
-static int16_t *combiner_rgbsub_b_b[2];
-static int16_t *combiner_rgbmul_r[2];
-static int16_t *combiner_rgbmul_g[2];
-static int16_t *combiner_rgbmul_b[2];
-static int16_t *combiner_rgbadd_r[2];
-static int16_t *combiner_rgbadd_g[2];
-static int16_t *combiner_rgbadd_b[2];
-
-static int16_t *combiner_alphasub_a[2];
-static int16_t *combiner_alphasub_b[2];
-static int16_t *combiner_alphamul[2];
-static int16_t *combiner_alphaadd[2];
-
-static int16_t *blender1a_r[2];
-static int16_t *blender1a_g[2];
-static int16_t *blender1a_b[2];
-static int16_t *blender1b_a[2];
-static int16_t *blender2a_r[2];
-static int16_t *blender2a_g[2];
-static int16_t *blender2a_b[2];
-static int16_t *blender2b_a[2];
+/* What the commands set and the rasterizer works on. rdp points to the
+ * state of the running thread: the first one runs the commands, the
+ * parallel rasterizer's workers draw its tiles on the others, see
+ * draw_tile(). The macros after the struct keep the names these had as
+ * globals. */
+typedef struct
+{
+    int8_t get_dither_noise_type;
+    int scfield;
+    int sckeepodd;
+
+    int ti_format;
+    int ti_size;
+    int ti_width;
+    uint32_t ti_address;
+
+    int fb_format;
+    int fb_size;
+    int fb_width;
+    uint32_t fb_address;
+    uint32_t zb_address;
+
+    uint32_t max_level;
+    int32_t min_level;
+    int16_t primitive_lod_frac;
+
+    uint32_t primitive_z;
+    uint16_t primitive_delta_z;
+
+    uint32_t fill_color;
+
+    int16_t *combiner_rgbsub_a_r[2];
+    int16_t *combiner_rgbsub_a_g[2];
+    int16_t *combiner_rgbsub_a_b[2];
+    int16_t *combiner_rgbsub_b_r[2];
+    int16_t *combiner_rgbsub_b_g[2];
+    int16_t *combiner_rgbsub_b_b[2];
+    int16_t *combiner_rgbmul_r[2];
+    int16_t *combiner_rgbmul_g[2];
+    int16_t *combiner_rgbmul_b[2];
+    int16_t *combiner_rgbadd_r[2];
+    int16_t *combiner_rgbadd_g[2];
+    int16_t *combiner_rgbadd_b[2];
+
+    int16_t *combiner_alphasub_a[2];
+    int16_t *combiner_alphasub_b[2];
+    int16_t *combiner_alphamul[2];
+    int16_t *combiner_alphaadd[2];
+
+    int16_t *blender1a_r[2];
+    int16_t *blender1a_g[2];
+    int16_t *blender1a_b[2];
+    int16_t *blender1b_a[2];
+    int16_t *blender2a_r[2];
+    int16_t *blender2a_g[2];
+    int16_t *blender2a_b[2];
+    int16_t *blender2b_a[2];
+
+    int32_t k0_tf, k1_tf, k2_tf, k3_tf;
+    int16_t k4, k5;
+
+    TILE tile[8];
+
+    OTHER_MODES other_modes;
+    COMBINE_MODES combine;
+
+    COLOR key_width;
+    COLOR key_scale;
+    COLOR key_center;
+    COLOR fog_color;
+    COLOR blend_color;
+    COLOR prim_color;
+    COLOR env_color;
+
+    RECTANGLE __clip;
+
+    void (*fbread1_ptr)(uint32_t, uint32_t*);
+    void (*fbread2_ptr)(uint32_t, uint32_t*);
+    void (*fbwrite_ptr)(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+
+    void (*render_spans_1cycle_ptr)(int, int, int, int);
+    void (*render_spans_2cycle_ptr)(int start, int end, int tilenum, int flip);
+
+    /* The modes end here, what follows the primitives work out. */
+    int blshifta, blshiftb, pastblshifta, pastblshiftb;
+    int32_t pastrawdzmem;
+
+    SPAN span[1024];
+    uint8_t cvgbuf[1024];
+
+    int32_t spans_d_rgba[4];
+    int32_t spans_d_stwz[4];
+    uint16_t spans_dzpix;
+
+    int32_t spans_d_rgba_dy[4];
+    int32_t spans_cd_rgba[4];
+    int spans_cdz;
+
+    int32_t spans_d_stwz_dy[4];
+
+    COLOR combined_color;
+    COLOR texel0_color;
+    COLOR texel1_color;
+    COLOR nexttexel_color;
+    COLOR shade_color;
+    int16_t noise;
+
+    COLOR pixel_color;
+    COLOR inv_pixel_color;
+    COLOR blended_pixel_color;
+    COLOR memory_color;
+    COLOR pre_memory_color;
+
+    int16_t lod_frac;
+
+    uint8_t __TMEM[0x1000];
+
+    int cmd_cur;
+
+    RECTANGLE window;       /* pixels drawn, inclusive: a tile, or all */
+    int tiled;              /* drawing a tile, see rdp_tiled */
+    uint32_t noise_prim;    /* primitive count, for the noise seeds */
+    uint32_t noise_seed;    /* rdp_rand()'s */
+
+    int modes_snapshot;     /* loaded by draw_tile(), -1 for none */
+    int tmem_snapshot;
+} RDP_STATE;
+
+/* The modes, copied into the workers' states */
+enum { RDP_MODES_SIZE = offsetof(RDP_STATE, blshifta) };
+
+/* The first state and one for each worker of the parallel rasterizer */
+static RDP_STATE rdp_states[1 + WORKERS_MAX];
+
+/* Each worker draws its tiles with its own state. In a shared library every
+ * function using a thread-local pointer looks it up, which makes the serial
+ * rasterizer 20 to 30% slower, so it is only built in with
+ * HAVE_ANGRYLION_TILES.
+ *
+ * rdp_tiled is whether the current state draws a tile. The pixel pipeline
+ * then starts over at the tile's edges and the noise is seeded by position,
+ * so that a tile doesn't depend on the pixels before it. The serial
+ * rasterizer, and the primitives the parallel one leaves to it, run as
+ * they always have. */
+#ifdef HAVE_ANGRYLION_TILES
+static __thread RDP_STATE* rdp = &rdp_states[0];
+#define rdp_tiled (rdp->tiled)
+#else
+static RDP_STATE* rdp = &rdp_states[0];
+#define rdp_tiled 0
+#endif
+
+/* The parallel rasterizer bins the primitives by tiles of RDP_TILE_SIZE
+ * pixels square, 1024 pixels across at most. */
+#define RDP_TILE_SHIFT 6
+#define RDP_TILE_SIZE  (1 << RDP_TILE_SHIFT)
+#define RDP_TILES_WIDE (1024 >> RDP_TILE_SHIFT)
+#define RDP_TILES      (RDP_TILES_WIDE * RDP_TILES_WIDE)
+
+static int rdp_parallel;
+static int rdp_workers = 1; /* 1 while the parallel rasterizer is off */
+
+#define get_dither_noise_type   (rdp->get_dither_noise_type)
+#define scfield                 (rdp->scfield)
+#define sckeepodd               (rdp->sckeepodd)
+#define ti_format               (rdp->ti_format)
+#define ti_size                 (rdp->ti_size)
+#define ti_width                (rdp->ti_width)
+#define ti_address              (rdp->ti_address)
+#define fb_format               (rdp->fb_format)
+#define fb_size                 (rdp->fb_size)
+#define fb_width                (rdp->fb_width)
+#define fb_address              (rdp->fb_address)
+#define zb_address              (rdp->zb_address)
+#define max_level               (rdp->max_level)
+#define min_level               (rdp->min_level)
+#define primitive_lod_frac      (rdp->primitive_lod_frac)
+#define primitive_z             (rdp->primitive_z)
+#define primitive_delta_z       (rdp->primitive_delta_z)
+#define fill_color              (rdp->fill_color)
+#define combiner_rgbsub_a_r     (rdp->combiner_rgbsub_a_r)
+#define combiner_rgbsub_a_g     (rdp->combiner_rgbsub_a_g)
+#define combiner_rgbsub_a_b     (rdp->combiner_rgbsub_a_b)
+#define combiner_rgbsub_b_r     (rdp->combiner_rgbsub_b_r)
+#define combiner_rgbsub_b_g     (rdp->combiner_rgbsub_b_g)
+#define combiner_rgbsub_b_b     (rdp->combiner_rgbsub_b_b)
+#define combiner_rgbmul_r       (rdp->combiner_rgbmul_r)
+#define combiner_rgbmul_g       (rdp->combiner_rgbmul_g)
+#define combiner_rgbmul_b       (rdp->combiner_rgbmul_b)
+#define combiner_rgbadd_r       (rdp->combiner_rgbadd_r)
+#define combiner_rgbadd_g       (rdp->combiner_rgbadd_g)
+#define combiner_rgbadd_b       (rdp->combiner_rgbadd_b)
+#define combiner_alphasub_a     (rdp->combiner_alphasub_a)
+#define combiner_alphasub_b     (rdp->combiner_alphasub_b)
+#define combiner_alphamul       (rdp->combiner_alphamul)
+#define combiner_alphaadd       (rdp->combiner_alphaadd)
+#define blender1a_r             (rdp->blender1a_r)
+#define blender1a_g             (rdp->blender1a_g)
+#define blender1a_b             (rdp->blender1a_b)
+#define blender1b_a             (rdp->blender1b_a)
+#define blender2a_r             (rdp->blender2a_r)
+#define blender2a_g             (rdp->blender2a_g)
+#define blender2a_b             (rdp->blender2a_b)
+#define blender2b_a             (rdp->blender2b_a)
+#define k0_tf                   (rdp->k0_tf)
+#define k1_tf                   (rdp->k1_tf)
+#define k2_tf                   (rdp->k2_tf)
+#define k3_tf                   (rdp->k3_tf)
+#define k4                      (rdp->k4)
+#define k5                      (rdp->k5)
+#define tile                    (rdp->tile)
+#define other_modes             (rdp->other_modes)
+#define combine                 (rdp->combine)
+#define key_width               (rdp->key_width)
+#define key_scale               (rdp->key_scale)
+#define key_center              (rdp->key_center)
+#define fog_color               (rdp->fog_color)
+#define blend_color             (rdp->blend_color)
+#define prim_color              (rdp->prim_color)
+#define env_color               (rdp->env_color)
+#define __clip                  (rdp->__clip)
+#define fbread1_ptr             (rdp->fbread1_ptr)
+#define fbread2_ptr             (rdp->fbread2_ptr)
+#define fbwrite_ptr             (rdp->fbwrite_ptr)
+#define blshifta                (rdp->blshifta)
+#define blshiftb                (rdp->blshiftb)
+#define pastblshifta            (rdp->pastblshifta)
+#define pastblshiftb            (rdp->pastblshiftb)
+#define pastrawdzmem            (rdp->pastrawdzmem)
+#define span                    (rdp->span)
+#define cvgbuf                  (rdp->cvgbuf)
+#define spans_d_rgba            (rdp->spans_d_rgba)
+#define spans_d_stwz            (rdp->spans_d_stwz)
+#define spans_dzpix             (rdp->spans_dzpix)
+#define spans_d_rgba_dy         (rdp->spans_d_rgba_dy)
+#define spans_cd_rgba           (rdp->spans_cd_rgba)
+#define spans_cdz               (rdp->spans_cdz)
+#define spans_d_stwz_dy         (rdp->spans_d_stwz_dy)
+#define combined_color          (rdp->combined_color)
+#define texel0_color            (rdp->texel0_color)
+#define texel1_color            (rdp->texel1_color)
+#define nexttexel_color         (rdp->nexttexel_color)
+#define shade_color             (rdp->shade_color)
+#define noise                   (rdp->noise)
+#define pixel_color             (rdp->pixel_color)
+#define inv_pixel_color         (rdp->inv_pixel_color)
+#define blended_pixel_color     (rdp->blended_pixel_color)
+#define memory_color            (rdp->memory_color)
+#define pre_memory_color        (rdp->pre_memory_color)
+#define __TMEM                  (rdp->__TMEM)
+#define lod_frac                (rdp->lod_frac)
+#define render_spans_1cycle_ptr (rdp->render_spans_1cycle_ptr)
+#define render_spans_2cycle_ptr (rdp->render_spans_2cycle_ptr)
+#define cmd_cur                 (rdp->cmd_cur)
+#define window                  (rdp->window)
 
 #define COLOR_RED(val)       (val.col[0])
 #define COLOR_GREEN(val)     (val.col[1])
@@ -200,28 +407,8 @@ static int16_t *blender2b_a[2];
 #define TRELATIVE(x, y) 	((x) - ((y) << 3))
 #define UPPER ((sfrac + tfrac) & 0x20)
 
-static int32_t k0_tf = 0, k1_tf = 0, k2_tf = 0, k3_tf = 0;
-static int16_t k4 = 0, k5 = 0;
-
-static TILE tile[8];
-
-static OTHER_MODES other_modes;
-static COMBINE_MODES combine;
-
-static COLOR key_width;
-static COLOR key_scale;
-static COLOR key_center;
-static COLOR fog_color;
-static COLOR blend_color;
-static COLOR prim_color;
-static COLOR env_color;
-
 static int rdp_pipeline_crashed;
 
-static RECTANGLE __clip = {
-    0, 0, 0x2000, 0x2000
-};
-
 static void fbread_4(uint32_t num, uint32_t* curpixel_memcvg);
 static void fbread_8(uint32_t num, uint32_t* curpixel_memcvg);
 static void fbread_16(uint32_t num, uint32_t* curpixel_memcvg);
@@ -238,10 +425,6 @@ static void (*fbread2_func[4])(uint32_t, uint32_t*) = {
     fbread2_4, fbread2_8, fbread2_16, fbread2_32
 };
 
-void (*fbread1_ptr)(uint32_t, uint32_t*);
-void (*fbread2_ptr)(uint32_t, uint32_t*);
-void (*fbwrite_ptr)(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
-
 #define PAIRWRITE16(in, rval, hval) {            \
    (in) &= (RDRAM_MASK >> 1);	                   \
     if ((in) <= idxlim16) {                      \
@@ -270,23 +453,8 @@ uint32_t internal_vi_v_current_line = 0;
 uint32_t old_vi_origin = 0;
 uint32_t oldhstart = 0;
 uint32_t oldsomething = 0;
-int blshifta = 0, blshiftb = 0, pastblshifta = 0, pastblshiftb = 0;
-int32_t pastrawdzmem = 0;
 int32_t iseed = 1;
 
-static SPAN span[1024];
-uint8_t cvgbuf[1024];
-
-static int32_t spans_d_rgba[4];
-static int32_t spans_d_stwz[4];
-static uint16_t spans_dzpix;
-
-static int32_t spans_d_rgba_dy[4];
-static int32_t spans_cd_rgba[4];
-static int spans_cdz;
-
-static int32_t spans_d_stwz_dy[4];
-
 typedef struct
 {
     int tilenum;
@@ -308,27 +476,13 @@ typedef struct
 #define ZMODE_TRANSPARENT        2
 #define ZMODE_DECAL                3
 
-COLOR combined_color;
-COLOR texel0_color;
-COLOR texel1_color;
-COLOR nexttexel_color;
-COLOR shade_color;
-static int16_t noise = 0;
 static int16_t one_color = 0x100;
 static int16_t zero_color = 0x00;
 
 static int16_t blenderone    = 0xff;
 
-COLOR pixel_color;
-COLOR inv_pixel_color;
-COLOR blended_pixel_color;
-COLOR memory_color;
-COLOR pre_memory_color;
-
 int oldscyl = 0;
 
-uint8_t __TMEM[0x1000]; 
-
 #define tlut ((uint16_t*)(&__TMEM[0x800]))
 
 #define PIXELS_TO_BYTES(pix, siz) (((pix) << (siz)) >> 1)
@@ -343,7 +497,6 @@ typedef struct{
     int onelessthanmid;
 }SPANSIGS;
 
-static int16_t lod_frac = 0;
 struct {uint32_t shift; uint32_t add;} z_dec_table[8] = {
      6, 0x00000,
      5, 0x20000,
@@ -374,10 +527,6 @@ static void (*render_spans_2cycle_func[4])(int, int, int, int) =
     render_spans_2cycle_notex, render_spans_2cycle_notexel1, render_spans_2cycle_notexelnext, render_spans_2cycle_complete
 };
 
-static void (*render_spans_1cycle_ptr)(int, int, int, int);
-
-static void (*render_spans_2cycle_ptr)(int start, int end, int tilenum, int flip);
-
 uint16_t z_com_table[0x40000];
 uint32_t z_complete_dec_table[0x4000];
 uint8_t replicated_rgba[32];
@@ -1099,6 +1248,17 @@ void rdp_init(void)
 {
     int i;
 
+    rdp_workers = 1; /* until rdp_flush() starts the workers */
+    window.xh = -0x1000; /* all of the clip, and past it on either side */
+    window.yh = -0x1000;
+    window.xl = 0xFFF;
+    window.yl = 0xFFF;
+    rdp->noise_prim = 0;
+    __clip.xh = 0;
+    __clip.yh = 0;
+    __clip.xl = 0x2000;
+    __clip.yl = 0x2000;
+
     fbread1_ptr = fbread_func[0];
     fbread2_ptr = fbread2_func[0];
     fbwrite_ptr = fbwrite_func[0];
@@ -1490,6 +1650,33 @@ static INLINE void SET_MUL_ALPHA_INPUT(int16_t **input, int code)
     }
 }
 
+/* In a tile the rasterizer's noise is irand()'s generator, restarted at
+ * every pixel from a hash of its position and of the primitive drawing it,
+ * so that it doesn't depend on the order the pixels are drawn in. Else it
+ * is irand() itself. */
+static STRICTINLINE void rdp_seed_noise(int x, int y)
+{
+    uint32_t seed;
+
+    if (!rdp_tiled)
+        return;
+
+    seed = (uint32_t)x * 0x9E3779B1 ^ (uint32_t)y * 0x85EBCA77 ^ rdp->noise_prim * 0xC2B2AE3D;
+    seed ^= seed >> 15;
+    seed *= 0x2C1B3C6D;
+    rdp->noise_seed = seed ^ (seed >> 12);
+}
+
+static STRICTINLINE int32_t rdp_rand(void)
+{
+    if (!rdp_tiled)
+        return irand();
+
+    rdp->noise_seed *= 0x343fd;
+    rdp->noise_seed += 0x269ec3;
+    return ((rdp->noise_seed >> 16) & 0x7fff);
+}
+
 static STRICTINLINE int alpha_compare(int32_t comb_alpha)
 {
     int32_t threshold;
@@ -1501,7 +1688,7 @@ static STRICTINLINE int alpha_compare(int32_t comb_alpha)
         if (!other_modes.dither_alpha_en)
             threshold = COLOR_ALPHA(blend_color);
         else
-            threshold = irand() & 0xff;
+            threshold = rdp_rand() & 0xff;
         if (comb_alpha >= threshold)
             return 1;
         else
@@ -4417,12 +4604,13 @@ static uint32_t z_compare(uint32_t zcurpixel, uint32_t sz, uint16_t dzpix, int d
 
 static void get_dither_noise(int x, int y, int* cdith, int* adith)
 {
+   rdp_seed_noise(x, y);
    if (get_dither_noise_type < 2)
    {
       int dithindex = ((y & 3) << 2) | (x & 3);
 
       if (!get_dither_noise_type)
-         noise = ((irand() & 7) << 6) | 0x20;
+         noise = ((rdp_rand() & 7) << 6) | 0x20;
 
       switch(other_modes.f.rgb_alpha_dither)
       {
@@ -4457,19 +4645,19 @@ static void get_dither_noise(int x, int y, int* cdith, int* adith)
             *adith = 0;
             break;
          case 8:
-            *cdith = irand();
+            *cdith = rdp_rand();
             *adith = magic_matrix[dithindex];
             break;
          case 9:
-            *cdith = irand();
+            *cdith = rdp_rand();
             *adith = (~magic_matrix[dithindex]) & 7;
             break;
          case 10:
-            *cdith = irand();
+            *cdith = rdp_rand();
             *adith = (noise >> 6) & 7;
             break;
          case 11:
-            *cdith = irand();
+            *cdith = rdp_rand();
             *adith = 0;
             break;
          case 12:
@@ -5029,6 +5217,43 @@ static void rgbaz_correct_clip(int offx, int offy, int r, int g, int b, int a,
     *z &= 0x3FFFF;
 }
 
+/* The pixels j = first to *last of a span starting at xendsc which are in
+ * the state's window; none if first > *last. */
+static STRICTINLINE int span_window(int xendsc, int length, int flip, int* last)
+{
+    int first;
+
+    if (flip)
+    {
+        first = window.xh - xendsc;
+        *last = window.xl - xendsc;
+    }
+    else
+    {
+        first = xendsc - window.xl;
+        *last = xendsc - window.xh;
+    }
+    if (*last > length)
+        *last = length;
+    return (first < 0) ? 0 : first;
+}
+
+/* Whether the pixel at x, j into its span, is the first one drawn of its
+ * span or of its column of tiles, in a tile. The pipeline then starts over,
+ * with restart_pixel_pipeline(), instead of going on from the pixel before
+ * it, which only the state drawing the previous tile would have. */
+#define PIXEL_PIPELINE_RESTARTS(x, j, first, flip) \
+    (rdp_tiled && ((j) == (first) || ((x) & (RDP_TILE_SIZE - 1)) == ((flip) ? 0 : RDP_TILE_SIZE - 1)))
+
+static STRICTINLINE void restart_pixel_pipeline(void)
+{
+    memset(&combined_color, 0, sizeof(COLOR));
+    memset(&pixel_color, 0, sizeof(COLOR));
+    memset(&blended_pixel_color, 0, sizeof(COLOR));
+    lod_frac = 0;
+    pastrawdzmem = 0xf;
+}
+
 static void render_spans_1cycle_complete(int start, int end, int tilenum, int flip)
 {
     uint8_t offx, offy;
@@ -5055,9 +5280,10 @@ static void render_spans_1cycle_complete(int start, int end, int tilenum, int fl
     int sr, sg, sb, sa, sz, ss, st, sw;
     int xstart, xend, xendsc;
     int sss = 0, sst = 0;
-    int32_t prelodfrac;
+    int32_t prelodfrac = 0;
     int curpixel = 0;
     int x, length, scdiff;
+    int first, last, skip;
     uint32_t fir, fig, fib;
 
     if (flip)
@@ -5121,14 +5347,19 @@ static void render_spans_1cycle_complete(int start, int end, int tilenum, int fl
         {
             length = xendsc - xstart;
             scdiff = xend - xendsc;
-            compute_cvg_noflip(i);
         }
         else
         {
             length = xstart - xendsc;
             scdiff = xendsc - xend;
-            compute_cvg_flip(i);
         }
+        first = span_window(xendsc, length, flip, &last);
+        if (first > last)
+            continue;
+        if (!flip)
+            compute_cvg_noflip(i);
+        else
+            compute_cvg_flip(i);
         sigs.longspan = (length > 7);
         sigs.midspan = (length == 7);
         sigs.onelessthanmid = (length == 6);
@@ -5145,10 +5376,32 @@ static void render_spans_1cycle_complete(int start, int end, int tilenum, int fl
             t += (dtinc * scdiff);
             w += (dwinc * scdiff);
         }
-        sigs.startspan = 1;
 
-        for (j = 0; j <= length; j++)
+        /* From the window's first pixel on, or from the one before it, which
+         * fetches the texels of the first */
+        skip = first ? first - 1 : 0;
+        if (skip)
+        {
+            r += drinc * skip;
+            g += dginc * skip;
+            b += dbinc * skip;
+            a += dainc * skip;
+            z += dzinc * skip;
+            s += dsinc * skip;
+            t += dtinc * skip;
+            w += dwinc * skip;
+            x += xinc * skip;
+            curpixel += xinc * skip;
+            zbcur += xinc * skip;
+            zbcur &= 0x00FFFFFF >> 1;
+        }
+        sigs.startspan = !skip;
+
+        for (j = skip; j <= last; j++)
         {
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                restart_pixel_pipeline();
+
             sr = r >> 14;
             sg = g >> 14;
             sb = b >> 14;
@@ -5190,6 +5443,8 @@ static void render_spans_1cycle_complete(int start, int end, int tilenum, int fl
             tclod_1cycle_next(&news, &newt, s, t, w, dsinc, dtinc, dwinc, i, prim_tile, &newtile, &sigs, &prelodfrac);
 
             texture_pipeline_cycle(&texel1_color, &texel1_color, news, newt, newtile, 0);
+            if (j < first)
+                goto next_pixel;
 
             rgbaz_correct_clip(offx, offy, sr, sg, sb, sa, &sz, curpixel_cvg);
             LOG("SZ = %d\n", sz);
@@ -5205,6 +5460,7 @@ static void render_spans_1cycle_complete(int start, int end, int tilenum, int fl
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
+next_pixel:
             r += drinc;
             g += dginc;
             b += dbinc;
@@ -5245,6 +5501,7 @@ static void render_spans_1cycle_notexel1(int start, int end, int tilenum, int fl
     int sss = 0, sst = 0;
     int curpixel = 0;
     int x, length, scdiff;
+    int first, last, skip;
     uint32_t fir, fig, fib;
 
     if (flip)
@@ -5308,14 +5565,19 @@ static void render_spans_1cycle_notexel1(int start, int end, int tilenum, int fl
         {
             length = xendsc - xstart;
             scdiff = xend - xendsc;
-            compute_cvg_noflip(i);
         }
         else
         {
             length = xstart - xendsc;
             scdiff = xendsc - xend;
-            compute_cvg_flip(i);
         }
+        first = span_window(xendsc, length, flip, &last);
+        if (first > last)
+            continue;
+        if (!flip)
+            compute_cvg_noflip(i);
+        else
+            compute_cvg_flip(i);
 
         sigs.longspan = (length > 7);
         sigs.midspan = (length == 7);
@@ -5333,8 +5595,28 @@ static void render_spans_1cycle_notexel1(int start, int end, int tilenum, int fl
             w += (dwinc * scdiff);
         }
 
-        for (j = 0; j <= length; j++)
+        skip = first; /* to the window's first pixel */
+        if (skip)
+        {
+            r += drinc * skip;
+            g += dginc * skip;
+            b += dbinc * skip;
+            a += dainc * skip;
+            z += dzinc * skip;
+            s += dsinc * skip;
+            t += dtinc * skip;
+            w += dwinc * skip;
+            x += xinc * skip;
+            curpixel += xinc * skip;
+            zbcur += xinc * skip;
+            zbcur &= 0x00FFFFFF >> 1;
+        }
+
+        for (j = skip; j <= last; j++)
         {
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                restart_pixel_pipeline();
+
             sr = r >> 14;
             sg = g >> 14;
             sb = b >> 14;
@@ -5426,6 +5708,7 @@ static void render_spans_1cycle_notex(int start, int end, int tilenum, int flip)
     int xstart, xend, xendsc;
     int curpixel = 0;
     int x, length, scdiff;
+    int first, last, skip;
     uint32_t fir, fig, fib;
 
     if (flip)
@@ -5480,14 +5763,19 @@ static void render_spans_1cycle_notex(int start, int end, int tilenum, int flip)
         {
             length = xendsc - xstart;
             scdiff = xend - xendsc;
-            compute_cvg_noflip(i);
         }
         else
         {
             length = xstart - xendsc;
             scdiff = xendsc - xend;
-            compute_cvg_flip(i);
         }
+        first = span_window(xendsc, length, flip, &last);
+        if (first > last)
+            continue;
+        if (!flip)
+            compute_cvg_noflip(i);
+        else
+            compute_cvg_flip(i);
 
         if (scdiff)
         {
@@ -5499,8 +5787,25 @@ static void render_spans_1cycle_notex(int start, int end, int tilenum, int flip)
             z += (dzinc * scdiff);
         }
 
-        for (j = 0; j <= length; j++)
+        skip = first; /* to the window's first pixel */
+        if (skip)
         {
+            r += drinc * skip;
+            g += dginc * skip;
+            b += dbinc * skip;
+            a += dainc * skip;
+            z += dzinc * skip;
+            x += xinc * skip;
+            curpixel += xinc * skip;
+            zbcur += xinc * skip;
+            zbcur &= 0x00FFFFFF >> 1;
+        }
+
+        for (j = skip; j <= last; j++)
+        {
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                restart_pixel_pipeline();
+
             sr = r >> 14;
             sg = g >> 14;
             sb = b >> 14;
@@ -5837,7 +6142,7 @@ static void render_spans_2cycle_complete(int start, int end, int tilenum, int fl
     int zbcur;
     uint8_t offx, offy;
     SPANSIGS sigs;
-    int32_t prelodfrac;
+    int32_t prelodfrac = 0;
     COLOR nexttexel1_color;
     uint32_t blend_en;
     uint32_t prewrap;
@@ -5865,6 +6170,7 @@ static void render_spans_2cycle_complete(int start, int end, int tilenum, int fl
     int curpixel = 0;
     
     int x, length, scdiff;
+    int first, last, skip;
     uint32_t fir, fig, fib;
 
     int dzpix;
@@ -5930,14 +6236,19 @@ static void render_spans_2cycle_complete(int start, int end, int tilenum, int fl
         {
             length = xendsc - xstart;
             scdiff = xend - xendsc;
-            compute_cvg_noflip(i);
         }
         else
         {
             length = xstart - xendsc;
             scdiff = xendsc - xend;
-            compute_cvg_flip(i);
         }
+        first = span_window(xendsc, length, flip, &last);
+        if (first > last)
+            continue;
+        if (!flip)
+            compute_cvg_noflip(i);
+        else
+            compute_cvg_flip(i);
 
         if (scdiff)
         {
@@ -5951,10 +6262,32 @@ static void render_spans_2cycle_complete(int start, int end, int tilenum, int fl
             t += (dtinc * scdiff);
             w += (dwinc * scdiff);
         }
-        sigs.startspan = 1;
 
-        for (j = 0; j <= length; j++)
+        /* From the window's first pixel on, or from the one before it, which
+         * fetches the texels of the first */
+        skip = first ? first - 1 : 0;
+        if (skip)
+        {
+            r += drinc * skip;
+            g += dginc * skip;
+            b += dbinc * skip;
+            a += dainc * skip;
+            z += dzinc * skip;
+            s += dsinc * skip;
+            t += dtinc * skip;
+            w += dwinc * skip;
+            x += xinc * skip;
+            curpixel += xinc * skip;
+            zbcur += xinc * skip;
+            zbcur &= 0x00FFFFFF >> 1;
+        }
+        sigs.startspan = !skip;
+
+        for (j = skip; j <= last; j++)
         {
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                restart_pixel_pipeline();
+
             sr = r >> 14;
             sg = g >> 14;
             sb = b >> 14;
@@ -5993,11 +6326,15 @@ static void render_spans_2cycle_complete(int start, int end, int tilenum, int fl
 
             texture_pipeline_cycle(&nexttexel_color, &nexttexel_color, news, newt, newtile1, 0);
             texture_pipeline_cycle(&nexttexel1_color, &nexttexel_color, news, newt, newtile2, 1);
+            if (j < first)
+                goto next_pixel;
 
             rgbaz_correct_clip(offx, offy, sr, sg, sb, sa, &sz, curpixel_cvg);
             get_dither_noise(x, i, &cdith, &adith);
             combiner_2cycle(adith, &curpixel_cvg, &acalpha);
             fbread2_ptr(curpixel, &curpixel_memcvg);
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                COLOR_ASSIGN(memory_color, pre_memory_color);
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_2cycle(&fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit, acalpha))
@@ -6013,6 +6350,7 @@ static void render_spans_2cycle_complete(int start, int end, int tilenum, int fl
                COLOR_ASSIGN(memory_color, pre_memory_color);
             }
 
+next_pixel:
             r += drinc;
             g += dginc;
             b += dbinc;
@@ -6053,6 +6391,7 @@ static void render_spans_2cycle_notexelnext(int start, int end, int tilenum, int
     int curpixel = 0;
     
     int x, length, scdiff;
+    int first, last, skip;
     uint32_t fir, fig, fib;
 
     int dzpix;
@@ -6118,14 +6457,19 @@ static void render_spans_2cycle_notexelnext(int start, int end, int tilenum, int
         {
             length = xendsc - xstart;
             scdiff = xend - xendsc;
-            compute_cvg_noflip(i);
         }
         else
         {
             length = xstart - xendsc;
             scdiff = xendsc - xend;
-            compute_cvg_flip(i);
         }
+        first = span_window(xendsc, length, flip, &last);
+        if (first > last)
+            continue;
+        if (!flip)
+            compute_cvg_noflip(i);
+        else
+            compute_cvg_flip(i);
 
         if (scdiff)
         {
@@ -6140,8 +6484,28 @@ static void render_spans_2cycle_notexelnext(int start, int end, int tilenum, int
             w += (dwinc * scdiff);
         }
 
-        for (j = 0; j <= length; j++)
+        skip = first; /* to the window's first pixel */
+        if (skip)
+        {
+            r += drinc * skip;
+            g += dginc * skip;
+            b += dbinc * skip;
+            a += dainc * skip;
+            z += dzinc * skip;
+            s += dsinc * skip;
+            t += dtinc * skip;
+            w += dwinc * skip;
+            x += xinc * skip;
+            curpixel += xinc * skip;
+            zbcur += xinc * skip;
+            zbcur &= 0x00FFFFFF >> 1;
+        }
+
+        for (j = skip; j <= last; j++)
         {
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                restart_pixel_pipeline();
+
             sr = r >> 14;
             sg = g >> 14;
             sb = b >> 14;
@@ -6171,6 +6535,8 @@ static void render_spans_2cycle_notexelnext(int start, int end, int tilenum, int
             combiner_2cycle(adith, &curpixel_cvg, &acalpha);
                 
             fbread2_ptr(curpixel, &curpixel_memcvg);
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                COLOR_ASSIGN(memory_color, pre_memory_color);
 
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
@@ -6235,6 +6601,7 @@ static void render_spans_2cycle_notexel1(int start, int end, int tilenum, int fl
     int curpixel = 0;
     
     int x, length, scdiff;
+    int first, last, skip;
     uint32_t fir, fig, fib;
 
     int dzpix;
@@ -6300,14 +6667,19 @@ static void render_spans_2cycle_notexel1(int start, int end, int tilenum, int fl
         {
             length = xendsc - xstart;
             scdiff = xend - xendsc;
-            compute_cvg_noflip(i);
         }
         else
         {
             length = xstart - xendsc;
             scdiff = xendsc - xend;
-            compute_cvg_flip(i);
         }
+        first = span_window(xendsc, length, flip, &last);
+        if (first > last)
+            continue;
+        if (!flip)
+            compute_cvg_noflip(i);
+        else
+            compute_cvg_flip(i);
 
         if (scdiff)
         {
@@ -6322,8 +6694,28 @@ static void render_spans_2cycle_notexel1(int start, int end, int tilenum, int fl
             w += (dwinc * scdiff);
         }
 
-        for (j = 0; j <= length; j++)
+        skip = first; /* to the window's first pixel */
+        if (skip)
+        {
+            r += drinc * skip;
+            g += dginc * skip;
+            b += dbinc * skip;
+            a += dainc * skip;
+            z += dzinc * skip;
+            s += dsinc * skip;
+            t += dtinc * skip;
+            w += dwinc * skip;
+            x += xinc * skip;
+            curpixel += xinc * skip;
+            zbcur += xinc * skip;
+            zbcur &= 0x00FFFFFF >> 1;
+        }
+
+        for (j = skip; j <= last; j++)
         {
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                restart_pixel_pipeline();
+
             sr = r >> 14;
             sg = g >> 14;
             sb = b >> 14;
@@ -6355,6 +6747,8 @@ static void render_spans_2cycle_notexel1(int start, int end, int tilenum, int fl
             combiner_2cycle(adith, &curpixel_cvg, &acalpha);
                 
             fbread2_ptr(curpixel, &curpixel_memcvg);
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                COLOR_ASSIGN(memory_color, pre_memory_color);
 
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
@@ -6418,6 +6812,7 @@ static void render_spans_2cycle_notex(int start, int end, int tilenum, int flip)
     int curpixel = 0;
     
     int x, length, scdiff;
+    int first, last, skip;
     uint32_t fir, fig, fib;
 
     int dzpix;
@@ -6474,14 +6869,19 @@ static void render_spans_2cycle_notex(int start, int end, int tilenum, int flip)
         {
             length = xendsc - xstart;
             scdiff = xend - xendsc;
-            compute_cvg_noflip(i);
         }
         else
         {
             length = xstart - xendsc;
             scdiff = xendsc - xend;
-            compute_cvg_flip(i);
         }
+        first = span_window(xendsc, length, flip, &last);
+        if (first > last)
+            continue;
+        if (!flip)
+            compute_cvg_noflip(i);
+        else
+            compute_cvg_flip(i);
 
         if (scdiff)
         {
@@ -6493,8 +6893,25 @@ static void render_spans_2cycle_notex(int start, int end, int tilenum, int flip)
             z += (dzinc * scdiff);
         }
 
-        for (j = 0; j <= length; j++)
+        skip = first; /* to the window's first pixel */
+        if (skip)
+        {
+            r += drinc * skip;
+            g += dginc * skip;
+            b += dbinc * skip;
+            a += dainc * skip;
+            z += dzinc * skip;
+            x += xinc * skip;
+            curpixel += xinc * skip;
+            zbcur += xinc * skip;
+            zbcur &= 0x00FFFFFF >> 1;
+        }
+
+        for (j = skip; j <= last; j++)
         {
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                restart_pixel_pipeline();
+
             sr = r >> 14;
             sg = g >> 14;
             sb = b >> 14;
@@ -6509,6 +6926,8 @@ static void render_spans_2cycle_notex(int start, int end, int tilenum, int flip)
             combiner_2cycle(adith, &curpixel_cvg, &acalpha);
                 
             fbread2_ptr(curpixel, &curpixel_memcvg);
+            if (PIXEL_PIPELINE_RESTARTS(x, j, first, flip))
+                COLOR_ASSIGN(memory_color, pre_memory_color);
 
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
@@ -6547,7 +6966,7 @@ static void render_spans_fill_4(int start, int end, int flip)
 static void render_spans_fill_8(int start, int end, int flip)
 {
    int i, j;
-   int x, length;
+   int x, length, last;
    uint32_t fb;
    int prevxstart;
    const int fastkillbits
@@ -6591,7 +7010,8 @@ static void render_spans_fill_8(int start, int end, int flip)
       if (!span[i].validline)
          continue;
 
-      for (j = 0, fb = fb_address + curpixel; j <= length; j++, fb += xinc)
+      j = span_window(xendsc, length, flip, &last);
+      for (fb = fb_address + curpixel + xinc * j; j <= last; j++, fb += xinc)
       {
          uint32_t val = (fill_color >> (((fb & 3) ^ 3) << 3)) & 0xff;
          uint8_t hval = ((val & 1) << 1) | (val & 1);
@@ -6603,7 +7023,7 @@ static void render_spans_fill_8(int start, int end, int flip)
 static void render_spans_fill_16(int start, int end, int flip)
 {
    int i, j;
-   int x, length;
+   int x, length, last;
    uint32_t fb;
    int prevxstart;
    const int fastkillbits
@@ -6649,7 +7069,8 @@ static void render_spans_fill_16(int start, int end, int flip)
       if (!span[i].validline)
          continue;
 
-      for (j = 0, fb = (fb_address >> 1) + curpixel; j <= length; j++, fb += xinc)
+      j = span_window(xendsc, length, flip, &last);
+      for (fb = (fb_address >> 1) + curpixel + xinc * j; j <= last; j++, fb += xinc)
       {
          val   = (fb & 1 ? fill_color : fill_color >> 16) & 0xffff;
          hval  = (val & 1);
@@ -6662,7 +7083,7 @@ static void render_spans_fill_16(int start, int end, int flip)
 static void render_spans_fill_32(int start, int end, int flip)
 {
    int i, j;
-   int x, length;
+   int x, length, last;
    uint32_t fb;
    int prevxstart;
    const int fastkillbits
@@ -6706,7 +7127,8 @@ static void render_spans_fill_32(int start, int end, int flip)
       if (!span[i].validline)
          continue;
 
-      for (j = 0, fb = (fb_address >> 2) + curpixel; j <= length; j++, fb += xinc)
+      j = span_window(xendsc, length, flip, &last);
+      for (fb = (fb_address >> 2) + curpixel + xinc * j; j <= last; j++, fb += xinc)
       {
          PAIRWRITE32(fb, fill_color, (fill_color & 0x10000) ? 3 : 0, (fill_color & 0x1) ? 3 : 0);
       }
@@ -6795,7 +7217,7 @@ static void render_spans_copy(int start, int end, int tilenum, int flip)
     int dsinc, dtinc, dwinc;
     int xinc;
 
-    int xstart = 0, xendsc;
+    int xstart = 0, xendsc, xw;
     int s = 0, t = 0, w = 0, ss = 0, st = 0, sw = 0, sss = 0, sst = 0, ssw = 0;
     int fb_index, length;
     int diff = 0;
@@ -6855,6 +7277,10 @@ static void render_spans_copy(int start, int end, int tilenum, int flip)
 
         for (j = 0; j <= length; j += fbadvance)
         {
+            xw = xendsc + xinc * j;
+            if (xw + 8 < window.xh || xw - 8 > window.xl)
+                goto next_word; /* none of its pixels in the window */
+
             ss = s >> 16;
             st = t >> 16;
             sw = w >> 16;
@@ -6880,7 +7306,13 @@ static void render_spans_copy(int start, int end, int tilenum, int flip)
             else if (fb_size == PIXEL_SIZE_8BIT)
             {
                 alphamask = 0;
-                threshold = (other_modes.dither_alpha_en) ? (irand() & 0xff) : COLOR_ALPHA(blend_color);
+                if (other_modes.dither_alpha_en)
+                {
+                    rdp_seed_noise(xw, i);
+                    threshold = rdp_rand() & 0xff;
+                }
+                else
+                    threshold = COLOR_ALPHA(blend_color);
                 if (other_modes.dither_alpha_en)
                 {
                     currthreshold = threshold;
@@ -6912,9 +7344,14 @@ static void render_spans_copy(int start, int end, int tilenum, int flip)
             tempdword = fbptr;
             k = 7;
             while (copywmask > 0)
-            {
+            { /* the bytes go from xw's first one, to the right or left */
+                const int n = 7 - k;
+                const int x = flip
+                    ? xw + (n >> (bytesperpixel - 1))
+                    : xw - ((n + bytesperpixel - 1) >> (bytesperpixel - 1));
+
                 tempbyte = (uint32_t)((copyqword >> (k << 3)) & 0xff);
-                if (alphamask & (1 << k))
+                if ((alphamask & (1 << k)) && x >= window.xh && x <= window.xl)
                 {
                     PAIRWRITE8(tempdword, tempbyte, (tempbyte & 1) ? 3 : 0);
                 }
@@ -6922,6 +7359,7 @@ static void render_spans_copy(int start, int end, int tilenum, int flip)
                 tempdword += xinc;
                 copywmask--;
             }
+next_word:
             s += dsinc;
             t += dtinc;
             w += dwinc;
@@ -7023,6 +7461,11 @@ static void render_spans(
     ++render_cycle_mode_counts[other_modes.cycle_type];
 #endif
 
+    if (yhlimit < window.yh)
+        yhlimit = window.yh;
+    if (yllimit > window.yl)
+        yllimit = window.yl;
+
     switch (other_modes.cycle_type)
     {
        case CYCLE_TYPE_1:
@@ -7463,6 +7906,7 @@ int32_t irand(void)
 
 void rdp_close(void)
 {
+    workers_close();
 }
 
 static STRICTINLINE int finalize_spanalpha(
@@ -7808,7 +8252,6 @@ struct stepwalker_info
    uint8_t xfrac;
 };
 
-static int cmd_cur;
 static int cmd_ptr; /* for 64-bit elements, always <= +0x7FFF */
 
 /* static DP_FIFO cmd_fifo; */
@@ -8002,6 +8445,478 @@ static void count_DP_commands(void)
 }
 #endif
 
+/* The parallel rasterizer.
+ *
+ * While it is on, process_RDP_list() runs the commands other than the
+ * primitives on the first state as usual, and bins each primitive into the
+ * tiles it may draw to, in command order. A primitive carries snapshots of
+ * the modes and of TMEM as they are when it is binned, taken again only
+ * once a command changes them. run_tiles() then hands the tiles out to the
+ * workers: a worker sets up and draws the primitives of its tile in order,
+ * on its own state, writing only the tile's pixels (see window), so a
+ * primitive is set up once for each tile it touches and each pixel is
+ * written by one worker, in command order.
+ *
+ * What a pixel gets depends on nothing but the pixel and its primitive: the
+ * noise is seeded per pixel, and the pipeline restarts at the edges of the
+ * tile columns (see PIXEL_PIPELINE_RESTARTS()), in the serial rasterizer
+ * too, so both draw the same frames.
+ *
+ * The bins are drawn before the commands that need what they draw or that
+ * change how memory maps to the tiles:
+ * - sync_full, which raises the interrupt once it is done,
+ * - set_color_image and set_mask_image changing the image,
+ * - loads from memory the bins may draw to,
+ * when the pools fill up or process_RDP_list() runs out of room, and before
+ * the VI reads a frame, through rdp_flush(). Primitives that may draw past
+ * the end of a scanline, into the next one, that use a Z buffer overlapping
+ * their color pixels with another layout, or that may crash the pipeline,
+ * are drawn in order after the bins, on the first state; the bins are also
+ * drawn before a primitive whose color or Z pixels overlap the other image
+ * where the bins draw.
+ */
+#define BIN_PRIMITIVES 4096
+#define BIN_ENTRIES    16384
+#define BIN_MODES      256
+#define BIN_TMEMS      32
+
+static struct
+{
+    int primitives;         /* binned */
+    int entries;
+    int modes, tmems;       /* snapshots taken */
+    int modes_changed;      /* since the last snapshot */
+    int tmem_changed;
+    int rows;               /* scanlines the bins may draw to */
+    int z_rows;             /* of those, with Z */
+    int tiles;              /* with entries */
+
+    struct
+    {
+        int cmd;            /* in cmd_data */
+        uint32_t seed;      /* noise_prim */
+        int modes, tmem;    /* snapshots */
+    } primitive[BIN_PRIMITIVES];
+
+    struct
+    {
+        int primitive;
+        int next;           /* entry, of the same tile */
+    } entry[BIN_ENTRIES];
+
+    int first[RDP_TILES];   /* entries of each tile, in command order */
+    int last[RDP_TILES];
+    int count[RDP_TILES];
+    int order[RDP_TILES];   /* tiles with entries, as handed out */
+} bins = { 0, 0, 0, 0, 1, 1 };
+
+static uint8_t bin_modes[BIN_MODES][RDP_MODES_SIZE];
+static uint8_t bin_tmem[BIN_TMEMS][0x1000];
+
+/* Points the inputs of the first state's modes at the same members of this
+ * one. */
+static void rebase_inputs(int16_t** inputs)
+{
+    const char* const from = (const char*)&rdp_states[0];
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        const char* const input = (const char*)inputs[i];
+
+        if (input >= from && input < from + sizeof(RDP_STATE))
+            inputs[i] = (int16_t*)((char*)rdp + (input - from));
+    }
+}
+
+static void load_modes(int snapshot)
+{
+    memcpy(rdp, bin_modes[snapshot], RDP_MODES_SIZE);
+    rdp->modes_snapshot = snapshot;
+
+    rebase_inputs(combiner_rgbsub_a_r);
+    rebase_inputs(combiner_rgbsub_a_g);
+    rebase_inputs(combiner_rgbsub_a_b);
+    rebase_inputs(combiner_rgbsub_b_r);
+    rebase_inputs(combiner_rgbsub_b_g);
+    rebase_inputs(combiner_rgbsub_b_b);
+    rebase_inputs(combiner_rgbmul_r);
+    rebase_inputs(combiner_rgbmul_g);
+    rebase_inputs(combiner_rgbmul_b);
+    rebase_inputs(combiner_rgbadd_r);
+    rebase_inputs(combiner_rgbadd_g);
+    rebase_inputs(combiner_rgbadd_b);
+    rebase_inputs(combiner_alphasub_a);
+    rebase_inputs(combiner_alphasub_b);
+    rebase_inputs(combiner_alphamul);
+    rebase_inputs(combiner_alphaadd);
+    rebase_inputs(blender1a_r);
+    rebase_inputs(blender1a_g);
+    rebase_inputs(blender1a_b);
+    rebase_inputs(blender1b_a);
+    rebase_inputs(blender2a_r);
+    rebase_inputs(blender2a_g);
+    rebase_inputs(blender2a_b);
+    rebase_inputs(blender2b_a);
+}
+
+static void draw_tile(void* arg, unsigned index)
+{
+    RDP_STATE* const caller = rdp;
+    const int t = bins.order[index];
+    int e;
+
+    rdp = &rdp_states[1 + workers_thread()];
+    rdp->tiled = 1;
+    window.xh = (t % RDP_TILES_WIDE) << RDP_TILE_SHIFT;
+    window.yh = (t / RDP_TILES_WIDE) << RDP_TILE_SHIFT;
+    window.xl = window.xh + RDP_TILE_SIZE - 1;
+    window.yl = window.yh + RDP_TILE_SIZE - 1;
+
+    for (e = bins.first[t]; e >= 0; e = bins.entry[e].next)
+    {
+        const int p = bins.entry[e].primitive;
+        uint32_t w1, w2;
+
+        if (bins.primitive[p].modes != rdp->modes_snapshot)
+            load_modes(bins.primitive[p].modes);
+        if (bins.primitive[p].tmem != rdp->tmem_snapshot)
+        {
+            memcpy(__TMEM, bin_tmem[bins.primitive[p].tmem], 0x1000);
+            rdp->tmem_snapshot = bins.primitive[p].tmem;
+        }
+
+        cmd_cur = bins.primitive[p].cmd;
+        rdp->noise_prim = bins.primitive[p].seed;
+        w1 = cmd_data[cmd_cur + 0].UW32[0];
+        w2 = cmd_data[cmd_cur + 0].UW32[1];
+        rdp_command_table[(w1 >> 24) % 64](w1, w2);
+    }
+    rdp = caller;
+}
+
+/* Most entries first, so that the longest tiles don't end up last. */
+static int compare_tiles(const void* a, const void* b)
+{
+    const int x = *(const int*)a;
+    const int y = *(const int*)b;
+
+    if (bins.count[x] != bins.count[y])
+        return bins.count[y] - bins.count[x];
+    return x - y;
+}
+
+/* Draws the binned primitives and empties the bins. */
+static void run_tiles(void)
+{
+    int i;
+
+    if (bins.primitives == 0)
+        return;
+
+    qsort(bins.order, bins.tiles, sizeof(bins.order[0]), compare_tiles);
+    for (i = 1; i <= WORKERS_MAX; i++)
+    {
+        rdp_states[i].modes_snapshot = -1;
+        rdp_states[i].tmem_snapshot = -1;
+    }
+    workers_run(draw_tile, NULL, bins.tiles);
+
+    for (i = 0; i < bins.tiles; i++)
+        bins.count[bins.order[i]] = 0;
+    bins.primitives = bins.entries = 0;
+    bins.modes = bins.tmems = 0;
+    bins.modes_changed = bins.tmem_changed = 1;
+    bins.rows = bins.z_rows = 0;
+    bins.tiles = 0;
+}
+
+static int overlap(uint32_t a, uint32_t a_length, uint32_t b, uint32_t b_length)
+{
+    a &= RDRAM_MASK;
+    b &= RDRAM_MASK;
+    if (a + a_length > RDRAM_MASK || b + b_length > RDRAM_MASK)
+        return 1; /* wraps around */
+    return a < b + b_length && b < a + a_length;
+}
+
+/* Whether the first color_rows rows of the color image overlap the first
+ * z_rows of the Z image, with another layout. */
+static int z_overlaps(int color_rows, int z_rows)
+{
+    const uint32_t color_pixels = (uint32_t)color_rows * fb_width + 1;
+    const uint32_t z_pixels = (uint32_t)z_rows * fb_width + 1;
+
+    if (z_rows == 0 || (fb_size == PIXEL_SIZE_16BIT && fb_address == zb_address))
+        return 0;
+    return overlap(fb_address, PIXELS_TO_BYTES(color_pixels, fb_size), zb_address, z_pixels << 1);
+}
+
+/* Whether a load reads memory the bins may draw to, the texels from the
+ * start of the tile's first row to the end of its last, for a block as if
+ * its coordinates were either integer or fixed point. The bounds are
+ * rounded out to whole 64-bit words and more. */
+static int load_reads_bins(int command, uint32_t w1, uint32_t w2)
+{
+    const int sl = (w1 & 0x00FFF000) >> 12;
+    const int tl = (w1 & 0x00000FFF) >>  0;
+    const int sh = (w2 & 0x00FFF000) >> 12;
+    const int th = (w2 & 0x00000FFF) >>  0;
+    const uint32_t pixels = (uint32_t)bins.rows * fb_width + 1;
+    uint32_t address, length;
+    int first, last;
+
+    if (bins.rows == 0)
+        return 0;
+
+    first = (tl >> 2) * ti_width + (sl >> 2);
+    if (command == 0x33) /* load_block, th is dxt */
+        last = tl * ti_width + sl + sh;
+    else
+        last = (th >> 2) * ti_width + (sh >> 2);
+    if (last < first)
+        return 0;
+
+    address = ti_address + PIXELS_TO_BYTES(first, ti_size) - 8;
+    length = PIXELS_TO_BYTES(last - first + 1, ti_size) + 16;
+    return overlap(address, length, fb_address, PIXELS_TO_BYTES(pixels, fb_size))
+        || overlap(address, length, zb_address, pixels << 1);
+}
+
+/* The columns a triangle's edges may cover over the subscanlines from first
+ * to last, in pixels; 0 if they are out of the edge walker's range. */
+static int triangle_columns(int first, int last, int* x0, int* x1)
+{
+    const uint32_t w2 = cmd_data[cmd_cur + 0].UW32[1];
+    const int32_t ym = SIGN((w2 & 0xFFFF0000) >> 16, 14);
+    const int32_t yh = SIGN(w2 & 0x0000FFFF, 14);
+    const int64_t xl = SIGN(cmd_data[cmd_cur + 1].UW32[0], 30) & ~1;
+    const int64_t xh = SIGN(cmd_data[cmd_cur + 2].UW32[0], 30) & ~1;
+    const int64_t xm = SIGN(cmd_data[cmd_cur + 3].UW32[0], 30) & ~1;
+    const int64_t dxl = ((int32_t)cmd_data[cmd_cur + 1].UW32[1] >> 2) & ~1;
+    const int64_t dxh = ((int32_t)cmd_data[cmd_cur + 2].UW32[1] >> 2) & ~1;
+    const int64_t dxm = ((int32_t)cmd_data[cmd_cur + 3].UW32[1] >> 2) & ~1;
+    const int ycur = yh & ~3;
+    int64_t x[6];
+    int64_t low, high;
+    int n = 0, i;
+
+    /* The major edge, then the middle one up to ym and the low one from
+     * there, as draw_triangle() steps them from ycur on. */
+    x[n++] = xh + dxh * (first - ycur);
+    x[n++] = xh + dxh * (last - ycur);
+    if (ym < ycur || ym > last)
+    {
+        x[n++] = xm + dxm * (first - ycur);
+        x[n++] = xm + dxm * (last - ycur);
+    }
+    else
+    {
+        if (ym > first)
+        {
+            x[n++] = xm + dxm * (first - ycur);
+            x[n++] = xm + dxm * (ym - 1 - ycur);
+        }
+        x[n++] = xl + dxl * ((first > ym ? first : ym) - ym);
+        x[n++] = xl + dxl * (last - ym);
+    }
+
+    low = high = x[0];
+    for (i = 1; i < n; i++)
+    {
+        low = x[i] < low ? x[i] : low;
+        high = x[i] > high ? x[i] : high;
+    }
+    if (low < -((int64_t)1 << 27) || high >= (int64_t)1 << 27)
+        return 0;
+    *x0 = (int)(low >> 16) - 1;
+    *x1 = (int)(high >> 16) + 1;
+    return 1;
+}
+
+/* Bins the primitive at cmd_cur into the tiles it may draw to, or draws it
+ * on the first state if it can't be binned. */
+static void bin_primitive(int command, uint32_t w1, uint32_t w2)
+{
+    const int copy_fill = other_modes.cycle_type >= CYCLE_TYPE_COPY;
+    const int z_used = !copy_fill && (other_modes.z_compare_en || other_modes.z_update_en);
+    int x0, y0, x1, y1;
+    int xl, serial;
+    int tx, ty, p;
+
+    if (command < 0x24) /* triangles */
+    {
+        const int32_t yl = SIGN(w1 & 0x0000FFFF, 14);
+        const int32_t yh = SIGN(w2 & 0x0000FFFF, 14);
+
+        xl = __clip.xl;
+        y0 = (yh > __clip.yh ? yh : __clip.yh) >> 2;
+        y1 = (yl < __clip.yl ? yl : __clip.yl) >> 2;
+        if (y0 > y1
+         || !triangle_columns(y0 << 2, y1 << 2 | 3, &x0, &x1))
+        {
+            x0 = __clip.xh >> 2;
+            x1 = __clip.xl >> 2;
+        }
+    }
+    else
+    {
+        xl = (w1 & 0x00FFF000) >> 12;
+        x0 = ((w2 & 0x00FFF000) >> 12) >> 2;
+        x1 = (xl >> 2) + 1;
+        y0 = (w2 & 0x00000FFF) >> 2;
+        y1 = (w1 & 0x00000FFF) >> 2;
+        if (y0 < __clip.yh >> 2)
+            y0 = __clip.yh >> 2;
+        if (y1 > __clip.yl >> 2)
+            y1 = __clip.yl >> 2;
+        xl = xl < __clip.xl ? xl : __clip.xl;
+    }
+    if (x0 < __clip.xh >> 2)
+        x0 = __clip.xh >> 2;
+    if (x1 > __clip.xl >> 2)
+        x1 = __clip.xl >> 2;
+    if (x0 < 0)
+        x0 = 0;
+    if (x1 > 1023)
+        x1 = 1023;
+    if (y1 > 1023)
+        y1 = 1023;
+
+    if (copy_fill)
+        serial = (xl >> 2) >= fb_width;
+    else
+        serial = ((xl + 3) >> 2) > fb_width || (z_used && z_overlaps(y1 + 1, y1 + 1));
+    if (other_modes.cycle_type == CYCLE_TYPE_COPY)
+        serial |= fb_size == PIXEL_SIZE_32BIT || command < 0x24;
+    if (other_modes.cycle_type == CYCLE_TYPE_FILL)
+        serial |= fb_size == PIXEL_SIZE_4BIT
+               || other_modes.image_read_en || other_modes.z_compare_en
+               || (other_modes.z_update_en && !other_modes.z_source_sel);
+    if (serial)
+    {
+        run_tiles();
+        rdp_command_table[command](w1, w2);
+        return;
+    }
+    if (x0 > x1 || y0 > y1)
+        return; /* draws nothing */
+
+    if (z_overlaps(bins.rows > y1 + 1 ? bins.rows : y1 + 1,
+                   z_used && bins.z_rows < y1 + 1 ? y1 + 1 : bins.z_rows)
+     || bins.primitives == BIN_PRIMITIVES
+     || bins.entries + ((x1 >> RDP_TILE_SHIFT) - (x0 >> RDP_TILE_SHIFT) + 1)
+                     * ((y1 >> RDP_TILE_SHIFT) - (y0 >> RDP_TILE_SHIFT) + 1) > BIN_ENTRIES
+     || (bins.modes_changed && bins.modes == BIN_MODES)
+     || (bins.tmem_changed && bins.tmems == BIN_TMEMS))
+        run_tiles();
+
+    if (bins.modes_changed)
+    {
+        memcpy(bin_modes[bins.modes++], rdp, RDP_MODES_SIZE);
+        bins.modes_changed = 0;
+    }
+    if (bins.tmem_changed)
+    {
+        memcpy(bin_tmem[bins.tmems++], __TMEM, 0x1000);
+        bins.tmem_changed = 0;
+    }
+
+    p = bins.primitives++;
+    bins.primitive[p].cmd   = cmd_cur;
+    bins.primitive[p].seed  = rdp->noise_prim;
+    bins.primitive[p].modes = bins.modes - 1;
+    bins.primitive[p].tmem  = bins.tmems - 1;
+    if (bins.rows < y1 + 1)
+        bins.rows = y1 + 1;
+    if (z_used && bins.z_rows < y1 + 1)
+        bins.z_rows = y1 + 1;
+
+    for (ty = y0 >> RDP_TILE_SHIFT; ty <= y1 >> RDP_TILE_SHIFT; ty++)
+        for (tx = x0 >> RDP_TILE_SHIFT; tx <= x1 >> RDP_TILE_SHIFT; tx++)
+        {
+            const int t = ty * RDP_TILES_WIDE + tx;
+            const int e = bins.entries++;
+
+            bins.entry[e].primitive = p;
+            bins.entry[e].next = -1;
+            if (bins.count[t]++ == 0)
+            {
+                bins.first[t] = e;
+                bins.order[bins.tiles++] = t;
+            }
+            else
+                bins.entry[bins.last[t]].next = e;
+            bins.last[t] = e;
+        }
+}
+
+static STRICTINLINE int is_primitive(int command)
+{
+    return (command >= 0x08 && command <= 0x0F)
+        || command == 0x24 || command == 0x25 || command == 0x36;
+}
+
+/* What process_RDP_list() does with a command while the parallel rasterizer
+ * is on, in place of running it. */
+static void bin_command(int command, uint32_t w1, uint32_t w2)
+{
+    if (is_primitive(command))
+    {
+        bin_primitive(command, w1, w2);
+        return;
+    }
+
+    switch (command)
+    {
+        case 0x00: /* noop */
+        case 0x26: /* sync_load */
+        case 0x27: /* sync_pipe */
+        case 0x28: /* sync_tile */
+            return;
+        case 0x29: /* sync_full */
+            run_tiles();
+            break;
+        case 0x30: /* load_tlut */
+        case 0x33: /* load_block */
+        case 0x34: /* load_tile */
+            if (load_reads_bins(command, w1, w2))
+                run_tiles();
+            bins.tmem_changed = 1;
+            break;
+        case 0x3E: /* set_mask_image */
+            if ((w2 & 0x03FFFFFF) != zb_address)
+                run_tiles();
+            break;
+        case 0x3F: /* set_color_image */
+            if (((w1 & 0x00180000) >> 19) != fb_size
+             || (int)(w1 & 0x000003FF) + 1 != fb_width
+             || (w2 & 0x03FFFFFF) != fb_address)
+                run_tiles();
+            break;
+    }
+    rdp_command_table[command](w1, w2);
+    bins.modes_changed = 1;
+}
+
+void angrylion_set_parallel_rdp(unsigned enable)
+{
+#ifdef HAVE_ANGRYLION_TILES
+    rdp_parallel = enable;
+#else
+    (void)enable;
+#endif
+}
+
+/* Draws what the parallel rasterizer has binned, then starts or stops its
+ * workers as the option and thread count ask. Called before the VI reads a
+ * frame. */
+void rdp_flush(void)
+{
+    run_tiles();
+    rdp_workers = rdp_parallel ? (int)workers_count() : 1;
+}
+
 void process_RDP_list(void)
 {
     int length;
@@ -8015,6 +8930,13 @@ void process_RDP_list(void)
     if (length <= 0)
         return;
     length = (unsigned)(length) / sizeof(int64_t);
+    if (rdp_workers > 1 && ((cmd_ptr + length) & ~(0x0003FFFF / sizeof(int64_t))))
+    { /* make room, moving an incomplete last command to the start */
+        run_tiles();
+        memmove(&cmd_data[0], &cmd_data[cmd_cur], (cmd_ptr - cmd_cur) * sizeof(DP_FIFO));
+        cmd_ptr -= cmd_cur;
+        cmd_cur = 0;
+    }
     if ((cmd_ptr + length) & ~(0x0003FFFF / sizeof(int64_t)))
     {
         DisplayError("ProcessRDPList\nOut of command cache memory.");
@@ -8076,10 +8998,16 @@ void process_RDP_list(void)
               (const uint32_t*)(cmd_data + cmd_cur), cmd_length * 2);
 #endif
 
-        rdp_command_table[command](w1, w2);
+        rdp->noise_prim += is_primitive(command);
+        if (rdp_workers > 1)
+            bin_command(command, w1, w2);
+        else
+            rdp_command_table[command](w1, w2);
         cmd_cur += cmd_length;
     };
 exit_a:
+    if (bins.primitives != 0)
+        goto exit_b; /* the bins still need their commands */
     cmd_ptr = 0;
     cmd_cur = 0;
 exit_b:
@@ -8137,6 +9065,7 @@ static NOINLINE void draw_triangle(uint32_t w1, uint32_t w2,
     int curcross;
     int allover, allunder, curover, curunder;
     int allinval;
+    int minmax[2];
     int j, k;
     const int32_t clipxlshift = __clip.xl << 1;
     const int32_t clipxhshift = __clip.xh << 1;
@@ -8147,10 +9076,9 @@ static NOINLINE void draw_triangle(uint32_t w1, uint32_t w2,
     int lft     = (w1 & 0x00800000) >> (55 - 32);
     /* unused  (w1 & 0x00400000) >> (54 - 32) */
     int level   = (w1 & 0x00380000) >> (51 - 32);
-    int tile    = (w1 & 0x00070000) >> (48 - 32);
+    int tilenum = (w1 & 0x00070000) >> (48 - 32);
     int flip    = lft;
     max_level   = level;
-    int tilenum = tile;
 
     /* Triangle edge Y-coordinates */
     int32_t      yl = (w1 & 0x0000FFFF) >> (32 - 32); /* & 0x3FFF */
@@ -8423,6 +9351,8 @@ no_read_zbuffer_coefficients:
         ylfar += 4;
     else if (yllimit >> 2 >= 0 && yllimit >> 2 < 1023)
         span[(yllimit >> 2) + 1].validline = 0;
+    if (ylfar > ((window.yl + 1) << 2 | 3))
+        ylfar = (window.yl + 1) << 2 | 3; /* no rows past the window's next */
 
     yhlimit              = (yh - __clip.yh >= 0) ? yh : __clip.yh; /* clip.yh always &= 0xFFF */
 
@@ -8440,11 +9370,10 @@ no_read_zbuffer_coefficients:
 
     for (k = ycur; k <= ylfar; k++)
     {
-        static int minmax[2];
         int stickybit;
         int xlrsc[2];
         const int spix = k & 3;
-        const int yhclose = yhlimit & ~3;
+        const int yhclose = (yhlimit > window.yh * 4 ? yhlimit : window.yh * 4) & ~3;
 
         if (k == ym)
         {
@@ -8750,6 +9679,8 @@ static NOINLINE void draw_texture_rectangle(
         ylfar += 4;
     else if ((yllimit >> 2) >= 0 && (yllimit >> 2) < 1023)
         span[(yllimit >> 2) + 1].validline = 0;
+    if (ylfar > ((window.yl + 1) << 2 | 3))
+        ylfar = (window.yl + 1) << 2 | 3; /* no rows past the window's next */
 
     xleft = xm/* & ~0x00000001 // never needed because xm <<= 14 */;
     xright = xh/* & ~0x00000001 // never needed because xh <<= 14 */;
@@ -8764,7 +9695,7 @@ static NOINLINE void draw_texture_rectangle(
     {
         int xrsc, xlsc, stickybit;
         const int spix = k & 3;
-        const int yhclose = yhlimit & ~3;
+        const int yhclose = (yhlimit > window.yh * 4 ? yhlimit : window.yh * 4) & ~3;
 
         if (k < yhclose)
             { /* branch */ }
@@ -9161,6 +10092,7 @@ static void fill_rect(uint32_t w1, uint32_t w2)
     int curcross;
     int allover, allunder, curover, curunder;
     int allinval;
+    int maxxmx, minxhx;
     int j, k;
     const int32_t clipxlshift = __clip.xl << 1;
     const int32_t clipxhshift = __clip.xh << 1;
@@ -9201,6 +10133,8 @@ static void fill_rect(uint32_t w1, uint32_t w2)
         ylfar += 4;
     else if (yllimit >> 2 >= 0 && yllimit>>2 < 1023)
         span[(yllimit >> 2) + 1].validline = 0;
+    if (ylfar > ((window.yl + 1) << 2 | 3))
+        ylfar = (window.yl + 1) << 2 | 3; /* no rows past the window's next */
     yhlimit = (yh >= __clip.yh) ? yh : __clip.yh;
 
     allover = 1;
@@ -9210,10 +10144,9 @@ static void fill_rect(uint32_t w1, uint32_t w2)
     allinval = 1;
     for (k = ycur; k <= ylfar; k++)
     {
-        static int maxxmx, minxhx;
         int xrsc, xlsc, stickybit;
         const int32_t xleft = xl & ~0x00000001, xright = xh & ~0x00000001;
-        const int yhclose = yhlimit & ~3;
+        const int yhclose = (yhlimit > window.yh * 4 ? yhlimit : window.yh * 4) & ~3;
         const int spix = k & 3;
 
         if (k < yhclose)
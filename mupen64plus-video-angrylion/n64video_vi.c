@@ -3,12 +3,57 @@
 #include "z64.h"
 #include "rdp.h"
 #include "vi.h"
+#include "workers.h"
 #include "api/libretro.h"
 
+#if !defined(MSB_FIRST) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define VI_SSE2
+#elif !defined(MSB_FIRST) && defined(__ARM_NEON__) && defined(HAVE_NEON)
+#include <arm_neon.h>
+#define VI_NEON
+#endif
+
 typedef struct {
     uint8_t r, g, b, cvg;
 } CCVG;
 
+/* The filters read source pixels line_x - 1 to line_x + 2 around the one
+ * a screen pixel starts in, the furthest line_x being that of the last
+ * pixel with the largest x_start and x_add. */
+#define VI_MAX_LINE_X   ((0xFFF + (PRESCALE_WIDTH - 1) * 0xFFF) >> 10)
+#define VI_ROW_SIZE     (VI_MAX_LINE_X + 4)
+
+/* Smaller frames are not split between threads. */
+#define VI_BAND_MIN_PIXELS  0x8000
+#define VI_BAND_MIN_ROWS    16
+
+/* A frame filtered by do_frame_buffer_proper(), in bands of rows. */
+typedef struct {
+    uint32_t frame_buffer;
+    uint32_t vi_width_low;
+    uint32_t prescale_ptr;
+    int linecount;
+    int hres, vres;
+    int x_start, x_add;
+    uint32_t y_start, y_add;
+    int vitype;
+    int fsaa, dither_filter, divot, lerp_en;
+    int gamma_and_dither, slowbright;
+    int first_x, last_x;    /* source pixels fetched for each row */
+    uint32_t seed;          /* iseed before the first pixel */
+    unsigned bands;
+} VI_FRAME;
+
+/* The source rows a band's scanlines lerp between, fetched and divot
+ * filtered, pixel x at index x + 1. */
+typedef struct {
+    CCVG viaa[2][VI_ROW_SIZE];
+    CCVG divot[2][VI_ROW_SIZE];
+} VI_BAND;
+
+static VI_BAND vi_bands[WORKERS_MAX];
+
 typedef struct {
     uint8_t cvg;
     uint8_t cvbit;
@@ -120,8 +165,9 @@ STRICTINLINE static void restore_filter16(
     int* r, int* g, int* b, uint32_t fboffset, uint32_t num, uint32_t hres);
 STRICTINLINE static void restore_filter32(
     int* r, int* g, int* b, uint32_t fboffset, uint32_t num, uint32_t hres);
-static void gamma_filters(unsigned char* argb, int gamma_and_dither);
-static void adjust_brightness(unsigned char* argb, int brightcoeff);
+STRICTINLINE static uint32_t gamma_filters(
+    uint32_t pix, int gamma_and_dither, uint32_t* seed);
+static uint32_t adjust_brightness(uint32_t pix, int brightcoeff);
 STRICTINLINE static void vi_vl_lerp(CCVG* up, CCVG down, uint32_t frac);
 STRICTINLINE static void video_max_optimized(uint32_t* Pixels, uint32_t* penumin, uint32_t* penumax, int numofels);
 
@@ -129,6 +175,7 @@ STRICTINLINE static void vi_fetch_filter16(
     CCVG* res, uint32_t fboffset, uint32_t cur_x, uint32_t fsaa, uint32_t dither_filter);
 STRICTINLINE static void vi_fetch_filter32(
     CCVG* res, uint32_t fboffset, uint32_t cur_x, uint32_t fsaa, uint32_t dither_filter);
+static void vi_divot_row(CCVG* dst, const CCVG* src, int count);
 
 static void do_frame_buffer_proper(
     uint32_t prescale_ptr, int hres, int vres, int x_start, int vitype,
@@ -142,10 +189,6 @@ static void (*do_frame_buffer[2])(uint32_t, int, int, int, int, int) = {
 
 static void (*vi_fetch_filter_ptr)(
     CCVG*, uint32_t, uint32_t, uint32_t, uint32_t);
-static void (*vi_fetch_filter_func[2])(
-    CCVG*, uint32_t, uint32_t, uint32_t, uint32_t) = {
-    vi_fetch_filter16, vi_fetch_filter32
-};
 
 static STRICTINLINE uint16_t decompress_cvmask_frombyte(uint8_t x)
 {
@@ -238,6 +281,8 @@ void rdp_update(void)
        blitter_buf_lock = (uint32_t*)fb.data;
 #endif
 
+    rdp_flush(); /* draws what the rasterizer has queued */
+
 /*
  * initial value (angrylion)
  */
@@ -387,32 +432,333 @@ no_frame_buffer:
     }
 }
 
+extern int32_t iseed;
+
+/* The seed irand() leaves after count more calls, for the bands to draw
+ * their dither noise as if the frame was filtered in one go. */
+static uint32_t vi_seed_after(uint32_t seed, uint32_t count)
+{
+    uint32_t mul = 0x343fd;
+    uint32_t add = 0x269ec3;
+
+    while (count)
+    {
+        if (count & 1)
+            seed = seed * mul + add;
+        add = add * mul + add;
+        mul *= mul;
+        count >>= 1;
+    }
+    return seed;
+}
+
+STRICTINLINE static int32_t vi_irand(uint32_t* seed)
+{
+    *seed = *seed * 0x343fd + 0x269ec3;
+    return (*seed >> 16) & 0x7fff;
+}
+
+static void vi_fetch_row(
+    const VI_FRAME* f, CCVG* viaa, CCVG* divot, uint32_t y)
+{
+    const uint32_t pixels = f->vi_width_low * y;
+    int x;
+
+    if (f->vitype & 1)
+        for (x = f->first_x; x <= f->last_x; x++)
+            vi_fetch_filter32(
+                &viaa[x], f->frame_buffer, pixels + x, f->fsaa,
+                f->dither_filter);
+    else
+        for (x = f->first_x; x <= f->last_x; x++)
+            vi_fetch_filter16(
+                &viaa[x], f->frame_buffer, pixels + x, f->fsaa,
+                f->dither_filter);
+
+    if (f->divot)
+        vi_divot_row(
+            &divot[f->first_x + 1], &viaa[f->first_x + 1],
+            f->last_x - f->first_x - 1);
+}
+
+/* divot_filter() on count pixels, src[-1] and src[count] being read. Per
+ * component it keeps the median of the pixel and its neighbours. */
+static void vi_divot_row(CCVG* dst, const CCVG* src, int count)
+{
+    int x = 0;
+#if defined(VI_SSE2)
+    const __m128i seven = _mm_set1_epi32(7);
+    const __m128i cvg_mask = _mm_set1_epi32(0xFF000000);
+
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128i left   = _mm_loadu_si128((const __m128i*)&src[x - 1]);
+        __m128i center = _mm_loadu_si128((const __m128i*)&src[x]);
+        __m128i right  = _mm_loadu_si128((const __m128i*)&src[x + 1]);
+        __m128i full   = _mm_and_si128(_mm_and_si128(left, center), right);
+        __m128i keep   = _mm_cmpeq_epi32(_mm_srli_epi32(full, 24), seven);
+        __m128i median = _mm_max_epu8(
+            _mm_min_epu8(left, right),
+            _mm_min_epu8(_mm_max_epu8(left, right), center));
+
+        keep = _mm_or_si128(keep, cvg_mask);
+        _mm_storeu_si128((__m128i*)&dst[x], _mm_or_si128(
+            _mm_and_si128(keep, center), _mm_andnot_si128(keep, median)));
+    }
+#elif defined(VI_NEON)
+    const uint32x4_t seven = vdupq_n_u32(7);
+    const uint32x4_t cvg_mask = vdupq_n_u32(0xFF000000);
+
+    for (; x + 4 <= count; x += 4)
+    {
+        uint8x16_t left   = vld1q_u8((const uint8_t*)&src[x - 1]);
+        uint8x16_t center = vld1q_u8((const uint8_t*)&src[x]);
+        uint8x16_t right  = vld1q_u8((const uint8_t*)&src[x + 1]);
+        uint32x4_t full   = vreinterpretq_u32_u8(
+            vandq_u8(vandq_u8(left, center), right));
+        uint32x4_t keep   = vceqq_u32(vshrq_n_u32(full, 24), seven);
+        uint8x16_t median = vmaxq_u8(
+            vminq_u8(left, right), vminq_u8(vmaxq_u8(left, right), center));
+
+        keep = vorrq_u32(keep, cvg_mask);
+        vst1q_u8((uint8_t*)&dst[x],
+            vbslq_u8(vreinterpretq_u8_u32(keep), center, median));
+    }
+#endif
+    for (; x < count; x++)
+        divot_filter(&dst[x], src[x], src[x - 1], src[x + 1]);
+}
+
+#if defined(VI_SSE2)
+STRICTINLINE static __m128i vi_lerp_epi16(__m128i up, __m128i down, __m128i frac)
+{
+    __m128i d = _mm_mullo_epi16(_mm_sub_epi16(down, up), frac);
+
+    d = _mm_srai_epi16(_mm_add_epi16(d, _mm_set1_epi16(16)), 5);
+    return _mm_and_si128(_mm_add_epi16(d, up), _mm_set1_epi16(0xFF));
+}
+#elif defined(VI_NEON)
+STRICTINLINE static int16x8_t vi_lerp_s16(int16x8_t up, int16x8_t down, int16x8_t frac)
+{
+    int16x8_t d = vmulq_s16(vsubq_s16(down, up), frac);
+
+    d = vshrq_n_s16(vaddq_s16(d, vdupq_n_s16(16)), 5);
+    return vandq_s16(vaddq_s16(d, up), vdupq_n_s16(0xFF));
+}
+#endif
+
+/* The screen pixels of a scanline, lerped between the source rows it
+ * falls between, as 0x00RRGGBB. vi_vl_lerp() by 0 keeps the color, so
+ * all pixels go through the same lerps. */
+static void vi_lerp_row(
+    const VI_FRAME* f, uint32_t* scanline, const CCVG* row,
+    const CCVG* row_next, uint32_t yfrac)
+{
+    int x_start = f->x_start;
+    int i = 0;
+
+    if (!f->lerp_en)
+        yfrac = 0;
+#if defined(VI_SSE2) || defined(VI_NEON)
+    for (; i + 4 <= f->hres; i += 4)
+    {
+        uint32_t c[4], n[4], s[4], sn[4];
+        int16_t xfrac[8];
+        int k;
+
+        for (k = 0; k < 4; k++)
+        {
+            const int line_x = x_start >> 10;
+
+            memcpy(&c[k], &row[line_x], sizeof(uint32_t));
+            memcpy(&n[k], &row[line_x + 1], sizeof(uint32_t));
+            memcpy(&s[k], &row_next[line_x], sizeof(uint32_t));
+            memcpy(&sn[k], &row_next[line_x + 1], sizeof(uint32_t));
+            xfrac[k] = f->lerp_en ? (x_start >> 5) & 0x1f : 0;
+            x_start += f->x_add;
+        }
+#if defined(VI_SSE2)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i yf = _mm_set1_epi16(yfrac);
+            const __m128i xf_lo = _mm_set_epi16(
+                xfrac[1], xfrac[1], xfrac[1], xfrac[1],
+                xfrac[0], xfrac[0], xfrac[0], xfrac[0]);
+            const __m128i xf_hi = _mm_set_epi16(
+                xfrac[3], xfrac[3], xfrac[3], xfrac[3],
+                xfrac[2], xfrac[2], xfrac[2], xfrac[2]);
+            __m128i cv  = _mm_loadu_si128((const __m128i*)c);
+            __m128i nv  = _mm_loadu_si128((const __m128i*)n);
+            __m128i sv  = _mm_loadu_si128((const __m128i*)s);
+            __m128i snv = _mm_loadu_si128((const __m128i*)sn);
+            __m128i lo, hi;
+
+            lo = vi_lerp_epi16(
+                vi_lerp_epi16(
+                    _mm_unpacklo_epi8(cv, zero), _mm_unpacklo_epi8(sv, zero), yf),
+                vi_lerp_epi16(
+                    _mm_unpacklo_epi8(nv, zero), _mm_unpacklo_epi8(snv, zero), yf),
+                xf_lo);
+            hi = vi_lerp_epi16(
+                vi_lerp_epi16(
+                    _mm_unpackhi_epi8(cv, zero), _mm_unpackhi_epi8(sv, zero), yf),
+                vi_lerp_epi16(
+                    _mm_unpackhi_epi8(nv, zero), _mm_unpackhi_epi8(snv, zero), yf),
+                xf_hi);
+
+            /* r, g, b, cvg to b, g, r, cvg: 0xCCRRGGBB once packed */
+            lo = _mm_shufflehi_epi16(
+                _mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+            hi = _mm_shufflehi_epi16(
+                _mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+            _mm_storeu_si128((__m128i*)&scanline[i], _mm_and_si128(
+                _mm_packus_epi16(lo, hi), _mm_set1_epi32(0x00FFFFFF)));
+        }
+#else
+        {
+            const int16x8_t yf = vdupq_n_s16(yfrac);
+            const int16x8_t xf_lo = vcombine_s16(
+                vdup_n_s16(xfrac[0]), vdup_n_s16(xfrac[1]));
+            const int16x8_t xf_hi = vcombine_s16(
+                vdup_n_s16(xfrac[2]), vdup_n_s16(xfrac[3]));
+            uint8x16_t cv  = vld1q_u8((const uint8_t*)c);
+            uint8x16_t nv  = vld1q_u8((const uint8_t*)n);
+            uint8x16_t sv  = vld1q_u8((const uint8_t*)s);
+            uint8x16_t snv = vld1q_u8((const uint8_t*)sn);
+            int16x8_t lo, hi;
+            uint32x4_t out;
+
+#define VI_WIDEN(v, half) vreinterpretq_s16_u16(vmovl_u8(vget_##half##_u8(v)))
+            lo = vi_lerp_s16(
+                vi_lerp_s16(VI_WIDEN(cv, low), VI_WIDEN(sv, low), yf),
+                vi_lerp_s16(VI_WIDEN(nv, low), VI_WIDEN(snv, low), yf),
+                xf_lo);
+            hi = vi_lerp_s16(
+                vi_lerp_s16(VI_WIDEN(cv, high), VI_WIDEN(sv, high), yf),
+                vi_lerp_s16(VI_WIDEN(nv, high), VI_WIDEN(snv, high), yf),
+                xf_hi);
+#undef VI_WIDEN
+
+            /* r, g, b, cvg reversed and shifted down: 0x00RRGGBB */
+            out = vreinterpretq_u32_u8(vrev32q_u8(vcombine_u8(
+                vmovn_u16(vreinterpretq_u16_s16(lo)),
+                vmovn_u16(vreinterpretq_u16_s16(hi)))));
+            vst1q_u32(&scanline[i], vshrq_n_u32(out, 8));
+        }
+#endif
+    }
+#endif
+    for (; i < f->hres; i++)
+    {
+        const int line_x = x_start >> 10;
+        CCVG color = row[line_x];
+        CCVG nextcolor = row[line_x + 1];
+
+        if (f->lerp_en)
+        {
+            vi_vl_lerp(&color, row_next[line_x], yfrac);
+            vi_vl_lerp(&nextcolor, row_next[line_x + 1], yfrac);
+            vi_vl_lerp(&color, nextcolor, (x_start >> 5) & 0x1f);
+        }
+        scanline[i] = (color.r << 16) | (color.g << 8) | color.b;
+        x_start += f->x_add;
+    }
+}
+
+static void vi_gamma_row(
+    uint32_t* scanline, int hres, int gamma_and_dither, uint32_t* seed)
+{
+    int i = 0;
+
+    if (gamma_and_dither == 1)
+    {
+        /* Adding the dither bits saturates at 255. */
+#if defined(VI_SSE2) || defined(VI_NEON)
+        for (; i + 4 <= hres; i += 4)
+        {
+            uint32_t dith[4];
+            int k;
+
+            for (k = 0; k < 4; k++)
+            {
+                const uint32_t cdith = vi_irand(seed);
+
+                dith[k] = ((cdith & 1) << 16) | ((cdith & 2) << 7) | ((cdith >> 2) & 1);
+            }
+#if defined(VI_SSE2)
+            _mm_storeu_si128((__m128i*)&scanline[i], _mm_adds_epu8(
+                _mm_loadu_si128((const __m128i*)&scanline[i]),
+                _mm_loadu_si128((const __m128i*)dith)));
+#else
+            vst1q_u32(&scanline[i], vreinterpretq_u32_u8(vqaddq_u8(
+                vreinterpretq_u8_u32(vld1q_u32(&scanline[i])),
+                vreinterpretq_u8_u32(vld1q_u32(dith)))));
+#endif
+        }
+#endif
+    }
+    for (; i < hres; i++)
+        scanline[i] = gamma_filters(scanline[i], gamma_and_dither, seed);
+}
+
+static void vi_band(void* arg, unsigned band)
+{
+    const VI_FRAME* f = (const VI_FRAME*)arg;
+    VI_BAND* cache = &vi_bands[band];
+    CCVG* viaa = &cache->viaa[0][1];
+    CCVG* viaa_next = &cache->viaa[1][1];
+    CCVG* divot = &cache->divot[0][1];
+    CCVG* divot_next = &cache->divot[1][1];
+    CCVG* tempccvgptr;
+    const int j_begin = f->vres * band / f->bands;
+    const int j_end = f->vres * (band + 1) / f->bands;
+    uint32_t seed = vi_seed_after(f->seed, (uint32_t)j_begin * f->hres);
+    uint32_t prevy = 0;
+    int i, j;
+
+    for (j = j_begin; j < j_end; j++)
+    {
+        const uint32_t y_start = f->y_start + j * f->y_add;
+        uint32_t* scanline = &blitter_buf_lock[f->prescale_ptr + j * f->linecount];
+
+        if ((y_start >> 10) == prevy + 1 && j != j_begin)
+        {
+            tempccvgptr = viaa;
+            viaa = viaa_next;
+            viaa_next = tempccvgptr;
+            tempccvgptr = divot;
+            divot = divot_next;
+            divot_next = tempccvgptr;
+            vi_fetch_row(f, viaa_next, divot_next, (y_start >> 10) + 1);
+        }
+        else if ((y_start >> 10) != prevy || j == j_begin)
+        {
+            vi_fetch_row(f, viaa, divot, y_start >> 10);
+            vi_fetch_row(f, viaa_next, divot_next, (y_start >> 10) + 1);
+        }
+        prevy = y_start >> 10;
+
+        if (f->divot)
+            vi_lerp_row(f, scanline, divot, divot_next, (y_start >> 5) & 0x1f);
+        else
+            vi_lerp_row(f, scanline, viaa, viaa_next, (y_start >> 5) & 0x1f);
+
+        if (f->gamma_and_dither)
+            vi_gamma_row(scanline, f->hres, f->gamma_and_dither, &seed);
+        if (f->slowbright)
+            for (i = 0; i < f->hres; i++)
+                scanline[i] = adjust_brightness(scanline[i], f->slowbright);
+    }
+}
+
 static void do_frame_buffer_proper(
     uint32_t prescale_ptr, int hres, int vres, int x_start, int vitype,
     int linecount)
 {
-    CCVG viaa_array[2048];
-    CCVG divot_array[2048];
-    CCVG *viaa_cache, *viaa_cache_next, *divot_cache, *divot_cache_next;
-    CCVG *tempccvgptr;
-    CCVG color, nextcolor, scancolor, scannextcolor;
-    uint32_t * scanline;
-    uint32_t pixels = 0, nextpixels = 0;
-    uint32_t prevy = 0;
-    uint32_t y_start = (vi_y_scale >> 16) & 0x0FFF;
-	uint32_t frame_buffer = vi_origin & 0x00FFFFFF;
-    signed int cache_marker_init;
-    int line_x = 0, next_line_x = 0, prev_line_x = 0, far_line_x = 0;
-    int prev_scan_x = 0, scan_x = 0, next_scan_x = 0, far_scan_x = 0;
-    int prev_x = 0, cur_x = 0, next_x = 0, far_x = 0;
-    int cache_marker = 0, cache_next_marker = 0, divot_cache_marker = 0, divot_cache_next_marker = 0;
-    int xfrac = 0, yfrac = 0;
-    int slowbright;
-    int lerping = 0;
-    int vi_width_low = vi_width & 0xFFF;
-    const int x_add = *GET_GFX_INFO(VI_X_SCALE_REG) & 0x00000FFF;
-    uint32_t y_add = vi_y_scale & 0xfff;
-    register int i, j;
+    VI_FRAME f;
+    unsigned bands;
+    int last_line_x;
+    const uint32_t frame_buffer = vi_origin & 0x00FFFFFF;
     const int gamma_dither     = !!(*GET_GFX_INFO(VI_STATUS_REG) & 0x00000004);
     const int gamma            = !!(*GET_GFX_INFO(VI_STATUS_REG) & 0x00000008);
     const int divot            = !!(*GET_GFX_INFO(VI_STATUS_REG) & 0x00000010);
@@ -433,277 +779,52 @@ static void do_frame_buffer_proper(
             "turning this bit on will result in permanent damage to the "\
             "hardware! Emulation will now continue.");
 
-    viaa_cache = &viaa_array[0];
-    viaa_cache_next = &viaa_array[1024];
-    divot_cache = &divot_array[0];
-    divot_cache_next = &divot_array[1024];
-
-    cache_marker_init  = (x_start >> 10) - 2;
-    cache_marker_init |= -(cache_marker_init < 0);
-
-    slowbright = 0;
+    /* Each scanline starts at the x_start of VI_X_SCALE_REG. */
+    x_start = (vi_x_scale >> 16) & 0x0FFF;
+
+    f.frame_buffer = frame_buffer;
+    f.vi_width_low = vi_width & 0xFFF;
+    f.prescale_ptr = prescale_ptr;
+    f.linecount = linecount;
+    f.hres = hres;
+    f.vres = vres;
+    f.x_start = x_start;
+    f.x_add = *GET_GFX_INFO(VI_X_SCALE_REG) & 0x00000FFF;
+    f.y_start = (vi_y_scale >> 16) & 0x0FFF;
+    f.y_add = vi_y_scale & 0xfff;
+    f.vitype = vitype;
+    f.fsaa = fsaa;
+    f.dither_filter = dither_filter;
+    f.divot = divot;
+    f.lerp_en = lerp_en;
+    f.gamma_and_dither = gamma_and_dither;
+
+    f.slowbright = 0;
 #if 0
     if (GetAsyncKeyState(0x91))
         brightness = ++brightness & 0xF;
-    slowbright = brightness >> 1;
+    f.slowbright = brightness >> 1;
 #endif
-    pixels = 0;
-
-    for (j = 0; j < vres; j++)
-    {
-        x_start = (vi_x_scale >> 16) & 0x0FFF;
 
-        if ((y_start >> 10) == (prevy + 1) && j)
-        {
-            cache_marker = cache_next_marker;
-            cache_next_marker = cache_marker_init;
-
-            tempccvgptr = viaa_cache;
-            viaa_cache = viaa_cache_next;
-            viaa_cache_next = tempccvgptr;
-            if (divot == 0)
-                {/* do nothing and branch */}
-            else
-            {
-                divot_cache_marker = divot_cache_next_marker;
-                divot_cache_next_marker = cache_marker_init;
-                tempccvgptr = divot_cache;
-                divot_cache = divot_cache_next;
-                divot_cache_next = tempccvgptr;
-            }
-        }
-        else if ((y_start >> 10) != prevy || !j)
-        {
-            cache_marker = cache_next_marker = cache_marker_init;
-            if (divot == 0)
-                {/* do nothing and branch */}
-            else
-                divot_cache_marker
-              = divot_cache_next_marker
-              = cache_marker_init;
-        }
-
-        scanline = &blitter_buf_lock[prescale_ptr];
-        prescale_ptr += linecount;
-
-        prevy = y_start >> 10;
-        yfrac = (y_start >> 5) & 0x1f;
-        pixels = vi_width_low * prevy;
-        nextpixels = pixels + vi_width_low;
+    /* The lerps read line_x and line_x + 1, the divot filter one more
+     * pixel on each side of those. */
+    last_line_x = (x_start + (hres - 1) * f.x_add) >> 10;
+    f.first_x = (x_start >> 10) - divot;
+    f.last_x = last_line_x + 1 + divot;
+    f.seed = (uint32_t)iseed;
 
-        for (i = 0; i < hres; i++)
-        {
-            unsigned char argb[4];
-
-            line_x = x_start >> 10;
-            prev_line_x = line_x - 1;
-            next_line_x = line_x + 1;
-            far_line_x = line_x + 2;
-
-            cur_x = pixels + line_x;
-            prev_x = pixels + prev_line_x;
-            next_x = pixels + next_line_x;
-            far_x = pixels + far_line_x;
-
-            scan_x = nextpixels + line_x;
-            prev_scan_x = nextpixels + prev_line_x;
-            next_scan_x = nextpixels + next_line_x;
-            far_scan_x = nextpixels + far_line_x;
-
-            xfrac = (x_start >> 5) & 0x1f;
-            lerping = lerp_en & (xfrac || yfrac);
-
-            if (prev_line_x > cache_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[prev_line_x], frame_buffer, prev_x, fsaa,
-                    dither_filter);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[line_x], frame_buffer, cur_x, fsaa,
-                    dither_filter);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[next_line_x], frame_buffer, next_x, fsaa,
-                    dither_filter);
-                cache_marker = next_line_x;
-            }
-            else if (line_x > cache_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[line_x], frame_buffer, cur_x, fsaa,
-                    dither_filter);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[next_line_x], frame_buffer, next_x, fsaa,
-                    dither_filter);
-                cache_marker = next_line_x;
-            }
-            else if (next_line_x > cache_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[next_line_x], frame_buffer, next_x, fsaa,
-                    dither_filter);
-                cache_marker = next_line_x;
-            }
-
-            if (prev_line_x > cache_next_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[prev_line_x], frame_buffer, prev_scan_x,
-                    fsaa, dither_filter);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[line_x], frame_buffer, scan_x, fsaa,
-                    dither_filter);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[next_line_x], frame_buffer, next_scan_x,
-                    fsaa, dither_filter);
-                cache_next_marker = next_line_x;
-            }
-            else if (line_x > cache_next_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[line_x], frame_buffer, scan_x, fsaa,
-                    dither_filter);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[next_line_x], frame_buffer, next_scan_x,
-                    fsaa, dither_filter);
-                cache_next_marker = next_line_x;
-            }
-            else if (next_line_x > cache_next_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[next_line_x], frame_buffer, next_scan_x,
-                    fsaa, dither_filter);
-                cache_next_marker = next_line_x;
-            }
-
-            if (divot == 0)
-                color = viaa_cache[line_x];
-            else
-            {
-                if (far_line_x > cache_marker)
-                {
-                    vi_fetch_filter_func[vitype & 1](
-                        &viaa_cache[far_line_x], frame_buffer, far_x, fsaa,
-                        dither_filter);
-                    cache_marker = far_line_x;
-                }
-
-                if (far_line_x > cache_next_marker)
-                {
-                    vi_fetch_filter_func[vitype & 1](
-                        &viaa_cache_next[far_line_x], frame_buffer, far_scan_x,
-                        fsaa, dither_filter);
-                    cache_next_marker = far_line_x;
-                }
-
-                if (line_x > divot_cache_marker)
-                {
-                    divot_filter(
-                        &divot_cache[line_x], viaa_cache[line_x],
-                        viaa_cache[prev_line_x], viaa_cache[next_line_x]);
-                    divot_filter(
-                        &divot_cache[next_line_x], viaa_cache[next_line_x],
-                        viaa_cache[line_x], viaa_cache[far_line_x]);
-                    divot_cache_marker = next_line_x;
-                }
-                else if (next_line_x > divot_cache_marker)
-                {
-                    divot_filter(
-                        &divot_cache[next_line_x], viaa_cache[next_line_x],
-                        viaa_cache[line_x], viaa_cache[far_line_x]);
-                    divot_cache_marker = next_line_x;
-                }
-
-                if (line_x > divot_cache_next_marker)
-                {
-                    divot_filter(
-                        &divot_cache_next[line_x], viaa_cache_next[line_x],
-                        viaa_cache_next[prev_line_x],
-                        viaa_cache_next[next_line_x]);
-                    divot_filter(
-                        &divot_cache_next[next_line_x],
-                        viaa_cache_next[next_line_x], viaa_cache_next[line_x],
-                        viaa_cache_next[far_line_x]);
-                    divot_cache_next_marker = next_line_x;
-                }
-                else if (next_line_x > divot_cache_next_marker)
-                {
-                    divot_filter(
-                        &divot_cache_next[next_line_x],
-                        viaa_cache_next[next_line_x], viaa_cache_next[line_x],
-                        viaa_cache_next[far_line_x]);
-                    divot_cache_next_marker = next_line_x;
-                }
-                color = divot_cache[line_x];
-            }
-
-            if (lerping)
-            {
-                if (divot == 0)
-                { /* branch unlikely */
-                    nextcolor = viaa_cache[next_line_x];
-                    scancolor = viaa_cache_next[line_x];
-                    scannextcolor = viaa_cache_next[next_line_x];
-                }
-                else
-                {
-                    nextcolor = divot_cache[next_line_x];
-                    scancolor = divot_cache_next[line_x];
-                    scannextcolor = divot_cache_next[next_line_x];
-                }
-                if (yfrac == 0)
-                    {}
-                else
-                {
-                    vi_vl_lerp(&color, scancolor, yfrac);
-                    vi_vl_lerp(&nextcolor, scannextcolor, yfrac);
-                }
-                if (xfrac == 0)
-                    {}
-                else
-                    vi_vl_lerp(&color, nextcolor, xfrac);
-            }
-            argb[1 ^ BYTE_ADDR_XOR] = color.r;
-            argb[2 ^ BYTE_ADDR_XOR] = color.g;
-            argb[3 ^ BYTE_ADDR_XOR] = color.b;
-
-            gamma_filters(argb, gamma_and_dither);
-#ifdef BW_ZBUFFER
-            uint32_t tempz = RREADIDX16((frame_buffer >> 1) + cur_x);
-
-            pix = tempz;
-            argb[1 ^ 3] = argb[2 ^ 3] = argb[3 ^ 3] = pix >> 8;
-#endif
-#ifdef ZBUFF_AS_16B_IATEXTURE
-            argb[1 ^ 3] = argb[2 ^ 3] = argb[3 ^ 3] =
-                (unsigned char)(pix >> 8)*(unsigned char)(pix >> 0) >> 8;
-#endif
-#ifdef RENDER_CVG_BITS16
-            argb[1 ^ 3] = argb[2 ^ 3] = argb[3 ^ 3] = cur_cvg << 5;
-#endif
-#ifdef RENDER_CVG_BITS32
-            argb[1 ^ 3] = argb[2 ^ 3] = argb[3 ^ 3] = cur_cvg << 5;
-#endif
-#ifdef RENDER_MIN_CVG_ONLY
-            if (!cur_cvg)
-                argb[1 ^ 3] = argb[2 ^ 3] = argb[3 ^ 3] = 0x00;
-            else
-                argb[1 ^ 3] = argb[2 ^ 3] = argb[3 ^ 3] = 0xFF;
-#endif
-#ifdef RENDER_MAX_CVG_ONLY
-            if (cur_cvg != 7)
-                argb[1 ^ 3] = argb[2 ^ 3] = argb[3 ^ 3] = 0x00;
-            else
-                argb[1 ^ 3] = argb[2 ^ 3] = argb[3 ^ 3] = 0xFF;
-#endif
-            x_start += x_add;
-            scanline[i] = *(int32_t *)(argb);
-            if (slowbright == 0)
-                continue;
-            adjust_brightness(argb, slowbright);
-            scanline[i] = *(int32_t *)(argb);
-        }
-        y_start += y_add;
+    bands = 1;
+    if (hres * vres >= VI_BAND_MIN_PIXELS)
+    {
+        bands = workers_count();
+        if (bands > (unsigned)vres / VI_BAND_MIN_ROWS)
+            bands = (unsigned)vres / VI_BAND_MIN_ROWS;
     }
+    f.bands = bands;
+    workers_run(vi_band, &f, bands);
+
+    if (gamma_and_dither & 1)
+        iseed = (int32_t)vi_seed_after(f.seed, (uint32_t)hres * vres);
 }
 static void do_frame_buffer_raw(
     uint32_t prescale_ptr, int hres, int vres, int x_start, int vitype,
@@ -1124,22 +1245,21 @@ STRICTINLINE static void restore_filter32(
     *b = bend;
 }
 
-static void gamma_filters(unsigned char* argb, int gamma_and_dither)
+/* On 0x00RRGGBB pixels. */
+STRICTINLINE static uint32_t gamma_filters(
+    uint32_t pix, int gamma_and_dither, uint32_t* seed)
 {
     int cdith, dith;
     int r, g, b;
 
-    if (gamma_and_dither == 0)
-       return;
-
-    r = argb[1 ^ BYTE_ADDR_XOR];
-    g = argb[2 ^ BYTE_ADDR_XOR];
-    b = argb[3 ^ BYTE_ADDR_XOR];
+    r = (pix >> 16) & 0xFF;
+    g = (pix >>  8) & 0xFF;
+    b = (pix >>  0) & 0xFF;
 
     switch(gamma_and_dither)
     {
         case 1:
-            cdith = irand();
+            cdith = vi_irand(seed);
             dith = cdith & 1;
             if (r < 255)
                 r += dith;
@@ -1156,7 +1276,7 @@ static void gamma_filters(unsigned char* argb, int gamma_and_dither)
             b = gamma_table[b];
             break;
         case 3:
-            cdith = irand();
+            cdith = vi_irand(seed);
             dith = cdith & 0x3f;
             r = gamma_dither_table[(r << 6) | dith];
             dith = (cdith >> 6) & 0x3f;
@@ -1165,18 +1285,16 @@ static void gamma_filters(unsigned char* argb, int gamma_and_dither)
             b = gamma_dither_table[(b << 6) | dith];
             break;
     }
-    argb[1 ^ BYTE_ADDR_XOR] = (unsigned char)(r);
-    argb[2 ^ BYTE_ADDR_XOR] = (unsigned char)(g);
-    argb[3 ^ BYTE_ADDR_XOR] = (unsigned char)(b);
+    return ((r & 0xFF) << 16) | ((g & 0xFF) << 8) | (b & 0xFF);
 }
 
-static void adjust_brightness(unsigned char* argb, int brightcoeff)
+static uint32_t adjust_brightness(uint32_t pix, int brightcoeff)
 {
     int r, g, b;
 
-    r = argb[1 ^ BYTE_ADDR_XOR];
-    g = argb[2 ^ BYTE_ADDR_XOR];
-    b = argb[3 ^ BYTE_ADDR_XOR];
+    r = (pix >> 16) & 0xFF;
+    g = (pix >>  8) & 0xFF;
+    b = (pix >>  0) & 0xFF;
     brightcoeff &= 7;
     switch (brightcoeff)
     {
@@ -1210,9 +1328,7 @@ static void adjust_brightness(unsigned char* argb, int brightcoeff)
                 b = 0xFF;
             break;
     }
-    argb[1 ^ BYTE_ADDR_XOR] = (unsigned char)(r);
-    argb[2 ^ BYTE_ADDR_XOR] = (unsigned char)(g);
-    argb[3 ^ BYTE_ADDR_XOR] = (unsigned char)(b);
+    return ((r & 0xFF) << 16) | ((g & 0xFF) << 8) | (b & 0xFF);
 }
 
 STRICTINLINE static void vi_vl_lerp(CCVG* up, CCVG down, uint32_t frac)
@@ -0,0 +1,188 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "workers.h"
+
+static unsigned requested_threads = 0;
+
+void angrylion_set_threads(unsigned count)
+{
+    requested_threads = count;
+}
+
+#ifdef HAVE_THREADED_EMU
+#include <pthread.h>
+#include <unistd.h>
+
+static struct
+{
+    unsigned wanted;        /* count asked for when started */
+    unsigned count;         /* threads, the caller included; 0 until started */
+    int quit;
+    pthread_t threads[WORKERS_MAX - 1];
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+
+    /* The job, written under lock. Tasks are handed out in order from
+     * next, pending counts those not finished yet. */
+    void (*task)(void*, unsigned);
+    void* arg;
+    unsigned tasks;
+    unsigned next;
+    unsigned pending;
+} pool;
+
+static __thread unsigned thread_index; /* 0 on the callers of workers_run() */
+
+static unsigned wanted_threads(void)
+{
+    long cores;
+
+    if (requested_threads)
+        return requested_threads < WORKERS_MAX ? requested_threads : WORKERS_MAX;
+
+    cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1)
+        return 1;
+    return cores < WORKERS_MAX ? (unsigned)cores : WORKERS_MAX;
+}
+
+/* Runs the job's tasks until none is left. Called and returns with the
+ * lock held. */
+static void run_tasks(void)
+{
+    while (pool.next < pool.tasks)
+    {
+        unsigned index = pool.next++;
+
+        pthread_mutex_unlock(&pool.lock);
+        pool.task(pool.arg, index);
+        pthread_mutex_lock(&pool.lock);
+
+        if (--pool.pending == 0)
+            pthread_cond_signal(&pool.done);
+    }
+}
+
+static void* worker_main(void* index)
+{
+    thread_index = (unsigned)(uintptr_t)index;
+
+    pthread_mutex_lock(&pool.lock);
+    while (!pool.quit)
+    {
+        run_tasks();
+        if (!pool.quit)
+            pthread_cond_wait(&pool.work, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+void workers_close(void)
+{
+    unsigned i;
+
+    if (pool.count == 0)
+        return;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.quit = 1;
+    pthread_cond_broadcast(&pool.work);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (i = 0; i < pool.count - 1; i++)
+        pthread_join(pool.threads[i], NULL);
+
+    pthread_cond_destroy(&pool.done);
+    pthread_cond_destroy(&pool.work);
+    pthread_mutex_destroy(&pool.lock);
+    pool.count = 0;
+}
+
+static void workers_start(unsigned count)
+{
+    unsigned i;
+
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.work, NULL);
+    pthread_cond_init(&pool.done, NULL);
+    pool.wanted = count;
+    pool.quit = 0;
+    pool.tasks = pool.next = pool.pending = 0;
+
+    for (i = 0; i < count - 1; i++)
+        if (pthread_create(&pool.threads[i], NULL, worker_main, (void*)(uintptr_t)(i + 1)))
+            break;
+    pool.count = i + 1;
+}
+
+unsigned workers_count(void)
+{
+    unsigned wanted = wanted_threads();
+
+    if (pool.count == 0 || pool.wanted != wanted)
+    {
+        workers_close();
+        workers_start(wanted);
+    }
+    return pool.count;
+}
+
+unsigned workers_thread(void)
+{
+    return thread_index;
+}
+
+void workers_run(void (*task)(void*, unsigned), void* arg, unsigned tasks)
+{
+    unsigned i;
+
+    if (tasks <= 1 || workers_count() == 1)
+    {
+        for (i = 0; i < tasks; i++)
+            task(arg, i);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.task = task;
+    pool.arg = arg;
+    pool.tasks = tasks;
+    pool.next = 0;
+    pool.pending = tasks;
+    pthread_cond_broadcast(&pool.work);
+
+    run_tasks();
+    while (pool.pending)
+        pthread_cond_wait(&pool.done, &pool.lock);
+    pool.tasks = 0;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+#else
+
+unsigned workers_count(void)
+{
+    return 1;
+}
+
+unsigned workers_thread(void)
+{
+    return 0;
+}
+
+void workers_run(void (*task)(void*, unsigned), void* arg, unsigned tasks)
+{
+    unsigned i;
+
+    for (i = 0; i < tasks; i++)
+        task(arg, i);
+}
+
+void workers_close(void)
+{
+}
+
+#endif
@@ -59,5 +59,6 @@ void lookup_cvmask_derivatives(uint32_t mask, uint8_t* offx, uint8_t* offy, uint
 extern void rdp_init(void);
 extern void rdp_close(void);
 extern void rdp_update(void);
+extern void rdp_flush(void);
 
 #endif
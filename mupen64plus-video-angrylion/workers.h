@@ -0,0 +1,24 @@
+#ifndef _WORKERS_H_
+#define _WORKERS_H_
+
+/* Threads running angrylion's parallel work, the caller included. */
+#define WORKERS_MAX 8
+
+/* 0 starts one thread per core, up to WORKERS_MAX. Takes effect on the
+ * next workers_run(). */
+void angrylion_set_threads(unsigned count);
+
+unsigned workers_count(void);
+
+/* Index of the calling thread in the pool, below WORKERS_MAX: 0 for the
+ * thread calling workers_run(), 1 and up for the pool's own. */
+unsigned workers_thread(void);
+
+/* Runs task(arg, 0) to task(arg, tasks - 1) on the pool and the calling
+ * thread, and returns once they are all done. Without thread support the
+ * tasks run in order on the caller. */
+void workers_run(void (*task)(void*, unsigned), void* arg, unsigned tasks);
+
+void workers_close(void);
+
+#endif
@@ -147,6 +147,7 @@ private:
 	CombinerInfo(const CombinerInfo &);
 
 	void _saveShadersStorage() const;
+	void _appendShadersStorage(const ShaderCombiner * _pCombiner);
 	bool _loadShadersStorage();
 	uint32_t _getConfigOptionsBitSet() const;
 	ShaderCombiner * _compile(uint64_t mux) const;
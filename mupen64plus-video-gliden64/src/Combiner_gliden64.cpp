@@ -1,6 +1,11 @@
+#include <algorithm>
 #include <fstream>
 #include <functional>
+#include <sstream>
 #include <stdio.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
 
 #include "OpenGL.h"
 #include "Combiner.h"
@@ -104,9 +109,14 @@ void CombinerInfo::init()
 #ifdef GL_NUM_PROGRAM_BINARY_FORMATS
 	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
 #endif
+#ifdef GLIDEN64ES
+	// The GLES2 combiner can't serialize its programs.
+	m_bShaderCacheSupported = false;
+#else
 	m_bShaderCacheSupported = config.generalEmulation.enableShadersStorage != 0 &&
 								OGLVideo::isExtensionSupported(GET_PROGRAM_BINARY_EXTENSION) &&
 								numBinaryFormats > 0;
+#endif
 
 	m_shadersLoaded = 0;
 	if (m_bShaderCacheSupported && !_loadShadersStorage())
@@ -114,6 +124,9 @@ void CombinerInfo::init()
 		for (Combiners::iterator cur = m_combiners.begin(); cur != m_combiners.end(); ++cur)
 			delete cur->second;
 		m_combiners.clear();
+		m_shadersLoaded = 0;
+		// Start over with an empty file, new programs are appended to it.
+		_saveShadersStorage();
 	}
 }
 
@@ -122,7 +135,7 @@ void CombinerInfo::destroy()
 	delete m_pUniformCollection;
 	m_pUniformCollection = NULL;
 	m_pCurrent = NULL;
-	if (m_bShaderCacheSupported)
+	if (m_bShaderCacheSupported && m_shadersLoaded < m_combiners.size())
 		_saveShadersStorage();
 	m_shadersLoaded = 0;
 	for (Combiners::iterator cur = m_combiners.begin(); cur != m_combiners.end(); ++cur)
@@ -276,6 +289,8 @@ void CombinerInfo::setCombine(uint64_t _mux )
 		m_pCurrent->update(true);
 		m_pUniformCollection->bindWithShaderCombiner(m_pCurrent);
 		m_combiners[_mux] = m_pCurrent;
+		if (m_bShaderCacheSupported)
+			_appendShadersStorage(m_pCurrent);
 	}
 	m_bChanged = true;
 }
@@ -347,10 +362,196 @@ uint32_t CombinerInfo::_getConfigOptionsBitSet() const
 	return optionsSet;
 }
 
+#ifndef GLIDEN64ES
+// Shader storage: one file per ROM in the user cache folder.
+//   header:  magic, format version, config options bitset,
+//            length + GL vendor/renderer/version string
+//   records: size, checksum, then a program written by ShaderCombiner's operator<<
+// Records are appended as combiners get compiled. A file written for other
+// options, another driver or an older format is thrown away, as is one with a
+// damaged record or a program the driver refuses to load.
+static const uint32_t ShaderStorageMagic = 0x53364E47; // 'GN6S'
+static const uint32_t ShaderStorageFormatVersion = 0x01U;
+static const uint32_t ShaderStorageMaxRecordSize = 8 * 1024 * 1024;
+
+static
+uint32_t storageChecksum(const void * _data, size_t _size)
+{
+	// FNV-1a
+	const uint8_t * p = (const uint8_t*)_data;
+	uint32_t hash = 0x811C9DC5U;
+	for (size_t i = 0; i < _size; ++i)
+		hash = (hash ^ p[i]) * 0x01000193U;
+	return hash;
+}
+
+static
+bool getStorageFileName(std::string & _fileName)
+{
+	wchar_t strCacheFolderPath[PATH_MAX_LENGTH];
+	strCacheFolderPath[0] = 0;
+	api().GetUserCachePath(strCacheFolderPath);
+	if (strCacheFolderPath[0] == 0)
+		return false;
+
+	_fileName.clear();
+	for (const wchar_t * c = strCacheFolderPath; *c != 0; ++c)
+		_fileName.push_back((char)*c);
+
+	char strName[64];
+	sprintf(strName, "/GLideN64.%08x.shaders", storageChecksum(__RSP.romname, strlen(__RSP.romname)));
+	_fileName.append(strName);
+	return true;
+}
+
+static
+std::string getDriverString()
+{
+	static const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	std::string strDriver;
+	for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+		const char * str = (const char*)glGetString(names[i]);
+		if (str != NULL)
+			strDriver.append(str);
+		strDriver.push_back('\n');
+	}
+	return strDriver;
+}
+
+static
+void writeStorageHeader(std::ostream & _os, uint32_t _optionsBitSet)
+{
+	const std::string strDriver = getDriverString();
+	const uint32_t len = strDriver.size();
+	_os.write((const char*)&ShaderStorageMagic, sizeof(ShaderStorageMagic));
+	_os.write((const char*)&ShaderStorageFormatVersion, sizeof(ShaderStorageFormatVersion));
+	_os.write((const char*)&_optionsBitSet, sizeof(_optionsBitSet));
+	_os.write((const char*)&len, sizeof(len));
+	_os.write(strDriver.data(), len);
+}
+
+static
+bool checkStorageHeader(std::istream & _is, uint32_t _optionsBitSet)
+{
+	uint32_t magic = 0, version = 0, optionsBitSet = 0, len = 0;
+	_is.read((char*)&magic, sizeof(magic));
+	_is.read((char*)&version, sizeof(version));
+	_is.read((char*)&optionsBitSet, sizeof(optionsBitSet));
+	_is.read((char*)&len, sizeof(len));
+	if (!_is || magic != ShaderStorageMagic || version != ShaderStorageFormatVersion || optionsBitSet != _optionsBitSet)
+		return false;
+
+	const std::string strDriver = getDriverString();
+	if (len != strDriver.size())
+		return false;
+	std::vector<char> strStored(len);
+	_is.read(strStored.data(), len);
+	return _is && std::equal(strStored.begin(), strStored.end(), strDriver.begin());
+}
+
+static
+bool writeStorageRecord(std::ostream & _os, const ShaderCombiner & _combiner)
+{
+	std::ostringstream record;
+	record << _combiner;
+	const std::string data = record.str();
+	if (data.empty())
+		return false;
+
+	const uint32_t size = data.size();
+	const uint32_t checksum = storageChecksum(data.data(), size);
+	_os.write((const char*)&size, sizeof(size));
+	_os.write((const char*)&checksum, sizeof(checksum));
+	_os.write(data.data(), size);
+	return _os.good();
+}
+
+void CombinerInfo::_saveShadersStorage() const
+{
+	std::string fileName;
+	if (!getStorageFileName(fileName))
+		return;
+
+	std::ofstream fout(fileName.c_str(), std::ofstream::binary | std::ofstream::trunc);
+	if (!fout)
+		return;
+
+	writeStorageHeader(fout, _getConfigOptionsBitSet());
+	for (Combiners::const_iterator cur = m_combiners.begin(); cur != m_combiners.end(); ++cur)
+		writeStorageRecord(fout, *(cur->second));
+}
+
+void CombinerInfo::_appendShadersStorage(const ShaderCombiner * _pCombiner)
+{
+	// Everything but the new program must already be on disk, otherwise
+	// the whole file gets rewritten in destroy().
+	if (m_shadersLoaded + 1 != m_combiners.size())
+		return;
+
+	std::string fileName;
+	if (!getStorageFileName(fileName))
+		return;
+
+	std::ofstream fout(fileName.c_str(), std::ofstream::binary | std::ofstream::app);
+	if (fout && writeStorageRecord(fout, *_pCombiner))
+		++m_shadersLoaded;
+}
+
+bool CombinerInfo::_loadShadersStorage()
+{
+	std::string fileName;
+	if (!getStorageFileName(fileName))
+		return false;
+
+	std::ifstream fin(fileName.c_str(), std::ifstream::binary);
+	if (!fin)
+		return false;
+
+	if (!checkStorageHeader(fin, _getConfigOptionsBitSet())) {
+		LOG(LOG_VERBOSE, "Shader storage %s is out of date\n", fileName.c_str());
+		return false;
+	}
+
+	std::vector<char> data;
+	while (true) {
+		uint32_t size, checksum;
+		fin.read((char*)&size, sizeof(size));
+		if (fin.gcount() == 0 && fin.eof())
+			break;
+		fin.read((char*)&checksum, sizeof(checksum));
+		if (!fin || size == 0 || size > ShaderStorageMaxRecordSize)
+			return false;
+
+		data.resize(size);
+		fin.read(data.data(), size);
+		if (!fin || storageChecksum(data.data(), size) != checksum)
+			return false;
+
+		std::istringstream record(std::string(data.data(), size));
+		ShaderCombiner * pCombiner = new ShaderCombiner();
+		record >> *pCombiner;
+		if (!record || m_combiners.find(pCombiner->getMux()) != m_combiners.end()) {
+			delete pCombiner;
+			return false;
+		}
+		pCombiner->update(true);
+		m_pUniformCollection->bindWithShaderCombiner(pCombiner);
+		m_combiners[pCombiner->getMux()] = pCombiner;
+		++m_shadersLoaded;
+	}
+
+	LOG(LOG_VERBOSE, "Loaded %u shaders from %s\n", m_shadersLoaded, fileName.c_str());
+	return true;
+}
+#else // GLIDEN64ES
 void CombinerInfo::_saveShadersStorage() const
 {}
 
+void CombinerInfo::_appendShadersStorage(const ShaderCombiner * _pCombiner)
+{}
+
 bool CombinerInfo::_loadShadersStorage()
 {
 	return true;
 }
+#endif // GLIDEN64ES
@@ -90,6 +90,7 @@ struct gliden64_config
 		uint32_t txFilterMode;				// Texture filtering mode, eg Sharpen
 		uint32_t txEnhancementMode;			// Texture enhancement mode, eg 2xSAI
 		uint32_t txFilterIgnoreBG;			// Do not apply filtering to backgrounds textures
+		uint32_t txEnhancementAsync;		// Filter textures on worker threads, use them unfiltered until done
 		uint32_t txCacheSize;				// Cache size in Mbytes
 
 		uint32_t txHiresEnable;				// Use high-resolution texture packs
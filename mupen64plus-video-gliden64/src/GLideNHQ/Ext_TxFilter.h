@@ -97,7 +97,7 @@ typedef unsigned char boolean;
 #define DUMP_TEXCACHE       0x01000000
 #define DUMP_HIRESTEXCACHE  0x02000000
 #define TILE_HIRESTEX       0x04000000
-#define UNDEFINED_0         0x08000000
+#define ASYNC_TEXFILTER     0x08000000 /* filter on worker threads, see txfilter_fetch */
 #define FORCE16BPP_HIRESTEX 0x10000000
 #define FORCE16BPP_TEX      0x20000000
 #define LET_TEXARTISTS_FLY  0x40000000 /* a little freedom for texture artists */
@@ -227,6 +227,12 @@ TAPI boolean TAPIENTRY
 txfilter_filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
 		 uint64 g64crc, GHQTexInfo *info);
 
+/* With ASYNC_TEXFILTER, txfilter_filter returns 0 for a texture it has queued
+ * for filtering. Returns 1 and the filtered texture once it is done, 0 while
+ * it is waiting and -1 if it was not queued. */
+TAPI int TAPIENTRY
+txfilter_fetch(uint64 g64crc, GHQTexInfo *info);
+
 TAPI boolean TAPIENTRY
 txfilter_hirestex(uint64 g64crc, uint64 r_crc64, uint16 *palette, GHQTexInfo *info);
 
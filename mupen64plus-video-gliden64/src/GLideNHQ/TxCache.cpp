@@ -31,12 +31,71 @@
 #include <zlib.h>
 #include <memory.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Cache file layout, in native byte order:
+ *   TXPACKHEADER
+ *   TXPACKENTRY[count], sorted by checksum
+ *   texture data of each entry, TXPACK_ALIGN aligned; zlib compressed if
+ *   the entry format has GL_TEXFMT_GZ, ready to upload otherwise.
+ * The file is mapped read-only and looked up with a binary search, so a
+ * texture is only read from disk, and decompressed, when it is used.
+ */
+#define TXPACK_MAGIC   0x50514847 /* "GHQP" */
+#define TXPACK_VERSION 1
+#define TXPACK_ALIGN   16
+
+/* fixed size types, uint32 is a long */
+struct TXPACKHEADER {
+	uint32_t magic;
+	uint32_t version;
+	int32_t config;
+	uint32_t count;
+};
+
+struct TxCache::TXPACKENTRY {
+	uint64_t checksum;
+	uint64_t offset;
+	uint32_t size;
+	int32_t width;
+	int32_t height;
+	uint32_t format;
+	uint16_t texture_format;
+	uint16_t pixel_type;
+	uint8_t is_hires_tex;
+	uint8_t pad[7];
+};
+
+/* entries allocated at a time */
+#define TXCACHE_CHUNK 256
+
+/* textures that zlib shrinks by less than 1/TXCACHE_GZ_GAIN are kept
+ * uncompressed, they would be inflated on every hit for little memory */
+#define TXCACHE_GZ_GAIN 8
+
+static uint64
+packAlign(uint64 offset)
+{
+	return (offset + TXPACK_ALIGN - 1) & ~(uint64)(TXPACK_ALIGN - 1);
+}
 
 TxCache::~TxCache()
 {
 	/* free memory, clean up, etc */
 	clear();
 
+	for (unsigned int i = 0; i < _entryChunks.size(); i++)
+		delete [] _entryChunks[i];
+
 	delete _txUtil;
 }
 
@@ -45,10 +104,21 @@ TxCache::TxCache(int options, int cachesize, const wchar_t *path, const wchar_t
 {
 	_txUtil = new TxUtil();
 
+	_packBase = NULL;
+	_packSize = 0;
+	_packIndex = NULL;
+	_packCount = 0;
+	_packMapping = NULL;
+
+	_freeEntries = NULL;
+	_oldest = NULL;
+	_newest = NULL;
+
 	_options = options;
 	_cacheSize = cachesize;
 	_callback = callback;
 	_totalSize = 0;
+	_totalRawSize = 0;
 
 	/* save path name */
 	if (path)
@@ -74,6 +144,41 @@ TxCache::TxCache(int options, int cachesize, const wchar_t *path, const wchar_t
 	}
 }
 
+TxCache::TXCACHE *
+TxCache::newEntry()
+{
+	if (!_freeEntries) {
+		TXCACHE *chunk = new TXCACHE[TXCACHE_CHUNK];
+		_entryChunks.push_back(chunk);
+		for (int i = 0; i < TXCACHE_CHUNK; i++) {
+			chunk[i].next = _freeEntries;
+			_freeEntries = &chunk[i];
+		}
+	}
+
+	TXCACHE *entry = _freeEntries;
+	_freeEntries = entry->next;
+	return entry;
+}
+
+void
+TxCache::removeEntry(TXCACHE *entry)
+{
+	/* unlink it from the LRU list */
+	if (entry->prev) entry->prev->next = entry->next;
+	else _oldest = entry->next;
+	if (entry->next) entry->next->prev = entry->prev;
+	else _newest = entry->prev;
+
+	_cache.erase(entry->checksum);
+	_totalSize -= entry->size;
+	_totalRawSize -= entry->rawSize;
+	free(entry->info.data);
+
+	entry->next = _freeEntries;
+	_freeEntries = entry;
+}
+
 boolean
 TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
 {
@@ -83,9 +188,10 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
 
 	uint8 *dest = info->data;
 	uint32 format = info->format;
+	int rawSize = _txUtil->sizeofTx(info->width, info->height, info->format & ~GL_TEXFMT_GZ);
 
 	if (!dataSize) {
-		dataSize = _txUtil->sizeofTx(info->width, info->height, info->format);
+		dataSize = rawSize;
 
 		if (!dataSize) return 0;
 
@@ -96,6 +202,9 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
 			if (compress2(dest, &destLen, info->data, dataSize, 1) != Z_OK) {
 				dest = info->data;
 				DBG_INFO(80, wst("Error: zlib compression failed!\n"));
+			} else if ((int)destLen > dataSize - dataSize / TXCACHE_GZ_GAIN) {
+				dest = info->data;
+				DBG_INFO(80, wst("zlib compression skipped: %.02fkb->%.02fkb\n"), (float)dataSize/1000, (float)destLen/1000);
 			} else {
 				DBG_INFO(80, wst("zlib compressed: %.02fkb->%.02fkb\n"), (float)dataSize/1000, (float)destLen/1000);
 				dataSize = destLen;
@@ -104,130 +213,219 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
 		}
 	}
 
-	/* if cache size exceeds limit, remove old cache */
-	if (_cacheSize > 0) {
-		_totalSize += dataSize;
-		if ((_totalSize > _cacheSize) && !_cachelist.empty()) {
-			/* _cachelist is arranged so that frequently used textures are in the back */
-			std::list<uint64>::iterator itList = _cachelist.begin();
-			while (itList != _cachelist.end()) {
-				/* find it in _cache */
-				std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(*itList);
-				if (itMap != _cache.end()) {
-					/* yep we have it. remove it. */
-					_totalSize -= (*itMap).second->size;
-					free((*itMap).second->info.data);
-					delete (*itMap).second;
-					_cache.erase(itMap);
-				}
-				itList++;
-
-				/* check if memory cache has enough space */
-				if (_totalSize <= _cacheSize)
-					break;
-			}
-			/* remove from _cachelist */
-			_cachelist.erase(_cachelist.begin(), itList);
+	/* replace an older version of it */
+	std::unordered_map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
+	if (itMap != _cache.end())
+		removeEntry((*itMap).second);
 
-			DBG_INFO(80, wst("+++++++++\n"));
-		}
-		_totalSize -= dataSize;
+	/* if cache size exceeds limit, remove the least recently used */
+	if (_cacheSize > 0 && _totalSize + dataSize > _cacheSize) {
+		while (_oldest && _totalSize + dataSize > _cacheSize)
+			removeEntry(_oldest);
+
+		DBG_INFO(80, wst("+++++++++\n"));
 	}
 
 	/* cache it */
 	uint8 *tmpdata = (uint8*)malloc(dataSize);
-	if (tmpdata) {
-		TXCACHE *txCache = new TXCACHE;
-		if (txCache) {
-			/* we can directly write as we filter, but for now we get away
-	   * with doing memcpy after all the filtering is done.
-	   */
-			memcpy(tmpdata, dest, dataSize);
-
-			/* copy it */
-			memcpy(&txCache->info, info, sizeof(GHQTexInfo));
-			txCache->info.data = tmpdata;
-			txCache->info.format = format;
-			txCache->size = dataSize;
-
-			/* add to cache */
-			if (_cacheSize > 0) {
-				_cachelist.push_back(checksum);
-				txCache->it = --(_cachelist.end());
-			}
-			/* _cache[checksum] = txCache; */
-			_cache.insert(std::map<uint64, TXCACHE*>::value_type(checksum, txCache));
+	if (!tmpdata)
+		return 0;
 
-#ifdef DEBUG
-			DBG_INFO(80, wst("[%5d] added!! crc:%08X %08X %d x %d gfmt:%x total:%.02fmb\n"),
-					 _cache.size(), (uint32)(checksum >> 32), (uint32)(checksum & 0xffffffff),
-					 info->width, info->height, info->format & 0xffff, (float)_totalSize/1000000);
+	/* we can directly write as we filter, but for now we get away
+	 * with doing memcpy after all the filtering is done.
+	 */
+	memcpy(tmpdata, dest, dataSize);
+
+	/* copy it */
+	TXCACHE *txCache = newEntry();
+	txCache->checksum = checksum;
+	txCache->info = *info;
+	txCache->info.data = tmpdata;
+	txCache->info.format = format;
+	txCache->size = dataSize;
+	txCache->rawSize = rawSize;
+
+	/* add to cache, as the most recently used */
+	txCache->prev = _newest;
+	txCache->next = NULL;
+	if (_newest) _newest->next = txCache;
+	else _oldest = txCache;
+	_newest = txCache;
+	_cache[checksum] = txCache;
+
+	/* total cache size */
+	_totalSize += dataSize;
+	_totalRawSize += rawSize;
 
-			if (_cacheSize > 0) {
-				DBG_INFO(80, wst("cache max config:%.02fmb\n"), (float)_cacheSize/1000000);
+#ifdef DEBUG
+	DBG_INFO(80, wst("[%5d] added!! crc:%08X %08X %d x %d gfmt:%x total:%.02fmb (%.02fmb decompressed)\n"),
+			 _cache.size(), (uint32)(checksum >> 32), (uint32)(checksum & 0xffffffff),
+			 info->width, info->height, info->format & 0xffff, (float)_totalSize/1000000, (float)_totalRawSize/1000000);
 
-				if (_cache.size() != _cachelist.size()) {
-					DBG_INFO(80, wst("Error: cache/cachelist mismatch! (%d/%d)\n"), _cache.size(), _cachelist.size());
-				}
-			}
+	if (_cacheSize > 0)
+		DBG_INFO(80, wst("cache max config:%.02fmb\n"), (float)_cacheSize/1000000);
 #endif
 
-			/* total cache size */
-			_totalSize += dataSize;
-
-			return 1;
-		}
-		free(tmpdata);
-	}
-
-	return 0;
+	return 1;
 }
 
 boolean
 TxCache::get(uint64 checksum, GHQTexInfo *info)
 {
-	if (!checksum || _cache.empty()) return 0;
+	if (!checksum || (_cache.empty() && !_packCount)) return 0;
+
+	uint32 dataSize;
 
 	/* find a match in cache */
-	std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
+	std::unordered_map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
 	if (itMap != _cache.end()) {
 		/* yep, we've got it. */
-		memcpy(info, &(((*itMap).second)->info), sizeof(GHQTexInfo));
-
-		/* push it to the back of the list */
-		if (_cacheSize > 0) {
-			_cachelist.erase(((*itMap).second)->it);
-			_cachelist.push_back(checksum);
-			((*itMap).second)->it = --(_cachelist.end());
+		TXCACHE *txCache = (*itMap).second;
+		*info = txCache->info;
+		dataSize = txCache->size;
+
+		/* move it to the back of the list */
+		if (txCache != _newest) {
+			if (txCache->prev) txCache->prev->next = txCache->next;
+			else _oldest = txCache->next;
+			txCache->next->prev = txCache->prev;
+
+			txCache->prev = _newest;
+			txCache->next = NULL;
+			_newest->next = txCache;
+			_newest = txCache;
 		}
+	} else {
+		/* then in the cache file */
+		const TXPACKENTRY *entry = findPacked(checksum);
+		if (!entry) return 0;
+
+		info->data = _packBase + entry->offset;
+		info->width = entry->width;
+		info->height = entry->height;
+		info->format = entry->format;
+		info->texture_format = entry->texture_format;
+		info->pixel_type = entry->pixel_type;
+		info->is_hires_tex = entry->is_hires_tex;
+		dataSize = entry->size;
+	}
 
-		/* zlib decompress it */
-		if (info->format & GL_TEXFMT_GZ) {
-			uint32 destLen = _gzdestLen;
-			uint8 *dest = (_gzdest0 == info->data) ? _gzdest1 : _gzdest0;
-			if (uncompress(dest, &destLen, info->data, ((*itMap).second)->size) != Z_OK) {
-				DBG_INFO(80, wst("Error: zlib decompression failed!\n"));
-				return 0;
-			}
-			info->data = dest;
-			info->format &= ~GL_TEXFMT_GZ;
-			DBG_INFO(80, wst("zlib decompressed: %.02fkb->%.02fkb\n"), (float)(((*itMap).second)->size)/1000, (float)destLen/1000);
+	/* zlib decompress it */
+	if (info->format & GL_TEXFMT_GZ) {
+		uint32 destLen = _gzdestLen;
+		uint8 *dest = (_gzdest0 == info->data) ? _gzdest1 : _gzdest0;
+		if (uncompress(dest, &destLen, info->data, dataSize) != Z_OK) {
+			DBG_INFO(80, wst("Error: zlib decompression failed!\n"));
+			return 0;
 		}
+		info->data = dest;
+		info->format &= ~GL_TEXFMT_GZ;
+		DBG_INFO(80, wst("zlib decompressed: %.02fkb->%.02fkb\n"), (float)dataSize/1000, (float)destLen/1000);
+	}
 
-		return 1;
+	return 1;
+}
+
+const TxCache::TXPACKENTRY *
+TxCache::findPacked(uint64 checksum)
+{
+	uint32 lo = 0, hi = _packCount;
+
+	while (lo < hi) {
+		uint32 mid = lo + ((hi - lo) >> 1);
+		if (_packIndex[mid].checksum < checksum)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
 
-	return 0;
+	if (lo < _packCount && _packIndex[lo].checksum == checksum)
+		return &_packIndex[lo];
+
+	return NULL;
+}
+
+void
+TxCache::unmapPack()
+{
+	if (_packBase) {
+#ifdef WIN32
+		UnmapViewOfFile(_packBase);
+		CloseHandle((HANDLE)_packMapping);
+#else
+		munmap(_packBase, _packSize);
+#endif
+	}
+
+	_packBase = NULL;
+	_packSize = 0;
+	_packIndex = NULL;
+	_packCount = 0;
+	_packMapping = NULL;
+}
+
+bool
+TxCache::checksumLess(const TXCACHE *a, const TXCACHE *b)
+{
+	return a->checksum < b->checksum;
 }
 
 boolean
 TxCache::save(const wchar_t *path, const wchar_t *filename, int config)
 {
+	/* nothing new since the cache file was loaded */
 	if (_cache.empty())
-		return true;
+		return 1;
+
+	/* merge the memory cache into the cache file, both are sorted by
+	 * checksum. textures in memory replace those in the file. */
+	std::vector<TXPACKENTRY> index;
+	std::vector<const uint8*> data;
+	std::vector<TXCACHE*> sorted;
+	std::unordered_map<uint64, TXCACHE*>::iterator itMap;
+	for (itMap = _cache.begin(); itMap != _cache.end(); ++itMap)
+		sorted.push_back((*itMap).second);
+	std::sort(sorted.begin(), sorted.end(), checksumLess);
+
+	std::vector<TXCACHE*>::iterator it = sorted.begin();
+	uint32 i = 0;
+	while (it != sorted.end() || i < _packCount) {
+		TXPACKENTRY entry;
+		if (i < _packCount && (it == sorted.end() || _packIndex[i].checksum < (*it)->checksum)) {
+			entry = _packIndex[i];
+			data.push_back(_packBase + entry.offset);
+			i++;
+		} else {
+			if (i < _packCount && _packIndex[i].checksum == (*it)->checksum)
+				i++;
+
+			/* textures are kept in the state they are cached in, zlib
+			 * compressed or not. if the GZ_TEXCACHE or GZ_HIRESTEXCACHE
+			 * option is toggled, the cache will need to be rebuilt. */
+			memset(&entry, 0, sizeof(entry));
+			entry.checksum = (*it)->checksum;
+			entry.size = (*it)->size;
+			entry.width = (*it)->info.width;
+			entry.height = (*it)->info.height;
+			entry.format = (*it)->info.format;
+			entry.texture_format = (*it)->info.texture_format;
+			entry.pixel_type = (*it)->info.pixel_type;
+			entry.is_hires_tex = (*it)->info.is_hires_tex;
+			data.push_back((*it)->info.data);
+			it++;
+		}
+		index.push_back(entry);
+	}
+
+	uint64 offset = packAlign(sizeof(TXPACKHEADER) + index.size() * sizeof(TXPACKENTRY));
+	for (i = 0; i < index.size(); i++) {
+		index[i].offset = offset;
+		offset = packAlign(offset + index[i].size);
+	}
 
 	/* dump cache to disk */
 	char cbuf[MAX_PATH];
+	char tmpbuf[MAX_PATH + 4];
 
 	osal_mkdirp(path);
 
@@ -245,63 +443,50 @@ TxCache::save(const wchar_t *path, const wchar_t *filename, int config)
 
 	wcstombs(cbuf, filename, MAX_PATH);
 
-	gzFile gzfp = gzopen(cbuf, "wb1");
-	DBG_INFO(80, wst("gzfp:%x file:%ls\n"), gzfp, filename);
-	if (gzfp) {
-		/* write header to determine config match */
-		gzwrite(gzfp, &config, 4);
-
-		std::map<uint64, TXCACHE*>::iterator itMap = _cache.begin();
-		int total = 0;
-		while (itMap != _cache.end()) {
-			uint8 *dest = (*itMap).second->info.data;
-			uint32 destLen = (*itMap).second->size;
-			uint32 format = (*itMap).second->info.format;
-
-			/* to keep things simple, we save the texture data in a zlib uncompressed state. */
-			/* sigh... for those who cannot wait the extra few seconds. changed to keep
-	 * texture data in a zlib compressed state. if the GZ_TEXCACHE or GZ_HIRESTEXCACHE
-	 * option is toggled, the cache will need to be rebuilt.
-	 */
-			/*if (format & GL_TEXFMT_GZ) {
-	  dest = _gzdest0;
-	  destLen = _gzdestLen;
-	  if (dest && destLen) {
-	  if (uncompress(dest, &destLen, (*itMap).second->info.data, (*itMap).second->size) != Z_OK) {
-	  dest = NULL;
-	  destLen = 0;
-	  }
-	  format &= ~GL_TEXFMT_GZ;
-	  }
-	  }*/
-
-			if (dest && destLen) {
-				/* texture checksum */
-				gzwrite(gzfp, &((*itMap).first), 8);
-
-				/* other texture info */
-				gzwrite(gzfp, &((*itMap).second->info.width), 4);
-				gzwrite(gzfp, &((*itMap).second->info.height), 4);
-				gzwrite(gzfp, &format, 4);
-				gzwrite(gzfp, &((*itMap).second->info.texture_format), 2);
-				gzwrite(gzfp, &((*itMap).second->info.pixel_type), 2);
-				gzwrite(gzfp, &((*itMap).second->info.is_hires_tex), 1);
-
-				gzwrite(gzfp, &destLen, 4);
-				gzwrite(gzfp, dest, destLen);
-			}
+	/* write next to the mapped file, then replace it */
+	snprintf(tmpbuf, sizeof(tmpbuf), "%s.tmp", cbuf);
+	FILE *fp = fopen(tmpbuf, "wb");
+	DBG_INFO(80, wst("fp:%x file:%ls\n"), fp, filename);
+	boolean ok = 0;
+	if (fp) {
+		static const uint8 zero[TXPACK_ALIGN] = { 0 };
+		TXPACKHEADER header;
+		header.magic = TXPACK_MAGIC;
+		header.version = TXPACK_VERSION;
+		header.config = config;
+		header.count = index.size();
+
+		ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+		if (ok && !index.empty())
+			ok = fwrite(&index[0], sizeof(TXPACKENTRY), index.size(), fp) == index.size();
+
+		offset = sizeof(TXPACKHEADER) + index.size() * sizeof(TXPACKENTRY);
+		for (i = 0; ok && i < index.size(); i++) {
+			ok = fwrite(zero, 1, index[i].offset - offset, fp) == index[i].offset - offset &&
+				 fwrite(data[i], 1, index[i].size, fp) == index[i].size;
+			offset = index[i].offset + index[i].size;
+
+			if (_callback && (!((i + 1) % 100) || i + 1 == index.size()))
+				(*_callback)(wst("Total textures saved to HDD: %d\n"), i + 1);
+		}
 
-			itMap++;
+		if (fclose(fp) != 0)
+			ok = 0;
 
-			if (_callback)
-				(*_callback)(wst("Total textures saved to HDD: %d\n"), ++total);
+		if (ok) {
+			unmapPack();
+			remove(cbuf);
+			ok = rename(tmpbuf, cbuf) == 0;
+		}
+		if (!ok) {
+			remove(tmpbuf);
+			DBG_INFO(80, wst("Error: failed to write %ls!\n"), filename);
 		}
-		gzclose(gzfp);
 	}
 
 	CHDIR(curpath);
 
-	return _cache.empty();
+	return ok;
 }
 
 boolean
@@ -323,55 +508,74 @@ TxCache::load(const wchar_t *path, const wchar_t *filename, int config)
 
 	wcstombs(cbuf, filename, MAX_PATH);
 
-	gzFile gzfp = gzopen(cbuf, "rb");
-	DBG_INFO(80, wst("gzfp:%x file:%ls\n"), gzfp, filename);
-	if (gzfp) {
-		/* yep, we have it. load it into memory cache. */
-		int dataSize;
-		uint64 checksum;
-		int tmpconfig;
-		/* read header to determine config match */
-		gzread(gzfp, &tmpconfig, 4);
-
-		if (tmpconfig == config) {
-			do {
-				GHQTexInfo tmpInfo;
-
-				gzread(gzfp, &checksum, 8);
-
-				gzread(gzfp, &tmpInfo.width, 4);
-				gzread(gzfp, &tmpInfo.height, 4);
-				gzread(gzfp, &tmpInfo.format, 4);
-				gzread(gzfp, &tmpInfo.texture_format, 2);
-				gzread(gzfp, &tmpInfo.pixel_type, 2);
-				gzread(gzfp, &tmpInfo.is_hires_tex, 1);
-
-				gzread(gzfp, &dataSize, 4);
-
-				tmpInfo.data = (uint8*)malloc(dataSize);
-				if (tmpInfo.data) {
-					gzread(gzfp, tmpInfo.data, dataSize);
-
-					/* add to memory cache */
-					add(checksum, &tmpInfo, (tmpInfo.format & GL_TEXFMT_GZ) ? dataSize : 0);
-
-					free(tmpInfo.data);
-				} else {
-					gzseek(gzfp, dataSize, SEEK_CUR);
-				}
-
-				/* skip in between to prevent the loop from being tied down to vsync */
-				if (_callback && (!(_cache.size() % 100) || gzeof(gzfp)))
-					(*_callback)(wst("[%d] total mem:%.02fmb - %ls\n"), _cache.size(), (float)_totalSize/1000000, filename);
-
-			} while (!gzeof(gzfp));
-			gzclose(gzfp);
+	unmapPack();
+
+#ifdef WIN32
+	HANDLE file = CreateFileA(cbuf, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER size;
+		if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+			HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping) {
+				_packBase = (uint8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				if (_packBase) {
+					_packSize = (size_t)size.QuadPart;
+					_packMapping = mapping;
+				} else
+					CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+	}
+#else
+	int fd = open(cbuf, O_RDONLY);
+	if (fd >= 0) {
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0) {
+			void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (base != MAP_FAILED) {
+				_packBase = (uint8*)base;
+				_packSize = st.st_size;
+			}
 		}
+		close(fd);
 	}
+#endif
+	DBG_INFO(80, wst("base:%x size:%d file:%ls\n"), _packBase, _packSize, filename);
 
 	CHDIR(curpath);
 
-	return !_cache.empty();
+	if (!_packBase)
+		return !_cache.empty();
+
+	/* check the header to determine config match, and that the index and
+	 * every texture are within the file */
+	const TXPACKHEADER *header = (const TXPACKHEADER*)_packBase;
+	boolean valid = _packSize >= sizeof(TXPACKHEADER) &&
+					header->magic == TXPACK_MAGIC &&
+					header->version == TXPACK_VERSION &&
+					header->config == config &&
+					header->count <= (_packSize - sizeof(TXPACKHEADER)) / sizeof(TXPACKENTRY);
+	if (valid) {
+		const TXPACKENTRY *index = (const TXPACKENTRY*)(_packBase + sizeof(TXPACKHEADER));
+		uint32 i;
+		for (i = 0; valid && i < header->count; i++)
+			valid = index[i].offset <= _packSize && index[i].size <= _packSize - index[i].offset &&
+					(i == 0 || index[i - 1].checksum < index[i].checksum);
+		if (valid) {
+			_packIndex = index;
+			_packCount = header->count;
+		}
+	}
+	if (!valid) {
+		DBG_INFO(80, wst("Error: %ls is not a cache file for this config!\n"), filename);
+		unmapPack();
+	}
+
+	if (_callback)
+		(*_callback)(wst("[%d] textures mapped - %ls\n"), _packCount, filename);
+
+	return _packCount > 0 || !_cache.empty();
 }
 
 boolean
@@ -379,17 +583,11 @@ TxCache::del(uint64 checksum)
 {
 	if (!checksum || _cache.empty()) return 0;
 
-	std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
+	std::unordered_map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
 	if (itMap != _cache.end()) {
 
-		/* for texture cache (not hi-res cache) */
-		if (!_cachelist.empty()) _cachelist.erase(((*itMap).second)->it);
-
 		/* remove from cache */
-		free((*itMap).second->info.data);
-		_totalSize -= (*itMap).second->size;
-		delete (*itMap).second;
-		_cache.erase(itMap);
+		removeEntry((*itMap).second);
 
 		DBG_INFO(80, wst("removed from cache: checksum = %08X %08X\n"), (uint32)(checksum & 0xffffffff), (uint32)(checksum >> 32));
 
@@ -402,26 +600,19 @@ TxCache::del(uint64 checksum)
 boolean
 TxCache::is_cached(uint64 checksum)
 {
-	std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
-	if (itMap != _cache.end()) return 1;
+	if (_cache.find(checksum) != _cache.end()) return 1;
 
-	return 0;
+	return findPacked(checksum) != NULL;
 }
 
 void
 TxCache::clear()
 {
-	if (!_cache.empty()) {
-		std::map<uint64, TXCACHE*>::iterator itMap = _cache.begin();
-		while (itMap != _cache.end()) {
-			free((*itMap).second->info.data);
-			delete (*itMap).second;
-			itMap++;
-		}
-		_cache.clear();
-	}
+	while (_oldest)
+		removeEntry(_oldest);
 
-	if (!_cachelist.empty()) _cachelist.clear();
+	unmapPack();
 
 	_totalSize = 0;
+	_totalRawSize = 0;
 }
@@ -26,13 +26,12 @@
 
 #include "TxInternal.h"
 #include "TxUtil.h"
-#include <list>
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 class TxCache
 {
 private:
-  std::list<uint64> _cachelist;
   uint8 *_gzdest0;
   uint8 *_gzdest1;
   uint32 _gzdestLen;
@@ -43,13 +42,34 @@ protected:
   dispInfoFuncExt _callback;
   TxUtil *_txUtil;
   struct TXCACHE {
-    int size;
+    uint64 checksum;
+    int size;            /* stored, zlib compressed or not */
+    int rawSize;         /* decompressed */
     GHQTexInfo info;
-    std::list<uint64>::iterator it;
+    TXCACHE *prev;       /* LRU list, oldest first */
+    TXCACHE *next;
   };
-  int _totalSize;
+  int _totalSize;        /* stored bytes, bounded by _cacheSize if > 0 */
+  int _totalRawSize;
   int _cacheSize;
-  std::map<uint64, TXCACHE*> _cache;
+  std::unordered_map<uint64, TXCACHE*> _cache;
+  /* entries are carved from chunks and recycled through a free list */
+  std::vector<TXCACHE*> _entryChunks;
+  TXCACHE *_freeEntries;
+  TXCACHE *_oldest;
+  TXCACHE *_newest;
+  TXCACHE *newEntry();
+  void removeEntry(TXCACHE *entry);
+  static bool checksumLess(const TXCACHE *a, const TXCACHE *b);
+  /* cache file mapped by load(), its textures are read on demand */
+  struct TXPACKENTRY;
+  uint8 *_packBase;
+  size_t _packSize;
+  const TXPACKENTRY *_packIndex;
+  uint32 _packCount;
+  void *_packMapping;
+  const TXPACKENTRY *findPacked(uint64 checksum);
+  void unmapPack();
   boolean save(const wchar_t *path, const wchar_t *filename, const int config);
   boolean load(const wchar_t *path, const wchar_t *filename, const int config);
   boolean del(uint64 checksum); /* checksum hi:palette low:texture */
@@ -28,6 +28,7 @@
 #include <functional>
 #include <thread>
 #include <stdlib.h>
+#include <string.h>
 
 #include <osal_files.h>
 #include "TxFilter.h"
@@ -37,6 +38,10 @@
 
 void TxFilter::clear()
 {
+	/* stop the filter threads */
+	delete _txFilterQueue;
+	_txFilterQueue = NULL;
+
 	/* clear hires texture cache */
 	delete _txHiResCache;
 
@@ -60,7 +65,7 @@ TxFilter::~TxFilter()
 TxFilter::TxFilter(int maxwidth, int maxheight, int maxbpp, int options,
 	int cachesize, const wchar_t * path, const wchar_t * texPackPath, const wchar_t * ident,
 				   dispInfoFuncExt callback) :
-	_tex1(NULL), _tex2(NULL), _txQuantize(NULL), _txTexCache(NULL), _txHiResCache(NULL), _txUtil(NULL), _txImage(NULL)
+	_tex1(NULL), _tex2(NULL), _txQuantize(NULL), _txTexCache(NULL), _txHiResCache(NULL), _txUtil(NULL), _txImage(NULL), _txFilterQueue(NULL)
 {
 	/* HACKALERT: the emulator misbehaves and sometimes forgets to shutdown */
 	if ((ident && wcscmp(ident, wst("DEFAULT")) != 0 && _ident.compare(ident) == 0) &&
@@ -143,6 +148,10 @@ TxFilter::TxFilter(int maxwidth, int maxheight, int maxbpp, int options,
 
 	if (_tex1 && _tex2)
 		_initialized = 1;
+
+	/* filter on worker threads, leaving one core to the emulator */
+	if (_initialized && (_options & ASYNC_TEXFILTER) && (_options & (FILTER_MASK|ENHANCEMENT_MASK)))
+		_txFilterQueue = new TxFilterQueue(this, _numcore > 1 ? _numcore - 1 : 1);
 }
 
 boolean
@@ -158,7 +167,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 	if (!_initialized) return 0;
 
 	/* find cached textures */
-	if (_cacheSize) {
+	if (_cacheSize || _txFilterQueue) {
 
 		/* calculate checksum of source texture */
 		if (!g64crc)
@@ -177,6 +186,13 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 #endif
 	}
 
+	/* done or still being filtered on the worker threads */
+	if (_txFilterQueue) {
+		int ret = fetch(g64crc, info);
+		if (ret >= 0)
+			return ret;
+	}
+
 	/* Leave small textures alone because filtering makes little difference.
    * Moreover, some filters require at least 4 * 4 to work.
    * Bypass _options to do ARGB8888->16bpp if _maxbpp=16 or forced color reduction.
@@ -285,77 +301,26 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 			}
 
 			/*
-	   * execute texture enhancements and filters
+	   * hand them to the worker threads, the caller uses the texture
+	   * unfiltered until fetch() returns it
 	   */
-			while (num_filters > 0) {
-
-				tmptex = (texture == _tex1) ? _tex2 : _tex1;
-
-				uint8 *_texture = texture;
-				uint8 *_tmptex  = tmptex;
-
-				unsigned int numcore = _numcore;
-				unsigned int blkrow = 0;
-				while (numcore > 1 && blkrow == 0) {
-					blkrow = (srcheight >> 2) / numcore;
-					numcore--;
-				}
-				if (blkrow > 0 && numcore > 1) {
-					std::thread *thrd[MAX_NUMCORE];
-					unsigned int i;
-					int blkheight = blkrow << 2;
-					unsigned int srcStride = (srcwidth * blkheight) << 2;
-					unsigned int destStride = srcStride * scale * scale;
-					for (i = 0; i < numcore - 1; i++) {
-						thrd[i] = new std::thread(std::bind(filter_8888,
-																(uint32*)_texture,
-																srcwidth,
-																blkheight,
-																(uint32*)_tmptex,
-																filter));
-						_texture += srcStride;
-						_tmptex  += destStride;
-					}
-					thrd[i] = new std::thread(std::bind(filter_8888,
-															(uint32*)_texture,
-															srcwidth,
-															srcheight - blkheight * i,
-															(uint32*)_tmptex,
-															filter));
-					for (i = 0; i < numcore; i++) {
-						thrd[i]->join();
-						delete thrd[i];
-					}
-				} else {
-					filter_8888((uint32*)_texture, srcwidth, srcheight, (uint32*)_tmptex, filter);
-				}
-
-				if (filter & ENHANCEMENT_MASK) {
-					srcwidth  *= scale;
-					srcheight *= scale;
-					filter &= ~ENHANCEMENT_MASK;
-					scale = 1;
+			if (_txFilterQueue && num_filters > 0) {
+				TxFilterJob *job = _txFilterQueue->newJob(g64crc, srcwidth, srcheight, scale);
+				if (job) {
+					memcpy(job->buf[0], texture, srcwidth * srcheight * 4);
+					job->format = srcformat;
+					job->filter = filter;
+					job->numFilters = num_filters;
+					_txFilterQueue->push(job);
+					return 0;
 				}
-
-				texture = tmptex;
-				num_filters--;
 			}
 
-			/*
-	   * texture (re)conversions
-	   */
-			if (destformat == GL_RGBA8) {
-				if (srcformat == GL_RGBA8 && (_maxbpp < 32 || _options & FORCE16BPP_TEX)) srcformat = GL_RGBA4;
-				if (srcformat != GL_RGBA8) {
-					tmptex = (texture == _tex1) ? _tex2 : _tex1;
-					if (!_txQuantize->quantize(texture, tmptex, srcwidth, srcheight, GL_RGBA8, srcformat)) {
-						DBG_INFO(80, wst("Error: unsupported format! gfmt:%x\n"), srcformat);
-						return 0;
-					}
-					texture = tmptex;
-					destformat = srcformat;
-				}
-			}
+			texture = filter8888(texture, _tex1, _tex2, srcwidth, srcheight, srcformat,
+								 filter, scale, num_filters, NULL);
+			if (!texture)
+				return 0;
+			destformat = srcformat;
 
 		break;
 #if !_16BPP_HACK
@@ -450,6 +415,131 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
 	return 1;
 }
 
+uint8 *
+TxFilter::filter8888(uint8 *texture, uint8 *tex1, uint8 *tex2,
+					 int &width, int &height, uint16 &format,
+					 uint32 filter, int scale, int numFilters,
+					 TxFilterQueue *pool)
+{
+	uint8 *tmptex;
+
+	/*
+   * execute texture enhancements and filters
+   */
+	while (numFilters > 0) {
+
+		tmptex = (texture == tex1) ? tex2 : tex1;
+
+		uint8 *_texture = texture;
+		uint8 *_tmptex  = tmptex;
+
+		unsigned int numcore = pool ? pool->numThreads() + 1 : _numcore;
+		unsigned int blkrow = 0;
+		while (numcore > 1 && blkrow == 0) {
+			blkrow = (height >> 2) / numcore;
+			numcore--;
+		}
+		if (blkrow > 0 && numcore > 1) {
+			std::vector<std::function<void()> > tiles;
+			unsigned int i;
+			int blkheight = blkrow << 2;
+			unsigned int srcStride = (width * blkheight) << 2;
+			unsigned int destStride = srcStride * scale * scale;
+			for (i = 0; i < numcore - 1; i++) {
+				tiles.push_back(std::bind(filter_8888,
+										  (uint32*)_texture,
+										  width,
+										  blkheight,
+										  (uint32*)_tmptex,
+										  filter));
+				_texture += srcStride;
+				_tmptex  += destStride;
+			}
+			tiles.push_back(std::bind(filter_8888,
+									  (uint32*)_texture,
+									  width,
+									  height - blkheight * i,
+									  (uint32*)_tmptex,
+									  filter));
+			if (pool) {
+				pool->parallel(tiles);
+			} else {
+				std::thread *thrd[MAX_NUMCORE];
+				for (i = 0; i < numcore; i++)
+					thrd[i] = new std::thread(tiles[i]);
+				for (i = 0; i < numcore; i++) {
+					thrd[i]->join();
+					delete thrd[i];
+				}
+			}
+		} else {
+			filter_8888((uint32*)_texture, width, height, (uint32*)_tmptex, filter);
+		}
+
+		if (filter & ENHANCEMENT_MASK) {
+			width  *= scale;
+			height *= scale;
+			filter &= ~ENHANCEMENT_MASK;
+			scale = 1;
+		}
+
+		texture = tmptex;
+		numFilters--;
+	}
+
+	/*
+   * texture (re)conversions
+   */
+	if (format == GL_RGBA8 && (_maxbpp < 32 || _options & FORCE16BPP_TEX)) format = GL_RGBA4;
+	if (format != GL_RGBA8) {
+		tmptex = (texture == tex1) ? tex2 : tex1;
+		if (!_txQuantize->quantize(texture, tmptex, width, height, GL_RGBA8, format)) {
+			DBG_INFO(80, wst("Error: unsupported format! gfmt:%x\n"), format);
+			return NULL;
+		}
+		texture = tmptex;
+	}
+
+	return texture;
+}
+
+void
+TxFilter::runJob(TxFilterJob *job)
+{
+	uint8 *texture = filter8888(job->buf[0], job->buf[0], job->buf[1],
+								job->width, job->height, job->format,
+								job->filter, job->scale, job->numFilters,
+								_txFilterQueue);
+	if (!texture)
+		return;
+
+	job->info.data = texture;
+	job->info.width  = job->width;
+	job->info.height = job->height;
+	job->info.is_hires_tex = 0;
+	setTextureFormat(job->format, &job->info);
+	job->ok = 1;
+}
+
+int
+TxFilter::fetch(uint64 g64crc, GHQTexInfo *info)
+{
+	int ret;
+
+	if (!_txFilterQueue)
+		return -1;
+
+	ret = _txFilterQueue->fetch(g64crc, info);
+	if (ret == 1) {
+		/* cache the texture. */
+		if (_cacheSize) _txTexCache->add(g64crc, info);
+
+		DBG_INFO(80, wst("filtered texture: %d x %d gfmt:%x\n"), info->width, info->height, info->format);
+	}
+
+	return ret;
+}
+
 boolean
 TxFilter::hirestex(uint64 g64crc, uint64 r_crc64, uint16 *palette, GHQTexInfo *info)
 {
@@ -30,9 +30,11 @@
 #include "TxTexCache.h"
 #include "TxUtil.h"
 #include "TxImage.h"
+#include "TxFilterQueue.h"
 
 class TxFilter
 {
+  friend class TxFilterQueue;
 private:
   int _numcore;
 
@@ -50,8 +52,14 @@ private:
   TxHiResCache *_txHiResCache;
   TxUtil *_txUtil;
   TxImage *_txImage;
+  TxFilterQueue *_txFilterQueue;
   boolean _initialized;
   void clear();
+  uint8 *filter8888(uint8 *texture, uint8 *tex1, uint8 *tex2,
+                    int &width, int &height, uint16 &format,
+                    uint32 filter, int scale, int numFilters,
+                    TxFilterQueue *pool);
+  void runJob(TxFilterJob *job);
 public:
   ~TxFilter();
   TxFilter(int maxwidth,
@@ -69,6 +77,7 @@ public:
 				  uint16 srcformat,
 				  uint64 g64crc, /* glide64 crc, 64bit for future use */
 				  GHQTexInfo *info);
+  int fetch(uint64 g64crc, GHQTexInfo *info);
   boolean hirestex(uint64 g64crc, /* glide64 crc, 64bit for future use */
 					  uint64 r_crc64,   /* checksum hi:palette low:texture */
 					  uint16 *palette,
@@ -65,6 +65,15 @@ txfilter_filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
   return 0;
 }
 
+TAPI int TAPIENTRY
+txfilter_fetch(uint64 g64crc, GHQTexInfo *info)
+{
+  if (txFilter)
+	return txFilter->fetch(g64crc, info);
+
+  return -1;
+}
+
 TAPI boolean TAPIENTRY
 txfilter_hirestex(uint64 g64crc, uint64 r_crc64, uint16 *palette, GHQTexInfo *info)
 {
@@ -0,0 +1,226 @@
+/*
+ * Texture Filtering
+ * Version:  1.0
+ *
+ * this is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * this is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Make; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifdef __MSC__
+#pragma warning(disable: 4786)
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "TxFilterQueue.h"
+#include "TxFilter.h"
+
+/* jobs waiting to be filtered or fetched, each holding two scaled
+ * textures */
+#define MAX_FILTER_JOBS 64
+
+TxFilterQueue::TxFilterQueue(TxFilter *owner, int numthreads) :
+	_owner(owner), _delivered(NULL), _quit(0)
+{
+	int i;
+
+	if (numthreads < 1)
+		numthreads = 1;
+
+	for (i = 0; i < numthreads; i++)
+		_workers.push_back(std::thread(&TxFilterQueue::worker, this));
+}
+
+TxFilterQueue::~TxFilterQueue()
+{
+	std::map<uint64, TxFilterJob*>::iterator itMap;
+	unsigned int i;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_quit = 1;
+	}
+	_wake.notify_all();
+
+	for (i = 0; i < _workers.size(); i++)
+		_workers[i].join();
+
+	for (itMap = _jobs.begin(); itMap != _jobs.end(); ++itMap)
+		freeJob(itMap->second);
+	freeJob(_delivered);
+}
+
+void
+TxFilterQueue::freeJob(TxFilterJob *job)
+{
+	if (!job)
+		return;
+
+	free(job->buf[0]);
+	free(job->buf[1]);
+	delete job;
+}
+
+void
+TxFilterQueue::worker()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	for (;;) {
+		while (!_quit && _tiles.empty() && _pending.empty())
+			_wake.wait(lock);
+
+		/* tiles first, a job is waiting for them */
+		if (!_tiles.empty()) {
+			runTile(lock);
+			continue;
+		}
+
+		if (_quit)
+			return;
+
+		TxFilterJob *job = _pending.front();
+		_pending.pop_front();
+
+		lock.unlock();
+		_owner->runJob(job);
+		lock.lock();
+
+		job->done = 1;
+	}
+}
+
+void
+TxFilterQueue::runTile(std::unique_lock<std::mutex> &lock)
+{
+	Tile tile = _tiles.front();
+	_tiles.pop_front();
+
+	lock.unlock();
+	(*tile.func)();
+	lock.lock();
+
+	if (--(*tile.remaining) == 0)
+		_tileDone.notify_all();
+}
+
+void
+TxFilterQueue::parallel(std::vector<std::function<void()> > &tasks)
+{
+	int remaining = (int)tasks.size();
+	unsigned int i;
+
+	if (tasks.empty())
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		for (i = 1; i < tasks.size(); i++) {
+			Tile tile = { &tasks[i], &remaining };
+			_tiles.push_back(tile);
+		}
+	}
+	_wake.notify_all();
+
+	tasks[0]();
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	remaining--;
+
+	/* help with the tiles rather than wait, the other workers may all be
+	 * busy with jobs of their own */
+	while (remaining > 0) {
+		if (!_tiles.empty())
+			runTile(lock);
+		else
+			_tileDone.wait(lock);
+	}
+}
+
+TxFilterJob *
+TxFilterQueue::newJob(uint64 checksum, int width, int height, int scale)
+{
+	size_t size = (size_t)width * height * scale * scale * 4;
+	TxFilterJob *job;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		/* make room by dropping a filtered texture nobody fetched */
+		if (_jobs.size() >= MAX_FILTER_JOBS) {
+			std::map<uint64, TxFilterJob*>::iterator itMap;
+			for (itMap = _jobs.begin(); itMap != _jobs.end(); ++itMap) {
+				if (itMap->second->done) {
+					freeJob(itMap->second);
+					_jobs.erase(itMap);
+					break;
+				}
+			}
+			if (_jobs.size() >= MAX_FILTER_JOBS)
+				return NULL;
+		}
+	}
+
+	job = new TxFilterJob();
+	job->checksum = checksum;
+	job->width = width;
+	job->height = height;
+	job->scale = scale;
+	job->buf[0] = (uint8*)malloc(size);
+	job->buf[1] = (uint8*)malloc(size);
+	if (!job->buf[0] || !job->buf[1]) {
+		freeJob(job);
+		return NULL;
+	}
+
+	return job;
+}
+
+void
+TxFilterQueue::push(TxFilterJob *job)
+{
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_jobs[job->checksum] = job;
+		_pending.push_back(job);
+	}
+	_wake.notify_one();
+}
+
+int
+TxFilterQueue::fetch(uint64 checksum, GHQTexInfo *info)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	std::map<uint64, TxFilterJob*>::iterator itMap = _jobs.find(checksum);
+	TxFilterJob *job;
+
+	if (itMap == _jobs.end())
+		return -1;
+
+	job = itMap->second;
+
+	/* a failed job stays, so the texture is not queued again */
+	if (!job->done || !job->ok)
+		return 0;
+
+	_jobs.erase(itMap);
+
+	/* the caller uploads the texture before it fetches another one */
+	freeJob(_delivered);
+	_delivered = job;
+
+	*info = job->info;
+	return 1;
+}
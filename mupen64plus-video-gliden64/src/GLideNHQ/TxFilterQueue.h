@@ -0,0 +1,88 @@
+/*
+ * Texture Filtering
+ * Version:  1.0
+ *
+ * this is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * this is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Make; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __TXFILTERQUEUE_H__
+#define __TXFILTERQUEUE_H__
+
+#include "TxInternal.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TxFilter;
+
+/* A texture waiting for, or done with, its enhancements and filters. */
+struct TxFilterJob {
+  uint64 checksum;
+  int width;          /* source size, filtered size once done */
+  int height;
+  uint16 format;      /* format to convert back to after filtering */
+  uint32 filter;
+  int scale;
+  int numFilters;
+  uint8 *buf[2];      /* each large enough for the scaled texture */
+  GHQTexInfo info;
+  boolean ok;
+  boolean done;
+};
+
+/* Worker threads for ASYNC_TEXFILTER. Jobs are filtered in the order they
+ * are pushed. A job may split its rows into tiles with parallel(), which
+ * the idle workers pick up before new jobs. */
+class TxFilterQueue
+{
+private:
+  struct Tile {
+    std::function<void()> *func;
+    int *remaining;
+  };
+  TxFilter *_owner;
+  std::vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _tileDone;
+  std::deque<TxFilterJob*> _pending;
+  std::deque<Tile> _tiles;
+  std::map<uint64, TxFilterJob*> _jobs;
+  TxFilterJob *_delivered;
+  boolean _quit;
+  void worker();
+  void runTile(std::unique_lock<std::mutex> &lock);
+  static void freeJob(TxFilterJob *job);
+public:
+  ~TxFilterQueue();
+  TxFilterQueue(TxFilter *owner, int numthreads);
+  int numThreads() const { return (int)_workers.size(); }
+  /* allocates a job with room for the scaled texture, or NULL when too
+   * many jobs are waiting to be fetched */
+  TxFilterJob *newJob(uint64 checksum, int width, int height, int scale);
+  void push(TxFilterJob *job);
+  /* 1 and the filtered texture, valid until the next fetch, once the job
+   * is done; 0 while it is waiting or if it failed; -1 if there is no such
+   * job */
+  int fetch(uint64 checksum, GHQTexInfo *info);
+  /* runs the tasks on the workers and the calling thread */
+  void parallel(std::vector<std::function<void()> > &tasks);
+};
+
+#endif /* __TXFILTERQUEUE_H__ */
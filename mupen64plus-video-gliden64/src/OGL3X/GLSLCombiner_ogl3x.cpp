@@ -775,11 +775,21 @@ std::istream & operator>> (std::istream & _is, ShaderCombiner & _combiner)
 	GLint  binaryLength;
 	_is.read((char*)&binaryFormat, sizeof(binaryFormat));
 	_is.read((char*)&binaryLength, sizeof(binaryLength));
+	if (!_is || binaryLength < 1) {
+		_is.setstate(std::ios::failbit);
+		return _is;
+	}
 	std::vector<char> binary(binaryLength);
 	_is.read(binary.data(), binaryLength);
+	if (!_is)
+		return _is;
 
+	// The driver refuses binaries it didn't write or no longer understands.
 	glProgramBinary(_combiner.m_program, binaryFormat, binary.data(), binaryLength);
-	assert(checkProgramLinkStatus(_combiner.m_program));
+	if (!checkProgramLinkStatus(_combiner.m_program)) {
+		_is.setstate(std::ios::failbit);
+		return _is;
+	}
 	_combiner._locateUniforms();
 	return _is;
 }
@@ -1515,6 +1515,8 @@ uint32_t TextureFilterHandler::_getConfigOptions() const
 		options |= LET_TEXARTISTS_FLY;
 	if (config.textureFilter.txDump)
 		options |= DUMP_TEX;
+	if (config.textureFilter.txEnhancementAsync)
+		options |= ASYNC_TEXFILTER;
 	return options;
 }
 
@@ -13,6 +13,7 @@
 #include "gSP.h"
 #include "N64.h"
 #include "convert.h"
+#include "../../Graphics/texconv.h"
 #include "FrameBuffer.h"
 #include "Config.h"
 #include "GLideNHQ/Ext_TxFilter.h"
@@ -805,7 +806,8 @@ void TextureCache::_loadBackground(CachedTexture *pTexture)
 					ghqTexInfo.data);
 			_updateCachedTexture(ghqTexInfo, pTexture);
 			bLoaded = true;
-		}
+		} else
+			pTexture->filterPending = config.textureFilter.txEnhancementAsync != 0;
 	}
 	if (!bLoaded) {
 		if (pTexture->realWidth % 2 != 0 && glInternalFormat != GL_RGBA)
@@ -880,6 +882,36 @@ bool TextureCache::_loadHiresTexture(uint32_t _tile, CachedTexture *_pTexture, u
 	return false;
 }
 
+/*
+ * Decodes a whole row with Graphics/texconv when it matches GetTexel
+ * exactly. The row must need no clamping or mirroring in S.
+*/
+static bool _convertRow(GetTexelFunc GetTexel, uint32_t* pDest, uint64_t* pSrc,
+						uint16_t i, uint16_t width, const uint32_t* pPalette)
+{
+	const uint8_t* src = (const uint8_t*)pSrc;
+	const unsigned fiddle = i << 1;
+
+	if (GetTexel == GetI4_RGBA8888)
+		texconv_i4(pDest, src, 0, fiddle, width);
+	else if (GetTexel == GetI8_RGBA8888)
+		texconv_i8(pDest, src, 0, fiddle, width);
+	else if (GetTexel == GetIA44_RGBA8888)
+		texconv_ia8(pDest, src, 0, fiddle, width);
+	// An odd fiddle reads the words swapped, see swapword()
+	else if (GetTexel == GetIA88_RGBA8888)
+		texconv_ia16(pDest, src, 0, fiddle | 1, width);
+	else if (GetTexel == GetRGBA5551_RGBA8888)
+		texconv_rgba16(pDest, src, 0, fiddle | 1, width, TEXCONV_ABGR | TEXCONV_ROUND);
+	else if (GetTexel == GetCI4RGBA_RGBA8888 || GetTexel == GetCI4IA_RGBA8888)
+		texconv_ci4(pDest, src, 0, fiddle, width, pPalette);
+	else if (GetTexel == GetCI8RGBA_RGBA8888 || GetTexel == GetCI8IA_RGBA8888)
+		texconv_ci8(pDest, src, 0, fiddle, width, pPalette);
+	else
+		return false;
+	return true;
+}
+
 /*
  * Worker function for _load
 */
@@ -972,6 +1004,23 @@ void TextureCache::_getTextureDestData(CachedTexture& tmptex,
 	} else {
 		j = 0;
       const uint32_t tMemMask = gDP.otherMode.textureLUT == G_TT_NONE ? 0x1FF : 0xFF;
+		// Rows that read texels 0..realWidth-1 in order go through texconv
+		const bool rowCopy = glInternalFormat == GL_RGBA &&
+			tmptex.realWidth <= clampSClamp + 1 && tmptex.realWidth <= maskSMask + 1;
+		uint32_t palette[256];
+		if (GetTexel == GetCI4RGBA_RGBA8888) {
+			for (x = 0; x < 16; ++x)
+				palette[x] = RGBA5551_RGBA8888(*(uint16_t*)&TMEM[256 + (tmptex.palette << 4) + x]);
+		} else if (GetTexel == GetCI4IA_RGBA8888) {
+			for (x = 0; x < 16; ++x)
+				palette[x] = IA88_RGBA8888(*(uint16_t*)&TMEM[256 + (tmptex.palette << 4) + x]);
+		} else if (GetTexel == GetCI8RGBA_RGBA8888) {
+			for (x = 0; x < 256; ++x)
+				palette[x] = RGBA5551_RGBA8888(*(uint16_t*)&TMEM[256 + x]);
+		} else if (GetTexel == GetCI8IA_RGBA8888) {
+			for (x = 0; x < 256; ++x)
+				palette[x] = IA88_RGBA8888(*(uint16_t*)&TMEM[256 + x]);
+		}
 		for (y = 0; y < tmptex.realHeight; ++y) {
 			ty = min(y, clampTClamp) & maskTMask;
 
@@ -981,6 +1030,10 @@ void TextureCache::_getTextureDestData(CachedTexture& tmptex,
          pSrc = &TMEM[(tmptex.tMem + *pLine * ty) & tMemMask];
 
 			i = (ty & 1) << 1;
+			if (rowCopy && _convertRow(GetTexel, pDest + j, pSrc, i, tmptex.realWidth, palette)) {
+				j += tmptex.realWidth;
+				continue;
+			}
 			for (x = 0; x < tmptex.realWidth; ++x) {
 				tx = min(x, clampSClamp) & maskSMask;
 
@@ -1077,7 +1130,8 @@ void TextureCache::_load(uint32_t _tile, CachedTexture *_pTexture)
 #endif
 				_updateCachedTexture(ghqTexInfo, _pTexture);
 				bLoaded = true;
-			}
+			} else
+				_pTexture->filterPending = config.textureFilter.txEnhancementAsync != 0;
 		}
 		if (!bLoaded) {
 			if (tmptex.realWidth % 2 != 0 &&
@@ -1163,6 +1217,38 @@ uint32_t _calculateCRC(uint32_t t, const TextureParams & _params)
 	return crc;
 }
 
+void TextureCache::_fetchFilteredTexture(CachedTexture *_pTexture)
+{
+	GHQTexInfo ghqTexInfo;
+	const int res = txfilter_fetch((uint64)_pTexture->crc, &ghqTexInfo);
+	if (res == 0)
+		return;
+	_pTexture->filterPending = false;
+	if (res < 0 || ghqTexInfo.data == NULL)
+		return;
+
+	if (ghqTexInfo.width % 2 != 0 &&
+			ghqTexInfo.format != GL_RGBA &&
+			m_curUnpackAlignment > 1)
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+#ifdef HAVE_OPENGLES2
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+			ghqTexInfo.width, ghqTexInfo.height,
+			0, GL_RGBA, ghqTexInfo.pixel_type,
+			ghqTexInfo.data);
+#else
+	glTexImage2D(GL_TEXTURE_2D, 0, ghqTexInfo.format,
+			ghqTexInfo.width, ghqTexInfo.height,
+			0, ghqTexInfo.texture_format, ghqTexInfo.pixel_type,
+			ghqTexInfo.data);
+#endif
+	if (m_curUnpackAlignment > 1)
+		glPixelStorei(GL_UNPACK_ALIGNMENT, m_curUnpackAlignment);
+	m_cachedBytes -= _pTexture->textureBytes;
+	_updateCachedTexture(ghqTexInfo, _pTexture);
+	m_cachedBytes += _pTexture->textureBytes;
+}
+
 void TextureCache::activateTexture(uint32_t _t, CachedTexture *_pTexture)
 {
 #ifdef GL_MULTISAMPLING_SUPPORT
@@ -1176,6 +1262,8 @@ void TextureCache::activateTexture(uint32_t _t, CachedTexture *_pTexture)
 		glActiveTexture(GL_TEXTURE0 + _t);
 		// Bind the cached texture
 		glBindTexture(GL_TEXTURE_2D, _pTexture->glName);
+		if (_pTexture->filterPending)
+			_fetchFilteredTexture(_pTexture);
 	}
 
 	const bool bUseBilinear = (gDP.otherMode.textureFilter | (gSP.objRendermode&G_OBJRM_BILERP)) != 0;
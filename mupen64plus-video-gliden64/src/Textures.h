@@ -15,7 +15,7 @@ typedef uint32_t (*GetTexelFunc)( uint64_t *src, uint16_t x, uint16_t i, uint8_t
 
 struct CachedTexture
 {
-	CachedTexture(GLuint _glName) : glName(_glName), max_level(0), frameBufferTexture(fbNone) {}
+	CachedTexture(GLuint _glName) : glName(_glName), max_level(0), frameBufferTexture(fbNone), filterPending(false) {}
 
 	GLuint	glName;
 	uint32_t		crc;
@@ -45,6 +45,7 @@ struct CachedTexture
 		fbOneSample = 1,
 		fbMultiSample = 2
 	} frameBufferTexture;
+	bool filterPending;	// uploaded unfiltered, the filtered texture is on its way
 };
 
 
@@ -79,6 +80,7 @@ private:
 	bool _loadHiresTexture(uint32_t _tile, CachedTexture *_pTexture, uint64_t & _ricecrc);
 	void _loadBackground(CachedTexture *pTexture);
 	bool _loadHiresBackground(CachedTexture *_pTexture);
+	void _fetchFilteredTexture(CachedTexture *_pTexture);
 	void _updateBackground();
 	void _clear();
 	void _initDummyTexture(CachedTexture * _pDummy);
@@ -25,6 +25,7 @@
 
 #include "../../Graphics/image_convert.h"
 #include "../../Graphics/3dmath.h"
+#include "../../Graphics/RSP/gSP_vertex.h"
 
 using namespace std;
 
@@ -279,60 +280,105 @@ void gln64gSPClipVertex(uint32_t v)
 	if (vtx.w < 0.01f)  vtx.clip |= CLIP_Z;
 }
 
-void gln64gSPProcessVertex(uint32_t v)
+/* Transforms and lights vertices v0 .. v0 + n - 1 of a vertex load.
+ * Transform and normals go through the batched pipeline in
+ * Graphics/RSP, the rest is done per vertex. */
+void gln64gSPProcessVertices(uint32_t v0, uint32_t n)
 {
+	struct vertex_batch batch;
+	const bool lighting = (gSP.geometryMode & G_LIGHTING) != 0;
+
 	if (gSP.changed & CHANGED_MATRIX)
 		gln64gSPCombineMatrices();
 
 	OGLVideo & ogl = video();
 	OGLRender & render = ogl.getRender();
-	SPVertex & vtx = render.getVertex(v);
-	float vPos[3] = {(float)vtx.x, (float)vtx.y, (float)vtx.z};
-	gln64gSPTransformVertex( &vtx.x, gSP.matrix.combined );
 
-	if (ogl.isAdjustScreen() && (gDP.colorImage.width > VI.width * 98 / 100)) {
-		vtx.x *= ogl.getAdjustScale();
-		if (gSP.matrix.projection[3][2] == -1.f)
-			vtx.w *= ogl.getAdjustScale();
+	for (uint32_t i = 0; i < n; ++i) {
+		SPVertex & vtx = render.getVertex(v0 + i);
+		batch.x[i] = vtx.x;
+		batch.y[i] = vtx.y;
+		batch.z[i] = vtx.z;
+		if (lighting) {
+			batch.nx[i] = vtx.nx;
+			batch.ny[i] = vtx.ny;
+			batch.nz[i] = vtx.nz;
+		}
 	}
 
-	if (gSP.viewport.vscale[0] < 0)
-		vtx.x = -vtx.x;
+	gSPBatchTransform(&batch, n, gSP.matrix.combined);
+	if (lighting)
+		gSPBatchTransformNormals(&batch, n, gSP.matrix.modelView[gSP.matrix.modelViewi]);
 
-	if (gSP.matrix.billboard) {
-		int i = 0;
-		gln64gSPBillboardVertex(v, i);
+	if (ogl.isAdjustScreen() && (gDP.colorImage.width > VI.width * 98 / 100)) {
+		const float adjustScale = ogl.getAdjustScale();
+		for (uint32_t i = 0; i < n; ++i) {
+			batch.x[i] *= adjustScale;
+			if (gSP.matrix.projection[3][2] == -1.f)
+				batch.w[i] *= adjustScale;
+		}
 	}
 
-	gln64gSPClipVertex(v);
+	if (gSP.viewport.vscale[0] < 0) {
+		for (uint32_t i = 0; i < n; ++i)
+			batch.x[i] = -batch.x[i];
+	}
 
-	if (gSP.geometryMode & G_LIGHTING) {
-		TransformVectorNormalize( &vtx.nx, gSP.matrix.modelView[gSP.matrix.modelViewi] );
-		if (gSP.geometryMode & G_POINT_LIGHTING)
-			gln64gSPPointLightVertex(vtx, vPos);
-		else
-			gln64gSPLightVertex(vtx);
-
-		if (GBI.isTextureGen() && (gSP.geometryMode & G_TEXTURE_GEN) != 0) {
-			float fLightDir[3] = {vtx.nx, vtx.ny, vtx.nz};
-			float x, y;
-			if (gSP.lookatEnable) {
-				x = DotProduct(&gSP.lookat[0].x, fLightDir);
-				y = DotProduct(&gSP.lookat[1].x, fLightDir);
-			} else {
-				x = fLightDir[0];
-				y = fLightDir[1];
-			}
-			if (gSP.geometryMode & G_TEXTURE_GEN_LINEAR) {
-				vtx.s = acosf(x) * 325.94931f;
-				vtx.t = acosf(y) * 325.94931f;
-			} else { // G_TEXTURE_GEN
-				vtx.s = (x + 1.0f) * 512.0f;
-				vtx.t = (y + 1.0f) * 512.0f;
+	// Billboarding moves the vertices first
+	if (!gSP.matrix.billboard)
+		gSPBatchClip(&batch, n, 0.01f);
+
+	for (uint32_t i = 0; i < n; ++i) {
+		const uint32_t v = v0 + i;
+		SPVertex & vtx = render.getVertex(v);
+		float vPos[3] = {(float)vtx.x, (float)vtx.y, (float)vtx.z};
+
+		vtx.x = batch.x[i];
+		vtx.y = batch.y[i];
+		vtx.z = batch.z[i];
+		vtx.w = batch.w[i];
+
+		if (gSP.matrix.billboard) {
+			gln64gSPBillboardVertex(v, 0);
+			gln64gSPClipVertex(v);
+		} else
+			vtx.clip = batch.clip[i];
+
+		if (lighting) {
+			vtx.nx = batch.nx[i];
+			vtx.ny = batch.ny[i];
+			vtx.nz = batch.nz[i];
+			if (gSP.geometryMode & G_POINT_LIGHTING)
+				gln64gSPPointLightVertex(vtx, vPos);
+			else
+				gln64gSPLightVertex(vtx);
+
+			if (GBI.isTextureGen() && (gSP.geometryMode & G_TEXTURE_GEN) != 0) {
+				float fLightDir[3] = {vtx.nx, vtx.ny, vtx.nz};
+				float x, y;
+				if (gSP.lookatEnable) {
+					x = DotProduct(&gSP.lookat[0].x, fLightDir);
+					y = DotProduct(&gSP.lookat[1].x, fLightDir);
+				} else {
+					x = fLightDir[0];
+					y = fLightDir[1];
+				}
+				if (gSP.geometryMode & G_TEXTURE_GEN_LINEAR) {
+					vtx.s = acosf(x) * 325.94931f;
+					vtx.t = acosf(y) * 325.94931f;
+				} else { // G_TEXTURE_GEN
+					vtx.s = (x + 1.0f) * 512.0f;
+					vtx.t = (y + 1.0f) * 512.0f;
+				}
 			}
-		}
-	} else
-		vtx.HWLight = 0;
+		} else
+			vtx.HWLight = 0;
+	}
+}
+
+void gln64gSPProcessVertex(uint32_t v)
+{
+	gln64gSPProcessVertices(v, 1);
 }
 
 void gln64gSPLoadUcodeEx( uint32_t uc_start, uint32_t uc_dstart, uint16_t uc_dsize )
@@ -562,9 +608,9 @@ void gln64gSPVertex( uint32_t a, uint32_t n, uint32_t v0 )
 				vtx.b = vertex->color.b * 0.0039215689f;
 				vtx.a = vertex->color.a * 0.0039215689f;
 			}
-			gln64gSPProcessVertex(v);
 			vertex++;
 		}
+		gln64gSPProcessVertices(v0, n);
 	} else {
 		LOG(LOG_ERROR, "Using Vertex outside buffer v0=%i, n=%i\n", v0, n);
 	}
@@ -604,9 +650,9 @@ void gln64gSPCIVertex( uint32_t a, uint32_t n, uint32_t v0 )
 				vtx.a = color[0] * 0.0039215689f;
 			}
 
-			gln64gSPProcessVertex(v);
 			vertex++;
 		}
+		gln64gSPProcessVertices(v0, n);
 	} else {
 		LOG(LOG_ERROR, "Using Vertex outside buffer v0=%i, n=%i\n", v0, n);
 	}
@@ -641,9 +687,9 @@ void gln64gSPDMAVertex( uint32_t a, uint32_t n, uint32_t v0 )
 				vtx.a = *(uint8_t*)&gfx_info.RDRAM[(address + 9) ^ 3] * 0.0039215689f;
 			}
 
-			gln64gSPProcessVertex(v);
 			address += 10;
 		}
+		gln64gSPProcessVertices(v0, n);
 	} else {
 		LOG(LOG_ERROR, "Using Vertex outside buffer v0=%i, n=%i\n", v0, n);
 	}
@@ -679,9 +725,9 @@ void gln64gSPCBFDVertex( uint32_t a, uint32_t n, uint32_t v0 )
 			vtx.g = vertex->color.g * 0.0039215689f;
 			vtx.b = vertex->color.b * 0.0039215689f;
 			vtx.a = vertex->color.a * 0.0039215689f;
-			gln64gSPProcessVertex(v);
 			vertex++;
 		}
+		gln64gSPProcessVertices(v0, n);
 	} else {
 		LOG(LOG_ERROR, "Using Vertex outside buffer v0=%i, n=%i\n", v0, n);
 	}
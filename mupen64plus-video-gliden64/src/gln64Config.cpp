@@ -52,6 +52,7 @@ void gliden64_config::resetToDefaults()
 	textureFilter.txDump = 0;
 	textureFilter.txEnhancementMode = 0;
 	textureFilter.txFilterIgnoreBG = 0;
+	textureFilter.txEnhancementAsync = 0;
 	textureFilter.txFilterMode = 0;
 	textureFilter.txHiresEnable = 0;
 	textureFilter.txHiresFullAlphaChannel = 0;
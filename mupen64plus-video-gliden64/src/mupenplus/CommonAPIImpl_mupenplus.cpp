@@ -1,6 +1,8 @@
 #include <boolean.h>
 
 #include <algorithm>
+#include <retro_miscellaneous.h>
+#include "m64p_config.h"
 #include "../PluginAPI.h"
 #include "../OpenGL.h"
 #include "../RSP.h"
@@ -12,12 +14,23 @@ int PluginAPI::InitiateGFX(const GFX_INFO & _gfxInfo)
 	return true;
 }
 
+static void copyPath(wchar_t * _strPath, const char * _strSrc)
+{
+	size_t i = 0;
+	if (_strSrc != NULL)
+		for (; _strSrc[i] != 0 && i < PATH_MAX_LENGTH - 1; ++i)
+			_strPath[i] = (unsigned char)_strSrc[i];
+	_strPath[i] = 0;
+}
+
 void PluginAPI::GetUserDataPath(wchar_t * _strPath)
 {
+	copyPath(_strPath, ConfigGetUserDataPath());
 }
 
 void PluginAPI::GetUserCachePath(wchar_t * _strPath)
 {
+	copyPath(_strPath, ConfigGetUserCachePath());
 }
 
 void PluginAPI::FindPluginPath(wchar_t * _strPath)
@@ -0,0 +1,718 @@
+/* bench
+ * Headless libretro frontend used to benchmark the core.
+ *
+ * Loads the core, forces the angrylion software renderer (no GPU needed),
+ * runs a ROM for a fixed number of frames without any frame pacing and
+ * reports frames/sec together with the time spent in the R4300, RSP, RDP,
+ * VI and audio stages.
+ *
+ * The per-stage breakdown comes from the core's RETRO_PERFORMANCE counters,
+ * so the core has to be built with PERF_TEST=1 ("make PERF_TEST=1 bench").
+ * Without them only the totals are reported.
+ *
+ * For runs on real gameplay the core's input movie can be played (or
+ * recorded, with no input) through its "movie" option, see
+ * mupen64plus-core/src/main/movie.h. The hashes of RDRAM and of the
+ * presented frame can be written for every frame, or compared with the
+ * ones of an earlier run to find where two builds diverge. Hashing isn't
+ * counted in the measured time.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <dlfcn.h>
+
+#include "libretro.h"
+
+#define NAME_PREFIX "parallel_n64"
+
+#define MAX_COUNTERS 32
+
+enum bench_stage
+{
+   STAGE_RSP,
+   STAGE_RDP,
+   STAGE_VI,
+   STAGE_AUDIO,
+   NUM_STAGES
+};
+
+static const char *stage_names[NUM_STAGES] = { "rsp", "rdp", "vi", "audio" };
+static const char *stage_idents[NUM_STAGES] = { "perf_rsp", "perf_rdp", "perf_vi", "perf_audio" };
+
+struct core_api
+{
+   void *handle;
+   void (*retro_init)(void);
+   void (*retro_deinit)(void);
+   void (*retro_set_environment)(retro_environment_t);
+   void (*retro_set_video_refresh)(retro_video_refresh_t);
+   void (*retro_set_audio_sample)(retro_audio_sample_t);
+   void (*retro_set_audio_sample_batch)(retro_audio_sample_batch_t);
+   void (*retro_set_input_poll)(retro_input_poll_t);
+   void (*retro_set_input_state)(retro_input_state_t);
+   bool (*retro_load_game)(const struct retro_game_info*);
+   void (*retro_unload_game)(void);
+   void (*retro_run)(void);
+   void *(*retro_get_memory_data)(unsigned);
+   size_t (*retro_get_memory_size)(unsigned);
+};
+
+static struct core_api core;
+
+static const char *opt_cpucore   = "pure_interpreter";
+static const char *opt_rspplugin = "hle";
+static int         opt_verbose   = 0;
+static const char *opt_blockprof = NULL;
+static const char *opt_threaded  = NULL;
+static unsigned    opt_frontend_us = 0;
+static const char *opt_movie     = "disabled";
+static const char *opt_dynacache = "disabled";
+static bool        variables_updated = false;
+
+/* Counters registered by the core. Nested counters (e.g. RDP inside an LLE
+ * RSP task) are accounted exclusively: starting a child pauses its parent. */
+static struct retro_perf_counter *counters[MAX_COUNTERS];
+static unsigned num_counters;
+static struct retro_perf_counter *active[MAX_COUNTERS];
+static unsigned num_active;
+static int counting;
+
+static unsigned video_frames;
+static size_t   audio_frames;
+
+/* Per frame hashes */
+static FILE    *hash_out;
+static FILE    *hash_ref;
+static unsigned pixel_bytes = 2;
+static uint64_t frame_hash;
+static long     diverged_at = -1;
+static retro_perf_tick_t hash_ticks;
+
+static retro_perf_tick_t get_ticks(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (retro_perf_tick_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static retro_time_t RETRO_CALLCONV perf_get_time_usec(void)
+{
+   return (retro_time_t)(get_ticks() / 1000);
+}
+
+static uint64_t RETRO_CALLCONV perf_get_cpu_features(void)
+{
+   uint64_t cpu = 0;
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("sse"))
+      cpu |= RETRO_SIMD_SSE;
+   if (__builtin_cpu_supports("sse2"))
+      cpu |= RETRO_SIMD_SSE2;
+   if (__builtin_cpu_supports("sse3"))
+      cpu |= RETRO_SIMD_SSE3;
+   if (__builtin_cpu_supports("ssse3"))
+      cpu |= RETRO_SIMD_SSSE3;
+   if (__builtin_cpu_supports("sse4.1"))
+      cpu |= RETRO_SIMD_SSE4;
+   if (__builtin_cpu_supports("sse4.2"))
+      cpu |= RETRO_SIMD_SSE42;
+   if (__builtin_cpu_supports("avx"))
+      cpu |= RETRO_SIMD_AVX;
+   if (__builtin_cpu_supports("avx2"))
+      cpu |= RETRO_SIMD_AVX2;
+#endif
+   return cpu;
+}
+
+static retro_perf_tick_t RETRO_CALLCONV perf_get_counter(void)
+{
+   return get_ticks();
+}
+
+static void RETRO_CALLCONV perf_register(struct retro_perf_counter *counter)
+{
+   if (counter->registered || num_counters >= MAX_COUNTERS)
+      return;
+
+   counters[num_counters++] = counter;
+   counter->registered = true;
+}
+
+static void RETRO_CALLCONV perf_start(struct retro_perf_counter *counter)
+{
+   retro_perf_tick_t now = get_ticks();
+
+   if (num_active >= MAX_COUNTERS)
+      return;
+
+   if (num_active && counting)
+   {
+      struct retro_perf_counter *parent = active[num_active - 1];
+      parent->total += now - parent->start;
+   }
+
+   active[num_active++] = counter;
+   counter->start       = now;
+}
+
+static void RETRO_CALLCONV perf_stop(struct retro_perf_counter *counter)
+{
+   retro_perf_tick_t now = get_ticks();
+
+   if (!num_active || active[num_active - 1] != counter)
+      return;
+
+   if (counting)
+   {
+      counter->total += now - counter->start;
+      counter->call_cnt++;
+   }
+
+   if (--num_active)
+      active[num_active - 1]->start = now;
+}
+
+static void RETRO_CALLCONV perf_log(void)
+{
+}
+
+static void perf_reset(void)
+{
+   unsigned i;
+
+   for (i = 0; i < num_counters; i++)
+   {
+      counters[i]->total    = 0;
+      counters[i]->call_cnt = 0;
+   }
+}
+
+static struct retro_perf_counter *perf_find(const char *ident)
+{
+   unsigned i;
+
+   for (i = 0; i < num_counters; i++)
+      if (!strcmp(counters[i]->ident, ident))
+         return counters[i];
+
+   return NULL;
+}
+
+static void RETRO_CALLCONV log_printf(enum retro_log_level level, const char *fmt, ...)
+{
+   va_list ap;
+
+   if (!opt_verbose && level < RETRO_LOG_WARN)
+      return;
+
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static const char *get_variable(const char *key)
+{
+   if (!strcmp(key, NAME_PREFIX "-gfxplugin"))
+      return "angrylion";
+   if (!strcmp(key, NAME_PREFIX "-rspplugin"))
+      return opt_rspplugin;
+   if (!strcmp(key, NAME_PREFIX "-cpucore"))
+      return opt_cpucore;
+   if (!strcmp(key, NAME_PREFIX "-framerate"))
+      return "original";
+   if (!strcmp(key, NAME_PREFIX "-angrylion-vioverlay"))
+      return "enabled";
+   if (!strcmp(key, NAME_PREFIX "-block-profiler"))
+      return opt_blockprof;
+   if (!strcmp(key, NAME_PREFIX "-threaded-emu"))
+      return opt_threaded ? "enabled" : "disabled";
+   if (!strcmp(key, NAME_PREFIX "-threaded-latency"))
+      return opt_threaded;
+   if (!strcmp(key, NAME_PREFIX "-movie"))
+      return opt_movie;
+   if (!strcmp(key, NAME_PREFIX "-dynarec-cache"))
+      return opt_dynacache;
+   return NULL;
+}
+
+static bool RETRO_CALLCONV environment(unsigned cmd, void *data)
+{
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_GET_VARIABLE:
+         {
+            struct retro_variable *var = (struct retro_variable*)data;
+            var->value = get_variable(var->key);
+            return var->value != NULL;
+         }
+      case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+         *(bool*)data = variables_updated;
+         variables_updated = false;
+         return true;
+      case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+         pixel_bytes = *(const enum retro_pixel_format*)data
+            == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2;
+         return true;
+      case RETRO_ENVIRONMENT_SET_VARIABLES:
+      case RETRO_ENVIRONMENT_SET_CONTROLLER_INFO:
+         return true;
+      case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+         ((struct retro_log_callback*)data)->log = log_printf;
+         return true;
+      case RETRO_ENVIRONMENT_GET_PERF_INTERFACE:
+         {
+            struct retro_perf_callback *cb = (struct retro_perf_callback*)data;
+            cb->get_time_usec    = perf_get_time_usec;
+            cb->get_cpu_features = perf_get_cpu_features;
+            cb->get_perf_counter = perf_get_counter;
+            cb->perf_register    = perf_register;
+            cb->perf_start       = perf_start;
+            cb->perf_stop        = perf_stop;
+            cb->perf_log         = perf_log;
+         }
+         return true;
+      case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+      case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+         *(const char**)data = ".";
+         return true;
+      default:
+         /* No hardware rendering, rumble, etc. */
+         return false;
+   }
+}
+
+/* FNV-1a over 64-bit words */
+static uint64_t hash_words(uint64_t hash, const void *data, size_t size)
+{
+   const unsigned char *p = (const unsigned char*)data;
+   size_t i;
+
+   for (i = 0; i + 8 <= size; i += 8)
+   {
+      uint64_t w;
+      memcpy(&w, p + i, 8);
+      hash = (hash ^ w) * UINT64_C(0x100000001b3);
+   }
+   for (; i < size; i++)
+      hash = (hash ^ p[i]) * UINT64_C(0x100000001b3);
+   return hash;
+}
+
+static void RETRO_CALLCONV video_refresh(const void *data, unsigned width,
+      unsigned height, size_t pitch)
+{
+   /* A dupe keeps the hash of the frame it repeats */
+   if (data && (hash_out || hash_ref))
+   {
+      retro_perf_tick_t start = get_ticks();
+      unsigned y;
+
+      frame_hash = UINT64_C(0xcbf29ce484222325);
+      for (y = 0; y < height; y++)
+         frame_hash = hash_words(frame_hash,
+               (const unsigned char*)data + y * pitch, width * pixel_bytes);
+      hash_ticks += get_ticks() - start;
+   }
+
+   /* Stand-in for the work a real frontend does per frame (scaling,
+    * shaders, presenting), which threaded emulation can overlap. */
+   if (opt_frontend_us)
+   {
+      retro_perf_tick_t end = get_ticks() + opt_frontend_us * 1000ull;
+      while (get_ticks() < end);
+   }
+
+   video_frames++;
+}
+
+static void RETRO_CALLCONV audio_sample(int16_t left, int16_t right)
+{
+   audio_frames++;
+}
+
+static size_t RETRO_CALLCONV audio_sample_batch(const int16_t *data, size_t frames)
+{
+   audio_frames += frames;
+   return frames;
+}
+
+static void RETRO_CALLCONV input_poll(void)
+{
+}
+
+static int16_t RETRO_CALLCONV input_state(unsigned port, unsigned device,
+      unsigned index, unsigned id)
+{
+   return 0;
+}
+
+#define LOAD_SYM(name) \
+   do { \
+      *(void**)&core.name = dlsym(core.handle, #name); \
+      if (!core.name) \
+      { \
+         fprintf(stderr, "bench: missing symbol %s in core\n", #name); \
+         return 0; \
+      } \
+   } while (0)
+
+static int load_core(const char *path)
+{
+   core.handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+   if (!core.handle)
+   {
+      fprintf(stderr, "bench: failed to load core '%s': %s\n", path, dlerror());
+      return 0;
+   }
+
+   LOAD_SYM(retro_init);
+   LOAD_SYM(retro_deinit);
+   LOAD_SYM(retro_set_environment);
+   LOAD_SYM(retro_set_video_refresh);
+   LOAD_SYM(retro_set_audio_sample);
+   LOAD_SYM(retro_set_audio_sample_batch);
+   LOAD_SYM(retro_set_input_poll);
+   LOAD_SYM(retro_set_input_state);
+   LOAD_SYM(retro_load_game);
+   LOAD_SYM(retro_unload_game);
+   LOAD_SYM(retro_run);
+   LOAD_SYM(retro_get_memory_data);
+   LOAD_SYM(retro_get_memory_size);
+
+   return 1;
+}
+
+static void *read_file(const char *path, size_t *size)
+{
+   long len;
+   void *buf;
+   FILE *fp = fopen(path, "rb");
+
+   if (!fp)
+      return NULL;
+
+   fseek(fp, 0, SEEK_END);
+   len = ftell(fp);
+   fseek(fp, 0, SEEK_SET);
+
+   buf = len > 0 ? malloc(len) : NULL;
+   if (buf && fread(buf, 1, len, fp) != (size_t)len)
+   {
+      free(buf);
+      buf = NULL;
+   }
+   fclose(fp);
+
+   *size = buf ? (size_t)len : 0;
+   return buf;
+}
+
+/* Writes or checks the hashes of the frame that just ran. */
+static void check_frame(unsigned frame)
+{
+   retro_perf_tick_t start;
+   const void *ram;
+   uint64_t ram_hash;
+
+   if (!hash_out && !hash_ref)
+      return;
+
+   start    = get_ticks();
+   ram      = core.retro_get_memory_data(RETRO_MEMORY_SYSTEM_RAM);
+   ram_hash = UINT64_C(0xcbf29ce484222325);
+   if (ram)
+      ram_hash = hash_words(ram_hash, ram,
+            core.retro_get_memory_size(RETRO_MEMORY_SYSTEM_RAM));
+
+   if (hash_out)
+      fprintf(hash_out, "%u %016llx %016llx\n", frame,
+            (unsigned long long)ram_hash, (unsigned long long)frame_hash);
+
+   if (hash_ref && diverged_at < 0)
+   {
+      unsigned ref_frame;
+      unsigned long long ref_ram, ref_fb;
+
+      if (fscanf(hash_ref, "%u %llx %llx", &ref_frame, &ref_ram, &ref_fb) != 3
+            || ref_frame != frame)
+      {
+         fprintf(stderr, "bench: no reference hashes for frame %u\n", frame);
+         fclose(hash_ref);
+         hash_ref = NULL;
+      }
+      else if (ref_ram != ram_hash || ref_fb != frame_hash)
+      {
+         diverged_at = frame;
+         fprintf(stderr, "bench: frame %u diverges from the reference (%s)\n", frame,
+               ref_ram != ram_hash ? (ref_fb != frame_hash ? "rdram, frame" : "rdram") : "frame");
+      }
+   }
+
+   hash_ticks += get_ticks() - start;
+}
+
+static void usage(const char *argv0)
+{
+   fprintf(stderr,
+         "usage: %s [options] <rom>\n"
+         "  -c <core>     libretro core to load (default ./parallel_n64_libretro.so)\n"
+         "  -n <frames>   frames to measure (default 600)\n"
+         "  -w <frames>   warm-up frames run before measuring (default 60)\n"
+         "  -p <cpucore>  pure_interpreter|cached_interpreter|dynamic_recompiler\n"
+         "  -r <rsp>      hle|cxd4|parallel\n"
+         "  -o <file>     append results as a CSV row to <file>\n"
+         "  -l <label>    label stored in the CSV row (e.g. a commit id)\n"
+         "  -v            forward core log messages\n"
+         "  -b            profile guest blocks during the measured frames\n"
+         "                (core built with PROFILE_BLOCKS=1)\n"
+         "  -t <latency>  threaded emulation with 0 or 1 frames of latency\n"
+         "  -f <usec>     simulated frontend time per presented frame\n"
+         "  -m <mode>     input movie: record|play (core option)\n"
+         "  -d            keep the dynarec's code in the code cache, loaded\n"
+         "                from and saved to the current directory\n"
+         "  -H <file>     write RDRAM and frame hashes of every frame to <file>\n"
+         "  -C <file>     compare the hashes with those written to <file>\n"
+         "                (not with -t 1)\n",
+         argv0);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned frame;
+   struct retro_game_info info;
+   retro_perf_tick_t start, elapsed, stage_total;
+   retro_perf_tick_t stage_ticks[NUM_STAGES];
+   double seconds;
+   const char *core_path = "./parallel_n64_libretro.so";
+   const char *rom_path  = NULL;
+   const char *csv_path  = NULL;
+   const char *label     = "";
+   const char *hash_path = NULL;
+   const char *ref_path  = NULL;
+   unsigned frames       = 600;
+   unsigned warmup       = 60;
+   int have_stages       = 1;
+   void *rom;
+   size_t rom_size;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-c") && i + 1 < argc)
+         core_path = argv[++i];
+      else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         frames = strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+         warmup = strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-p") && i + 1 < argc)
+         opt_cpucore = argv[++i];
+      else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+         opt_rspplugin = argv[++i];
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+         csv_path = argv[++i];
+      else if (!strcmp(argv[i], "-l") && i + 1 < argc)
+         label = argv[++i];
+      else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+         opt_threaded = !strcmp(argv[++i], "0") ? "0" : "1";
+      else if (!strcmp(argv[i], "-f") && i + 1 < argc)
+         opt_frontend_us = strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-m") && i + 1 < argc)
+         opt_movie = argv[++i];
+      else if (!strcmp(argv[i], "-H") && i + 1 < argc)
+         hash_path = argv[++i];
+      else if (!strcmp(argv[i], "-C") && i + 1 < argc)
+         ref_path = argv[++i];
+      else if (!strcmp(argv[i], "-b"))
+         opt_blockprof = "disabled";
+      else if (!strcmp(argv[i], "-d"))
+         opt_dynacache = "enabled";
+      else if (!strcmp(argv[i], "-v"))
+         opt_verbose = 1;
+      else if (argv[i][0] != '-' && !rom_path)
+         rom_path = argv[i];
+      else
+      {
+         usage(argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+
+   if (!rom_path || !frames)
+   {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   /* With a frame of latency the next frame is already running when
+    * retro_run returns, so RDRAM as it was at the end of a frame can't be
+    * read. With -t 0 the core syncs with its emulator thread first. */
+   if ((hash_path || ref_path) && opt_threaded && strcmp(opt_threaded, "0"))
+   {
+      fprintf(stderr, "bench: -H and -C need -t 0 with threaded emulation\n");
+      return EXIT_FAILURE;
+   }
+
+   rom = read_file(rom_path, &rom_size);
+   if (!rom)
+   {
+      fprintf(stderr, "bench: failed to read ROM '%s'\n", rom_path);
+      return EXIT_FAILURE;
+   }
+
+   if (!load_core(core_path))
+      return EXIT_FAILURE;
+
+   if (hash_path && !(hash_out = fopen(hash_path, "w")))
+   {
+      fprintf(stderr, "bench: failed to create '%s'\n", hash_path);
+      return EXIT_FAILURE;
+   }
+   if (ref_path && !(hash_ref = fopen(ref_path, "r")))
+   {
+      fprintf(stderr, "bench: failed to open '%s'\n", ref_path);
+      return EXIT_FAILURE;
+   }
+
+   core.retro_set_environment(environment);
+   core.retro_set_video_refresh(video_refresh);
+   core.retro_set_audio_sample(audio_sample);
+   core.retro_set_audio_sample_batch(audio_sample_batch);
+   core.retro_set_input_poll(input_poll);
+   core.retro_set_input_state(input_state);
+   core.retro_init();
+
+   info.path = rom_path;
+   info.data = rom;
+   info.size = rom_size;
+   info.meta = NULL;
+
+   if (!core.retro_load_game(&info))
+   {
+      fprintf(stderr, "bench: core failed to load '%s'\n", rom_path);
+      return EXIT_FAILURE;
+   }
+
+   for (frame = 0; frame < warmup; frame++)
+   {
+      core.retro_run();
+      check_frame(frame);
+   }
+
+   /* The block profiler is switched through its core option so that only
+    * the measured frames are attributed; switching it off dumps the report. */
+   if (opt_blockprof)
+   {
+      opt_blockprof     = "enabled";
+      variables_updated = true;
+   }
+
+   perf_reset();
+   video_frames = 0;
+   audio_frames = 0;
+   counting     = 1;
+   hash_ticks   = 0;
+
+   start = get_ticks();
+   for (frame = 0; frame < frames; frame++)
+   {
+      core.retro_run();
+      check_frame(warmup + frame);
+   }
+   elapsed = get_ticks() - start - hash_ticks;
+
+   counting = 0;
+
+   if (opt_blockprof)
+   {
+      opt_blockprof     = "disabled";
+      variables_updated = true;
+      opt_verbose       = 1;
+      core.retro_run();
+   }
+
+   stage_total = 0;
+   for (i = 0; i < NUM_STAGES; i++)
+   {
+      struct retro_perf_counter *counter = perf_find(stage_idents[i]);
+      stage_ticks[i] = counter ? counter->total : 0;
+      stage_total   += stage_ticks[i];
+   }
+
+   /* The core only registers a counter the first time its stage runs, so
+    * a build without PERF_TEST shows up as no counters at all. */
+   if (!num_counters)
+   {
+      have_stages = 0;
+      fprintf(stderr, "bench: core exposes no perf counters, rebuild it with PERF_TEST=1 for a breakdown\n");
+   }
+
+   seconds = elapsed / 1e9;
+
+   printf("rom:       %s\n", rom_path);
+   printf("cpucore:   %s\n", opt_cpucore);
+   printf("rsp:       %s\n", opt_rspplugin);
+   if (opt_threaded)
+      printf("threaded:  latency %s\n", opt_threaded);
+   printf("frames:    %u (%u presented, %lu audio frames)\n",
+         frames, video_frames, (unsigned long)audio_frames);
+   printf("time:      %.3f s\n", seconds);
+   printf("fps:       %.2f\n", frames / seconds);
+
+   if (have_stages)
+   {
+      printf("%-10s %12s %10s %8s\n", "stage", "total (ms)", "ms/frame", "share");
+      printf("%-10s %12.2f %10.3f %7.1f%%\n", "r4300",
+            (elapsed - stage_total) / 1e6,
+            (elapsed - stage_total) / 1e6 / frames,
+            100.0 * (elapsed - stage_total) / elapsed);
+      for (i = 0; i < NUM_STAGES; i++)
+         printf("%-10s %12.2f %10.3f %7.1f%%\n", stage_names[i],
+               stage_ticks[i] / 1e6,
+               stage_ticks[i] / 1e6 / frames,
+               100.0 * stage_ticks[i] / elapsed);
+   }
+
+   if (csv_path)
+   {
+      FILE *csv = fopen(csv_path, "a+");
+
+      if (!csv)
+         fprintf(stderr, "bench: failed to open '%s'\n", csv_path);
+      else
+      {
+         fseek(csv, 0, SEEK_END);
+         if (ftell(csv) == 0)
+            fprintf(csv, "label,rom,cpucore,rsp,frames,seconds,fps,r4300_ms,rsp_ms,rdp_ms,vi_ms,audio_ms\n");
+
+         fprintf(csv, "%s,%s,%s,%s,%u,%.6f,%.3f", label, rom_path,
+               opt_cpucore, opt_rspplugin, frames, seconds, frames / seconds);
+         if (have_stages)
+         {
+            fprintf(csv, ",%.3f", (elapsed - stage_total) / 1e6);
+            for (i = 0; i < NUM_STAGES; i++)
+               fprintf(csv, ",%.3f", stage_ticks[i] / 1e6);
+            fprintf(csv, "\n");
+         }
+         else
+            fprintf(csv, ",,,,,\n");
+         fclose(csv);
+      }
+   }
+
+   core.retro_unload_game();
+   core.retro_deinit();
+   free(rom);
+
+   if (hash_out)
+      fclose(hash_out);
+   if (hash_ref)
+      fclose(hash_ref);
+
+   if (diverged_at >= 0)
+      return EXIT_FAILURE;
+   return EXIT_SUCCESS;
+}
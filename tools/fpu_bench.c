@@ -0,0 +1,278 @@
+/* fpu_bench
+ * Correctness and speed check for the interpreter's FPU helpers in
+ * mupen64plus-core/src/r4300/fpu.h.
+ *
+ * A stream of FPU instructions, weighted like the inner loops of 3D games
+ * (mostly ADD/SUB/MUL on singles, some DIV, SQRT and conversions), is run
+ * over random operands:
+ *   - lazily, as the core does, setting the host rounding mode only when
+ *     FCR31 asks for another one,
+ *   - eagerly, setting it before every operation as the core used to.
+ * Both runs must give the same bits, in each of the four rounding modes
+ * and with CTC1 switching modes within the stream.
+ *
+ * The round, trunc, ceil and floor conversions are also compared with
+ * libm on values around the halfway points and the integer limits.
+ *
+ * Built with "make fpu_bench", add -msse4.1 to CC to check the SSE4.1
+ * conversions. Exits non-zero on the first mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "r4300/fpu.h"
+
+uint32_t FCR31;
+uint32_t host_rounding_mode = ~UINT32_C(0);
+
+#define STREAM_OPS   4096
+#define BENCH_PASSES 2000
+#define CTC1_EVERY   512
+
+enum op
+{
+   OP_ADD_S = 0,
+   OP_SUB_S,
+   OP_MUL_S,
+   OP_DIV_S,
+   OP_SQRT_S,
+   OP_ADD_D,
+   OP_MUL_D,
+   OP_DIV_D,
+   OP_CVT_S_W,
+   OP_CVT_S_D,
+   OP_CVT_W_S,
+   OP_CVT_D_L,
+   OP_CTC1,
+   OP_COUNT
+};
+
+/* Out of 64 */
+static const unsigned op_weights[OP_COUNT] = {
+   14, 8, 18, 4, 2, 3, 3, 1, 3, 3, 4, 1, 0
+};
+
+struct insn
+{
+   unsigned op;
+   unsigned a, b;
+};
+
+static struct insn stream[STREAM_OPS];
+static float fs[64];
+static double fd[64];
+static int32_t iw[64];
+static int64_t il[64];
+
+static double get_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void make_stream(int ctc1)
+{
+   unsigned i, k, pick;
+
+   for (i = 0; i < STREAM_OPS; i++)
+   {
+      stream[i].a = rand() & 63;
+      stream[i].b = rand() & 63;
+      if (ctc1 && i % CTC1_EVERY == CTC1_EVERY - 1)
+      {
+         stream[i].op = OP_CTC1;
+         continue;
+      }
+      pick = rand() & 63;
+      for (k = 0; pick >= op_weights[k]; k++)
+         pick -= op_weights[k];
+      stream[i].op = k;
+   }
+}
+
+/* The operands are computed in the default rounding mode. */
+static void reset_regs(void)
+{
+   unsigned i;
+
+   FCR31 = 0;
+   set_rounding();
+   srand(2);
+   for (i = 0; i < 64; i++)
+   {
+      fs[i] = (float)(rand() - RAND_MAX / 2) / (float)(rand() % 1000 + 1);
+      fd[i] = (double)(rand() - RAND_MAX / 2) / (double)(rand() % 1000 + 1);
+      iw[i] = rand() - RAND_MAX / 2;
+      il[i] = ((int64_t)rand() << 20) ^ rand();
+   }
+}
+
+/* Results are written back at a, keeping the values bounded by dividing
+ * the ones that grew large. */
+static void run_stream(int eager)
+{
+   unsigned i;
+
+   for (i = 0; i < STREAM_OPS; i++)
+   {
+      const struct insn *in = &stream[i];
+      unsigned a = in->a, b = in->b;
+
+      if (eager)
+         host_rounding_mode = ~UINT32_C(0);
+
+      switch (in->op)
+      {
+         case OP_ADD_S:   add_s(&fs[a], &fs[b], &fs[a]); break;
+         case OP_SUB_S:   sub_s(&fs[a], &fs[b], &fs[a]); break;
+         case OP_MUL_S:   mul_s(&fs[a], &fs[b], &fs[a]); break;
+         case OP_DIV_S:   div_s(&fs[a], &fs[b], &fs[a]); break;
+         case OP_SQRT_S:  abs_s(&fs[b], &fs[b]); sqrt_s(&fs[b], &fs[a]); break;
+         case OP_ADD_D:   add_d(&fd[a], &fd[b], &fd[a]); break;
+         case OP_MUL_D:   mul_d(&fd[a], &fd[b], &fd[a]); break;
+         case OP_DIV_D:   div_d(&fd[a], &fd[b], &fd[a]); break;
+         case OP_CVT_S_W: cvt_s_w(&iw[b], &fs[a]); break;
+         case OP_CVT_S_D: cvt_s_d(&fd[b], &fs[a]); break;
+         case OP_CVT_W_S: cvt_w_s(&fs[b], &iw[a]); break;
+         case OP_CVT_D_L: cvt_d_l(&il[b], &fd[a]); break;
+         case OP_CTC1:    FCR31 = (FCR31 & ~UINT32_C(3)) | (b & 3); break;
+      }
+      if (!(fs[a] > -1e6f && fs[a] < 1e6f))
+         fs[a] = (float)(a + 1) / 3.0f;
+      if (!(fd[a] > -1e12 && fd[a] < 1e12))
+         fd[a] = (double)(a + 1) / 3.0;
+   }
+}
+
+static int check_stream(uint32_t mode, int ctc1)
+{
+   float fs_lazy[64];
+   double fd_lazy[64];
+   int32_t iw_lazy[64];
+   unsigned pass;
+
+   make_stream(ctc1);
+
+   reset_regs();
+   FCR31 = mode;
+   for (pass = 0; pass < 4; pass++)
+      run_stream(0);
+   memcpy(fs_lazy, fs, sizeof(fs));
+   memcpy(fd_lazy, fd, sizeof(fd));
+   memcpy(iw_lazy, iw, sizeof(iw));
+
+   reset_regs();
+   FCR31 = mode;
+   for (pass = 0; pass < 4; pass++)
+      run_stream(1);
+
+   if (memcmp(fs_lazy, fs, sizeof(fs)) || memcmp(fd_lazy, fd, sizeof(fd))
+         || memcmp(iw_lazy, iw, sizeof(iw)))
+   {
+      printf("stream, mode %u%s: lazy and eager results differ\n",
+            mode, ctc1 ? " with CTC1" : "");
+      return 0;
+   }
+   return 1;
+}
+
+static int check_conversions(void)
+{
+   static const double edges[] = {
+      0.0, 0.25, 0.5, 0.75, 1.0, 1.5, 2.5, 3.5, 1e-30,
+      8388607.5, 8388608.0, 16777215.0, 16777217.0,
+      2147483647.0, 2147483648.0, 4503599627370495.5, 4503599627370496.0,
+   };
+   unsigned i, k, mode;
+
+   for (mode = 0; mode < 4; mode++)
+   {
+      FCR31 = mode;
+      set_rounding();
+      for (i = 0; i < sizeof(edges) / sizeof(edges[0]); i++)
+         for (k = 0; k < 4; k++)
+         {
+            double d = edges[i] * (k & 1 ? -1.0 : 1.0);
+            float f;
+            int64_t got, expect;
+
+            if (k & 2)
+               d = nextafter(d, 0.0);
+            f = (float)d;
+
+            round_l_d(&d, &got); expect = (int64_t)round(d);
+            if (got != expect) goto fail;
+            trunc_l_d(&d, &got); expect = (int64_t)trunc(d);
+            if (got != expect) goto fail;
+            ceil_l_d(&d, &got);  expect = (int64_t)ceil(d);
+            if (got != expect) goto fail;
+            floor_l_d(&d, &got); expect = (int64_t)floor(d);
+            if (got != expect) goto fail;
+
+            round_l_s(&f, &got); expect = (int64_t)roundf(f);
+            if (got != expect) goto fail;
+            trunc_l_s(&f, &got); expect = (int64_t)truncf(f);
+            if (got != expect) goto fail;
+            ceil_l_s(&f, &got);  expect = (int64_t)ceilf(f);
+            if (got != expect) goto fail;
+            floor_l_s(&f, &got); expect = (int64_t)floorf(f);
+            if (got != expect) goto fail;
+            continue;
+fail:
+            printf("conversion of %.17g, mode %u: %lld instead of %lld\n",
+                  d, mode, (long long)got, (long long)expect);
+            return 0;
+         }
+   }
+   return 1;
+}
+
+static double bench(int eager)
+{
+   double start;
+   unsigned pass;
+
+   reset_regs();
+   FCR31 = 0;
+   start = get_time();
+   for (pass = 0; pass < BENCH_PASSES; pass++)
+      run_stream(eager);
+   return get_time() - start;
+}
+
+int main(void)
+{
+   double lazy, eager;
+   uint32_t mode;
+
+#if defined(__SSE4_1__)
+   printf("fpu: SSE4.1 conversions\n");
+#else
+   printf("fpu: libm conversions\n");
+#endif
+
+   if (!check_conversions())
+      return 1;
+   printf("round, trunc, ceil, floor ok\n");
+
+   for (mode = 0; mode < 4; mode++)
+      if (!check_stream(mode, 0))
+         return 1;
+   if (!check_stream(0, 1))
+      return 1;
+   printf("instruction streams ok\n");
+
+   srand(1);
+   make_stream(0);
+   lazy  = bench(0);
+   eager = bench(1);
+
+   printf("\n%u ops: %.2f ns/op lazy, %.2f ns/op eager, %.1fx\n",
+         STREAM_OPS * BENCH_PASSES,
+         lazy * 1e9 / (STREAM_OPS * BENCH_PASSES),
+         eager * 1e9 / (STREAM_OPS * BENCH_PASSES), eager / lazy);
+   return 0;
+}
@@ -0,0 +1,332 @@
+/* gsp_vertex_check
+ * Bit-exactness and speed check for the batched vertex pipeline in
+ * Graphics/RSP/gSP_vertex.c.
+ *
+ * Every step is compared, bit for bit, with the per-vertex code the
+ * plugins ran before it: TransformVectorNormalize and NormalizeVector
+ * from Graphics/3dmath.h for normals, and gles2n64's
+ * gln64gSPTransformVertex_default, gln64gSPLightVertex_default and
+ * gln64gSPClipVertex, which are static there and repeated below, for
+ * positions, lights and clip codes.
+ *
+ * The loads are random, of every size up to VERTEX_BATCH_SIZE so that
+ * each SIMD/scalar split is hit, and get some zero normals, zeros of
+ * both signs, infinities, NaNs and vertices right on the clip planes.
+ *
+ * Then the time per vertex of transform plus normals is printed for a
+ * 32 vertex load, for the batch and for the per-vertex loop.
+ *
+ * Built with "make gsp_vertex_check". Exits non-zero on the first
+ * mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "3dmath.h"
+#include "RSP/gSP_vertex.h"
+
+#define LOADS       20000
+#define MAX_LIGHTS  7
+#define BENCH_LOADS 200000
+#define BENCH_SIZE  32
+
+struct vertex
+{
+   float pos[4];
+   float n[3];
+   float col[3];
+   uint32_t clip;
+};
+
+struct light
+{
+   float dir[3];
+   float col[3];
+};
+
+static double get_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Mostly small values, sometimes one of the edge cases. */
+static float random_float(void)
+{
+   switch (rand() % 64)
+   {
+      case 0:
+         return 0.0f;
+      case 1:
+         return -0.0f;
+      case 2:
+         return INFINITY;
+      case 3:
+         return NAN;
+      default:
+         break;
+   }
+   return (float)(rand() - RAND_MAX / 2) / (float)(RAND_MAX / 8);
+}
+
+/* gln64gSPTransformVertex_default */
+static void ref_transform(float vtx[4], float mtx[4][4])
+{
+   float x, y, z, w;
+   x = vtx[0];
+   y = vtx[1];
+   z = vtx[2];
+   w = vtx[3];
+
+   vtx[0] = x * mtx[0][0] + y * mtx[1][0] + z * mtx[2][0] + mtx[3][0];
+   vtx[1] = x * mtx[0][1] + y * mtx[1][1] + z * mtx[2][1] + mtx[3][1];
+   vtx[2] = x * mtx[0][2] + y * mtx[1][2] + z * mtx[2][2] + mtx[3][2];
+   vtx[3] = x * mtx[0][3] + y * mtx[1][3] + z * mtx[2][3] + mtx[3][3];
+   (void)w;
+}
+
+/* gln64gSPLightVertex_default, without hardware lighting */
+static void ref_light(struct vertex *vtx, const struct light *lights,
+      unsigned num_lights)
+{
+   unsigned i;
+
+   vtx->col[0] = lights[num_lights].col[0];
+   vtx->col[1] = lights[num_lights].col[1];
+   vtx->col[2] = lights[num_lights].col[2];
+
+   for (i = 0; i < num_lights; i++)
+   {
+      float intensity = DotProduct(vtx->n, lights[i].dir);
+      if (intensity < 0.0f)
+         intensity = 0.0f;
+      vtx->col[0] += lights[i].col[0] * intensity;
+      vtx->col[1] += lights[i].col[1] * intensity;
+      vtx->col[2] += lights[i].col[2] * intensity;
+   }
+
+   vtx->col[0] = MIN(1.0f, vtx->col[0]);
+   vtx->col[1] = MIN(1.0f, vtx->col[1]);
+   vtx->col[2] = MIN(1.0f, vtx->col[2]);
+}
+
+/* gln64gSPClipVertex, the near plane at w_min */
+static void ref_clip(struct vertex *vtx, float w_min)
+{
+   const float *v = vtx->pos;
+
+   vtx->clip = 0;
+   if (v[0] > +v[3])   vtx->clip |= VERTEX_CLIP_POSX;
+   if (v[0] < -v[3])   vtx->clip |= VERTEX_CLIP_NEGX;
+   if (v[1] > +v[3])   vtx->clip |= VERTEX_CLIP_POSY;
+   if (v[1] < -v[3])   vtx->clip |= VERTEX_CLIP_NEGY;
+   if (v[3] < w_min)   vtx->clip |= VERTEX_CLIP_Z;
+}
+
+/* Bit for bit, except that any NaN matches any NaN: which operand's NaN
+ * an addition passes on depends on the order the compiler picked. */
+static int same(const char *step, unsigned load, unsigned i,
+      const char *name, float got, float want)
+{
+   if (!memcmp(&got, &want, sizeof(got)) || (isnan(got) && isnan(want)))
+      return 1;
+   printf("%s: mismatch, load %u vertex %u %s: %a, expected %a\n",
+         step, load, i, name, got, want);
+   return 0;
+}
+
+static int check_load(unsigned load, unsigned n)
+{
+   unsigned i, j;
+   float mtx[4][4], mv[4][4];
+   struct vertex ref[VERTEX_BATCH_SIZE];
+   struct light lights[MAX_LIGHTS + 1];
+   struct vertex_batch_light batch_lights[MAX_LIGHTS];
+   struct vertex_batch batch;
+   unsigned num_lights = rand() % (MAX_LIGHTS + 1);
+   float ambient[3];
+   float w_min = (rand() & 1) ? 0.1f : 0.01f;
+
+   for (i = 0; i < 4; i++)
+      for (j = 0; j < 4; j++)
+      {
+         mtx[i][j] = random_float();
+         mv[i][j]  = random_float();
+      }
+
+   for (i = 0; i <= num_lights; i++)
+   {
+      for (j = 0; j < 3; j++)
+      {
+         lights[i].dir[j] = random_float();
+         lights[i].col[j] = fabsf(random_float()) / 4.0f;
+      }
+      NormalizeVector(lights[i].dir);
+   }
+   for (i = 0; i < num_lights; i++)
+      for (j = 0; j < 3; j++)
+      {
+         batch_lights[i].dir[j] = lights[i].dir[j];
+         batch_lights[i].col[j] = lights[i].col[j];
+      }
+   for (j = 0; j < 3; j++)
+      ambient[j] = lights[num_lights].col[j];
+
+   for (i = 0; i < n; i++)
+   {
+      ref[i].pos[0] = batch.x[i]  = (float)(rand() % 2048 - 1024);
+      ref[i].pos[1] = batch.y[i]  = (float)(rand() % 2048 - 1024);
+      ref[i].pos[2] = batch.z[i]  = (float)(rand() % 2048 - 1024);
+      ref[i].pos[3] = 1.0f;
+      ref[i].n[0]   = batch.nx[i] = (rand() % 8) ? (float)(rand() % 256 - 128) : 0.0f;
+      ref[i].n[1]   = batch.ny[i] = (rand() % 8) ? (float)(rand() % 256 - 128) : 0.0f;
+      ref[i].n[2]   = batch.nz[i] = (rand() % 8) ? (float)(rand() % 256 - 128) : 0.0f;
+   }
+
+   gSPBatchTransform(&batch, n, mtx);
+   for (i = 0; i < n; i++)
+   {
+      ref_transform(ref[i].pos, mtx);
+      if (!same("transform", load, i, "x", batch.x[i], ref[i].pos[0])
+            || !same("transform", load, i, "y", batch.y[i], ref[i].pos[1])
+            || !same("transform", load, i, "z", batch.z[i], ref[i].pos[2])
+            || !same("transform", load, i, "w", batch.w[i], ref[i].pos[3]))
+         return 0;
+   }
+
+   /* Some vertices on the clip planes */
+   for (i = 0; i < n; i++)
+   {
+      switch (rand() % 8)
+      {
+         case 0: batch.x[i] = ref[i].pos[0] = ref[i].pos[3]; break;
+         case 1: batch.y[i] = ref[i].pos[1] = -ref[i].pos[3]; break;
+         case 2: batch.w[i] = ref[i].pos[3] = w_min; break;
+         default: break;
+      }
+   }
+
+   gSPBatchClip(&batch, n, w_min);
+   for (i = 0; i < n; i++)
+   {
+      ref_clip(&ref[i], w_min);
+      if (batch.clip[i] != ref[i].clip)
+      {
+         printf("clip: mismatch, load %u vertex %u: %x, expected %x\n",
+               load, i, (unsigned)batch.clip[i], (unsigned)ref[i].clip);
+         return 0;
+      }
+   }
+
+   if (load & 1)
+   {
+      gSPBatchTransformNormals(&batch, n, mv);
+      for (i = 0; i < n; i++)
+         TransformVectorNormalize(ref[i].n, mv);
+   }
+   else
+   {
+      gSPBatchNormalize(&batch, n);
+      for (i = 0; i < n; i++)
+         NormalizeVector(ref[i].n);
+   }
+   for (i = 0; i < n; i++)
+      if (!same("normals", load, i, "nx", batch.nx[i], ref[i].n[0])
+            || !same("normals", load, i, "ny", batch.ny[i], ref[i].n[1])
+            || !same("normals", load, i, "nz", batch.nz[i], ref[i].n[2]))
+         return 0;
+
+   gSPBatchLight(&batch, n, batch_lights, num_lights, ambient);
+   for (i = 0; i < n; i++)
+   {
+      ref_light(&ref[i], lights, num_lights);
+      if (!same("light", load, i, "r", batch.r[i], ref[i].col[0])
+            || !same("light", load, i, "g", batch.g[i], ref[i].col[1])
+            || !same("light", load, i, "b", batch.b[i], ref[i].col[2]))
+         return 0;
+   }
+
+   return 1;
+}
+
+static void bench(void)
+{
+   unsigned load, i, j;
+   float mtx[4][4], mv[4][4];
+   struct vertex ref[BENCH_SIZE];
+   struct vertex_batch batch;
+   double start, batched, scalar;
+   volatile float sink = 0.0f;
+
+   for (i = 0; i < 4; i++)
+      for (j = 0; j < 4; j++)
+      {
+         mtx[i][j] = (float)(rand() % 200 - 100) / 50.0f;
+         mv[i][j]  = (float)(rand() % 200 - 100) / 50.0f;
+      }
+
+   start = get_time();
+   for (load = 0; load < BENCH_LOADS; load++)
+   {
+      for (i = 0; i < BENCH_SIZE; i++)
+      {
+         batch.x[i]  = batch.nx[i] = (float)(i + load);
+         batch.y[i]  = batch.ny[i] = (float)i;
+         batch.z[i]  = batch.nz[i] = 1.0f;
+      }
+      gSPBatchTransform(&batch, BENCH_SIZE, mtx);
+      gSPBatchTransformNormals(&batch, BENCH_SIZE, mv);
+      sink += batch.w[load % BENCH_SIZE] + batch.nz[load % BENCH_SIZE];
+   }
+   batched = get_time() - start;
+
+   start = get_time();
+   for (load = 0; load < BENCH_LOADS; load++)
+   {
+      for (i = 0; i < BENCH_SIZE; i++)
+      {
+         ref[i].pos[0] = ref[i].n[0] = (float)(i + load);
+         ref[i].pos[1] = ref[i].n[1] = (float)i;
+         ref[i].pos[2] = ref[i].n[2] = 1.0f;
+         ref[i].pos[3] = 1.0f;
+         ref_transform(ref[i].pos, mtx);
+         TransformVectorNormalize(ref[i].n, mv);
+      }
+      sink += ref[load % BENCH_SIZE].pos[3] + ref[load % BENCH_SIZE].n[2];
+   }
+   scalar = get_time() - start;
+
+   printf("\n%-20s %10s %10s %9s\n", "", "ns/vertex", "scalar", "speedup");
+   printf("%-20s %10.2f %10.2f %8.1fx\n", "transform+normals",
+         batched * 1e9 / ((double)BENCH_LOADS * BENCH_SIZE),
+         scalar * 1e9 / ((double)BENCH_LOADS * BENCH_SIZE),
+         scalar / batched);
+   (void)sink;
+}
+
+int main(void)
+{
+   unsigned load;
+
+   srand(1);
+
+#if defined(__SSE__) || defined(_M_X64)
+   printf("gSP_vertex: SSE\n");
+#elif defined(__ARM_NEON__) && defined(HAVE_NEON)
+   printf("gSP_vertex: NEON\n");
+#else
+   printf("gSP_vertex: C\n");
+#endif
+
+   for (load = 0; load < LOADS; load++)
+      if (!check_load(load, load % VERTEX_BATCH_SIZE + 1))
+         return 1;
+   printf("%u loads ok\n", LOADS);
+
+   bench();
+   return 0;
+}
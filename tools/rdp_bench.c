@@ -0,0 +1,629 @@
+/* rdp_bench
+ * Check and speed test for angrylion's parallel rasterizer (the tile bins
+ * in mupen64plus-video-angrylion/n64video.c).
+ *
+ * Random frames of commands go through process_RDP_list() in random
+ * pieces, cut inside commands too: the 8 kinds of triangles and the
+ * rectangles in every cycle type, with random modes, combiners, colors,
+ * scissors and textures, color and Z images which may overlap, images
+ * changing inside frames, loads from the images being drawn to, and
+ * frames longer than the command buffer. After each frame RDRAM and the
+ * hidden bits are hashed, and must match:
+ *   - those of the serial rasterizer, on 2 to WORKERS_MAX workers, for
+ *     frames without what a tile draws differently by design: noise, the
+ *     combined color and texel 1 in 1-cycle mode and the 2-cycle blender's
+ *     memory inputs in the first cycle, which come from the pixel before;
+ *   - those of 2 workers, on 3 to WORKERS_MAX workers, for frames with all
+ *     of it.
+ * Both keep away from the modes that crash the RDP.
+ *
+ * Then the time of a frame of small triangles and of a frame of large
+ * ones is printed, serial, on 4 workers and on one per core, along with
+ * the tiles per primitive and an estimate for 4 cores: the tiles are run
+ * one at a time and timed, and handed out to 4 simulated workers as the
+ * pool would, the first free one taking the next tile. Built with
+ * "make rdp_bench"; exits non-zero on the first mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void bench_workers_run(void (*task)(void*, unsigned), void* arg, unsigned tasks);
+
+#define workers_run bench_workers_run
+#include "n64video.c"
+#include "n64video_vi.c"
+#undef workers_run
+
+void workers_run(void (*task)(void*, unsigned), void* arg, unsigned tasks);
+
+#define RAM_SIZE      0x800000
+#define LIST_ADDRESS  0x600000  /* out of reach of the images */
+#define LIST_MAX      ((RAM_SIZE - LIST_ADDRESS) / 8)
+#define CHECK_FRAMES  100
+#define BENCH_FRAMES  10
+#define SIM_WORKERS   4
+
+GFX_INFO gfx_info;
+uint32_t *blitter_buf_lock;
+int32_t pitchindwords = PRESCALE_WIDTH;
+RECT __src;
+retro_log_printf_t log_cb;
+
+static uint32_t dp_regs[4];
+static uint32_t mi_intr;
+static uint32_t *ram;
+static uint32_t *ram_start;
+static unsigned emitted;
+
+static struct
+{
+   int exact;           /* frames drawn the same as by the serial rasterizer */
+   uint32_t color, z;
+   int size, width;
+   int cycle_type;
+} gen;
+
+static struct
+{
+   int on;
+   double tasks;        /* time of the tiles, one at a time */
+   double makespan;     /* time of the tiles on SIM_WORKERS workers */
+   double primitives, entries;
+} sim;
+
+static void check_interrupts(void)
+{
+}
+
+static double get_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench_workers_run(void (*task)(void*, unsigned), void* arg, unsigned tasks)
+{
+   double busy[SIM_WORKERS] = { 0 };
+   double begin, t, last = 0;
+   unsigned i, w, next;
+
+   if (!sim.on)
+   {
+      workers_run(task, arg, tasks);
+      return;
+   }
+
+   sim.primitives += bins.primitives;
+   sim.entries += bins.entries;
+   for (i = 0; i < tasks; i++)
+   {
+      begin = get_time();
+      task(arg, i);
+      t = get_time() - begin;
+      sim.tasks += t;
+
+      next = 0;
+      for (w = 1; w < SIM_WORKERS; w++)
+         if (busy[w] < busy[next])
+            next = w;
+      busy[next] += t;
+   }
+   for (w = 0; w < SIM_WORKERS; w++)
+      last = busy[w] > last ? busy[w] : last;
+   sim.makespan += last;
+}
+
+static uint32_t rand32(void)
+{
+   return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static int range(int low, int high)
+{
+   return low + rand() % (high - low + 1);
+}
+
+static void emit(uint32_t w1, uint32_t w2)
+{
+   if (emitted >= LIST_MAX)
+      return;
+   ram[LIST_ADDRESS / 4 + 2 * emitted + 0] = w1;
+   ram[LIST_ADDRESS / 4 + 2 * emitted + 1] = w2;
+   emitted++;
+}
+
+static void emit_color_image(uint32_t address, int size, int width)
+{
+   emit(0x3F000000 | (size << 19) | (width - 1), address);
+}
+
+static void emit_scissor(int xl, int yl)
+{
+   emit(0x2D000000 | (range(0, 8) << 12) | range(0, 8), (xl << 12) | yl);
+}
+
+static void random_images(void)
+{
+   static const uint32_t colors[] = { 0x100000, 0x200000, 0x300000 };
+
+   gen.color = colors[rand() % 3];
+   if (rand() % 4 == 0)
+      gen.color += range(1, 0x2000) * 8;
+   gen.size = rand() % 3 ? PIXEL_SIZE_16BIT : PIXEL_SIZE_32BIT;
+   if (gen.cycle_type == CYCLE_TYPE_COPY)
+      gen.size = PIXEL_SIZE_16BIT; /* copying to 32-bit crashes */
+   switch (rand() % 3)
+   {
+      case 0:  gen.width = 320; break;
+      case 1:  gen.width = 640; break;
+      default: gen.width = range(8, 640); break;
+   }
+
+   switch (rand() % 4)
+   {
+      case 0:  gen.z = gen.color; break;
+      case 1:  gen.z = gen.color + range(1, 0x1000) * 8; break;
+      default: gen.z = 0x480000; break;
+   }
+
+   emit(0x3E000000, gen.z);
+   emit_color_image(gen.color, gen.size, gen.width);
+   /* past the right edge at times, for the serial fallback */
+   emit_scissor(range(1, gen.width + 4) * 4 + range(0, 3), range(1, 480) * 4 + range(0, 3));
+}
+
+static void random_combine(void)
+{
+   /* No noise, no combined color and no texel 1, which in 1-cycle mode is
+    * the next pixel's texel 0. */
+   static const int rgb_a[] = { 1, 3, 4, 5, 6, 8 };
+   static const int rgb_b[] = { 1, 3, 4, 5, 6, 8 };
+   static const int rgb_c[] = { 1, 3, 4, 5, 8, 10, 11, 12, 15, 16 };
+   static const int rgb_d[] = { 1, 3, 4, 5, 6, 7 };
+   static const int alpha[] = { 1, 3, 4, 5, 6, 7 };
+   uint32_t w1 = 0x3C000000, w2 = 0;
+
+   if (!gen.exact)
+   {
+      emit(w1 | (rand32() & 0x00FFFFFF), rand32());
+      return;
+   }
+
+#define PICK(table) (table[rand() % (sizeof(table) / sizeof(table[0]))])
+   w1 |= PICK(rgb_a) << 20 | PICK(rgb_c) << 15 | PICK(alpha) << 12;
+   w1 |= PICK(alpha) <<  9 | PICK(rgb_a) <<  5 | PICK(rgb_c) <<  0;
+   w2 |= (uint32_t)PICK(rgb_b) << 28 | PICK(rgb_b) << 24 | PICK(alpha) << 21;
+   w2 |= PICK(alpha) << 18 | PICK(rgb_d) << 15 | PICK(alpha) << 12;
+   w2 |= PICK(alpha) <<  9 | PICK(rgb_d) <<  6 | PICK(alpha) <<  3;
+   w2 |= PICK(alpha) <<  0;
+#undef PICK
+   emit(w1, w2);
+}
+
+static void random_modes(void)
+{
+   static const int dithers[] = { 0, 1, 3 };
+   uint32_t w1, w2;
+   int m1a_0, m2a_0, m2b_0;
+
+   switch (rand() % 10)
+   {
+      case 0:  gen.cycle_type = CYCLE_TYPE_FILL; break;
+      case 1:  gen.cycle_type = CYCLE_TYPE_COPY; break;
+      case 2:
+      case 3:
+      case 4:  gen.cycle_type = CYCLE_TYPE_2; break;
+      default: gen.cycle_type = CYCLE_TYPE_1; break;
+   }
+   if (gen.cycle_type == CYCLE_TYPE_COPY && gen.size != PIXEL_SIZE_16BIT)
+      gen.cycle_type = CYCLE_TYPE_1;
+
+   /* Without the TLUT, which loads crash on. */
+   w1 = 0x2F000000 | (gen.cycle_type << 20) | (rand32() & 0x000F3FF0);
+   w2 = rand32();
+   if (gen.exact)
+   {
+      /* Without the dither noise and the alpha compare's */
+      w1 = (w1 & ~0x000000F0) | dithers[rand() % 3] << 6 | dithers[rand() % 3] << 4;
+      w2 &= 0xFFFFFFFD;
+      if (gen.cycle_type == CYCLE_TYPE_2)
+      {
+         do
+         {
+            m1a_0 = rand() & 3;
+            m2a_0 = rand() & 3;
+            m2b_0 = rand() & 3;
+         } while (m1a_0 == 1 || m2a_0 == 1 || m2b_0 == 1);
+         w2 = (w2 & 0x3F33FFFF) | m1a_0 << 30 | m2a_0 << 22 | m2b_0 << 18;
+      }
+   }
+   if (gen.cycle_type == CYCLE_TYPE_FILL)
+      w2 &= ~0x00000070; /* image read and Z crash the fill */
+   emit(w1, w2);
+   random_combine();
+}
+
+static void random_colors(void)
+{
+   emit(0x37000000, rand32());              /* fill */
+   emit(0x38000000, rand32());              /* fog */
+   emit(0x39000000, rand32());              /* blend */
+   emit(0x3A000000 | (rand() & 0xFF), rand32()); /* primitive */
+   emit(0x3B000000, rand32());              /* environment */
+   emit(0x2E000000, rand32());              /* primitive depth */
+}
+
+static void emit_tile(int index, int line, int tmem)
+{
+   emit(0x35000000 | (PIXEL_SIZE_16BIT << 19) | (line << 9) | tmem,
+         (index << 24) | (rand32() & 0x000FFFFF));
+}
+
+/* Loads 16-bit texels, at times from the images. */
+static void random_texture(void)
+{
+   const int width = range(4, 64);
+   const int rows = range(1, 32);
+   const int line = (width * 2 + 7) / 8;
+   uint32_t address;
+   int sl, tl;
+
+   switch (rand() % 4)
+   {
+      case 0:  address = gen.color + range(0, 0x4000) * 8; break;
+      case 1:  address = gen.z + range(0, 0x4000) * 8; break;
+      default: address = range(0, 0x1F000) * 8; break;
+   }
+   emit(0x3D000000 | (PIXEL_SIZE_16BIT << 19) | (width - 1), address);
+
+   sl = range(0, width - 1);
+   tl = range(0, rows - 1);
+   switch (rand() % 4)
+   {
+      case 0: /* load_block */
+         emit_tile(7, 0, 0);
+         emit(0x33000000 | (sl << 12) | tl,
+               (7 << 24) | (range(1, 1023) << 12) | (2048 + line - 1) / line);
+         break;
+      case 1: /* load_tlut */
+         emit_tile(6, 0, 0x100);
+         emit(0x30000000 | (sl << 14) | (tl << 2),
+               (6 << 24) | (range(sl, sl + 255) << 14) | (tl << 2));
+         break;
+      default: /* load_tile */
+         emit_tile(7, line, 0);
+         emit(0x34000000 | (sl << 14) | (tl << 2),
+               (7 << 24) | (range(sl, width - 1) << 14) | (range(tl, rows - 1) << 2));
+         break;
+   }
+   emit(0x27000000, 0); /* sync_load */
+   emit_tile(range(0, 1), line, 0);
+   emit(0x32000000 | (range(0, 15) << 12) | range(0, 15),
+         (rand32() & 0x07000000) | (range(16, 255) << 12) | range(16, 255));
+}
+
+static void edge(int32_t x, double slope)
+{
+   emit(x, (int32_t)(slope * 65536));
+}
+
+static void triangle(int kind, int size)
+{
+   double x[3], y[3], t, xm;
+   int32_t yh, ym, yl;
+   int i, j, right;
+
+   x[0] = range(-16, gen.width + 16);
+   y[0] = range(-16, 496);
+   for (i = 1; i < 3; i++)
+   {
+      x[i] = x[0] + range(-size, size) + rand() % 4 / 4.0;
+      y[i] = y[0] + range(-size, size) + rand() % 4 / 4.0;
+   }
+   for (i = 0; i < 3; i++)
+      for (j = i + 1; j < 3; j++)
+         if (y[j] < y[i])
+         {
+            t = y[i]; y[i] = y[j]; y[j] = t;
+            t = x[i]; x[i] = x[j]; x[j] = t;
+         }
+   if (y[2] - y[0] < 0.25)
+      y[2] = y[0] + 0.25;
+
+   yh = (int32_t)(y[0] * 4);
+   ym = (int32_t)(y[1] * 4);
+   yl = (int32_t)(y[2] * 4);
+   xm = x[0] + (x[2] - x[0]) * (y[1] - y[0]) / (y[2] - y[0]);
+   right = xm < x[1];
+
+   emit(((0x08 | kind) << 24) | (right << 23) | (rand() & 0x00070000) | (yl & 0x3FFF),
+         ((ym & 0x3FFF) << 16) | (yh & 0x3FFF));
+   edge((int32_t)(x[1] * 65536), y[2] > y[1] ? (x[2] - x[1]) / (y[2] - y[1]) : 0);
+   edge((int32_t)(x[0] * 65536), (x[2] - x[0]) / (y[2] - y[0]));
+   edge((int32_t)(x[0] * 65536), y[1] > y[0] ? (x[1] - x[0]) / (y[1] - y[0]) : 0);
+
+   if (kind & 4) /* shade */
+   {
+      emit(rand32() & 0x00FF00FF, rand32() & 0x00FF00FF);
+      emit(rand32() & 0x00030003, rand32() & 0x00030003);
+      for (i = 2; i < 8; i++)
+         emit(rand32() & 0x0001FFFF, rand32() & 0x0001FFFF);
+   }
+   if (kind & 2) /* texture */
+   {
+      emit(rand32() & 0x03FF03FF, (rand32() & 0x7FFF0000) | 0x40000000);
+      for (i = 1; i < 8; i++)
+         emit(rand32() & 0x0003FFFF, rand32() & 0x0000FFFF);
+   }
+   if (kind & 1) /* Z */
+   {
+      emit(rand32() & 0x7FFFFFFF, rand32() & 0x0003FFFF);
+      emit(rand32() & 0x0003FFFF, rand32() & 0x0003FFFF);
+   }
+}
+
+static void rectangle(int command, int size)
+{
+   const int xh = range(-4, gen.width + 4) * 4 + range(0, 3);
+   const int yh = range(-4, 484) * 4 + range(0, 3);
+   const int xl = xh + range(0, size * 4);
+   const int yl = yh + range(0, size * 4);
+
+   if (xh < 0 || yh < 0)
+      return;
+   emit((command << 24) | ((xl & 0xFFF) << 12) | (yl & 0xFFF),
+         (rand32() & 0x07000000) | ((xh & 0xFFF) << 12) | (yh & 0xFFF));
+   if (command != 0x36)
+      emit(rand32(), (range(-0x1000, 0x1000) << 16) | (range(-0x1000, 0x1000) & 0xFFFF));
+}
+
+static void primitives(int count)
+{
+   const int size = rand() % 4 ? 12 : 200;
+
+   while (count-- > 0)
+      switch (rand() % 6)
+      {
+         case 0:
+            rectangle(gen.cycle_type == CYCLE_TYPE_FILL ? 0x36 : 0x24, size);
+            break;
+         case 1:
+            rectangle(gen.cycle_type == CYCLE_TYPE_FILL ? 0x36 : 0x24 + (rand() & 1), size);
+            break;
+         default:
+            triangle(rand() & 7, size);
+            break;
+      }
+}
+
+static void random_frame(int length, int exact)
+{
+   emitted = 0;
+   memset(&gen, 0, sizeof(gen));
+   gen.exact = exact;
+   random_images();
+   random_colors();
+   random_texture();
+   random_modes();
+
+   while (emitted < (unsigned)length)
+      switch (rand() % 12)
+      {
+         case 0:  random_images(); break;
+         case 1:  random_texture(); break;
+         case 2:  random_colors(); break;
+         case 3:
+         case 4:  random_modes(); break;
+         case 5:  emit(0x26000000 + (rand() % 3 << 24), 0); break; /* syncs */
+         case 6:  if (rand() % 8 == 0) emit(0x29000000, 0); break; /* sync_full */
+         default: primitives(range(1, 30)); break;
+      }
+   emit(0x29000000, 0);
+}
+
+/* Sends the frame in random pieces, as the RSP would. */
+static void send(void)
+{
+   unsigned at = 0, piece;
+
+   while (at < emitted)
+   {
+      piece = 1 + rand() % 300;
+      if (piece > emitted - at)
+         piece = emitted - at;
+      dp_regs[0] = dp_regs[2] = LIST_ADDRESS + at * 8;
+      dp_regs[1] = LIST_ADDRESS + (at + piece) * 8;
+      process_RDP_list();
+      at += piece;
+   }
+}
+
+static uint64_t hash(void)
+{
+   const uint64_t* words = (const uint64_t*)ram;
+   const uint64_t* bits = (const uint64_t*)hidden_bits;
+   uint64_t h = 0;
+   unsigned i;
+
+   for (i = 0; i < LIST_ADDRESS / 8; i++)
+      h = (h ^ words[i]) * 0x100000001B3ull;
+   for (i = 0; i < LIST_ADDRESS / 16; i++)
+      h = (h ^ bits[i]) * 0x100000001B3ull;
+   return h;
+}
+
+static void start(unsigned workers)
+{
+   memcpy(ram, ram_start, RAM_SIZE);
+   angrylion_set_threads(workers);
+   angrylion_set_parallel_rdp(workers != 1);
+   rdp_init();
+   iseed = 1; /* the noise of what is drawn serially */
+   rdp_flush();
+}
+
+static void run_frame(unsigned frame, int exact)
+{
+   srand(frame + 1);
+   random_frame(frame % 8 == 7 ? 100000 : range(500, 20000), exact);
+   send();
+   rdp_flush();
+}
+
+/* Runs the frames with workers from first on, their hashes have to match
+ * those of the frames run with reference workers (1 for serial). */
+static int check_frames(int exact, unsigned reference, unsigned first)
+{
+   static uint64_t hashes[CHECK_FRAMES];
+   unsigned frame, workers;
+
+   start(reference);
+   for (frame = 0; frame < CHECK_FRAMES; frame++)
+   {
+      run_frame(frame, exact);
+      hashes[frame] = hash();
+   }
+   if (rdp_pipeline_crashed)
+   {
+      printf("the frames crash the RDP\n");
+      return 0;
+   }
+
+   for (workers = first; workers <= WORKERS_MAX; workers++)
+   {
+      start(workers);
+      if (rdp_workers != (int)workers)
+      {
+         printf("%u workers asked, %d started\n", workers, rdp_workers);
+         return 0;
+      }
+      for (frame = 0; frame < CHECK_FRAMES; frame++)
+      {
+         run_frame(frame, exact);
+         if (hash() != hashes[frame])
+         {
+            printf("%s frame %u differs on %u workers from %u\n",
+                  exact ? "exact" : "random", frame, workers, reference);
+            return 0;
+         }
+      }
+   }
+   return 1;
+}
+
+static int check(void)
+{
+   if (!check_frames(1, 1, 2) || !check_frames(0, 2, 3))
+      return 0;
+   printf("%u frames as serial and %u random frames ok\n", CHECK_FRAMES, CHECK_FRAMES);
+   return 1;
+}
+
+/* A 320x240 16-bit frame of textured, shaded and Z buffered triangles. */
+static void bench_frame(int count, int size)
+{
+   emitted = 0;
+   emit(0x3E000000, 0x480000);
+   emit_color_image(0x480000, PIXEL_SIZE_16BIT, 320);
+   emit_scissor(320 << 2, 240 << 2);
+   emit(0x2F300000, 0);
+   emit(0x37000000, 0xFFFCFFFC);
+   emit(0x36000000 | (319 << 14) | (239 << 2), 0);
+   emit(0x27000000, 0);
+   emit_color_image(0x100000, PIXEL_SIZE_16BIT, 320);
+
+   emit(0x3D000000 | (PIXEL_SIZE_16BIT << 19) | 31, 0x000000);
+   emit_tile(7, 8, 0);
+   emit(0x34000000, (7 << 24) | (31 << 14) | (31 << 2));
+   emit(0x27000000, 0);
+   emit(0x35000000 | (PIXEL_SIZE_16BIT << 19) | (8 << 9), (5 << 14) | (5 << 4));
+   emit(0x32000000, (31 << 14) | (31 << 2));
+
+   /* 1-cycle, bilinear, Z compare and update, texel 0 times shade */
+   emit(0x2F000000 | (CYCLE_TYPE_1 << 20) | 0x2000 | 0xC00 | (3 << 6) | (3 << 4),
+         0x00000030 | 0x8 | 0x200);
+   emit(0x3C000000 | (1 << 20) | (4 << 15) | (1 << 12) | (4 << 9) | (1 << 5) | 4,
+         (8u << 28) | (8 << 24) | (1 << 21) | (4 << 18) | (7 << 15) | (7 << 12)
+         | (7 << 9) | (7 << 6) | (7 << 3) | 7);
+
+   gen.width = 320;
+   while (count-- > 0)
+      triangle(7, size);
+   emit(0x29000000, 0);
+}
+
+static double bench(unsigned workers, int count, int size)
+{
+   double begin, time = 0;
+   unsigned frame;
+
+   start(workers);
+   for (frame = 0; frame < BENCH_FRAMES; frame++)
+   {
+      srand(frame + 1);
+      bench_frame(count, size);
+      begin = get_time();
+      send();
+      rdp_flush();
+      time += get_time() - begin;
+   }
+   return time * 1e3 / BENCH_FRAMES;
+}
+
+/* The frame time on SIM_WORKERS cores, estimated from one, and the tiles
+ * per binned primitive. */
+static double simulate(int count, int size, double *tiles)
+{
+   double total;
+
+   memset(&sim, 0, sizeof(sim));
+   sim.on = 1;
+   total = bench(SIM_WORKERS, count, size) * BENCH_FRAMES / 1e3;
+   sim.on = 0;
+   *tiles = sim.entries / (sim.primitives ? sim.primitives : 1);
+   return (total - sim.tasks + sim.makespan) * 1e3 / BENCH_FRAMES;
+}
+
+int main(void)
+{
+   static const int scenes[][2] = { { 4000, 8 }, { 100, 160 } };
+   static const char *names[] = { "4000 small triangles", "100 large triangles" };
+   unsigned i;
+
+   ram = (uint32_t*)calloc(1, RAM_SIZE);
+   ram_start = (uint32_t*)malloc(RAM_SIZE);
+   srand(1);
+   for (i = 0; i < RAM_SIZE / 4; i++)
+      ram_start[i] = rand32();
+
+   gfx_info.RDRAM = (uint8_t*)ram;
+   gfx_info.DMEM = (uint8_t*)calloc(1, 0x1000);
+   gfx_info.IMEM = (uint8_t*)calloc(1, 0x1000);
+   gfx_info.MI_INTR_REG = &mi_intr;
+   gfx_info.DPC_START_REG = &dp_regs[0];
+   gfx_info.DPC_END_REG = &dp_regs[1];
+   gfx_info.DPC_CURRENT_REG = &dp_regs[2];
+   gfx_info.DPC_STATUS_REG = &dp_regs[3];
+   gfx_info.CheckInterrupts = check_interrupts;
+
+   if (!check())
+      return 1;
+
+   printf("\n%-22s %12s %12s %12s %12s %6s\n", "",
+         "serial", "4 workers", "per core", "4 cores est", "tiles");
+   for (i = 0; i < 2; i++)
+   {
+      double serial = bench(1, scenes[i][0], scenes[i][1]);
+      double four = bench(4, scenes[i][0], scenes[i][1]);
+      double per_core = bench(0, scenes[i][0], scenes[i][1]);
+      double tiles;
+      double estimate = simulate(scenes[i][0], scenes[i][1], &tiles);
+
+      printf("%-22s %9.3f ms %9.3f ms %9.3f ms %9.3f ms %6.2f\n", names[i],
+            serial, four, per_core, estimate, tiles);
+   }
+   return 0;
+}
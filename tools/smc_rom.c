@@ -0,0 +1,324 @@
+/* smc_rom
+ * Writes a small test ROM whose code rewrites itself, for checking how the
+ * cached interpreter and the dynarec invalidate self-modifying code (see
+ * invalidate_code_word() in mupen64plus-core/src/r4300/cached_interp.c).
+ *
+ * The boot code in SP DMEM copies the program to 0x80001000 and jumps
+ * there. The program's hot loop:
+ *   - calls func_a, a function in the same page whose first instruction
+ *     is rewritten every 16 iterations, through kseg0 and kseg1 in turn,
+ *   - calls func_b, in the same page and never rewritten,
+ *   - runs an "addiu" at its own top that it rewrites every 64 iterations,
+ *     so the loop being executed is invalidated,
+ *   - bumps a data word kept in the code page,
+ *   - logs the running checksum of what it computed into the framebuffer.
+ * After LOOPS iterations it stores the checksum and spins.
+ *
+ * "make smc_check" runs the ROM with the pure interpreter, then checks the
+ * RDRAM and frame hashes of every frame with the cached interpreter and
+ * the dynarec against it (tools/bench.c -H and -C). With -v the dynarec
+ * logs its invalidation counters when it frees its blocks.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ROM_SIZE   (1024 * 1024)
+#define BOOT_ADDR  0xA4000040u
+#define PROG_ADDR  0x80001000u
+#define FB_ADDR    0x80100000u
+#define LOOPS      100000
+
+/* Registers */
+enum
+{
+   ZERO = 0, V0 = 2, A0 = 4, A1 = 5, A2 = 6,
+   T0 = 8, T1, T2, T3, T4, T5, T6, T7,
+   S0 = 16, S1, S2, S3, S4,
+   RA = 31
+};
+
+static uint32_t code[1024];
+static unsigned code_len;
+static uint32_t code_base;
+
+static uint32_t pc(void)
+{
+   return code_base + code_len * 4;
+}
+
+static void emit(uint32_t op)
+{
+   code[code_len++] = op;
+}
+
+static uint32_t op_i(unsigned op, unsigned rs, unsigned rt, uint32_t imm)
+{
+   return (op << 26) | (rs << 21) | (rt << 16) | (imm & 0xffff);
+}
+
+static uint32_t op_r(unsigned rs, unsigned rt, unsigned rd, unsigned sa, unsigned funct)
+{
+   return (rs << 21) | (rt << 16) | (rd << 11) | (sa << 6) | funct;
+}
+
+#define LUI(rt, imm)        emit(op_i(0x0f, 0, rt, imm))
+#define ORI(rt, rs, imm)    emit(op_i(0x0d, rs, rt, imm))
+#define ADDIU(rt, rs, imm)  emit(op_i(0x09, rs, rt, imm))
+#define ANDI(rt, rs, imm)   emit(op_i(0x0c, rs, rt, imm))
+#define LW(rt, off, rs)     emit(op_i(0x23, rs, rt, off))
+#define SW(rt, off, rs)     emit(op_i(0x2b, rs, rt, off))
+#define ADDU(rd, rs, rt)    emit(op_r(rs, rt, rd, 0, 0x21))
+#define OR(rd, rs, rt)      emit(op_r(rs, rt, rd, 0, 0x25))
+#define SLL(rd, rt, sa)     emit(op_r(0, rt, rd, sa, 0x00))
+#define JR(rs)              emit(op_r(rs, 0, 0, 0, 0x08))
+#define NOP()               emit(0)
+
+/* Branches and jumps to a label, resolved by fixup() */
+#define MAX_FIXUPS 64
+
+enum label
+{
+   L_COPY, L_LOOP, L_SKIP_A, L_KSEG0, L_SKIP_L, L_DONE, L_FUNC_A, L_FUNC_B,
+   L_DATA, L_PATCH, NUM_LABELS
+};
+
+static uint32_t labels[NUM_LABELS];
+static struct { unsigned at; enum label to; } fixups[MAX_FIXUPS];
+static unsigned num_fixups;
+
+static void label(enum label l)
+{
+   labels[l] = pc();
+}
+
+static void branch(unsigned op, unsigned rs, unsigned rt, enum label to)
+{
+   fixups[num_fixups].at   = code_len;
+   fixups[num_fixups++].to = to;
+   emit(op_i(op, rs, rt, 0));
+}
+
+static void jump(unsigned op, enum label to)
+{
+   fixups[num_fixups].at   = code_len;
+   fixups[num_fixups++].to = to;
+   emit(op << 26);
+}
+
+#define BEQ(rs, rt, l)  branch(0x04, rs, rt, l)
+#define BNE(rs, rt, l)  branch(0x05, rs, rt, l)
+#define J(l)            jump(0x02, l)
+#define JAL(l)          jump(0x03, l)
+
+static void fixup(void)
+{
+   unsigned i;
+
+   for (i = 0; i < num_fixups; i++)
+   {
+      uint32_t *op    = &code[fixups[i].at];
+      uint32_t target = labels[fixups[i].to];
+
+      if ((*op >> 26) == 0x02 || (*op >> 26) == 0x03)
+         *op |= (target & 0x0fffffff) >> 2;
+      else
+         *op |= ((target - (code_base + fixups[i].at * 4 + 4)) >> 2) & 0xffff;
+   }
+   num_fixups = 0;
+}
+
+/* Offset of a label from the start of the program, for s1/s2 relative
+ * accesses. */
+static uint32_t prog_off(enum label l)
+{
+   return labels[l] - PROG_ADDR;
+}
+
+static void program(void)
+{
+   code_base  = PROG_ADDR;
+   code_len   = 0;
+   num_fixups = 0;
+
+   LUI(S1, PROG_ADDR >> 16);
+   ORI(S1, S1, PROG_ADDR & 0xffff);
+   LUI(S2, (PROG_ADDR | 0x20000000) >> 16);
+   ORI(S2, S2, PROG_ADDR & 0xffff);
+   LUI(S3, FB_ADDR >> 16);
+   LUI(S4, LOOPS >> 16);
+   ORI(S4, S4, LOOPS & 0xffff);
+   ADDIU(S0, ZERO, 0);
+   ADDIU(T6, ZERO, 0);
+   ADDIU(T7, ZERO, 0);
+
+   label(L_LOOP);
+   label(L_PATCH);
+   ADDIU(T7, T7, 1);             /* rewritten below */
+   JAL(L_FUNC_A);
+   NOP();
+   ADDU(T6, T6, V0);
+   JAL(L_FUNC_B);
+   NOP();
+   ADDU(T6, T6, V0);
+   ADDU(T6, T6, T7);
+
+   LW(T0, prog_off(L_DATA), S1);
+   ADDIU(T0, T0, 1);
+   SW(T0, prog_off(L_DATA), S1);
+
+   ANDI(T1, S0, 1023);
+   SLL(T1, T1, 2);
+   ADDU(T1, T1, S3);
+   SW(T6, 0, T1);
+
+   /* func_a: "addiu v0, zero, n", through kseg0 and kseg1 in turn */
+   ANDI(T1, S0, 15);
+   BNE(T1, ZERO, L_SKIP_A);
+   NOP();
+   ANDI(T2, T0, 0x7fff);
+   LUI(T3, 0x2402);
+   OR(T2, T2, T3);
+   ANDI(T1, S0, 16);
+   BEQ(T1, ZERO, L_KSEG0);
+   NOP();
+   SW(T2, prog_off(L_FUNC_A), S2);
+   J(L_SKIP_A);
+   NOP();
+   label(L_KSEG0);
+   SW(T2, prog_off(L_FUNC_A), S1);
+   label(L_SKIP_A);
+
+   /* The loop's own "addiu t7, t7, n" */
+   ANDI(T1, S0, 63);
+   BNE(T1, ZERO, L_SKIP_L);
+   NOP();
+   ANDI(T2, S0, 0x7fc0);
+   LUI(T3, 0x25ef);
+   OR(T2, T2, T3);
+   SW(T2, prog_off(L_PATCH), S1);
+   label(L_SKIP_L);
+
+   ADDIU(S0, S0, 1);
+   BNE(S0, S4, L_LOOP);
+   NOP();
+
+   SW(T6, 0x1000, S3);
+   label(L_DONE);
+   J(L_DONE);
+   NOP();
+
+   label(L_FUNC_A);
+   ADDIU(V0, ZERO, 1);
+   JR(RA);
+   NOP();
+
+   label(L_FUNC_B);
+   ADDIU(V0, S0, 3);
+   JR(RA);
+   NOP();
+
+   label(L_DATA);
+   emit(0);
+}
+
+/* Runs from SP DMEM: NTSC VI setup, then copies the program, which
+ * follows it at prog_at, and jumps to it. */
+static void boot(uint32_t prog_at, unsigned prog_len)
+{
+   static const uint32_t vi[14] = {
+      0x0000320e, FB_ADDR & 0x00ffffff, 320, 2, 0, 0x03e52239, 0x20d,
+      0x0c15, 0x0c150c15, 0x006c02ec, 0x002501ff, 0x000e0204, 0x200, 0x400
+   };
+   unsigned i;
+
+   code_base  = BOOT_ADDR;
+   code_len   = 0;
+   num_fixups = 0;
+
+   LUI(T0, 0xa440);
+   for (i = 0; i < 14; i++)
+   {
+      LUI(T1, vi[i] >> 16);
+      ORI(T1, T1, vi[i] & 0xffff);
+      SW(T1, i * 4, T0);
+   }
+
+   LUI(A0, prog_at >> 16);
+   ORI(A0, A0, prog_at & 0xffff);
+   LUI(A1, PROG_ADDR >> 16);
+   ORI(A1, A1, PROG_ADDR & 0xffff);
+   ADDIU(A2, ZERO, prog_len);
+   label(L_COPY);
+   LW(T0, 0, A0);
+   ADDIU(A0, A0, 4);
+   SW(T0, 0, A1);
+   ADDIU(A2, A2, -1);
+   BNE(A2, ZERO, L_COPY);
+   ADDIU(A1, A1, 4);
+
+   LUI(S1, PROG_ADDR >> 16);
+   ORI(S1, S1, PROG_ADDR & 0xffff);
+   JR(S1);
+   NOP();
+   fixup();
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+   p[0] = v >> 24;
+   p[1] = v >> 16;
+   p[2] = v >> 8;
+   p[3] = v;
+}
+
+int main(int argc, char *argv[])
+{
+   static uint8_t rom[ROM_SIZE];
+   uint32_t prog[1024];
+   unsigned prog_len, boot_len, i;
+   FILE *fp;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "usage: %s <rom>\n", argv[0]);
+      return 1;
+   }
+
+   /* Both are assembled twice, the first pass finding the labels */
+   program();
+   program();
+   fixup();
+   memcpy(prog, code, code_len * 4);
+   prog_len = code_len;
+
+   boot(0, prog_len);
+   boot_len = code_len;
+   boot(BOOT_ADDR + boot_len * 4, prog_len);
+   if (0x40 + (boot_len + prog_len) * 4 > 0x1000)
+   {
+      fprintf(stderr, "smc_rom: the code doesn't fit in SP DMEM\n");
+      return 1;
+   }
+   memcpy(code + code_len, prog, prog_len * 4);
+   code_len += prog_len;
+
+   put32(rom + 0x00, 0x80371240);
+   put32(rom + 0x04, 0x0000000f);
+   put32(rom + 0x08, 0x80000400);
+   put32(rom + 0x0c, 0x0000144b);
+   memcpy(rom + 0x20, "SMC TEST ROM        ", 20);
+   rom[0x3b] = 'N';
+   rom[0x3e] = 'E';
+   for (i = 0; i < code_len; i++)
+      put32(rom + 0x40 + i * 4, code[i]);
+
+   fp = fopen(argv[1], "wb");
+   if (!fp || fwrite(rom, 1, sizeof(rom), fp) != sizeof(rom))
+   {
+      fprintf(stderr, "smc_rom: failed to write '%s'\n", argv[1]);
+      return 1;
+   }
+   fclose(fp);
+   return 0;
+}
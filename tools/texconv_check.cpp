@@ -0,0 +1,387 @@
+/* texconv_check
+ * Bit-exactness and speed check for the texel row decoders in
+ * Graphics/texconv.c, through the renderers that call them.
+ *
+ * Rice's 32-bit converters (gles2rice/src/ConvertImage.cpp) are run over
+ * a fixed set of textures: every row width up to MAX_WIDTH texels, every
+ * left edge below 8, swapped and unswapped rows, the conker swap hack,
+ * two pitches and two source alignments, with random texels and palettes.
+ * The surfaces, and what was written past the rows, are hashed per
+ * converter and width and compared with texconv_check_golden.h. Those
+ * hashes were written by this program linked with ConvertImage.cpp as it
+ * was before its converters went through texconv.c, one texel at a time:
+ *
+ *    make texconv_check TEXCONV_CHECK_RICE=<that ConvertImage.o>
+ *    ./parallel_n64_texconv_check -g > tools/texconv_check_golden.h
+ *
+ * GLideN64 decodes a row with texconv.c when its per-texel getter would
+ * read it in order. Those rows are compared with the texel conversions of
+ * its convert.h, read the way the getters in Textures.cpp read them.
+ *
+ * Then the time per texel of the Rice converters is printed for a 64x64
+ * texture; link the old ConvertImage.o as above for the one to compare
+ * with.
+ *
+ * Built with "make texconv_check", with the core's compiler flags.
+ * Exits non-zero on the first mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../gles2rice/src/Config.h"
+#include "../gles2rice/src/ConvertImage.h"
+#include "../gles2rice/src/RenderBase.h"
+#include "../gles2rice/src/RSP_Parser.h"
+#include "../Graphics/RDP/gDP_state.h"
+#include "../Graphics/texconv.h"
+#include "../mupen64plus-video-gliden64/src/convert.h"
+
+#define MAX_WIDTH     70
+#define ROWS          8
+#define SURFACE_PITCH ((MAX_WIDTH + 8) * 4)
+#define SOURCE_SIZE   ((ROWS + 1) * 264 + 256)
+#define GLIDEN64_MAX  130
+#define BENCH_SIZE    64
+#define BENCH_RUNS    20000
+
+/* What ConvertImage.cpp links against, outside of the converters. */
+GlobalOptions   options;
+RDP_Options     gRDP;
+TmemType        g_Tmem;
+struct gDPInfo  gDP;
+bool            conkerSwapHack;
+
+/* A texture backed by a plain surface, with room past every row and
+ * below the last one to catch writes out of the texture. */
+static uint8_t surface[SURFACE_PITCH * (ROWS + 1)];
+
+CTexture::CTexture(uint32_t dwWidth, uint32_t dwHeight, TextureUsage usage) :
+   m_dwWidth(dwWidth), m_dwHeight(dwHeight),
+   m_dwCreatedTextureWidth(dwWidth), m_dwCreatedTextureHeight(dwHeight),
+   m_fXScale(1.0f), m_fYScale(1.0f),
+   m_bScaledS(false), m_bScaledT(false), m_bClampedS(false), m_bClampedT(false),
+   m_bIsEnhancedTexture(false), m_Usage(usage),
+   m_pTexture(NULL), m_dwTextureFmt(TEXTURE_FMT_A8R8G8B8)
+{
+}
+
+CTexture::~CTexture() { }
+void CTexture::ScaleImageToSurface(bool scaleS, bool scaleT) { }
+void CTexture::ClampImageToSurfaceS() { }
+void CTexture::ClampImageToSurfaceT() { }
+void CTexture::RestoreAlphaChannel(void) { }
+
+class CheckTexture : public CTexture
+{
+public:
+   CheckTexture(uint32_t dwWidth, uint32_t dwHeight) :
+      CTexture(dwWidth, dwHeight, AS_NORMAL) { }
+
+   virtual bool StartUpdate(DrawInfo *di)
+   {
+      di->dwWidth         = (unsigned short)m_dwWidth;
+      di->dwHeight        = (unsigned short)m_dwHeight;
+      di->dwCreatedWidth  = (unsigned short)m_dwCreatedTextureWidth;
+      di->dwCreatedHeight = (unsigned short)m_dwCreatedTextureHeight;
+      di->lPitch          = SURFACE_PITCH;
+      di->lpSurface       = surface;
+      return true;
+   }
+
+   virtual void EndUpdate(DrawInfo *di) { }
+};
+
+struct converter
+{
+   const char *name;
+   ConvertFunction convert;
+   uint32_t format;
+   uint32_t size;
+   uint32_t tlut;
+};
+
+static const struct converter converters[] =
+{
+   { "RGBA16",           ConvertRGBA16,     G_IM_FMT_RGBA, G_IM_SIZ_16b, TLUT_FMT_NONE    },
+   { "IA4",              ConvertIA4,        G_IM_FMT_IA,   G_IM_SIZ_4b,  TLUT_FMT_NONE    },
+   { "IA8",              ConvertIA8,        G_IM_FMT_IA,   G_IM_SIZ_8b,  TLUT_FMT_NONE    },
+   { "IA16",             ConvertIA16,       G_IM_FMT_IA,   G_IM_SIZ_16b, TLUT_FMT_NONE    },
+   { "I4",               ConvertI4,         G_IM_FMT_I,    G_IM_SIZ_4b,  TLUT_FMT_NONE    },
+   { "I8",               ConvertI8,         G_IM_FMT_I,    G_IM_SIZ_8b,  TLUT_FMT_NONE    },
+   { "CI4/RGBA16",       ConvertCI4,        G_IM_FMT_CI,   G_IM_SIZ_4b,  TLUT_FMT_RGBA16  },
+   { "CI4/IA16",         ConvertCI4,        G_IM_FMT_CI,   G_IM_SIZ_4b,  TLUT_FMT_IA16    },
+   { "CI8/RGBA16",       ConvertCI8,        G_IM_FMT_CI,   G_IM_SIZ_8b,  TLUT_FMT_RGBA16  },
+   { "CI8/IA16",         ConvertCI8,        G_IM_FMT_CI,   G_IM_SIZ_8b,  TLUT_FMT_IA16    },
+   /* The palettes made opaque, as the TLUT-less callers ask for */
+   { "CI4/RGBA16 opaque", ConvertCI4_RGBA16, G_IM_FMT_CI,  G_IM_SIZ_4b,  TLUT_FMT_NONE    },
+   { "CI4/IA16 opaque",  ConvertCI4_IA16,   G_IM_FMT_CI,   G_IM_SIZ_4b,  TLUT_FMT_UNKNOWN },
+   { "CI8/RGBA16 opaque", ConvertCI8_RGBA16, G_IM_FMT_CI,  G_IM_SIZ_8b,  TLUT_FMT_NONE    },
+   { "CI8/IA16 opaque",  ConvertCI8_IA16,   G_IM_FMT_CI,   G_IM_SIZ_8b,  TLUT_FMT_UNKNOWN },
+};
+
+#define NUM_CONVERTERS (sizeof(converters) / sizeof(converters[0]))
+
+#include "texconv_check_golden.h"
+
+/* 16 byte aligned, for the source alignments below. */
+static uint64_t source64[(SOURCE_SIZE + 16) / 8 + 2];
+static uint64_t palette64[512 / 8];
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+   rng_state = rng_state * 1103515245u + 12345u;
+   return rng_state >> 8;
+}
+
+static double get_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+   const uint8_t *p = (const uint8_t*)data;
+   size_t i;
+
+   for (i = 0; i < size; i++)
+      hash = (hash ^ p[i]) * UINT64_C(0x100000001b3);
+   return hash;
+}
+
+static uint64_t hash_width(const struct converter *conv, uint32_t width)
+{
+   uint64_t hash = UINT64_C(0xcbf29ce484222325);
+   unsigned variant;
+
+   for (variant = 0; variant < 64; variant++)
+   {
+      CheckTexture texture(width, ROWS);
+      TxtrInfo tinfo = TxtrInfo();
+      uint8_t *source = (uint8_t*)source64 + ((variant & 32) ? 4 : 0);
+
+      tinfo.Format           = conv->format;
+      tinfo.Size             = conv->size;
+      tinfo.TLutFmt          = conv->tlut;
+      tinfo.PalAddress       = (uint8_t*)palette64;
+      tinfo.pPhysicalAddress = source;
+      tinfo.WidthToCreate    = width;
+      tinfo.HeightToCreate   = ROWS;
+      tinfo.WidthToLoad      = width;
+      tinfo.HeightToLoad     = ROWS;
+      tinfo.LeftToLoad       = variant & 7;
+      tinfo.TopToLoad        = variant & 1;
+      tinfo.Pitch            = (variant & 16) ? 136 : 264;
+      tinfo.bSwapped         = (variant & 8) != 0;
+      tinfo.tileNo           = -1;
+      conkerSwapHack         = (variant & 2) != 0;
+
+      memset(surface, 0xCD, sizeof(surface));
+      conv->convert(&texture, tinfo);
+
+      hash = hash_bytes(hash, surface, sizeof(surface));
+      hash = hash_bytes(hash, &conkerSwapHack, sizeof(conkerSwapHack));
+   }
+   return hash;
+}
+
+static void generate(void)
+{
+   unsigned c, w;
+
+   printf("/* Hashes of Rice's converters before texconv.c, written by\n"
+          " * \"texconv_check -g\", see texconv_check.cpp. */\n"
+          "static const uint64_t golden[][MAX_WIDTH] =\n{\n");
+   for (c = 0; c < NUM_CONVERTERS; c++)
+   {
+      printf("   /* %s */\n   {", converters[c].name);
+      for (w = 1; w <= MAX_WIDTH; w++)
+         printf("%s UINT64_C(0x%016llx),", (w - 1) % 3 ? "" : "\n     ",
+               (unsigned long long)hash_width(&converters[c], w));
+      printf("\n   },\n");
+   }
+   printf("};\n");
+}
+
+static int check_rice(void)
+{
+   unsigned c, w;
+
+   if (sizeof(golden) / sizeof(golden[0]) != NUM_CONVERTERS)
+   {
+      printf("texconv_check_golden.h doesn't match the converters\n");
+      return 0;
+   }
+
+   for (c = 0; c < NUM_CONVERTERS; c++)
+   {
+      for (w = 1; w <= MAX_WIDTH; w++)
+         if (hash_width(&converters[c], w) != golden[c][w - 1])
+         {
+            printf("%-18s mismatch, width %u\n", converters[c].name, w);
+            return 0;
+         }
+      printf("%-18s ok\n", converters[c].name);
+   }
+   return 1;
+}
+
+enum gliden64_getter
+{
+   GET_I4 = 0,
+   GET_I8,
+   GET_IA44,
+   GET_IA88,
+   GET_RGBA5551,
+   GET_COUNT
+};
+
+static const char *gliden64_names[GET_COUNT] =
+{
+   "I4", "I8", "IA44", "IA88", "RGBA5551"
+};
+
+/* Texel x of a row, as GetI4_RGBA8888() and friends read it. */
+static uint32_t gliden64_texel(enum gliden64_getter getter,
+      const uint64_t *src, uint16_t x, uint16_t i)
+{
+   const uint8_t *src8   = (const uint8_t*)src;
+   const uint16_t *src16 = (const uint16_t*)src;
+   uint8_t color4B;
+
+   switch (getter)
+   {
+      case GET_I4:
+         color4B = src8[(x >> 1) ^ (i << 1)];
+         return I4_RGBA8888((x & 1) ? (color4B & 0x0F) : (color4B >> 4));
+      case GET_I8:
+         return I8_RGBA8888(src8[x ^ (i << 1)]);
+      case GET_IA44:
+         return IA44_RGBA8888(src8[x ^ (i << 1)]);
+      case GET_IA88:
+         return IA88_RGBA8888(src16[x ^ i]);
+      default:
+         break;
+   }
+   return RGBA5551_RGBA8888(src16[x ^ i]);
+}
+
+/* The row decode of _convertRow() in Textures.cpp. */
+static void gliden64_row(enum gliden64_getter getter, uint32_t *dst,
+      const uint64_t *src, uint16_t i, uint16_t width)
+{
+   const uint8_t *src8   = (const uint8_t*)src;
+   const unsigned fiddle = i << 1;
+
+   switch (getter)
+   {
+      case GET_I4:   texconv_i4(dst, src8, 0, fiddle, width); break;
+      case GET_I8:   texconv_i8(dst, src8, 0, fiddle, width); break;
+      case GET_IA44: texconv_ia8(dst, src8, 0, fiddle, width); break;
+      case GET_IA88: texconv_ia16(dst, src8, 0, fiddle | 1, width); break;
+      default:
+         texconv_rgba16(dst, src8, 0, fiddle | 1, width, TEXCONV_ABGR | TEXCONV_ROUND);
+         break;
+   }
+}
+
+static int check_gliden64(void)
+{
+   uint32_t dst[GLIDEN64_MAX + 1];
+   unsigned g, i, width, x;
+
+   for (g = 0; g < GET_COUNT; g++)
+   {
+      for (i = 0; i < 4; i += 2)
+         for (width = 1; width <= GLIDEN64_MAX; width++)
+         {
+            dst[width] = 0xDEADBEEF;
+            gliden64_row((enum gliden64_getter)g, dst, source64, i, width);
+
+            for (x = 0; x < width; x++)
+            {
+               uint32_t want = gliden64_texel((enum gliden64_getter)g, source64, x, i);
+               if (dst[x] != want)
+               {
+                  printf("GLideN64 %s: mismatch, i %u width %u texel %u: %08x, expected %08x\n",
+                        gliden64_names[g], i, width, x, (unsigned)dst[x], (unsigned)want);
+                  return 0;
+               }
+            }
+            if (dst[width] != 0xDEADBEEF)
+            {
+               printf("GLideN64 %s: wrote past the row, i %u width %u\n",
+                     gliden64_names[g], i, width);
+               return 0;
+            }
+         }
+      printf("GLideN64 %-9s ok\n", gliden64_names[g]);
+   }
+   return 1;
+}
+
+static void bench(const struct converter *conv)
+{
+   CheckTexture texture(BENCH_SIZE, ROWS);
+   TxtrInfo tinfo = TxtrInfo();
+   unsigned run;
+   double start, elapsed;
+
+   tinfo.Format           = conv->format;
+   tinfo.Size             = conv->size;
+   tinfo.TLutFmt          = conv->tlut;
+   tinfo.PalAddress       = (uint8_t*)palette64;
+   tinfo.pPhysicalAddress = source64;
+   tinfo.WidthToLoad      = BENCH_SIZE;
+   tinfo.HeightToLoad     = ROWS;
+   tinfo.Pitch            = 264;
+   tinfo.bSwapped         = true;
+   tinfo.tileNo           = -1;
+
+   /* ROWS rows at a time, as many times as a 64x64 texture takes */
+   start = get_time();
+   for (run = 0; run < BENCH_RUNS * (BENCH_SIZE / ROWS); run++)
+      conv->convert(&texture, tinfo);
+   elapsed = get_time() - start;
+
+   printf("%-18s %10.2f\n", conv->name,
+         elapsed * 1e9 / ((double)BENCH_RUNS * BENCH_SIZE * BENCH_SIZE));
+}
+
+int main(int argc, char **argv)
+{
+   unsigned k;
+
+   for (k = 0; k < sizeof(source64); k++)
+      ((uint8_t*)source64)[k] = (uint8_t)rng();
+   for (k = 0; k < sizeof(palette64); k++)
+      ((uint8_t*)palette64)[k] = (uint8_t)rng();
+
+   if (argc > 1 && !strcmp(argv[1], "-g"))
+   {
+      generate();
+      return 0;
+   }
+
+#if defined(__SSSE3__)
+   printf("texconv: SSSE3\n");
+#elif defined(__SSE2__) || defined(_M_X64)
+   printf("texconv: SSE2\n");
+#elif defined(__ARM_NEON__) && defined(HAVE_NEON)
+   printf("texconv: NEON\n");
+#else
+   printf("texconv: C\n");
+#endif
+
+   if (!check_rice() || !check_gliden64())
+      return 1;
+
+   printf("\n%-18s %10s\n", "converter", "ns/texel");
+   for (k = 0; k < NUM_CONVERTERS; k++)
+      bench(&converters[k]);
+   return 0;
+}
@@ -0,0 +1,383 @@
+/* Hashes of Rice's converters before texconv.c, written by
+ * "texconv_check -g", see texconv_check.cpp. */
+static const uint64_t golden[][MAX_WIDTH] =
+{
+   /* RGBA16 */
+   {
+      UINT64_C(0xaaa9b827681407c5), UINT64_C(0xf106937badeea5fe), UINT64_C(0xcd087949a7e17207),
+      UINT64_C(0xd6304afe85c9c709), UINT64_C(0x12f2d7e7c4f69ff1), UINT64_C(0x64a23a1b4a6304b0),
+      UINT64_C(0x1feb5e47380e4888), UINT64_C(0x100818a1ea76db03), UINT64_C(0xc2f976371c19c463),
+      UINT64_C(0x22933131c0d57144), UINT64_C(0x9655f436c24f4f65), UINT64_C(0xc3506efb09a0a5df),
+      UINT64_C(0xce7ddc062b804b33), UINT64_C(0x6f99e5e27ce616b5), UINT64_C(0xb0d926fca005b094),
+      UINT64_C(0x4ee227c1e158727d), UINT64_C(0x70f0a5a847af3b65), UINT64_C(0xd33c8c0135044746),
+      UINT64_C(0x723e590a609b7a4d), UINT64_C(0x7bf194474a36c7b9), UINT64_C(0x460f355577dfb9dd),
+      UINT64_C(0xd3e8cabe547da83d), UINT64_C(0xed73cc77734af179), UINT64_C(0xb71453f4a701b8c1),
+      UINT64_C(0xe16de9c7cf5a4fb5), UINT64_C(0x025d391ada7a403f), UINT64_C(0xc2e15ed83151b9ac),
+      UINT64_C(0x0b4ffb0e40aea22f), UINT64_C(0xd2b73cf308f84b0f), UINT64_C(0x32f0775faaa1200e),
+      UINT64_C(0x220dff97371014e8), UINT64_C(0xbbb9ec79baa45e2c), UINT64_C(0xaac94a8d073fcad4),
+      UINT64_C(0x696cb101b0146acc), UINT64_C(0x1c531a82caaa8cc2), UINT64_C(0x646f4432f847f465),
+      UINT64_C(0xb9066bc239651235), UINT64_C(0x70c2e70993c6b4b9), UINT64_C(0x2f43ac348dff1614),
+      UINT64_C(0xaf5318617d2ca335), UINT64_C(0xef9a2793336264f9), UINT64_C(0x865fd82840c8bb9d),
+      UINT64_C(0x8d81abda55487f3c), UINT64_C(0x1e041d8e9eb5c47d), UINT64_C(0xb8f0e657897de8c9),
+      UINT64_C(0x9f5de6c721850984), UINT64_C(0x2ced7223f80d516d), UINT64_C(0x6ba845f851e22596),
+      UINT64_C(0x1f21c5b86f291966), UINT64_C(0x11d02d4b95bfa551), UINT64_C(0x657a41fc4f1e9604),
+      UINT64_C(0x7cd684b0a1ea90d9), UINT64_C(0x01e2911edf764941), UINT64_C(0x0f7d9e1cc87d2611),
+      UINT64_C(0x739a0ab990987346), UINT64_C(0x3a8396f132acdbc3), UINT64_C(0x8d6fc29b864ae883),
+      UINT64_C(0xfb99ac709d993c72), UINT64_C(0xf4949745f79981e0), UINT64_C(0xd91c5370feb7c802),
+      UINT64_C(0x029d5652eb37026a), UINT64_C(0x90695c8ddcc621c0), UINT64_C(0xb8bd03256d2b09e0),
+      UINT64_C(0x6f5060fa1b1ce19e), UINT64_C(0x7a84ba7c96fca40a), UINT64_C(0x867ff917332ddd82),
+      UINT64_C(0xc84b8773ed70319d), UINT64_C(0xf1467a9e4db38629), UINT64_C(0xc1e1cf21ac1bac9d),
+      UINT64_C(0x89bc40515c17e52b),
+   },
+   /* IA4 */
+   {
+      UINT64_C(0xfe9d80715194838a), UINT64_C(0xd7c4976c99268ce9), UINT64_C(0xe0f14c5dd0275f69),
+      UINT64_C(0xe0f14c5dd0275f69), UINT64_C(0x45088dc20f642e25), UINT64_C(0x45088dc20f642e25),
+      UINT64_C(0x3ae34a45b1e2e055), UINT64_C(0x3ae34a45b1e2e055), UINT64_C(0xe7dcbca4631ee935),
+      UINT64_C(0xe7dcbca4631ee935), UINT64_C(0x3ae16355cd837f5b), UINT64_C(0x3ae16355cd837f5b),
+      UINT64_C(0xe4eb64233bd5b2be), UINT64_C(0xe4eb64233bd5b2be), UINT64_C(0x13a83d24fc4b9cb6),
+      UINT64_C(0x13a83d24fc4b9cb6), UINT64_C(0xae4dd13e68a2f24a), UINT64_C(0xae4dd13e68a2f24a),
+      UINT64_C(0xbc00f5ac6b90bc0a), UINT64_C(0xbc00f5ac6b90bc0a), UINT64_C(0xe1927cf54ff8b6f6),
+      UINT64_C(0xe1927cf54ff8b6f6), UINT64_C(0xc58ebb334900b85a), UINT64_C(0xc58ebb334900b85a),
+      UINT64_C(0x8d0f3fdae74c9c3e), UINT64_C(0x8d0f3fdae74c9c3e), UINT64_C(0xc2659422bca66b2b),
+      UINT64_C(0xc2659422bca66b2b), UINT64_C(0xf2248b6bfa78d32c), UINT64_C(0xf2248b6bfa78d32c),
+      UINT64_C(0xcdf12cded197586c), UINT64_C(0xcdf12cded197586c), UINT64_C(0x672fe8b160112c93),
+      UINT64_C(0x672fe8b160112c93), UINT64_C(0xa43a2dc0be7e2bf8), UINT64_C(0xa43a2dc0be7e2bf8),
+      UINT64_C(0x4a62238c7cfb4c9b), UINT64_C(0x4a62238c7cfb4c9b), UINT64_C(0xac662393b779fc20),
+      UINT64_C(0xac662393b779fc20), UINT64_C(0xa8326d5f183cd5af), UINT64_C(0xa8326d5f183cd5af),
+      UINT64_C(0x75efde40f82d4e1f), UINT64_C(0x75efde40f82d4e1f), UINT64_C(0x94e860fb7c66ef87),
+      UINT64_C(0x94e860fb7c66ef87), UINT64_C(0xaf1e37d262cb2eb6), UINT64_C(0xaf1e37d262cb2eb6),
+      UINT64_C(0x9cf605b6a453e912), UINT64_C(0x9cf605b6a453e912), UINT64_C(0x0ebb04b6423d122e),
+      UINT64_C(0x0ebb04b6423d122e), UINT64_C(0x708d699e6e46fe6e), UINT64_C(0x708d699e6e46fe6e),
+      UINT64_C(0x18b5d9ab14101966), UINT64_C(0x18b5d9ab14101966), UINT64_C(0x44fc8765a2b3f872),
+      UINT64_C(0x44fc8765a2b3f872), UINT64_C(0x2981ef7b4e60b1b0), UINT64_C(0x2981ef7b4e60b1b0),
+      UINT64_C(0xc4590fd368201cd3), UINT64_C(0xc4590fd368201cd3), UINT64_C(0x6cb6c67acb82f877),
+      UINT64_C(0x6cb6c67acb82f877), UINT64_C(0xd2deda60f6eb5285), UINT64_C(0xd2deda60f6eb5285),
+      UINT64_C(0x9f693e5653a5633b), UINT64_C(0x9f693e5653a5633b), UINT64_C(0xe433f526d7141a45),
+      UINT64_C(0xe433f526d7141a45),
+   },
+   /* IA8 */
+   {
+      UINT64_C(0x2609698a70b51291), UINT64_C(0xc891ae9aa98f5196), UINT64_C(0xff48f0519be8dd3e),
+      UINT64_C(0x4cae76d3cf55740b), UINT64_C(0x13b9dbdae0e16f3b), UINT64_C(0x794c1a69c0e1d0ce),
+      UINT64_C(0x1f8656c824aacb7e), UINT64_C(0xe38f2ef2c2d123d1), UINT64_C(0x8a13e335bb0bd9e9),
+      UINT64_C(0x147ff63cbb5c2517), UINT64_C(0x5fa9e4422876bcdd), UINT64_C(0x97581efcccc2b2c5),
+      UINT64_C(0xb410f4341a91a706), UINT64_C(0x84e5b7400afee385), UINT64_C(0xbb8793522d832c88),
+      UINT64_C(0x7df1719c249bd625), UINT64_C(0x903853c6be4aa209), UINT64_C(0x87817d04d0d0385e),
+      UINT64_C(0x5c41c2539a2cf7f6), UINT64_C(0xc12e8e983052ec21), UINT64_C(0x8db7ebdb02ccf9b0),
+      UINT64_C(0xba352141d8907ca1), UINT64_C(0x025ff2d0c6a6df00), UINT64_C(0x3c58eb6c2c0c2369),
+      UINT64_C(0x117a59779d0ffcbd), UINT64_C(0x2be4abb1c0c9a8b1), UINT64_C(0xac45d9901f6c4031),
+      UINT64_C(0x9462d0d5bed8a1ab), UINT64_C(0x12bb0c87c3b67da7), UINT64_C(0xb20891ae5f6d8d83),
+      UINT64_C(0xb96d6f774660ce9f), UINT64_C(0x6b8a7ae2639b0859), UINT64_C(0x98c099d1f022485d),
+      UINT64_C(0x0eb57811f0c838c4), UINT64_C(0x4785ab513bda65e1), UINT64_C(0xdb44fffac066fcdd),
+      UINT64_C(0xc2e36e2490842cb2), UINT64_C(0x704a28edb0d55e86), UINT64_C(0x068f7f0d5b1f71b0),
+      UINT64_C(0x75433aea8a9be10d), UINT64_C(0xcb9453f10c83aa3d), UINT64_C(0x591e534f46ff4294),
+      UINT64_C(0x715add4a4dd2601e), UINT64_C(0x8d65058d5754a68b), UINT64_C(0x4f307d4f37a7c3e4),
+      UINT64_C(0xaf000ef118bec419), UINT64_C(0x32510e5521486f80), UINT64_C(0x70c2231f4d84911d),
+      UINT64_C(0x4272c17603b8f431), UINT64_C(0x04db63e4ede0f67e), UINT64_C(0xc67781e217cac164),
+      UINT64_C(0xff736bcb08e96f64), UINT64_C(0x9b7c93c0f5701c8c), UINT64_C(0xce70c6d1fa294e18),
+      UINT64_C(0x85b4e02264b0969a), UINT64_C(0x3519f9473fa8c895), UINT64_C(0x53697ee398c0c475),
+      UINT64_C(0xb96a6a9c5e07a62e), UINT64_C(0x5ac4113cfd56f517), UINT64_C(0x017b062544458515),
+      UINT64_C(0xabae1362669f218b), UINT64_C(0x1871516621c795ef), UINT64_C(0x144479bd1dd51e40),
+      UINT64_C(0x29bca48b58089099), UINT64_C(0x16caf37ce2565241), UINT64_C(0xd50600688f21885c),
+      UINT64_C(0xf7a7e3ec50a42b81), UINT64_C(0x12ed71b58c756986), UINT64_C(0xee5c356d9bde86df),
+      UINT64_C(0xd2499f595b319fbc),
+   },
+   /* IA16 */
+   {
+      UINT64_C(0xe7fc78ce37a8e50d), UINT64_C(0xb2a29329d675dc17), UINT64_C(0x29a2f58a3cee286f),
+      UINT64_C(0xa89328be9ac75d19), UINT64_C(0xef47669dda817ca5), UINT64_C(0x0d32ac5ba49b83a9),
+      UINT64_C(0x90ed7d53f5eaddc0), UINT64_C(0x3322389496b141bb), UINT64_C(0xe0e3d437bb052763),
+      UINT64_C(0x6ad03bb0052e1df9), UINT64_C(0xe251b0321faa5ef2), UINT64_C(0x912106aaa3c8282e),
+      UINT64_C(0x4426fdf5912efb92), UINT64_C(0x399a646c675d92fc), UINT64_C(0x17f5a743e1aedcb6),
+      UINT64_C(0x8a29d5f541e26f00), UINT64_C(0x079795228872ecd0), UINT64_C(0xdfa157e19a46a074),
+      UINT64_C(0x203ea40ff8036653), UINT64_C(0x9f74b6acc34ef158), UINT64_C(0x53b4c5ed7c282ddc),
+      UINT64_C(0x2c6eec384b774338), UINT64_C(0xd166e430ade85e1d), UINT64_C(0x62baf9d410195129),
+      UINT64_C(0x54f304421e8f3935), UINT64_C(0x6879fe4cb0384bbf), UINT64_C(0x8dc8b84fcf113dc8),
+      UINT64_C(0xfdbc17fecbe9b837), UINT64_C(0x11d8b8a4f05c3643), UINT64_C(0x020bbb22ff9ced4b),
+      UINT64_C(0x83317c4dcde5a1fc), UINT64_C(0xfae928db9d725d73), UINT64_C(0x6d3e1e63dae2683b),
+      UINT64_C(0x39c88a3b8f536855), UINT64_C(0x58fbab7421ef2b75), UINT64_C(0x3f198c7235fc5901),
+      UINT64_C(0x7f16fce36e9d0689), UINT64_C(0x997da93c9972d6f5), UINT64_C(0x7272cbb6f4c0a74e),
+      UINT64_C(0xa0a176d4b6bc21d9), UINT64_C(0x424a0ae0f4685609), UINT64_C(0x4bc2a6cf4d6a984f),
+      UINT64_C(0x43811d3ec76d591a), UINT64_C(0x5c351823550ad494), UINT64_C(0xbbd114a0ee013d84),
+      UINT64_C(0xecc43bfd04592cb8), UINT64_C(0xa8a0fb01be4271ea), UINT64_C(0x3cd3af6a703be76e),
+      UINT64_C(0xbf49e264b5f7a8f2), UINT64_C(0xd21a5a81196eda74), UINT64_C(0xa978caededadd40f),
+      UINT64_C(0xd022cb353cdb0856), UINT64_C(0x1f077ad89555c1de), UINT64_C(0x4e7d7d20e28fe1f6),
+      UINT64_C(0x09c000ce8d939f0d), UINT64_C(0x5744c75738cf96cb), UINT64_C(0x2d33927cf58e5d2b),
+      UINT64_C(0xf6ee6a550244e957), UINT64_C(0x9041e7383e5d2058), UINT64_C(0xe67851194416c4d1),
+      UINT64_C(0x4f8e9a400c19a271), UINT64_C(0x375ad76c02ecff8d), UINT64_C(0xe80ab86dee55b90e),
+      UINT64_C(0x09b3e38652d8e95b), UINT64_C(0x4335beccde8ec2c7), UINT64_C(0x660492a1585f7db5),
+      UINT64_C(0x81f39338366e374f), UINT64_C(0x4401bee6faf2272b), UINT64_C(0xa8bfcb9f69e76597),
+      UINT64_C(0x4ea0af213a4956a5),
+   },
+   /* I4 */
+   {
+      UINT64_C(0xaa390dc6ac8c5691), UINT64_C(0x1c1d9dfb2b0cf269), UINT64_C(0x085f1be9d2f8555d),
+      UINT64_C(0x085f1be9d2f8555d), UINT64_C(0xc79bf267f88df7b1), UINT64_C(0xc79bf267f88df7b1),
+      UINT64_C(0x21b1c5f0b09a2255), UINT64_C(0x21b1c5f0b09a2255), UINT64_C(0x0d1d6b008321db21),
+      UINT64_C(0x0d1d6b008321db21), UINT64_C(0x60a3786aa9554841), UINT64_C(0x60a3786aa9554841),
+      UINT64_C(0x1ad8459b373d3a21), UINT64_C(0x1ad8459b373d3a21), UINT64_C(0x154a68cb3e6541b5),
+      UINT64_C(0x154a68cb3e6541b5), UINT64_C(0xc789bf341f1934e9), UINT64_C(0xc789bf341f1934e9),
+      UINT64_C(0xd39f6edd8cf4532d), UINT64_C(0xd39f6edd8cf4532d), UINT64_C(0xd4796704c2e1c7d1),
+      UINT64_C(0xd4796704c2e1c7d1), UINT64_C(0xc49fd3c6c4db1b1d), UINT64_C(0xc49fd3c6c4db1b1d),
+      UINT64_C(0x59d28f9c8c8a7a51), UINT64_C(0x59d28f9c8c8a7a51), UINT64_C(0x5554f2c0d2b7c125),
+      UINT64_C(0x5554f2c0d2b7c125), UINT64_C(0x179702d8dfb3f979), UINT64_C(0x179702d8dfb3f979),
+      UINT64_C(0x861b80b96d7f8671), UINT64_C(0x861b80b96d7f8671), UINT64_C(0x0427eb267d9958c9),
+      UINT64_C(0x0427eb267d9958c9), UINT64_C(0x4207975b8da9161d), UINT64_C(0x4207975b8da9161d),
+      UINT64_C(0x2bc1fd4bdd8a534d), UINT64_C(0x2bc1fd4bdd8a534d), UINT64_C(0x214eb2eed867b5b1),
+      UINT64_C(0x214eb2eed867b5b1), UINT64_C(0xdbf4ff4ff5e140b1), UINT64_C(0xdbf4ff4ff5e140b1),
+      UINT64_C(0x98b6449973394a69), UINT64_C(0x98b6449973394a69), UINT64_C(0xaac4a023bf43f7a9),
+      UINT64_C(0xaac4a023bf43f7a9), UINT64_C(0x2cb227be2a5bfcd9), UINT64_C(0x2cb227be2a5bfcd9),
+      UINT64_C(0x47854e9c801ed1a9), UINT64_C(0x47854e9c801ed1a9), UINT64_C(0x88745e490d36d8b1),
+      UINT64_C(0x88745e490d36d8b1), UINT64_C(0x1c622b39926b9d79), UINT64_C(0x1c622b39926b9d79),
+      UINT64_C(0xaf42b6bff13f3629), UINT64_C(0xaf42b6bff13f3629), UINT64_C(0x9114171b86380e09),
+      UINT64_C(0x9114171b86380e09), UINT64_C(0xb1a94e663634a5c1), UINT64_C(0xb1a94e663634a5c1),
+      UINT64_C(0xce5a458ee1523005), UINT64_C(0xce5a458ee1523005), UINT64_C(0xaf1fc1b0e8471b89),
+      UINT64_C(0xaf1fc1b0e8471b89), UINT64_C(0x6ced6950983625a1), UINT64_C(0x6ced6950983625a1),
+      UINT64_C(0xd68bc5e6910be691), UINT64_C(0xd68bc5e6910be691), UINT64_C(0xd7b4ee87ef9b8aa1),
+      UINT64_C(0xd7b4ee87ef9b8aa1),
+   },
+   /* I8 */
+   {
+      UINT64_C(0xfb826bc1e4487e7d), UINT64_C(0x6af793edb78cb985), UINT64_C(0x5b18f67267036c6d),
+      UINT64_C(0xac1649e940b4780d), UINT64_C(0x1039f95adbd3ea85), UINT64_C(0x60780ebcd705e4fd),
+      UINT64_C(0xa7abb2cfc050e97d), UINT64_C(0x5eb148f4e34f099d), UINT64_C(0xad989ee0439c506d),
+      UINT64_C(0x7ee165e8d55c5051), UINT64_C(0x77aad72db2c23921), UINT64_C(0x1aa54cec74489e05),
+      UINT64_C(0x0d51a77ac7e5ed3d), UINT64_C(0x9611da2df06fe401), UINT64_C(0x543d7a7cbf030481),
+      UINT64_C(0x47912696dba28e09), UINT64_C(0xd86df344864bbd79), UINT64_C(0x3b1e8c2333093fa1),
+      UINT64_C(0x339c4a014756fd19), UINT64_C(0xf6a12d27003754b9), UINT64_C(0xcc815c84fb12b0a9),
+      UINT64_C(0x22da52830a6d2961), UINT64_C(0xbe0823d3d4f4a0e9), UINT64_C(0x5cc3f0fa3288b1a9),
+      UINT64_C(0xdac837377cf89d29), UINT64_C(0x5d80ba58e29c1599), UINT64_C(0x30da368149d00749),
+      UINT64_C(0xf2000b22fb534de9), UINT64_C(0x0bbfb16bcf5b2c49), UINT64_C(0x7700dccb82f68541),
+      UINT64_C(0x1b93f92e084b8471), UINT64_C(0x1718b48d8cfa6c59), UINT64_C(0x7c51ef89abce6941),
+      UINT64_C(0x6192d27c210ac959), UINT64_C(0xc5de1fab89bb2f01), UINT64_C(0x9d11a44697aeac59),
+      UINT64_C(0xb22aa689b052ba81), UINT64_C(0xde8bd200fa71baa1), UINT64_C(0xedef0e4254f25091),
+      UINT64_C(0xc2a18a78f0df3d85), UINT64_C(0x1b000caad481c299), UINT64_C(0xf6844deb62e2b1c5),
+      UINT64_C(0xf56ff62969764699), UINT64_C(0xe93dddd95c2b621d), UINT64_C(0x8f19aac3e284ace1),
+      UINT64_C(0x6a7d89ed0c72b645), UINT64_C(0xbab60418149faea1), UINT64_C(0x39ca749cc827a65d),
+      UINT64_C(0xe3adfda78d09c1ad), UINT64_C(0x7917fb30209b53cd), UINT64_C(0xd63761510ea76efd),
+      UINT64_C(0x165fd88ca503cbc5), UINT64_C(0xa031edafa3297455), UINT64_C(0x9e8793d5efd297ed),
+      UINT64_C(0xacb9fe7789354ba5), UINT64_C(0x13ba14a678acb205), UINT64_C(0xba604378a20c6a79),
+      UINT64_C(0xc4bbc5af6424a5d9), UINT64_C(0x87387394a56454d5), UINT64_C(0x62a52b01b8a333d5),
+      UINT64_C(0x3903d9775a5c2ff1), UINT64_C(0x8a4f806e34cc1121), UINT64_C(0x4fac6dd88416d545),
+      UINT64_C(0x37aefcc00d8f65dd), UINT64_C(0xdfd2b4992f53f45d), UINT64_C(0x1fbaba60791175bd),
+      UINT64_C(0xa1fa4f69fc905b1d), UINT64_C(0xb914dacb28055b75), UINT64_C(0x5cce1c030018f4c5),
+      UINT64_C(0x72cfa98bcdc86e45),
+   },
+   /* CI4/RGBA16 */
+   {
+      UINT64_C(0x59d1fc3ad6459c14), UINT64_C(0x41028b7e820eeb79), UINT64_C(0x1f456571e62f042c),
+      UINT64_C(0x1f456571e62f042c), UINT64_C(0x9a84a8ecf6ec9ae7), UINT64_C(0x9a84a8ecf6ec9ae7),
+      UINT64_C(0xf257eb8cfd7c5491), UINT64_C(0xf257eb8cfd7c5491), UINT64_C(0x38b7479943415750),
+      UINT64_C(0x38b7479943415750), UINT64_C(0x05f0db2c5d2bc864), UINT64_C(0x05f0db2c5d2bc864),
+      UINT64_C(0xe5b5f71605974a88), UINT64_C(0xe5b5f71605974a88), UINT64_C(0xbfeab767c71504e5),
+      UINT64_C(0xbfeab767c71504e5), UINT64_C(0x50b3e96e0b11ff5e), UINT64_C(0x50b3e96e0b11ff5e),
+      UINT64_C(0x16547aed6dad3212), UINT64_C(0x16547aed6dad3212), UINT64_C(0x2610e98c4e41a1a3),
+      UINT64_C(0x2610e98c4e41a1a3), UINT64_C(0x7b82c02208972910), UINT64_C(0x7b82c02208972910),
+      UINT64_C(0xc17c71d605f819e8), UINT64_C(0xc17c71d605f819e8), UINT64_C(0x7e2d7a100a344909),
+      UINT64_C(0x7e2d7a100a344909), UINT64_C(0xd6f866b5e93d266a), UINT64_C(0xd6f866b5e93d266a),
+      UINT64_C(0x5dbbcb8cac3a26e0), UINT64_C(0x5dbbcb8cac3a26e0), UINT64_C(0x06f119513ccbb4e7),
+      UINT64_C(0x06f119513ccbb4e7), UINT64_C(0x016597a30d9b7c83), UINT64_C(0x016597a30d9b7c83),
+      UINT64_C(0x63300ccabb0935b0), UINT64_C(0x63300ccabb0935b0), UINT64_C(0x626bcc90c60c1c8e),
+      UINT64_C(0x626bcc90c60c1c8e), UINT64_C(0x68b198b77738327e), UINT64_C(0x68b198b77738327e),
+      UINT64_C(0x6c80bf8cb5f74ac8), UINT64_C(0x6c80bf8cb5f74ac8), UINT64_C(0x021920eb304bffa8),
+      UINT64_C(0x021920eb304bffa8), UINT64_C(0xbbc351412d7efc30), UINT64_C(0xbbc351412d7efc30),
+      UINT64_C(0xcd2e3fd3c932481e), UINT64_C(0xcd2e3fd3c932481e), UINT64_C(0xfce6d3778d5f30a9),
+      UINT64_C(0xfce6d3778d5f30a9), UINT64_C(0x72c8cf790f7d4fd9), UINT64_C(0x72c8cf790f7d4fd9),
+      UINT64_C(0x9f929530ccddb8db), UINT64_C(0x9f929530ccddb8db), UINT64_C(0x6ee31ceed408671a),
+      UINT64_C(0x6ee31ceed408671a), UINT64_C(0x37d98f5c9eea39c0), UINT64_C(0x37d98f5c9eea39c0),
+      UINT64_C(0xba7df0b0f7587390), UINT64_C(0xba7df0b0f7587390), UINT64_C(0x2cfd5e18de4bfdcb),
+      UINT64_C(0x2cfd5e18de4bfdcb), UINT64_C(0xd5c799779271e450), UINT64_C(0xd5c799779271e450),
+      UINT64_C(0xfb063b6a2e0d9ff2), UINT64_C(0xfb063b6a2e0d9ff2), UINT64_C(0x37094a085efe54f6),
+      UINT64_C(0x37094a085efe54f6),
+   },
+   /* CI4/IA16 */
+   {
+      UINT64_C(0xf40dce91215ec2c4), UINT64_C(0xada818580068d689), UINT64_C(0x8748f535a45ab9cd),
+      UINT64_C(0x8748f535a45ab9cd), UINT64_C(0xd8255c061228e359), UINT64_C(0xd8255c061228e359),
+      UINT64_C(0x2943da3bfdf0f5b9), UINT64_C(0x2943da3bfdf0f5b9), UINT64_C(0x3aaf2b1e6704fa85),
+      UINT64_C(0x3aaf2b1e6704fa85), UINT64_C(0x609ab2a5e589d646), UINT64_C(0x609ab2a5e589d646),
+      UINT64_C(0xbe5440fb8d2dde44), UINT64_C(0xbe5440fb8d2dde44), UINT64_C(0x90a6e5f053a9e3cf),
+      UINT64_C(0x90a6e5f053a9e3cf), UINT64_C(0x8a6254f89a305597), UINT64_C(0x8a6254f89a305597),
+      UINT64_C(0xb4d3f21942c58177), UINT64_C(0xb4d3f21942c58177), UINT64_C(0x632cea269b027deb),
+      UINT64_C(0x632cea269b027deb), UINT64_C(0x85afc2df0288f5ff), UINT64_C(0x85afc2df0288f5ff),
+      UINT64_C(0xbca4b58c253f7df7), UINT64_C(0xbca4b58c253f7df7), UINT64_C(0x939ee4b5da0dfc62),
+      UINT64_C(0x939ee4b5da0dfc62), UINT64_C(0x1ddb8b83f0e3c038), UINT64_C(0x1ddb8b83f0e3c038),
+      UINT64_C(0xa9bc7a29af759813), UINT64_C(0xa9bc7a29af759813), UINT64_C(0x1adc0a83e12a046b),
+      UINT64_C(0x1adc0a83e12a046b), UINT64_C(0xb1d94f28bdbf7287), UINT64_C(0xb1d94f28bdbf7287),
+      UINT64_C(0xc04003bdcbc638c7), UINT64_C(0xc04003bdcbc638c7), UINT64_C(0x13cec1cfcb49188b),
+      UINT64_C(0x13cec1cfcb49188b), UINT64_C(0xde013ab8442ff90b), UINT64_C(0xde013ab8442ff90b),
+      UINT64_C(0x63e32082a1d5ff4a), UINT64_C(0x63e32082a1d5ff4a), UINT64_C(0xdbba945d0fdf6e8e),
+      UINT64_C(0xdbba945d0fdf6e8e), UINT64_C(0x53fb93fb18dc19cb), UINT64_C(0x53fb93fb18dc19cb),
+      UINT64_C(0x0941070d09c03e8e), UINT64_C(0x0941070d09c03e8e), UINT64_C(0xec82269761df93c3),
+      UINT64_C(0xec82269761df93c3), UINT64_C(0xa3cb80565226bbaa), UINT64_C(0xa3cb80565226bbaa),
+      UINT64_C(0x2e631590508828f7), UINT64_C(0x2e631590508828f7), UINT64_C(0x6ede0b6e271f8266),
+      UINT64_C(0x6ede0b6e271f8266), UINT64_C(0xa3f0966da00a7371), UINT64_C(0xa3f0966da00a7371),
+      UINT64_C(0x173756bb864798dc), UINT64_C(0x173756bb864798dc), UINT64_C(0xda394c8cecea115f),
+      UINT64_C(0xda394c8cecea115f), UINT64_C(0xd989bfaed02cd386), UINT64_C(0xd989bfaed02cd386),
+      UINT64_C(0xc757014eb4bd22ff), UINT64_C(0xc757014eb4bd22ff), UINT64_C(0x0a7c2ad443d5907e),
+      UINT64_C(0x0a7c2ad443d5907e),
+   },
+   /* CI8/RGBA16 */
+   {
+      UINT64_C(0xc8faf0729a193561), UINT64_C(0xc856e5e6a6b83eb4), UINT64_C(0xb58d559571c99daf),
+      UINT64_C(0xd33311e2f7675753), UINT64_C(0x371ae3e429d46f89), UINT64_C(0x3fa26aae32525803),
+      UINT64_C(0xd85cb4c96d0ffc62), UINT64_C(0x8989be9883c70669), UINT64_C(0x322e0c189d98c5ed),
+      UINT64_C(0xd5baa1b1a51f45dd), UINT64_C(0x06c59b77c66f5a22), UINT64_C(0xa8ba366b919b91d4),
+      UINT64_C(0x722ffc95ad212c89), UINT64_C(0xc23fbd928678bf6a), UINT64_C(0xe636a0008b19cda4),
+      UINT64_C(0xa72b8282384fd5cd), UINT64_C(0xd4c736611f722d4d), UINT64_C(0x46d424acae1f5e64),
+      UINT64_C(0x186ad317f608ec2c), UINT64_C(0xd4e2d0a623d7c28c), UINT64_C(0xff090a72351ba907),
+      UINT64_C(0x439a5376430b2065), UINT64_C(0x8f13877b135e6d4a), UINT64_C(0x4724b785612d2651),
+      UINT64_C(0x3e5526703cbe41d1), UINT64_C(0xbe9ee30f872a943b), UINT64_C(0x249f2a389885def1),
+      UINT64_C(0x007947c0017f8a75), UINT64_C(0x1cc3126d3a171931), UINT64_C(0x7960bbc67df326e9),
+      UINT64_C(0xe9b0287ec956c197), UINT64_C(0x1930086c96d6880d), UINT64_C(0x45cfe810a48e10cd),
+      UINT64_C(0xae9448cb150b31ef), UINT64_C(0x1f91f4a96e9b08f9), UINT64_C(0x39962719a0a336bb),
+      UINT64_C(0x6a9df983a174e04f), UINT64_C(0x432c7739675775ce), UINT64_C(0x966468ce393c4f4c),
+      UINT64_C(0x509609876fec8009), UINT64_C(0xad65f3748061e82d), UINT64_C(0xc10475ebd732beb1),
+      UINT64_C(0xefcf375bc17f97a9), UINT64_C(0x53ee06936db5d321), UINT64_C(0x8fb043b8eb050969),
+      UINT64_C(0xb9315b9b191f93c5), UINT64_C(0x7daef32fe7d447a1), UINT64_C(0x2437e4788436b859),
+      UINT64_C(0xffc36d9b0a3443c5), UINT64_C(0xe4fd4011190df374), UINT64_C(0x5013ce0f5c5e58be),
+      UINT64_C(0x84b5aaef353890c4), UINT64_C(0x3df66f1f857cf36f), UINT64_C(0x411b9b72a53370d5),
+      UINT64_C(0xf9094e16cbdaed10), UINT64_C(0x00cb10c8899532ad), UINT64_C(0xb2610643044dcead),
+      UINT64_C(0x438ec36e9613a2b2), UINT64_C(0xb5036938a3b1e491), UINT64_C(0x622d99447473ec58),
+      UINT64_C(0x50397d02832c3146), UINT64_C(0x09ff4115a3d8e9ed), UINT64_C(0xbb72d57928f7b4b0),
+      UINT64_C(0xfef08140abdfdce1), UINT64_C(0x195efa2d90fd8421), UINT64_C(0x953910579e48f442),
+      UINT64_C(0x0dc5cbd3e4888461), UINT64_C(0x4d1e62736fa9c22a), UINT64_C(0xde88a11e4f0816e8),
+      UINT64_C(0x99d145b4bbf6c79e),
+   },
+   /* CI8/IA16 */
+   {
+      UINT64_C(0x4305a588ff7e471d), UINT64_C(0x965ba0103b8846e3), UINT64_C(0x300478577695eaa2),
+      UINT64_C(0x396528c5b2482e73), UINT64_C(0xad641e945dfe6236), UINT64_C(0x2389a644afde0050),
+      UINT64_C(0xd2ca4b5b1d6d7c70), UINT64_C(0x739b652c0704b04d), UINT64_C(0x03ef6431203611b5),
+      UINT64_C(0x9a4ab5dbf1ad7ad0), UINT64_C(0x2e6c6c00cb9c5274), UINT64_C(0x9305e81131fee569),
+      UINT64_C(0xfefd85fd6b10c398), UINT64_C(0x130fc194ea096161), UINT64_C(0xb13fb3b9da0a60ac),
+      UINT64_C(0x8f7cfa5aa1e1956d), UINT64_C(0x1961fb5785550d99), UINT64_C(0x4538679c5a44213a),
+      UINT64_C(0x0201c991b143336c), UINT64_C(0xeadb8318cb37593f), UINT64_C(0xe262134420357e4c),
+      UINT64_C(0xfc7038cebc559956), UINT64_C(0xa8b6d16b67896b13), UINT64_C(0xe2a7e003bd41b2dd),
+      UINT64_C(0x241ec26b3935363d), UINT64_C(0x74408d951f3e74a3), UINT64_C(0xabfc3fb9f4dbab2a),
+      UINT64_C(0x7b3015833d62219b), UINT64_C(0xf11a3de2c2cb7163), UINT64_C(0x20105f40a660356c),
+      UINT64_C(0xe19a6a1f775f2a09), UINT64_C(0xe790fe0362c117f5), UINT64_C(0xe0cebb1e6af9acfd),
+      UINT64_C(0x62b54bf64c9f11ab), UINT64_C(0x48fc209bafd2f2cf), UINT64_C(0x19d794aba8c46c89),
+      UINT64_C(0xa28cec5f87016960), UINT64_C(0x8c12c1fa7d0b01d7), UINT64_C(0x654ff1047dc11b06),
+      UINT64_C(0xa3e9506dbb36df45), UINT64_C(0x656e1530e22d8fe1), UINT64_C(0xb3119f90e778b817),
+      UINT64_C(0xf3e847e590626d76), UINT64_C(0xe604f248158dd039), UINT64_C(0x6c3d80e03b153e5d),
+      UINT64_C(0xf71e38c34c9e53c3), UINT64_C(0x1161ec476d7bb122), UINT64_C(0xaf6774271da1acb5),
+      UINT64_C(0xc15a2a14d61fd4c5), UINT64_C(0x06bd3d086f260524), UINT64_C(0x95a6f18b36357ae7),
+      UINT64_C(0x923f3bec79a0b640), UINT64_C(0xbefcf973e5a8e444), UINT64_C(0x8bbecda4931454a7),
+      UINT64_C(0xf831fee7cb1c53e8), UINT64_C(0x237ff48cf078c031), UINT64_C(0x8e4bf05827898b15),
+      UINT64_C(0x126b5f66a697ab5b), UINT64_C(0x72374f9f54bc0eec), UINT64_C(0x8d30919fc6d388ce),
+      UINT64_C(0xfba64a7ca47bc00d), UINT64_C(0xb93854aa7a59fa5d), UINT64_C(0xec32216178c84739),
+      UINT64_C(0x13561a0251488089), UINT64_C(0x9885ea4563578991), UINT64_C(0xca42c75675f4637f),
+      UINT64_C(0x2a03000dfe498038), UINT64_C(0xb1c3abe7c2612acc), UINT64_C(0x2fab1ac7b56d7f4e),
+      UINT64_C(0xeda1a65d1d19e4a6),
+   },
+   /* CI4/RGBA16 opaque */
+   {
+      UINT64_C(0xd415e36072009263), UINT64_C(0xcc7bf223bc47b440), UINT64_C(0x864b1e8b6b097691),
+      UINT64_C(0x864b1e8b6b097691), UINT64_C(0x8aa614354f80e88c), UINT64_C(0x8aa614354f80e88c),
+      UINT64_C(0xaf8b64c63c587123), UINT64_C(0xaf8b64c63c587123), UINT64_C(0x0735a030eb96846d),
+      UINT64_C(0x0735a030eb96846d), UINT64_C(0x5c02c337baae14c0), UINT64_C(0x5c02c337baae14c0),
+      UINT64_C(0xe1a1c3cc662ad0ee), UINT64_C(0xe1a1c3cc662ad0ee), UINT64_C(0x6fdec5f6f9c75e69),
+      UINT64_C(0x6fdec5f6f9c75e69), UINT64_C(0xab6b3a57ff5580dd), UINT64_C(0xab6b3a57ff5580dd),
+      UINT64_C(0x9946d43c68136d4d), UINT64_C(0x9946d43c68136d4d), UINT64_C(0x4ac3df116294fb21),
+      UINT64_C(0x4ac3df116294fb21), UINT64_C(0xd36cef00d0e0a3e5), UINT64_C(0xd36cef00d0e0a3e5),
+      UINT64_C(0x601d17a273dafc57), UINT64_C(0x601d17a273dafc57), UINT64_C(0x0536a6019072ad99),
+      UINT64_C(0x0536a6019072ad99), UINT64_C(0xd84dd16328b2c368), UINT64_C(0xd84dd16328b2c368),
+      UINT64_C(0x4929c789063d9fba), UINT64_C(0x4929c789063d9fba), UINT64_C(0xbf07886a6de26860),
+      UINT64_C(0xbf07886a6de26860), UINT64_C(0x65c95eda0fc0b866), UINT64_C(0x65c95eda0fc0b866),
+      UINT64_C(0x24fca37f47bc4139), UINT64_C(0x24fca37f47bc4139), UINT64_C(0xd3d5979a6aeeaf5a),
+      UINT64_C(0xd3d5979a6aeeaf5a), UINT64_C(0xee8a4b2626f117aa), UINT64_C(0xee8a4b2626f117aa),
+      UINT64_C(0x32450e7bc475d1fe), UINT64_C(0x32450e7bc475d1fe), UINT64_C(0xb1f80ce58a7555ca),
+      UINT64_C(0xb1f80ce58a7555ca), UINT64_C(0x23670acec82065d8), UINT64_C(0x23670acec82065d8),
+      UINT64_C(0xee967d5e562d4f4a), UINT64_C(0xee967d5e562d4f4a), UINT64_C(0x407c1aebc65fa87c),
+      UINT64_C(0x407c1aebc65fa87c), UINT64_C(0x19b4f89d4fe76fd5), UINT64_C(0x19b4f89d4fe76fd5),
+      UINT64_C(0xc0ce447029495bfa), UINT64_C(0xc0ce447029495bfa), UINT64_C(0x2e2206a60fe69097),
+      UINT64_C(0x2e2206a60fe69097), UINT64_C(0x1beb597e8f950a38), UINT64_C(0x1beb597e8f950a38),
+      UINT64_C(0x58df3c6d7a3f013d), UINT64_C(0x58df3c6d7a3f013d), UINT64_C(0x8a8bd364af43a9cc),
+      UINT64_C(0x8a8bd364af43a9cc), UINT64_C(0xbdef32c6a352b52c), UINT64_C(0xbdef32c6a352b52c),
+      UINT64_C(0x6960dee04da26f90), UINT64_C(0x6960dee04da26f90), UINT64_C(0x375ef3d477e3e2f6),
+      UINT64_C(0x375ef3d477e3e2f6),
+   },
+   /* CI4/IA16 opaque */
+   {
+      UINT64_C(0x4bb80a05767f1e3c), UINT64_C(0x4225d8c246b0b992), UINT64_C(0xeca0124a8aa92e51),
+      UINT64_C(0xeca0124a8aa92e51), UINT64_C(0x6c2e454f9cabdd42), UINT64_C(0x6c2e454f9cabdd42),
+      UINT64_C(0x386cbd922078fe4d), UINT64_C(0x386cbd922078fe4d), UINT64_C(0xfaa5db7f6045a162),
+      UINT64_C(0xfaa5db7f6045a162), UINT64_C(0x7fc123ad1b834899), UINT64_C(0x7fc123ad1b834899),
+      UINT64_C(0xfc5127cae4e665a8), UINT64_C(0xfc5127cae4e665a8), UINT64_C(0x9f93c92e2a99ac14),
+      UINT64_C(0x9f93c92e2a99ac14), UINT64_C(0x8b980ee3fad91ae6), UINT64_C(0x8b980ee3fad91ae6),
+      UINT64_C(0x07bfd08bab0032fc), UINT64_C(0x07bfd08bab0032fc), UINT64_C(0xeb2c55986f2fecba),
+      UINT64_C(0xeb2c55986f2fecba), UINT64_C(0x1b58f51c02878e08), UINT64_C(0x1b58f51c02878e08),
+      UINT64_C(0x9b9d03608b2743fe), UINT64_C(0x9b9d03608b2743fe), UINT64_C(0xae22ffee91f05815),
+      UINT64_C(0xae22ffee91f05815), UINT64_C(0x4a0e940bd174ec1e), UINT64_C(0x4a0e940bd174ec1e),
+      UINT64_C(0xd33dfd3d18e4a71d), UINT64_C(0xd33dfd3d18e4a71d), UINT64_C(0xfc722bdcbd5c417b),
+      UINT64_C(0xfc722bdcbd5c417b), UINT64_C(0x4fc3b6a273a8fc51), UINT64_C(0x4fc3b6a273a8fc51),
+      UINT64_C(0xaec56ed2535c55f3), UINT64_C(0xaec56ed2535c55f3), UINT64_C(0x98f7e4c1878782f5),
+      UINT64_C(0x98f7e4c1878782f5), UINT64_C(0x277276455c7779ab), UINT64_C(0x277276455c7779ab),
+      UINT64_C(0xe62acba339051c83), UINT64_C(0xe62acba339051c83), UINT64_C(0x2b4f7ff1b9c1920d),
+      UINT64_C(0x2b4f7ff1b9c1920d), UINT64_C(0x20f52cad79ec3d56), UINT64_C(0x20f52cad79ec3d56),
+      UINT64_C(0xe0bb2e1492e29d25), UINT64_C(0xe0bb2e1492e29d25), UINT64_C(0x48327eedd21ac0e6),
+      UINT64_C(0x48327eedd21ac0e6), UINT64_C(0xab66ba95a2e47519), UINT64_C(0xab66ba95a2e47519),
+      UINT64_C(0xffa2d53aed49f7f6), UINT64_C(0xffa2d53aed49f7f6), UINT64_C(0x36ea3fb6bc7342fd),
+      UINT64_C(0x36ea3fb6bc7342fd), UINT64_C(0xa17d9df34ec202de), UINT64_C(0xa17d9df34ec202de),
+      UINT64_C(0xcb4501937f075bd1), UINT64_C(0xcb4501937f075bd1), UINT64_C(0x826dcfc0e8d5bf78),
+      UINT64_C(0x826dcfc0e8d5bf78), UINT64_C(0x594c5b75c3b6dd0c), UINT64_C(0x594c5b75c3b6dd0c),
+      UINT64_C(0x8e2bfa55c0ea1b54), UINT64_C(0x8e2bfa55c0ea1b54), UINT64_C(0x6d27b4466d299e4c),
+      UINT64_C(0x6d27b4466d299e4c),
+   },
+   /* CI8/RGBA16 opaque */
+   {
+      UINT64_C(0x8c003a70d9aaf349), UINT64_C(0x813b13422b5df224), UINT64_C(0x49f20c5f65973ec2),
+      UINT64_C(0xfebda541ec40444d), UINT64_C(0x2a40c7829c046e03), UINT64_C(0x66db3634daf5e58e),
+      UINT64_C(0x2752c256f6ee3006), UINT64_C(0x48ceaf016b663089), UINT64_C(0x82c53f0da59ee881),
+      UINT64_C(0x3fed5f750f7ccee9), UINT64_C(0xe4556de79a7ffbca), UINT64_C(0x2d82b68b5760d89c),
+      UINT64_C(0xd886b95b5efff2d9), UINT64_C(0xb257486bea5b597a), UINT64_C(0x5aa7395a5eea0b20),
+      UINT64_C(0x13a0994494841511), UINT64_C(0x3bc6cb2d6ad897c1), UINT64_C(0x8c8b179397c6b048),
+      UINT64_C(0x08985cc87a76bce1), UINT64_C(0x0d6ba5bef1d829c9), UINT64_C(0xbcec5b3d81bc1d18),
+      UINT64_C(0x03ce8a711bd36416), UINT64_C(0xfb8158a97dcf16ee), UINT64_C(0x1f2456113676ef0d),
+      UINT64_C(0x1d4c05c12b6bc12d), UINT64_C(0x71d214a8a9c5035c), UINT64_C(0xf61d5c716e96d448),
+      UINT64_C(0x8f2cd55517787dd9), UINT64_C(0xea6c7cb3c96c45bf), UINT64_C(0x987fece3695ee92d),
+      UINT64_C(0x73069748b0f3c3bb), UINT64_C(0x586ceee771d4b20d), UINT64_C(0x836e6829230f2465),
+      UINT64_C(0x4feb405e8d7fb3bc), UINT64_C(0xc308f1fd1debc624), UINT64_C(0x196c2e654159174b),
+      UINT64_C(0xa6a10b136b69fd45), UINT64_C(0x9e50219e83b9a702), UINT64_C(0x17ca25794e27b778),
+      UINT64_C(0x865b0afa67bbc691), UINT64_C(0x38f1395a67d08625), UINT64_C(0x0f082ee73baef9b6),
+      UINT64_C(0x5847f08b6e412f95), UINT64_C(0xb3c9385394f995e2), UINT64_C(0x85795ef886400687),
+      UINT64_C(0xb1f8220f81b5edd2), UINT64_C(0x3e895632525ee450), UINT64_C(0x0f2247eec6667c7d),
+      UINT64_C(0xd4849ed21aabf659), UINT64_C(0x9dd17c3e562467b0), UINT64_C(0x420f0e61b75a5776),
+      UINT64_C(0xe2d765244e8ad0a8), UINT64_C(0xa8d3a8360c4d0dec), UINT64_C(0xeb68201f9c95daaf),
+      UINT64_C(0xac88684512c47bc5), UINT64_C(0x44cda48f6681f2fd), UINT64_C(0x8a96df09b7f9dad9),
+      UINT64_C(0xf03411395017e89d), UINT64_C(0xc19df09dd5b7c88a), UINT64_C(0x861807850f9e7cf2),
+      UINT64_C(0xaabe21be5c85a41a), UINT64_C(0x3519b62c6195aa66), UINT64_C(0xe831b82927f4b4bd),
+      UINT64_C(0x8dde9f4fbd9cb429), UINT64_C(0x94580066f42f4b39), UINT64_C(0x38d30eff084626c5),
+      UINT64_C(0xf4f49138a0ee218d), UINT64_C(0x8a696de14eb4df88), UINT64_C(0xf9991f3e0cac219f),
+      UINT64_C(0xe99bd1e8cbeee3ac),
+   },
+   /* CI8/IA16 opaque */
+   {
+      UINT64_C(0xb3fb2f7327240bc1), UINT64_C(0xd53e7a0c48d3c2fb), UINT64_C(0x500330cad04c00b9),
+      UINT64_C(0x55583db08f4203b3), UINT64_C(0x9a788ca6face5c62), UINT64_C(0x58ba41db59b9794b),
+      UINT64_C(0xad3325d10b87ced0), UINT64_C(0x9a347337a31b2989), UINT64_C(0x52573de80bf972a5),
+      UINT64_C(0x3f37a9dae546e63c), UINT64_C(0xc48458d15c763536), UINT64_C(0xa486d4192bb3e527),
+      UINT64_C(0xf81eb9581bb38c9a), UINT64_C(0xbffdbb37a9fa8af1), UINT64_C(0xf1214d64f0e6823e),
+      UINT64_C(0x9199bb199c3f109d), UINT64_C(0x780086abb93116d9), UINT64_C(0x6e1d0e80d1bc390e),
+      UINT64_C(0x3dde7cacc08f22d9), UINT64_C(0x45b4cfb03af82356), UINT64_C(0xbb68839f42e5dd8f),
+      UINT64_C(0xbf927e2347fab233), UINT64_C(0xed3e9e7c421b8a75), UINT64_C(0xad0c16e6d1a41275),
+      UINT64_C(0x0267db5334b3bdf9), UINT64_C(0x58760bc6c66eb340), UINT64_C(0x1c560f2cd766a0dd),
+      UINT64_C(0x613c9e41bc89ef3d), UINT64_C(0xe0bd0ca9b04717d9), UINT64_C(0x42f3b65a8d92dff4),
+      UINT64_C(0x3fb6c83f1d3f76e1), UINT64_C(0xe17a22ca79b8ee1d), UINT64_C(0x588c9db0d8658d9d),
+      UINT64_C(0x51bb96dbe828a802), UINT64_C(0xdef7126d9ba5c56a), UINT64_C(0x1d5f1b17b5673777),
+      UINT64_C(0xa0a87ffffd659ec4), UINT64_C(0x3da18dc9eadd12f5), UINT64_C(0x3ed0e7dba9c54f92),
+      UINT64_C(0x6cb1110d582c2d45), UINT64_C(0x5ebed616d5cf3ca5), UINT64_C(0xd24d1eb39258ec1a),
+      UINT64_C(0x0ab207a8259ecaae), UINT64_C(0xb99b3605e00e6b90), UINT64_C(0xa2679537f76e8ca3),
+      UINT64_C(0x326b9619c5c14a88), UINT64_C(0x1a5ad03c129412f7), UINT64_C(0xc9fbd16ed9957d9d),
+      UINT64_C(0xcc8c86d4fa69e885), UINT64_C(0xfcc40fb4d53e9dfc), UINT64_C(0x32dc7b9771511f21),
+      UINT64_C(0xbad641aa8a0f997a), UINT64_C(0x4a8ceb7ad234ae1f), UINT64_C(0x7e6233d88f2d7295),
+      UINT64_C(0x3ad85197d9957471), UINT64_C(0x81369a0cb50ade55), UINT64_C(0x92911e57270be3a5),
+      UINT64_C(0xd63f469f1b012dc0), UINT64_C(0xfe45eeaf880c5bff), UINT64_C(0xa883b80d81eccab4),
+      UINT64_C(0xab4a1a2a63a70c6f), UINT64_C(0xbee32fa3d25f0112), UINT64_C(0xe76e67abc6278fb2),
+      UINT64_C(0x1135e40e20227c69), UINT64_C(0x9679a8506a49220d), UINT64_C(0x1cfe9cbd070c22f4),
+      UINT64_C(0x5ff1765386f787be), UINT64_C(0x5081f8c676a95052), UINT64_C(0x716b7876643554a3),
+      UINT64_C(0x04e42bc423ca66cc),
+   },
+};
@@ -0,0 +1,286 @@
+/* texexpand_bench
+ * Bit-exactness and speed check for the clamp, mirror and wrap expansion
+ * in Graphics/texexpand.c.
+ *
+ * Each function is compared with the texel by texel loops Rice's
+ * TextureManager.cpp used before, on surfaces filled with noise (the
+ * loops may read texels they have not written yet, and so must the
+ * replacement), for 16 and 32-bit texels:
+ *   - S: every pitch up to 64, every width and target width, every mask,
+ *   - T: every height and target height up to 64 rows, every mask.
+ *
+ * Then the time of a full S and T expansion is printed for the common
+ * 32x32 to 256x256 surfaces, next to that of the reference loops.
+ *
+ * Built with "make texexpand_bench", with whatever SIMD the compiler
+ * enables by default; add -mssse3 to CFLAGS to check the SSSE3 path.
+ * Exits non-zero on the first mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "texexpand.h"
+
+#define CHECK_MAX    64
+#define CHECK_ROWS   2
+#define BENCH_BYTES  (64 << 20)
+
+enum op
+{
+   OP_CLAMP = 0,
+   OP_MIRROR,
+   OP_WRAP,
+   OP_COUNT
+};
+
+static const char *op_names[OP_COUNT] = { "clamp", "mirror", "wrap" };
+
+/* The reference loops, as in Rice's ClampS32, MirrorT16, WrapS32... */
+
+#define REF_S(type) \
+static void ref_s_##type(enum op op, type *array, uint32_t width, uint32_t mask, \
+      uint32_t towidth, uint32_t arrayWidth, uint32_t rows) \
+{ \
+   uint32_t maskval1 = (1<<mask)-1; \
+   uint32_t maskval2 = (1<<(mask+1))-1; \
+   uint32_t x, y; \
+   if (op == OP_CLAMP && ((int) width <= 0 || (int) towidth < 0)) \
+      return; \
+   for( y = 0; y<rows; y++ ) \
+   { \
+      type* line = array+y*arrayWidth; \
+      type val = line[width-1]; \
+      for( x=width; x<towidth; x++ ) \
+      { \
+         if (op == OP_CLAMP) \
+            line[x] = val; \
+         else if (op == OP_MIRROR) \
+            line[x] = (x&maskval2)<=maskval1 ? line[x&maskval1] : line[maskval2-(x&maskval2)]; \
+         else \
+            line[x] = line[(x&maskval1)<width?(x&maskval1):towidth-(x&maskval1)]; \
+      } \
+   } \
+}
+
+#define REF_T(type) \
+static void ref_t_##type(enum op op, type *array, uint32_t height, uint32_t mask, \
+      uint32_t toheight, uint32_t arrayWidth) \
+{ \
+   uint32_t maskval1 = (1<<mask)-1; \
+   uint32_t maskval2 = (1<<(mask+1))-1; \
+   uint32_t x, y; \
+   if (op == OP_CLAMP && ((int) height <= 0 || (int) toheight < 0)) \
+      return; \
+   for( y = height; y<toheight; y++ ) \
+   { \
+      uint32_t srcy; \
+      type* linesrc; \
+      type* linedst = array+arrayWidth*y; \
+      if (op == OP_CLAMP) \
+         srcy = height-1; \
+      else if (op == OP_MIRROR) \
+         srcy = (y&maskval2)<=maskval1 ? y&maskval1 : maskval2-(y&maskval2); \
+      else \
+         srcy = y>maskval1?y&maskval1:y-height; \
+      linesrc = array+arrayWidth*srcy; \
+      for( x=0; x<arrayWidth; x++ ) \
+         linedst[x] = linesrc[x]; \
+   } \
+}
+
+REF_S(uint16_t)
+REF_S(uint32_t)
+REF_T(uint16_t)
+REF_T(uint32_t)
+
+static void ref_s(enum op op, void *array, unsigned size, uint32_t width, uint32_t mask,
+      uint32_t towidth, uint32_t pitch, uint32_t rows)
+{
+   if (size == 4)
+      ref_s_uint32_t(op, (uint32_t*)array, width, mask, towidth, pitch, rows);
+   else
+      ref_s_uint16_t(op, (uint16_t*)array, width, mask, towidth, pitch, rows);
+}
+
+static void ref_t(enum op op, void *array, unsigned size, uint32_t height, uint32_t mask,
+      uint32_t toheight, uint32_t pitch)
+{
+   if (size == 4)
+      ref_t_uint32_t(op, (uint32_t*)array, height, mask, toheight, pitch);
+   else
+      ref_t_uint16_t(op, (uint16_t*)array, height, mask, toheight, pitch);
+}
+
+static void expand_s(enum op op, void *array, unsigned size, uint32_t width, uint32_t mask,
+      uint32_t towidth, uint32_t pitch, uint32_t rows)
+{
+   if (op == OP_CLAMP)
+      texexpand_clamp_s(array, size, width, towidth, pitch, rows);
+   else if (op == OP_MIRROR)
+      texexpand_mirror_s(array, size, width, mask, towidth, pitch, rows);
+   else
+      texexpand_wrap_s(array, size, width, mask, towidth, pitch, rows);
+}
+
+static void expand_t(enum op op, void *array, unsigned size, uint32_t height, uint32_t mask,
+      uint32_t toheight, uint32_t pitch)
+{
+   if (op == OP_CLAMP)
+      texexpand_clamp_t(array, size, height, toheight, pitch);
+   else if (op == OP_MIRROR)
+      texexpand_mirror_t(array, size, height, mask, toheight, pitch);
+   else
+      texexpand_wrap_t(array, size, height, mask, toheight, pitch);
+}
+
+static double get_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int check_s(enum op op, unsigned size, const uint8_t *noise,
+      uint8_t *expect, uint8_t *got)
+{
+   uint32_t pitch, width, towidth, mask;
+
+   for (pitch = 1; pitch <= CHECK_MAX; pitch++)
+      for (width = 1; width <= pitch; width++)
+         for (towidth = width; towidth <= pitch; towidth++)
+            for (mask = 0; mask <= 6; mask++)
+            {
+               size_t bytes = pitch * CHECK_ROWS * size;
+
+               if (op == OP_CLAMP && mask)
+                  continue;
+               memcpy(expect, noise, bytes);
+               memcpy(got, noise, bytes);
+               ref_s(op, expect, size, width, mask, towidth, pitch, CHECK_ROWS);
+               expand_s(op, got, size, width, mask, towidth, pitch, CHECK_ROWS);
+               if (memcmp(expect, got, bytes))
+               {
+                  printf("%s S %u bit: mismatch, pitch %u width %u towidth %u mask %u\n",
+                        op_names[op], size * 8, pitch, width, towidth, mask);
+                  return 0;
+               }
+            }
+   return 1;
+}
+
+static int check_t(enum op op, unsigned size, const uint8_t *noise,
+      uint8_t *expect, uint8_t *got)
+{
+   const uint32_t pitch = 7;
+   uint32_t height, toheight, mask;
+
+   for (height = 1; height <= CHECK_MAX; height++)
+      for (toheight = height; toheight <= CHECK_MAX; toheight++)
+         for (mask = 0; mask <= 6; mask++)
+         {
+            size_t bytes = pitch * CHECK_MAX * size;
+
+            if (op == OP_CLAMP && mask)
+               continue;
+            memcpy(expect, noise, bytes);
+            memcpy(got, noise, bytes);
+            ref_t(op, expect, size, height, mask, toheight, pitch);
+            expand_t(op, got, size, height, mask, toheight, pitch);
+            if (memcmp(expect, got, bytes))
+            {
+               printf("%s T %u bit: mismatch, height %u toheight %u mask %u\n",
+                     op_names[op], size * 8, height, toheight, mask);
+               return 0;
+            }
+         }
+   return 1;
+}
+
+static unsigned log2_u32(uint32_t v)
+{
+   unsigned l = 0;
+   while ((1u << (l + 1)) <= v)
+      l++;
+   return l;
+}
+
+/* A dim x dim surface loaded with a quarter less for clamping, and with
+ * half of it for mirroring and wrapping, as for a mask of half the size. */
+static void bench(enum op op, unsigned size, uint32_t dim, uint8_t *surface)
+{
+   uint32_t load = op == OP_CLAMP ? dim - dim / 4 : dim / 2;
+   uint32_t mask = op == OP_CLAMP ? 0 : log2_u32(dim / 2);
+   unsigned iters = BENCH_BYTES / (dim * dim * size);
+   double start, fast, scalar;
+   unsigned i;
+
+   start = get_time();
+   for (i = 0; i < iters; i++)
+   {
+      expand_s(op, surface, size, load, mask, dim, dim, load);
+      expand_t(op, surface, size, load, mask, dim, dim);
+   }
+   fast = get_time() - start;
+
+   start = get_time();
+   for (i = 0; i < iters; i++)
+   {
+      ref_s(op, surface, size, load, mask, dim, dim, load);
+      ref_t(op, surface, size, load, mask, dim, dim);
+   }
+   scalar = get_time() - start;
+
+   printf("%-7s %2u bit %3ux%-3u %10.2f %10.2f %8.1fx\n", op_names[op], size * 8, dim, dim,
+         fast * 1e6 / iters, scalar * 1e6 / iters, scalar / fast);
+}
+
+int main(void)
+{
+   size_t noise_bytes = CHECK_MAX * CHECK_MAX * 4;
+   uint8_t *noise   = (uint8_t*)malloc(noise_bytes);
+   uint8_t *expect  = (uint8_t*)malloc(noise_bytes);
+   uint8_t *got     = (uint8_t*)malloc(noise_bytes);
+   uint8_t *surface = (uint8_t*)malloc(256 * 256 * 4);
+   unsigned size, k;
+   uint32_t dim;
+   int op;
+
+   srand(1);
+   for (k = 0; k < noise_bytes; k++)
+      noise[k] = (uint8_t)rand();
+   for (k = 0; k < 256 * 256 * 4; k++)
+      surface[k] = (uint8_t)rand();
+
+#if defined(__SSSE3__)
+   printf("texexpand: SSSE3\n");
+#elif defined(__SSE2__) || defined(_M_X64)
+   printf("texexpand: SSE2\n");
+#elif defined(__ARM_NEON__) && defined(HAVE_NEON)
+   printf("texexpand: NEON\n");
+#else
+   printf("texexpand: C\n");
+#endif
+
+   for (op = 0; op < OP_COUNT; op++)
+      for (size = 2; size <= 4; size += 2)
+      {
+         if (!check_s((enum op)op, size, noise, expect, got) ||
+             !check_t((enum op)op, size, noise, expect, got))
+            return 1;
+         printf("%-7s %2u bit ok\n", op_names[op], size * 8);
+      }
+
+   printf("\n%-22s %10s %10s %9s\n", "expand S+T", "us", "scalar", "speedup");
+   for (op = 0; op < OP_COUNT; op++)
+      for (size = 2; size <= 4; size += 2)
+         for (dim = 32; dim <= 256; dim *= 2)
+            bench((enum op)op, size, dim, surface);
+
+   free(noise);
+   free(expect);
+   free(got);
+   free(surface);
+   return 0;
+}
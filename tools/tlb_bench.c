@@ -0,0 +1,337 @@
+/* tlb_bench
+ * Correctness and speed check for the TLB cache the memory handlers of the
+ * mapped segments use (mupen64plus-core/src/r4300/tlb.c and read_nomem and
+ * friends in memory/m64p_memory.c).
+ *
+ * 32 TLB entries of two 4KB pages map 256KB of kuseg onto random RDRAM
+ * pages, as the games running code and data from mapped memory do. A
+ * stream of accesses, mostly sequential with random jumps (word, byte,
+ * half and double word reads, a few writes), is run:
+ *   - through virtual_to_physical_address() and a handler table, as the
+ *     core did for every access,
+ *   - through the direct-mapped host pointer cache, filled from the LUTs
+ *     on a miss.
+ * Both runs must read the same values and leave the same RAM, with TLBWI
+ * remapping entries within the stream.
+ *
+ * The lookup is the one of m64p_memory.c without the handler check, every
+ * page here being RDRAM. Built with "make tlb_bench", exits non-zero on
+ * the first mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "r4300/exception.h"
+#include "r4300/tlb.h"
+#include "main/rom.h"
+
+unsigned char isGoldeneyeRom;
+m64p_rom_header ROM_HEADER;
+
+static unsigned refills;
+
+void TLB_refill_exception(uint32_t addresse, int w)
+{
+   (void)addresse;
+   (void)w;
+   refills++;
+}
+
+#define MAPPED_BASE   UINT32_C(0x00400000)
+#define MAPPED_PAGES  64
+#define RAM_WORDS     (0x400000 / 4)
+#define STREAM_OPS    4096
+#define REMAP_EVERY   1024
+#define BENCH_PASSES  2000
+
+#define BSHIFT(a) ((((a) & 3) ^ 3) << 3)
+#define HSHIFT(a) ((((a) & 2) ^ 2) << 3)
+
+enum op
+{
+   OP_LW = 0,
+   OP_LB,
+   OP_LH,
+   OP_LD,
+   OP_SW,
+   OP_SB,
+   OP_TLBWI,
+   OP_COUNT
+};
+
+/* Out of 16 */
+static const unsigned op_weights[OP_COUNT - 1] = { 9, 2, 2, 1, 1, 1 };
+
+struct insn
+{
+   unsigned op;
+   uint32_t vaddr;
+   uint32_t value;
+};
+
+static struct insn stream[STREAM_OPS];
+static uint32_t ram_ref[RAM_WORDS];
+static uint32_t ram_cached[RAM_WORDS];
+static uint32_t *ram;
+
+/* The core dispatches on the physical region, through readmem[] and
+ * writemem[]. */
+static uint32_t read_rdram(uint32_t paddr)
+{
+   return ram[(paddr & 0xffffff) >> 2];
+}
+
+static void write_rdram(uint32_t paddr, uint32_t value, uint32_t mask)
+{
+   uint32_t *w = &ram[(paddr & 0xffffff) >> 2];
+   *w = (*w & ~mask) | (value & mask);
+}
+
+static uint32_t (*readmem[0x10000])(uint32_t);
+static void (*writemem[0x10000])(uint32_t, uint32_t, uint32_t);
+
+static double get_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void set_entry(unsigned idx, uint32_t pfn_even, uint32_t pfn_odd)
+{
+   tlb *e = &tlb_e[idx];
+
+   memset(e, 0, sizeof(*e));
+   e->vpn2 = (MAPPED_BASE >> 13) + idx;
+   e->v_even = e->v_odd = 1;
+   e->d_even = e->d_odd = 1;
+   e->g = 1;
+   e->start_even = e->vpn2 << 13;
+   e->end_even = e->start_even + 0xFFF;
+   e->phys_even = pfn_even << 12;
+   e->start_odd = e->end_even + 1;
+   e->end_odd = e->start_odd + 0xFFF;
+   e->phys_odd = pfn_odd << 12;
+}
+
+static uint32_t random_pfn(void)
+{
+   return (uint32_t)rand() % (RAM_WORDS * 4 / 0x1000);
+}
+
+static void reset_tlb(void)
+{
+   unsigned i;
+
+   memset(tlb_LUT_r, 0, sizeof(tlb_LUT_r));
+   memset(tlb_LUT_w, 0, sizeof(tlb_LUT_w));
+   srand(3);
+   for (i = 0; i < MAPPED_PAGES / 2; i++)
+   {
+      set_entry(i, random_pfn(), random_pfn());
+      tlb_map(&tlb_e[i]);
+   }
+   tlb_cache_flush();
+}
+
+static void fill_ram(uint32_t *dst)
+{
+   unsigned i;
+
+   srand(4);
+   for (i = 0; i < RAM_WORDS; i++)
+      dst[i] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static void make_stream(int remap)
+{
+   uint32_t offset = 0;
+   unsigned i, k, pick;
+
+   for (i = 0; i < STREAM_OPS; i++)
+   {
+      struct insn *in = &stream[i];
+
+      if ((rand() & 7) == 0)
+         offset = (uint32_t)rand() % (MAPPED_PAGES * 0x1000);
+      else
+         offset = (offset + 4) % (MAPPED_PAGES * 0x1000);
+
+      if (remap && i % REMAP_EVERY == REMAP_EVERY - 1)
+      {
+         in->op = OP_TLBWI;
+         in->vaddr = (uint32_t)rand() % (MAPPED_PAGES / 2);
+         in->value = random_pfn();
+         continue;
+      }
+
+      pick = rand() & 15;
+      for (k = 0; pick >= op_weights[k]; k++)
+         pick -= op_weights[k];
+      in->op = k;
+      in->vaddr = MAPPED_BASE + offset;
+      in->value = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+      if (k == OP_LD)
+         in->vaddr &= ~UINT32_C(7);
+   }
+}
+
+static uint32_t *cache_lookup(uint32_t vaddr, int w)
+{
+   uint32_t page = vaddr >> 12;
+   struct tlb_cache_entry *entry = w
+      ? &tlb_cache_w[page & (TLB_CACHE_SIZE - 1)]
+      : &tlb_cache_r[page & (TLB_CACHE_SIZE - 1)];
+   uint32_t lut;
+
+   if (entry->tag != page + 1)
+   {
+      lut = w ? tlb_LUT_w[page] : tlb_LUT_r[page];
+      if (lut == 0)
+         return NULL;
+      entry->tag  = page + 1;
+      entry->phys = lut & UINT32_C(0xFFFFF000);
+      entry->host = &ram[(entry->phys & 0xffffff) >> 2];
+   }
+   return &entry->host[(vaddr & 0xFFF) >> 2];
+}
+
+static uint32_t read_ref(uint32_t vaddr)
+{
+   uint32_t paddr = virtual_to_physical_address(vaddr, 0);
+   return paddr ? readmem[paddr >> 16](paddr) : 0;
+}
+
+static void write_ref(uint32_t vaddr, uint32_t value, uint32_t mask)
+{
+   uint32_t paddr = virtual_to_physical_address(vaddr, 1);
+   if (paddr)
+      writemem[paddr >> 16](paddr, value, mask);
+}
+
+static uint32_t read_cached(uint32_t vaddr)
+{
+   uint32_t *mem = cache_lookup(vaddr, 0);
+   return mem ? *mem : read_ref(vaddr);
+}
+
+static void write_cached(uint32_t vaddr, uint32_t value, uint32_t mask)
+{
+   uint32_t *mem = cache_lookup(vaddr, 1);
+   if (mem)
+      *mem = (*mem & ~mask) | (value & mask);
+   else
+      write_ref(vaddr, value, mask);
+}
+
+/* Returns a sum of everything read. */
+static uint64_t run_stream(int cached)
+{
+   uint32_t (*read_word)(uint32_t) = cached ? read_cached : read_ref;
+   void (*write_word)(uint32_t, uint32_t, uint32_t) = cached ? write_cached : write_ref;
+   uint64_t sum = 0;
+   unsigned i;
+
+   for (i = 0; i < STREAM_OPS; i++)
+   {
+      const struct insn *in = &stream[i];
+      uint32_t a = in->vaddr;
+
+      switch (in->op)
+      {
+         case OP_LW: sum += read_word(a); break;
+         case OP_LB: sum += (read_word(a) >> BSHIFT(a)) & 0xff; break;
+         case OP_LH: sum += (read_word(a) >> HSHIFT(a)) & 0xffff; break;
+         case OP_LD: sum += ((uint64_t)read_word(a) << 32) | read_word(a + 4); break;
+         case OP_SW: write_word(a, in->value, ~UINT32_C(0)); break;
+         case OP_SB:
+            write_word(a, in->value << BSHIFT(a), UINT32_C(0xff) << BSHIFT(a));
+            break;
+         case OP_TLBWI:
+            tlb_unmap(&tlb_e[a]);
+            set_entry(a, in->value, tlb_e[a].phys_odd >> 12);
+            tlb_map(&tlb_e[a]);
+            break;
+      }
+   }
+   return sum;
+}
+
+static int check_stream(int remap)
+{
+   uint64_t sum_ref, sum_cached;
+   unsigned pass;
+
+   srand(remap ? 5 : 6);
+   make_stream(remap);
+
+   fill_ram(ram_ref);
+   ram = ram_ref;
+   reset_tlb();
+   sum_ref = 0;
+   for (pass = 0; pass < 4; pass++)
+      sum_ref += run_stream(0);
+
+   fill_ram(ram_cached);
+   ram = ram_cached;
+   reset_tlb();
+   sum_cached = 0;
+   for (pass = 0; pass < 4; pass++)
+      sum_cached += run_stream(1);
+
+   if (sum_ref != sum_cached || memcmp(ram_ref, ram_cached, sizeof(ram_ref)))
+   {
+      printf("stream%s: reads or RAM differ\n", remap ? " with TLBWI" : "");
+      return 0;
+   }
+   if (refills)
+   {
+      printf("stream%s: %u unexpected TLB refills\n", remap ? " with TLBWI" : "", refills);
+      return 0;
+   }
+   return 1;
+}
+
+static double bench(int cached, uint64_t *sum)
+{
+   double start;
+   unsigned pass;
+
+   ram = cached ? ram_cached : ram_ref;
+   reset_tlb();
+   start = get_time();
+   for (pass = 0; pass < BENCH_PASSES; pass++)
+      *sum += run_stream(cached);
+   return get_time() - start;
+}
+
+int main(void)
+{
+   double ref, cached;
+   uint64_t sum = 0;
+   unsigned i;
+
+   for (i = 0x8000; i < 0x8000 + (RAM_WORDS * 4 >> 16); i++)
+   {
+      readmem[i] = read_rdram;
+      writemem[i] = write_rdram;
+   }
+
+   if (!check_stream(0) || !check_stream(1))
+      return 1;
+   printf("streams ok\n");
+
+   srand(1);
+   make_stream(0);
+   ref    = bench(0, &sum);
+   cached = bench(1, &sum);
+
+   printf("\n%u accesses: %.2f ns/access uncached, %.2f ns/access cached, %.1fx (%08x)\n",
+         STREAM_OPS * BENCH_PASSES,
+         ref * 1e9 / (STREAM_OPS * BENCH_PASSES),
+         cached * 1e9 / (STREAM_OPS * BENCH_PASSES), ref / cached,
+         (unsigned)sum);
+   return 0;
+}
@@ -0,0 +1,571 @@
+/* vi_bench
+ * Bit-exactness and speed check for angrylion's VI filters
+ * (do_frame_buffer_proper in mupen64plus-video-angrylion/n64video_vi.c).
+ *
+ * The reference is the pixel by pixel loop the VI used before it was
+ * split into scanline passes, with its caches of fetched and divot
+ * filtered pixels. It shares the fetch, restore and anti-aliasing filters
+ * with the new code, which are unchanged. Frames of noise (hidden bits
+ * included) go through both, for random VI settings: 16 and 32-bit
+ * buffers, every combination of the anti-aliasing, divot, dither filter,
+ * gamma and gamma dither bits, and upscaled, downscaled and skipped rows
+ * and pixels. Both must give the same RGB and leave irand()'s seed at the
+ * same value, on 1 to WORKERS_MAX threads.
+ *
+ * Then the time of a 320x240 frame scaled to 640x240 and of a 640x480
+ * interlaced field is printed, with the usual filters on, for the
+ * reference and the new code on one thread and on one per core.
+ *
+ * The reference's caches start at the first pixel, so the checks keep
+ * the divot filter off the left edge, which it would read from outside
+ * its cache. Built with "make vi_bench"; exits non-zero on the first
+ * mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "n64video_vi.c"
+
+#define RAM_SIZE      0x800000
+#define CHECK_FRAMES  600
+#define BENCH_FRAMES  200
+
+GFX_INFO gfx_info;
+uint32_t *blitter_buf_lock;
+int32_t pitchindwords = PRESCALE_WIDTH;
+RECT __src;
+retro_log_printf_t log_cb;
+uint32_t internal_vi_v_current_line;
+int32_t iseed = 1;
+
+int32_t irand(void)
+{
+   iseed *= 0x343fd;
+   iseed += 0x269ec3;
+   return ((iseed >> 16) & 0x7fff);
+}
+
+void rdp_flush(void)
+{
+}
+
+static uint32_t vi_regs[16];
+static uint32_t screen_ref[PRESCALE_WIDTH * PRESCALE_HEIGHT];
+static uint32_t screen_new[PRESCALE_WIDTH * PRESCALE_HEIGHT];
+
+/* The VI as it was, from n64video_vi.c. */
+
+static void ref_gamma_filters(unsigned char* argb, int gamma_and_dither)
+{
+   int cdith, dith;
+   int r, g, b;
+
+   if (gamma_and_dither == 0)
+      return;
+
+   r = argb[1 ^ BYTE_ADDR_XOR];
+   g = argb[2 ^ BYTE_ADDR_XOR];
+   b = argb[3 ^ BYTE_ADDR_XOR];
+
+   switch(gamma_and_dither)
+   {
+      case 1:
+         cdith = irand();
+         dith = cdith & 1;
+         if (r < 255)
+            r += dith;
+         dith = (cdith >> 1) & 1;
+         if (g < 255)
+            g += dith;
+         dith = (cdith >> 2) & 1;
+         if (b < 255)
+            b += dith;
+         break;
+      case 2:
+         r = gamma_table[r];
+         g = gamma_table[g];
+         b = gamma_table[b];
+         break;
+      case 3:
+         cdith = irand();
+         dith = cdith & 0x3f;
+         r = gamma_dither_table[(r << 6) | dith];
+         dith = (cdith >> 6) & 0x3f;
+         g = gamma_dither_table[(g << 6) | dith];
+         dith = ((cdith >> 9) & 0x38) | (cdith & 7);
+         b = gamma_dither_table[(b << 6) | dith];
+         break;
+   }
+   argb[1 ^ BYTE_ADDR_XOR] = (unsigned char)(r);
+   argb[2 ^ BYTE_ADDR_XOR] = (unsigned char)(g);
+   argb[3 ^ BYTE_ADDR_XOR] = (unsigned char)(b);
+}
+
+static void ref_frame_buffer_proper(
+   uint32_t prescale_ptr, int hres, int vres, int x_start, int vitype,
+   int linecount)
+{
+   static void (*const fetch[2])(
+         CCVG*, uint32_t, uint32_t, uint32_t, uint32_t) = {
+      vi_fetch_filter16, vi_fetch_filter32
+   };
+   CCVG viaa_array[2048];
+   CCVG divot_array[2048];
+   CCVG *viaa_cache, *viaa_cache_next, *divot_cache, *divot_cache_next;
+   CCVG *tempccvgptr;
+   CCVG color, nextcolor, scancolor, scannextcolor;
+   uint32_t * scanline;
+   uint32_t pixels = 0, nextpixels = 0;
+   uint32_t prevy = 0;
+   uint32_t y_start = (vi_y_scale >> 16) & 0x0FFF;
+   uint32_t frame_buffer = vi_origin & 0x00FFFFFF;
+   signed int cache_marker_init;
+   int line_x = 0, next_line_x = 0, prev_line_x = 0, far_line_x = 0;
+   int prev_scan_x = 0, scan_x = 0, next_scan_x = 0, far_scan_x = 0;
+   int prev_x = 0, cur_x = 0, next_x = 0, far_x = 0;
+   int cache_marker = 0, cache_next_marker = 0, divot_cache_marker = 0, divot_cache_next_marker = 0;
+   int xfrac = 0, yfrac = 0;
+   int lerping = 0;
+   int vi_width_low = vi_width & 0xFFF;
+   const int x_add = *GET_GFX_INFO(VI_X_SCALE_REG) & 0x00000FFF;
+   uint32_t y_add = vi_y_scale & 0xfff;
+   int i, j;
+   const int gamma_dither     = !!(*GET_GFX_INFO(VI_STATUS_REG) & 0x00000004);
+   const int gamma            = !!(*GET_GFX_INFO(VI_STATUS_REG) & 0x00000008);
+   const int divot            = !!(*GET_GFX_INFO(VI_STATUS_REG) & 0x00000010);
+   const int extralines       =  !(*GET_GFX_INFO(VI_STATUS_REG) & 0x00000100);
+   const int fsaa             =  !(*GET_GFX_INFO(VI_STATUS_REG) & 0x00000200);
+   const int dither_filter    = !!(*GET_GFX_INFO(VI_STATUS_REG) & 0x00010000);
+   const int gamma_and_dither = (gamma << 1) | gamma_dither;
+   const int lerp_en          = fsaa | extralines;
+
+   if (frame_buffer == 0)
+      return;
+
+   viaa_cache = &viaa_array[0];
+   viaa_cache_next = &viaa_array[1024];
+   divot_cache = &divot_array[0];
+   divot_cache_next = &divot_array[1024];
+
+   cache_marker_init  = (x_start >> 10) - 2;
+   cache_marker_init |= -(cache_marker_init < 0);
+
+   for (j = 0; j < vres; j++)
+   {
+      x_start = (vi_x_scale >> 16) & 0x0FFF;
+
+      if ((y_start >> 10) == (prevy + 1) && j)
+      {
+         cache_marker = cache_next_marker;
+         cache_next_marker = cache_marker_init;
+
+         tempccvgptr = viaa_cache;
+         viaa_cache = viaa_cache_next;
+         viaa_cache_next = tempccvgptr;
+         if (divot)
+         {
+            divot_cache_marker = divot_cache_next_marker;
+            divot_cache_next_marker = cache_marker_init;
+            tempccvgptr = divot_cache;
+            divot_cache = divot_cache_next;
+            divot_cache_next = tempccvgptr;
+         }
+      }
+      else if ((y_start >> 10) != prevy || !j)
+      {
+         cache_marker = cache_next_marker = cache_marker_init;
+         if (divot)
+            divot_cache_marker = divot_cache_next_marker = cache_marker_init;
+      }
+
+      scanline = &blitter_buf_lock[prescale_ptr];
+      prescale_ptr += linecount;
+
+      prevy = y_start >> 10;
+      yfrac = (y_start >> 5) & 0x1f;
+      pixels = vi_width_low * prevy;
+      nextpixels = pixels + vi_width_low;
+
+      for (i = 0; i < hres; i++)
+      {
+         unsigned char argb[4];
+
+         line_x = x_start >> 10;
+         prev_line_x = line_x - 1;
+         next_line_x = line_x + 1;
+         far_line_x = line_x + 2;
+
+         cur_x = pixels + line_x;
+         prev_x = pixels + prev_line_x;
+         next_x = pixels + next_line_x;
+         far_x = pixels + far_line_x;
+
+         scan_x = nextpixels + line_x;
+         prev_scan_x = nextpixels + prev_line_x;
+         next_scan_x = nextpixels + next_line_x;
+         far_scan_x = nextpixels + far_line_x;
+
+         xfrac = (x_start >> 5) & 0x1f;
+         lerping = lerp_en & (xfrac || yfrac);
+
+         if (prev_line_x > cache_marker)
+         {
+            fetch[vitype & 1](&viaa_cache[prev_line_x], frame_buffer, prev_x, fsaa, dither_filter);
+            fetch[vitype & 1](&viaa_cache[line_x], frame_buffer, cur_x, fsaa, dither_filter);
+            fetch[vitype & 1](&viaa_cache[next_line_x], frame_buffer, next_x, fsaa, dither_filter);
+            cache_marker = next_line_x;
+         }
+         else if (line_x > cache_marker)
+         {
+            fetch[vitype & 1](&viaa_cache[line_x], frame_buffer, cur_x, fsaa, dither_filter);
+            fetch[vitype & 1](&viaa_cache[next_line_x], frame_buffer, next_x, fsaa, dither_filter);
+            cache_marker = next_line_x;
+         }
+         else if (next_line_x > cache_marker)
+         {
+            fetch[vitype & 1](&viaa_cache[next_line_x], frame_buffer, next_x, fsaa, dither_filter);
+            cache_marker = next_line_x;
+         }
+
+         if (prev_line_x > cache_next_marker)
+         {
+            fetch[vitype & 1](&viaa_cache_next[prev_line_x], frame_buffer, prev_scan_x, fsaa, dither_filter);
+            fetch[vitype & 1](&viaa_cache_next[line_x], frame_buffer, scan_x, fsaa, dither_filter);
+            fetch[vitype & 1](&viaa_cache_next[next_line_x], frame_buffer, next_scan_x, fsaa, dither_filter);
+            cache_next_marker = next_line_x;
+         }
+         else if (line_x > cache_next_marker)
+         {
+            fetch[vitype & 1](&viaa_cache_next[line_x], frame_buffer, scan_x, fsaa, dither_filter);
+            fetch[vitype & 1](&viaa_cache_next[next_line_x], frame_buffer, next_scan_x, fsaa, dither_filter);
+            cache_next_marker = next_line_x;
+         }
+         else if (next_line_x > cache_next_marker)
+         {
+            fetch[vitype & 1](&viaa_cache_next[next_line_x], frame_buffer, next_scan_x, fsaa, dither_filter);
+            cache_next_marker = next_line_x;
+         }
+
+         if (divot == 0)
+            color = viaa_cache[line_x];
+         else
+         {
+            if (far_line_x > cache_marker)
+            {
+               fetch[vitype & 1](&viaa_cache[far_line_x], frame_buffer, far_x, fsaa, dither_filter);
+               cache_marker = far_line_x;
+            }
+
+            if (far_line_x > cache_next_marker)
+            {
+               fetch[vitype & 1](&viaa_cache_next[far_line_x], frame_buffer, far_scan_x, fsaa, dither_filter);
+               cache_next_marker = far_line_x;
+            }
+
+            if (line_x > divot_cache_marker)
+            {
+               divot_filter(&divot_cache[line_x], viaa_cache[line_x],
+                     viaa_cache[prev_line_x], viaa_cache[next_line_x]);
+               divot_filter(&divot_cache[next_line_x], viaa_cache[next_line_x],
+                     viaa_cache[line_x], viaa_cache[far_line_x]);
+               divot_cache_marker = next_line_x;
+            }
+            else if (next_line_x > divot_cache_marker)
+            {
+               divot_filter(&divot_cache[next_line_x], viaa_cache[next_line_x],
+                     viaa_cache[line_x], viaa_cache[far_line_x]);
+               divot_cache_marker = next_line_x;
+            }
+
+            if (line_x > divot_cache_next_marker)
+            {
+               divot_filter(&divot_cache_next[line_x], viaa_cache_next[line_x],
+                     viaa_cache_next[prev_line_x], viaa_cache_next[next_line_x]);
+               divot_filter(&divot_cache_next[next_line_x], viaa_cache_next[next_line_x],
+                     viaa_cache_next[line_x], viaa_cache_next[far_line_x]);
+               divot_cache_next_marker = next_line_x;
+            }
+            else if (next_line_x > divot_cache_next_marker)
+            {
+               divot_filter(&divot_cache_next[next_line_x], viaa_cache_next[next_line_x],
+                     viaa_cache_next[line_x], viaa_cache_next[far_line_x]);
+               divot_cache_next_marker = next_line_x;
+            }
+            color = divot_cache[line_x];
+         }
+
+         if (lerping)
+         {
+            if (divot == 0)
+            {
+               nextcolor = viaa_cache[next_line_x];
+               scancolor = viaa_cache_next[line_x];
+               scannextcolor = viaa_cache_next[next_line_x];
+            }
+            else
+            {
+               nextcolor = divot_cache[next_line_x];
+               scancolor = divot_cache_next[line_x];
+               scannextcolor = divot_cache_next[next_line_x];
+            }
+            if (yfrac)
+            {
+               vi_vl_lerp(&color, scancolor, yfrac);
+               vi_vl_lerp(&nextcolor, scannextcolor, yfrac);
+            }
+            if (xfrac)
+               vi_vl_lerp(&color, nextcolor, xfrac);
+         }
+         argb[0 ^ BYTE_ADDR_XOR] = 0;
+         argb[1 ^ BYTE_ADDR_XOR] = color.r;
+         argb[2 ^ BYTE_ADDR_XOR] = color.g;
+         argb[3 ^ BYTE_ADDR_XOR] = color.b;
+
+         ref_gamma_filters(argb, gamma_and_dither);
+         x_start += x_add;
+         memcpy(&scanline[i], argb, sizeof(uint32_t));
+      }
+      y_start += y_add;
+   }
+}
+
+/* The tables rdp_init() computes */
+static uint32_t integer_sqrt(uint32_t a)
+{
+   uint32_t op = a, res = 0, one = 1 << 30;
+
+   while (one > op)
+      one >>= 2;
+
+   while (one != 0)
+   {
+      if (op >= res + one)
+      {
+         op -= res + one;
+         res += one << 1;
+      }
+      res >>= 1;
+      one >>= 2;
+   }
+   return res;
+}
+
+static void init_tables(void)
+{
+   int i;
+
+   for (i = 0; i < 0x100; i++)
+      gamma_table[i] = integer_sqrt(i << 6) << 1;
+   for (i = 0; i < 0x4000; i++)
+      gamma_dither_table[i] = integer_sqrt(i) << 1;
+   for (i = 0; i < 0x400; i++)
+   {
+      if (((i >> 5) & 0x1f) < (i & 0x1f))
+         vi_restore_table[i] = 1;
+      else if (((i >> 5) & 0x1f) > (i & 0x1f))
+         vi_restore_table[i] = -1;
+      else
+         vi_restore_table[i] = 0;
+   }
+}
+
+static uint32_t rand32(void)
+{
+   return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static void init_memory(void)
+{
+   uint8_t *ram = (uint8_t*)malloc(RAM_SIZE);
+   uint32_t i;
+
+   srand(7);
+   for (i = 0; i < RAM_SIZE; i++)
+      ram[i] = rand();
+   for (i = 0; i < sizeof(hidden_bits); i++)
+      hidden_bits[i] = rand() & 3;
+
+   gfx_info.RDRAM = ram;
+   gfx_info.VI_STATUS_REG  = &vi_regs[0];
+   gfx_info.VI_ORIGIN_REG  = &vi_regs[1];
+   gfx_info.VI_WIDTH_REG   = &vi_regs[2];
+   gfx_info.VI_X_SCALE_REG = &vi_regs[3];
+   gfx_info.VI_Y_SCALE_REG = &vi_regs[4];
+
+   rdram_8 = ram;
+   rdram_16 = (uint16_t*)ram;
+   plim = RAM_SIZE - 1;
+   idxlim16 = RAM_SIZE / 2 - 1;
+   idxlim32 = RAM_SIZE / 4 - 1;
+}
+
+struct vi_setup
+{
+   uint32_t status;
+   uint32_t origin;
+   uint32_t width;
+   uint32_t x_scale;
+   uint32_t y_scale;
+   int hres;
+   int vres;
+};
+
+static void set_regs(const struct vi_setup *s)
+{
+   vi_regs[0] = s->status;
+   vi_regs[1] = s->origin;
+   vi_regs[2] = s->width;
+   vi_regs[3] = s->x_scale;
+   vi_regs[4] = s->y_scale;
+}
+
+static void run(const struct vi_setup *s, uint32_t *screen, int reference)
+{
+   set_regs(s);
+   blitter_buf_lock = screen;
+   if (reference)
+      ref_frame_buffer_proper(0, s->hres, s->vres, (s->x_scale >> 16) & 0xFFF,
+            s->status & 3, PRESCALE_WIDTH);
+   else
+      do_frame_buffer_proper(0, s->hres, s->vres, (s->x_scale >> 16) & 0xFFF,
+            s->status & 3, PRESCALE_WIDTH);
+}
+
+static void random_setup(struct vi_setup *s)
+{
+   static const uint32_t steps[] = { 0x100, 0x200, 0x333, 0x400, 0x555, 0x800 };
+   uint32_t x_add, y_add, x_start;
+   int max_hres;
+
+   s->status = 2 | (rand() & 1)
+      | (rand() & (0x4 | 0x8 | 0x10 | 0x100 | 0x200 | 0x10000));
+   s->origin = rand32() & 0x7FFFF8;
+   s->width = 64 + rand() % 700;
+
+   x_add = rand() & 1 ? steps[rand() % 6] : 0x80 + rand() % 0x780;
+   y_add = rand() & 1 ? steps[rand() % 6] : 0x80 + rand() % 0x780;
+   x_start = rand() & 0xFFF;
+   if ((s->status & 0x10) && x_start < 0x400)
+      x_start += 0x400;
+   s->x_scale = (x_start << 16) | x_add;
+   s->y_scale = ((rand() & 0xFFF) << 16) | y_add;
+
+   /* The reference's caches hold 1024 pixels. */
+   max_hres = ((1020 - 4) << 10) / x_add;
+   if (max_hres > PRESCALE_WIDTH)
+      max_hres = PRESCALE_WIDTH;
+   s->hres = 1 + rand() % max_hres;
+   s->vres = 1 + rand() % 300;
+}
+
+static int same_frame(const struct vi_setup *s)
+{
+   int i, j;
+
+   for (j = 0; j < s->vres; j++)
+      for (i = 0; i < s->hres; i++)
+      {
+         const uint32_t ref = screen_ref[j * PRESCALE_WIDTH + i] & 0xFFFFFF;
+         const uint32_t got = screen_new[j * PRESCALE_WIDTH + i] & 0xFFFFFF;
+
+         if (ref != got)
+         {
+            printf("status %05x width %u x_scale %07x y_scale %07x, %dx%d: "
+                  "pixel %d,%d is %06x, not %06x\n",
+                  s->status, s->width, s->x_scale, s->y_scale, s->hres, s->vres,
+                  i, j, got, ref);
+            return 0;
+         }
+      }
+   return 1;
+}
+
+static int check(void)
+{
+   struct vi_setup s;
+   unsigned frame, threads;
+   int32_t seed, seed_ref;
+
+   srand(11);
+   for (frame = 0; frame < CHECK_FRAMES; frame++)
+   {
+      random_setup(&s);
+      seed = (int32_t)rand32();
+
+      iseed = seed;
+      run(&s, screen_ref, 1);
+      seed_ref = iseed;
+
+      for (threads = 1; threads <= WORKERS_MAX; threads++)
+      {
+         angrylion_set_threads(threads);
+         iseed = seed;
+         run(&s, screen_new, 0);
+         if (!same_frame(&s))
+         {
+            printf("frame %u differs on %u threads\n", frame, threads);
+            return 0;
+         }
+         if (iseed != seed_ref)
+         {
+            printf("frame %u leaves seed %08x on %u threads, not %08x\n",
+                  frame, (unsigned)iseed, threads, (unsigned)seed_ref);
+            return 0;
+         }
+      }
+   }
+   printf("%u frames ok\n", CHECK_FRAMES);
+   return 1;
+}
+
+static double get_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double bench(const struct vi_setup *s, int reference, unsigned threads)
+{
+   double start;
+   unsigned frame;
+
+   angrylion_set_threads(threads);
+   run(s, screen_new, reference);
+   start = get_time();
+   for (frame = 0; frame < BENCH_FRAMES; frame++)
+      run(s, screen_new, reference);
+   return (get_time() - start) * 1e3 / BENCH_FRAMES;
+}
+
+int main(void)
+{
+   /* 16-bit, anti-aliasing, divot and dither filter on, gamma dither on
+    * the first, gamma and gamma dither on the second. */
+   static const struct vi_setup setups[] = {
+      { 0x13016, 0x100000, 320, (0x200 << 16) | 0x200, 0x400, 640, 240 },
+      { 0x1301e, 0x100000, 640, (0x400 << 16) | 0x400, 0x800, 640, 240 },
+   };
+   static const char *names[] = { "320x240 to 640x240", "640x480 field" };
+   unsigned i;
+
+   init_tables();
+   init_memory();
+   if (!check())
+      return 1;
+
+   printf("\n%-20s %12s %12s %12s\n", "", "reference", "1 thread", "per core");
+   for (i = 0; i < 2; i++)
+   {
+      const double ref = bench(&setups[i], 1, 1);
+      const double one = bench(&setups[i], 0, 1);
+      const double all = bench(&setups[i], 0, 0);
+
+      printf("%-20s %9.3f ms %9.3f ms %9.3f ms  (%.1fx, %.1fx on %u threads)\n",
+            names[i], ref, one, all, ref / one, ref / all, workers_count());
+   }
+   workers_close();
+   return 0;
+}